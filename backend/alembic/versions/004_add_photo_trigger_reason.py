@@ -0,0 +1,31 @@
+"""add trigger_reason to photos
+
+Revision ID: 004
+Revises: 003
+Create Date: 2026-10-18
+
+Records why the camera node woke for each photo: its sleep timer
+('scheduled'), the sensor node's activity line ('activity'), or a cold
+power-on ('boot').  Existing rows are backfilled as 'scheduled'.
+"""
+
+from collections.abc import Sequence
+
+from alembic import op
+
+# revision identifiers, used by Alembic.
+revision: str = "004"
+down_revision: str | None = "003"
+branch_labels: str | Sequence[str] | None = None
+depends_on: str | Sequence[str] | None = None
+
+
+def upgrade() -> None:
+    op.execute(
+        "ALTER TABLE photos ADD COLUMN trigger_reason TEXT NOT NULL DEFAULT 'scheduled'"
+        " CHECK(trigger_reason IN ('scheduled','activity','boot'));"
+    )
+
+
+def downgrade() -> None:
+    op.execute("ALTER TABLE photos DROP COLUMN trigger_reason;")
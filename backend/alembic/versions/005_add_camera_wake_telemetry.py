@@ -0,0 +1,54 @@
+"""add camera_wake_telemetry table
+
+Revision ID: 005
+Revises: 004
+Create Date: 2026-10-18
+
+One row per photo upload that carried an X-Wake-Telemetry header:
+per-phase wake timings, previous-wake upload/teardown/awake time,
+battery voltage and consecutive WiFi/upload failure counts.
+"""
+
+from collections.abc import Sequence
+
+from alembic import op
+
+# revision identifiers, used by Alembic.
+revision: str = "005"
+down_revision: str | None = "004"
+branch_labels: str | Sequence[str] | None = None
+depends_on: str | Sequence[str] | None = None
+
+
+def upgrade() -> None:
+    op.execute("""
+        CREATE TABLE camera_wake_telemetry (
+            id                INTEGER PRIMARY KEY AUTOINCREMENT,
+            photo_id          INTEGER NOT NULL UNIQUE
+                                 REFERENCES photos(id) ON DELETE CASCADE,
+            device_id         TEXT NOT NULL REFERENCES camera_nodes(device_id),
+            hive_id           INTEGER NOT NULL REFERENCES hives(id) ON DELETE RESTRICT,
+            recorded_at       TEXT NOT NULL CHECK(LENGTH(recorded_at) = 24),
+            boot_ms           INTEGER,
+            nvs_ms            INTEGER,
+            camera_init_ms    INTEGER,
+            warmup_ms         INTEGER,
+            capture_ms        INTEGER,
+            wifi_ms           INTEGER,
+            time_sync_ms      INTEGER,
+            prev_upload_ms    INTEGER,
+            prev_teardown_ms  INTEGER,
+            prev_awake_ms     INTEGER,
+            battery_mv        INTEGER,
+            wifi_failures     INTEGER,
+            upload_failures   INTEGER
+        );
+    """)
+    op.execute(
+        "CREATE INDEX idx_wake_telemetry_device_time"
+        " ON camera_wake_telemetry(device_id, recorded_at DESC);"
+    )
+
+
+def downgrade() -> None:
+    op.execute("DROP TABLE IF EXISTS camera_wake_telemetry;")
@@ -0,0 +1,30 @@
+"""add photo thumbnails
+
+Revision ID: 006
+Revises: 005
+Create Date: 2026-10-18
+
+Camera nodes can upload a small thumbnail captured in the same wake as
+the full frame.  photos.thumbnail_path is NULL when none was sent.
+camera_wake_telemetry gains the time spent grabbing it.
+"""
+
+from collections.abc import Sequence
+
+from alembic import op
+
+# revision identifiers, used by Alembic.
+revision: str = "006"
+down_revision: str | None = "005"
+branch_labels: str | Sequence[str] | None = None
+depends_on: str | Sequence[str] | None = None
+
+
+def upgrade() -> None:
+    op.execute("ALTER TABLE photos ADD COLUMN thumbnail_path TEXT;")
+    op.execute("ALTER TABLE camera_wake_telemetry ADD COLUMN thumbnail_ms INTEGER;")
+
+
+def downgrade() -> None:
+    op.execute("ALTER TABLE camera_wake_telemetry DROP COLUMN thumbnail_ms;")
+    op.execute("ALTER TABLE photos DROP COLUMN thumbnail_path;")
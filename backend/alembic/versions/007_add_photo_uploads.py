@@ -0,0 +1,51 @@
+"""add resumable photo uploads
+
+Revision ID: 007
+Revises: 006
+Create Date: 2026-10-18
+
+Camera nodes on weak links send photos in CRC-checked chunks.  Each
+in-progress transfer keeps its metadata and acknowledged offset here so
+a broken upload resumes on the next attempt instead of starting over.
+Rows are deleted once the photo is stored or the upload expires; the
+table is local only and never synced.
+"""
+
+from collections.abc import Sequence
+
+from alembic import op
+
+# revision identifiers, used by Alembic.
+revision: str = "007"
+down_revision: str | None = "006"
+branch_labels: str | Sequence[str] | None = None
+depends_on: str | Sequence[str] | None = None
+
+
+def upgrade() -> None:
+    op.execute("""
+        CREATE TABLE photo_uploads (
+            id                  TEXT PRIMARY KEY,
+            device_id           TEXT NOT NULL REFERENCES camera_nodes(device_id),
+            hive_id             INTEGER NOT NULL REFERENCES hives(id) ON DELETE RESTRICT,
+            boot_id             INTEGER NOT NULL,
+            sequence            INTEGER NOT NULL,
+            captured_at         TEXT NOT NULL,
+            captured_at_source  TEXT NOT NULL,
+            trigger_reason      TEXT NOT NULL DEFAULT 'scheduled'
+                                   CHECK(trigger_reason IN ('scheduled', 'activity', 'boot')),
+            total_size          INTEGER NOT NULL CHECK(total_size > 0),
+            crc32               INTEGER NOT NULL,
+            received            INTEGER NOT NULL DEFAULT 0,
+            has_thumbnail       INTEGER NOT NULL DEFAULT 0,
+            created_at          TEXT NOT NULL,
+            updated_at          TEXT NOT NULL,
+            CHECK(received >= 0 AND received <= total_size),
+            UNIQUE(device_id, boot_id, sequence)
+        );
+    """)
+    op.execute("CREATE INDEX idx_photo_uploads_updated ON photo_uploads(updated_at);")
+
+
+def downgrade() -> None:
+    op.execute("DROP TABLE IF EXISTS photo_uploads;")
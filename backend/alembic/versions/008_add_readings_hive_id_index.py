@@ -0,0 +1,29 @@
+"""add sensor_readings (hive_id, id) index
+
+Revision ID: 008
+Revises: 007
+Create Date: 2026-10-18
+
+The time-series store exporter reads each hive's readings above its
+high-water id, and raw reading queries served from the store look up the
+rows not exported yet the same way.  idx_readings_hive_time orders by
+observed_at, so without this index both scan every row of the hive.
+"""
+
+from collections.abc import Sequence
+
+from alembic import op
+
+# revision identifiers, used by Alembic.
+revision: str = "008"
+down_revision: str | None = "007"
+branch_labels: str | Sequence[str] | None = None
+depends_on: str | Sequence[str] | None = None
+
+
+def upgrade() -> None:
+    op.execute("CREATE INDEX idx_readings_hive_id ON sensor_readings(hive_id, id);")
+
+
+def downgrade() -> None:
+    op.execute("DROP INDEX IF EXISTS idx_readings_hive_id;")
@@ -0,0 +1,226 @@
+"""Replay readings through AlertEngine and StreamingAlertEngine and compare.
+
+Each message goes through IngestionService twice, into two fresh databases:
+once with the SQL AlertEngine and once with StreamingAlertEngine (native
+waggle._alerts windows).  The alerts each engine fires for every reading
+must be identical (type, severity, message, observed_at); the harness
+prints the first differences and exits non-zero if there are any, then
+reports the per-reading check_reading latency of both.
+
+Messages come from either
+
+  synthetic   --hives N --days D: minute readings with traffic, ending now,
+              with swarm, absconding, robbing and quiet episodes, sensor
+              errors, first-boot / clamped flags, stuck lanes and a share
+              of late (out-of-order) readings
+  --input     a recorded serial byte stream (loadgen --out, or framelog
+              replay --speed 0 --out) decoded by BridgeProcessor
+
+Run from backend/ after ``pip install -e .`` (builds the extension):
+
+    python benchmarks/alert_replay.py --hives 4 --days 9
+"""
+
+import argparse
+import asyncio
+import math
+import os
+import random
+import statistics
+import sys
+import tempfile
+import time
+from datetime import UTC, datetime, timedelta
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from serial_pipeline import seed_hives  # noqa: E402
+
+from waggle.config import Settings  # noqa: E402
+from waggle.database import create_engine_from_url, init_db  # noqa: E402
+from waggle.services.alert_engine import AlertEngine  # noqa: E402
+from waggle.services.alert_stream import NATIVE_AVAILABLE, StreamingAlertEngine  # noqa: E402
+from waggle.services.bridge import BridgeProcessor  # noqa: E402
+from waggle.services.ingestion import IngestionService  # noqa: E402
+
+READ_SIZE = 4096
+ALERT_KEYS = ("hive_id", "type", "severity", "message", "observed_at")
+
+
+class Recorder:
+    """Wraps an alert engine, keeping each check's alerts and duration."""
+
+    def __init__(self, inner: AlertEngine):
+        self.inner = inner
+        self.results: list[list[tuple]] = []
+        self.samples: list[float] = []
+
+    async def check_reading(self, hive_id: int, reading: dict) -> list[dict]:
+        start = time.perf_counter()
+        alerts = await self.inner.check_reading(hive_id, reading)
+        self.samples.append((time.perf_counter() - start) * 1e6)
+        self.results.append([tuple(a[k] for k in ALERT_KEYS) for a in alerts])
+        return alerts
+
+
+# --- Messages ---
+
+
+def _iso(dt: datetime) -> str:
+    return dt.strftime("%Y-%m-%dT%H:%M:%S.%f")[:-3] + "Z"
+
+
+def synthetic(hives: int, days: int, seed: int) -> list[tuple[str, dict]]:
+    """Minute readings for hives 1..N over the last `days` days, in arrival order."""
+    rng = random.Random(seed)
+    end = datetime.now(UTC) - timedelta(minutes=1)
+    start = end - timedelta(days=days)
+    messages = []
+    for hive_id in range(1, hives + 1):
+        weight_g = rng.randint(30_000, 60_000)
+        episode, episode_left = "normal", 0
+        late: list[tuple[datetime, dict]] = []
+        t = start + timedelta(seconds=rng.randint(0, 59))
+        seq = 0
+        while t < end:
+            if episode_left == 0:
+                episode = rng.choices(
+                    ["normal", "swarm", "abscond", "robbing", "quiet"], [40, 1, 1, 1, 2]
+                )[0]
+                episode_left = rng.randint(30, 300) if episode != "quiet" else 1440
+            episode_left -= 1
+            day_phase = math.sin(2 * math.pi * (t.hour * 60 + t.minute) / 1440)
+            bees = max(0, int(40 + 35 * day_phase)) + rng.randint(0, 8)
+            bees_in, bees_out = bees, bees + rng.randint(-3, 3)
+            if episode == "swarm":
+                weight_g -= rng.randint(40, 120)
+                bees_in, bees_out = rng.randint(0, 5), rng.randint(20, 60)
+            elif episode == "abscond":
+                weight_g -= rng.randint(20, 60)
+                bees_in, bees_out = rng.randint(0, 5), rng.randint(8, 20)
+            elif episode == "robbing":
+                weight_g -= rng.randint(5, 25)
+                bees_in, bees_out = rng.randint(40, 90), rng.randint(0, 30)
+            elif episode == "quiet":
+                bees_in, bees_out = 0, rng.randint(0, 1)
+            else:
+                weight_g += rng.randint(-10, 15)
+            flags = rng.choices([0, 0x02, 0x08, 0x40], [200, 1, 2, 2])[0]
+            msg = {
+                "schema_version": 2,
+                "hive_id": hive_id,
+                "msg_type": 2 if rng.random() < 0.9 else 1,
+                "sequence": seq % 65536,
+                "weight_g": max(0, weight_g),
+                "temp_c_x100": 3450 + int(300 * day_phase) + rng.randint(-20, 20),
+                "humidity_x100": 5500 + rng.randint(-300, 300),
+                "pressure_hpa_x10": 10130 + rng.randint(-20, 20),
+                "battery_mv": 3900 - seq // 2000,
+                "flags": flags,
+                "sender_mac": f"AA:BB:CC:DD:EE:{hive_id:02X}",
+                "observed_at": _iso(t),
+                "bees_in": max(0, bees_in),
+                "bees_out": max(0, bees_out),
+                "period_ms": 60_000,
+                "lane_mask": 15,
+                "stuck_mask": 1 if rng.random() < 0.02 else 0,
+            }
+            seq += 1
+            if rng.random() < 0.01:
+                late.append((t + timedelta(minutes=rng.randint(5, 90)), msg))  # Buffered
+            else:
+                messages.append((t, msg))
+            t += timedelta(seconds=60 + rng.randint(-2, 2))
+        messages.extend(late)
+    # Arrival order; a late message arrives after readings observed later
+    messages.sort(key=lambda m: (m[0], m[1]["hive_id"]))
+    return [(f"waggle/{m['hive_id']}/sensors", m) for _, m in messages]
+
+
+def recorded(path: str) -> list[tuple[str, dict]]:
+    stream = Path(path).read_bytes()
+    bridge = BridgeProcessor()
+    messages = []
+    for offset in range(0, len(stream), READ_SIZE):
+        messages.extend(bridge.process_buffer(stream[offset : offset + READ_SIZE]))
+    return messages
+
+
+# --- Replay ---
+
+
+async def replay(messages, db_path: str, hives: int, settings: Settings, streaming: bool):
+    engine = create_engine_from_url(f"sqlite+aiosqlite:///{db_path}", is_worker=True)
+    await init_db(engine)
+    await seed_hives(engine, hives)
+    recorder = Recorder(StreamingAlertEngine(engine) if streaming else AlertEngine(engine))
+    ingestion = IngestionService(engine, settings, recorder)
+    for topic, msg in messages:
+        await ingestion.process_message(topic, dict(msg))
+    await engine.dispose()
+    return recorder
+
+
+def percentiles(samples: list[float]) -> tuple[float, float]:
+    samples = sorted(samples)
+    return statistics.median(samples), samples[max(0, int(len(samples) * 0.95) - 1)]
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--input", help="raw serial byte stream instead of synthetic readings")
+    parser.add_argument("--hives", type=int, default=4)
+    parser.add_argument("--days", type=int, default=9)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+    if not 1 <= args.hives <= 250:
+        parser.error("--hives must be 1-250")
+    if not NATIVE_AVAILABLE:
+        sys.exit("waggle._alerts is not built (pip install -e .)")
+
+    messages = recorded(args.input) if args.input else synthetic(args.hives, args.days, args.seed)
+    if args.input:
+        args.hives = max((m["hive_id"] for _, m in messages), default=1)
+    print(f"{len(messages)} messages for {args.hives} hives")
+
+    with tempfile.TemporaryDirectory() as tmp:
+        # Synthetic history reaches further back than the default skew limit
+        settings = Settings(
+            API_KEY=os.environ.get("API_KEY", "bench"),
+            DB_PATH=os.path.join(tmp, "unused.db"),
+            MAX_PAST_SKEW_HOURS=(args.days + 1) * 24,
+        )
+        sql = asyncio.run(
+            replay(messages, os.path.join(tmp, "sql.db"), args.hives, settings, False)
+        )
+        stream = asyncio.run(
+            replay(messages, os.path.join(tmp, "stream.db"), args.hives, settings, True)
+        )
+
+    fired: dict[str, int] = {}
+    for alerts in sql.results:
+        for alert in alerts:
+            fired[alert[1]] = fired.get(alert[1], 0) + 1
+    print(f"  {len(sql.results)} readings checked, alerts: "
+          + (", ".join(f"{k} {v}" for k, v in sorted(fired.items())) or "none"))
+
+    diffs = [
+        (i, a, b) for i, (a, b) in enumerate(zip(sql.results, stream.results)) if a != b
+    ]
+    if len(sql.results) != len(stream.results):
+        diffs.append((-1, len(sql.results), len(stream.results)))
+    for i, a, b in diffs[:10]:
+        print(f"  MISMATCH at reading {i}:\n    sql    {a}\n    stream {b}")
+
+    s50, s95 = percentiles(sql.samples)
+    t50, t95 = percentiles(stream.samples)
+    print(f"  check_reading  sql p50 {s50:8.1f} us  p95 {s95:8.1f} us")
+    print(f"                 stream p50 {t50:8.1f} us  p95 {t95:8.1f} us  ({s50 / t50:.1f}x)")
+    if diffs:
+        sys.exit(f"{len(diffs)} readings fired different alerts")
+    print("  identical alerts")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,137 @@
+"""Side-by-side benchmark of the bridge frame decoders.
+
+Decodes the same synthetic serial stream (Phase 1 and Phase 2 frames with
+a few percent of corrupt ones) with:
+
+  per-frame      BridgeProcessor.process_frame on each split frame (old path)
+  python         waggle.utils.frames.decode_frames_py on whole reads
+  native         waggle._frames via decode_frames_native on whole reads
+  process_buffer BridgeProcessor.process_buffer (default decoder + msg dicts)
+
+Run from backend/ (build the extension first with
+``python setup.py build_ext --inplace`` or ``pip install -e .``):
+
+    python benchmarks/frame_decode.py --frames 20000 --read-size 4096
+"""
+
+import argparse
+import random
+import struct
+import sys
+import time
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from waggle.services.bridge import BridgeProcessor  # noqa: E402
+from waggle.utils.cobs import cobs_encode  # noqa: E402
+from waggle.utils.crc8 import crc8  # noqa: E402
+from waggle.utils.frames import (  # noqa: E402
+    NATIVE_AVAILABLE,
+    decode_frames_native,
+    decode_frames_py,
+)
+
+
+def build_stream(count: int, corrupt_pct: float, seed: int) -> bytes:
+    rng = random.Random(seed)
+    out = bytearray()
+    for i in range(count):
+        hive_id = 1 + i % 250
+        common = struct.pack(
+            "<BBHihHHHB",
+            hive_id, 0x02 if i % 4 else 0x01, i & 0xFFFF,
+            rng.randrange(20000, 60000), rng.randrange(1000, 3000),
+            rng.randrange(3000, 9000), rng.randrange(9900, 10300),
+            rng.randrange(3300, 4200), 0,
+        )
+        if i % 4:
+            traffic = struct.pack("<HHIBB", rng.randrange(500), rng.randrange(500), 60000, 15, 0)
+            payload = common + bytes([crc8(common)]) + traffic + bytes(20)
+        else:
+            payload = common + bytes([crc8(common)]) + bytes(14)
+        frame = bytearray(cobs_encode(bytes([0x24, 0x6F, 0x28, 0x10, 0x00, hive_id]) + payload))
+        if rng.random() * 100 < corrupt_pct:
+            frame[12] ^= 0x10
+        out += frame + b"\x00"
+    return bytes(out)
+
+
+def reads(stream: bytes, size: int) -> list[bytes]:
+    return [stream[i : i + size] for i in range(0, len(stream), size)]
+
+
+def run_per_frame(chunks: list[bytes]) -> int:
+    processor = BridgeProcessor()
+    pending = b""
+    count = 0
+    for chunk in chunks:
+        *frames, pending = (pending + chunk).split(b"\x00")
+        for raw in frames:
+            if raw and processor.process_frame(raw) is not None:
+                count += 1
+    return count
+
+
+def run_decoder(decode, chunks: list[bytes]) -> int:
+    pending = b""
+    count = 0
+    for chunk in chunks:
+        buf = pending + chunk
+        result = decode(buf)
+        pending = buf[result.consumed :]
+        count += len(result.frames)
+    return count
+
+
+def run_process_buffer(chunks: list[bytes]) -> int:
+    processor = BridgeProcessor()
+    return sum(len(processor.process_buffer(chunk)) for chunk in chunks)
+
+
+def best_of(fn, repeats: int) -> tuple[float, int]:
+    best = float("inf")
+    count = 0
+    for _ in range(repeats):
+        t0 = time.perf_counter()
+        count = fn()
+        best = min(best, time.perf_counter() - t0)
+    return best, count
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--frames", type=int, default=20000)
+    parser.add_argument("--read-size", type=int, default=4096, help="bytes per serial read")
+    parser.add_argument("--corrupt-pct", type=float, default=2.0)
+    parser.add_argument("--repeats", type=int, default=5)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    stream = build_stream(args.frames, args.corrupt_pct, args.seed)
+    chunks = reads(stream, args.read_size)
+
+    cases = [
+        ("per-frame", lambda: run_per_frame(chunks)),
+        ("python", lambda: run_decoder(decode_frames_py, chunks)),
+    ]
+    if NATIVE_AVAILABLE:
+        cases.append(("native", lambda: run_decoder(decode_frames_native, chunks)))
+    cases.append(("process_buffer", lambda: run_process_buffer(chunks)))
+
+    print(
+        f"{args.frames} frames, {len(stream)} bytes, {len(chunks)} reads of "
+        f"{args.read_size} B, native {'available' if NATIVE_AVAILABLE else 'NOT built'}"
+    )
+    baseline = None
+    for name, fn in cases:
+        elapsed, count = best_of(fn, args.repeats)
+        baseline = baseline or elapsed
+        print(
+            f"  {name:<15} {count:>7} valid  {elapsed * 1e6 / args.frames:8.2f} us/frame  "
+            f"{args.frames / elapsed:>10.0f} frames/s  {baseline / elapsed:6.1f}x"
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,121 @@
+"""Rows/s benchmark: Python bridge + IngestionService vs the native ingestd.
+
+Feeds the same recorded serial byte stream (loadgen --out, or a framelog
+capture exported with ``framelog replay --speed 0 --out``) through:
+
+  python   BridgeProcessor.process_buffer + IngestionService.process_message
+           (the bridge and worker pair without the MQTT hop)
+  ingestd  backend/native/ingestd/ingestd --input (same checks, batched writes)
+
+Each path writes into its own fresh database with hives 1..N.  The alert
+engine is stubbed out on the Python side unless --with-alerts is given,
+since ingestd hands alert checks to ``python -m waggle alerts``.
+
+Run from backend/ after ``make -C native ingestd``:
+
+    ../firmware/bridge/.pio/build/loadgen/program --hives 100 --interval-ms 100 \\
+        --duration-s 60 --baud 0 --out /tmp/apiary.bin
+    python benchmarks/ingest_rows.py --input /tmp/apiary.bin --hives 100
+"""
+
+import argparse
+import asyncio
+import os
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from serial_pipeline import seed_hives  # noqa: E402
+
+from waggle.config import Settings  # noqa: E402
+from waggle.database import create_engine_from_url, init_db  # noqa: E402
+from waggle.services.alert_engine import AlertEngine  # noqa: E402
+from waggle.services.bridge import BridgeProcessor  # noqa: E402
+from waggle.services.ingestion import IngestionService  # noqa: E402
+
+READ_SIZE = 4096
+DEFAULT_INGESTD = Path(__file__).resolve().parents[1] / "native" / "ingestd" / "ingestd"
+
+
+class NullAlertEngine:
+    async def check_reading(self, hive_id: int, reading: dict) -> list[dict]:
+        return []
+
+
+async def prepare_db(path: str, hives: int):
+    engine = create_engine_from_url(f"sqlite+aiosqlite:///{path}", is_worker=True)
+    await init_db(engine)
+    await seed_hives(engine, hives)
+    return engine
+
+
+async def run_python(stream: bytes, db_path: str, hives: int, with_alerts: bool) -> tuple:
+    engine = await prepare_db(db_path, hives)
+    settings = Settings(API_KEY=os.environ.get("API_KEY", "bench"), DB_PATH=db_path)
+    alerts = AlertEngine(engine) if with_alerts else NullAlertEngine()
+    ingestion = IngestionService(engine, settings, alerts)
+    bridge = BridgeProcessor()
+
+    stored = 0
+    start = time.perf_counter()
+    for offset in range(0, len(stream), READ_SIZE):
+        for topic, msg in bridge.process_buffer(stream[offset : offset + READ_SIZE]):
+            if await ingestion.process_message(topic, msg):
+                stored += 1
+    elapsed = time.perf_counter() - start
+    await engine.dispose()
+    return stored, elapsed
+
+
+def run_ingestd(binary: Path, input_path: str, db_path: str, hives: int) -> tuple:
+    engine = asyncio.run(prepare_db(db_path, hives))
+    asyncio.run(engine.dispose())
+    start = time.perf_counter()
+    result = subprocess.run(
+        [str(binary), "--input", input_path, "--db", db_path, "--no-mqtt"],
+        capture_output=True,
+        text=True,
+        check=True,
+    )
+    elapsed = time.perf_counter() - start
+    sys.stderr.write(result.stderr)
+    stored = int(result.stderr.split(" stored ")[1].split()[0])
+    return stored, elapsed
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--input", required=True, help="raw serial byte stream")
+    parser.add_argument("--hives", type=int, default=20, help="create hives 1..N")
+    parser.add_argument("--ingestd", type=Path, default=DEFAULT_INGESTD)
+    parser.add_argument("--with-alerts", action="store_true", help="run alert rules in Python")
+    args = parser.parse_args()
+    if not 1 <= args.hives <= 250:
+        parser.error("--hives must be 1-250")
+
+    stream = Path(args.input).read_bytes()
+    print(f"{len(stream)} bytes, {stream.count(0)} delimiters")
+    with tempfile.TemporaryDirectory() as tmp:
+        py_db = os.path.join(tmp, "python.db")
+        stored, elapsed = asyncio.run(run_python(stream, py_db, args.hives, args.with_alerts))
+        py_rate = stored / elapsed
+        print(f"  python   {stored:8d} rows  {elapsed:8.3f} s  {py_rate:10.1f} rows/s")
+
+        if not args.ingestd.is_file():
+            print(f"  ingestd  not built ({args.ingestd}); run make -C native ingestd")
+            return
+        native_db = os.path.join(tmp, "ingestd.db")
+        stored, elapsed = run_ingestd(args.ingestd, args.input, native_db, args.hives)
+        rate = stored / elapsed
+        print(
+            f"  ingestd  {stored:8d} rows  {elapsed:8.3f} s  {rate:10.1f} rows/s"
+            f"  ({rate / py_rate:.1f}x, includes process start-up)"
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,120 @@
+"""Photos per second of ML pre-processing: ultralytics' path vs waggle._preprocess.
+
+Both turn a camera JPEG into the (3, size, size) float32 0..1 RGB input
+YOLOv8-nano takes, letterboxed on grey (114):
+
+  current   what ultralytics does with a photo path: cv2.imread at full
+            size, cv2.resize (INTER_LINEAR), cv2.copyMakeBorder, BGR->RGB,
+            HWC->CHW, contiguous float32 copy, / 255
+  native    waggle._preprocess.letterbox: DCT-scaled libjpeg-turbo decode,
+            then one SIMD pass per row to resize, split planes and normalise
+
+Photos come from --photos (a directory of camera JPEGs, e.g. PHOTO_DIR/1)
+or are synthesised at the camera node's frame sizes.  Also prints the mean
+and max difference of the two inputs in 0..255 steps, as a sanity check.
+
+Run from backend/ after ``pip install -e .`` (builds the extension), with
+opencv-python and numpy installed (ultralytics brings both):
+
+    python benchmarks/ml_preprocess.py --runs 200
+"""
+
+import argparse
+import sys
+import time
+from pathlib import Path
+
+import cv2
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from waggle import _preprocess  # noqa: E402
+
+# VGA is the PSRAM default (CAMERA_FRAMESIZE), SVGA the no-PSRAM fallback,
+# UXGA the OV2640's full resolution (decoded at 1/2)
+FRAME_SIZES = {"vga": (640, 480), "svga": (800, 600), "uxga": (1600, 1200)}
+
+
+def synth_jpeg(width: int, height: int, rng: np.random.Generator) -> bytes:
+    """A textured frame: gradients, blobs and noise, so the entropy coder has work."""
+    y, x = np.mgrid[0:height, 0:width].astype(np.float32)
+    img = np.stack([x / width * 255, y / height * 255, (x + y) % 256], axis=-1)
+    for _ in range(40):
+        cx, cy, r = rng.integers(0, width), rng.integers(0, height), rng.integers(5, 40)
+        cv2.circle(img, (int(cx), int(cy)), int(r), rng.integers(0, 255, 3).tolist(), -1)
+    img += rng.normal(0, 8, img.shape)
+    ok, buf = cv2.imencode(".jpg", np.clip(img, 0, 255).astype(np.uint8),
+                           [cv2.IMWRITE_JPEG_QUALITY, 80])
+    assert ok
+    return buf.tobytes()
+
+
+def current(jpeg: bytes, size: int) -> np.ndarray:
+    im = cv2.imdecode(np.frombuffer(jpeg, np.uint8), cv2.IMREAD_COLOR)
+    h, w = im.shape[:2]
+    r = min(size / h, size / w)
+    new_w, new_h = int(round(w * r)), int(round(h * r))
+    if (w, h) != (new_w, new_h):
+        im = cv2.resize(im, (new_w, new_h), interpolation=cv2.INTER_LINEAR)
+    dw, dh = (size - new_w) / 2, (size - new_h) / 2
+    top, bottom = int(round(dh - 0.1)), int(round(dh + 0.1))
+    left, right = int(round(dw - 0.1)), int(round(dw + 0.1))
+    im = cv2.copyMakeBorder(im, top, bottom, left, right, cv2.BORDER_CONSTANT,
+                            value=(114, 114, 114))
+    im = np.ascontiguousarray(im[..., ::-1].transpose(2, 0, 1))
+    return im.astype(np.float32) / 255
+
+
+def native(jpeg: bytes, size: int) -> np.ndarray:
+    data = _preprocess.letterbox(jpeg, size)[0]
+    return np.frombuffer(data, dtype=np.float32).reshape(3, size, size)
+
+
+def photos_per_sec(fn, photos: list[bytes], size: int, runs: int) -> float:
+    for jpeg in photos[:4]:
+        fn(jpeg, size)  # Warm up
+    start = time.perf_counter()
+    for i in range(runs):
+        fn(photos[i % len(photos)], size)
+    return runs / (time.perf_counter() - start)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--photos", help="directory of JPEGs (default: synthesised)")
+    parser.add_argument("--frame", choices=sorted(FRAME_SIZES), default="vga",
+                        help="synthesised frame size")
+    parser.add_argument("--count", type=int, default=20, help="synthesised photos")
+    parser.add_argument("--size", type=int, default=640, help="model input size")
+    parser.add_argument("--runs", type=int, default=200, help="photos timed per path")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    # One thread each: the worker pre-processes a photo at a time
+    cv2.setNumThreads(1)
+
+    if args.photos:
+        photos = [p.read_bytes() for p in sorted(Path(args.photos).rglob("*.jpg"))]
+        if not photos:
+            parser.error(f"no .jpg files under {args.photos}")
+        source = f"{len(photos)} photos from {args.photos}"
+    else:
+        rng = np.random.default_rng(args.seed)
+        width, height = FRAME_SIZES[args.frame]
+        photos = [synth_jpeg(width, height, rng) for _ in range(args.count)]
+        source = f"{len(photos)} synthesised {width}x{height} photos"
+
+    diffs = [np.abs(current(j, args.size) - native(j, args.size)) * 255 for j in photos]
+    print(f"{source} -> {args.size}x{args.size} float32, kernels {_preprocess.KERNELS}")
+    print(f"  input difference  mean {np.mean([d.mean() for d in diffs]):.2f}"
+          f"  max {max(d.max() for d in diffs):.0f}  (0..255 steps)")
+
+    cur = photos_per_sec(current, photos, args.size, args.runs)
+    nat = photos_per_sec(native, photos, args.size, args.runs)
+    print(f"  current  {cur:8.1f} photos/s  {1000 / cur:6.2f} ms/photo")
+    print(f"  native   {nat:8.1f} photos/s  {1000 / nat:6.2f} ms/photo  {nat / cur:5.2f}x")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,216 @@
+"""Serial → bridge → (MQTT) → ingestion pipeline for load testing.
+
+Consumer half of the synthetic apiary load generator
+(firmware/bridge/loadgen).  Reads COBS frames from the loadgen pty,
+decodes them with BridgeProcessor and stores them with IngestionService,
+optionally round-tripping every message through the MQTT broker the way
+the bridge and worker processes will in production.
+
+Run from backend/ against a scratch database (hives 1..N are created
+without a sender_mac so the MAC check is skipped):
+
+    python benchmarks/serial_pipeline.py --device /tmp/ttyWAGGLE \\
+        --db /tmp/loadgen.db --hives 100 [--mqtt]
+
+then start the load generator with the same --db and --hives; it reports
+throughput and latency once its run completes.  Stop this with Ctrl-C;
+the per-hop latency of traced readings (waggle/services/latency.py) is
+logged on exit.
+"""
+
+import argparse
+import asyncio
+import json
+import logging
+import os
+import sys
+import termios
+import time
+import tty
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from sqlalchemy import text  # noqa: E402
+
+from waggle.config import Settings  # noqa: E402
+from waggle.database import create_engine_from_url, init_db  # noqa: E402
+from waggle.services.alert_engine import AlertEngine  # noqa: E402
+from waggle.services.bridge import BridgeProcessor  # noqa: E402
+from waggle.services.ingestion import IngestionService  # noqa: E402
+from waggle.services.latency import latency_tracker  # noqa: E402
+from waggle.utils.timestamps import utc_now  # noqa: E402
+
+logger = logging.getLogger("serial_pipeline")
+
+
+class Stats:
+    def __init__(self) -> None:
+        self.frames = 0  # Delimiters seen, including empty and invalid frames
+        self.stored = 0
+        self.dropped = 0
+        self.start = time.monotonic()
+
+    def line(self) -> str:
+        elapsed = max(time.monotonic() - self.start, 1e-9)
+        return (
+            f"frames {self.frames} "
+            f"stored {self.stored} dropped {self.dropped} "
+            f"({self.stored / elapsed:.1f} stored/s)"
+        )
+
+
+# --- Serial reader ---
+
+
+def _open_serial(device: str) -> int:
+    fd = os.open(device, os.O_RDONLY | os.O_NOCTTY | os.O_NONBLOCK)
+    if os.isatty(fd):
+        tty.setraw(fd, termios.TCSANOW)
+    return fd
+
+
+async def read_frames(device: str, queue: asyncio.Queue, stats: Stats) -> None:
+    """Decode each read with BridgeProcessor.process_buffer and queue (topic, msg) pairs."""
+    loop = asyncio.get_running_loop()
+    fd = _open_serial(device)
+    bridge = BridgeProcessor()
+    readable = asyncio.Event()
+    loop.add_reader(fd, readable.set)
+    try:
+        while True:
+            await readable.wait()
+            readable.clear()
+            try:
+                chunk = os.read(fd, 4096)
+            except BlockingIOError:
+                continue
+            if not chunk:
+                # Writer closed the pty; keep waiting for the next run
+                await asyncio.sleep(0.1)
+                continue
+            stats.frames += chunk.count(0)
+            for result in bridge.process_buffer(chunk):
+                await queue.put(result)
+    finally:
+        loop.remove_reader(fd)
+        os.close(fd)
+
+
+# --- Ingestion paths ---
+
+
+async def ingest_direct(
+    queue: asyncio.Queue, ingestion: IngestionService, stats: Stats
+) -> None:
+    while True:
+        topic, msg = await queue.get()
+        if await ingestion.process_message(topic, msg):
+            stats.stored += 1
+        else:
+            stats.dropped += 1
+
+
+async def ingest_via_mqtt(
+    queue: asyncio.Queue, ingestion: IngestionService, stats: Stats, settings: Settings
+) -> None:
+    import aiomqtt
+
+    async def publish() -> None:
+        async with aiomqtt.Client(settings.MQTT_HOST, settings.MQTT_PORT) as client:
+            while True:
+                topic, msg = await queue.get()
+                await client.publish(topic, json.dumps(msg), qos=1)
+
+    async def subscribe() -> None:
+        async with aiomqtt.Client(settings.MQTT_HOST, settings.MQTT_PORT) as client:
+            await client.subscribe("waggle/+/sensors", qos=1)
+            async for message in client.messages:
+                payload = json.loads(message.payload)
+                if await ingestion.process_message(str(message.topic), payload):
+                    stats.stored += 1
+                else:
+                    stats.dropped += 1
+
+    await asyncio.gather(publish(), subscribe())
+
+
+# --- Main ---
+
+
+async def seed_hives(engine, count: int) -> None:
+    async with engine.begin() as conn:
+        for hive_id in range(1, count + 1):
+            await conn.execute(
+                text(
+                    "INSERT OR IGNORE INTO hives (id, name, created_at) "
+                    "VALUES (:id, :name, :created_at)"
+                ),
+                {"id": hive_id, "name": f"loadgen-{hive_id}", "created_at": utc_now()},
+            )
+
+
+async def report(stats: Stats, interval: float) -> None:
+    while True:
+        await asyncio.sleep(interval)
+        logger.info(stats.line())
+
+
+async def run(args: argparse.Namespace) -> None:
+    settings = Settings(
+        API_KEY=os.environ.get("API_KEY", "loadgen"),
+        DB_PATH=args.db,
+        MQTT_HOST=args.mqtt_host,
+        MQTT_PORT=args.mqtt_port,
+    )
+    engine = create_engine_from_url(settings.DB_URL, is_worker=True)
+    await init_db(engine)
+    await seed_hives(engine, args.hives)
+
+    ingestion = IngestionService(engine, settings, AlertEngine(engine))
+    await ingestion.warm_dedup_cache()
+
+    stats = Stats()
+    queue: asyncio.Queue = asyncio.Queue(maxsize=1024)
+    if args.mqtt:
+        consumer = ingest_via_mqtt(queue, ingestion, stats, settings)
+    else:
+        consumer = ingest_direct(queue, ingestion, stats)
+    logger.info("reading %s (%s)", args.device, "mqtt" if args.mqtt else "direct")
+    try:
+        await asyncio.gather(
+            read_frames(args.device, queue, stats), consumer, report(stats, args.report_sec)
+        )
+    finally:
+        logger.info(stats.line())
+        for hop, h in latency_tracker.summary(recent=0)["hops"].items():
+            if h["count"]:
+                logger.info(
+                    "%-6s n=%d p50<=%sms p95<=%sms p99<=%sms max %.1fms",
+                    hop, h["count"], h["p50_ms"], h["p95_ms"], h["p99_ms"], h["max_ms"],
+                )
+        await engine.dispose()
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--device", required=True, help="pty or serial device to read")
+    parser.add_argument("--db", required=True, help="SQLite database (use a scratch copy)")
+    parser.add_argument("--hives", type=int, default=20, help="create hives 1..N if missing")
+    parser.add_argument("--mqtt", action="store_true", help="round-trip through the broker")
+    parser.add_argument("--mqtt-host", default="127.0.0.1")
+    parser.add_argument("--mqtt-port", type=int, default=1883)
+    parser.add_argument("--report-sec", type=float, default=5.0)
+    args = parser.parse_args()
+    if not 1 <= args.hives <= 250:
+        parser.error("--hives must be 1-250")
+
+    logging.basicConfig(level=logging.INFO, format="%(asctime)s %(message)s")
+    try:
+        asyncio.run(run(args))
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
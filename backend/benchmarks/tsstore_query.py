@@ -0,0 +1,274 @@
+"""Raw query latency and disk footprint: SQLite vs the time-series store.
+
+Generates minute-cadence readings (traffic on every other hive) with a
+little timestamp jitter, writes them to a SQLite database with the
+sensor_readings / bee_counts columns and indexes, and seals the same rows
+into a waggle._tsstore store in BLOCK_ROWS blocks, as the exporter does.
+Then times the queries behind GET /api/hives/{id}/readings?interval=raw
+(count + page) both ways:
+
+  latest      newest 100 readings, no bounds (dashboard default)
+  day         one day by prefix bound, first page and total
+  deep        page at the middle of the hive's history
+  traffic     bee_counts page, oldest first
+
+Footprint counts the readings and traffic tables with their indexes
+(dbstat) against the store files.
+
+Run from backend/ after ``pip install -e .`` (builds the extension):
+
+    python benchmarks/tsstore_query.py --hives 10 --days 30
+"""
+
+import argparse
+import math
+import os
+import random
+import sqlite3
+import statistics
+import sys
+import tempfile
+import time
+from datetime import UTC, datetime
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from waggle import _tsstore  # noqa: E402
+
+SCHEMA = """
+CREATE TABLE sensor_readings (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    hive_id INTEGER NOT NULL,
+    observed_at TEXT NOT NULL,
+    ingested_at TEXT NOT NULL,
+    weight_kg REAL, temp_c REAL, humidity_pct REAL, pressure_hpa REAL, battery_v REAL,
+    sequence INTEGER NOT NULL,
+    flags INTEGER NOT NULL DEFAULT 0,
+    sender_mac TEXT NOT NULL,
+    row_synced INTEGER NOT NULL DEFAULT 0,
+    UNIQUE (hive_id, sequence, observed_at)
+);
+CREATE INDEX idx_readings_hive_time ON sensor_readings(hive_id, observed_at);
+CREATE INDEX idx_readings_time ON sensor_readings(observed_at);
+CREATE INDEX idx_readings_hive_id ON sensor_readings(hive_id, id);
+CREATE TABLE bee_counts (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    reading_id INTEGER NOT NULL UNIQUE REFERENCES sensor_readings(id),
+    hive_id INTEGER NOT NULL,
+    observed_at TEXT NOT NULL,
+    ingested_at TEXT NOT NULL,
+    period_ms INTEGER NOT NULL,
+    bees_in INTEGER NOT NULL,
+    bees_out INTEGER NOT NULL,
+    net_out INTEGER GENERATED ALWAYS AS (bees_out - bees_in) VIRTUAL,
+    total_traffic INTEGER GENERATED ALWAYS AS (bees_in + bees_out) VIRTUAL,
+    lane_mask INTEGER NOT NULL,
+    stuck_mask INTEGER NOT NULL,
+    sequence INTEGER NOT NULL,
+    flags INTEGER NOT NULL DEFAULT 0,
+    sender_mac TEXT NOT NULL,
+    row_synced INTEGER NOT NULL DEFAULT 0
+);
+CREATE INDEX idx_bee_counts_hive_time ON bee_counts(hive_id, observed_at DESC);
+"""
+
+T0_MS = 1_767_225_600_000  # 2026-01-01T00:00:00.000Z
+MAC = "AA:BB:CC:DD:EE:FF"
+
+
+def iso(ms: int) -> str:
+    return datetime.fromtimestamp(ms / 1000, UTC).strftime("%Y-%m-%dT%H:%M:%S.%f")[:-3] + "Z"
+
+
+# --- Data ---
+
+
+def generate(hive_id: int, count: int, rng: random.Random) -> list[tuple]:
+    """Store.append row tuples (without final ids) for one hive."""
+    rows = []
+    weight_g = rng.randint(25_000, 60_000)
+    battery_mv = 4150
+    traffic = hive_id % 2 == 0
+    for i in range(count):
+        t_ms = T0_MS + i * 60_000 + rng.randint(-40, 40)
+        day_phase = math.sin(2 * math.pi * (i % 1440) / 1440)
+        weight_g += rng.randint(-15, 20)
+        battery_mv -= rng.random() < 0.01
+        temp = round(3450 + 150 * day_phase + rng.randint(-5, 5))
+        hum = round(5600 - 800 * day_phase + rng.randint(-20, 20))
+        pres = 10130 + rng.randint(-3, 3)
+        bc = (None, 0, 0, 0, 0, 0)
+        if traffic:
+            bees = max(0, int(60 + 50 * day_phase)) + rng.randint(0, 10)
+            bc = (1, 60_000, bees, max(0, bees + rng.randint(-5, 5)), 15, 0)
+        rows.append(
+            (0, t_ms, weight_g / 1000.0, temp / 100.0, hum / 100.0, pres / 10.0,
+             battery_mv / 1000.0, i % 65536, 0, *bc)
+        )
+    return rows
+
+
+def populate(db_path: str, store_dir: str, hives: int, per_hive: int, seed: int) -> None:
+    rng = random.Random(seed)
+    data = {h: generate(h, per_hive, rng) for h in range(1, hives + 1)}
+    db = sqlite3.connect(db_path)
+    db.executescript(SCHEMA)
+
+    # Interleave hives by time, as ingestion does, so ids are shared
+    order = sorted(((r[1], h, i) for h, rows in data.items() for i, r in enumerate(rows)))
+    sealed = {h: [] for h in data}
+    store = _tsstore.Store(store_dir)
+    cur = db.cursor()
+    for _, h, i in order:
+        r = data[h][i]
+        observed_at = iso(r[1])
+        cur.execute(
+            "INSERT INTO sensor_readings (hive_id, observed_at, ingested_at, weight_kg, temp_c, "
+            "humidity_pct, pressure_hpa, battery_v, sequence, flags, sender_mac) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+            (h, observed_at, observed_at, *r[2:9], MAC),
+        )
+        reading_id = cur.lastrowid
+        bc_id = None
+        if r[9] is not None:
+            cur.execute(
+                "INSERT INTO bee_counts (reading_id, hive_id, observed_at, ingested_at, "
+                "period_ms, bees_in, bees_out, lane_mask, stuck_mask, sequence, flags, "
+                "sender_mac) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+                (reading_id, h, observed_at, observed_at, *r[10:15], r[7], r[8], MAC),
+            )
+            bc_id = cur.lastrowid
+        sealed[h].append((reading_id, r[1], *r[2:9], bc_id, *r[10:15]))
+        if len(sealed[h]) == _tsstore.BLOCK_ROWS:
+            store.append(h, sealed[h])
+            sealed[h] = []
+    for h, rest in sealed.items():
+        if rest:
+            store.append(h, rest)  # Short last block so both sides hold every row
+    db.commit()
+    db.execute("ANALYZE")
+    db.close()
+
+
+# --- Measurement ---
+
+
+def timed(fn, runs: int) -> tuple[float, float]:
+    samples = []
+    for _ in range(runs):
+        start = time.perf_counter()
+        fn()
+        samples.append((time.perf_counter() - start) * 1e6)
+    samples.sort()
+    return statistics.median(samples), samples[int(len(samples) * 0.95) - 1]
+
+
+def sqlite_readings(db, hive_id, start, end, limit, offset):
+    where = "hive_id = ?"
+    params = [hive_id]
+    if start is not None:
+        where += " AND observed_at >= ?"
+        params.append(start)
+    if end is not None:
+        where += " AND observed_at <= ?"
+        params.append(end)
+    total = db.execute(f"SELECT COUNT(*) FROM sensor_readings WHERE {where}", params).fetchone()
+    rows = db.execute(
+        f"SELECT * FROM sensor_readings WHERE {where} "
+        "ORDER BY observed_at DESC LIMIT ? OFFSET ?",
+        [*params, limit, offset],
+    ).fetchall()
+    return total[0], rows
+
+
+def sqlite_traffic(db, hive_id, limit, offset):
+    total = db.execute("SELECT COUNT(*) FROM bee_counts WHERE hive_id = ?", (hive_id,)).fetchone()
+    rows = db.execute(
+        "SELECT id, reading_id, hive_id, observed_at, period_ms, bees_in, bees_out, net_out, "
+        "total_traffic, lane_mask, stuck_mask, flags FROM bee_counts WHERE hive_id = ? "
+        "ORDER BY observed_at ASC LIMIT ? OFFSET ?",
+        (hive_id, limit, offset),
+    ).fetchall()
+    return total[0], rows
+
+
+def footprint(db_path: str, store_dir: str) -> tuple[int, int]:
+    db = sqlite3.connect(db_path)
+    names = (
+        "sensor_readings", "bee_counts", "idx_readings_hive_time", "idx_readings_time",
+        "idx_readings_hive_id", "idx_bee_counts_hive_time",
+        "sqlite_autoindex_sensor_readings_1", "sqlite_autoindex_bee_counts_1",
+    )
+    try:
+        marks = ",".join("?" * len(names))
+        sqlite_bytes = db.execute(
+            f"SELECT SUM(pgsize) FROM dbstat WHERE name IN ({marks})", names
+        ).fetchone()[0]
+    except sqlite3.OperationalError:  # Built without SQLITE_ENABLE_DBSTAT_VTAB
+        sqlite_bytes = os.path.getsize(db_path)
+    db.close()
+    store_bytes = sum(f.stat().st_size for f in Path(store_dir).glob("hive_*.wts"))
+    return sqlite_bytes, store_bytes
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--hives", type=int, default=10)
+    parser.add_argument("--days", type=int, default=30)
+    parser.add_argument("--runs", type=int, default=200, help="timed runs per query")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    per_hive = args.days * 1440
+    with tempfile.TemporaryDirectory() as tmp:
+        db_path = os.path.join(tmp, "bench.db")
+        store_dir = os.path.join(tmp, "tsstore")
+        os.makedirs(store_dir)
+        start = time.perf_counter()
+        populate(db_path, store_dir, args.hives, per_hive, args.seed)
+        rows = args.hives * per_hive
+        print(f"{rows} readings ({args.hives} hives x {args.days} days) in "
+              f"{time.perf_counter() - start:.1f} s; decoder {_tsstore.DECODER}")
+
+        sqlite_bytes, store_bytes = footprint(db_path, store_dir)
+        print(f"  footprint  sqlite {sqlite_bytes / 1e6:8.2f} MB"
+              f" ({sqlite_bytes / rows:6.1f} B/row)"
+              f"   store {store_bytes / 1e6:8.2f} MB ({store_bytes / rows:6.1f} B/row)"
+              f"   {sqlite_bytes / store_bytes:.1f}x smaller")
+
+        db = sqlite3.connect(db_path)
+        store = _tsstore.Store(store_dir)
+        hive = 2  # Has traffic
+        mid_day = iso(T0_MS + args.days // 2 * 86_400_000)[:10]
+        day_lo = int(datetime.fromisoformat(mid_day).replace(tzinfo=UTC).timestamp() * 1000)
+        cases = {
+            "latest": (
+                lambda: sqlite_readings(db, hive, None, None, 100, 0),
+                lambda: store.readings(hive, -(2**62), 2**62, 0, 100),
+            ),
+            "day": (
+                lambda: sqlite_readings(db, hive, mid_day, mid_day + "T23:59:59.999Z", 100, 0),
+                lambda: store.readings(hive, day_lo, day_lo + 86_399_999, 0, 100),
+            ),
+            "deep": (
+                lambda: sqlite_readings(db, hive, None, None, 100, per_hive // 2),
+                lambda: store.readings(hive, -(2**62), 2**62, per_hive // 2, 100),
+            ),
+            "traffic": (
+                lambda: sqlite_traffic(db, hive, 100, 0),
+                lambda: store.traffic(hive, -(2**62), 2**62, 0, 100),
+            ),
+        }
+        header = f"{'sqlite p50':>11s} {'p95':>9s} {'store p50':>11s} {'p95':>9s}"
+        print(f"  {'query':8s} {header}  (us)")
+        for name, (via_sqlite, via_store) in cases.items():
+            assert via_sqlite()[0] == via_store()[0], name  # Same totals
+            s50, s95 = timed(via_sqlite, args.runs)
+            t50, t95 = timed(via_store, args.runs)
+            print(f"  {name:8s} {s50:11.1f} {s95:9.1f} {t50:11.1f} {t95:9.1f}  {s50 / t50:5.1f}x")
+        db.close()
+
+
+if __name__ == "__main__":
+    main()
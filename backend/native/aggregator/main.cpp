@@ -0,0 +1,555 @@
+/**
+ * Waggle Hub — aggregator: one clean frame stream from several bridges.
+ *
+ * An apiary covered by more than one bridge hears most ESP-NOW packets
+ * several times.  The aggregator reads every bridge's serial port in one
+ * epoll loop, stamps each read with its receive time, and forwards the
+ * first copy of each distinct packet (same MAC + payload, ignoring the
+ * Phase 2 latency trace) immediately to a single output — a pty that the
+ * bridge service or ingestd opens in place of /dev/ttyUSB0, or a file.
+ * Later copies from other bridges only update statistics: which bridges
+ * hear each node, with what RSSI (bridges built with env:bridge-rssi
+ * append it), and which bridge had the strongest copy.
+ *
+ * Output frames are always the standard [COBS(MAC + payload)][0x00] so the
+ * hub decoders need no changes; thermal array frames (msg_type 0x04) are
+ * deduplicated and forwarded like readings.  Frames failing the CRC or
+ * length checks are dropped and counted per bridge.  Memory is fixed at
+ * start-up by --table-size (packets remembered for --dedup-ms) and
+ * --max-nodes.
+ *
+ * Build: make -C backend/native aggregator
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "cobs.h"
+#include "frame_decoder.h"
+#include "host_io.h"
+#include "node_stats.h"
+#include "packet_table.h"
+#include "payload.h"
+
+static constexpr size_t   READ_SIZE     = 4096;
+static constexpr size_t   MAX_PENDING   = 256;    // Partial frame without delimiter
+static constexpr size_t   FRAME_MAX     = 64;     // Decoded frame buffer
+static constexpr size_t   OUT_QUEUE_MAX = 65536;  // Unread output before dropping
+static constexpr uint64_t REOPEN_NS     = 2000000000ULL;
+static constexpr uint32_t OUTPUT_TAG    = 0xFFFFFFFFu;
+
+// [MAC][payload][rssi] from bridges built with env:bridge-rssi
+static constexpr size_t RSSI_FRAME_P1 = FRAME_MAC_LEN + PAYLOAD_SIZE + 1;     // 39
+static constexpr size_t RSSI_FRAME_P2 = FRAME_MAC_LEN + PAYLOAD_SIZE_V2 + 1;  // 55
+static constexpr size_t RSSI_FRAME_THERMAL = FRAME_MAC_LEN + PAYLOAD_SIZE_THERMAL + 1;  // 51
+
+// ---- Options ----
+
+struct Options {
+    std::vector<std::string> names;
+    std::vector<std::string> devices;
+    const char* link        = nullptr;
+    const char* out         = nullptr;
+    const char* stats_json  = nullptr;
+    uint32_t    baud        = 115200;
+    uint32_t    dedup_ms    = 1000;
+    uint32_t    table_size  = 4096;
+    uint32_t    max_nodes   = 512;
+    uint32_t    stats_s     = 30;
+};
+
+// ---- State ----
+
+struct Bridge {
+    std::string          name;
+    std::string          device;
+    int                  fd;
+    uint64_t             next_open_ns;
+    std::vector<uint8_t> buf;
+    uint64_t             bytes;
+    uint64_t             frames;      // Valid frames received (readings and thermal)
+    uint64_t             invalid;     // Failed COBS / length / CRC / msg_type
+    uint64_t             first;       // Copies forwarded (heard here first)
+    uint64_t             duplicates;  // Copies another bridge delivered first
+    uint64_t             repeats;     // Same packet twice from this bridge
+    uint64_t             reconnects;
+};
+
+struct Aggregator {
+    Options               opt;
+    std::vector<Bridge>   bridges;
+    PacketTable*          table = nullptr;
+    NodeTable*            nodes = nullptr;
+    int                   epfd = -1;
+    int                   out_fd = -1;
+    bool                  out_is_pty = false;
+    bool                  out_watching = false;
+    std::vector<uint8_t>  out_queue;    // Bytes the pty reader hasn't taken yet
+    uint64_t              emitted = 0;
+    uint64_t              duplicates = 0;
+    uint64_t              out_dropped = 0;
+    uint64_t              heard_by[MAX_BRIDGES + 1] = {};  // Packets by copy count
+    uint64_t              start_ns = 0;
+};
+
+static volatile sig_atomic_t s_stop = 0;
+
+static void on_signal(int) {
+    s_stop = 1;
+}
+
+// FNV-1a over MAC + payload: identical packets from different bridges.
+// A Phase 2 latency trace is left out — each bridge stamps its own receive
+// time into it and the node rewrites it on every retry, outside the CRC.
+static uint64_t packet_key(const uint8_t* frame, size_t len) {
+    size_t trace_start = len;
+    size_t trace_end = len;
+    if (len == FRAME_MAC_LEN + PAYLOAD_SIZE_V2) {
+        trace_start = FRAME_MAC_LEN + TRACE_OFFSET;
+        trace_end = trace_start + sizeof(payload_trace_t);
+    }
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; i++) {
+        if (i >= trace_start && i < trace_end) {
+            continue;
+        }
+        h ^= frame[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// ---- Output ----
+
+static void out_watch(Aggregator* a, bool on) {
+    if (a->out_watching == on || !a->out_is_pty) {
+        return;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = on ? (uint32_t)EPOLLOUT : 0u;
+    ev.data.u32 = OUTPUT_TAG;
+    epoll_ctl(a->epfd, EPOLL_CTL_MOD, a->out_fd, &ev);
+    a->out_watching = on;
+}
+
+static void out_flush(Aggregator* a) {
+    while (!a->out_queue.empty()) {
+        ssize_t n = write(a->out_fd, a->out_queue.data(), a->out_queue.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                perror("write output");
+            }
+            break;
+        }
+        a->out_queue.erase(a->out_queue.begin(), a->out_queue.begin() + n);
+    }
+    out_watch(a, !a->out_queue.empty());
+}
+
+static void emit(Aggregator* a, const uint8_t* frame, size_t len) {
+    uint8_t wire[FRAME_MAX + 8];
+    size_t n = cobs_encode(frame, len, wire);
+    wire[n++] = 0x00;
+    if (a->out_queue.size() + n > OUT_QUEUE_MAX) {
+        a->out_dropped++;  // Consumer not reading; keep the newest data out
+        return;
+    }
+    a->out_queue.insert(a->out_queue.end(), wire, wire + n);
+    out_flush(a);
+    a->emitted++;
+}
+
+// ---- Packets ----
+
+static void retire(Aggregator* a, const PacketEntry& e) {
+    a->heard_by[e.copies <= MAX_BRIDGES ? e.copies : MAX_BRIDGES]++;
+    NodeStats* node = a->nodes->find(e.mac);
+    if (node != nullptr) {
+        node->packets++;
+        node->bridges[e.best_bridge].best++;
+    }
+}
+
+static void on_frame(Aggregator* a, uint8_t b, uint8_t* frame, size_t n, uint64_t rx_ns) {
+    Bridge& br = a->bridges[b];
+
+    int8_t rssi = RSSI_UNKNOWN;
+    if (n == RSSI_FRAME_P1 || n == RSSI_FRAME_P2 || n == RSSI_FRAME_THERMAL) {
+        rssi = (int8_t)frame[--n];
+    }
+    DecodedFrame df;
+    FrameStatus st = frame_parse(frame, n, &df);
+    if (st != FRAME_OK && st != FRAME_THERMAL) {
+        br.invalid++;
+        return;
+    }
+    br.frames++;
+
+    bool is_new = false;
+    PacketEntry* e = a->table->find_or_insert(
+        packet_key(frame, n), rx_ns, &is_new, [a](const PacketEntry& old) { retire(a, old); });
+    uint16_t bit = (uint16_t)(1u << b);
+    if (is_new) {
+        memcpy(e->mac, df.mac, sizeof(e->mac));
+        e->first_bridge = b;
+        e->best_bridge = b;
+        e->best_rssi = rssi;
+        br.first++;
+        emit(a, frame, n);
+    } else if (e->bridge_mask & bit) {
+        br.repeats++;  // Bridge or node retransmission, not a second receiver
+        return;
+    } else {
+        br.duplicates++;
+        a->duplicates++;
+        if (rssi != RSSI_UNKNOWN && (e->best_rssi == RSSI_UNKNOWN || rssi > e->best_rssi)) {
+            e->best_bridge = b;
+            e->best_rssi = rssi;
+        }
+    }
+    e->bridge_mask |= bit;
+    e->copies++;
+
+    NodeStats* node = a->nodes->get(df.mac, rx_ns);
+    node->hive_id = df.hive_id;
+    NodeBridgeStats& nb = node->bridges[b];
+    nb.copies++;
+    if (rssi != RSSI_UNKNOWN) {
+        if (nb.rssi_n == 0 || rssi > nb.rssi_best) {
+            nb.rssi_best = rssi;
+        }
+        nb.rssi_n++;
+        nb.rssi_sum += rssi;
+    }
+}
+
+static void on_bytes(Aggregator* a, uint8_t b, uint64_t rx_ns) {
+    std::vector<uint8_t>& buf = a->bridges[b].buf;
+    size_t start = 0;
+    for (;;) {
+        const uint8_t* end = (const uint8_t*)memchr(buf.data() + start, 0, buf.size() - start);
+        if (end == nullptr) {
+            break;
+        }
+        size_t len = (size_t)(end - (buf.data() + start));
+        if (len > 0) {
+            uint8_t frame[FRAME_MAX];
+            size_t n = len <= FRAME_MAX + 1
+                           ? cobs_decode(buf.data() + start, len, frame, sizeof(frame))
+                           : 0;
+            if (n == 0) {
+                a->bridges[b].invalid++;
+            } else {
+                on_frame(a, b, frame, n, rx_ns);
+            }
+        }
+        start += len + 1;
+    }
+    buf.erase(buf.begin(), buf.begin() + start);
+    if (buf.size() > MAX_PENDING) {
+        buf.clear();  // Line noise without a delimiter
+    }
+}
+
+// ---- Bridges ----
+
+static void bridge_open(Aggregator* a, uint32_t b) {
+    Bridge& br = a->bridges[b];
+    br.fd = open(br.device.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (br.fd < 0) {
+        br.next_open_ns = host_mono_ns() + REOPEN_NS;
+        return;
+    }
+    if (isatty(br.fd) && !host_tty_raw(br.fd, a->opt.baud)) {
+        fprintf(stderr, "W %s: cannot set raw mode\n", br.device.c_str());
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = b;
+    if (epoll_ctl(a->epfd, EPOLL_CTL_ADD, br.fd, &ev) != 0) {
+        // Regular files can't be polled; name a pty or serial device
+        fprintf(stderr, "E %s: %s\n", br.device.c_str(), strerror(errno));
+        close(br.fd);
+        br.fd = -1;
+        br.next_open_ns = UINT64_MAX;
+        return;
+    }
+    br.buf.clear();
+    fprintf(stderr, "I bridge %s: reading %s\n", br.name.c_str(), br.device.c_str());
+}
+
+static void bridge_readable(Aggregator* a, uint32_t b) {
+    Bridge& br = a->bridges[b];
+    for (;;) {
+        size_t old = br.buf.size();
+        br.buf.resize(old + READ_SIZE);
+        ssize_t n = read(br.fd, br.buf.data() + old, READ_SIZE);
+        br.buf.resize(old + (n > 0 ? (size_t)n : 0));
+        if (n > 0) {
+            br.bytes += (uint64_t)n;
+            on_bytes(a, (uint8_t)b, host_mono_ns());
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+        fprintf(stderr, "W bridge %s: %s, reopening\n", br.name.c_str(),
+                n == 0 ? "closed" : strerror(errno));
+        epoll_ctl(a->epfd, EPOLL_CTL_DEL, br.fd, nullptr);
+        close(br.fd);
+        br.fd = -1;
+        br.reconnects++;
+        br.next_open_ns = host_mono_ns() + REOPEN_NS;
+        return;
+    }
+}
+
+// ---- Statistics ----
+
+static void print_stats(const Aggregator& a) {
+    double up = (host_mono_ns() - a.start_ns) / 1e9;
+    fprintf(stderr, "I %.0f s: forwarded %llu, duplicates %llu, out dropped %llu, nodes evicted %llu\n",
+            up, (unsigned long long)a.emitted, (unsigned long long)a.duplicates,
+            (unsigned long long)a.out_dropped, (unsigned long long)a.nodes->evicted());
+    for (const Bridge& br : a.bridges) {
+        fprintf(stderr, "  %-12s %s frames %llu first %llu dup %llu repeat %llu invalid %llu\n",
+                br.name.c_str(), br.fd >= 0 ? "up  " : "down", (unsigned long long)br.frames,
+                (unsigned long long)br.first, (unsigned long long)br.duplicates,
+                (unsigned long long)br.repeats, (unsigned long long)br.invalid);
+    }
+}
+
+static void write_stats_json(const Aggregator& a) {
+    std::string tmp = std::string(a.opt.stats_json) + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "w");
+    if (f == nullptr) {
+        perror(tmp.c_str());
+        return;
+    }
+    fprintf(f, "{\"uptime_s\":%.1f,\"forwarded\":%llu,\"duplicates\":%llu,"
+               "\"out_dropped\":%llu,\"packets_in_window\":%u,\"heard_by\":[",
+            (host_mono_ns() - a.start_ns) / 1e9, (unsigned long long)a.emitted,
+            (unsigned long long)a.duplicates, (unsigned long long)a.out_dropped,
+            a.table->size());
+    for (size_t k = 1; k <= a.bridges.size(); k++) {
+        fprintf(f, "%s%llu", k > 1 ? "," : "", (unsigned long long)a.heard_by[k]);
+    }
+    fprintf(f, "],\"bridges\":[");
+    for (size_t b = 0; b < a.bridges.size(); b++) {
+        const Bridge& br = a.bridges[b];
+        fprintf(f, "%s{\"name\":\"%s\",\"device\":\"%s\",\"connected\":%s,\"bytes\":%llu,"
+                   "\"frames\":%llu,\"first\":%llu,\"duplicates\":%llu,\"repeats\":%llu,"
+                   "\"invalid\":%llu,\"reconnects\":%llu}",
+                b ? "," : "", br.name.c_str(), br.device.c_str(), br.fd >= 0 ? "true" : "false",
+                (unsigned long long)br.bytes, (unsigned long long)br.frames,
+                (unsigned long long)br.first, (unsigned long long)br.duplicates,
+                (unsigned long long)br.repeats, (unsigned long long)br.invalid,
+                (unsigned long long)br.reconnects);
+    }
+    fprintf(f, "],\"nodes\":[");
+    bool first_node = true;
+    uint64_t now = host_mono_ns();
+    for (const NodeStats& n : a.nodes->nodes()) {
+        if (!n.used) {
+            continue;
+        }
+        fprintf(f, "%s{\"mac\":\"%02X:%02X:%02X:%02X:%02X:%02X\",\"hive_id\":%u,"
+                   "\"last_heard_s\":%.1f,\"packets\":%u,\"bridges\":{",
+                first_node ? "" : ",", n.mac[0], n.mac[1], n.mac[2], n.mac[3], n.mac[4],
+                n.mac[5], n.hive_id, (now - n.last_heard_ns) / 1e9, n.packets);
+        first_node = false;
+        bool first_bridge = true;
+        for (size_t b = 0; b < a.bridges.size(); b++) {
+            const NodeBridgeStats& nb = n.bridges[b];
+            if (nb.copies == 0) {
+                continue;
+            }
+            fprintf(f, "%s\"%s\":{\"copies\":%u,\"best\":%u", first_bridge ? "" : ",",
+                    a.bridges[b].name.c_str(), nb.copies, nb.best);
+            if (nb.rssi_n > 0) {
+                fprintf(f, ",\"rssi_avg\":%.1f,\"rssi_best\":%d",
+                        (double)nb.rssi_sum / nb.rssi_n, nb.rssi_best);
+            }
+            fprintf(f, "}");
+            first_bridge = false;
+        }
+        fprintf(f, "}}");
+    }
+    fprintf(f, "]}\n");
+    if (fclose(f) != 0 || rename(tmp.c_str(), a.opt.stats_json) != 0) {
+        perror(a.opt.stats_json);
+    }
+}
+
+// ---- Main ----
+
+static void usage() {
+    fprintf(stderr,
+        "usage: aggregator --bridge [NAME=]DEV [--bridge ...] (--link PATH | --out FILE)\n"
+        "                  [--baud N] [--dedup-ms N] [--table-size N] [--max-nodes N]\n"
+        "                  [--stats-json PATH] [--stats-s N]\n"
+        "  --link PATH      pty for the hub (bridge service / ingestd SERIAL_DEVICE)\n"
+        "  --out FILE       write the merged stream to a file ('-' = stdout)\n"
+        "  --dedup-ms N     window in which copies count as the same packet (1000)\n"
+        "  --table-size N   packets remembered within the window (4096)\n"
+        "  --max-nodes N    sensor nodes with reception stats (512)\n"
+        "  --stats-json P   rewrite reception stats to P every --stats-s (30)\n");
+    exit(2);
+}
+
+static void parse_args(int argc, char** argv, Options* opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+        }
+        const char* v = argv[++i];
+        if (strcmp(a, "--bridge") == 0) {
+            std::string spec = v;
+            size_t eq = spec.find('=');
+            std::string dev = eq == std::string::npos ? spec : spec.substr(eq + 1);
+            std::string name = eq == std::string::npos ? dev.substr(dev.rfind('/') + 1)
+                                                       : spec.substr(0, eq);
+            opt->names.push_back(name);
+            opt->devices.push_back(dev);
+        }
+        else if (strcmp(a, "--link") == 0)       opt->link = v;
+        else if (strcmp(a, "--out") == 0)        opt->out = v;
+        else if (strcmp(a, "--stats-json") == 0) opt->stats_json = v;
+        else if (strcmp(a, "--baud") == 0)       opt->baud = (uint32_t)atol(v);
+        else if (strcmp(a, "--dedup-ms") == 0)   opt->dedup_ms = (uint32_t)atol(v);
+        else if (strcmp(a, "--table-size") == 0) opt->table_size = (uint32_t)atol(v);
+        else if (strcmp(a, "--max-nodes") == 0)  opt->max_nodes = (uint32_t)atol(v);
+        else if (strcmp(a, "--stats-s") == 0)    opt->stats_s = (uint32_t)atol(v);
+        else usage();
+    }
+    if (opt->devices.empty() || opt->devices.size() > (size_t)MAX_BRIDGES ||
+        (opt->link == nullptr) == (opt->out == nullptr) || opt->table_size == 0 ||
+        opt->max_nodes == 0) {
+        usage();
+    }
+}
+
+int main(int argc, char** argv) {
+    Aggregator a;
+    parse_args(argc, argv, &a.opt);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    PacketTable table(a.opt.table_size, a.opt.dedup_ms * 1000000ULL);
+    NodeTable nodes(a.opt.max_nodes);
+    a.table = &table;
+    a.nodes = &nodes;
+    a.epfd = epoll_create1(EPOLL_CLOEXEC);
+    a.start_ns = host_mono_ns();
+
+    int slave_fd = -1;
+    if (a.opt.link != nullptr) {
+        char slave[64];
+        a.out_fd = host_open_pty(a.opt.link, slave, sizeof(slave), &slave_fd);
+        if (a.out_fd < 0) {
+            return 1;
+        }
+        fcntl(a.out_fd, F_SETFL, fcntl(a.out_fd, F_GETFL) | O_NONBLOCK);
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.data.u32 = OUTPUT_TAG;
+        epoll_ctl(a.epfd, EPOLL_CTL_ADD, a.out_fd, &ev);
+        a.out_is_pty = true;
+        fprintf(stderr, "I output %s -> %s\n", a.opt.link, slave);
+    } else {
+        a.out_fd = strcmp(a.opt.out, "-") == 0
+                       ? STDOUT_FILENO
+                       : open(a.opt.out, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (a.out_fd < 0) {
+            perror(a.opt.out);
+            return 1;
+        }
+    }
+
+    for (size_t b = 0; b < a.opt.devices.size(); b++) {
+        Bridge br = Bridge();
+        br.name = a.opt.names[b];
+        br.device = a.opt.devices[b];
+        br.fd = -1;
+        a.bridges.push_back(br);
+    }
+    for (uint32_t b = 0; b < a.bridges.size(); b++) {
+        bridge_open(&a, b);
+    }
+
+    uint64_t next_stats =
+        a.opt.stats_s > 0 ? a.start_ns + a.opt.stats_s * 1000000000ULL : UINT64_MAX;
+    auto retire_cb = [&a](const PacketEntry& e) { retire(&a, e); };
+    while (!s_stop) {
+        uint64_t now = host_mono_ns();
+        uint64_t wake = next_stats;
+        if (table.size() > 0) {
+            uint64_t due = table.oldest_ns() + a.opt.dedup_ms * 1000000ULL;
+            wake = due < wake ? due : wake;
+        }
+        for (const Bridge& br : a.bridges) {
+            if (br.fd < 0 && br.next_open_ns < wake) {
+                wake = br.next_open_ns;
+            }
+        }
+        uint64_t wait_ms = wake > now ? (wake - now + 999999) / 1000000 : 0;
+        int timeout = wait_ms < 1000 ? (int)wait_ms : 1000;
+
+        struct epoll_event events[MAX_BRIDGES + 1];
+        int n = epoll_wait(a.epfd, events, MAX_BRIDGES + 1, timeout);
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.u32 == OUTPUT_TAG) {
+                out_flush(&a);
+            } else if (a.bridges[events[i].data.u32].fd >= 0) {
+                bridge_readable(&a, events[i].data.u32);
+            }
+        }
+
+        now = host_mono_ns();
+        table.expire(now, retire_cb);
+        for (uint32_t b = 0; b < a.bridges.size(); b++) {
+            if (a.bridges[b].fd < 0 && now >= a.bridges[b].next_open_ns) {
+                bridge_open(&a, b);
+            }
+        }
+        if (now >= next_stats) {
+            print_stats(a);
+            if (a.opt.stats_json != nullptr) {
+                write_stats_json(a);
+            }
+            next_stats = now + a.opt.stats_s * 1000000000ULL;
+        }
+    }
+
+    table.expire(UINT64_MAX, retire_cb);
+    print_stats(a);
+    if (a.opt.stats_json != nullptr) {
+        write_stats_json(a);
+    }
+    if (a.opt.link != nullptr) {
+        unlink(a.opt.link);
+        close(slave_fd);
+    }
+    return 0;
+}
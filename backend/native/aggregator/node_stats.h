@@ -0,0 +1,93 @@
+/**
+ * Waggle Hub — aggregator per-node reception statistics.
+ *
+ * For each sensor node (sender MAC): packets heard, and per bridge the
+ * copies received, RSSI average / best, and how often that bridge had the
+ * strongest copy.  A fixed table of max_nodes entries; when it is full the
+ * node heard least recently is replaced.  Lookups scan linearly, which is
+ * cheap at ESP-NOW packet rates for a few hundred nodes.
+ */
+
+#ifndef WAGGLE_AGGREGATOR_NODE_STATS_H
+#define WAGGLE_AGGREGATOR_NODE_STATS_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+static constexpr int MAX_BRIDGES = 16;  // PacketEntry::bridge_mask width
+
+struct NodeBridgeStats {
+    uint32_t copies;
+    uint32_t rssi_n;      // Copies that carried an RSSI
+    int32_t  rssi_sum;
+    int8_t   rssi_best;
+    uint32_t best;        // Packets where this bridge had the strongest copy
+};
+
+struct NodeStats {
+    uint8_t         mac[6];
+    uint8_t         hive_id;
+    bool            used;
+    uint64_t        last_heard_ns;
+    uint32_t        packets;  // Distinct packets
+    NodeBridgeStats bridges[MAX_BRIDGES];
+};
+
+class NodeTable {
+public:
+    explicit NodeTable(uint32_t max_nodes) : _nodes(max_nodes), _evicted(0) {
+        memset(_nodes.data(), 0, _nodes.size() * sizeof(NodeStats));
+    }
+
+    /** Stats for mac, creating (or recycling) an entry if needed. */
+    NodeStats* get(const uint8_t mac[6], uint64_t now_ns) {
+        NodeStats* free_slot = nullptr;
+        NodeStats* lru = nullptr;
+        for (NodeStats& n : _nodes) {
+            if (!n.used) {
+                if (free_slot == nullptr) {
+                    free_slot = &n;
+                }
+                continue;
+            }
+            if (memcmp(n.mac, mac, 6) == 0) {
+                n.last_heard_ns = now_ns;
+                return &n;
+            }
+            if (lru == nullptr || n.last_heard_ns < lru->last_heard_ns) {
+                lru = &n;
+            }
+        }
+        NodeStats* n = free_slot;
+        if (n == nullptr) {
+            n = lru;
+            _evicted++;
+        }
+        memset(n, 0, sizeof(*n));
+        memcpy(n->mac, mac, 6);
+        n->used = true;
+        n->last_heard_ns = now_ns;
+        return n;
+    }
+
+    /** Existing stats for mac, or nullptr. */
+    NodeStats* find(const uint8_t mac[6]) {
+        for (NodeStats& n : _nodes) {
+            if (n.used && memcmp(n.mac, mac, 6) == 0) {
+                return &n;
+            }
+        }
+        return nullptr;
+    }
+
+    const std::vector<NodeStats>& nodes() const { return _nodes; }
+    uint64_t evicted() const { return _evicted; }
+
+private:
+    std::vector<NodeStats> _nodes;
+    uint64_t               _evicted;
+};
+
+#endif  // WAGGLE_AGGREGATOR_NODE_STATS_H
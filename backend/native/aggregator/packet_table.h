@@ -0,0 +1,140 @@
+/**
+ * Waggle Hub — aggregator packet table.
+ *
+ * Remembers every distinct packet (hash of MAC + payload) for a short
+ * window so copies forwarded by other bridges are recognised.  Entries live
+ * in a fixed ring in arrival order, with an open-addressing hash index
+ * (twice the ring size, linear probing, backward-shift deletion) on top.
+ * Expiry pops from the ring tail; when the ring is full the oldest entry
+ * is retired early.  Memory is fixed at construction.
+ */
+
+#ifndef WAGGLE_AGGREGATOR_PACKET_TABLE_H
+#define WAGGLE_AGGREGATOR_PACKET_TABLE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+static constexpr int8_t RSSI_UNKNOWN = 0;  // Bridge built without the trailer
+
+struct PacketEntry {
+    uint64_t key;
+    uint64_t first_rx_ns;   // Receive time of the first copy
+    uint16_t bridge_mask;   // Bridges that delivered a copy
+    uint8_t  first_bridge;
+    uint8_t  best_bridge;   // Strongest copy so far (first copy if no RSSI)
+    int8_t   best_rssi;
+    uint8_t  copies;
+    uint8_t  mac[6];
+};
+
+class PacketTable {
+public:
+    /** capacity is rounded up to a power of two. */
+    PacketTable(uint32_t capacity, uint64_t ttl_ns) : _ttl_ns(ttl_ns), _head(0), _count(0) {
+        uint32_t cap = 1;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        _ring.resize(cap);
+        _index.assign(cap * 2, 0);
+    }
+
+    /**
+     * Find the entry for key, or create it (*is_new = true).  Creating an
+     * entry in a full table first retires the oldest one through retire().
+     */
+    template <typename Retire>
+    PacketEntry* find_or_insert(uint64_t key, uint64_t now_ns, bool* is_new, Retire retire) {
+        uint32_t mask = (uint32_t)_index.size() - 1;
+        for (uint32_t i = slot_of(key);; i = (i + 1) & mask) {
+            uint32_t ref = _index[i];
+            if (ref == 0) {
+                break;
+            }
+            if (_ring[ref - 1].key == key) {
+                *is_new = false;
+                return &_ring[ref - 1];
+            }
+        }
+
+        if (_count == _ring.size()) {
+            retire(_ring[tail()]);
+            pop_tail();
+        }
+        uint32_t pos = _head;
+        _head = (_head + 1) & ((uint32_t)_ring.size() - 1);
+        _count++;
+
+        PacketEntry& e = _ring[pos];
+        memset(&e, 0, sizeof(e));
+        e.key = key;
+        e.first_rx_ns = now_ns;
+        index_insert(key, pos);
+        *is_new = true;
+        return &e;
+    }
+
+    /** Retire entries older than the TTL, oldest first. */
+    template <typename Retire>
+    void expire(uint64_t now_ns, Retire retire) {
+        while (_count > 0 && now_ns - _ring[tail()].first_rx_ns >= _ttl_ns) {
+            retire(_ring[tail()]);
+            pop_tail();
+        }
+    }
+
+    /** Receive time of the oldest live entry, or 0 when empty. */
+    uint64_t oldest_ns() const { return _count > 0 ? _ring[tail()].first_rx_ns : 0; }
+
+    uint32_t size() const { return _count; }
+    uint32_t capacity() const { return (uint32_t)_ring.size(); }
+
+private:
+    uint32_t tail() const { return (_head - _count) & ((uint32_t)_ring.size() - 1); }
+
+    uint32_t slot_of(uint64_t key) const {
+        // Keys are already hashes; fold the high bits in for small tables
+        return (uint32_t)(key ^ (key >> 32)) & ((uint32_t)_index.size() - 1);
+    }
+
+    void index_insert(uint64_t key, uint32_t pos) {
+        uint32_t mask = (uint32_t)_index.size() - 1;
+        uint32_t i = slot_of(key);
+        while (_index[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        _index[i] = pos + 1;
+    }
+
+    void pop_tail() {
+        uint32_t pos = tail();
+        uint32_t mask = (uint32_t)_index.size() - 1;
+        uint32_t i = slot_of(_ring[pos].key);
+        while (_index[i] != pos + 1) {
+            i = (i + 1) & mask;
+        }
+        // Backward-shift deletion keeps probe chains intact without tombstones
+        uint32_t hole = i;
+        for (uint32_t j = (i + 1) & mask; _index[j] != 0; j = (j + 1) & mask) {
+            uint32_t home = slot_of(_ring[_index[j] - 1].key);
+            bool movable = hole <= j ? (home <= hole || home > j) : (home <= hole && home > j);
+            if (movable) {
+                _index[hole] = _index[j];
+                hole = j;
+            }
+        }
+        _index[hole] = 0;
+        _count--;
+    }
+
+    uint64_t              _ttl_ns;
+    uint32_t              _head;   // Next ring slot to fill
+    uint32_t              _count;
+    std::vector<PacketEntry> _ring;
+    std::vector<uint32_t> _index;  // Ring position + 1, 0 = empty
+};
+
+#endif  // WAGGLE_AGGREGATOR_PACKET_TABLE_H
@@ -0,0 +1,201 @@
+/**
+ * Waggle Hub — incremental look-back windows for the reading alert rules.
+ *
+ * The thresholds mirror the SQL in AlertEngine (alert_engine.py); the
+ * replay tests (tests/test_alert_stream.py) run both over the same readings.
+ */
+
+#include "hive_windows.h"
+
+// ---- Rule thresholds (AlertEngine) ----
+
+static constexpr uint32_t SWARM_WEIGHT_MIN_ROWS = 5;
+static constexpr double   SWARM_WEIGHT_DROP_KG  = 2.0;
+
+static constexpr uint32_t SWARM_MIN_ROWS    = 30;
+static constexpr double   SWARM_DROP_KG     = 1.5;
+static constexpr int64_t  SWARM_MIN_NET_OUT = 500;
+
+static constexpr uint32_t ABSCOND_MIN_ROWS    = 60;
+static constexpr double   ABSCOND_DROP_KG     = 2.0;
+static constexpr int64_t  ABSCOND_MIN_NET_OUT = 400;
+
+static constexpr uint32_t ROBBING_MIN_ROWS    = 30;
+static constexpr double   ROBBING_DROP_KG     = 0.5;
+static constexpr int64_t  ROBBING_MIN_TRAFFIC = 1000;
+static constexpr int64_t  ROBBING_MAX_NET_OUT = -200;
+
+static constexpr uint32_t LOW_ACTIVITY_MIN_DAY_ROWS = 10;
+static constexpr uint32_t LOW_ACTIVITY_MIN_DAYS     = 3;
+static constexpr double   LOW_ACTIVITY_RATIO        = 0.2;
+
+static int64_t day_of(int64_t t_ms) {
+    int64_t day = t_ms / ALERT_DAY_MS;
+    return (t_ms % ALERT_DAY_MS < 0) ? day - 1 : day;
+}
+
+// ---- Window ----
+
+void HiveWindows::Window::clear() {
+    _rows.clear();
+    _max.clear();
+    _net_out = 0;
+    _total_traffic = 0;
+}
+
+void HiveWindows::Window::push(const Row& r) {
+    if (_rows.empty() || r.t_ms > _latest.t_ms) {
+        _latest = r;
+    }
+    _rows.push_back(r);
+    _net_out += r.net_out;
+    _total_traffic += r.total_traffic;
+    if (r.has_weight) {
+        while (!_max.empty() && _max.back().weight_kg <= r.weight_kg) {
+            _max.pop_back();
+        }
+        _max.push_back(r);
+    }
+}
+
+void HiveWindows::Window::evict(int64_t now_ms) {
+    int64_t cutoff = now_ms - _span_ms;  // Inclusive lower bound, as in SQL
+    while (!_rows.empty() && _rows.front().t_ms < cutoff) {
+        _net_out -= _rows.front().net_out;
+        _total_traffic -= _rows.front().total_traffic;
+        _rows.pop_front();
+    }
+    while (!_max.empty() && _max.front().t_ms < cutoff) {
+        _max.pop_front();
+    }
+}
+
+// ---- HiveWindows ----
+
+HiveWindows::HiveWindows()
+    : _weights_1h(ALERT_HOUR_MS),
+      _traffic_1h(ALERT_HOUR_MS),
+      _eligible_1h(ALERT_HOUR_MS),
+      _eligible_2h(2 * ALERT_HOUR_MS) {
+    clear();
+}
+
+void HiveWindows::clear() {
+    _last_t = INT64_MIN;
+    _weights_1h.clear();
+    _traffic_1h.clear();
+    _eligible_1h.clear();
+    _eligible_2h.clear();
+    for (Day& d : _days) {
+        d.day = INT64_MIN;
+        d.count = 0;
+        d.total_traffic = 0;
+    }
+}
+
+HiveWindows::Day& HiveWindows::day_bucket(int64_t day) {
+    int64_t slot = day % (ALERT_HISTORY_DAYS + 1);
+    Day& d = _days[slot < 0 ? slot + ALERT_HISTORY_DAYS + 1 : slot];
+    if (d.day != day) {
+        d.day = day;
+        d.count = 0;
+        d.total_traffic = 0;
+    }
+    return d;
+}
+
+void HiveWindows::add_day(int64_t day, uint32_t count, int64_t total_traffic) {
+    Day& d = day_bucket(day);
+    d.count += count;
+    d.total_traffic += total_traffic;
+}
+
+bool HiveWindows::add(const AlertSample& s) {
+    if (s.t_ms < _last_t) {
+        return false;
+    }
+    _last_t = s.t_ms;
+
+    Row r;
+    r.t_ms = s.t_ms;
+    r.has_weight = s.has_weight;
+    r.weight_kg = s.has_weight ? s.weight_kg : 0.0;
+    r.net_out = s.has_traffic ? s.bees_out - s.bees_in : 0;
+    r.total_traffic = s.has_traffic ? s.bees_in + s.bees_out : 0;
+
+    _weights_1h.evict(s.t_ms);
+    _traffic_1h.evict(s.t_ms);
+    _eligible_1h.evict(s.t_ms);
+    _eligible_2h.evict(s.t_ms);
+
+    if (s.has_weight) {
+        _weights_1h.push(r);
+    }
+    if (s.has_traffic) {
+        _traffic_1h.push(r);
+        if ((s.flags & ALERT_EXCLUDED_FLAGS) == 0 && s.stuck_mask == 0) {
+            _eligible_1h.push(r);
+            _eligible_2h.push(r);
+            Day& d = day_bucket(day_of(s.t_ms));
+            d.count++;
+            d.total_traffic += r.total_traffic;
+        }
+    }
+    return true;
+}
+
+AlertWindowHit HiveWindows::correlation(const Window& w, uint32_t min_count,
+                                        double min_drop) const {
+    AlertWindowHit h;
+    h.hit = false;
+    h.count = w.count();
+    h.net_out = w.net_out();
+    h.total_traffic = w.total_traffic();
+    h.weight_drop = 0.0;
+    // MAX(weight_kg) - newest weight_kg is NULL when either is missing
+    if (h.count < min_count || !w.has_max() || !w.has_latest_weight()) {
+        return h;
+    }
+    h.weight_drop = w.max_weight() - w.latest_weight();
+    h.hit = h.weight_drop > min_drop;
+    return h;
+}
+
+void HiveWindows::evaluate(bool has_weight, double current_weight, AlertEvaluation* out) const {
+    out->traffic_rows_1h = _traffic_1h.count();
+
+    out->swarm_weight = has_weight && _weights_1h.count() >= SWARM_WEIGHT_MIN_ROWS &&
+                        _weights_1h.max_weight() - current_weight > SWARM_WEIGHT_DROP_KG;
+
+    out->swarm = correlation(_eligible_1h, SWARM_MIN_ROWS, SWARM_DROP_KG);
+    out->swarm.hit = has_weight && out->swarm.hit && out->swarm.net_out > SWARM_MIN_NET_OUT;
+
+    out->absconding = correlation(_eligible_2h, ABSCOND_MIN_ROWS, ABSCOND_DROP_KG);
+    out->absconding.hit =
+        has_weight && out->absconding.hit && out->absconding.net_out > ABSCOND_MIN_NET_OUT;
+
+    out->robbing = correlation(_eligible_1h, ROBBING_MIN_ROWS, ROBBING_DROP_KG);
+    out->robbing.hit = has_weight && out->robbing.hit &&
+                       out->robbing.total_traffic > ROBBING_MIN_TRAFFIC &&
+                       out->robbing.net_out < ROBBING_MAX_NET_OUT;
+
+    // Today's eligible traffic against the average of the previous seven
+    // days that have enough rows to count
+    int64_t today = day_of(_last_t);
+    out->today_traffic = 0;
+    int64_t history_total = 0;
+    uint32_t history_days = 0;
+    for (const Day& d : _days) {
+        if (d.day == today) {
+            out->today_traffic = d.total_traffic;
+        } else if (d.day >= today - ALERT_HISTORY_DAYS && d.day < today &&
+                   d.count >= LOW_ACTIVITY_MIN_DAY_ROWS) {
+            history_total += d.total_traffic;
+            history_days++;
+        }
+    }
+    out->history_days = history_days;
+    out->avg_daily_traffic = history_days ? (double)history_total / history_days : 0.0;
+    out->low_activity = history_days >= LOW_ACTIVITY_MIN_DAYS && out->avg_daily_traffic > 0 &&
+                        (double)out->today_traffic < LOW_ACTIVITY_RATIO * out->avg_daily_traffic;
+}
@@ -0,0 +1,142 @@
+/**
+ * Waggle Hub — incremental look-back windows for the reading alert rules.
+ *
+ * AlertEngine.check_reading (waggle/services/alert_engine.py) evaluates its
+ * swarm, absconding, robbing and low-activity rules with SQL over the hive's
+ * readings in [observed_at - 1h/2h, observed_at] and its daily traffic over
+ * the past week.  HiveWindows keeps the same aggregates for one hive as
+ * readings arrive in observed_at order: each window is a deque of its rows
+ * with running sums and a monotonic deque for the maximum weight, and
+ * traffic is bucketed per UTC day, so adding a reading and evaluating every
+ * rule is O(1) amortised.
+ *
+ * A reading observed before the previous one cannot be added (add() returns
+ * false); the caller evaluates it with SQL and re-seeds the hive.
+ */
+
+#ifndef WAGGLE_HIVE_WINDOWS_H
+#define WAGGLE_HIVE_WINDOWS_H
+
+#include <stdint.h>
+
+#include <deque>
+
+// Reading flags that exclude a row from the correlation rules
+static constexpr uint32_t ALERT_EXCLUDED_FLAGS = 0x02 | 0x40;  // First boot, clamped
+
+static constexpr int64_t ALERT_HOUR_MS = 3600 * 1000;
+static constexpr int64_t ALERT_DAY_MS  = 24 * ALERT_HOUR_MS;
+static constexpr int     ALERT_HISTORY_DAYS = 7;
+
+// One stored reading, with its bee_counts row when it has one
+struct AlertSample {
+    int64_t  t_ms;          // observed_at, ms since the epoch
+    bool     has_weight;
+    double   weight_kg;
+    uint32_t flags;
+    bool     has_traffic;
+    int64_t  bees_in;
+    int64_t  bees_out;
+    uint32_t stuck_mask;
+};
+
+// A correlation rule's SQL row: weight drop, traffic sums and row count
+struct AlertWindowHit {
+    bool     hit;
+    double   weight_drop;
+    int64_t  net_out;
+    int64_t  total_traffic;
+    uint32_t count;
+};
+
+struct AlertEvaluation {
+    uint32_t       traffic_rows_1h;  // bee_counts rows in the last hour, any flags
+    bool           swarm_weight;     // Phase 1 weight-only POSSIBLE_SWARM
+    AlertWindowHit swarm;            // Phase 2 POSSIBLE_SWARM
+    AlertWindowHit absconding;
+    AlertWindowHit robbing;
+    bool           low_activity;
+    int64_t        today_traffic;
+    double         avg_daily_traffic;
+    uint32_t       history_days;
+};
+
+class HiveWindows {
+public:
+    HiveWindows();
+
+    /** Drop every window and day bucket (before seeding again). */
+    void clear();
+
+    /**
+     * Add the eligible traffic totals of one UTC day (day number since the
+     * epoch) for readings older than anything add() will see.
+     */
+    void add_day(int64_t day, uint32_t count, int64_t total_traffic);
+
+    /** Add a reading; false (and nothing changes) if it is out of order. */
+    bool add(const AlertSample& s);
+
+    /**
+     * Evaluate the rules as of the last added reading, whose weight is
+     * current_weight (has_weight false when NULL).
+     */
+    void evaluate(bool has_weight, double current_weight, AlertEvaluation* out) const;
+
+    bool empty() const { return _last_t == INT64_MIN; }
+    int64_t last_t() const { return _last_t; }
+
+private:
+    struct Row {
+        int64_t t_ms;
+        bool    has_weight;
+        double  weight_kg;
+        int64_t net_out;
+        int64_t total_traffic;
+    };
+
+    // Rows in [t - span, t] with running sums and the maximum weight
+    class Window {
+    public:
+        explicit Window(int64_t span_ms) : _span_ms(span_ms) { clear(); }
+        void clear();
+        void push(const Row& r);
+        void evict(int64_t now_ms);
+
+        uint32_t count() const { return (uint32_t)_rows.size(); }
+        int64_t net_out() const { return _net_out; }
+        int64_t total_traffic() const { return _total_traffic; }
+        bool has_max() const { return !_max.empty(); }
+        double max_weight() const { return _max.front().weight_kg; }
+        // Weight of the newest row (the SQL "ORDER BY observed_at DESC LIMIT 1",
+        // which returns the first stored of rows with equal observed_at)
+        bool has_latest_weight() const { return !_rows.empty() && _latest.has_weight; }
+        double latest_weight() const { return _latest.weight_kg; }
+
+    private:
+        int64_t         _span_ms;
+        std::deque<Row> _rows;
+        std::deque<Row> _max;  // Decreasing weights, oldest first
+        Row             _latest;
+        int64_t         _net_out;
+        int64_t         _total_traffic;
+    };
+
+    struct Day {
+        int64_t  day;
+        uint32_t count;
+        int64_t  total_traffic;
+    };
+
+    Day& day_bucket(int64_t day);
+    AlertWindowHit correlation(const Window& w, uint32_t min_count, double min_drop) const;
+
+    int64_t _last_t;
+    Window  _weights_1h;   // Readings with a weight (Phase 1 swarm)
+    Window  _traffic_1h;   // Readings with a bee_counts row, any flags
+    Window  _eligible_1h;  // Traffic rows without excluded flags or stuck lanes
+    Window  _eligible_2h;
+    Day     _days[ALERT_HISTORY_DAYS + 1];  // Ring indexed by day number
+};
+
+#endif  // WAGGLE_HIVE_WINDOWS_H
@@ -0,0 +1,289 @@
+/**
+ * Waggle Hub — waggle._alerts: CPython binding for the alert rule windows.
+ *
+ *   Windows()
+ *     .seed(hive_id, rows, days)     replace the hive's state
+ *     .add(hive_id, row) -> bool     False if observed before the last row
+ *     .evaluate(hive_id, weight_kg) -> (traffic_rows_1h, swarm_weight,
+ *                                       swarm, absconding, robbing,
+ *                                       low_activity)
+ *     .forget(hive_id), .clear(), hive_id in windows
+ *
+ * rows are (t_ms, weight_kg, flags, bees_in, bees_out, stuck_mask) in
+ * observed_at order, with None for a NULL weight and bees_in None when the
+ * reading has no bee_counts row.  days are (day, count, total_traffic) for
+ * eligible traffic older than the first row.  swarm and absconding are
+ * (weight_drop, net_out, count), robbing (weight_drop, total_traffic,
+ * net_out, count) and low_activity (today_total, avg_daily, num_days), or
+ * None when the rule does not fire.  waggle/services/alert_stream.py wraps
+ * this module and is the only caller.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <map>
+
+#include "hive_windows.h"
+
+struct WindowsObject {
+    PyObject_HEAD
+    std::map<int, HiveWindows>* hives;
+};
+
+static constexpr Py_ssize_t ROW_FIELDS = 6;
+
+static PyObject* windows_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {nullptr};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "", (char**)kwlist)) {
+        return nullptr;
+    }
+    WindowsObject* self = (WindowsObject*)type->tp_alloc(type, 0);
+    if (self == nullptr) {
+        return nullptr;
+    }
+    self->hives = new std::map<int, HiveWindows>();
+    return (PyObject*)self;
+}
+
+static void windows_dealloc(WindowsObject* self) {
+    delete self->hives;
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+// ---- rows ----
+
+static bool int_field(PyObject* item, int64_t* out) {
+    long long v = PyLong_AsLongLong(item);
+    if (v == -1 && PyErr_Occurred()) {
+        return false;
+    }
+    *out = (int64_t)v;
+    return true;
+}
+
+static bool sample_from_tuple(PyObject* obj, AlertSample* s) {
+    PyObject* seq = PySequence_Fast(obj, "rows must be tuples");
+    if (seq == nullptr) {
+        return false;
+    }
+    bool ok = false;
+    PyObject** f = PySequence_Fast_ITEMS(seq);
+    int64_t flags = 0, stuck = 0;
+    memset(s, 0, sizeof(*s));
+    if (PySequence_Fast_GET_SIZE(seq) != ROW_FIELDS) {
+        PyErr_Format(PyExc_ValueError, "rows must have %zd fields", ROW_FIELDS);
+        goto done;
+    }
+    if (!int_field(f[0], &s->t_ms) || !int_field(f[2], &flags)) {
+        goto done;
+    }
+    s->flags = (uint32_t)flags;
+    if (f[1] != Py_None) {
+        s->has_weight = true;
+        s->weight_kg = PyFloat_AsDouble(f[1]);
+        if (s->weight_kg == -1.0 && PyErr_Occurred()) {
+            goto done;
+        }
+    }
+    if (f[3] != Py_None) {
+        s->has_traffic = true;
+        if (!int_field(f[3], &s->bees_in) || !int_field(f[4], &s->bees_out) ||
+            !int_field(f[5], &stuck)) {
+            goto done;
+        }
+        s->stuck_mask = (uint32_t)stuck;
+    }
+    ok = true;
+done:
+    Py_DECREF(seq);
+    return ok;
+}
+
+static HiveWindows* find_hive(WindowsObject* self, int hive_id) {
+    auto it = self->hives->find(hive_id);
+    if (it == self->hives->end()) {
+        PyErr_Format(PyExc_KeyError, "hive %d is not seeded", hive_id);
+        return nullptr;
+    }
+    return &it->second;
+}
+
+// ---- methods ----
+
+static PyObject* windows_seed(WindowsObject* self, PyObject* args) {
+    int hive_id;
+    PyObject* rows_obj;
+    PyObject* days_obj;
+    if (!PyArg_ParseTuple(args, "iOO", &hive_id, &rows_obj, &days_obj)) {
+        return nullptr;
+    }
+    PyObject* rows = PySequence_Fast(rows_obj, "rows must be a sequence");
+    if (rows == nullptr) {
+        return nullptr;
+    }
+    PyObject* days = PySequence_Fast(days_obj, "days must be a sequence");
+    if (days == nullptr) {
+        Py_DECREF(rows);
+        return nullptr;
+    }
+
+    HiveWindows w;
+    bool ok = true;
+    for (Py_ssize_t i = 0; ok && i < PySequence_Fast_GET_SIZE(days); i++) {
+        long long day, total;
+        unsigned int count;
+        ok = PyArg_ParseTuple(PySequence_Fast_GET_ITEM(days, i), "LIL", &day, &count, &total);
+        if (ok) {
+            w.add_day(day, count, total);
+        }
+    }
+    for (Py_ssize_t i = 0; ok && i < PySequence_Fast_GET_SIZE(rows); i++) {
+        AlertSample s;
+        ok = sample_from_tuple(PySequence_Fast_GET_ITEM(rows, i), &s);
+        if (ok && !w.add(s)) {
+            PyErr_SetString(PyExc_ValueError, "rows must be in observed_at order");
+            ok = false;
+        }
+    }
+    Py_DECREF(rows);
+    Py_DECREF(days);
+    if (!ok) {
+        return nullptr;
+    }
+    (*self->hives)[hive_id] = w;
+    Py_RETURN_NONE;
+}
+
+static PyObject* windows_add(WindowsObject* self, PyObject* args) {
+    int hive_id;
+    PyObject* row;
+    if (!PyArg_ParseTuple(args, "iO", &hive_id, &row)) {
+        return nullptr;
+    }
+    HiveWindows* w = find_hive(self, hive_id);
+    AlertSample s;
+    if (w == nullptr || !sample_from_tuple(row, &s)) {
+        return nullptr;
+    }
+    return PyBool_FromLong(w->add(s));
+}
+
+static PyObject* window_hit(const AlertWindowHit& h, bool traffic) {
+    if (!h.hit) {
+        Py_RETURN_NONE;
+    }
+    if (traffic) {
+        return Py_BuildValue("(dLLI)", h.weight_drop, (long long)h.total_traffic,
+                             (long long)h.net_out, h.count);
+    }
+    return Py_BuildValue("(dLI)", h.weight_drop, (long long)h.net_out, h.count);
+}
+
+static PyObject* windows_evaluate(WindowsObject* self, PyObject* args) {
+    int hive_id;
+    PyObject* weight_obj;
+    if (!PyArg_ParseTuple(args, "iO", &hive_id, &weight_obj)) {
+        return nullptr;
+    }
+    HiveWindows* w = find_hive(self, hive_id);
+    if (w == nullptr) {
+        return nullptr;
+    }
+    bool has_weight = weight_obj != Py_None;
+    double weight = 0.0;
+    if (has_weight) {
+        weight = PyFloat_AsDouble(weight_obj);
+        if (weight == -1.0 && PyErr_Occurred()) {
+            return nullptr;
+        }
+    }
+
+    AlertEvaluation e;
+    w->evaluate(has_weight, weight, &e);
+    PyObject* low_activity;
+    if (e.low_activity) {
+        low_activity = Py_BuildValue("(LdI)", (long long)e.today_traffic, e.avg_daily_traffic,
+                                     e.history_days);
+    } else {
+        Py_INCREF(Py_None);
+        low_activity = Py_None;
+    }
+    return Py_BuildValue("(INNNNN)", e.traffic_rows_1h, PyBool_FromLong(e.swarm_weight),
+                         window_hit(e.swarm, false), window_hit(e.absconding, false),
+                         window_hit(e.robbing, true), low_activity);
+}
+
+static PyObject* windows_forget(WindowsObject* self, PyObject* args) {
+    int hive_id;
+    if (!PyArg_ParseTuple(args, "i", &hive_id)) {
+        return nullptr;
+    }
+    self->hives->erase(hive_id);
+    Py_RETURN_NONE;
+}
+
+static PyObject* windows_clear(WindowsObject* self, PyObject*) {
+    self->hives->clear();
+    Py_RETURN_NONE;
+}
+
+static int windows_contains(WindowsObject* self, PyObject* key) {
+    long hive_id = PyLong_AsLong(key);
+    if (hive_id == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+    return self->hives->count((int)hive_id) ? 1 : 0;
+}
+
+static PyMethodDef s_windows_methods[] = {
+    {"seed", (PyCFunction)windows_seed, METH_VARARGS,
+     "seed(hive_id, rows, days)\n\nReplace the hive's windows with stored rows."},
+    {"add", (PyCFunction)windows_add, METH_VARARGS,
+     "add(hive_id, row) -> bool\n\nAdd a reading; False if it is out of order."},
+    {"evaluate", (PyCFunction)windows_evaluate, METH_VARARGS,
+     "evaluate(hive_id, weight_kg) -> tuple\n\nRule results as of the last added reading."},
+    {"forget", (PyCFunction)windows_forget, METH_VARARGS,
+     "forget(hive_id)\n\nDrop the hive's windows."},
+    {"clear", (PyCFunction)windows_clear, METH_NOARGS, "clear()\n\nDrop every hive."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+static PySequenceMethods s_windows_sequence = {};
+
+static PyTypeObject s_windows_type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+static struct PyModuleDef s_module = {
+    PyModuleDef_HEAD_INIT, "waggle._alerts",
+    "Incremental look-back windows for the reading alert rules.", -1, nullptr,
+    nullptr, nullptr, nullptr, nullptr,
+};
+
+PyMODINIT_FUNC PyInit__alerts(void) {
+    s_windows_sequence.sq_contains = (objobjproc)windows_contains;
+    s_windows_type.tp_name = "waggle._alerts.Windows";
+    s_windows_type.tp_basicsize = sizeof(WindowsObject);
+    s_windows_type.tp_flags = Py_TPFLAGS_DEFAULT;
+    s_windows_type.tp_doc = "Windows(): per-hive alert rule windows.";
+    s_windows_type.tp_new = windows_new;
+    s_windows_type.tp_dealloc = (destructor)windows_dealloc;
+    s_windows_type.tp_methods = s_windows_methods;
+    s_windows_type.tp_as_sequence = &s_windows_sequence;
+    if (PyType_Ready(&s_windows_type) < 0) {
+        return nullptr;
+    }
+
+    PyObject* m = PyModule_Create(&s_module);
+    if (m == nullptr) {
+        return nullptr;
+    }
+    Py_INCREF(&s_windows_type);
+    if (PyModule_AddObject(m, "Windows", (PyObject*)&s_windows_type) < 0) {
+        Py_DECREF(&s_windows_type);
+        Py_DECREF(m);
+        return nullptr;
+    }
+    return m;
+}
@@ -0,0 +1,155 @@
+/**
+ * Waggle Hub — Native serial frame decoder implementation.
+ *
+ * Payload fields are copied out of the firmware's packed structs with
+ * memcpy, so the decoder is alignment-safe and uses the exact layout the
+ * sensor node transmits (little-endian hosts only — the Pi and x86).
+ */
+
+#include "frame_decoder.h"
+
+#include <string.h>
+
+#include "cobs.h"
+#include "payload.h"
+
+static_assert(sizeof(sensor_payload_t) == PAYLOAD_SIZE, "Phase 1 payload layout");
+static_assert(sizeof(bee_count_payload_t) == PAYLOAD_SIZE_V2, "Phase 2 payload layout");
+static_assert(sizeof(thermal_payload_t) == PAYLOAD_SIZE_THERMAL, "Thermal payload layout");
+
+static constexpr size_t FRAME_LEN_P1 = FRAME_MAC_LEN + PAYLOAD_SIZE;     // 38
+static constexpr size_t FRAME_LEN_P2 = FRAME_MAC_LEN + PAYLOAD_SIZE_V2;  // 54
+static constexpr size_t FRAME_LEN_THERMAL = FRAME_MAC_LEN + PAYLOAD_SIZE_THERMAL;  // 50
+
+// Largest decoded frame we care about; anything longer is a length error
+static constexpr size_t DECODE_MAX = 64;
+
+// True if `cobs` is well-formed COBS, without decoding it (for frames too
+// long to be valid, which are classified but never copied).
+static bool cobs_well_formed(const uint8_t* cobs, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        uint8_t code = cobs[i];
+        if (code == 0 || (size_t)code > len - i) {
+            return false;
+        }
+        i += code;
+    }
+    return len > 0;
+}
+
+FrameStatus frame_decode(const uint8_t* cobs, size_t len, DecodedFrame* out) {
+    if (len > DECODE_MAX + 1) {
+        // Decodes to more than DECODE_MAX bytes if it decodes at all
+        return cobs_well_formed(cobs, len) ? FRAME_BAD_LENGTH : FRAME_BAD_COBS;
+    }
+    uint8_t frame[DECODE_MAX];
+    size_t n = cobs_decode(cobs, len, frame, sizeof(frame));
+    if (n == 0) {
+        // 0 is also the valid decoding of e.g. {0x01}: an empty frame
+        return cobs_well_formed(cobs, len) ? FRAME_BAD_LENGTH : FRAME_BAD_COBS;
+    }
+    return frame_parse(frame, n, out);
+}
+
+// Thermal array frames carry no reading; check them and pick out who sent them
+static FrameStatus thermal_parse(const uint8_t* frame, DecodedFrame* out) {
+    thermal_payload_t p;
+    memcpy(&p, frame + FRAME_MAC_LEN, sizeof(p));
+    if (crc8((const uint8_t*)&p, PAYLOAD_SIZE_THERMAL - 1) != p.crc) {
+        return FRAME_BAD_CRC;
+    }
+    if (p.msg_type != MSG_TYPE_THERMAL || p.probe_count > THERMAL_MAX_PROBES) {
+        return FRAME_BAD_MSG_TYPE;
+    }
+    memcpy(out->mac, frame, FRAME_MAC_LEN);
+    out->hive_id  = p.hive_id;
+    out->msg_type = p.msg_type;
+    out->sequence = p.sequence;
+    return FRAME_THERMAL;
+}
+
+FrameStatus frame_parse(const uint8_t* frame, size_t n, DecodedFrame* out) {
+    if (n == FRAME_LEN_THERMAL) {
+        return thermal_parse(frame, out);
+    }
+    if (n != FRAME_LEN_P1 && n != FRAME_LEN_P2) {
+        return FRAME_BAD_LENGTH;
+    }
+
+    const uint8_t* payload = frame + FRAME_MAC_LEN;
+    if (crc8(payload, 17) != payload[17]) {
+        return FRAME_BAD_CRC;
+    }
+    uint8_t expected_type = (n == FRAME_LEN_P1) ? MSG_TYPE_SENSOR : MSG_TYPE_BEE_COUNT;
+    if (payload[1] != expected_type) {
+        return FRAME_BAD_MSG_TYPE;
+    }
+
+    memcpy(out->mac, frame, FRAME_MAC_LEN);
+    if (n == FRAME_LEN_P2) {
+        bee_count_payload_t p;
+        memcpy(&p, payload, sizeof(p));
+        out->bees_in    = p.bees_in;
+        out->bees_out   = p.bees_out;
+        out->period_ms  = p.period_ms;
+        out->lane_mask  = p.lane_mask;
+        out->stuck_mask = p.stuck_mask;
+
+        payload_trace_t t;
+        memcpy(&t, payload + TRACE_OFFSET, sizeof(t));
+        out->trace_version        = t.version;
+        out->trace_attempt        = t.tx_attempt;
+        out->trace_capture_age_ms = t.capture_age_ms;
+        out->trace_retry_ms       = t.retry_ms;
+        out->trace_bridge_rx_ms   = t.bridge_rx_ms;
+        out->trace_bridge_hold_us = t.bridge_hold_us;
+    } else {
+        out->bees_in    = 0;
+        out->bees_out   = 0;
+        out->period_ms  = 0;
+        out->lane_mask  = 0;
+        out->stuck_mask = 0;
+        out->trace_version = 0;
+    }
+
+    // Common fields sit at the same offsets in both layouts
+    sensor_payload_t p;
+    memcpy(&p, payload, sizeof(p));
+    out->hive_id          = p.hive_id;
+    out->msg_type         = p.msg_type;
+    out->sequence         = p.sequence;
+    out->weight_g         = p.weight_g;
+    out->temp_c_x100      = p.temp_c_x100;
+    out->humidity_x100    = p.humidity_x100;
+    out->pressure_hpa_x10 = p.pressure_hpa_x10;
+    out->battery_mv       = p.battery_mv;
+    out->flags            = p.flags;
+    return FRAME_OK;
+}
+
+void frames_decode_buffer(const uint8_t* buf, size_t len, DecodedFrame* out, size_t max_out,
+                          DecodeStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    size_t start = 0;
+    while (stats->frames < max_out) {
+        const uint8_t* end = (const uint8_t*)memchr(buf + start, 0, len - start);
+        if (end == nullptr) {
+            break;  // Partial frame, wait for more bytes
+        }
+        size_t flen = (size_t)(end - (buf + start));
+        if (flen > 0) {
+            FrameStatus st = frame_decode(buf + start, flen, &out[stats->frames]);
+            if (st == FRAME_OK) {
+                stats->frames++;
+            } else if (st == FRAME_THERMAL) {
+                stats->skipped++;
+            } else {
+                stats->invalid++;
+                stats->bad_length += (st == FRAME_BAD_LENGTH);
+            }
+        }
+        start += flen + 1;
+        stats->consumed = start;
+    }
+}
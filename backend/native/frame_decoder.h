@@ -0,0 +1,90 @@
+/**
+ * Waggle Hub — Native serial frame decoder.
+ *
+ * Decodes the bridge's serial stream ([COBS(MAC + payload)][0x00] ...) a
+ * whole read buffer at a time, using the bridge firmware's COBS decoder
+ * (firmware/bridge/src/cobs.cpp) and the sensor firmware's payload layout
+ * and CRC-8 (firmware/sensor/src/payload.h).  Validation matches
+ * BridgeProcessor.process_frame: 38- or 54-byte frames, CRC-8 over payload
+ * bytes 0-16, msg_type consistent with the payload length.  A Phase 2
+ * payload's latency trace (payload_trace_t) is passed through as-is.
+ * 50-byte thermal array frames (msg_type 0x04, CRC-8 over bytes 0-42) are
+ * recognised as FRAME_THERMAL: valid, but not a reading.
+ *
+ * Plain C++ with no Python dependency; framesmodule.cpp wraps it as the
+ * waggle._frames extension.
+ */
+
+#ifndef WAGGLE_HUB_FRAME_DECODER_H
+#define WAGGLE_HUB_FRAME_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+static constexpr size_t FRAME_MAC_LEN = 6;
+
+enum FrameStatus : uint8_t {
+    FRAME_OK = 0,
+    FRAME_BAD_COBS,
+    FRAME_BAD_LENGTH,
+    FRAME_BAD_CRC,
+    FRAME_BAD_MSG_TYPE,
+    FRAME_THERMAL,  // Valid thermal array frame; only mac, hive_id, msg_type, sequence set
+};
+
+/**
+ * One validated frame.  Traffic and trace fields are zero for Phase 1
+ * (msg_type 0x01); trace_version is 0 when the payload carries no trace.
+ */
+struct DecodedFrame {
+    uint8_t  mac[FRAME_MAC_LEN];
+    uint8_t  hive_id;
+    uint8_t  msg_type;
+    uint16_t sequence;
+    int32_t  weight_g;
+    int16_t  temp_c_x100;
+    uint16_t humidity_x100;
+    uint16_t pressure_hpa_x10;
+    uint16_t battery_mv;
+    uint8_t  flags;
+    uint16_t bees_in;
+    uint16_t bees_out;
+    uint32_t period_ms;
+    uint8_t  lane_mask;
+    uint8_t  stuck_mask;
+    uint8_t  trace_version;
+    uint8_t  trace_attempt;
+    uint16_t trace_capture_age_ms;
+    uint16_t trace_retry_ms;
+    uint32_t trace_bridge_rx_ms;
+    uint16_t trace_bridge_hold_us;
+};
+
+/** Totals from one frames_decode_buffer() call. */
+struct DecodeStats {
+    size_t consumed;      // Bytes up to and including the last delimiter
+    size_t frames;        // Entries written to `out`
+    size_t invalid;       // Non-empty frames rejected (any FrameStatus != OK)
+    size_t bad_length;    // ... of which had an unexpected decoded length
+    size_t skipped;       // Valid frames that are not readings (FRAME_THERMAL)
+};
+
+/** Decode one COBS frame (delimiter stripped) into `out`. */
+FrameStatus frame_decode(const uint8_t* cobs, size_t len, DecodedFrame* out);
+
+/** Validate and parse an already COBS-decoded frame ([MAC][payload]). */
+FrameStatus frame_parse(const uint8_t* frame, size_t len, DecodedFrame* out);
+
+/**
+ * Decode every complete frame in `buf`.
+ *
+ * Stops at the last 0x00 delimiter, or early once `max_out` frames have been
+ * written; stats->consumed tells the caller where to resume.  Bytes after
+ * the last delimiter are a partial frame for the next read.  Empty frames
+ * (back-to-back delimiters) are skipped silently; thermal frames are
+ * counted in stats->skipped.
+ */
+void frames_decode_buffer(const uint8_t* buf, size_t len, DecodedFrame* out, size_t max_out,
+                          DecodeStats* stats);
+
+#endif  // WAGGLE_HUB_FRAME_DECODER_H
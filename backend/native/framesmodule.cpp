@@ -0,0 +1,162 @@
+/**
+ * Waggle Hub — waggle._frames: CPython binding for the native frame decoder.
+ *
+ *   decode(buf, max_frames=-1) -> (frames, consumed, invalid, bad_length, skipped)
+ *
+ * `frames` is a list of dicts with the same keys BridgeProcessor builds from
+ * deserialize_payload() plus "sender_mac" (traffic keys only for Phase 2,
+ * trace keys only for a traced Phase 2 payload).
+ * The GIL is released while the buffer is decoded.  waggle/utils/frames.py
+ * falls back to pure Python when this module is not built.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <vector>
+
+#include "frame_decoder.h"
+#include "payload.h"
+
+// Interned dict keys, created once at import
+enum Key {
+    K_HIVE_ID, K_MSG_TYPE, K_SEQUENCE, K_WEIGHT_G, K_TEMP_C_X100, K_HUMIDITY_X100,
+    K_PRESSURE_HPA_X10, K_BATTERY_MV, K_FLAGS, K_SENDER_MAC,
+    K_BEES_IN, K_BEES_OUT, K_PERIOD_MS, K_LANE_MASK, K_STUCK_MASK,
+    K_TRACE_ATTEMPT, K_TRACE_CAPTURE_AGE_MS, K_TRACE_RETRY_MS, K_TRACE_BRIDGE_RX_MS,
+    K_TRACE_BRIDGE_HOLD_US,
+    K_COUNT
+};
+
+static const char* const KEY_NAMES[K_COUNT] = {
+    "hive_id", "msg_type", "sequence", "weight_g", "temp_c_x100", "humidity_x100",
+    "pressure_hpa_x10", "battery_mv", "flags", "sender_mac",
+    "bees_in", "bees_out", "period_ms", "lane_mask", "stuck_mask",
+    "trace_attempt", "trace_capture_age_ms", "trace_retry_ms", "trace_bridge_rx_ms",
+    "trace_bridge_hold_us",
+};
+
+static PyObject* s_keys[K_COUNT];
+
+// Smallest wire frame that can decode to a valid 38-byte frame: 39 + delimiter
+static constexpr size_t MIN_WIRE_FRAME = 40;
+
+static bool set_item(PyObject* dict, Key key, PyObject* value) {
+    if (value == nullptr) {
+        return false;
+    }
+    int rc = PyDict_SetItem(dict, s_keys[key], value);
+    Py_DECREF(value);
+    return rc == 0;
+}
+
+static PyObject* format_mac(const uint8_t* mac) {
+    static const char HEX[] = "0123456789ABCDEF";
+    char s[FRAME_MAC_LEN * 3 - 1];
+    for (size_t i = 0; i < FRAME_MAC_LEN; i++) {
+        s[i * 3]     = HEX[mac[i] >> 4];
+        s[i * 3 + 1] = HEX[mac[i] & 0x0F];
+        if (i + 1 < FRAME_MAC_LEN) {
+            s[i * 3 + 2] = ':';
+        }
+    }
+    return PyUnicode_FromStringAndSize(s, sizeof(s));
+}
+
+static PyObject* frame_to_dict(const DecodedFrame& f) {
+    PyObject* d = PyDict_New();
+    if (d == nullptr) {
+        return nullptr;
+    }
+    bool ok = set_item(d, K_HIVE_ID, PyLong_FromLong(f.hive_id)) &&
+              set_item(d, K_MSG_TYPE, PyLong_FromLong(f.msg_type)) &&
+              set_item(d, K_SEQUENCE, PyLong_FromLong(f.sequence)) &&
+              set_item(d, K_WEIGHT_G, PyLong_FromLong(f.weight_g)) &&
+              set_item(d, K_TEMP_C_X100, PyLong_FromLong(f.temp_c_x100)) &&
+              set_item(d, K_HUMIDITY_X100, PyLong_FromLong(f.humidity_x100)) &&
+              set_item(d, K_PRESSURE_HPA_X10, PyLong_FromLong(f.pressure_hpa_x10)) &&
+              set_item(d, K_BATTERY_MV, PyLong_FromLong(f.battery_mv)) &&
+              set_item(d, K_FLAGS, PyLong_FromLong(f.flags)) &&
+              set_item(d, K_SENDER_MAC, format_mac(f.mac));
+    if (ok && f.msg_type == 0x02) {
+        ok = set_item(d, K_BEES_IN, PyLong_FromLong(f.bees_in)) &&
+             set_item(d, K_BEES_OUT, PyLong_FromLong(f.bees_out)) &&
+             set_item(d, K_PERIOD_MS, PyLong_FromUnsignedLong(f.period_ms)) &&
+             set_item(d, K_LANE_MASK, PyLong_FromLong(f.lane_mask)) &&
+             set_item(d, K_STUCK_MASK, PyLong_FromLong(f.stuck_mask));
+    }
+    if (ok && f.msg_type == 0x02 && f.trace_version == TRACE_VERSION) {
+        ok = set_item(d, K_TRACE_ATTEMPT, PyLong_FromLong(f.trace_attempt)) &&
+             set_item(d, K_TRACE_CAPTURE_AGE_MS, PyLong_FromLong(f.trace_capture_age_ms)) &&
+             set_item(d, K_TRACE_RETRY_MS, PyLong_FromLong(f.trace_retry_ms)) &&
+             set_item(d, K_TRACE_BRIDGE_RX_MS, PyLong_FromUnsignedLong(f.trace_bridge_rx_ms)) &&
+             set_item(d, K_TRACE_BRIDGE_HOLD_US, PyLong_FromLong(f.trace_bridge_hold_us));
+    }
+    if (!ok) {
+        Py_DECREF(d);
+        return nullptr;
+    }
+    return d;
+}
+
+static PyObject* frames_decode(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"buf", "max_frames", nullptr};
+    Py_buffer view;
+    Py_ssize_t max_frames = -1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|n", (char**)kwlist, &view,
+                                     &max_frames)) {
+        return nullptr;
+    }
+
+    size_t len = (size_t)view.len;
+    size_t cap = len / MIN_WIRE_FRAME + 1;
+    if (max_frames >= 0 && (size_t)max_frames < cap) {
+        cap = (size_t)max_frames;
+    }
+    std::vector<DecodedFrame> decoded(cap);
+    DecodeStats stats;
+
+    Py_BEGIN_ALLOW_THREADS
+    frames_decode_buffer((const uint8_t*)view.buf, len, decoded.data(), cap, &stats);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&view);
+
+    PyObject* list = PyList_New((Py_ssize_t)stats.frames);
+    if (list == nullptr) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < stats.frames; i++) {
+        PyObject* d = frame_to_dict(decoded[i]);
+        if (d == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, (Py_ssize_t)i, d);
+    }
+    return Py_BuildValue("(Nnnnn)", list, (Py_ssize_t)stats.consumed,
+                         (Py_ssize_t)stats.invalid, (Py_ssize_t)stats.bad_length,
+                         (Py_ssize_t)stats.skipped);
+}
+
+static PyMethodDef s_methods[] = {
+    {"decode", (PyCFunction)(void (*)(void))frames_decode, METH_VARARGS | METH_KEYWORDS,
+     "decode(buf, max_frames=-1) -> (frames, consumed, invalid, bad_length, skipped)\n\n"
+     "Decode every complete 0x00-delimited frame in buf."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+static struct PyModuleDef s_module = {
+    PyModuleDef_HEAD_INIT, "waggle._frames",
+    "Native COBS frame decoder for the serial bridge.", -1, s_methods,
+    nullptr, nullptr, nullptr, nullptr,
+};
+
+PyMODINIT_FUNC PyInit__frames(void) {
+    for (int i = 0; i < K_COUNT; i++) {
+        s_keys[i] = PyUnicode_InternFromString(KEY_NAMES[i]);
+        if (s_keys[i] == nullptr) {
+            return nullptr;
+        }
+    }
+    return PyModule_Create(&s_module);
+}
@@ -0,0 +1,75 @@
+/**
+ * Waggle Hub — ingestd sequence dedup cache.
+ *
+ * Same policy as IngestionService (waggle/services/ingestion.py): a
+ * (hive_id, sequence) seen within DEDUP_TTL is a duplicate; a first-boot
+ * flag clears the hive's history; each hive keeps at most DEDUP_MAX_PER_HIVE
+ * sequences, oldest evicted first.  Each hive is a fixed array of
+ * DEDUP_MAX_PER_HIVE entries scanned linearly (about 0.5 MB in total, no
+ * allocation after start-up).
+ */
+
+#ifndef WAGGLE_INGESTD_DEDUP_H
+#define WAGGLE_INGESTD_DEDUP_H
+
+#include <stdint.h>
+#include <string.h>
+
+static constexpr uint32_t DEDUP_TTL_S        = 30 * 60;  // DEDUP_TTL_SECONDS
+static constexpr uint32_t DEDUP_MAX_PER_HIVE = 256;
+static constexpr int      DEDUP_MAX_HIVE_ID  = 250;
+
+class DedupCache {
+public:
+    DedupCache() { memset(_hives, 0, sizeof(_hives)); }
+
+    /**
+     * Record (hive_id, sequence) at now_s (monotonic seconds).
+     * Returns true if it was already seen within the TTL (drop the reading).
+     */
+    bool seen(uint8_t hive_id, uint16_t sequence, uint32_t now_s, bool first_boot) {
+        if (hive_id == 0 || hive_id > DEDUP_MAX_HIVE_ID) {
+            return false;
+        }
+        Hive& h = _hives[hive_id];
+        if (first_boot) {
+            memset(&h, 0, sizeof(h));
+        }
+
+        // Stamps are stored +1 so 0 means "empty slot"
+        uint32_t stamp = now_s + 1;
+        int free_slot = -1;
+        int oldest = 0;
+        for (uint32_t i = 0; i < DEDUP_MAX_PER_HIVE; i++) {
+            const Entry& e = h.entries[i];
+            if (e.stamp == 0 || stamp - e.stamp >= DEDUP_TTL_S) {
+                if (free_slot < 0) {
+                    free_slot = (int)i;  // Empty or expired
+                }
+                continue;
+            }
+            if (e.sequence == sequence) {
+                return true;
+            }
+            if (e.stamp < h.entries[oldest].stamp) {
+                oldest = (int)i;  // Only used when every entry is live
+            }
+        }
+        Entry& slot = h.entries[free_slot >= 0 ? free_slot : oldest];
+        slot.sequence = sequence;
+        slot.stamp = stamp;
+        return false;
+    }
+
+private:
+    struct Entry {
+        uint32_t stamp;
+        uint16_t sequence;
+    };
+    struct Hive {
+        Entry entries[DEDUP_MAX_PER_HIVE];
+    };
+    Hive _hives[DEDUP_MAX_HIVE_ID + 1];
+};
+
+#endif  // WAGGLE_INGESTD_DEDUP_H
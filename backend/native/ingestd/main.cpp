@@ -0,0 +1,567 @@
+/**
+ * Waggle Hub — ingestd: serial → SQLite ingestion daemon.
+ *
+ * Alternative to the Python bridge + worker pair for busy hubs.  Reads one
+ * or more bridge serial ports with epoll, decodes frames with the native
+ * frame decoder, applies IngestionService's checks (known hive, sender MAC,
+ * flag nulling, range limits, (hive_id, sequence) dedup) and writes
+ * sensor_readings / bee_counts / hives.last_seen_at in batched
+ * transactions.  After each commit the stored readings are published to
+ * waggle/{hive_id}/ingested for the alert listener (python -m waggle alerts)
+ * and, with LATEST_STATE_PATH set, merged into the shared-memory table of
+ * each hive's latest state that the API's status endpoints read
+ * (latest/latest_table.h); the table is rebuilt from SQLite at startup.
+ *
+ * Configuration comes from the same environment as the backend (DB_PATH,
+ * SERIAL_DEVICE, SERIAL_BAUD, MQTT_HOST, MQTT_PORT, MIN_VALID_YEAR,
+ * LATEST_STATE_PATH);
+ * command-line options override it.  --input FILE decodes a recorded byte
+ * stream as fast as possible and reports rows/s (benchmark mode).
+ *
+ * Build: make -C backend/native ingestd
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "dedup.h"
+#include "frame_decoder.h"
+#include "host_io.h"
+#include "latest_table.h"
+#include "mqtt.h"
+#include "reading.h"
+#include "store.h"
+
+static constexpr size_t   MAX_PORTS         = 8;
+static constexpr size_t   READ_SIZE         = 4096;
+static constexpr size_t   MAX_PENDING       = 256;   // Partial frame without delimiter
+static constexpr size_t   DECODE_BATCH      = 128;   // Frames per decode call
+static constexpr uint64_t REOPEN_MS         = 2000;  // Retry an unplugged port
+static constexpr uint64_t UNKNOWN_REFRESH_MS = 1000; // Reload hives on an unknown id
+
+// ---- Options ----
+
+struct Options {
+    std::vector<std::string> ports;
+    const char* db           = "/var/lib/waggle/waggle.db";
+    const char* input        = nullptr;
+    const char* latest       = nullptr;  // Latest-state table path
+    const char* mqtt_host    = "127.0.0.1";
+    uint16_t    mqtt_port    = 1883;
+    bool        mqtt         = true;
+    uint32_t    baud         = 115200;
+    uint32_t    batch_rows   = 256;
+    uint32_t    batch_ms     = 20;
+    uint32_t    hive_refresh_s = 30;
+    uint32_t    stats_s      = 60;
+    int         min_year     = 2025;
+};
+
+// ---- Counters ----
+
+struct Counters {
+    uint64_t frames;        // Valid frames decoded
+    uint64_t invalid;       // Rejected by the decoder
+    uint64_t skipped;       // Valid but not readings (thermal array frames)
+    uint64_t unknown_hive;
+    uint64_t mac_mismatch;
+    uint64_t out_of_range;
+    uint64_t clock_invalid;
+    uint64_t duplicates;    // In-memory dedup or unique index
+    uint64_t errors;        // SQLite errors
+    uint64_t stored;
+    uint64_t batches;
+};
+
+// ---- Daemon state ----
+
+struct Port {
+    std::string          path;
+    int                  fd;
+    uint64_t             next_open_ms;
+    std::vector<uint8_t> buf;  // Pending partial frame + current read
+};
+
+struct StoredReading {
+    Reading r;
+    char    ingested_at[25];
+};
+
+struct Daemon {
+    Options               opt;
+    Store                 store;
+    DedupCache            dedup;
+    MqttPublisher*        mqtt = nullptr;
+    int                   epfd = -1;
+    int                   mqtt_fd_registered = -1;
+    std::vector<Port>     ports;
+    Counters              c;
+    uint64_t              batch_start_ms = 0;
+    uint64_t              last_hive_load_ms = 0;
+    std::vector<std::string> outbox;  // Topic '\n' JSON, published after commit
+    LatestTable           latest;
+    std::vector<StoredReading> latest_outbox;  // Merged into latest after commit
+};
+
+static volatile sig_atomic_t s_stop = 0;
+
+static void on_signal(int) {
+    s_stop = 1;
+}
+
+static uint64_t mono_ms() {
+    return host_mono_ns() / 1000000ULL;
+}
+
+static int utc_year(int64_t wall_ns) {
+    time_t secs = (time_t)(wall_ns / 1000000000LL);
+    struct tm tm;
+    gmtime_r(&secs, &tm);
+    return tm.tm_year + 1900;
+}
+
+// ---- Ingestion ----
+
+static void queue_alert_message(Daemon* d, const Reading& r, int64_t reading_id) {
+    char json[512];
+    int n = snprintf(json, sizeof(json),
+                     "{\"reading_id\":%lld,\"hive_id\":%u,\"observed_at\":\"%s\",\"flags\":%u",
+                     (long long)reading_id, r.hive_id, r.observed_at, r.flags);
+    struct { const char* key; bool has; double v; } fields[] = {
+        {"weight_kg", r.has_weight, r.weight_kg},
+        {"temp_c", r.has_temp, r.temp_c},
+        {"humidity_pct", r.has_humidity, r.humidity_pct},
+        {"pressure_hpa", r.has_pressure, r.pressure_hpa},
+        {"battery_v", r.has_battery, r.battery_v},
+    };
+    for (const auto& f : fields) {
+        n += f.has ? snprintf(json + n, sizeof(json) - n, ",\"%s\":%.3f", f.key, f.v)
+                   : snprintf(json + n, sizeof(json) - n, ",\"%s\":null", f.key);
+    }
+    if (r.has_traffic) {  // Only when its bee_counts row was stored
+        n += snprintf(json + n, sizeof(json) - n,
+                      ",\"bees_in\":%u,\"bees_out\":%u,\"period_ms\":%u,"
+                      "\"lane_mask\":%u,\"stuck_mask\":%u",
+                      r.bees_in, r.bees_out, r.period_ms, r.lane_mask, r.stuck_mask);
+    }
+    snprintf(json + n, sizeof(json) - n, "}");
+
+    std::string msg = "waggle/" + std::to_string(r.hive_id) + "/ingested\n";
+    msg += json;
+    d->outbox.push_back(std::move(msg));
+}
+
+static void update_latest(Daemon* d, const StoredReading& s) {
+    const Reading& r = s.r;
+    LatestReading lr;
+    memset(&lr, 0, sizeof(lr));
+    memcpy(lr.observed_at, r.observed_at, sizeof(lr.observed_at));
+    lr.present = (r.has_weight ? LATEST_HAS_WEIGHT : 0) | (r.has_temp ? LATEST_HAS_TEMP : 0) |
+                 (r.has_humidity ? LATEST_HAS_HUMIDITY : 0) |
+                 (r.has_pressure ? LATEST_HAS_PRESSURE : 0) |
+                 (r.has_battery ? LATEST_HAS_BATTERY : 0);
+    lr.flags = r.flags;
+    lr.sequence = r.sequence;
+    lr.weight_kg = r.weight_kg;
+    lr.temp_c = r.temp_c;
+    lr.humidity_pct = r.humidity_pct;
+    lr.pressure_hpa = r.pressure_hpa;
+    lr.battery_v = r.battery_v;
+
+    LatestTraffic lt;
+    memset(&lt, 0, sizeof(lt));
+    if (r.has_traffic) {  // Only when its bee_counts row was stored
+        memcpy(lt.observed_at, r.observed_at, sizeof(lt.observed_at));
+        lt.bees_in = r.bees_in;
+        lt.bees_out = r.bees_out;
+        lt.period_ms = r.period_ms;
+        lt.lane_mask = r.lane_mask;
+        lt.stuck_mask = r.stuck_mask;
+    }
+    if (!d->latest.update(r.hive_id, s.ingested_at, &lr, r.has_traffic ? &lt : nullptr)) {
+        fprintf(stderr, "W latest-state slot for hive %u stayed locked\n", r.hive_id);
+    }
+}
+
+static void commit_batch(Daemon* d) {
+    if (!d->store.in_batch()) {
+        return;
+    }
+    bool had_rows = d->store.pending() > 0;
+    if (!d->store.commit()) {
+        d->c.errors++;
+        d->outbox.clear();  // Rolled back: nothing to announce
+        d->latest_outbox.clear();
+        return;
+    }
+    d->c.batches += had_rows;
+    for (const StoredReading& s : d->latest_outbox) {
+        update_latest(d, s);
+    }
+    d->latest_outbox.clear();
+    if (d->mqtt != nullptr) {
+        for (const std::string& m : d->outbox) {
+            size_t nl = m.find('\n');
+            std::string topic = m.substr(0, nl);
+            d->mqtt->publish(topic.c_str(), m.data() + nl + 1, m.size() - nl - 1);
+        }
+    }
+    d->outbox.clear();
+}
+
+static void ingest_frame(Daemon* d, const DecodedFrame& f, const char* observed_at,
+                         const char* ingested_at, uint32_t now_s) {
+    d->c.frames++;
+    if (f.hive_id == 0 || f.hive_id > DEDUP_MAX_HIVE_ID) {
+        d->c.unknown_hive++;  // Outside the hives.id CHECK range
+        return;
+    }
+    const HiveInfo* hive = &d->store.hive(f.hive_id);
+    if (!hive->exists && mono_ms() - d->last_hive_load_ms >= UNKNOWN_REFRESH_MS) {
+        // Hive may have been registered through the API since the last load
+        commit_batch(d);
+        d->store.load_hives();
+        d->last_hive_load_ms = mono_ms();
+        hive = &d->store.hive(f.hive_id);
+    }
+    if (!hive->exists) {
+        d->c.unknown_hive++;
+        return;
+    }
+
+    Reading r;
+    ReadingStatus st = reading_from_frame(f, observed_at, &r);
+    if (hive->has_mac && strcmp(r.sender_mac, hive->sender_mac) != 0) {
+        d->c.mac_mismatch++;
+        return;
+    }
+    if (st != READING_OK) {
+        d->c.out_of_range++;
+        return;
+    }
+    if (d->dedup.seen(r.hive_id, r.sequence, now_s, r.flags & HUB_FLAG_FIRST_BOOT)) {
+        d->c.duplicates++;
+        return;
+    }
+
+    if (!d->store.in_batch()) {
+        d->batch_start_ms = mono_ms();
+    }
+    int64_t reading_id = 0;
+    switch (d->store.insert(r, ingested_at, &reading_id)) {
+        case INSERT_OK:
+            d->c.stored++;
+            if (d->mqtt != nullptr) {
+                queue_alert_message(d, r, reading_id);
+            }
+            if (d->latest.is_open()) {
+                StoredReading s;
+                s.r = r;
+                memcpy(s.ingested_at, ingested_at, sizeof(s.ingested_at));
+                d->latest_outbox.push_back(s);
+            }
+            break;
+        case INSERT_DUPLICATE:
+            d->c.duplicates++;
+            break;
+        case INSERT_ERROR:
+            d->c.errors++;
+            break;
+    }
+    if (d->store.pending() >= d->opt.batch_rows) {
+        commit_batch(d);
+    }
+}
+
+/** Decode every complete frame in buf and keep the partial tail. */
+static void ingest_bytes(Daemon* d, std::vector<uint8_t>& buf) {
+    int64_t wall = host_wall_ns();
+    if (utc_year(wall) < d->opt.min_year) {
+        // is_system_time_valid: drop everything until NTP has synced
+        d->c.clock_invalid += std::count(buf.begin(), buf.end(), (uint8_t)0);
+        buf.clear();
+        return;
+    }
+    char now_iso[25];
+    format_utc(wall, now_iso);  // observed_at and ingested_at for this read
+    uint32_t now_s = (uint32_t)(host_mono_ns() / 1000000000ULL);
+
+    DecodedFrame frames[DECODE_BATCH];
+    size_t offset = 0;
+    for (;;) {
+        DecodeStats stats;
+        frames_decode_buffer(buf.data() + offset, buf.size() - offset, frames, DECODE_BATCH,
+                             &stats);
+        d->c.invalid += stats.invalid;
+        d->c.skipped += stats.skipped;
+        for (size_t i = 0; i < stats.frames; i++) {
+            ingest_frame(d, frames[i], now_iso, now_iso, now_s);
+        }
+        offset += stats.consumed;
+        if (stats.frames < DECODE_BATCH) {
+            break;
+        }
+    }
+    buf.erase(buf.begin(), buf.begin() + offset);
+    if (buf.size() > MAX_PENDING) {
+        buf.clear();  // Line noise without a delimiter
+    }
+}
+
+// ---- Serial ports ----
+
+static void port_open(Daemon* d, Port& p) {
+    p.fd = open(p.path.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (p.fd < 0) {
+        p.next_open_ms = mono_ms() + REOPEN_MS;
+        return;
+    }
+    if (isatty(p.fd) && !host_tty_raw(p.fd, d->opt.baud)) {
+        fprintf(stderr, "W %s: cannot set raw mode\n", p.path.c_str());
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &p;
+    epoll_ctl(d->epfd, EPOLL_CTL_ADD, p.fd, &ev);
+    p.buf.clear();
+    fprintf(stderr, "I reading %s\n", p.path.c_str());
+}
+
+static void port_close(Daemon* d, Port& p, const char* why) {
+    fprintf(stderr, "W %s: %s, reopening\n", p.path.c_str(), why);
+    epoll_ctl(d->epfd, EPOLL_CTL_DEL, p.fd, nullptr);
+    close(p.fd);
+    p.fd = -1;
+    p.next_open_ms = mono_ms() + REOPEN_MS;
+}
+
+static void port_readable(Daemon* d, Port& p) {
+    for (;;) {
+        size_t old = p.buf.size();
+        p.buf.resize(old + READ_SIZE);
+        ssize_t n = read(p.fd, p.buf.data() + old, READ_SIZE);
+        p.buf.resize(old + (n > 0 ? (size_t)n : 0));
+        if (n > 0) {
+            ingest_bytes(d, p.buf);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+        port_close(d, p, n == 0 ? "closed" : strerror(errno));
+        return;
+    }
+}
+
+// ---- Main loop ----
+
+static void print_stats(const Daemon& d, double elapsed_s) {
+    const Counters& c = d.c;
+    fprintf(stderr,
+            "I frames %llu invalid %llu skipped %llu stored %llu (%.1f rows/s) dup %llu "
+            "unknown %llu mac %llu range %llu clock %llu err %llu batches %llu",
+            (unsigned long long)c.frames, (unsigned long long)c.invalid,
+            (unsigned long long)c.skipped,
+            (unsigned long long)c.stored, elapsed_s > 0 ? c.stored / elapsed_s : 0.0,
+            (unsigned long long)c.duplicates, (unsigned long long)c.unknown_hive,
+            (unsigned long long)c.mac_mismatch, (unsigned long long)c.out_of_range,
+            (unsigned long long)c.clock_invalid, (unsigned long long)c.errors,
+            (unsigned long long)c.batches);
+    if (d.mqtt != nullptr) {
+        fprintf(stderr, " mqtt %llu/%llu dropped",
+                (unsigned long long)d.mqtt->published(), (unsigned long long)d.mqtt->dropped());
+    }
+    fprintf(stderr, "\n");
+}
+
+static int run_input(Daemon* d) {
+    FILE* f = fopen(d->opt.input, "rb");
+    if (f == nullptr) {
+        perror(d->opt.input);
+        return 1;
+    }
+    uint64_t t0 = host_mono_ns();
+    std::vector<uint8_t> buf;
+    uint8_t chunk[READ_SIZE];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        buf.insert(buf.end(), chunk, chunk + n);
+        ingest_bytes(d, buf);
+    }
+    fclose(f);
+    commit_batch(d);
+    double elapsed = (host_mono_ns() - t0) / 1e9;
+    print_stats(*d, elapsed);
+    printf("%.1f rows/s\n", elapsed > 0 ? d->c.stored / elapsed : 0.0);
+    return 0;
+}
+
+static int run_daemon(Daemon* d) {
+    d->epfd = epoll_create1(EPOLL_CLOEXEC);
+    for (const std::string& path : d->opt.ports) {
+        Port p;
+        p.path = path;
+        p.fd = -1;
+        p.next_open_ms = 0;
+        d->ports.push_back(p);
+    }
+    for (Port& p : d->ports) {
+        port_open(d, p);
+        if (p.fd < 0) {
+            fprintf(stderr, "W %s: %s, retrying\n", p.path.c_str(), strerror(errno));
+        }
+    }
+
+    uint64_t t0 = mono_ms();
+    uint64_t next_stats = t0 + d->opt.stats_s * 1000ULL;
+    while (!s_stop) {
+        uint64_t now = mono_ms();
+        int timeout = 1000;
+        if (d->store.in_batch()) {
+            uint64_t due = d->batch_start_ms + d->opt.batch_ms;
+            timeout = due > now ? (int)(due - now) : 0;
+        }
+
+        struct epoll_event events[MAX_PORTS + 1];
+        int n = epoll_wait(d->epfd, events, MAX_PORTS + 1, timeout);
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == nullptr) {
+                d->mqtt->on_readable();
+            } else {
+                Port& p = *(Port*)events[i].data.ptr;
+                if (p.fd >= 0) {
+                    port_readable(d, p);
+                }
+            }
+        }
+
+        now = mono_ms();
+        if (d->store.in_batch() && now - d->batch_start_ms >= d->opt.batch_ms) {
+            commit_batch(d);
+        }
+        for (Port& p : d->ports) {
+            if (p.fd < 0 && now >= p.next_open_ms) {
+                port_open(d, p);
+            }
+        }
+        if (now - d->last_hive_load_ms >= d->opt.hive_refresh_s * 1000ULL) {
+            commit_batch(d);
+            d->store.load_hives();
+            d->last_hive_load_ms = now;
+        }
+        if (d->mqtt != nullptr) {
+            d->mqtt->service(now);
+            if (d->mqtt->fd() != d->mqtt_fd_registered && d->mqtt->fd() >= 0) {
+                // New connection (a closed socket leaves the epoll set by itself)
+                struct epoll_event ev;
+                memset(&ev, 0, sizeof(ev));
+                ev.events = EPOLLIN;
+                ev.data.ptr = nullptr;
+                epoll_ctl(d->epfd, EPOLL_CTL_ADD, d->mqtt->fd(), &ev);
+                d->mqtt_fd_registered = d->mqtt->fd();
+            }
+        }
+        if (d->opt.stats_s > 0 && now >= next_stats) {
+            print_stats(*d, (now - t0) / 1000.0);
+            next_stats = now + d->opt.stats_s * 1000ULL;
+        }
+    }
+    commit_batch(d);
+    print_stats(*d, (mono_ms() - t0) / 1000.0);
+    return 0;
+}
+
+static void usage() {
+    fprintf(stderr,
+        "usage: ingestd [--port DEV]... [--db PATH] [--baud N] [--mqtt-host H]\n"
+        "               [--mqtt-port N] [--no-mqtt] [--batch-rows N] [--batch-ms N]\n"
+        "               [--hive-refresh-s N] [--stats-s N] [--latest PATH] [--input FILE]\n"
+        "Defaults come from DB_PATH, SERIAL_DEVICE, SERIAL_BAUD, MQTT_HOST, MQTT_PORT,\n"
+        "MIN_VALID_YEAR and LATEST_STATE_PATH.\n");
+    exit(2);
+}
+
+static void parse_args(int argc, char** argv, Options* opt) {
+    if (const char* v = getenv("DB_PATH"))        opt->db = v;
+    if (const char* v = getenv("MQTT_HOST"))      opt->mqtt_host = v;
+    if (const char* v = getenv("MQTT_PORT"))      opt->mqtt_port = (uint16_t)atoi(v);
+    if (const char* v = getenv("SERIAL_BAUD"))    opt->baud = (uint32_t)atol(v);
+    if (const char* v = getenv("MIN_VALID_YEAR")) opt->min_year = atoi(v);
+    if (const char* v = getenv("LATEST_STATE_PATH")) opt->latest = *v ? v : nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strcmp(a, "--no-mqtt") == 0) {
+            opt->mqtt = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage();
+        }
+        const char* v = argv[++i];
+        if (strcmp(a, "--port") == 0)                opt->ports.push_back(v);
+        else if (strcmp(a, "--db") == 0)             opt->db = v;
+        else if (strcmp(a, "--input") == 0)          opt->input = v;
+        else if (strcmp(a, "--latest") == 0)         opt->latest = v;
+        else if (strcmp(a, "--baud") == 0)           opt->baud = (uint32_t)atol(v);
+        else if (strcmp(a, "--mqtt-host") == 0)      opt->mqtt_host = v;
+        else if (strcmp(a, "--mqtt-port") == 0)      opt->mqtt_port = (uint16_t)atoi(v);
+        else if (strcmp(a, "--batch-rows") == 0)     opt->batch_rows = (uint32_t)atol(v);
+        else if (strcmp(a, "--batch-ms") == 0)       opt->batch_ms = (uint32_t)atol(v);
+        else if (strcmp(a, "--hive-refresh-s") == 0) opt->hive_refresh_s = (uint32_t)atol(v);
+        else if (strcmp(a, "--stats-s") == 0)        opt->stats_s = (uint32_t)atol(v);
+        else usage();
+    }
+    if (opt->ports.empty() && opt->input == nullptr) {
+        const char* dev = getenv("SERIAL_DEVICE");
+        opt->ports.push_back(dev ? dev : "/dev/ttyUSB0");
+    }
+    if (opt->ports.size() > MAX_PORTS || opt->batch_rows == 0) {
+        usage();
+    }
+}
+
+int main(int argc, char** argv) {
+    static Daemon d;  // DedupCache is ~0.5 MB: keep it off the stack
+    parse_args(argc, argv, &d.opt);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    if (!d.store.open(d.opt.db) || !d.store.load_hives()) {
+        return 1;
+    }
+    d.last_hive_load_ms = mono_ms();
+    d.store.warm_dedup(&d.dedup, (uint32_t)(host_mono_ns() / 1000000000ULL));
+    if (d.opt.latest != nullptr) {
+        // Optional: without the table the API answers from SQLite
+        std::string err;
+        if (!d.latest.open(d.opt.latest, true, &err)) {
+            fprintf(stderr, "W latest-state table disabled: %s\n", err.c_str());
+        } else if (!d.store.seed_latest(&d.latest)) {
+            d.latest.close();
+        }
+    }
+
+    MqttPublisher mqtt(d.opt.mqtt_host, d.opt.mqtt_port, "waggle-ingestd");
+    if (d.opt.mqtt && d.opt.input == nullptr) {
+        d.mqtt = &mqtt;
+    }
+    return d.opt.input ? run_input(&d) : run_daemon(&d);
+}
@@ -0,0 +1,210 @@
+/**
+ * Waggle Hub — ingestd minimal MQTT publisher implementation.
+ */
+
+#include "mqtt.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static constexpr uint16_t KEEPALIVE_S        = 60;
+static constexpr uint64_t RECONNECT_MS       = 5000;
+static constexpr int      CONNECT_TIMEOUT_MS = 1000;
+
+// MQTT "remaining length": 7 bits per byte, high bit = more follows
+static size_t encode_length(size_t len, uint8_t* out) {
+    size_t n = 0;
+    do {
+        uint8_t b = len % 128;
+        len /= 128;
+        out[n++] = (uint8_t)(b | (len > 0 ? 0x80 : 0));
+    } while (len > 0);
+    return n;
+}
+
+MqttPublisher::MqttPublisher(const char* host, uint16_t port, const char* client_id)
+    : _port(port), _fd(-1), _connected(false), _next_attempt_ms(0), _last_send_ms(0),
+      _published(0), _dropped(0) {
+    snprintf(_host, sizeof(_host), "%s", host);
+    snprintf(_client_id, sizeof(_client_id), "%s", client_id);
+}
+
+MqttPublisher::~MqttPublisher() {
+    if (_connected) {
+        const uint8_t bye[2] = {0xE0, 0x00};  // DISCONNECT
+        send_all(bye, sizeof(bye));
+    }
+    disconnect();
+}
+
+void MqttPublisher::disconnect() {
+    if (_fd >= 0) {
+        close(_fd);
+    }
+    _fd = -1;
+    _connected = false;
+}
+
+bool MqttPublisher::send_all(const uint8_t* data, size_t len) {
+    bool partial = false;
+    while (len > 0) {
+        ssize_t n = send(_fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN && errno != EWOULDBLOCK) || partial) {
+                // Error, or half a packet on the wire: the stream is unusable
+                fprintf(stderr, "W mqtt: send failed (%s), reconnecting\n", strerror(errno));
+                disconnect();
+            }
+            return false;
+        }
+        partial = true;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+void MqttPublisher::connect_now(uint64_t now_ms) {
+    _next_attempt_ms = now_ms + RECONNECT_MS;
+
+    char port[8];
+    snprintf(port, sizeof(port), "%u", _port);
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* res = nullptr;
+    if (getaddrinfo(_host, port, &hints, &res) != 0 || res == nullptr) {
+        return;
+    }
+    _fd = socket(res->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (_fd < 0) {
+        freeaddrinfo(res);
+        return;
+    }
+
+    // Bounded blocking connect (the broker is local), then non-blocking I/O
+    int flags = fcntl(_fd, F_GETFL, 0);
+    fcntl(_fd, F_SETFL, flags | O_NONBLOCK);
+    int rc = ::connect(_fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (rc != 0 && errno == EINPROGRESS) {
+        struct pollfd pfd = {_fd, POLLOUT, 0};
+        int err = 0;
+        socklen_t elen = sizeof(err);
+        if (poll(&pfd, 1, CONNECT_TIMEOUT_MS) == 1 &&
+            getsockopt(_fd, SOL_SOCKET, SO_ERROR, &err, &elen) == 0 && err == 0) {
+            rc = 0;
+        }
+    }
+    if (rc != 0) {
+        disconnect();
+        return;
+    }
+    int one = 1;
+    setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    // CONNECT: protocol "MQTT" level 4, clean session, keep-alive, client id
+    size_t id_len = strlen(_client_id);
+    uint8_t pkt[64];
+    size_t body = 10 + 2 + id_len;
+    size_t n = 0;
+    pkt[n++] = 0x10;
+    n += encode_length(body, pkt + n);
+    const uint8_t var[10] = {0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x02,
+                             (uint8_t)(KEEPALIVE_S >> 8), (uint8_t)(KEEPALIVE_S & 0xFF)};
+    memcpy(pkt + n, var, sizeof(var));
+    n += sizeof(var);
+    pkt[n++] = (uint8_t)(id_len >> 8);
+    pkt[n++] = (uint8_t)(id_len & 0xFF);
+    memcpy(pkt + n, _client_id, id_len);
+    n += id_len;
+    if (send_all(pkt, n)) {
+        _last_send_ms = now_ms;
+    }
+    // _connected is set when CONNACK arrives in on_readable()
+}
+
+void MqttPublisher::service(uint64_t now_ms) {
+    if (_fd < 0) {
+        if (now_ms >= _next_attempt_ms) {
+            connect_now(now_ms);
+        }
+        return;
+    }
+    if (_connected && now_ms - _last_send_ms >= KEEPALIVE_S * 1000ULL / 2) {
+        const uint8_t ping[2] = {0xC0, 0x00};  // PINGREQ
+        if (send_all(ping, sizeof(ping))) {
+            _last_send_ms = now_ms;
+        }
+    }
+}
+
+void MqttPublisher::on_readable() {
+    uint8_t buf[256];
+    for (;;) {
+        ssize_t n = recv(_fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            // CONNACK (0x20 0x02 flags rc) is the only packet we act on;
+            // it always arrives first, alone, right after CONNECT
+            if (!_connected && n >= 4 && buf[0] == 0x20) {
+                if (buf[3] == 0x00) {
+                    _connected = true;
+                    fprintf(stderr, "I mqtt: connected to %s:%u\n", _host, _port);
+                } else {
+                    fprintf(stderr, "W mqtt: broker refused connection (rc=%u)\n", buf[3]);
+                    disconnect();
+                    return;
+                }
+            }
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return;
+        }
+        fprintf(stderr, "W mqtt: connection to %s:%u lost\n", _host, _port);
+        disconnect();
+        return;
+    }
+}
+
+bool MqttPublisher::publish(const char* topic, const char* payload, size_t len) {
+    if (!_connected) {
+        _dropped++;
+        return false;
+    }
+    size_t topic_len = strlen(topic);
+    uint8_t pkt[1024];
+    size_t body = 2 + topic_len + len;
+    if (body + 5 > sizeof(pkt)) {
+        _dropped++;
+        return false;
+    }
+    size_t n = 0;
+    pkt[n++] = 0x30;  // PUBLISH, QoS 0, no retain
+    n += encode_length(body, pkt + n);
+    pkt[n++] = (uint8_t)(topic_len >> 8);
+    pkt[n++] = (uint8_t)(topic_len & 0xFF);
+    memcpy(pkt + n, topic, topic_len);
+    n += topic_len;
+    memcpy(pkt + n, payload, len);
+    n += len;
+    if (!send_all(pkt, n)) {
+        _dropped++;
+        return false;
+    }
+    _published++;
+    return true;
+}
@@ -0,0 +1,55 @@
+/**
+ * Waggle Hub — ingestd minimal MQTT publisher.
+ *
+ * Just enough MQTT 3.1.1 to publish QoS 0 messages to the local broker:
+ * CONNECT (clean session), PUBLISH, PINGREQ and DISCONNECT over a
+ * non-blocking TCP socket driven by the daemon's epoll loop.  Messages are
+ * dropped (and counted) while the broker is unreachable or the socket
+ * buffer is full; the alert engine tolerates gaps, the database does not
+ * depend on MQTT.
+ */
+
+#ifndef WAGGLE_INGESTD_MQTT_H
+#define WAGGLE_INGESTD_MQTT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class MqttPublisher {
+public:
+    MqttPublisher(const char* host, uint16_t port, const char* client_id);
+    ~MqttPublisher();
+
+    /** Socket to watch for EPOLLIN, or -1 while disconnected. */
+    int fd() const { return _fd; }
+
+    /** (Re)connect if due and send keep-alives; call from the event loop. */
+    void service(uint64_t now_ms);
+
+    /** Drain broker traffic (CONNACK, PINGRESP); disconnects on EOF/error. */
+    void on_readable();
+
+    /** Publish at QoS 0; false if the message was dropped. */
+    bool publish(const char* topic, const char* payload, size_t len);
+
+    bool connected() const { return _connected; }
+    uint64_t published() const { return _published; }
+    uint64_t dropped() const { return _dropped; }
+
+private:
+    void connect_now(uint64_t now_ms);
+    void disconnect();
+    bool send_all(const uint8_t* data, size_t len);
+
+    char     _host[64];
+    uint16_t _port;
+    char     _client_id[24];
+    int      _fd;
+    bool     _connected;       // CONNACK accepted
+    uint64_t _next_attempt_ms;
+    uint64_t _last_send_ms;
+    uint64_t _published;
+    uint64_t _dropped;
+};
+
+#endif  // WAGGLE_INGESTD_MQTT_H
@@ -0,0 +1,68 @@
+/**
+ * Waggle Hub — ingestd reading conversion and validation implementation.
+ */
+
+#include "reading.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// RANGE_LIMITS in waggle/services/ingestion.py
+static bool in_range(double v, double lo, double hi) {
+    return v >= lo && v <= hi;
+}
+
+void format_utc(int64_t wall_ns, char out[25]) {
+    time_t secs = (time_t)(wall_ns / 1000000000LL);
+    int ms = (int)((wall_ns / 1000000LL) % 1000);
+    struct tm tm;
+    gmtime_r(&secs, &tm);
+    // Unsigned and bounded so the compiler can prove the 24 characters fit
+    snprintf(out, 25, "%04u-%02u-%02uT%02u:%02u:%02u.%03uZ",
+             (unsigned)(tm.tm_year + 1900) % 10000u, (unsigned)(tm.tm_mon + 1) % 100u,
+             (unsigned)tm.tm_mday % 100u, (unsigned)tm.tm_hour % 100u,
+             (unsigned)tm.tm_min % 100u, (unsigned)tm.tm_sec % 100u, (unsigned)ms % 1000u);
+}
+
+ReadingStatus reading_from_frame(const DecodedFrame& f, const char* observed_at, Reading* r) {
+    r->hive_id  = f.hive_id;
+    r->msg_type = f.msg_type;
+    r->sequence = f.sequence;
+    r->flags    = f.flags;
+    snprintf(r->sender_mac, sizeof(r->sender_mac), "%02X:%02X:%02X:%02X:%02X:%02X",
+             f.mac[0], f.mac[1], f.mac[2], f.mac[3], f.mac[4], f.mac[5]);
+    memcpy(r->observed_at, observed_at, sizeof(r->observed_at));
+
+    bool hx711   = f.flags & HUB_FLAG_HX711_ERROR;
+    bool bme280  = f.flags & HUB_FLAG_BME280_ERROR;
+    bool battery = f.flags & HUB_FLAG_BATTERY_ERROR;
+
+    r->has_weight   = !hx711;
+    r->has_temp     = !bme280;
+    r->has_humidity = !bme280;
+    r->has_pressure = !bme280;
+    r->has_battery  = !battery;
+    r->weight_kg    = f.weight_g / 1000.0;
+    r->temp_c       = f.temp_c_x100 / 100.0;
+    r->humidity_pct = f.humidity_x100 / 100.0;
+    r->pressure_hpa = f.pressure_hpa_x10 / 10.0;
+    r->battery_v    = f.battery_mv / 1000.0;
+
+    if ((r->has_weight && !in_range(r->weight_kg, 0, 200)) ||
+        (r->has_temp && !in_range(r->temp_c, -20, 60)) ||
+        (r->has_humidity && !in_range(r->humidity_pct, 0, 100)) ||
+        (r->has_pressure && !in_range(r->pressure_hpa, 300, 1100)) ||
+        (r->has_battery && !in_range(r->battery_v, 2.5, 4.5))) {
+        return READING_OUT_OF_RANGE;
+    }
+
+    // _validate_traffic: u16 counts and u8 masks can't be out of range
+    r->has_traffic = f.msg_type == 0x02 && f.period_ms >= 1000 && f.period_ms <= 3600000;
+    r->bees_in    = f.bees_in;
+    r->bees_out   = f.bees_out;
+    r->period_ms  = f.period_ms;
+    r->lane_mask  = f.lane_mask;
+    r->stuck_mask = f.stuck_mask;
+    return READING_OK;
+}
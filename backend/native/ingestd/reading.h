@@ -0,0 +1,52 @@
+/**
+ * Waggle Hub — ingestd reading conversion and validation.
+ *
+ * Mirrors IngestionService.process_message: backend flag bits null the
+ * affected fields, units are converted, the hub's range limits reject the
+ * whole reading, and Phase 2 traffic fields are validated separately (a bad
+ * traffic block keeps the sensor row but skips bee_counts).
+ */
+
+#ifndef WAGGLE_INGESTD_READING_H
+#define WAGGLE_INGESTD_READING_H
+
+#include <stdint.h>
+
+#include "frame_decoder.h"
+
+// Hub flag bits (waggle/services/ingestion.py)
+static constexpr uint8_t HUB_FLAG_FIRST_BOOT    = 1 << 1;
+static constexpr uint8_t HUB_FLAG_HX711_ERROR   = 1 << 3;
+static constexpr uint8_t HUB_FLAG_BME280_ERROR  = 1 << 4;
+static constexpr uint8_t HUB_FLAG_BATTERY_ERROR = 1 << 5;
+
+enum ReadingStatus : uint8_t {
+    READING_OK = 0,
+    READING_OUT_OF_RANGE,
+};
+
+/** One converted reading; has_* false means SQL NULL. */
+struct Reading {
+    uint8_t  hive_id;
+    uint8_t  msg_type;
+    uint16_t sequence;
+    uint8_t  flags;
+    char     sender_mac[18];
+    char     observed_at[25];
+
+    bool     has_weight, has_temp, has_humidity, has_pressure, has_battery;
+    double   weight_kg, temp_c, humidity_pct, pressure_hpa, battery_v;
+
+    bool     has_traffic;  // Phase 2 with valid traffic fields
+    uint16_t bees_in, bees_out;
+    uint32_t period_ms;
+    uint8_t  lane_mask, stuck_mask;
+};
+
+/** Convert a decoded frame; observed_at is the canonical UTC string. */
+ReadingStatus reading_from_frame(const DecodedFrame& f, const char* observed_at, Reading* r);
+
+/** "YYYY-MM-DDTHH:MM:SS.mmmZ" for a CLOCK_REALTIME value. */
+void format_utc(int64_t wall_ns, char out[25]);
+
+#endif  // WAGGLE_INGESTD_READING_H
@@ -0,0 +1,311 @@
+/**
+ * Waggle Hub — ingestd SQLite writer implementation.
+ */
+
+#include "store.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+Store::Store()
+    : _db(nullptr), _insert_reading(nullptr), _insert_counts(nullptr), _update_seen(nullptr),
+      _savepoint(nullptr), _release(nullptr), _rollback_to(nullptr), _in_txn(false),
+      _pending(0) {
+    memset(_hives, 0, sizeof(_hives));
+    memset(_batch_seen, 0, sizeof(_batch_seen));
+}
+
+Store::~Store() {
+    commit();
+    sqlite3_finalize(_insert_reading);
+    sqlite3_finalize(_insert_counts);
+    sqlite3_finalize(_update_seen);
+    sqlite3_finalize(_savepoint);
+    sqlite3_finalize(_release);
+    sqlite3_finalize(_rollback_to);
+    sqlite3_close(_db);
+}
+
+bool Store::exec(const char* sql) {
+    char* err = nullptr;
+    if (sqlite3_exec(_db, sql, nullptr, nullptr, &err) != SQLITE_OK) {
+        fprintf(stderr, "E sqlite: %s: %s\n", sql, err ? err : "?");
+        sqlite3_free(err);
+        return false;
+    }
+    return true;
+}
+
+// Run a prepared statement that returns no rows
+static int step(sqlite3_stmt* stmt) {
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    return rc;
+}
+
+bool Store::prepare(const char* sql, sqlite3_stmt** stmt) {
+    if (sqlite3_prepare_v3(_db, sql, -1, SQLITE_PREPARE_PERSISTENT, stmt, nullptr) != SQLITE_OK) {
+        fprintf(stderr, "E sqlite: prepare failed (%s); is the schema up to date?\n",
+                sqlite3_errmsg(_db));
+        return false;
+    }
+    return true;
+}
+
+bool Store::open(const char* path) {
+    if (sqlite3_open_v2(path, &_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, nullptr) !=
+        SQLITE_OK) {
+        fprintf(stderr, "E cannot open %s: %s\n", path, sqlite3_errmsg(_db));
+        return false;
+    }
+    // Same pragmas as waggle.database._set_pragmas
+    if (!exec("PRAGMA journal_mode = WAL") || !exec("PRAGMA foreign_keys = ON") ||
+        !exec("PRAGMA synchronous = NORMAL") || !exec("PRAGMA busy_timeout = 30000")) {
+        return false;
+    }
+    return prepare("INSERT OR IGNORE INTO sensor_readings "
+                   "(hive_id, observed_at, ingested_at, weight_kg, temp_c, humidity_pct, "
+                   "pressure_hpa, battery_v, sequence, flags, sender_mac) "
+                   "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11)",
+                   &_insert_reading) &&
+           prepare("INSERT INTO bee_counts "
+                   "(reading_id, hive_id, observed_at, ingested_at, period_ms, bees_in, "
+                   "bees_out, lane_mask, stuck_mask, sequence, flags, sender_mac) "
+                   "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12)",
+                   &_insert_counts) &&
+           prepare("UPDATE hives SET last_seen_at = ?1 "
+                   "WHERE id = ?2 AND (last_seen_at IS NULL OR last_seen_at < ?1)",
+                   &_update_seen) &&
+           prepare("SAVEPOINT reading", &_savepoint) &&
+           prepare("RELEASE reading", &_release) &&
+           prepare("ROLLBACK TO reading", &_rollback_to);
+}
+
+bool Store::load_hives() {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(_db, "SELECT id, sender_mac FROM hives", -1, &stmt, nullptr) !=
+        SQLITE_OK) {
+        fprintf(stderr, "E sqlite: %s\n", sqlite3_errmsg(_db));
+        return false;
+    }
+    HiveInfo fresh[DEDUP_MAX_HIVE_ID + 1];
+    memset(fresh, 0, sizeof(fresh));
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int id = sqlite3_column_int(stmt, 0);
+        if (id < 1 || id > DEDUP_MAX_HIVE_ID) {
+            continue;
+        }
+        HiveInfo& h = fresh[id];
+        h.exists = true;
+        const unsigned char* mac = sqlite3_column_text(stmt, 1);
+        if (mac != nullptr) {
+            h.has_mac = true;
+            // Compared case-insensitively like process_message: store upper case
+            size_t i = 0;
+            for (; i < sizeof(h.sender_mac) - 1 && mac[i]; i++) {
+                char c = (char)mac[i];
+                h.sender_mac[i] = (c >= 'a' && c <= 'z') ? (char)(c - 32) : c;
+            }
+            h.sender_mac[i] = '\0';
+        }
+    }
+    sqlite3_finalize(stmt);
+    memcpy(_hives, fresh, sizeof(_hives));
+    return true;
+}
+
+bool Store::warm_dedup(DedupCache* dedup, uint32_t now_s) {
+    char cutoff[25];
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    int64_t wall_ns = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    format_utc(wall_ns - (int64_t)DEDUP_TTL_S * 1000000000LL, cutoff);
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(_db,
+            "SELECT hive_id, sequence FROM sensor_readings WHERE ingested_at >= ?1 ORDER BY id",
+            -1, &stmt, nullptr) != SQLITE_OK) {
+        fprintf(stderr, "E sqlite: %s\n", sqlite3_errmsg(_db));
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, cutoff, -1, SQLITE_TRANSIENT);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        dedup->seen((uint8_t)sqlite3_column_int(stmt, 0),
+                    (uint16_t)sqlite3_column_int(stmt, 1), now_s, false);
+    }
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+// Copy a TEXT column into a timestamp field ("" for NULL)
+static void column_ts(sqlite3_stmt* stmt, int col, char out[LATEST_TS_LEN]) {
+    const unsigned char* v = sqlite3_column_text(stmt, col);
+    memset(out, 0, LATEST_TS_LEN);
+    if (v != nullptr) {
+        strncpy(out, (const char*)v, LATEST_TS_LEN - 1);
+    }
+}
+
+bool Store::seed_latest(LatestTable* table) {
+    // Reset before reading: a reading committed meanwhile by another writer
+    // is then either in these queries or merged after the reset
+    table->reset();
+    static const char* const sql[] = {
+        "SELECT hive_id, observed_at, weight_kg, temp_c, humidity_pct, pressure_hpa, "
+        "battery_v, flags, sequence FROM (SELECT *, row_number() OVER "
+        "(PARTITION BY hive_id ORDER BY observed_at DESC) AS rn FROM sensor_readings) "
+        "WHERE rn = 1",
+        "SELECT hive_id, observed_at, bees_in, bees_out, period_ms, lane_mask, stuck_mask "
+        "FROM (SELECT *, row_number() OVER (PARTITION BY hive_id ORDER BY observed_at DESC) "
+        "AS rn FROM bee_counts) WHERE rn = 1",
+        "SELECT hive_id, MAX(ingested_at) FROM sensor_readings GROUP BY hive_id",
+    };
+    static const uint8_t has_bits[] = {LATEST_HAS_WEIGHT, LATEST_HAS_TEMP, LATEST_HAS_HUMIDITY,
+                                       LATEST_HAS_PRESSURE, LATEST_HAS_BATTERY};
+    for (int q = 0; q < 3; q++) {
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(_db, sql[q], -1, &stmt, nullptr) != SQLITE_OK) {
+            fprintf(stderr, "E sqlite: %s\n", sqlite3_errmsg(_db));
+            return false;
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int id = sqlite3_column_int(stmt, 0);
+            if (id < 0 || id >= (int)LATEST_SLOTS) {
+                continue;
+            }
+            if (q == 0) {
+                LatestReading r;
+                memset(&r, 0, sizeof(r));
+                column_ts(stmt, 1, r.observed_at);
+                double* values[] = {&r.weight_kg, &r.temp_c, &r.humidity_pct, &r.pressure_hpa,
+                                    &r.battery_v};
+                for (int v = 0; v < 5; v++) {
+                    if (sqlite3_column_type(stmt, 2 + v) != SQLITE_NULL) {
+                        *values[v] = sqlite3_column_double(stmt, 2 + v);
+                        r.present |= has_bits[v];
+                    }
+                }
+                r.flags = (uint8_t)sqlite3_column_int(stmt, 7);
+                r.sequence = (uint16_t)sqlite3_column_int(stmt, 8);
+                table->update((uint8_t)id, nullptr, &r, nullptr);
+            } else if (q == 1) {
+                LatestTraffic t;
+                memset(&t, 0, sizeof(t));
+                column_ts(stmt, 1, t.observed_at);
+                t.bees_in = (uint16_t)sqlite3_column_int(stmt, 2);
+                t.bees_out = (uint16_t)sqlite3_column_int(stmt, 3);
+                t.period_ms = (uint32_t)sqlite3_column_int64(stmt, 4);
+                t.lane_mask = (uint8_t)sqlite3_column_int(stmt, 5);
+                t.stuck_mask = (uint8_t)sqlite3_column_int(stmt, 6);
+                table->update((uint8_t)id, nullptr, nullptr, &t);
+            } else {
+                char ingested_at[LATEST_TS_LEN];
+                column_ts(stmt, 1, ingested_at);
+                table->update((uint8_t)id, ingested_at, nullptr, nullptr);
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+    table->mark_seeded();
+    return true;
+}
+
+static void bind_optional(sqlite3_stmt* stmt, int idx, bool has, double v) {
+    if (has) {
+        sqlite3_bind_double(stmt, idx, v);
+    } else {
+        sqlite3_bind_null(stmt, idx);
+    }
+}
+
+InsertResult Store::insert(const Reading& r, const char* ingested_at, int64_t* reading_id) {
+    if (!_in_txn) {
+        if (!exec("BEGIN IMMEDIATE")) {
+            return INSERT_ERROR;
+        }
+        _in_txn = true;
+    }
+
+    // Savepoint so a failed bee_counts insert rolls back its reading only,
+    // as the per-message transaction in process_message does
+    step(_savepoint);
+
+    sqlite3_stmt* s = _insert_reading;
+    sqlite3_bind_int(s, 1, r.hive_id);
+    sqlite3_bind_text(s, 2, r.observed_at, -1, SQLITE_STATIC);
+    sqlite3_bind_text(s, 3, ingested_at, -1, SQLITE_STATIC);
+    bind_optional(s, 4, r.has_weight, r.weight_kg);
+    bind_optional(s, 5, r.has_temp, r.temp_c);
+    bind_optional(s, 6, r.has_humidity, r.humidity_pct);
+    bind_optional(s, 7, r.has_pressure, r.pressure_hpa);
+    bind_optional(s, 8, r.has_battery, r.battery_v);
+    sqlite3_bind_int(s, 9, r.sequence);
+    sqlite3_bind_int(s, 10, r.flags);
+    sqlite3_bind_text(s, 11, r.sender_mac, -1, SQLITE_STATIC);
+    if (step(s) != SQLITE_DONE) {
+        fprintf(stderr, "E insert reading hive=%u seq=%u: %s\n", r.hive_id, r.sequence,
+                sqlite3_errmsg(_db));
+        step(_rollback_to);
+        step(_release);
+        return INSERT_ERROR;
+    }
+    if (sqlite3_changes(_db) == 0) {
+        step(_release);
+        return INSERT_DUPLICATE;
+    }
+    *reading_id = sqlite3_last_insert_rowid(_db);
+
+    if (r.has_traffic) {
+        s = _insert_counts;
+        sqlite3_bind_int64(s, 1, *reading_id);
+        sqlite3_bind_int(s, 2, r.hive_id);
+        sqlite3_bind_text(s, 3, r.observed_at, -1, SQLITE_STATIC);
+        sqlite3_bind_text(s, 4, ingested_at, -1, SQLITE_STATIC);
+        sqlite3_bind_int64(s, 5, r.period_ms);
+        sqlite3_bind_int(s, 6, r.bees_in);
+        sqlite3_bind_int(s, 7, r.bees_out);
+        sqlite3_bind_int(s, 8, r.lane_mask);
+        sqlite3_bind_int(s, 9, r.stuck_mask);
+        sqlite3_bind_int(s, 10, r.sequence);
+        sqlite3_bind_int(s, 11, r.flags);
+        sqlite3_bind_text(s, 12, r.sender_mac, -1, SQLITE_STATIC);
+        if (step(s) != SQLITE_DONE) {
+            fprintf(stderr, "E insert bee_counts for reading %lld: %s\n",
+                    (long long)*reading_id, sqlite3_errmsg(_db));
+            step(_rollback_to);
+            step(_release);
+            return INSERT_ERROR;
+        }
+    }
+    step(_release);
+
+    char* seen = _batch_seen[r.hive_id];
+    if (strcmp(r.observed_at, seen) > 0) {
+        memcpy(seen, r.observed_at, sizeof(_batch_seen[0]));
+    }
+    _pending++;
+    return INSERT_OK;
+}
+
+bool Store::commit() {
+    if (!_in_txn) {
+        return true;
+    }
+    for (int id = 1; id <= DEDUP_MAX_HIVE_ID; id++) {
+        if (_batch_seen[id][0] == '\0') {
+            continue;
+        }
+        sqlite3_bind_text(_update_seen, 1, _batch_seen[id], -1, SQLITE_STATIC);
+        sqlite3_bind_int(_update_seen, 2, id);
+        step(_update_seen);
+        _batch_seen[id][0] = '\0';
+    }
+    bool ok = exec("COMMIT");
+    if (!ok) {
+        exec("ROLLBACK");
+    }
+    _in_txn = false;
+    _pending = 0;
+    return ok;
+}
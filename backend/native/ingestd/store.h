@@ -0,0 +1,83 @@
+/**
+ * Waggle Hub — ingestd SQLite writer.
+ *
+ * Writes to the schema the backend creates (sensor_readings, bee_counts,
+ * hives.last_seen_at) with prepared statements inside batched
+ * transactions.  The database is opened with the backend's pragmas (WAL,
+ * foreign keys, synchronous=NORMAL, 30 s busy timeout) so the API and
+ * other services keep reading and writing while a batch is open.
+ */
+
+#ifndef WAGGLE_INGESTD_STORE_H
+#define WAGGLE_INGESTD_STORE_H
+
+#include <sqlite3.h>
+#include <stdint.h>
+
+#include "dedup.h"
+#include "latest_table.h"
+#include "reading.h"
+
+struct HiveInfo {
+    bool exists;
+    bool has_mac;
+    char sender_mac[18];
+};
+
+enum InsertResult : uint8_t {
+    INSERT_OK = 0,
+    INSERT_DUPLICATE,  // uq_readings_dedup already had the row
+    INSERT_ERROR,      // Constraint or I/O error (logged)
+};
+
+class Store {
+public:
+    Store();
+    ~Store();
+
+    /** Open an existing backend database; false (with a message) on error. */
+    bool open(const char* path);
+
+    /** Reload the hive table (existence and sender_mac). */
+    bool load_hives();
+    const HiveInfo& hive(uint8_t id) const { return _hives[id]; }
+
+    /** Seed the dedup cache with rows ingested within the TTL (warm_dedup_cache). */
+    bool warm_dedup(DedupCache* dedup, uint32_t now_s);
+
+    /**
+     * Rebuild the latest-state table: reset it, merge each hive's newest
+     * reading, bee_counts row and ingested_at, then mark it seeded.
+     */
+    bool seed_latest(LatestTable* table);
+
+    /** Insert one reading into the open batch, starting one if needed. */
+    InsertResult insert(const Reading& r, const char* ingested_at, int64_t* reading_id);
+
+    /** Advance last_seen_at for the batch's hives and commit; no-op when empty. */
+    bool commit();
+
+    /** Rows inserted into the open batch. */
+    uint32_t pending() const { return _pending; }
+
+    /** A batch transaction is open (it may hold only duplicates). */
+    bool in_batch() const { return _in_txn; }
+
+private:
+    bool exec(const char* sql);
+    bool prepare(const char* sql, sqlite3_stmt** stmt);
+
+    sqlite3*      _db;
+    sqlite3_stmt* _insert_reading;
+    sqlite3_stmt* _insert_counts;
+    sqlite3_stmt* _update_seen;
+    sqlite3_stmt* _savepoint;
+    sqlite3_stmt* _release;
+    sqlite3_stmt* _rollback_to;
+    bool          _in_txn;
+    uint32_t      _pending;
+    HiveInfo      _hives[DEDUP_MAX_HIVE_ID + 1];
+    char          _batch_seen[DEDUP_MAX_HIVE_ID + 1][25];  // Latest observed_at per hive
+};
+
+#endif  // WAGGLE_INGESTD_STORE_H
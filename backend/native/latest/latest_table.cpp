@@ -0,0 +1,195 @@
+/**
+ * Waggle Hub — shared-memory latest-state table (see latest_table.h).
+ */
+
+#include "latest_table.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(LatestHeader) == 64, "header is one cache line");
+static_assert(sizeof(LatestSlot) % 64 == 0, "slots are whole cache lines");
+static_assert(sizeof(LatestSlot) <= UINT16_MAX, "slot_size is a uint16");
+
+static constexpr size_t LATEST_TABLE_SIZE = sizeof(LatestHeader) + LATEST_SLOTS * sizeof(LatestSlot);
+
+// Spin budget: a writer holds a slot for a copy of ~150 bytes, but may be
+// preempted inside it.  Yield after the first few tries so it can finish.
+static constexpr int SPIN_TRIES  = 16;
+static constexpr int READ_TRIES  = 256;
+static constexpr int WRITE_TRIES = 4096;
+
+static std::string errno_message(const char* what, const char* path) {
+    return std::string(what) + " " + path + ": " + strerror(errno);
+}
+
+static bool header_matches(const LatestHeader* h) {
+    return h->magic == LATEST_MAGIC && h->version == LATEST_VERSION &&
+           h->slot_size == sizeof(LatestSlot) && h->slots == LATEST_SLOTS;
+}
+
+static void backoff(int attempt) {
+    if (attempt >= SPIN_TRIES) {
+        sched_yield();
+    }
+}
+
+LatestTable::LatestTable() : _header(nullptr), _slots(nullptr), _size(0), _writable(false) {}
+
+LatestTable::~LatestTable() {
+    close();
+}
+
+bool LatestTable::open(const char* path, bool writable, std::string* err) {
+    close();
+    int fd = ::open(path, writable ? (O_RDWR | O_CREAT | O_CLOEXEC) : (O_RDONLY | O_CLOEXEC),
+                    0644);
+    if (fd < 0) {
+        *err = errno_message("open", path);
+        return false;
+    }
+    // Writers size and format the file under an exclusive lock, so two
+    // writers starting together agree on one layout
+    if (writable && flock(fd, LOCK_EX) != 0) {
+        *err = errno_message("flock", path);
+        ::close(fd);
+        return false;
+    }
+    bool ok = false;
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) != 0) {
+        *err = errno_message("fstat", path);
+        goto done;
+    }
+    if ((size_t)st.st_size != LATEST_TABLE_SIZE) {
+        if (!writable) {
+            *err = std::string("not a latest-state table of this layout: ") + path;
+            goto done;
+        }
+        if (ftruncate(fd, (off_t)LATEST_TABLE_SIZE) != 0) {
+            *err = errno_message("ftruncate", path);
+            goto done;
+        }
+    }
+    map = mmap(nullptr, LATEST_TABLE_SIZE, writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+               MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        *err = errno_message("mmap", path);
+        goto done;
+    }
+    _header = (LatestHeader*)map;
+    if (!header_matches(_header)) {
+        if (!writable) {
+            *err = std::string("not a latest-state table of this layout: ") + path;
+            munmap(map, LATEST_TABLE_SIZE);
+            _header = nullptr;
+            goto done;
+        }
+        memset(map, 0, LATEST_TABLE_SIZE);
+        _header->magic = LATEST_MAGIC;
+        _header->version = LATEST_VERSION;
+        _header->slot_size = (uint16_t)sizeof(LatestSlot);
+        _header->slots = LATEST_SLOTS;
+    }
+    _slots = (LatestSlot*)((uint8_t*)map + sizeof(LatestHeader));
+    _size = LATEST_TABLE_SIZE;
+    _writable = writable;
+    ok = true;
+done:
+    ::close(fd);  // Drops the flock; the mapping stays valid
+    return ok;
+}
+
+void LatestTable::close() {
+    if (_header != nullptr) {
+        munmap(_header, _size);
+    }
+    _header = nullptr;
+    _slots = nullptr;
+    _size = 0;
+    _writable = false;
+}
+
+bool LatestTable::seeded() const {
+    return _header != nullptr && _header->seeded.load(std::memory_order_acquire) == 1;
+}
+
+void LatestTable::reset() {
+    _header->seeded.store(0, std::memory_order_release);
+    for (uint32_t i = 0; i < LATEST_SLOTS; i++) {
+        // Taken unconditionally: an odd counter here is a writer that died
+        std::atomic<uint32_t>& seq = _slots[i].seq;
+        uint32_t s = seq.load(std::memory_order_relaxed) | 1;
+        seq.store(s, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memset(&_slots[i].state, 0, sizeof(LatestState));
+        seq.store(s + 1, std::memory_order_release);
+    }
+}
+
+void LatestTable::mark_seeded() {
+    _header->seeded.store(1, std::memory_order_release);
+}
+
+bool LatestTable::update(uint8_t hive_id, const char* ingested_at, const LatestReading* reading,
+                         const LatestTraffic* traffic) {
+    LatestSlot* slot = &_slots[hive_id];
+    uint32_t s = 0;
+    bool taken = false;
+    for (int attempt = 0; attempt < WRITE_TRIES && !taken; attempt++) {
+        s = slot->seq.load(std::memory_order_relaxed);
+        taken = !(s & 1) && slot->seq.compare_exchange_weak(s, s + 1, std::memory_order_acquire,
+                                                            std::memory_order_relaxed);
+        if (!taken) {
+            backoff(attempt);
+        }
+    }
+    if (!taken) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    LatestState* st = &slot->state;
+    if (ingested_at != nullptr && strncmp(ingested_at, st->last_ingested_at, LATEST_TS_LEN) > 0) {
+        strncpy(st->last_ingested_at, ingested_at, LATEST_TS_LEN - 1);
+        st->last_ingested_at[LATEST_TS_LEN - 1] = '\0';
+    }
+    // On an observed_at tie the later write wins (SQLite's row_number() may
+    // pick either row)
+    if (reading != nullptr &&
+        strncmp(reading->observed_at, st->reading.observed_at, LATEST_TS_LEN) >= 0) {
+        st->reading = *reading;
+        st->reading.observed_at[LATEST_TS_LEN - 1] = '\0';
+    }
+    if (traffic != nullptr &&
+        strncmp(traffic->observed_at, st->traffic.observed_at, LATEST_TS_LEN) >= 0) {
+        st->traffic = *traffic;
+        st->traffic.observed_at[LATEST_TS_LEN - 1] = '\0';
+    }
+
+    slot->seq.store(s + 2, std::memory_order_release);
+    return true;
+}
+
+LatestReadResult LatestTable::read(uint8_t hive_id, LatestState* out) const {
+    const LatestSlot* slot = &_slots[hive_id];
+    for (int attempt = 0; attempt < READ_TRIES; attempt++) {
+        uint32_t s1 = slot->seq.load(std::memory_order_acquire);
+        if (!(s1 & 1)) {
+            memcpy(out, &slot->state, sizeof(LatestState));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot->seq.load(std::memory_order_relaxed) == s1) {
+                return LATEST_OK;
+            }
+        }
+        backoff(attempt);
+    }
+    return LATEST_BUSY;
+}
@@ -0,0 +1,148 @@
+/**
+ * Waggle Hub — shared-memory table of each hive's latest state.
+ *
+ * The hives list, hive detail and hub status endpoints want the newest
+ * sensor_readings row and the newest bee_counts row of every hive, which
+ * in SQLite is a row_number() window over the whole readings table on every
+ * request.  The ingestion path (ingestd, or IngestionService) already has
+ * those rows in hand when it commits them, so it also writes them into a
+ * fixed-layout table in a shared-memory file (/dev/shm) that the API maps
+ * read-only and reads in O(1) per hive.
+ *
+ * The table is a LatestHeader followed by LATEST_SLOTS slots indexed by
+ * hive_id (the payload's uint8).  A slot holds the converted fields of the
+ * payload (payload.h, in the hub's units and with the hub's NULLs) for the
+ * hive's newest reading by observed_at, the Phase 2 traffic fields of its
+ * newest stored bee_counts row, and the hive's newest ingested_at — the
+ * same rows the SQL queries pick, compared the same way (canonical
+ * observed_at strings).
+ *
+ * Each slot is guarded by a sequence lock: a writer takes the slot by
+ * moving its counter from even to odd, updates it, and makes it even
+ * again; a reader copies the slot and retries if the counter was odd or
+ * changed meanwhile.  Readers never block writers and take no lock.
+ * Writers on the same slot (ingestd and a Python writer) exclude each
+ * other through the counter and merge: an update only replaces a reading
+ * or traffic row observed no later than the new one.
+ *
+ * After (re)building the table from SQLite a writer marks it seeded; until
+ * then readers must use SQL.  A writer that died inside a slot leaves it
+ * odd: reads of it fail (LATEST_BUSY) until the next writer start resets
+ * the table.
+ */
+
+#ifndef WAGGLE_LATEST_TABLE_H
+#define WAGGLE_LATEST_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "sequence counters must be lock-free across processes");
+
+static constexpr uint32_t LATEST_MAGIC   = 0x5457474Cu;  // "LGWT"
+static constexpr uint16_t LATEST_VERSION = 1;
+static constexpr uint32_t LATEST_SLOTS   = 256;          // One per uint8 hive_id
+static constexpr size_t   LATEST_TS_LEN  = 25;           // "YYYY-MM-DDTHH:MM:SS.mmmZ" + NUL
+
+// LatestReading.present bits; a clear bit is SQL NULL
+static constexpr uint8_t LATEST_HAS_WEIGHT   = 1 << 0;
+static constexpr uint8_t LATEST_HAS_TEMP     = 1 << 1;
+static constexpr uint8_t LATEST_HAS_HUMIDITY = 1 << 2;
+static constexpr uint8_t LATEST_HAS_PRESSURE = 1 << 3;
+static constexpr uint8_t LATEST_HAS_BATTERY  = 1 << 4;
+
+/** Newest sensor_readings row; observed_at "" = the hive has none. */
+struct LatestReading {
+    char     observed_at[LATEST_TS_LEN];
+    uint8_t  present;   // LATEST_HAS_*
+    uint8_t  flags;
+    uint16_t sequence;
+    double   weight_kg;
+    double   temp_c;
+    double   humidity_pct;
+    double   pressure_hpa;
+    double   battery_v;
+};
+
+/** Newest bee_counts row; observed_at "" = the hive has none. */
+struct LatestTraffic {
+    char     observed_at[LATEST_TS_LEN];
+    uint8_t  lane_mask;
+    uint8_t  stuck_mask;
+    uint16_t bees_in;
+    uint16_t bees_out;
+    uint32_t period_ms;
+};
+
+/** What a reader gets for one hive. */
+struct LatestState {
+    char          last_ingested_at[LATEST_TS_LEN];  // "" = nothing ingested
+    LatestReading reading;
+    LatestTraffic traffic;
+};
+
+struct alignas(64) LatestSlot {
+    std::atomic<uint32_t> seq;  // Odd while a writer is inside
+    LatestState           state;
+};
+
+struct alignas(64) LatestHeader {
+    uint32_t              magic;
+    uint16_t              version;
+    uint16_t              slot_size;
+    uint32_t              slots;
+    std::atomic<uint32_t> seeded;  // 1 once built from SQLite
+};
+
+enum LatestReadResult : uint8_t {
+    LATEST_OK = 0,
+    LATEST_BUSY,  // Slot kept changing (or a writer died in it)
+};
+
+class LatestTable {
+public:
+    LatestTable();
+    ~LatestTable();
+    LatestTable(const LatestTable&) = delete;
+    LatestTable& operator=(const LatestTable&) = delete;
+
+    /**
+     * Map the table at path.  A writer creates and sizes the file; a reader
+     * needs an existing table of this layout.  False (with a message in
+     * *err) on error.
+     */
+    bool open(const char* path, bool writable, std::string* err);
+    void close();
+
+    bool is_open() const { return _header != nullptr; }
+    bool writable() const { return _writable; }
+    bool seeded() const;
+
+    /** Empty every slot and clear seeded (writer start, before seeding). */
+    void reset();
+
+    /** Mark the table as matching SQLite. */
+    void mark_seeded();
+
+    /**
+     * Merge a committed reading and/or its bee_counts row into the hive's
+     * slot (either may be null).  ingested_at may be null too (seeding
+     * traffic alone).  False if the slot stayed locked by another writer.
+     */
+    bool update(uint8_t hive_id, const char* ingested_at, const LatestReading* reading,
+                const LatestTraffic* traffic);
+
+    /** Consistent copy of the hive's slot. */
+    LatestReadResult read(uint8_t hive_id, LatestState* out) const;
+
+private:
+    LatestHeader* _header;
+    LatestSlot*   _slots;
+    size_t        _size;
+    bool          _writable;
+};
+
+#endif  // WAGGLE_LATEST_TABLE_H
@@ -0,0 +1,362 @@
+/**
+ * Waggle Hub — waggle._latest: CPython binding for the latest-state table.
+ *
+ *   Table(path, writable=False)
+ *     .update(hive_id, ingested_at, reading, traffic) -> bool
+ *     .read(hive_id) -> (last_ingested_at, reading, traffic) or None
+ *     .read_all() -> [(hive_id, last_ingested_at, reading, traffic)] or None
+ *     .reset(), .mark_seeded(), .seeded()
+ *
+ * reading is (observed_at, weight_kg, temp_c, humidity_pct, pressure_hpa,
+ * battery_v, flags, sequence) with None for a NULL value, traffic is
+ * (observed_at, bees_in, bees_out, period_ms, lane_mask, stuck_mask); either
+ * may be None (nothing to merge, or the hive has no such row).  read()
+ * returns None when the slot could not be read consistently and read_all()
+ * lists the hives that have anything, or None if any slot failed; the
+ * caller then queries SQLite.  update() returns False if the slot stayed
+ * locked.  waggle/services/latest_state.py wraps this module.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <string.h>
+
+#include "latest_table.h"
+
+struct TableObject {
+    PyObject_HEAD
+    LatestTable* table;
+};
+
+static constexpr Py_ssize_t READING_FIELDS = 8;
+static constexpr Py_ssize_t TRAFFIC_FIELDS = 6;
+
+static PyObject* table_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"path", "writable", nullptr};
+    const char* path = nullptr;
+    int writable = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|p", (char**)kwlist, &path, &writable)) {
+        return nullptr;
+    }
+    TableObject* self = (TableObject*)type->tp_alloc(type, 0);
+    if (self == nullptr) {
+        return nullptr;
+    }
+    self->table = new LatestTable();
+    std::string err;
+    if (!self->table->open(path, writable != 0, &err)) {
+        Py_DECREF(self);
+        PyErr_SetString(PyExc_OSError, err.c_str());
+        return nullptr;
+    }
+    return (PyObject*)self;
+}
+
+static void table_dealloc(TableObject* self) {
+    delete self->table;
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static bool writable_or_raise(TableObject* self) {
+    if (!self->table->writable()) {
+        PyErr_SetString(PyExc_PermissionError, "table was opened read-only");
+        return false;
+    }
+    return true;
+}
+
+static bool hive_arg(int hive_id) {
+    if (hive_id < 0 || hive_id >= (int)LATEST_SLOTS) {
+        PyErr_Format(PyExc_ValueError, "hive_id must be 0-%u", LATEST_SLOTS - 1);
+        return false;
+    }
+    return true;
+}
+
+// ---- tuples -> structs ----
+
+static bool copy_ts(PyObject* obj, char out[LATEST_TS_LEN]) {
+    Py_ssize_t n = 0;
+    const char* s = PyUnicode_AsUTF8AndSize(obj, &n);
+    if (s == nullptr) {
+        return false;
+    }
+    if (n >= (Py_ssize_t)LATEST_TS_LEN) {
+        PyErr_SetString(PyExc_ValueError, "timestamp longer than YYYY-MM-DDTHH:MM:SS.mmmZ");
+        return false;
+    }
+    memset(out, 0, LATEST_TS_LEN);
+    memcpy(out, s, (size_t)n);
+    return true;
+}
+
+static bool uint_field(PyObject* obj, unsigned long max, unsigned long* out) {
+    unsigned long v = PyLong_AsUnsignedLong(obj);
+    if (v == (unsigned long)-1 && PyErr_Occurred()) {
+        return false;
+    }
+    if (v > max) {
+        PyErr_Format(PyExc_ValueError, "value %lu out of range", v);
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+static bool reading_from_tuple(PyObject* obj, LatestReading* r) {
+    PyObject* seq = PySequence_Fast(obj, "reading must be a tuple");
+    if (seq == nullptr) {
+        return false;
+    }
+    bool ok = false;
+    PyObject** f = PySequence_Fast_ITEMS(seq);
+    static const uint8_t bits[] = {LATEST_HAS_WEIGHT, LATEST_HAS_TEMP, LATEST_HAS_HUMIDITY,
+                                   LATEST_HAS_PRESSURE, LATEST_HAS_BATTERY};
+    double* values[] = {&r->weight_kg, &r->temp_c, &r->humidity_pct, &r->pressure_hpa,
+                        &r->battery_v};
+    unsigned long flags = 0, sequence = 0;
+    memset(r, 0, sizeof(*r));
+    if (PySequence_Fast_GET_SIZE(seq) != READING_FIELDS) {
+        PyErr_Format(PyExc_ValueError, "reading must have %zd fields", READING_FIELDS);
+        goto done;
+    }
+    if (!copy_ts(f[0], r->observed_at)) {
+        goto done;
+    }
+    for (int v = 0; v < 5; v++) {
+        if (f[1 + v] == Py_None) {
+            continue;
+        }
+        *values[v] = PyFloat_AsDouble(f[1 + v]);
+        if (*values[v] == -1.0 && PyErr_Occurred()) {
+            goto done;
+        }
+        r->present |= bits[v];
+    }
+    if (!uint_field(f[6], 0xFF, &flags) || !uint_field(f[7], 0xFFFF, &sequence)) {
+        goto done;
+    }
+    r->flags = (uint8_t)flags;
+    r->sequence = (uint16_t)sequence;
+    ok = true;
+done:
+    Py_DECREF(seq);
+    return ok;
+}
+
+static bool traffic_from_tuple(PyObject* obj, LatestTraffic* t) {
+    PyObject* seq = PySequence_Fast(obj, "traffic must be a tuple");
+    if (seq == nullptr) {
+        return false;
+    }
+    bool ok = false;
+    PyObject** f = PySequence_Fast_ITEMS(seq);
+    unsigned long bees_in = 0, bees_out = 0, period_ms = 0, lane_mask = 0, stuck_mask = 0;
+    memset(t, 0, sizeof(*t));
+    if (PySequence_Fast_GET_SIZE(seq) != TRAFFIC_FIELDS) {
+        PyErr_Format(PyExc_ValueError, "traffic must have %zd fields", TRAFFIC_FIELDS);
+        goto done;
+    }
+    if (!copy_ts(f[0], t->observed_at) || !uint_field(f[1], 0xFFFF, &bees_in) ||
+        !uint_field(f[2], 0xFFFF, &bees_out) || !uint_field(f[3], 0xFFFFFFFFul, &period_ms) ||
+        !uint_field(f[4], 0xFF, &lane_mask) || !uint_field(f[5], 0xFF, &stuck_mask)) {
+        goto done;
+    }
+    t->bees_in = (uint16_t)bees_in;
+    t->bees_out = (uint16_t)bees_out;
+    t->period_ms = (uint32_t)period_ms;
+    t->lane_mask = (uint8_t)lane_mask;
+    t->stuck_mask = (uint8_t)stuck_mask;
+    ok = true;
+done:
+    Py_DECREF(seq);
+    return ok;
+}
+
+// ---- structs -> tuples ----
+
+static PyObject* optional_float(const LatestReading& r, uint8_t bit, double v) {
+    if (!(r.present & bit)) {
+        Py_RETURN_NONE;
+    }
+    return PyFloat_FromDouble(v);
+}
+
+// New references to the three parts of a state, or false with all null
+static bool state_parts(const LatestState& st, PyObject* parts[3]) {
+    if (st.last_ingested_at[0]) {
+        parts[0] = PyUnicode_FromString(st.last_ingested_at);
+    } else {
+        Py_INCREF(Py_None);
+        parts[0] = Py_None;
+    }
+    if (st.reading.observed_at[0]) {
+        const LatestReading& r = st.reading;
+        parts[1] = Py_BuildValue(
+            "(sNNNNNII)", r.observed_at, optional_float(r, LATEST_HAS_WEIGHT, r.weight_kg),
+            optional_float(r, LATEST_HAS_TEMP, r.temp_c),
+            optional_float(r, LATEST_HAS_HUMIDITY, r.humidity_pct),
+            optional_float(r, LATEST_HAS_PRESSURE, r.pressure_hpa),
+            optional_float(r, LATEST_HAS_BATTERY, r.battery_v), (unsigned)r.flags,
+            (unsigned)r.sequence);
+    } else {
+        Py_INCREF(Py_None);
+        parts[1] = Py_None;
+    }
+    if (st.traffic.observed_at[0]) {
+        const LatestTraffic& t = st.traffic;
+        parts[2] = Py_BuildValue("(sIIIII)", t.observed_at, (unsigned)t.bees_in,
+                                 (unsigned)t.bees_out, (unsigned)t.period_ms,
+                                 (unsigned)t.lane_mask, (unsigned)t.stuck_mask);
+    } else {
+        Py_INCREF(Py_None);
+        parts[2] = Py_None;
+    }
+    if (parts[0] == nullptr || parts[1] == nullptr || parts[2] == nullptr) {
+        for (int i = 0; i < 3; i++) {
+            Py_CLEAR(parts[i]);
+        }
+        return false;
+    }
+    return true;
+}
+
+// ---- methods ----
+
+static PyObject* table_update(TableObject* self, PyObject* args) {
+    int hive_id = 0;
+    PyObject* ingested_obj = nullptr;
+    PyObject* reading_obj = nullptr;
+    PyObject* traffic_obj = nullptr;
+    if (!PyArg_ParseTuple(args, "iOOO", &hive_id, &ingested_obj, &reading_obj, &traffic_obj) ||
+        !hive_arg(hive_id) || !writable_or_raise(self)) {
+        return nullptr;
+    }
+    char ingested_at[LATEST_TS_LEN];
+    LatestReading reading;
+    LatestTraffic traffic;
+    if ((ingested_obj != Py_None && !copy_ts(ingested_obj, ingested_at)) ||
+        (reading_obj != Py_None && !reading_from_tuple(reading_obj, &reading)) ||
+        (traffic_obj != Py_None && !traffic_from_tuple(traffic_obj, &traffic))) {
+        return nullptr;
+    }
+    bool ok = self->table->update((uint8_t)hive_id,
+                                  ingested_obj != Py_None ? ingested_at : nullptr,
+                                  reading_obj != Py_None ? &reading : nullptr,
+                                  traffic_obj != Py_None ? &traffic : nullptr);
+    return PyBool_FromLong(ok);
+}
+
+static PyObject* table_read(TableObject* self, PyObject* args) {
+    int hive_id = 0;
+    if (!PyArg_ParseTuple(args, "i", &hive_id) || !hive_arg(hive_id)) {
+        return nullptr;
+    }
+    LatestState st;
+    if (self->table->read((uint8_t)hive_id, &st) != LATEST_OK) {
+        Py_RETURN_NONE;
+    }
+    PyObject* parts[3];
+    if (!state_parts(st, parts)) {
+        return nullptr;
+    }
+    return Py_BuildValue("(NNN)", parts[0], parts[1], parts[2]);
+}
+
+static PyObject* table_read_all(TableObject* self, PyObject*) {
+    PyObject* out = PyList_New(0);
+    if (out == nullptr) {
+        return nullptr;
+    }
+    for (uint32_t h = 0; h < LATEST_SLOTS; h++) {
+        LatestState st;
+        if (self->table->read((uint8_t)h, &st) != LATEST_OK) {
+            Py_DECREF(out);
+            Py_RETURN_NONE;
+        }
+        if (st.last_ingested_at[0] == '\0' && st.reading.observed_at[0] == '\0' &&
+            st.traffic.observed_at[0] == '\0') {
+            continue;
+        }
+        PyObject* parts[3];
+        PyObject* item = state_parts(st, parts)
+                             ? Py_BuildValue("(INNN)", h, parts[0], parts[1], parts[2])
+                             : nullptr;
+        if (item == nullptr || PyList_Append(out, item) < 0) {
+            Py_XDECREF(item);
+            Py_DECREF(out);
+            return nullptr;
+        }
+        Py_DECREF(item);
+    }
+    return out;
+}
+
+static PyObject* table_reset(TableObject* self, PyObject*) {
+    if (!writable_or_raise(self)) {
+        return nullptr;
+    }
+    self->table->reset();
+    Py_RETURN_NONE;
+}
+
+static PyObject* table_mark_seeded(TableObject* self, PyObject*) {
+    if (!writable_or_raise(self)) {
+        return nullptr;
+    }
+    self->table->mark_seeded();
+    Py_RETURN_NONE;
+}
+
+static PyObject* table_seeded(TableObject* self, PyObject*) {
+    return PyBool_FromLong(self->table->seeded());
+}
+
+static PyMethodDef s_table_methods[] = {
+    {"update", (PyCFunction)table_update, METH_VARARGS,
+     "update(hive_id, ingested_at, reading, traffic) -> bool"},
+    {"read", (PyCFunction)table_read, METH_VARARGS,
+     "read(hive_id) -> (last_ingested_at, reading, traffic) or None"},
+    {"read_all", (PyCFunction)table_read_all, METH_NOARGS,
+     "read_all() -> [(hive_id, last_ingested_at, reading, traffic)] or None"},
+    {"reset", (PyCFunction)table_reset, METH_NOARGS, "Empty every slot; clears seeded."},
+    {"mark_seeded", (PyCFunction)table_mark_seeded, METH_NOARGS,
+     "Mark the table as matching SQLite."},
+    {"seeded", (PyCFunction)table_seeded, METH_NOARGS, "True once built from SQLite."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+static PyTypeObject s_table_type = {PyVarObject_HEAD_INIT(nullptr, 0)};
+
+static struct PyModuleDef s_module = {
+    PyModuleDef_HEAD_INIT, "waggle._latest",
+    "Shared-memory table of each hive's latest reading and traffic.", -1, nullptr,
+};
+
+PyMODINIT_FUNC PyInit__latest(void) {
+    s_table_type.tp_name = "waggle._latest.Table";
+    s_table_type.tp_basicsize = sizeof(TableObject);
+    s_table_type.tp_flags = Py_TPFLAGS_DEFAULT;
+    s_table_type.tp_doc = "Table(path, writable=False): the mapped latest-state table.";
+    s_table_type.tp_new = table_new;
+    s_table_type.tp_dealloc = (destructor)table_dealloc;
+    s_table_type.tp_methods = s_table_methods;
+    if (PyType_Ready(&s_table_type) < 0) {
+        return nullptr;
+    }
+
+    PyObject* m = PyModule_Create(&s_module);
+    if (m == nullptr) {
+        return nullptr;
+    }
+    Py_INCREF(&s_table_type);
+    if (PyModule_AddObject(m, "Table", (PyObject*)&s_table_type) < 0 ||
+        PyModule_AddIntConstant(m, "SLOTS", LATEST_SLOTS) < 0 ||
+        PyModule_AddIntConstant(m, "VERSION", LATEST_VERSION) < 0) {
+        Py_DECREF(&s_table_type);
+        Py_DECREF(m);
+        return nullptr;
+    }
+    return m;
+}
@@ -0,0 +1,567 @@
+/**
+ * Waggle Hub — JPEG decode and letterbox for the ML worker (see preprocess.h).
+ */
+
+#include "preprocess.h"
+
+#include <math.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <jpeglib.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define PP_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define PP_NEON 1
+#endif
+
+// Resize weights are 7-bit so both weights of a blend fit a u8 lane (NEON
+// vmull_u8) and a blended pixel fits a u16 lane
+static constexpr int      FRAC_BITS = 7;
+static constexpr uint32_t FRAC_ONE  = 1u << FRAC_BITS;
+
+// A photo is never decoded at more than this many times the input size;
+// only a JPEG over 32x the input even at 1/8 scale is refused
+static constexpr uint32_t MAX_DECODE_FACTOR = 4;
+
+size_t pp_output_size(uint32_t size, PpFormat fmt) {
+    size_t n = 3 * (size_t)size * size;
+    return fmt == PP_FLOAT32 ? n * sizeof(float) : n;
+}
+
+// ---- Geometry ----
+
+static uint32_t round_half_even(double v) {
+    return (uint32_t)nearbyint(v);  // Python's round(), as ultralytics uses
+}
+
+static void letterbox_geometry(uint32_t size, PpLetterbox* lb) {
+    lb->scale = std::min((double)size / lb->orig_w, (double)size / lb->orig_h);
+    lb->new_w = std::min(size, std::max(1u, round_half_even(lb->orig_w * lb->scale)));
+    lb->new_h = std::min(size, std::max(1u, round_half_even(lb->orig_h * lb->scale)));
+    // round(d / 2 - 0.1) before the image, the odd pixel after it
+    lb->pad_x = (size - lb->new_w) / 2;
+    lb->pad_y = (size - lb->new_h) / 2;
+}
+
+static inline uint32_t scaled_dim(uint32_t dim, uint32_t num) {
+    return (dim * num + 7) / 8;  // jdiv_round_up, as libjpeg sizes the output
+}
+
+/**
+ * Smallest DCT scale num/8 whose output still covers the letterboxed size.
+ * Only 1/8, 1/4 and 1/2 have SIMD IDCTs in libjpeg-turbo; the other
+ * eighths are scalar and slower than a full-size decode.
+ */
+static uint32_t pick_scale_num(const PpLetterbox& lb) {
+    for (uint32_t num = 1; num < 8; num *= 2) {
+        if (scaled_dim(lb.orig_w, num) >= lb.new_w && scaled_dim(lb.orig_h, num) >= lb.new_h) {
+            return num;
+        }
+    }
+    return 8;
+}
+
+// ---- Decode ----
+
+struct JpegError {
+    jpeg_error_mgr mgr;
+    jmp_buf        jump;
+    char           message[JMSG_LENGTH_MAX];
+};
+
+static void on_jpeg_error(j_common_ptr cinfo) {
+    JpegError* e = (JpegError*)cinfo->err;
+    (*cinfo->err->format_message)(cinfo, e->message);
+    longjmp(e->jump, 1);
+}
+
+static void on_jpeg_message(j_common_ptr) {}  // Warnings (e.g. a truncated scan) are not fatal
+
+/**
+ * Decode at the scale letterbox_geometry() needs into *rgb (interleaved).
+ * Only C objects live in this frame, so the longjmp from on_jpeg_error
+ * skips no destructors; *rgb belongs to the caller.
+ */
+static bool decode_scaled(const uint8_t* jpeg, size_t len, uint32_t size,
+                          std::vector<uint8_t>* rgb, std::vector<JSAMPROW>* rows,
+                          PpLetterbox* lb, std::string* err) {
+    jpeg_decompress_struct cinfo;
+    JpegError jerr;
+    cinfo.err = jpeg_std_error(&jerr.mgr);
+    jerr.mgr.error_exit = on_jpeg_error;
+    jerr.mgr.output_message = on_jpeg_message;
+    if (setjmp(jerr.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        *err = std::string("jpeg: ") + jerr.message;
+        return false;
+    }
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, (unsigned char*)jpeg, (unsigned long)len);
+    jpeg_read_header(&cinfo, TRUE);
+
+    lb->orig_w = cinfo.image_width;
+    lb->orig_h = cinfo.image_height;
+    letterbox_geometry(size, lb);
+    cinfo.scale_num = pick_scale_num(*lb);
+    cinfo.scale_denom = 8;
+    cinfo.out_color_space = JCS_RGB;
+    // Fancy (triangle) chroma upsampling, the default, as OpenCV decodes
+    // the photos the model was trained on
+    jpeg_calc_output_dimensions(&cinfo);
+    if (cinfo.output_width > MAX_DECODE_FACTOR * size ||
+        cinfo.output_height > MAX_DECODE_FACTOR * size) {
+        jpeg_destroy_decompress(&cinfo);
+        *err = "jpeg: image too large";
+        return false;
+    }
+
+    jpeg_start_decompress(&cinfo);
+    lb->decoded_w = cinfo.output_width;
+    lb->decoded_h = cinfo.output_height;
+    size_t stride = (size_t)lb->decoded_w * 3;
+    rgb->resize(stride * lb->decoded_h);
+    rows->resize(lb->decoded_h);
+    for (uint32_t y = 0; y < lb->decoded_h; y++) {
+        (*rows)[y] = rgb->data() + y * stride;
+    }
+    // Whole row groups per call, so libjpeg writes rows in place
+    while (cinfo.output_scanline < cinfo.output_height) {
+        jpeg_read_scanlines(&cinfo, rows->data() + cinfo.output_scanline,
+                            cinfo.output_height - cinfo.output_scanline);
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
+
+// ---- Taps ----
+
+/**
+ * Source samples and weight of each output position (cv2 INTER_LINEAR
+ * centres), and the same in blocks of 8 outputs for the SIMD resample:
+ * after DCT scaling the downscale is under 2x (short of a photo over 16x
+ * the input), so a block's 16 taps sit in the 16 source bytes from its
+ * first one and one table lookup fetches them.
+ */
+struct Taps {
+    std::vector<uint32_t> index;          // First source sample
+    std::vector<uint32_t> next;           // Second source sample (== index at the edge)
+    std::vector<uint8_t>  weight;         // Of the second sample, 0..FRAC_ONE
+    std::vector<uint32_t> block_base;     // index of the block's first output
+    std::vector<uint8_t>  block_shuffle;  // 16 per block: index - base, then next - base
+    bool                  windowed;       // Every block fits its 16-byte window
+};
+
+static Taps build_taps(uint32_t src, uint32_t dst) {
+    Taps t;
+    t.index.resize(dst);
+    t.next.resize(dst);
+    t.weight.resize(dst);
+    double ratio = (double)src / dst;
+    for (uint32_t d = 0; d < dst; d++) {
+        double f = std::max(0.0, (d + 0.5) * ratio - 0.5);
+        uint32_t i = std::min((uint32_t)f, src - 1);
+        uint32_t w = (uint32_t)lround((f - i) * FRAC_ONE);
+        if (w == FRAC_ONE && i + 1 < src) {
+            i++;
+            w = 0;
+        }
+        t.index[d] = i;
+        t.next[d] = std::min(i + 1, src - 1);
+        t.weight[d] = (uint8_t)(t.next[d] == i ? 0 : w);
+    }
+
+    uint32_t blocks = dst / 8;
+    t.block_base.resize(blocks);
+    t.block_shuffle.resize(16 * (size_t)blocks);
+    t.windowed = true;
+    for (uint32_t k = 0; k < blocks; k++) {
+        uint32_t base = t.index[8 * k];
+        t.block_base[k] = base;
+        for (uint32_t j = 0; j < 8; j++) {
+            uint32_t a = t.index[8 * k + j] - base;
+            uint32_t b = t.next[8 * k + j] - base;
+            t.windowed = t.windowed && b < 16;
+            t.block_shuffle[16 * k + j] = (uint8_t)std::min(a, 15u);
+            t.block_shuffle[16 * k + 8 + j] = (uint8_t)std::min(b, 15u);
+        }
+    }
+    return t;
+}
+
+// ---- Row kernels ----
+
+/** Interleaved RGB pixels [first, n) -> planes r, g, b. */
+static void split_rgb_scalar(const uint8_t* __restrict src, size_t first, size_t n,
+                             uint8_t* __restrict r, uint8_t* __restrict g,
+                             uint8_t* __restrict b) {
+    for (size_t x = first; x < n; x++) {
+        r[x] = src[3 * x];
+        g[x] = src[3 * x + 1];
+        b[x] = src[3 * x + 2];
+    }
+}
+
+static void split_rgb_plain(const uint8_t* src, size_t n, uint8_t* r, uint8_t* g, uint8_t* b) {
+    split_rgb_scalar(src, 0, n, r, g, b);
+}
+
+/** Resample one plane's outputs [first, dst_w). */
+static void resample_plane_scalar(const uint8_t* __restrict p, const Taps& tx, uint32_t first,
+                                  uint32_t dst_w, uint8_t* __restrict out) {
+    for (uint32_t x = first; x < dst_w; x++) {
+        uint32_t w1 = tx.weight[x];
+        out[x] = (uint8_t)((p[tx.index[x]] * (FRAC_ONE - w1) + p[tx.next[x]] * w1 +
+                            FRAC_ONE / 2) >> FRAC_BITS);
+    }
+}
+
+#if defined(PP_SSE2)
+/** pshufb masks taking channel c of 16 pixels from each of the 3 input vectors. */
+struct SplitMasks {
+    uint8_t m[3][3][16];  // [channel][input vector][lane], 0x80 = zero
+};
+
+static SplitMasks build_split_masks() {
+    SplitMasks t;
+    for (int c = 0; c < 3; c++) {
+        for (int k = 0; k < 3; k++) {
+            for (int j = 0; j < 16; j++) {
+                int at = 3 * j + c;
+                t.m[c][k][j] = at / 16 == k ? (uint8_t)(at % 16) : 0x80;
+            }
+        }
+    }
+    return t;
+}
+
+__attribute__((target("ssse3")))
+static void split_rgb_ssse3(const uint8_t* src, size_t n, uint8_t* r, uint8_t* g, uint8_t* b) {
+    static const SplitMasks t = build_split_masks();
+    uint8_t* planes[3] = {r, g, b};
+    __m128i mask[3][3];
+    for (int c = 0; c < 3; c++) {
+        for (int k = 0; k < 3; k++) {
+            mask[c][k] = _mm_loadu_si128((const __m128i*)t.m[c][k]);
+        }
+    }
+    size_t x = 0;
+    for (; x + 16 <= n; x += 16) {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)(src + 3 * x));
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(src + 3 * x + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i*)(src + 3 * x + 32));
+        for (int c = 0; c < 3; c++) {
+            __m128i p = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v0, mask[c][0]),
+                                                  _mm_shuffle_epi8(v1, mask[c][1])),
+                                     _mm_shuffle_epi8(v2, mask[c][2]));
+            _mm_storeu_si128((__m128i*)(planes[c] + x), p);
+        }
+    }
+    split_rgb_scalar(src, x, n, r, g, b);
+}
+
+__attribute__((target("ssse3")))
+static void resample_plane_ssse3(const uint8_t* p, const Taps& tx, uint32_t dst_w,
+                                 uint8_t* out) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16((short)FRAC_ONE);
+    const __m128i half = _mm_set1_epi16((short)(FRAC_ONE / 2));
+    uint32_t blocks = dst_w / 8;
+    for (uint32_t k = 0; k < blocks; k++) {
+        __m128i window = _mm_loadu_si128((const __m128i*)(p + tx.block_base[k]));
+        __m128i taps = _mm_shuffle_epi8(
+            window, _mm_loadu_si128((const __m128i*)&tx.block_shuffle[16 * (size_t)k]));
+        __m128i w1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)&tx.weight[8 * k]), zero);
+        __m128i v = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(taps, zero),
+                                                  _mm_sub_epi16(one, w1)),
+                                  _mm_mullo_epi16(_mm_unpackhi_epi8(taps, zero), w1));
+        v = _mm_srli_epi16(_mm_add_epi16(v, half), FRAC_BITS);
+        _mm_storel_epi64((__m128i*)(out + 8 * k), _mm_packus_epi16(v, v));
+    }
+    resample_plane_scalar(p, tx, 8 * blocks, dst_w, out);
+}
+#elif defined(PP_NEON)
+static void split_rgb_neon(const uint8_t* src, size_t n, uint8_t* r, uint8_t* g, uint8_t* b) {
+    size_t x = 0;
+    for (; x + 16 <= n; x += 16) {
+        uint8x16x3_t v = vld3q_u8(src + 3 * x);
+        vst1q_u8(r + x, v.val[0]);
+        vst1q_u8(g + x, v.val[1]);
+        vst1q_u8(b + x, v.val[2]);
+    }
+    split_rgb_scalar(src, x, n, r, g, b);
+}
+
+static void resample_plane_neon(const uint8_t* p, const Taps& tx, uint32_t dst_w,
+                                uint8_t* out) {
+    const uint8x8_t one = vdup_n_u8((uint8_t)FRAC_ONE);
+    uint32_t blocks = dst_w / 8;
+    for (uint32_t k = 0; k < blocks; k++) {
+        uint8x16_t taps = vqtbl1q_u8(vld1q_u8(p + tx.block_base[k]),
+                                     vld1q_u8(&tx.block_shuffle[16 * (size_t)k]));
+        uint8x8_t w1 = vld1_u8(&tx.weight[8 * k]);
+        uint16x8_t v = vmlal_u8(vmull_u8(vget_low_u8(taps), vsub_u8(one, w1)),
+                                vget_high_u8(taps), w1);
+        vst1_u8(out + 8 * k, vrshrn_n_u16(v, FRAC_BITS));
+    }
+    resample_plane_scalar(p, tx, 8 * blocks, dst_w, out);
+}
+#endif
+
+typedef void (*SplitFn)(const uint8_t*, size_t, uint8_t*, uint8_t*, uint8_t*);
+typedef void (*ResampleFn)(const uint8_t*, const Taps&, uint32_t, uint8_t*);
+
+struct RowKernels {
+    SplitFn     split;
+    ResampleFn  resample;  // nullptr: gather from the interleaved row
+    const char* name;
+};
+
+static RowKernels pick_kernels() {
+#if defined(PP_SSE2)
+    if (__builtin_cpu_supports("ssse3")) {
+        return {split_rgb_ssse3, resample_plane_ssse3, "ssse3"};
+    }
+    return {split_rgb_plain, nullptr, "sse2"};
+#elif defined(PP_NEON)
+    return {split_rgb_neon, resample_plane_neon, "neon"};
+#else
+    return {split_rgb_plain, nullptr, "scalar"};
+#endif
+}
+
+static const RowKernels& kernels() {
+    static const RowKernels k = pick_kernels();
+    return k;
+}
+
+// ---- Resize ----
+
+/** Slack after each split plane: a block's 16-byte window may run past the row. */
+static constexpr size_t WINDOW_SLACK = 16;
+
+/**
+ * Horizontal pass: one interleaved (vertically blended) source row ->
+ * three planar rows of dst_w (R, G, B).  A row already at the output width
+ * is only split; otherwise it is split into *split (3 planes of src_w +
+ * WINDOW_SLACK) and resampled by blocks, or gathered pixel by pixel when
+ * there is no SIMD resample or the taps do not fit its windows.
+ */
+static void resize_row(const uint8_t* __restrict src, const Taps& tx, uint32_t src_w,
+                       uint32_t dst_w, uint8_t* __restrict planes, uint8_t* split) {
+    const RowKernels& k = kernels();
+    uint8_t* __restrict r = planes;
+    uint8_t* __restrict g = planes + dst_w;
+    uint8_t* __restrict b = planes + 2 * dst_w;
+    if (src_w == dst_w) {
+        k.split(src, dst_w, r, g, b);
+        return;
+    }
+    if (k.resample != nullptr && tx.windowed) {
+        size_t stride = src_w + WINDOW_SLACK;
+        k.split(src, src_w, split, split + stride, split + 2 * stride);
+        for (int c = 0; c < 3; c++) {
+            k.resample(split + c * stride, tx, dst_w, planes + c * dst_w);
+        }
+        return;
+    }
+    // Restrict pointers: byte stores would otherwise force the taps to be
+    // reloaded for every pixel
+    const uint32_t* __restrict index = tx.index.data();
+    const uint32_t* __restrict next = tx.next.data();
+    const uint8_t* __restrict weight = tx.weight.data();
+    for (uint32_t x = 0; x < dst_w; x++) {
+        const uint8_t* p0 = src + 3 * index[x];
+        const uint8_t* p1 = src + 3 * next[x];
+        uint32_t w1 = weight[x];
+        uint32_t w0 = FRAC_ONE - w1;
+        r[x] = (uint8_t)((p0[0] * w0 + p1[0] * w1 + FRAC_ONE / 2) >> FRAC_BITS);
+        g[x] = (uint8_t)((p0[1] * w0 + p1[1] * w1 + FRAC_ONE / 2) >> FRAC_BITS);
+        b[x] = (uint8_t)((p0[2] * w0 + p1[2] * w1 + FRAC_ONE / 2) >> FRAC_BITS);
+    }
+}
+
+/** dst = a * (1 - w) + b * w for n bytes. */
+static void blend_rows(const uint8_t* a, const uint8_t* b, uint32_t w, uint8_t* dst, size_t n) {
+    size_t i = 0;
+#if defined(PP_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wa = _mm_set1_epi16((short)(FRAC_ONE - w));
+    const __m128i wb = _mm_set1_epi16((short)w);
+    const __m128i half = _mm_set1_epi16((short)(FRAC_ONE / 2));
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, half), FRAC_BITS);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, half), FRAC_BITS);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(PP_NEON)
+    const uint8x8_t wa = vdup_n_u8((uint8_t)(FRAC_ONE - w));
+    const uint8x8_t wb = vdup_n_u8((uint8_t)w);
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t va = vld1q_u8(a + i);
+        uint8x16_t vb = vld1q_u8(b + i);
+        uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(va), wa), vget_low_u8(vb), wb);
+        uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(va), wa), vget_high_u8(vb), wb);
+        vst1q_u8(dst + i, vcombine_u8(vrshrn_n_u16(lo, FRAC_BITS), vrshrn_n_u16(hi, FRAC_BITS)));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = (uint8_t)((a[i] * (FRAC_ONE - w) + b[i] * w + FRAC_ONE / 2) >> FRAC_BITS);
+    }
+}
+
+// ---- Convert ----
+
+static void to_float32(const uint8_t* in, float* out, size_t n) {
+    const float k = 1.0f / 255.0f;
+    size_t i = 0;
+#if defined(PP_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 vk = _mm_set1_ps(k);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_ps(out + i,
+                      _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), vk));
+        _mm_storeu_ps(out + i + 4,
+                      _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), vk));
+        _mm_storeu_ps(out + i + 8,
+                      _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), vk));
+        _mm_storeu_ps(out + i + 12,
+                      _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), vk));
+    }
+#elif defined(PP_NEON)
+    const float32x4_t vk = vdupq_n_f32(k);
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(in + i);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+        vst1q_f32(out + i, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), vk));
+        vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), vk));
+        vst1q_f32(out + i + 8, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), vk));
+        vst1q_f32(out + i + 12, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), vk));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = in[i] * k;
+    }
+}
+
+/** value - 128 as int8 is value with its top bit flipped. */
+static void to_int8(const uint8_t* in, uint8_t* out, size_t n) {
+    size_t i = 0;
+#if defined(PP_SSE2)
+    const __m128i flip = _mm_set1_epi8((char)0x80);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_xor_si128(v, flip));
+    }
+#elif defined(PP_NEON)
+    const uint8x16_t flip = vdupq_n_u8(0x80);
+    for (; i + 16 <= n; i += 16) {
+        vst1q_u8(out + i, veorq_u8(vld1q_u8(in + i), flip));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = in[i] ^ 0x80;
+    }
+}
+
+/** Write n values of a u8 row at element offset at of out. */
+static void convert_row(const uint8_t* in, size_t n, PpFormat fmt, void* out, size_t at) {
+    if (fmt == PP_FLOAT32) {
+        to_float32(in, (float*)out + at, n);
+    } else if (fmt == PP_INT8) {
+        to_int8(in, (uint8_t*)out + at, n);
+    } else {
+        memcpy((uint8_t*)out + at, in, n);
+    }
+}
+
+/** Fill n elements at element offset at of out with the pad value. */
+static void fill_pad(PpFormat fmt, void* out, size_t at, size_t n) {
+    if (fmt == PP_FLOAT32) {
+        std::fill_n((float*)out + at, n, PP_PAD_VALUE / 255.0f);
+    } else {
+        memset((uint8_t*)out + at, fmt == PP_INT8 ? PP_PAD_VALUE ^ 0x80 : PP_PAD_VALUE, n);
+    }
+}
+
+// ---- Public ----
+
+/**
+ * Buffers kept per thread between photos: the worker pre-processes one
+ * photo after another, and fresh allocations of the decoded image would
+ * page-fault on every call.
+ */
+struct Scratch {
+    std::vector<uint8_t>  rgb;
+    std::vector<JSAMPROW> rows;
+    std::vector<uint8_t>  blended;  // One vertically blended source row
+    std::vector<uint8_t>  split;    // The same, planar, for the SIMD resample
+    std::vector<uint8_t>  planes;   // One output row, planar
+};
+
+bool pp_letterbox_jpeg(const uint8_t* jpeg, size_t len, uint32_t size, PpFormat fmt, void* out,
+                       PpLetterbox* info, std::string* err) {
+    static thread_local Scratch scratch;
+    PpLetterbox lb;
+    memset(&lb, 0, sizeof(lb));
+    if (!decode_scaled(jpeg, len, size, &scratch.rgb, &scratch.rows, &lb, err)) {
+        return false;
+    }
+
+    size_t plane = (size_t)size * size;
+    size_t src_stride = (size_t)lb.decoded_w * 3;
+    size_t right = size - lb.pad_x - lb.new_w;
+    Taps tx = build_taps(lb.decoded_w, lb.new_w);
+    Taps ty = build_taps(lb.decoded_h, lb.new_h);
+    scratch.blended.resize(src_stride);
+    scratch.split.resize(3 * (lb.decoded_w + WINDOW_SLACK));
+    scratch.planes.resize(3 * (size_t)lb.new_w);
+
+    // Each output row in one pass: blend two source rows, resample and split
+    // into planes, convert into place; only the padding is written otherwise
+    for (uint32_t y = 0; y < lb.new_h; y++) {
+        const uint8_t* src = scratch.rgb.data() + ty.index[y] * src_stride;
+        if (ty.weight[y] != 0) {
+            blend_rows(src, scratch.rgb.data() + ty.next[y] * src_stride, ty.weight[y],
+                       scratch.blended.data(), src_stride);
+            src = scratch.blended.data();
+        }
+        resize_row(src, tx, lb.decoded_w, lb.new_w, scratch.planes.data(), scratch.split.data());
+        size_t row = (size_t)(lb.pad_y + y) * size;
+        for (int c = 0; c < 3; c++) {
+            fill_pad(fmt, out, c * plane + row, lb.pad_x);
+            convert_row(scratch.planes.data() + c * lb.new_w, lb.new_w, fmt, out,
+                        c * plane + row + lb.pad_x);
+            fill_pad(fmt, out, c * plane + row + lb.pad_x + lb.new_w, right);
+        }
+    }
+    for (int c = 0; c < 3; c++) {
+        fill_pad(fmt, out, c * plane, (size_t)lb.pad_y * size);
+        fill_pad(fmt, out, c * plane + (size_t)(lb.pad_y + lb.new_h) * size,
+                 (size_t)(size - lb.pad_y - lb.new_h) * size);
+    }
+    *info = lb;
+    return true;
+}
+
+const char* pp_kernel_name() {
+    return kernels().name;
+}
@@ -0,0 +1,68 @@
+/**
+ * Waggle Hub — JPEG decode and letterbox for the ML worker.
+ *
+ * ml_worker.py hands every uploaded photo (VGA or SVGA JPEG from the
+ * camera nodes) to YOLOv8-nano, which wants a square RGB input of the
+ * model's size (640): the image scaled to fit, centred on grey (114)
+ * padding, as planar CHW values in 0..1.  Done by ultralytics that is a
+ * full-size OpenCV decode, a resize, a pad and two passes over a float
+ * copy, which on a Pi costs about as much as the inference itself.
+ *
+ * Here libjpeg-turbo decodes with DCT-domain scaling: a photo at least
+ * twice the letterboxed size is decoded at 1/2, 1/4 or 1/8 (the scales
+ * with SIMD IDCTs), so the IDCT does most of the downscale.  A bilinear
+ * resize then takes it to the exact size one output row at a time: blend
+ * two source rows, split into planes and resample, convert straight into
+ * place in the output; only the padding is written otherwise.  The row
+ * blend and the conversion use SSE2 on x86-64 and NEON on AArch64 (the
+ * Pi 4/5 with a 64-bit OS); the split and the horizontal resample use
+ * table lookups (SSSE3 pshufb, NEON tbl) and are scalar without them.
+ * Chroma is upsampled as OpenCV does it, so a photo that needs no resize
+ * gives the same input as the ultralytics path.
+ *
+ * Geometry follows ultralytics' LetterBox(auto=False): scale =
+ * min(size / w, size / h), the image rounded to that size and the padding
+ * split with the odd pixel after it, so boxes map back the same way.
+ */
+
+#ifndef WAGGLE_PREPROCESS_H
+#define WAGGLE_PREPROCESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+static constexpr uint8_t  PP_PAD_VALUE = 114;
+static constexpr uint32_t PP_MAX_SIZE  = 4096;
+
+enum PpFormat : uint8_t {
+    PP_FLOAT32 = 0,  // value / 255
+    PP_INT8,         // value - 128
+    PP_UINT8,        // value
+};
+
+/** Where the photo landed in the canvas. */
+struct PpLetterbox {
+    uint32_t orig_w, orig_h;        // JPEG dimensions
+    uint32_t decoded_w, decoded_h;  // After DCT scaling
+    uint32_t new_w, new_h;          // Resized image inside the canvas
+    uint32_t pad_x, pad_y;          // Canvas offset of the image
+    double   scale;                 // new / orig
+};
+
+/** Bytes of a size x size, 3-plane output in fmt. */
+size_t pp_output_size(uint32_t size, PpFormat fmt);
+
+/**
+ * Decode jpeg and write it letterboxed into out (pp_output_size bytes,
+ * planes R, G, B).  False (with a message in *err) if the JPEG cannot be
+ * decoded.  Safe to call from several threads.
+ */
+bool pp_letterbox_jpeg(const uint8_t* jpeg, size_t len, uint32_t size, PpFormat fmt, void* out,
+                       PpLetterbox* info, std::string* err);
+
+/** Name of the row kernels picked for this CPU ("ssse3", "sse2", "neon" or "scalar"). */
+const char* pp_kernel_name();
+
+#endif  // WAGGLE_PREPROCESS_H
@@ -0,0 +1,107 @@
+/**
+ * Waggle Hub — waggle._preprocess: CPython binding for the ML pre-processing.
+ *
+ *   letterbox(jpeg, size=640, dtype="float32")
+ *     -> (data, orig_w, orig_h, scale, pad_x, pad_y)
+ *
+ * data is a bytearray of 3 x size x size values, planes R, G, B, in dtype:
+ * "float32" (0..1, what YOLOv8 takes), "int8" (value - 128, for quantised
+ * models) or "uint8".  A box in canvas pixels maps back to the photo as
+ * (x - pad_x) / scale.  ValueError if the JPEG cannot be decoded.  The GIL
+ * is released while the photo is processed.  waggle/services/ml_preprocess.py
+ * wraps this module; KERNELS names the SIMD kernels compiled in.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <string.h>
+
+#include "preprocess.h"
+
+static bool parse_format(const char* dtype, PpFormat* fmt) {
+    if (strcmp(dtype, "float32") == 0) {
+        *fmt = PP_FLOAT32;
+    } else if (strcmp(dtype, "int8") == 0) {
+        *fmt = PP_INT8;
+    } else if (strcmp(dtype, "uint8") == 0) {
+        *fmt = PP_UINT8;
+    } else {
+        PyErr_Format(PyExc_ValueError, "dtype must be float32, int8 or uint8, not %s", dtype);
+        return false;
+    }
+    return true;
+}
+
+static PyObject* preprocess_letterbox(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"jpeg", "size", "dtype", nullptr};
+    Py_buffer view;
+    int size = 640;
+    const char* dtype = "float32";
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|is", (char**)kwlist, &view, &size,
+                                     &dtype)) {
+        return nullptr;
+    }
+    PpFormat fmt;
+    if (!parse_format(dtype, &fmt)) {
+        PyBuffer_Release(&view);
+        return nullptr;
+    }
+    if (size < 1 || (uint32_t)size > PP_MAX_SIZE) {
+        PyBuffer_Release(&view);
+        PyErr_Format(PyExc_ValueError, "size must be 1..%u", PP_MAX_SIZE);
+        return nullptr;
+    }
+
+    PyObject* data =
+        PyByteArray_FromStringAndSize(nullptr, (Py_ssize_t)pp_output_size((uint32_t)size, fmt));
+    if (data == nullptr) {
+        PyBuffer_Release(&view);
+        return nullptr;
+    }
+    void* out = PyByteArray_AS_STRING(data);
+    PpLetterbox lb;
+    std::string err;
+    bool ok;
+
+    Py_BEGIN_ALLOW_THREADS
+    ok = pp_letterbox_jpeg((const uint8_t*)view.buf, (size_t)view.len, (uint32_t)size, fmt, out,
+                           &lb, &err);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&view);
+
+    if (!ok) {
+        Py_DECREF(data);
+        PyErr_SetString(PyExc_ValueError, err.c_str());
+        return nullptr;
+    }
+    return Py_BuildValue("(NIIdII)", data, lb.orig_w, lb.orig_h, lb.scale, lb.pad_x, lb.pad_y);
+}
+
+static PyMethodDef s_methods[] = {
+    {"letterbox", (PyCFunction)(void (*)(void))preprocess_letterbox,
+     METH_VARARGS | METH_KEYWORDS,
+     "letterbox(jpeg, size=640, dtype=\"float32\")\n"
+     "    -> (data, orig_w, orig_h, scale, pad_x, pad_y)\n\n"
+     "Decode a JPEG into a planar size x size letterboxed model input."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+static struct PyModuleDef s_module = {
+    PyModuleDef_HEAD_INIT, "waggle._preprocess",
+    "Native JPEG decode and letterbox for the ML worker.", -1, s_methods,
+    nullptr, nullptr, nullptr, nullptr,
+};
+
+PyMODINIT_FUNC PyInit__preprocess(void) {
+    PyObject* m = PyModule_Create(&s_module);
+    if (m == nullptr) {
+        return nullptr;
+    }
+    if (PyModule_AddIntConstant(m, "PAD_VALUE", PP_PAD_VALUE) < 0 ||
+        PyModule_AddStringConstant(m, "KERNELS", pp_kernel_name()) < 0) {
+        Py_DECREF(m);
+        return nullptr;
+    }
+    return m;
+}
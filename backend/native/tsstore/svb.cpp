@@ -0,0 +1,171 @@
+/**
+ * Waggle Hub — Stream VByte integer codec (see svb.h).
+ */
+
+#include "svb.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SVB_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define SVB_NEON 1
+#endif
+
+// ---- Tables ----
+
+struct SvbTables {
+    uint8_t length[256];      // Data bytes used by a group
+    uint8_t shuffle[256][16]; // Data byte -> output byte, 0xFF = zero
+};
+
+static SvbTables build_tables() {
+    SvbTables t;
+    for (int c = 0; c < 256; c++) {
+        uint8_t pos = 0;
+        for (int v = 0; v < 4; v++) {
+            int len = ((c >> (2 * v)) & 3) + 1;
+            for (int b = 0; b < 4; b++) {
+                t.shuffle[c][v * 4 + b] = b < len ? pos++ : 0xFF;
+            }
+        }
+        t.length[c] = pos;
+    }
+    return t;
+}
+
+static const SvbTables& tables() {
+    static const SvbTables t = build_tables();
+    return t;
+}
+
+// ---- Encode ----
+
+static inline int byte_len(uint32_t v) {
+    return v < (1u << 8) ? 1 : v < (1u << 16) ? 2 : v < (1u << 24) ? 3 : 4;
+}
+
+size_t svb_encode(const uint32_t* in, size_t n, uint8_t* out) {
+    uint8_t* control = out;
+    uint8_t* data = out + (n + 3) / 4;
+    memset(control, 0, (n + 3) / 4);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t v = in[i];
+        int len = byte_len(v);
+        control[i / 4] |= (uint8_t)((len - 1) << (2 * (i % 4)));
+        for (int b = 0; b < len; b++) {
+            *data++ = (uint8_t)(v >> (8 * b));
+        }
+    }
+    return (size_t)(data - out);
+}
+
+// ---- Decode ----
+
+static size_t decode_scalar_values(const uint8_t* control, const uint8_t* data,
+                                   const uint8_t* end, size_t first, size_t n, uint32_t* out,
+                                   const uint8_t** data_end) {
+    for (size_t i = first; i < n; i++) {
+        int len = ((control[i / 4] >> (2 * (i % 4))) & 3) + 1;
+        if (data + len > end) {
+            return 0;
+        }
+        uint32_t v = 0;
+        for (int b = 0; b < len; b++) {
+            v |= (uint32_t)data[b] << (8 * b);
+        }
+        out[i] = v;
+        data += len;
+    }
+    *data_end = data;
+    return 1;
+}
+
+#if defined(SVB_X86)
+__attribute__((target("ssse3")))
+static size_t decode_groups_ssse3(const uint8_t* control, const uint8_t* data,
+                                  const uint8_t* end, size_t groups, uint32_t* out,
+                                  const uint8_t** data_end) {
+    const SvbTables& t = tables();
+    size_t g = 0;
+    // A group reads 16 bytes whatever its length; stop while that stays in bounds
+    for (; g < groups && data + 16 <= end; g++) {
+        uint8_t c = control[g];
+        __m128i in = _mm_loadu_si128((const __m128i*)data);
+        __m128i mask = _mm_loadu_si128((const __m128i*)t.shuffle[c]);
+        _mm_storeu_si128((__m128i*)(out + 4 * g), _mm_shuffle_epi8(in, mask));
+        data += t.length[c];
+    }
+    *data_end = data;
+    return g;
+}
+#endif
+
+#if defined(SVB_NEON)
+static size_t decode_groups_neon(const uint8_t* control, const uint8_t* data,
+                                 const uint8_t* end, size_t groups, uint32_t* out,
+                                 const uint8_t** data_end) {
+    const SvbTables& t = tables();
+    size_t g = 0;
+    for (; g < groups && data + 16 <= end; g++) {
+        uint8_t c = control[g];
+        uint8x16_t shuffled = vqtbl1q_u8(vld1q_u8(data), vld1q_u8(t.shuffle[c]));
+        vst1q_u32(out + 4 * g, vreinterpretq_u32_u8(shuffled));
+        data += t.length[c];
+    }
+    *data_end = data;
+    return g;
+}
+#endif
+
+typedef size_t (*GroupDecoder)(const uint8_t*, const uint8_t*, const uint8_t*, size_t,
+                               uint32_t*, const uint8_t**);
+
+static GroupDecoder pick_decoder(const char** name) {
+#if defined(SVB_X86)
+    if (__builtin_cpu_supports("ssse3")) {
+        *name = "ssse3";
+        return decode_groups_ssse3;
+    }
+#elif defined(SVB_NEON)
+    *name = "neon";
+    return decode_groups_neon;
+#endif
+    *name = "scalar";
+    return nullptr;
+}
+
+static const char* s_decoder_name = nullptr;
+
+static GroupDecoder decoder() {
+    static const GroupDecoder d = pick_decoder(&s_decoder_name);
+    return d;
+}
+
+size_t svb_decode(const uint8_t* in, size_t len, size_t n, uint32_t* out) {
+    size_t control_len = (n + 3) / 4;
+    if (len < control_len) {
+        return 0;
+    }
+    const uint8_t* control = in;
+    const uint8_t* data = in + control_len;
+    const uint8_t* end = in + len;
+
+    size_t first = 0;
+    GroupDecoder groups = decoder();
+    if (groups != nullptr) {
+        // Only whole groups go through SIMD; a short last group is scalar
+        first = 4 * groups(control, data, end, n / 4, out, &data);
+    }
+    if (!decode_scalar_values(control, data, end, first, n, out, &data)) {
+        return 0;
+    }
+    return (size_t)(data - in);
+}
+
+const char* svb_decoder_name() {
+    decoder();
+    return s_decoder_name;
+}
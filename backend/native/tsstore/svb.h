@@ -0,0 +1,34 @@
+/**
+ * Waggle Hub — Stream VByte integer codec for the time-series store.
+ *
+ * Each group of four u32 values has one control byte (2 bits per value:
+ * byte length - 1) and the values' significant bytes packed separately, so
+ * a group decodes with a single 16-byte shuffle: SSSE3 pshufb on x86-64,
+ * NEON tbl on AArch64 (the Pi 4/5 with a 64-bit OS), scalar elsewhere.
+ * Layout: [control bytes, (n + 3) / 4][data bytes].
+ */
+
+#ifndef WAGGLE_TSSTORE_SVB_H
+#define WAGGLE_TSSTORE_SVB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Upper bound on svb_encode() output for n values. */
+inline size_t svb_max_bytes(size_t n) {
+    return (n + 3) / 4 + 4 * n;
+}
+
+/** Encode n values; returns the bytes written. */
+size_t svb_encode(const uint32_t* in, size_t n, uint8_t* out);
+
+/**
+ * Decode n values from len bytes; returns the bytes consumed, or 0 if the
+ * input is truncated.
+ */
+size_t svb_decode(const uint8_t* in, size_t len, size_t n, uint32_t* out);
+
+/** Name of the decoder picked for this CPU ("ssse3", "neon" or "scalar"). */
+const char* svb_decoder_name();
+
+#endif  // WAGGLE_TSSTORE_SVB_H
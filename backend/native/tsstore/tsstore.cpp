@@ -0,0 +1,928 @@
+/**
+ * Waggle Hub — compressed columnar time-series store (see tsstore.h).
+ */
+
+#include "tsstore.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "svb.h"
+
+// ---- On-disk format ----
+
+static const char FILE_MAGIC[4]  = {'W', 'T', 'S', 'F'};
+static const char BLOCK_MAGIC[4] = {'W', 'T', 'S', 'B'};
+static constexpr uint32_t FILE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t hive_id;
+    uint32_t reserved;
+};
+
+struct BlockHeader {
+    char     magic[4];
+    uint32_t length;        // Header + columns
+    uint32_t crc;           // CRC-32 of the column bytes
+    uint16_t rows;
+    uint16_t traffic_rows;
+    int64_t  t_min;
+    int64_t  t_max;
+    int64_t  id_min;
+    int64_t  id_max;
+};
+
+struct ColumnHeader {
+    uint8_t  encoding;
+    uint8_t  has_bitmap;    // Presence bitmap (one bit per block row) follows
+    uint16_t reserved;
+    uint32_t count;         // Values stored (present rows)
+    int64_t  base;          // First value (bit pattern for ENC_XOR)
+    uint32_t payload_len;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 16, "FileHeader layout");
+static_assert(sizeof(BlockHeader) == 48, "BlockHeader layout");
+static_assert(sizeof(ColumnHeader) == 20, "ColumnHeader layout");
+
+enum Encoding : uint8_t {
+    ENC_DELTA = 1,  // Zigzag deltas, Stream VByte
+    ENC_DOD   = 2,  // Zigzag delta-of-deltas, Stream VByte
+    ENC_RAW   = 3,  // int64 values
+    ENC_XOR   = 4,  // Float bits XOR previous, zero bytes trimmed
+};
+
+// Column order within a block.  The REAL columns are stored as integers in
+// units of 1 / VALUE_SCALE unless they use ENC_XOR.  Traffic columns after
+// C_BC_ID hold one value per traffic row and share C_BC_ID's bitmap.
+enum Column {
+    C_TIME,
+    C_ID,
+    C_SEQUENCE,
+    C_FLAGS,
+    C_VALUE0,
+    C_BC_ID = C_VALUE0 + TS_VALUE_COUNT,
+    C_PERIOD_MS,
+    C_BEES_IN,
+    C_BEES_OUT,
+    C_LANE_MASK,
+    C_STUCK_MASK,
+    C_COUNT,
+};
+
+static const double VALUE_SCALE[TS_VALUE_COUNT] = {1000.0, 100.0, 100.0, 10.0, 1000.0};
+
+// ---- Helpers ----
+
+static uint32_t crc32(const uint8_t* data, size_t len) {
+    static uint32_t table[256];
+    static bool ready = false;
+    if (!ready) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        ready = true;
+    }
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static inline uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static inline uint64_t double_bits(double v) {
+    uint64_t b;
+    memcpy(&b, &v, sizeof(b));
+    return b;
+}
+
+static inline double bits_double(uint64_t b) {
+    double v;
+    memcpy(&v, &b, sizeof(v));
+    return v;
+}
+
+static void put(std::vector<uint8_t>* out, const void* p, size_t len) {
+    const uint8_t* b = (const uint8_t*)p;
+    out->insert(out->end(), b, b + len);
+}
+
+static std::string errno_message(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + strerror(errno);
+}
+
+// ---- Column encoding ----
+
+// Differences of the given order (1 = delta, 2 = delta of delta), zigzagged.
+// Wrapping arithmetic keeps the transform exact; false if a value needs
+// more than 32 bits.
+static bool diff_encode(const int64_t* v, size_t n, int order, std::vector<uint32_t>* out) {
+    out->clear();
+    int64_t prev_delta = 0;
+    for (size_t i = 1; i < n; i++) {
+        int64_t d = (int64_t)((uint64_t)v[i] - (uint64_t)v[i - 1]);
+        int64_t x = order == 1 ? d : (int64_t)((uint64_t)d - (uint64_t)prev_delta);
+        prev_delta = d;
+        uint64_t z = zigzag(x);
+        if (z > UINT32_MAX) {
+            return false;
+        }
+        out->push_back((uint32_t)z);
+    }
+    return true;
+}
+
+static void put_column(std::vector<uint8_t>* out, uint8_t encoding, uint32_t count, int64_t base,
+                       const std::vector<uint8_t>* bitmap, const std::vector<uint8_t>& payload) {
+    ColumnHeader h;
+    memset(&h, 0, sizeof(h));
+    h.encoding = encoding;
+    h.has_bitmap = bitmap != nullptr;
+    h.count = count;
+    h.base = base;
+    h.payload_len = (uint32_t)payload.size();
+    put(out, &h, sizeof(h));
+    if (bitmap != nullptr) {
+        put(out, bitmap->data(), bitmap->size());
+    }
+    put(out, payload.data(), payload.size());
+}
+
+static void put_int_column(std::vector<uint8_t>* out, const std::vector<int64_t>& v,
+                           const std::vector<uint8_t>* bitmap) {
+    std::vector<uint8_t> best;
+    uint8_t best_enc = ENC_RAW;
+    std::vector<uint32_t> diffs;
+    std::vector<uint8_t> packed;
+    for (int order = 1; order <= 2 && v.size() > 1; order++) {
+        if (!diff_encode(v.data(), v.size(), order, &diffs)) {
+            continue;
+        }
+        packed.resize(svb_max_bytes(diffs.size()));
+        packed.resize(svb_encode(diffs.data(), diffs.size(), packed.data()));
+        if (best_enc == ENC_RAW || packed.size() < best.size()) {
+            best.swap(packed);
+            best_enc = order == 1 ? ENC_DELTA : ENC_DOD;
+        }
+    }
+    if (v.size() <= 1) {
+        best_enc = ENC_DELTA;  // Base only
+    } else if (best_enc == ENC_RAW) {
+        best.resize(v.size() * sizeof(int64_t));
+        memcpy(best.data(), v.data(), best.size());
+    }
+    int64_t base = best_enc == ENC_RAW || v.empty() ? 0 : v[0];
+    put_column(out, best_enc, (uint32_t)v.size(), base, bitmap, best);
+}
+
+// Per value: one byte (leading zero bytes << 4 | trailing zero bytes) of
+// the XOR with the previous value, then the bytes in between
+static void put_xor_column(std::vector<uint8_t>* out, const std::vector<double>& v,
+                           const std::vector<uint8_t>* bitmap) {
+    std::vector<uint8_t> payload;
+    for (size_t i = 1; i < v.size(); i++) {
+        uint64_t x = double_bits(v[i]) ^ double_bits(v[i - 1]);
+        int lead = x == 0 ? 8 : __builtin_clzll(x) / 8;
+        int trail = x == 0 ? 0 : __builtin_ctzll(x) / 8;
+        payload.push_back((uint8_t)(lead << 4 | trail));
+        for (int b = trail; b < 8 - lead; b++) {
+            payload.push_back((uint8_t)(x >> (8 * b)));
+        }
+    }
+    int64_t base = v.empty() ? 0 : (int64_t)double_bits(v[0]);
+    put_column(out, ENC_XOR, (uint32_t)v.size(), base, bitmap, payload);
+}
+
+static void put_value_column(std::vector<uint8_t>* out, const TsRow* rows, size_t n, int value,
+                             std::vector<uint8_t>* bitmap) {
+    bitmap->assign((n + 7) / 8, 0);
+    std::vector<double> present;
+    for (size_t i = 0; i < n; i++) {
+        if (!(rows[i].null_mask & (1u << value))) {
+            (*bitmap)[i / 8] |= (uint8_t)(1u << (i % 8));
+            present.push_back(rows[i].values[value]);
+        }
+    }
+    double scale = VALUE_SCALE[value];
+    std::vector<int64_t> fixed;
+    for (double v : present) {
+        double scaled = v * scale;
+        if (!(fabs(scaled) < 9.0e15)) {
+            break;
+        }
+        int64_t iv = llround(scaled);
+        if ((double)iv / scale != v) {
+            break;  // Not an ingestion value; keep the exact bits
+        }
+        fixed.push_back(iv);
+    }
+    if (fixed.size() == present.size()) {
+        put_int_column(out, fixed, bitmap);
+    } else {
+        put_xor_column(out, present, bitmap);
+    }
+}
+
+static bool row_less(const TsRow& a, const TsRow& b) {
+    return a.t_ms != b.t_ms ? a.t_ms < b.t_ms : a.id < b.id;
+}
+
+static void encode_block(const std::vector<TsRow>& rows, std::vector<uint8_t>* out) {
+    size_t n = rows.size();
+    const TsRow* r = rows.data();
+
+    BlockHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, BLOCK_MAGIC, 4);
+    h.rows = (uint16_t)n;
+    h.t_min = r[0].t_ms;
+    h.t_max = r[n - 1].t_ms;
+    h.id_min = r[0].id;
+    h.id_max = r[0].id;
+    for (size_t i = 0; i < n; i++) {
+        h.id_min = std::min(h.id_min, r[i].id);
+        h.id_max = std::max(h.id_max, r[i].id);
+    }
+
+    out->assign(sizeof(h), 0);
+    std::vector<int64_t> col(n);
+    const int64_t TsRow::*dense[] = {&TsRow::t_ms, &TsRow::id, &TsRow::sequence, &TsRow::flags};
+    for (auto field : dense) {
+        for (size_t i = 0; i < n; i++) {
+            col[i] = r[i].*field;
+        }
+        put_int_column(out, col, nullptr);
+    }
+
+    std::vector<uint8_t> bitmap;
+    for (int v = 0; v < TS_VALUE_COUNT; v++) {
+        put_value_column(out, r, n, v, &bitmap);
+    }
+
+    bitmap.assign((n + 7) / 8, 0);
+    std::vector<const TsRow*> traffic;
+    for (size_t i = 0; i < n; i++) {
+        if (r[i].bc_id != 0) {
+            bitmap[i / 8] |= (uint8_t)(1u << (i % 8));
+            traffic.push_back(&r[i]);
+        }
+    }
+    h.traffic_rows = (uint16_t)traffic.size();
+    const int64_t TsRow::*traffic_fields[] = {&TsRow::bc_id,    &TsRow::period_ms,
+                                              &TsRow::bees_in,  &TsRow::bees_out,
+                                              &TsRow::lane_mask, &TsRow::stuck_mask};
+    for (size_t f = 0; f < 6; f++) {
+        col.resize(traffic.size());
+        for (size_t i = 0; i < traffic.size(); i++) {
+            col[i] = traffic[i]->*traffic_fields[f];
+        }
+        put_int_column(out, col, f == 0 ? &bitmap : nullptr);
+    }
+
+    h.length = (uint32_t)out->size();
+    h.crc = crc32(out->data() + sizeof(h), out->size() - sizeof(h));
+    memcpy(out->data(), &h, sizeof(h));
+}
+
+// ---- Column decoding ----
+
+struct ColumnView {
+    ColumnHeader   h;
+    const uint8_t* bitmap;   // nullptr if none
+    const uint8_t* payload;
+};
+
+// Split the block into its columns; false if they do not fit
+static bool split_columns(const uint8_t* block, size_t len, ColumnView cols[C_COUNT]) {
+    BlockHeader bh;
+    memcpy(&bh, block, sizeof(bh));
+    size_t bitmap_len = ((size_t)bh.rows + 7) / 8;
+    size_t pos = sizeof(bh);
+    for (int c = 0; c < C_COUNT; c++) {
+        if (pos + sizeof(ColumnHeader) > len) {
+            return false;
+        }
+        memcpy(&cols[c].h, block + pos, sizeof(ColumnHeader));
+        pos += sizeof(ColumnHeader);
+        cols[c].bitmap = nullptr;
+        if (cols[c].h.has_bitmap) {
+            if (pos + bitmap_len > len) {
+                return false;
+            }
+            cols[c].bitmap = block + pos;
+            pos += bitmap_len;
+        }
+        if (cols[c].h.payload_len > len - pos) {
+            return false;
+        }
+        cols[c].payload = block + pos;
+        pos += cols[c].h.payload_len;
+    }
+    return true;
+}
+
+static bool decode_ints(const ColumnView& c, int64_t* out) {
+    uint32_t n = c.h.count;
+    if (n == 0) {
+        return true;
+    }
+    switch (c.h.encoding) {
+    case ENC_RAW:
+        if (c.h.payload_len != (uint64_t)n * sizeof(int64_t)) {
+            return false;
+        }
+        memcpy(out, c.payload, (size_t)n * sizeof(int64_t));
+        return true;
+    case ENC_DELTA:
+    case ENC_DOD: {
+        // Blocks can hold up to 64K rows; keep the scratch off the stack
+        static thread_local std::vector<uint32_t> diffs;
+        diffs.resize(n);
+        if (n > 1 && svb_decode(c.payload, c.h.payload_len, n - 1, diffs.data()) == 0) {
+            return false;
+        }
+        uint64_t v = (uint64_t)c.h.base;
+        uint64_t d = 0;
+        out[0] = (int64_t)v;
+        for (uint32_t i = 1; i < n; i++) {
+            uint64_t x = (uint64_t)unzigzag(diffs[i - 1]);
+            d = c.h.encoding == ENC_DELTA ? x : d + x;
+            v += d;
+            out[i] = (int64_t)v;
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+static bool decode_doubles(const ColumnView& c, double scale, double* out) {
+    uint32_t n = c.h.count;
+    if (c.h.encoding != ENC_XOR) {
+        static thread_local std::vector<int64_t> ints;
+        ints.resize(n);
+        if (!decode_ints(c, ints.data())) {
+            return false;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            out[i] = (double)ints[i] / scale;
+        }
+        return true;
+    }
+    if (n == 0) {
+        return true;
+    }
+    const uint8_t* p = c.payload;
+    const uint8_t* end = c.payload + c.h.payload_len;
+    uint64_t bits = (uint64_t)c.h.base;
+    out[0] = bits_double(bits);
+    for (uint32_t i = 1; i < n; i++) {
+        if (p >= end) {
+            return false;
+        }
+        int lead = *p >> 4;
+        int trail = *p & 0x0F;
+        p++;
+        if (lead + trail > 8 || p + (8 - lead - trail) > end) {
+            return false;
+        }
+        uint64_t x = 0;
+        for (int b = trail; b < 8 - lead; b++) {
+            x |= (uint64_t)*p++ << (8 * b);
+        }
+        bits ^= x;
+        out[i] = bits_double(bits);
+    }
+    return true;
+}
+
+static inline bool bit_set(const uint8_t* bitmap, size_t i) {
+    return bitmap[i / 8] & (1u << (i % 8));
+}
+
+// One block's columns, one entry per row (traffic columns per traffic row)
+struct BlockData {
+    uint32_t             rows;
+    std::vector<int64_t> ints[C_COUNT];
+    std::vector<double>  values[TS_VALUE_COUNT];
+    std::vector<uint8_t> null_mask;
+    std::vector<int32_t> traffic_index;  // Row -> traffic row, -1 if none
+};
+
+static int32_t popcount_bitmap(const uint8_t* bitmap, uint32_t rows) {
+    int32_t n = 0;
+    for (uint32_t i = 0; i < rows; i++) {
+        n += bit_set(bitmap, i);
+    }
+    return n;
+}
+
+// time_only: just C_TIME and traffic_index, for counting boundary blocks
+static bool decode_block(const uint8_t* block, size_t len, bool time_only, BlockData* out) {
+    BlockHeader bh;
+    memcpy(&bh, block, sizeof(bh));
+    ColumnView cols[C_COUNT];
+    if (!split_columns(block, len, cols)) {
+        return false;
+    }
+    uint32_t rows = bh.rows;
+    out->rows = rows;
+
+    const ColumnView& bc = cols[C_BC_ID];
+    if (bc.bitmap == nullptr || popcount_bitmap(bc.bitmap, rows) != (int32_t)bc.h.count) {
+        return false;
+    }
+    out->traffic_index.resize(rows);
+    int32_t t = 0;
+    for (uint32_t i = 0; i < rows; i++) {
+        out->traffic_index[i] = bit_set(bc.bitmap, i) ? t++ : -1;
+    }
+
+    for (int c = 0; c < C_COUNT; c++) {
+        bool is_value = c >= C_VALUE0 && c < C_BC_ID;
+        if (is_value || (time_only && c != C_TIME)) {
+            continue;
+        }
+        uint32_t expect = c < C_VALUE0 ? rows : bc.h.count;
+        if (cols[c].h.count != expect) {
+            return false;
+        }
+        out->ints[c].resize(expect);
+        if (!decode_ints(cols[c], out->ints[c].data())) {
+            return false;
+        }
+    }
+    if (time_only) {
+        return true;
+    }
+
+    out->null_mask.assign(rows, 0);
+    static thread_local std::vector<double> dense;
+    dense.resize(rows);
+    for (int v = 0; v < TS_VALUE_COUNT; v++) {
+        const ColumnView& c = cols[C_VALUE0 + v];
+        if (c.bitmap == nullptr || popcount_bitmap(c.bitmap, rows) != (int32_t)c.h.count ||
+            !decode_doubles(c, VALUE_SCALE[v], dense.data())) {
+            return false;
+        }
+        out->values[v].assign(rows, 0.0);
+        uint32_t k = 0;
+        for (uint32_t i = 0; i < rows; i++) {
+            if (bit_set(c.bitmap, i)) {
+                out->values[v][i] = dense[k++];
+            } else {
+                out->null_mask[i] |= (uint8_t)(1u << v);
+            }
+        }
+    }
+    return true;
+}
+
+static void row_at(const BlockData& d, uint32_t i, TsRow* r) {
+    memset(r, 0, sizeof(*r));
+    r->t_ms = d.ints[C_TIME][i];
+    r->id = d.ints[C_ID][i];
+    r->sequence = d.ints[C_SEQUENCE][i];
+    r->flags = d.ints[C_FLAGS][i];
+    for (int v = 0; v < TS_VALUE_COUNT; v++) {
+        r->values[v] = d.values[v][i];
+    }
+    r->null_mask = d.null_mask[i];
+    int32_t t = d.traffic_index[i];
+    if (t >= 0) {
+        r->bc_id = d.ints[C_BC_ID][t];
+        r->period_ms = d.ints[C_PERIOD_MS][t];
+        r->bees_in = d.ints[C_BEES_IN][t];
+        r->bees_out = d.ints[C_BEES_OUT][t];
+        r->lane_mask = d.ints[C_LANE_MASK][t];
+        r->stuck_mask = d.ints[C_STUCK_MASK][t];
+    }
+}
+
+// ---- Hive file ----
+
+struct BlockRef {
+    uint64_t offset;
+    uint32_t length;
+    uint16_t rows;
+    uint16_t traffic_rows;
+    int64_t  t_min;
+    int64_t  t_max;
+    int64_t  id_max;
+};
+
+class TsHive {
+public:
+    TsHive(const std::string& path, int hive_id)
+        : _path(path), _hive_id(hive_id), _fd(-1), _wfd(-1), _ino(0), _map(nullptr),
+          _map_len(0), _valid_end(0) {}
+
+    ~TsHive() {
+        close_reader();
+        if (_wfd >= 0) {
+            close(_wfd);
+        }
+    }
+
+    bool refresh(std::string* err) {
+        struct stat st;
+        if (stat(_path.c_str(), &st) != 0) {
+            if (errno == ENOENT) {
+                close_reader();  // Removed (store rebuilt); empty until recreated
+                return true;
+            }
+            *err = errno_message("stat", _path);
+            return false;
+        }
+        if (_fd >= 0 && st.st_ino != _ino) {
+            close_reader();
+        }
+        if (_fd < 0) {
+            _fd = open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (_fd < 0) {
+                *err = errno_message("open", _path);
+                return false;
+            }
+            _ino = st.st_ino;
+        }
+        if (fstat(_fd, &st) != 0) {
+            *err = errno_message("fstat", _path);
+            return false;
+        }
+        size_t size = (size_t)st.st_size;
+        if (size < sizeof(FileHeader)) {
+            return true;  // Being created
+        }
+        if (size > _map_len) {
+            // Files only grow, so the old mapping stays valid until replaced
+            void* m = mmap(nullptr, size, PROT_READ, MAP_SHARED, _fd, 0);
+            if (m == MAP_FAILED) {
+                *err = errno_message("mmap", _path);
+                return false;
+            }
+            if (_map != nullptr) {
+                munmap((void*)_map, _map_len);
+            }
+            _map = (const uint8_t*)m;
+            _map_len = size;
+        }
+        if (_valid_end == 0) {
+            FileHeader fh;
+            memcpy(&fh, _map, sizeof(fh));
+            if (memcmp(fh.magic, FILE_MAGIC, 4) != 0 || fh.version != FILE_VERSION ||
+                fh.hive_id != (uint32_t)_hive_id) {
+                *err = "not a hive " + std::to_string(_hive_id) + " store file: " + _path;
+                return false;
+            }
+            _valid_end = sizeof(FileHeader);
+        }
+        scan();
+        return true;
+    }
+
+    bool append(const TsRow* rows, size_t n, std::string* err) {
+        if (n == 0 || n > TS_MAX_BLOCK_ROWS) {
+            *err = "block must hold 1-" + std::to_string(TS_MAX_BLOCK_ROWS) + " rows";
+            return false;
+        }
+        if (!refresh(err)) {
+            return false;
+        }
+        int64_t high_water = _blocks.empty() ? 0 : _blocks.back().id_max;
+        for (size_t i = 0; i < n; i++) {
+            if (rows[i].id <= high_water) {
+                *err = "reading id " + std::to_string(rows[i].id) +
+                       " is not above the stored high-water mark";
+                return false;
+            }
+            if (rows[i].bc_id < 0) {
+                *err = "negative bee_counts id";
+                return false;
+            }
+        }
+        std::vector<TsRow> sorted(rows, rows + n);
+        std::sort(sorted.begin(), sorted.end(), row_less);
+        std::vector<uint8_t> block;
+        encode_block(sorted, &block);
+
+        if (_wfd < 0) {
+            _wfd = open(_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (_wfd < 0) {
+                *err = errno_message("open", _path);
+                return false;
+            }
+        }
+        if (_valid_end == 0) {
+            FileHeader fh;
+            memset(&fh, 0, sizeof(fh));
+            memcpy(fh.magic, FILE_MAGIC, 4);
+            fh.version = FILE_VERSION;
+            fh.hive_id = (uint32_t)_hive_id;
+            if (!write_at(&fh, sizeof(fh), 0, err) || !refresh(err)) {
+                return false;
+            }
+        }
+        // Overwrites whatever a crashed append left after the last valid block
+        size_t before = _blocks.size();
+        if (!write_at(block.data(), block.size(), _valid_end, err) || !refresh(err)) {
+            return false;
+        }
+        if (_blocks.size() != before + 1) {
+            *err = "appended block failed verification in " + _path;
+            return false;
+        }
+        return true;
+    }
+
+    void info(TsHiveInfo* out) const {
+        memset(out, 0, sizeof(*out));
+        out->blocks = (uint32_t)_blocks.size();
+        out->bytes = _valid_end;
+        for (size_t i = 0; i < _blocks.size(); i++) {
+            const BlockRef& b = _blocks[i];
+            out->rows += b.rows;
+            out->traffic_rows += b.traffic_rows;
+            out->t_min = i == 0 ? b.t_min : std::min(out->t_min, b.t_min);
+            out->t_max = i == 0 ? b.t_max : std::max(out->t_max, b.t_max);
+        }
+        out->high_water_id = _blocks.empty() ? 0 : _blocks.back().id_max;
+    }
+
+    const std::vector<BlockRef>& blocks() const { return _blocks; }
+    const uint8_t* block_data(const BlockRef& b) const { return _map + b.offset; }
+
+private:
+    void close_reader() {
+        if (_map != nullptr) {
+            munmap((void*)_map, _map_len);
+        }
+        if (_fd >= 0) {
+            close(_fd);
+        }
+        _fd = -1;
+        _ino = 0;
+        _map = nullptr;
+        _map_len = 0;
+        _valid_end = 0;
+        _blocks.clear();
+    }
+
+    // Index complete blocks after _valid_end; stops at a torn or partly written one
+    void scan() {
+        while (_valid_end + sizeof(BlockHeader) <= _map_len) {
+            BlockHeader bh;
+            memcpy(&bh, _map + _valid_end, sizeof(bh));
+            if (memcmp(bh.magic, BLOCK_MAGIC, 4) != 0 || bh.length < sizeof(bh) ||
+                bh.length > _map_len - _valid_end || bh.rows == 0 ||
+                crc32(_map + _valid_end + sizeof(bh), bh.length - sizeof(bh)) != bh.crc) {
+                break;
+            }
+            BlockRef ref;
+            ref.offset = _valid_end;
+            ref.length = bh.length;
+            ref.rows = bh.rows;
+            ref.traffic_rows = bh.traffic_rows;
+            ref.t_min = bh.t_min;
+            ref.t_max = bh.t_max;
+            ref.id_max = bh.id_max;
+            _blocks.push_back(ref);
+            _valid_end += bh.length;
+        }
+    }
+
+    bool write_at(const void* data, size_t len, uint64_t offset, std::string* err) {
+        const uint8_t* p = (const uint8_t*)data;
+        while (len > 0) {
+            ssize_t n = pwrite(_wfd, p, len, (off_t)offset);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                *err = errno_message("write", _path);
+                return false;
+            }
+            p += n;
+            len -= (size_t)n;
+            offset += (uint64_t)n;
+        }
+        if (fdatasync(_wfd) != 0) {
+            *err = errno_message("fdatasync", _path);
+            return false;
+        }
+        return true;
+    }
+
+    std::string           _path;
+    int                   _hive_id;
+    int                   _fd;        // Reader
+    int                   _wfd;       // Writer, opened on first append
+    ino_t                 _ino;
+    const uint8_t*        _map;
+    size_t                _map_len;
+    uint64_t              _valid_end; // End of the last valid block, 0 = no header yet
+    std::vector<BlockRef> _blocks;
+};
+
+// ---- Store ----
+
+TsStore::TsStore(const std::string& dir) : _dir(dir) {}
+
+TsStore::~TsStore() {
+    for (auto& kv : _hives) {
+        delete kv.second;
+    }
+}
+
+TsHive* TsStore::hive(int hive_id) {
+    auto it = _hives.find(hive_id);
+    if (it != _hives.end()) {
+        return it->second;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "/hive_%d.wts", hive_id);
+    TsHive* h = new TsHive(_dir + name, hive_id);
+    _hives[hive_id] = h;
+    return h;
+}
+
+bool TsStore::append(int hive_id, const TsRow* rows, size_t n, std::string* err) {
+    return hive(hive_id)->append(rows, n, err);
+}
+
+bool TsStore::refresh(int hive_id, std::string* err) {
+    return hive(hive_id)->refresh(err);
+}
+
+bool TsStore::info(int hive_id, TsHiveInfo* out, std::string* err) {
+    TsHive* h = hive(hive_id);
+    if (!h->refresh(err)) {
+        return false;
+    }
+    h->info(out);
+    return true;
+}
+
+// Rows of a decoded block inside the query, in ascending order
+static void matching_rows(const BlockData& d, const TsQuery& q, std::vector<uint32_t>* out) {
+    out->clear();
+    for (uint32_t i = 0; i < d.rows; i++) {
+        int64_t t = d.ints[C_TIME][i];
+        if (t >= q.t_from && t <= q.t_to && (!q.traffic_only || d.traffic_index[i] >= 0)) {
+            out->push_back(i);
+        }
+    }
+}
+
+static std::string corrupt_block(const BlockRef& b) {
+    return "corrupt block at offset " + std::to_string(b.offset);
+}
+
+bool TsStore::query(int hive_id, const TsQuery& q, uint64_t* total, std::vector<TsRow>* rows,
+                    TsQueryStats* stats, std::string* err) {
+    TsHive* h = hive(hive_id);
+    if (!h->refresh(err)) {
+        return false;
+    }
+    *total = 0;
+    rows->clear();
+    memset(stats, 0, sizeof(*stats));
+
+    std::vector<const BlockRef*> cand;
+    bool ordered = true;
+    for (const BlockRef& b : h->blocks()) {
+        if (b.t_max < q.t_from || b.t_min > q.t_to) {
+            continue;
+        }
+        // Later blocks hold larger ids, so touching time ranges still sort by (time, id)
+        if (!cand.empty() && cand.back()->t_max > b.t_min) {
+            ordered = false;
+        }
+        cand.push_back(&b);
+    }
+
+    BlockData data;
+    std::vector<uint32_t> match;
+    TsRow row;
+
+    if (!ordered) {
+        // Late readings overlap earlier blocks: merge the candidates in memory
+        std::vector<TsRow> all;
+        for (const BlockRef* b : cand) {
+            if (!decode_block(h->block_data(*b), b->length, false, &data)) {
+                *err = corrupt_block(*b);
+                return false;
+            }
+            stats->blocks_decoded++;
+            matching_rows(data, q, &match);
+            for (uint32_t i : match) {
+                row_at(data, i, &row);
+                all.push_back(row);
+            }
+        }
+        std::sort(all.begin(), all.end(), row_less);
+        if (q.descending) {
+            std::reverse(all.begin(), all.end());
+        }
+        *total = all.size();
+        if (q.offset < all.size()) {
+            size_t end = (size_t)std::min<uint64_t>(all.size(), q.offset + q.limit);
+            rows->assign(all.begin() + (ptrdiff_t)q.offset, all.begin() + (ptrdiff_t)end);
+        }
+        return true;
+    }
+
+    // Per-block match counts; only blocks cut by a bound need their times decoded
+    std::vector<uint32_t> counts(cand.size());
+    for (size_t k = 0; k < cand.size(); k++) {
+        const BlockRef* b = cand[k];
+        if (b->t_min >= q.t_from && b->t_max <= q.t_to) {
+            counts[k] = q.traffic_only ? b->traffic_rows : b->rows;
+            continue;
+        }
+        if (!decode_block(h->block_data(*b), b->length, true, &data)) {
+            *err = corrupt_block(*b);
+            return false;
+        }
+        matching_rows(data, q, &match);
+        counts[k] = (uint32_t)match.size();
+    }
+    for (uint32_t c : counts) {
+        *total += c;
+    }
+
+    uint64_t skip = q.offset;
+    for (size_t j = 0; j < cand.size() && rows->size() < q.limit; j++) {
+        size_t k = q.descending ? cand.size() - 1 - j : j;
+        if (skip >= counts[k]) {
+            skip -= counts[k];
+            stats->blocks_skipped++;
+            continue;
+        }
+        const BlockRef* b = cand[k];
+        if (!decode_block(h->block_data(*b), b->length, false, &data)) {
+            *err = corrupt_block(*b);
+            return false;
+        }
+        stats->blocks_decoded++;
+        matching_rows(data, q, &match);
+        if (q.descending) {
+            std::reverse(match.begin(), match.end());
+        }
+        for (size_t i = (size_t)skip; i < match.size() && rows->size() < q.limit; i++) {
+            row_at(data, match[i], &row);
+            rows->push_back(row);
+        }
+        skip = 0;
+    }
+    return true;
+}
+
+// ---- Time formatting ----
+
+void ts_format_utc(int64_t t_ms, char out[25]) {
+    int64_t secs = t_ms >= 0 ? t_ms / 1000 : (t_ms - 999) / 1000;
+    unsigned ms = (unsigned)(t_ms - secs * 1000);
+    int64_t days = secs >= 0 ? secs / 86400 : (secs - 86399) / 86400;
+    unsigned sod = (unsigned)(secs - days * 86400);
+
+    // Civil date from days since 1970-01-01 (Howard Hinnant's algorithm)
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = (unsigned)(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    unsigned day = doy - (153 * mp + 2) / 5 + 1;
+    unsigned month = mp < 10 ? mp + 3 : mp - 9;
+    int64_t year = (int64_t)yoe + era * 400 + (month <= 2);
+
+    char buf[64];  // Room for the compiler's worst case; the output is always 24 chars
+    snprintf(buf, sizeof(buf), "%04u-%02u-%02uT%02u:%02u:%02u.%03uZ",
+             (unsigned)(year % 10000), month, day, sod / 3600, sod / 60 % 60, sod % 60, ms);
+    memcpy(out, buf, 25);
+}
@@ -0,0 +1,126 @@
+/**
+ * Waggle Hub — compressed columnar time-series store for sensor readings.
+ *
+ * One append-only file per hive (hive_<id>.wts) holding sealed blocks of
+ * sensor_readings rows with their bee_counts traffic joined in.  A block is
+ * written once and never modified, so readers mmap the file and pick up new
+ * blocks by checking its size; a torn block after a crash fails its CRC and
+ * is overwritten by the next append.
+ *
+ * Within a block rows are sorted by (observed_at, id) and stored column by
+ * column.  Integer columns are delta or delta-of-delta coded (whichever is
+ * smaller), zigzagged and packed with Stream VByte (svb.h).  The REAL
+ * columns are fixed-point at ingestion (weight_g / 1000.0 and so on), so
+ * they go through the same path as scaled integers; a column holding a
+ * value that does not round-trip exactly falls back to XOR-of-previous
+ * float coding.  Block headers carry row counts and time / id bounds, so
+ * range counts and deep offsets skip whole blocks without decoding them.
+ *
+ * Little-endian hosts only (x86-64 and ARM Pi).
+ */
+
+#ifndef WAGGLE_TSSTORE_H
+#define WAGGLE_TSSTORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+static constexpr uint32_t TS_BLOCK_ROWS = 512;  // Rows per sealed block (exporter)
+static constexpr uint32_t TS_MAX_BLOCK_ROWS = 65535;
+
+// Nullable REAL columns of sensor_readings, in order
+enum TsValue {
+    TS_WEIGHT_KG,
+    TS_TEMP_C,
+    TS_HUMIDITY_PCT,
+    TS_PRESSURE_HPA,
+    TS_BATTERY_V,
+    TS_VALUE_COUNT,
+};
+
+struct TsRow {
+    int64_t id;           // sensor_readings.id
+    int64_t t_ms;         // observed_at, ms since the epoch
+    int64_t sequence;
+    int64_t flags;
+    double  values[TS_VALUE_COUNT];
+    uint8_t null_mask;    // Bit i set: values[i] is NULL
+    // bee_counts row for this reading; bc_id == 0 when there is none
+    int64_t bc_id;
+    int64_t period_ms;
+    int64_t bees_in;
+    int64_t bees_out;
+    int64_t lane_mask;
+    int64_t stuck_mask;
+};
+
+struct TsQuery {
+    int64_t  t_from;       // Inclusive observed_at bounds, ms
+    int64_t  t_to;
+    bool     traffic_only; // Only rows with a bee_counts record
+    bool     descending;
+    uint64_t offset;
+    uint64_t limit;
+};
+
+struct TsQueryStats {
+    uint32_t blocks_skipped;  // Counted or skipped from the header alone
+    uint32_t blocks_decoded;
+};
+
+struct TsHiveInfo {
+    uint32_t blocks;
+    uint64_t rows;
+    uint64_t traffic_rows;
+    uint64_t bytes;          // Valid bytes on disk
+    int64_t  high_water_id;  // Largest stored reading id, 0 if none
+    int64_t  t_min;          // Stored observed_at bounds (0 if empty)
+    int64_t  t_max;
+};
+
+class TsHive;
+
+class TsStore {
+public:
+    explicit TsStore(const std::string& dir);
+    ~TsStore();
+
+    TsStore(const TsStore&) = delete;
+    TsStore& operator=(const TsStore&) = delete;
+
+    /**
+     * Seal rows (1..TS_MAX_BLOCK_ROWS, every id above the hive's high-water
+     * mark) into a new block and fsync it.
+     */
+    bool append(int hive_id, const TsRow* rows, size_t n, std::string* err);
+
+    /** Pick up blocks appended by another process. */
+    bool refresh(int hive_id, std::string* err);
+
+    bool info(int hive_id, TsHiveInfo* out, std::string* err);
+
+    /**
+     * Rows in [t_from, t_to] ordered by (observed_at, id), ascending or
+     * descending, after skipping offset; *total is the full match count.
+     * Refreshes the hive first.
+     */
+    bool query(int hive_id, const TsQuery& q, uint64_t* total, std::vector<TsRow>* rows,
+               TsQueryStats* stats, std::string* err);
+
+    const std::string& dir() const { return _dir; }
+
+private:
+    TsHive* hive(int hive_id);
+
+    std::string             _dir;
+    std::map<int, TsHive*>  _hives;
+};
+
+/** Format ms since the epoch as YYYY-MM-DDTHH:MM:SS.mmmZ (25-byte buffer). */
+void ts_format_utc(int64_t t_ms, char out[25]);
+
+#endif  // WAGGLE_TSSTORE_H
@@ -0,0 +1,292 @@
+/**
+ * Waggle Hub — waggle._tsstore: CPython binding for the time-series store.
+ *
+ *   Store(path)
+ *     .append(hive_id, rows)        seal rows into one block
+ *     .info(hive_id) -> dict        blocks, rows, traffic_rows, bytes,
+ *                                   high_water_id, t_min, t_max
+ *     .readings(hive_id, t_from, t_to, offset, limit, descending=True)
+ *         -> (total, [(id, observed_at, weight_kg, temp_c, humidity_pct,
+ *                      pressure_hpa, battery_v, sequence, flags), ...])
+ *     .traffic(hive_id, t_from, t_to, offset, limit, descending=False)
+ *         -> (total, [(bee_count_id, reading_id, observed_at, period_ms,
+ *                      bees_in, bees_out, lane_mask, stuck_mask, flags), ...])
+ *
+ * append() rows are tuples of (id, t_ms, weight_kg, temp_c, humidity_pct,
+ * pressure_hpa, battery_v, sequence, flags, bee_count_id, period_ms,
+ * bees_in, bees_out, lane_mask, stuck_mask), None for NULL.  Times are ms
+ * since the epoch with inclusive bounds.  Store errors raise OSError.
+ * waggle/services/tsstore.py wraps this module and is the only caller.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <string>
+#include <vector>
+
+#include "svb.h"
+#include "tsstore.h"
+
+struct StoreObject {
+    PyObject_HEAD
+    TsStore* store;
+};
+
+static constexpr Py_ssize_t APPEND_FIELDS = 15;
+
+static PyObject* store_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* kwlist[] = {"path", nullptr};
+    const char* path;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &path)) {
+        return nullptr;
+    }
+    StoreObject* self = (StoreObject*)type->tp_alloc(type, 0);
+    if (self == nullptr) {
+        return nullptr;
+    }
+    self->store = new TsStore(path);
+    return (PyObject*)self;
+}
+
+static void store_dealloc(StoreObject* self) {
+    delete self->store;
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* store_error(const std::string& err) {
+    PyErr_SetString(PyExc_OSError, err.c_str());
+    return nullptr;
+}
+
+// ---- append ----
+
+static bool int_field(PyObject* item, int64_t* out) {
+    long long v = PyLong_AsLongLong(item);
+    if (v == -1 && PyErr_Occurred()) {
+        return false;
+    }
+    *out = (int64_t)v;
+    return true;
+}
+
+static bool row_from_tuple(PyObject* obj, TsRow* r) {
+    PyObject* seq = PySequence_Fast(obj, "rows must be tuples");
+    if (seq == nullptr) {
+        return false;
+    }
+    bool ok = false;
+    PyObject** f = PySequence_Fast_ITEMS(seq);
+    memset(r, 0, sizeof(*r));
+    if (PySequence_Fast_GET_SIZE(seq) != APPEND_FIELDS) {
+        PyErr_Format(PyExc_ValueError, "rows must have %zd fields", APPEND_FIELDS);
+        goto done;
+    }
+    if (!int_field(f[0], &r->id) || !int_field(f[1], &r->t_ms)) {
+        goto done;
+    }
+    for (int v = 0; v < TS_VALUE_COUNT; v++) {
+        PyObject* item = f[2 + v];
+        if (item == Py_None) {
+            r->null_mask |= (uint8_t)(1u << v);
+            continue;
+        }
+        r->values[v] = PyFloat_AsDouble(item);
+        if (r->values[v] == -1.0 && PyErr_Occurred()) {
+            goto done;
+        }
+    }
+    if (!int_field(f[7], &r->sequence) || !int_field(f[8], &r->flags)) {
+        goto done;
+    }
+    if (f[9] != Py_None) {
+        if (!int_field(f[9], &r->bc_id) || !int_field(f[10], &r->period_ms) ||
+            !int_field(f[11], &r->bees_in) || !int_field(f[12], &r->bees_out) ||
+            !int_field(f[13], &r->lane_mask) || !int_field(f[14], &r->stuck_mask)) {
+            goto done;
+        }
+        if (r->bc_id <= 0) {
+            PyErr_SetString(PyExc_ValueError, "bee_count_id must be positive");
+            goto done;
+        }
+    }
+    ok = true;
+done:
+    Py_DECREF(seq);
+    return ok;
+}
+
+static PyObject* store_append(StoreObject* self, PyObject* args) {
+    int hive_id;
+    PyObject* rows_obj;
+    if (!PyArg_ParseTuple(args, "iO", &hive_id, &rows_obj)) {
+        return nullptr;
+    }
+    PyObject* seq = PySequence_Fast(rows_obj, "rows must be a sequence");
+    if (seq == nullptr) {
+        return nullptr;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    std::vector<TsRow> rows((size_t)n);
+    for (Py_ssize_t i = 0; i < n; i++) {
+        if (!row_from_tuple(PySequence_Fast_GET_ITEM(seq, i), &rows[(size_t)i])) {
+            Py_DECREF(seq);
+            return nullptr;
+        }
+    }
+    Py_DECREF(seq);
+
+    std::string err;
+    if (!self->store->append(hive_id, rows.data(), rows.size(), &err)) {
+        return store_error(err);
+    }
+    Py_RETURN_NONE;
+}
+
+// ---- info ----
+
+static PyObject* store_info(StoreObject* self, PyObject* args) {
+    int hive_id;
+    if (!PyArg_ParseTuple(args, "i", &hive_id)) {
+        return nullptr;
+    }
+    TsHiveInfo info;
+    std::string err;
+    if (!self->store->info(hive_id, &info, &err)) {
+        return store_error(err);
+    }
+    return Py_BuildValue("{s:I,s:K,s:K,s:K,s:L,s:L,s:L}", "blocks", info.blocks, "rows",
+                         (unsigned long long)info.rows, "traffic_rows",
+                         (unsigned long long)info.traffic_rows, "bytes",
+                         (unsigned long long)info.bytes, "high_water_id",
+                         (long long)info.high_water_id, "t_min", (long long)info.t_min, "t_max",
+                         (long long)info.t_max);
+}
+
+// ---- queries ----
+
+static PyObject* optional_float(const TsRow& r, int v) {
+    if (r.null_mask & (1u << v)) {
+        Py_RETURN_NONE;
+    }
+    return PyFloat_FromDouble(r.values[v]);
+}
+
+static PyObject* observed_at(const TsRow& r) {
+    char buf[25];
+    ts_format_utc(r.t_ms, buf);
+    return PyUnicode_FromStringAndSize(buf, 24);
+}
+
+static PyObject* reading_tuple(const TsRow& r) {
+    return Py_BuildValue("(LNNNNNNLL)", (long long)r.id, observed_at(r),
+                         optional_float(r, TS_WEIGHT_KG), optional_float(r, TS_TEMP_C),
+                         optional_float(r, TS_HUMIDITY_PCT), optional_float(r, TS_PRESSURE_HPA),
+                         optional_float(r, TS_BATTERY_V), (long long)r.sequence,
+                         (long long)r.flags);
+}
+
+static PyObject* traffic_tuple(const TsRow& r) {
+    return Py_BuildValue("(LLNLLLLLL)", (long long)r.bc_id, (long long)r.id, observed_at(r),
+                         (long long)r.period_ms, (long long)r.bees_in, (long long)r.bees_out,
+                         (long long)r.lane_mask, (long long)r.stuck_mask, (long long)r.flags);
+}
+
+static PyObject* run_query(StoreObject* self, PyObject* args, PyObject* kwargs, bool traffic) {
+    static const char* kwlist[] = {"hive_id", "t_from", "t_to", "offset", "limit",
+                                   "descending", nullptr};
+    int hive_id;
+    long long t_from, t_to;
+    unsigned long long offset, limit;
+    int descending = traffic ? 0 : 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "iLLKK|p", (char**)kwlist, &hive_id,
+                                     &t_from, &t_to, &offset, &limit, &descending)) {
+        return nullptr;
+    }
+    TsQuery q;
+    q.t_from = t_from;
+    q.t_to = t_to;
+    q.traffic_only = traffic;
+    q.descending = descending != 0;
+    q.offset = offset;
+    q.limit = limit;
+
+    uint64_t total;
+    std::vector<TsRow> rows;
+    TsQueryStats stats;
+    std::string err;
+    if (!self->store->query(hive_id, q, &total, &rows, &stats, &err)) {
+        return store_error(err);
+    }
+
+    PyObject* list = PyList_New((Py_ssize_t)rows.size());
+    if (list == nullptr) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < rows.size(); i++) {
+        PyObject* t = traffic ? traffic_tuple(rows[i]) : reading_tuple(rows[i]);
+        if (t == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, (Py_ssize_t)i, t);
+    }
+    return Py_BuildValue("(KN)", (unsigned long long)total, list);
+}
+
+static PyObject* store_readings(StoreObject* self, PyObject* args, PyObject* kwargs) {
+    return run_query(self, args, kwargs, false);
+}
+
+static PyObject* store_traffic(StoreObject* self, PyObject* args, PyObject* kwargs) {
+    return run_query(self, args, kwargs, true);
+}
+
+static PyMethodDef s_store_methods[] = {
+    {"append", (PyCFunction)store_append, METH_VARARGS,
+     "append(hive_id, rows)\n\nSeal rows into a new block and fsync it."},
+    {"info", (PyCFunction)store_info, METH_VARARGS,
+     "info(hive_id) -> dict\n\nBlock, row and byte counts and the high-water id."},
+    {"readings", (PyCFunction)(void (*)(void))store_readings, METH_VARARGS | METH_KEYWORDS,
+     "readings(hive_id, t_from, t_to, offset, limit, descending=True) -> (total, rows)"},
+    {"traffic", (PyCFunction)(void (*)(void))store_traffic, METH_VARARGS | METH_KEYWORDS,
+     "traffic(hive_id, t_from, t_to, offset, limit, descending=False) -> (total, rows)"},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+static PyTypeObject s_store_type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+static struct PyModuleDef s_module = {
+    PyModuleDef_HEAD_INIT, "waggle._tsstore",
+    "Compressed columnar store for sensor readings.", -1, nullptr,
+    nullptr, nullptr, nullptr, nullptr,
+};
+
+PyMODINIT_FUNC PyInit__tsstore(void) {
+    s_store_type.tp_name = "waggle._tsstore.Store";
+    s_store_type.tp_basicsize = sizeof(StoreObject);
+    s_store_type.tp_flags = Py_TPFLAGS_DEFAULT;
+    s_store_type.tp_doc = "Store(path): per-hive block files under path.";
+    s_store_type.tp_new = store_new;
+    s_store_type.tp_dealloc = (destructor)store_dealloc;
+    s_store_type.tp_methods = s_store_methods;
+    if (PyType_Ready(&s_store_type) < 0) {
+        return nullptr;
+    }
+
+    PyObject* m = PyModule_Create(&s_module);
+    if (m == nullptr) {
+        return nullptr;
+    }
+    Py_INCREF(&s_store_type);
+    if (PyModule_AddObject(m, "Store", (PyObject*)&s_store_type) < 0 ||
+        PyModule_AddIntConstant(m, "BLOCK_ROWS", TS_BLOCK_ROWS) < 0 ||
+        PyModule_AddStringConstant(m, "DECODER", svb_decoder_name()) < 0) {
+        Py_DECREF(&s_store_type);
+        Py_DECREF(m);
+        return nullptr;
+    }
+    return m;
+}
@@ -0,0 +1,110 @@
+"""Optional native extension builds; project metadata lives in pyproject.toml.
+
+waggle._frames (backend/native) compiles the bridge firmware's COBS decoder
+and the sensor firmware's payload layout into a frame decoder for the
+bridge service.  The firmware sources are found at ../firmware, or at
+WAGGLE_FIRMWARE_DIR when backend/ has been copied elsewhere (install.sh).
+If they are missing or the compiler fails, the package installs without
+the extension and waggle.utils.frames uses pure Python.
+
+waggle._tsstore (backend/native/tsstore) is the compressed time-series
+store behind TSSTORE_DIR; without it the raw reading queries stay on
+SQLite.
+
+waggle._alerts (backend/native/alerts) keeps the alert rules' look-back
+windows in memory; without it AlertEngine evaluates them with SQL.
+
+waggle._latest (backend/native/latest) maps the shared-memory table of
+each hive's latest reading behind LATEST_STATE_PATH; without it the hives
+and status endpoints query SQLite.
+
+waggle._preprocess (backend/native/preprocess) decodes and letterboxes
+photos for the ML worker with libjpeg-turbo (libjpeg-turbo8-dev or
+libjpeg62-turbo-dev); without it ultralytics pre-processes each photo.
+"""
+
+import os
+from pathlib import Path
+
+from setuptools import Extension, setup
+
+HERE = Path(__file__).resolve().parent
+FIRMWARE = Path(os.environ.get("WAGGLE_FIRMWARE_DIR", HERE.parent / "firmware"))
+
+
+def _relative(path: Path) -> str:
+    # setuptools wants source paths relative to setup.py
+    return os.path.relpath(path, HERE)
+
+
+ext_modules = []
+if (FIRMWARE / "bridge" / "src" / "cobs.cpp").is_file():
+    ext_modules.append(
+        Extension(
+            "waggle._frames",
+            sources=[
+                "native/framesmodule.cpp",
+                "native/frame_decoder.cpp",
+                _relative(FIRMWARE / "bridge" / "src" / "cobs.cpp"),
+            ],
+            include_dirs=[
+                "native",
+                _relative(FIRMWARE / "bridge" / "src"),
+                _relative(FIRMWARE / "sensor" / "src"),
+            ],
+            extra_compile_args=["-std=c++11", "-O2"],
+            language="c++",
+            optional=True,
+        )
+    )
+
+ext_modules.append(
+    Extension(
+        "waggle._tsstore",
+        sources=[
+            "native/tsstoremodule.cpp",
+            "native/tsstore/tsstore.cpp",
+            "native/tsstore/svb.cpp",
+        ],
+        include_dirs=["native/tsstore"],
+        extra_compile_args=["-std=c++11", "-O2"],
+        language="c++",
+        optional=True,
+    )
+)
+
+ext_modules.append(
+    Extension(
+        "waggle._alerts",
+        sources=["native/alertsmodule.cpp", "native/alerts/hive_windows.cpp"],
+        include_dirs=["native/alerts"],
+        extra_compile_args=["-std=c++11", "-O2"],
+        language="c++",
+        optional=True,
+    )
+)
+
+ext_modules.append(
+    Extension(
+        "waggle._latest",
+        sources=["native/latestmodule.cpp", "native/latest/latest_table.cpp"],
+        include_dirs=["native/latest"],
+        extra_compile_args=["-std=c++11", "-O2"],
+        language="c++",
+        optional=True,
+    )
+)
+
+ext_modules.append(
+    Extension(
+        "waggle._preprocess",
+        sources=["native/preprocessmodule.cpp", "native/preprocess/preprocess.cpp"],
+        include_dirs=["native/preprocess"],
+        libraries=["jpeg"],
+        extra_compile_args=["-std=c++11", "-O2"],
+        language="c++",
+        optional=True,
+    )
+)
+
+setup(ext_modules=ext_modules)
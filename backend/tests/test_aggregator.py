@@ -0,0 +1,73 @@
+"""Tests for the multi-bridge aggregator (native/aggregator), run over FIFOs."""
+
+import json
+import os
+import signal
+import subprocess
+import time
+from pathlib import Path
+
+import pytest
+
+from tests.test_bridge import _build_phase2_frame
+
+AGGREGATOR = Path(__file__).resolve().parents[1] / "native" / "aggregator" / "aggregator"
+
+pytestmark = pytest.mark.skipif(
+    not AGGREGATOR.exists(), reason="aggregator not built (make -C backend/native aggregator)"
+)
+
+
+def _aggregate(tmp_path, frames: list[tuple[int, bytes]]) -> tuple[bytes, dict]:
+    """Feed (bridge index, COBS frame) pairs through two bridges.
+
+    Returns the merged output stream and the final stats JSON.
+    """
+    fifos = [tmp_path / "north", tmp_path / "south"]
+    for fifo in fifos:
+        os.mkfifo(fifo)
+    out = tmp_path / "merged.bin"
+    stats = tmp_path / "stats.json"
+    proc = subprocess.Popen(
+        [str(AGGREGATOR), "--bridge", f"north={fifos[0]}", "--bridge", f"south={fifos[1]}",
+         "--out", str(out), "--stats-json", str(stats), "--stats-s", "0"],
+        stderr=subprocess.DEVNULL,
+    )
+    try:
+        # Opening for write blocks until the aggregator has the read end open
+        writers = [open(fifo, "wb", buffering=0) for fifo in fifos]
+        for bridge, frame in frames:
+            writers[bridge].write(frame + b"\x00")
+            time.sleep(0.02)  # Keep arrival order across the two ports
+        time.sleep(0.2)
+        for w in writers:
+            w.close()
+    finally:
+        proc.send_signal(signal.SIGTERM)
+        proc.wait(timeout=5)
+    return out.read_bytes(), json.loads(stats.read_text())
+
+
+def test_bridge_trace_stamps_do_not_split_packets(tmp_path):
+    # Same packet, each bridge stamping its own receive time and hold
+    north = _build_phase2_frame(trace=(1, 30, 0, 5000, 250))
+    south = _build_phase2_frame(trace=(1, 30, 0, 7123, 410))
+    merged, stats = _aggregate(tmp_path, [(0, north), (1, south)])
+
+    assert merged == north + b"\x00"
+    assert stats["forwarded"] == 1
+    assert stats["duplicates"] == 1
+    assert [b["first"] for b in stats["bridges"]] == [1, 0]
+    assert [b["duplicates"] for b in stats["bridges"]] == [0, 1]
+    assert stats["heard_by"] == [0, 1]
+
+
+def test_node_retry_counted_as_repeat(tmp_path):
+    # The node rewrites tx_attempt and retry_ms before transmitting again
+    first = _build_phase2_frame(trace=(1, 30, 0, 5000, 250))
+    retry = _build_phase2_frame(trace=(2, 30, 120, 5120, 260))
+    other = _build_phase2_frame(sequence=43, trace=(1, 30, 0, 65000, 250))
+    _, stats = _aggregate(tmp_path, [(0, first), (0, retry), (0, other)])
+
+    assert stats["forwarded"] == 2
+    assert stats["bridges"][0]["repeats"] == 1
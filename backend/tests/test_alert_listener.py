@@ -0,0 +1,77 @@
+"""Tests for the ingestd alert listener."""
+
+import json
+
+from waggle.services.alert_listener import handle_message, parse_ingested
+
+
+def _message(**overrides) -> bytes:
+    msg = {
+        "reading_id": 42,
+        "hive_id": 3,
+        "observed_at": "2026-03-01T12:00:00.000Z",
+        "flags": 0,
+        "weight_kg": 32.5,
+        "temp_c": 41.2,
+        "humidity_pct": 55.0,
+        "pressure_hpa": 1013.2,
+        "battery_v": None,
+    }
+    msg.update(overrides)
+    return json.dumps(msg).encode()
+
+
+class StubAlertEngine:
+    def __init__(self):
+        self.calls = []
+
+    async def check_reading(self, hive_id, reading):
+        self.calls.append((hive_id, reading))
+        return [{"type": "HIGH_TEMP"}]
+
+
+def test_parse_phase1_matches_ingestion_dict():
+    hive_id, reading = parse_ingested(_message())
+    assert hive_id == 3
+    assert reading == {
+        "weight_kg": 32.5,
+        "temp_c": 41.2,
+        "humidity_pct": 55.0,
+        "pressure_hpa": 1013.2,
+        "battery_v": None,
+        "observed_at": "2026-03-01T12:00:00.000Z",
+        "flags": 0,
+    }
+
+
+def test_parse_phase2_adds_traffic_fields():
+    _, reading = parse_ingested(
+        _message(bees_in=120, bees_out=80, period_ms=60000, lane_mask=15, stuck_mask=0)
+    )
+    assert reading["bees_in"] == 120
+    assert reading["bees_out"] == 80
+    assert reading["period_ms"] == 60000
+    assert reading["lane_mask"] == 15
+    assert reading["stuck_mask"] == 0
+
+
+def test_parse_rejects_malformed():
+    assert parse_ingested(b"not json") is None
+    assert parse_ingested(b"[1, 2]") is None
+    assert parse_ingested(_message(hive_id=0)) is None
+    assert parse_ingested(_message(hive_id="3")) is None
+    assert parse_ingested(_message(observed_at=None)) is None
+
+
+async def test_handle_message_calls_alert_engine():
+    engine = StubAlertEngine()
+    alerts = await handle_message(engine, _message())
+    assert alerts == [{"type": "HIGH_TEMP"}]
+    assert engine.calls[0][0] == 3
+    assert engine.calls[0][1]["temp_c"] == 41.2
+
+
+async def test_handle_message_skips_malformed():
+    engine = StubAlertEngine()
+    assert await handle_message(engine, b"{}") == []
+    assert engine.calls == []
@@ -0,0 +1,251 @@
+"""Tests for StreamingAlertEngine and the native alert windows (waggle._alerts).
+
+The replay tests store the same readings in two databases and check each
+one with AlertEngine (SQL) and StreamingAlertEngine; the fired alerts must
+be identical.
+"""
+
+import random
+from datetime import UTC, datetime, timedelta
+
+import pytest
+from sqlalchemy import text
+from sqlalchemy.ext.asyncio import AsyncSession
+
+from waggle.database import create_engine_from_url, init_db
+from waggle.models import Hive
+from waggle.services.alert_engine import AlertEngine
+from waggle.services.alert_stream import StreamingAlertEngine
+from waggle.utils.timestamps import utc_now
+
+_alerts = pytest.importorskip("waggle._alerts")
+
+T0 = datetime(2026, 3, 1, tzinfo=UTC)
+HOUR_MS = 3_600_000
+
+
+def _ts(dt: datetime) -> str:
+    return dt.strftime("%Y-%m-%dT%H:%M:%S.%f")[:-3] + "Z"
+
+
+def _ms(dt: datetime) -> int:
+    return (dt - datetime(1970, 1, 1, tzinfo=UTC)) // timedelta(milliseconds=1)
+
+
+# --- Windows ---
+
+
+def test_windows_reject_out_of_order_rows():
+    windows = _alerts.Windows()
+    t = _ms(T0)
+    windows.seed(1, [(t, 30.0, 0, 10, 20, 0)], [])
+    assert 1 in windows
+    assert windows.add(1, (t + 60_000, 30.0, 0, 10, 20, 0))
+    assert not windows.add(1, (t + 30_000, 30.0, 0, 10, 20, 0))
+    windows.forget(1)
+    assert 1 not in windows
+    with pytest.raises(ValueError, match="order"):
+        windows.seed(1, [(t, 30.0, 0, None, 0, 0), (t - 1, 30.0, 0, None, 0, 0)], [])
+
+
+def test_windows_hour_bound_is_inclusive():
+    windows = _alerts.Windows()
+    t = _ms(T0)
+    # 30 eligible rows: the first at exactly now - 1h, weight 35 -> 33
+    rows = [(t + i * 60_000, 35.0 if i == 0 else 33.0, 0, 0, 20, 0) for i in range(31)]
+    rows[-1] = (t + HOUR_MS, 33.0, 0, 0, 20, 0)
+    windows.seed(1, rows[1:], [])
+    assert windows.evaluate(1, 33.0)[2] is None  # No drop without the 35 kg row
+    windows.seed(1, rows, [])
+    assert windows.evaluate(1, 33.0)[2] == (2.0, 620, 31)
+    assert windows.add(1, (t + HOUR_MS + 1, 33.0, 0, 0, 20, 0))
+    assert windows.evaluate(1, 33.0)[2] is None  # The 35 kg row has left the window
+
+
+def test_windows_newest_weight_is_first_stored_of_a_tie():
+    windows = _alerts.Windows()
+    t = _ms(T0)
+    rows = [(t + i * 60_000, 36.0, 0, 0, 20, 0) for i in range(29)]
+    rows += [(t + 29 * 60_000, 34.0, 0, 0, 20, 0), (t + 29 * 60_000, 35.0, 0, 0, 20, 0)]
+    windows.seed(1, rows, [])
+    assert windows.evaluate(1, 35.0)[2] == (2.0, 620, 31)
+
+
+# --- Replay against AlertEngine ---
+
+
+@pytest.fixture
+async def engines(tmp_path):
+    pairs = []
+    for name, cls in (("sql", AlertEngine), ("stream", StreamingAlertEngine)):
+        db = create_engine_from_url(f"sqlite+aiosqlite:///{tmp_path / name}.db")
+        await init_db(db)
+        async with AsyncSession(db) as session:
+            session.add(Hive(id=1, name="Test", created_at=utc_now()))
+            session.add(Hive(id=2, name="Other", created_at=utc_now()))
+            await session.commit()
+        pairs.append((db, cls(db)))
+    yield pairs
+    for db, _ in pairs:
+        await db.dispose()
+
+
+async def _store(db, hive_id: int, r: dict) -> None:
+    async with AsyncSession(db) as session:
+        result = await session.execute(
+            text(
+                "INSERT INTO sensor_readings (hive_id, observed_at, ingested_at, weight_kg, "
+                "temp_c, humidity_pct, pressure_hpa, battery_v, sequence, flags, sender_mac) "
+                "VALUES (:hive_id, :observed_at, :observed_at, :weight_kg, :temp_c, 55.0, "
+                "1013.0, :battery_v, :sequence, :flags, 'AA:BB:CC:DD:EE:FF') RETURNING id"
+            ),
+            {"hive_id": hive_id, **r},
+        )
+        reading_id = result.scalar_one()
+        if "bees_in" in r:
+            await session.execute(
+                text(
+                    "INSERT INTO bee_counts (reading_id, hive_id, observed_at, ingested_at, "
+                    "period_ms, bees_in, bees_out, lane_mask, stuck_mask, sequence, flags, "
+                    "sender_mac) VALUES (:rid, :hive_id, :observed_at, :observed_at, 60000, "
+                    ":bees_in, :bees_out, 15, :stuck_mask, :sequence, :flags, "
+                    "'AA:BB:CC:DD:EE:FF')"
+                ),
+                {"rid": reading_id, "hive_id": hive_id, **r},
+            )
+        await session.commit()
+
+
+async def _replay(engines, readings: list[tuple[int, dict]]) -> list[list[tuple]]:
+    """Store and check each reading with every engine; returns each engine's alerts."""
+    fired = [[] for _ in engines]
+    for hive_id, r in readings:
+        for i, (db, alert_engine) in enumerate(engines):
+            await _store(db, hive_id, r)
+            reading = {k: v for k, v in r.items() if k != "sequence"}
+            alerts = await alert_engine.check_reading(hive_id, reading)
+            fired[i].append(
+                [(a["hive_id"], a["type"], a["severity"], a["message"], a["observed_at"])
+                 for a in alerts]
+            )
+    return fired
+
+
+def _reading(t: datetime, seq: int, weight, traffic=None, flags=0, temp_c=35.0) -> dict:
+    r = {
+        "observed_at": _ts(t),
+        "weight_kg": weight,
+        "temp_c": temp_c,
+        "humidity_pct": 55.0,
+        "pressure_hpa": 1013.0,
+        "battery_v": 3.7,
+        "flags": flags,
+        "sequence": seq % 65536,
+    }
+    if traffic is not None:
+        bees_in, bees_out, stuck = traffic
+        r.update(bees_in=bees_in, bees_out=bees_out, period_ms=60000, lane_mask=15,
+                 stuck_mask=stuck)
+    return r
+
+
+def _trace(start: datetime, minutes: int, weight_at, traffic_at, hive_id: int = 1):
+    return [
+        (hive_id, _reading(start + timedelta(minutes=m), m, weight_at(m), traffic_at(m)))
+        for m in range(minutes)
+    ]
+
+
+async def _assert_same(engines, readings) -> list[list[tuple]]:
+    sql, stream = await _replay(engines, readings)
+    assert stream == sql
+    return sql
+
+
+def _types(fired) -> set[str]:
+    return {a[1] for alerts in fired for a in alerts}
+
+
+async def test_replay_swarm_correlation(engines):
+    readings = _trace(
+        T0, 90, lambda m: 36.0 if m < 60 else 36.0 - 0.1 * (m - 60), lambda m: (1, 25, 0)
+    )
+    fired = await _assert_same(engines, readings)
+    assert "POSSIBLE_SWARM" in _types(fired)
+
+
+async def test_replay_weight_only_swarm_without_traffic(engines):
+    readings = _trace(T0, 40, lambda m: 36.0 if m < 30 else 33.0, lambda m: None)
+    fired = await _assert_same(engines, readings)
+    assert ("POSSIBLE_SWARM", "high") in {(a[1], a[2]) for alerts in fired for a in alerts}
+
+
+async def test_replay_absconding_and_robbing(engines):
+    readings = _trace(
+        T0, 150, lambda m: 40.0 - 0.03 * max(0, m - 60), lambda m: (2, 12, 0), hive_id=1
+    )
+    readings += _trace(
+        T0, 90, lambda m: 40.0 - 0.02 * m, lambda m: (60, 10, 0), hive_id=2
+    )
+    readings.sort(key=lambda r: r[1]["observed_at"])
+    fired = await _assert_same(engines, readings)
+    assert {"ABSCONDING", "ROBBING"} <= _types(fired)
+
+
+async def test_replay_low_activity(engines):
+    # Four busy days, then a quiet one; readings every 30 minutes
+    readings = [
+        (
+            1,
+            _reading(
+                T0 + timedelta(minutes=30 * i), i, 40.0, (50, 50, 0) if i < 192 else (0, 1, 0)
+            ),
+        )
+        for i in range(240)
+    ]
+    fired = await _assert_same(engines, readings)
+    assert "LOW_ACTIVITY" in _types(fired)
+
+
+async def test_replay_excluded_flags_and_stuck_lanes(engines):
+    rng = random.Random(3)
+    readings = [
+        (1, _reading(
+            T0 + timedelta(minutes=m),
+            m,
+            None if m % 17 == 0 else 36.0 - (0.08 * (m - 50) if m > 50 else 0),
+            (rng.randint(0, 3), rng.randint(15, 30), 1 if m % 7 == 0 else 0),
+            flags=rng.choice([0, 0, 0, 0x02, 0x40]),
+        ))
+        for m in range(100)
+    ]
+    await _assert_same(engines, readings)
+
+
+async def test_replay_late_readings_and_thresholds(engines):
+    rng = random.Random(7)
+    readings = _trace(
+        T0, 120, lambda m: 38.0 - 0.05 * max(0, m - 70), lambda m: (1, 22, 0)
+    )
+    # Readings buffered by the bridge arrive after newer ones
+    for i in range(0, 120, 15):
+        late = readings.pop(i)
+        readings.insert(min(len(readings), i + rng.randint(2, 10)), late)
+    readings.append((1, _reading(T0 + timedelta(minutes=121), 999, 35.0, temp_c=41.0)))
+    fired = await _assert_same(engines, readings)
+    assert "HIGH_TEMP" in _types(fired)
+
+
+async def test_stream_seeds_from_existing_history(engines):
+    history = _trace(
+        T0, 70, lambda m: 36.0 if m < 50 else 36.0 - 0.1 * (m - 50), lambda m: (1, 25, 0)
+    )
+    for db, _ in engines:
+        for hive_id, r in history:
+            await _store(db, hive_id, r)
+    # An engine started after the history was stored sees it on its first reading
+    readings = _trace(
+        T0 + timedelta(minutes=70), 5, lambda m: 33.5, lambda m: (1, 25, 0)
+    )
+    fired = await _assert_same(engines, readings)
+    assert "POSSIBLE_SWARM" in _types(fired)
@@ -2,9 +2,11 @@
 
 import pytest
 from httpx import ASGITransport, AsyncClient
+from sqlalchemy.ext.asyncio import AsyncSession
 
 from waggle.database import create_engine_from_url, init_db
 from waggle.main import create_app
+from waggle.models import BeeCount, SensorReading
 
 
 @pytest.fixture
@@ -34,3 +36,74 @@ async def client(app):
 @pytest.fixture
 def auth_headers():
     return {"X-API-Key": "test-key"}
+
+
+@pytest.fixture
+def insert_readings(app):
+    """Insert readings (and their bee_counts rows) straight into the database.
+
+    Each row is a dict with hive_id, observed_at and sequence, optionally
+    weight_kg and temp_c, and a "traffic" dict (bees_in, bees_out, optional
+    stuck_mask) for a reading that carries a bee_counts row.  Rows get ids
+    in list order.
+    """
+
+    async def insert(rows: list[dict]) -> None:
+        async with AsyncSession(app.state.engine) as session:
+            for row in rows:
+                reading = SensorReading(
+                    hive_id=row["hive_id"],
+                    observed_at=row["observed_at"],
+                    ingested_at=row["observed_at"],
+                    weight_kg=row.get("weight_kg", 30.0),
+                    temp_c=row.get("temp_c", 35.0),
+                    humidity_pct=55.5,
+                    pressure_hpa=1013.2,
+                    battery_v=3.7,
+                    sequence=row["sequence"],
+                    flags=0,
+                    sender_mac="AA:BB:CC:DD:EE:FF",
+                )
+                session.add(reading)
+                traffic = row.get("traffic")
+                if traffic is None:
+                    continue
+                await session.flush()
+                session.add(
+                    BeeCount(
+                        reading_id=reading.id,
+                        hive_id=row["hive_id"],
+                        observed_at=row["observed_at"],
+                        ingested_at=row["observed_at"],
+                        period_ms=60000,
+                        bees_in=traffic["bees_in"],
+                        bees_out=traffic["bees_out"],
+                        lane_mask=15,
+                        stuck_mask=traffic.get("stuck_mask", 0),
+                        sequence=row["sequence"],
+                        flags=0,
+                        sender_mac="AA:BB:CC:DD:EE:FF",
+                    )
+                )
+            await session.commit()
+
+    return insert
+
+
+@pytest.fixture
+def with_and_without(client, app, auth_headers):
+    """GET a URL with app.state.<attr> set to a read backend, then without it.
+
+    Returns both JSON bodies, for checking that an alternative read path
+    (time-series store, latest-state table) answers as the SQL queries do.
+    """
+
+    async def get_both(attr: str, backend, url: str, params=None, status: int = 200):
+        setattr(app.state, attr, backend)
+        with_backend = await client.get(url, params=params, headers=auth_headers)
+        setattr(app.state, attr, None)
+        without = await client.get(url, params=params, headers=auth_headers)
+        assert with_backend.status_code == without.status_code == status
+        return with_backend.json(), without.json()
+
+    return get_both
@@ -0,0 +1,80 @@
+"""Hive and hub-status endpoints answer the same from the latest-state table as from SQLite."""
+
+import pytest
+
+from waggle.services.latest_state import LatestState, open_latest_state, seed_table
+
+_latest = pytest.importorskip("waggle._latest")
+
+
+def _ts(minute: int) -> str:
+    return f"2026-02-01T{minute // 60:02d}:{minute % 60:02d}:00.000Z"
+
+
+def _rows() -> list[dict]:
+    rows = []
+    for hive_id, count in ((1, 30), (2, 5)):
+        for i in range(count):
+            rows.append(
+                {
+                    "hive_id": hive_id,
+                    "observed_at": _ts(i),
+                    "sequence": i,
+                    "weight_kg": None if i % 7 == 0 else 30.0 + i / 10,
+                    "traffic": (
+                        {"bees_in": i, "bees_out": i * 2, "stuck_mask": i % 3}
+                        if hive_id == 1 and i % 4 == 0
+                        else None
+                    ),
+                }
+            )
+    return rows
+
+
+@pytest.fixture
+def table_path(tmp_path):
+    return str(tmp_path / "latest")
+
+
+@pytest.fixture
+async def seeded(client, app, auth_headers, insert_readings, table_path):
+    for hive_id, name in ((1, "Alpha"), (2, "Bravo"), (3, "Charlie")):
+        resp = await client.post(
+            "/api/hives", json={"id": hive_id, "name": name}, headers=auth_headers
+        )
+        assert resp.status_code == 201
+    await insert_readings(_rows())
+    writer = open_latest_state(table_path, writable=True)
+    assert await seed_table(app.state.engine, writer)
+    return LatestState(table_path)
+
+
+@pytest.mark.parametrize(
+    ("url", "status"),
+    [
+        ("/api/hives", 200),
+        ("/api/hives/1", 200),
+        ("/api/hives/2", 200),
+        ("/api/hives/3", 200),
+        ("/api/hives/9", 404),
+    ],
+)
+async def test_hives_match_sqlite(seeded, with_and_without, url, status):
+    with_table, without = await with_and_without("latest_state", seeded, url, status=status)
+    assert with_table == without
+
+
+async def test_hub_status_matches_sqlite(seeded, with_and_without):
+    with_table, without = await with_and_without("latest_state", seeded, "/api/hub/status")
+    for body in (with_table, without):
+        body.pop("uptime_sec")
+        body.pop("disk_free_mb")
+    assert with_table == without
+    assert with_table["stuck_lanes_total"] == bin(28 % 3).count("1")
+
+
+async def test_unseeded_table_falls_back_to_sqlite(seeded, with_and_without, table_path):
+    _latest.Table(table_path, writable=True).reset()
+    with_table, without = await with_and_without("latest_state", seeded, "/api/hives/1")
+    assert with_table == without
+    assert with_table["latest_reading"]["observed_at"] == _ts(29)
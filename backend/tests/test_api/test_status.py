@@ -348,3 +348,31 @@ async def test_status_sync_pending_rows(client, auth_headers):
     body = resp.json()
     # The hive we just created has row_synced=0 by default
     assert body["sync_pending_rows"] >= 1
+
+
+async def test_latency_endpoint(client):
+    """Latency summary lists every hop and the recent traces, newest first."""
+    from waggle.services.latency import HOPS, latency_tracker
+
+    latency_tracker.reset()
+    latency_tracker.record(2, 40, {"node": 25, "db": 2}, attempt=1)
+    latency_tracker.record(2, 41, {"node": 30, "radio": 1002, "db": 3}, attempt=2)
+
+    resp = await client.get("/api/hub/latency")
+    assert resp.status_code == 200
+    body = resp.json()
+    assert set(body["hops"]) == set(HOPS)
+    assert body["hops"]["node"]["count"] == 2
+    assert body["hops"]["radio"]["p50_ms"] == 2500
+    assert [t["sequence"] for t in body["recent"]] == [41, 40]
+
+    resp = await client.get("/api/hub/latency", params={"recent": 1})
+    assert len(resp.json()["recent"]) == 1
+
+    resp = await client.get("/api/hub/latency/trace/2/41")
+    assert resp.status_code == 200
+    assert resp.json()["hops_ms"]["total"] == 1035
+
+    resp = await client.get("/api/hub/latency/trace/2/99")
+    assert resp.status_code == 404
+    latency_tracker.reset()
@@ -0,0 +1,100 @@
+"""Readings/traffic endpoints answer the same from the time-series store as from SQLite."""
+
+from datetime import UTC, datetime
+
+import pytest
+from sqlalchemy.ext.asyncio import AsyncSession
+
+from waggle.services.tsstore import (
+    BLOCK_ROWS,
+    export_all,
+    iso_to_ms,
+    open_store,
+    query_readings,
+)
+
+pytest.importorskip("waggle._tsstore")
+
+T0 = iso_to_ms("2026-02-01T00:00:00.000Z")
+
+
+def _iso(ms: int) -> str:
+    return datetime.fromtimestamp(ms / 1000, UTC).strftime("%Y-%m-%dT%H:%M:%S.%f")[:-3] + "Z"
+
+
+def _rows(count: int, first: int = 0, t_offset_min: int = 0) -> list[dict]:
+    rows = []
+    for i in range(first, first + count):
+        seq = i % 65536
+        rows.append(
+            {
+                "hive_id": 1,
+                "observed_at": _iso(T0 + (i + t_offset_min) * 60_000),
+                "sequence": seq,
+                "weight_kg": None if i % 11 == 0 else (30000 + i) / 1000.0,
+                "temp_c": 35.123456 if i == 7 else (3500 + i % 9) / 100.0,
+                "traffic": {"bees_in": seq % 97, "bees_out": seq % 89} if i % 3 == 0 else None,
+            }
+        )
+    return rows
+
+
+@pytest.fixture
+async def exported(client, app, auth_headers, insert_readings, tmp_path):
+    resp = await client.post("/api/hives", json={"id": 1, "name": "Alpha"}, headers=auth_headers)
+    assert resp.status_code == 201
+    await insert_readings(_rows(2 * BLOCK_ROWS + 100))
+    store = open_store(str(tmp_path / "tsstore"))
+    assert await export_all(app.state.engine, store) == 2 * BLOCK_ROWS
+    return store
+
+
+READING_PARAMS = [
+    {},
+    {"limit": 1000},
+    {"offset": 90, "limit": 20},
+    {"offset": 700, "limit": 50},
+    {"offset": 2 * BLOCK_ROWS + 95},
+    {"start": "2026-02-01T05", "end": "2026-02-01T12:30"},
+    {"start": "2026-02-01T10:00:00.000Z", "limit": 1000},
+    {"end": "2026-02-01T03:00:00.000Z", "offset": 3},
+    {"start": "2026-02-01T10:00:00Z"},  # Not a prefix: SQLite path
+]
+
+
+@pytest.mark.parametrize("params", READING_PARAMS)
+async def test_raw_readings_match_sqlite(exported, with_and_without, params):
+    with_store, without = await with_and_without(
+        "tsstore", exported, "/api/hives/1/readings", params
+    )
+    assert with_store == without
+
+
+@pytest.mark.parametrize(
+    "params",
+    [
+        {},
+        {"order": "asc", "limit": 1000},
+        {"order": "asc", "offset": 340, "limit": 20},
+        {"order": "desc", "offset": 30, "limit": 20},
+        {"from": "2026-02-01T06", "to": "2026-02-01T09:59:59.999Z", "order": "asc"},
+    ],
+)
+async def test_raw_traffic_matches_sqlite(exported, with_and_without, params):
+    with_store, without = await with_and_without(
+        "tsstore", exported, "/api/hives/1/traffic", params
+    )
+    assert with_store == without
+
+
+async def test_late_fresh_rows_fall_back_to_sqlite(
+    app, exported, insert_readings, with_and_without
+):
+    # Rows above the high-water id but observed before the newest stored row
+    await insert_readings(_rows(5, first=5000, t_offset_min=-5000 + 10))
+    async with AsyncSession(app.state.engine) as session:
+        assert await query_readings(exported, session, 1, None, None, 100, 0) is None
+
+    with_store, without = await with_and_without("tsstore", exported, "/api/hives/1/readings", {})
+    assert with_store == without
+    assert with_store["total"] == 2 * BLOCK_ROWS + 105
@@ -20,6 +20,7 @@ API_KEY = "test-api-key"
 SIGNING_SECRET = "test-signing-secret"
 DEVICE_KEY = "a" * 32
 JPEG_DATA = b"\xff\xd8\xff\xe0" + b"\x00" * 100
+THUMB_DATA = b"\xff\xd8\xff\xe0" + b"\x01" * 20
 
 
 @pytest.fixture
@@ -70,6 +71,7 @@ async def app_with_photo(tmp_path):
         full_dir = photo_dir / "1" / "2026-02-08"
         full_dir.mkdir(parents=True)
         (full_dir / "cam-1_100_1_test.jpg").write_bytes(JPEG_DATA)
+        (full_dir / "cam-1_100_1_test_thumb.jpg").write_bytes(THUMB_DATA)
 
         photo = Photo(
             hive_id=1,
@@ -80,10 +82,26 @@ async def app_with_photo(tmp_path):
             ingested_at=now,
             sequence=1,
             photo_path=relative_path,
+            thumbnail_path="1/2026-02-08/cam-1_100_1_test_thumb.jpg",
             file_size_bytes=len(JPEG_DATA),
             sha256=hashlib.sha256(JPEG_DATA).hexdigest(),
         )
         session.add(photo)
+        # Second photo uploaded without a thumbnail
+        session.add(
+            Photo(
+                hive_id=1,
+                device_id="cam-1",
+                boot_id=100,
+                captured_at="2026-02-08T12:15:00.000Z",
+                captured_at_source="device_ntp",
+                ingested_at=now,
+                sequence=2,
+                photo_path=relative_path,
+                file_size_bytes=len(JPEG_DATA),
+                sha256=hashlib.sha256(JPEG_DATA).hexdigest(),
+            )
+        )
         await session.commit()
 
     yield application
@@ -149,3 +167,27 @@ async def test_serve_photo_sentinel_missing(client, app_with_photo):
     os.unlink(sentinel)
     resp = await client.get("/api/photos/1/image", headers={"X-API-Key": API_KEY})
     assert resp.status_code == 503
+
+
+async def test_serve_thumbnail_with_api_key(client):
+    resp = await client.get("/api/photos/1/thumbnail", headers={"X-API-Key": API_KEY})
+    assert resp.status_code == 200
+    assert resp.headers["content-type"] == "image/jpeg"
+    assert resp.content == THUMB_DATA
+
+
+async def test_serve_thumbnail_with_signed_token(client):
+    expires = int(time.time()) + 600
+    token = _sign_token(1, expires)
+    resp = await client.get(f"/api/photos/1/thumbnail?token={token}&expires={expires}")
+    assert resp.status_code == 200
+
+
+async def test_serve_thumbnail_no_auth(client):
+    resp = await client.get("/api/photos/1/thumbnail")
+    assert resp.status_code == 401
+
+
+async def test_serve_thumbnail_missing(client):
+    resp = await client.get("/api/photos/2/thumbnail", headers={"X-API-Key": API_KEY})
+    assert resp.status_code == 404
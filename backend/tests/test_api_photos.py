@@ -133,6 +133,8 @@ async def test_list_photos_returns_photos(client, app_with_photos):
     assert item["hive_id"] == 1
     assert item["device_id"] == DEVICE_ID
     assert item["ml_status"] == "pending"
+    assert item["trigger_reason"] == "scheduled"
+    assert item["local_thumbnail_url"] is None
 
     # Signed URL checks
     assert "local_image_url" in item
@@ -1,6 +1,7 @@
 """Tests for bridge service (serial frame processing)."""
 
 import struct
+import time
 
 import pytest
 
@@ -66,8 +67,13 @@ def _build_phase2_frame(
     period_ms=60000,
     lane_mask=15,
     stuck_mask=0,
+    trace=None,
 ) -> bytes:
-    """Build a valid COBS-encoded Phase 2 frame (6 MAC + 48 payload = 54 bytes)."""
+    """Build a valid COBS-encoded Phase 2 frame (6 MAC + 48 payload = 54 bytes).
+
+    trace: (attempt, capture_age_ms, retry_ms, bridge_rx_ms, bridge_hold_us)
+    for a traced payload, written to payload bytes 28-39.
+    """
     # Bytes 0-16: common data fields (17 bytes)
     data = struct.pack(
         "<BBHihHHHB",
@@ -83,6 +89,8 @@ def _build_phase2_frame(
     # Build 48-byte payload: 17 data + 1 CRC + 10 traffic + 20 reserved
     payload = data + bytes([crc_val]) + traffic + b"\x00" * (48 - 18 - len(traffic))
     assert len(payload) == 48
+    if trace is not None:
+        payload = payload[:28] + struct.pack("<BBHHIH", 1, *trace) + payload[40:]
 
     # Concatenate MAC (6 bytes) + payload (48 bytes) = 54 bytes
     frame_data = mac + payload
@@ -92,6 +100,27 @@ def _build_phase2_frame(
     return cobs_encode(frame_data)
 
 
+# ---------------------------------------------------------------------------
+# Thermal array (50-byte frame) helper
+# ---------------------------------------------------------------------------
+
+
+def _build_thermal_frame(
+    mac=b"\xAA\xBB\xCC\xDD\xEE\xFF",
+    hive_id=1,
+    sequence=42,
+    base_x16=560,
+    q=(0, 8, 0xFF),
+    thermal_flags=0,
+) -> bytes:
+    """Build a valid COBS-encoded thermal frame (6 MAC + 44 payload = 50 bytes)."""
+    data = struct.pack("<BBHBBh", hive_id, 0x04, sequence, len(q), thermal_flags, base_x16)
+    data += bytes(q) + b"\xFF" * (32 - len(q)) + bytes(3)
+    payload = data + bytes([crc8(data)])
+    assert len(payload) == 44
+    return cobs_encode(mac + payload)
+
+
 @pytest.fixture
 def processor():
     return BridgeProcessor()
@@ -169,6 +198,14 @@ def test_wrong_frame_length_45(processor):
     assert result is None
 
 
+def test_thermal_frame_skipped_without_warning(processor, caplog):
+    """Thermal array frames are valid but carry no reading."""
+    with caplog.at_level("WARNING"):
+        assert processor.process_frame(_build_thermal_frame()) is None
+        assert processor.process_buffer(_build_thermal_frame() + b"\x00") == []
+    assert caplog.records == []
+
+
 def test_bad_crc(processor):
     """Corrupted CRC should return None."""
     # Build valid frame, then corrupt the CRC byte
@@ -306,3 +343,50 @@ def test_phase2_observed_at_format(processor):
     assert result is not None
     _, msg = result
     assert re.match(r"^\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}\.\d{3}Z$", msg["observed_at"])
+
+
+# ---------------------------------------------------------------------------
+# Latency trace
+# ---------------------------------------------------------------------------
+
+
+def test_phase2_trace_in_message(processor):
+    """A traced payload gets a trace dict with the node and bridge hops."""
+    before = time.time()
+    result = processor.process_frame(_build_phase2_frame(trace=(2, 31, 1002, 5000, 250)))
+    assert result is not None
+    _, msg = result
+    trace = msg["trace"]
+    assert trace["attempt"] == 2
+    assert trace["node_ms"] == 31
+    assert trace["radio_ms"] == 1002
+    assert trace["bridge_ms"] == pytest.approx(0.25)
+    assert trace["serial_ms"] == 0  # First frame sets the clock offset
+    assert before <= trace["hub_rx"] <= time.time()
+
+
+def test_untraced_frames_have_no_trace(processor):
+    _, p1 = processor.process_frame(_build_frame())
+    _, p2 = processor.process_frame(_build_phase2_frame())
+    assert "trace" not in p1
+    assert "trace" not in p2
+
+
+def test_serial_hop_is_excess_over_fastest_transfer(processor, monkeypatch):
+    """The serial hop is measured against the fastest recent bridge->hub transfer."""
+    clock = [100.0]
+    monkeypatch.setattr(time, "monotonic", lambda: clock[0])
+
+    def serial_ms(bridge_rx_ms: int) -> float:
+        frame = _build_phase2_frame(trace=(1, 20, 0, bridge_rx_ms, 0))
+        return processor.process_buffer(frame + b"\x00")[0][1]["trace"]["serial_ms"]
+
+    assert serial_ms(1000) == 0
+    clock[0] += 1.0  # Hub read 1000 ms later, bridge wrote 990 ms later
+    assert serial_ms(1990) == pytest.approx(10)
+    clock[0] += 1.0  # A faster transfer lowers the baseline
+    assert serial_ms(3005) == 0
+    clock[0] += 1.0
+    assert serial_ms(3990) == pytest.approx(15)
+    clock[0] += 1.0  # Bridge restarted: its clock went backwards
+    assert serial_ms(50) == 0
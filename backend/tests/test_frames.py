@@ -0,0 +1,137 @@
+"""Tests for buffer decoding of the serial stream (native and pure-Python paths)."""
+
+import random
+
+import pytest
+
+from tests.test_bridge import _build_frame, _build_phase2_frame, _build_thermal_frame
+from waggle.services.bridge import BridgeProcessor
+from waggle.utils.frames import NATIVE_AVAILABLE, decode_frames_native, decode_frames_py
+
+DECODERS = [pytest.param(decode_frames_py, id="python")]
+DECODERS.append(
+    pytest.param(
+        decode_frames_native,
+        id="native",
+        marks=pytest.mark.skipif(not NATIVE_AVAILABLE, reason="waggle._frames not built"),
+    )
+)
+
+
+def _stream(*frames: bytes) -> bytes:
+    return b"".join(f + b"\x00" for f in frames)
+
+
+def _mixed_stream(count: int, seed: int = 1) -> bytes:
+    """Valid frames of both phases interleaved with the usual line faults."""
+    rng = random.Random(seed)
+    parts = []
+    for i in range(count):
+        kind = rng.randrange(10)
+        if kind < 4:
+            parts.append(_build_frame(hive_id=1 + i % 250, sequence=i, weight_g=-i * 7))
+        elif kind == 4 and i % 3 == 0:
+            parts.append(_build_thermal_frame(hive_id=1 + i % 250, sequence=i))
+        elif kind < 8:
+            trace = (1 + i % 3, i % 90, 0, i * 1000, i % 400) if i % 2 else None
+            parts.append(
+                _build_phase2_frame(hive_id=1 + i % 250, sequence=i, bees_in=i, trace=trace)
+            )
+        elif kind == 8:
+            bad = bytearray(_build_phase2_frame(sequence=i))
+            bad[10] ^= 0x40  # CRC failure (or COBS damage)
+            parts.append(bytes(bad))
+        else:
+            parts.append(bytes(rng.randrange(1, 256) for _ in range(rng.randrange(1, 80))))
+    return _stream(*parts)
+
+
+@pytest.mark.parametrize("decode", DECODERS)
+def test_decodes_both_phases(decode):
+    buf = _stream(_build_frame(sequence=7), _build_phase2_frame(sequence=8, bees_out=99))
+    result = decode(buf)
+    assert result.consumed == len(buf)
+    assert result.invalid == 0
+    assert [f["sequence"] for f in result.frames] == [7, 8]
+    assert "bees_in" not in result.frames[0]
+    assert result.frames[1]["bees_out"] == 99
+    assert result.frames[1]["sender_mac"] == "AA:BB:CC:DD:EE:FF"
+
+
+@pytest.mark.parametrize("decode", DECODERS)
+def test_decodes_latency_trace(decode):
+    buf = _stream(
+        _build_phase2_frame(sequence=1),
+        _build_phase2_frame(sequence=2, trace=(3, 40, 2004, 0x89ABCDEF, 1500)),
+    )
+    frames = decode(buf).frames
+    assert "trace_attempt" not in frames[0]
+    assert frames[1]["trace_attempt"] == 3
+    assert frames[1]["trace_capture_age_ms"] == 40
+    assert frames[1]["trace_retry_ms"] == 2004
+    assert frames[1]["trace_bridge_rx_ms"] == 0x89ABCDEF
+    assert frames[1]["trace_bridge_hold_us"] == 1500
+
+
+@pytest.mark.parametrize("decode", DECODERS)
+def test_partial_frame_not_consumed(decode):
+    whole = _stream(_build_frame(sequence=1))
+    tail = _build_phase2_frame(sequence=2)[:20]
+    result = decode(whole + tail)
+    assert result.consumed == len(whole)
+    assert len(result.frames) == 1
+
+    assert decode(tail).consumed == 0
+
+
+@pytest.mark.parametrize("decode", DECODERS)
+def test_counts_invalid_and_skips_empty(decode):
+    short = b"\x05\x01\x02\x03\x04"  # Valid COBS, 4-byte frame
+    buf = b"\x00\x00" + _stream(short, b"\x09\x01", b"\x01", _build_frame()) + b"\x00"
+    result = decode(buf)
+    assert len(result.frames) == 1
+    assert result.invalid == 3
+    assert result.bad_length == 2
+
+
+@pytest.mark.parametrize("decode", DECODERS)
+def test_thermal_frames_skipped_not_invalid(decode):
+    bad = bytearray(_build_thermal_frame(sequence=3))
+    bad[12] ^= 0x01  # CRC failure
+    buf = _stream(_build_frame(sequence=1), _build_thermal_frame(sequence=1), bytes(bad))
+    result = decode(buf)
+    assert [f["sequence"] for f in result.frames] == [1]
+    assert result.skipped == 1
+    assert result.invalid == 1
+    assert result.bad_length == 0
+
+
+@pytest.mark.skipif(not NATIVE_AVAILABLE, reason="waggle._frames not built")
+def test_native_matches_python_on_noisy_stream():
+    buf = _mixed_stream(2000)
+    assert decode_frames_native(buf) == decode_frames_py(buf)
+
+
+def test_process_buffer_matches_process_frame():
+    frames = [_build_frame(sequence=s) for s in range(3)] + [_build_phase2_frame(sequence=9)]
+    buf = _stream(*frames)
+
+    per_frame = [BridgeProcessor().process_frame(f) for f in frames]
+    processor = BridgeProcessor()
+    # Split mid-frame: the tail of the first read completes in the second
+    batched = processor.process_buffer(buf[:100]) + processor.process_buffer(buf[100:])
+
+    assert len(batched) == len(per_frame)
+    for (topic_a, msg_a), (topic_b, msg_b) in zip(per_frame, batched, strict=True):
+        assert topic_a == topic_b
+        msg_a.pop("observed_at")
+        msg_b.pop("observed_at")
+        assert msg_a == msg_b
+
+
+def test_process_buffer_drops_runaway_partial():
+    processor = BridgeProcessor()
+    assert processor.process_buffer(b"\x01" * 300) == []
+    # The noise is discarded, so the next frame decodes cleanly
+    result = processor.process_buffer(_stream(_build_frame()))
+    assert len(result) == 1
@@ -1,6 +1,6 @@
 """Tests for worker ingestion service."""
 
-
+import time
 from datetime import UTC, datetime, timedelta
 
 import pytest
@@ -12,6 +12,7 @@ from waggle.database import create_engine_from_url, init_db
 from waggle.models import Hive, SensorReading
 from waggle.services.alert_engine import AlertEngine
 from waggle.services.ingestion import IngestionService
+from waggle.services.latency import latency_tracker
 from waggle.utils.timestamps import utc_now
 
 
@@ -203,3 +204,34 @@ async def test_last_seen_at_updated(service, hive, engine):
     async with AsyncSession(engine) as session:
         h = (await session.execute(select(Hive).where(Hive.id == 1))).scalar_one()
     assert h.last_seen_at is not None
+
+
+# Latency trace
+async def test_stored_reading_records_hops(service, hive):
+    latency_tracker.reset()
+    trace = {
+        "attempt": 2, "node_ms": 30, "radio_ms": 1002, "bridge_ms": 0.25,
+        "serial_ms": 1.5, "hub_rx": time.time() - 0.05,
+    }
+    assert await service.process_message(
+        "waggle/1/sensors", _make_payload(sequence=7, trace=trace)
+    )
+    kept = latency_tracker.trace(1, 7)
+    assert kept["attempt"] == 2
+    hops = kept["hops_ms"]
+    assert hops["node"] == 30 and hops["radio"] == 1002 and hops["serial"] == 1.5
+    assert 50 <= hops["mqtt"] < 5000
+    assert hops["db"] > 0
+    assert hops["total"] == pytest.approx(sum(v for k, v in hops.items() if k != "total"))
+
+
+async def test_untraced_and_dropped_readings(service, hive):
+    latency_tracker.reset()
+    await service.process_message("waggle/1/sensors", _make_payload(sequence=8))
+    await service.process_message("waggle/1/sensors", _make_payload(sequence=8))  # Dedup
+    await service.process_message(
+        "waggle/1/sensors", _make_payload(sequence=9, trace={"attempt": "x"})
+    )
+    assert set(latency_tracker.trace(1, 8)["hops_ms"]) == {"db", "total"}
+    assert set(latency_tracker.trace(1, 9)["hops_ms"]) == {"db", "total"}
+    assert latency_tracker.summary()["hops"]["db"]["count"] == 2
@@ -0,0 +1,85 @@
+"""Tests for the per-hop reading latency tracker."""
+
+import pytest
+
+from waggle.services.latency import (
+    BUCKET_BOUNDS_MS,
+    HOPS,
+    HopHistogram,
+    LatencyTracker,
+    SerialClock,
+)
+
+
+def test_histogram_buckets_and_percentiles():
+    h = HopHistogram()
+    for ms in [0.3] * 50 + [4.0] * 45 + [700.0] * 5:
+        h.add(ms)
+    assert h.count == 100
+    assert h.counts[BUCKET_BOUNDS_MS.index(0.5)] == 50
+    assert h.counts[BUCKET_BOUNDS_MS.index(5)] == 45
+    assert h.counts[BUCKET_BOUNDS_MS.index(1000)] == 5
+    assert h.percentile(50) == 0.5
+    assert h.percentile(95) == 5
+    assert h.percentile(99) == 1000
+    assert h.max_ms == 700.0
+
+
+def test_histogram_open_bucket_reports_max():
+    h = HopHistogram()
+    h.add(90_000.0)
+    assert h.counts[-1] == 1
+    assert h.percentile(50) == 90_000.0
+
+
+def test_empty_histogram_summary():
+    s = HopHistogram().summary()
+    assert s["count"] == 0
+    assert s["p50_ms"] is None
+    assert s["mean_ms"] is None
+    assert len(s["buckets"]) == len(BUCKET_BOUNDS_MS) + 1
+    assert s["buckets"][-1]["le_ms"] is None
+
+
+def test_record_sums_total_and_keeps_trace():
+    t = LatencyTracker()
+    trace = t.record(3, 17, {"node": 20, "radio": 1002, "db": 1.5, "bogus": 9}, attempt=2)
+    assert trace["hops_ms"] == {"node": 20.0, "radio": 1002.0, "db": 1.5, "total": 1023.5}
+    assert trace["attempt"] == 2
+    assert t.trace(3, 17) is trace
+    assert t.trace(3, 18) is None
+
+    summary = t.summary()
+    assert set(summary["hops"]) == set(HOPS)
+    assert summary["hops"]["radio"]["count"] == 1
+    assert summary["hops"]["serial"]["count"] == 0
+    assert summary["hops"]["total"]["max_ms"] == pytest.approx(1023.5)
+
+
+def test_negative_hops_clamped():
+    t = LatencyTracker()
+    trace = t.record(1, 1, {"mqtt": -3.0, "db": 2.0})
+    assert trace["hops_ms"]["mqtt"] == 0.0
+    assert trace["hops_ms"]["total"] == 2.0
+
+
+def test_recent_traces_bounded_newest_first():
+    t = LatencyTracker(recent=4)
+    for seq in range(6):
+        t.record(1, seq, {"db": 1.0})
+    t.record(1, 3, {"db": 2.0})  # Same reading again: moves to the front
+    assert t.trace(1, 0) is None
+    assert t.trace(1, 1) is None
+    recent = t.summary(recent=10)["recent"]
+    assert [r["sequence"] for r in recent] == [3, 5, 4, 2]
+    assert t.summary(recent=2)["recent"][1]["sequence"] == 5
+    assert t.summary(recent=0)["recent"] == []
+    assert t.summary()["hops"]["db"]["count"] == 7
+
+
+def test_serial_clock_window():
+    c = SerialClock(window=2)
+    assert c.hop_ms(1000, 5000) == 0
+    assert c.hop_ms(2000, 6004) == 4
+    assert c.hop_ms(3000, 7008) == 4  # (1000, 5000) left the window
+    assert c.hop_ms(100, 9000) == 0  # Bridge clock went backwards
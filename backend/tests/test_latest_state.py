@@ -0,0 +1,144 @@
+"""Tests for the shared-memory latest-state table (waggle._latest)."""
+
+import multiprocessing
+
+import pytest
+
+from waggle.services.latest_state import LatestState, open_latest_state
+
+_latest = pytest.importorskip("waggle._latest")
+
+T = "2026-02-01T00:00:00.000Z"
+
+
+def _ts(minute: int) -> str:
+    return f"2026-02-01T{minute // 60:02d}:{minute % 60:02d}:00.000Z"
+
+
+def _reading(minute: int, weight_kg: float | None = 30.0, flags: int = 0) -> tuple:
+    return (_ts(minute), weight_kg, 35.0, 55.5, 1013.2, 3.7, flags, minute)
+
+
+def _traffic(minute: int, stuck_mask: int = 0) -> tuple:
+    return (_ts(minute), 10 + minute, 20 + minute, 60000, 15, stuck_mask)
+
+
+@pytest.fixture
+def table_path(tmp_path):
+    return str(tmp_path / "latest")
+
+
+# --- Table ---
+
+
+def test_table_round_trip(table_path):
+    table = _latest.Table(table_path, writable=True)
+    assert table.read(3) == (None, None, None)
+    assert table.update(3, _ts(1), _reading(1, weight_kg=None), _traffic(1))
+
+    reader = _latest.Table(table_path)
+    assert reader.read(3) == (_ts(1), _reading(1, weight_kg=None), _traffic(1))
+    assert reader.read_all() == [(3, _ts(1), _reading(1, weight_kg=None), _traffic(1))]
+
+
+def test_table_keeps_newest_rows(table_path):
+    table = _latest.Table(table_path, writable=True)
+    table.update(1, _ts(10), _reading(10), _traffic(10))
+    # A late reading without traffic: older than what is held, so nothing moves
+    # except ingested_at
+    table.update(1, _ts(20), _reading(5), None)
+    assert table.read(1) == (_ts(20), _reading(10), _traffic(10))
+    # A newer reading whose bee_counts row was not stored keeps the old traffic
+    table.update(1, _ts(21), _reading(11), None)
+    assert table.read(1) == (_ts(21), _reading(11), _traffic(10))
+
+
+def test_table_reset_and_seeded(table_path):
+    table = _latest.Table(table_path, writable=True)
+    table.update(1, _ts(1), _reading(1), None)
+    assert not table.seeded()
+    table.mark_seeded()
+    assert _latest.Table(table_path).seeded()
+    table.reset()
+    assert not table.seeded()
+    assert table.read_all() == []
+
+
+def test_reader_cannot_write_or_open_other_files(table_path, tmp_path):
+    _latest.Table(table_path, writable=True)
+    reader = _latest.Table(table_path)
+    with pytest.raises(PermissionError):
+        reader.update(1, None, _reading(1), None)
+    with pytest.raises(OSError):
+        _latest.Table(str(tmp_path / "missing"))
+    other = tmp_path / "other"
+    other.write_bytes(b"\0" * 64)
+    with pytest.raises(OSError):
+        _latest.Table(str(other))
+
+
+def test_table_rejects_bad_rows(table_path):
+    table = _latest.Table(table_path, writable=True)
+    with pytest.raises(ValueError):
+        table.update(256, None, _reading(1), None)
+    with pytest.raises(ValueError):
+        table.update(1, None, _reading(1)[:-1], None)
+    with pytest.raises(ValueError):
+        table.update(1, None, None, (_ts(1), 70000, 0, 60000, 15, 0))
+
+
+def _write_many(path: str, count: int) -> None:
+    table = _latest.Table(path, writable=True)
+    for i in range(1, count + 1):
+        # Every field derives from i, so a torn read shows mismatched values
+        table.update(7, T, (T, float(i), float(i), None, None, None, i % 256, i % 65536), None)
+
+
+def test_concurrent_reader_sees_whole_updates(table_path):
+    _latest.Table(table_path, writable=True)
+    writer = multiprocessing.get_context("fork").Process(
+        target=_write_many, args=(table_path, 200_000)
+    )
+    writer.start()
+    reader = _latest.Table(table_path)
+    reads = 0
+    while writer.is_alive() or reads == 0:
+        state = reader.read(7)
+        if state is None or state[1] is None:
+            continue
+        _, weight, temp, _, _, _, flags, sequence = state[1]
+        assert weight == temp
+        assert flags == int(weight) % 256
+        assert sequence == int(weight) % 65536
+        reads += 1
+    writer.join()
+    assert writer.exitcode == 0
+    assert reads > 0
+
+
+# --- LatestState ---
+
+
+def test_latest_state_needs_seeded_table(table_path):
+    assert open_latest_state("") is None
+    state = open_latest_state(table_path, writable=True)
+    state.record(
+        1, _ts(2), {"observed_at": _ts(1), "weight_kg": 30.0, "temp_c": None,
+                    "humidity_pct": 55.5, "pressure_hpa": 1013.2, "battery_v": 3.7,
+                    "flags": 0},
+        4, {"bees_in": 10, "bees_out": 25, "period_ms": 60000, "lane_mask": 15,
+            "stuck_mask": 0b101},
+    )
+    reader = LatestState(table_path)
+    assert reader.hives([1]) is None
+    assert reader.hub() is None
+
+    state.table().mark_seeded()
+    latest, traffic = reader.hives([1, 2])[1]
+    assert latest == {"weight_kg": 30.0, "temp_c": None, "humidity_pct": 55.5,
+                      "pressure_hpa": 1013.2, "battery_v": 3.7, "observed_at": _ts(1),
+                      "flags": 0}
+    assert traffic == {"observed_at": _ts(1), "bees_in": 10, "bees_out": 25,
+                       "net_out": 15, "total_traffic": 35}
+    assert reader.hives([2]) == {2: (None, None)}
+    assert reader.hub() == (_ts(2), 2)
@@ -0,0 +1,73 @@
+"""Test migration 004 adds photos.trigger_reason."""
+import os
+import sqlite3
+
+import pytest
+from alembic.command import downgrade, upgrade
+from alembic.config import Config
+
+
+@pytest.fixture
+def alembic_config(tmp_path, monkeypatch):
+    db_path = tmp_path / "test.db"
+    monkeypatch.setenv("DB_PATH", str(db_path))
+    cfg = Config(os.path.join(os.path.dirname(__file__), "..", "alembic.ini"))
+    cfg.set_main_option("sqlalchemy.url", f"sqlite:///{db_path}")
+    return cfg, db_path
+
+
+def _photo_columns(conn):
+    return [row[1] for row in conn.execute("PRAGMA table_info(photos)")]
+
+
+def test_migration_adds_trigger_reason(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "head")
+    conn = sqlite3.connect(str(db_path))
+    assert "trigger_reason" in _photo_columns(conn)
+    conn.close()
+
+
+def test_trigger_reason_backfills_scheduled(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "003")
+    conn = sqlite3.connect(str(db_path))
+    ts = "2026-02-08T12:00:00.000Z"
+    conn.execute("INSERT INTO hives (id, name, created_at) VALUES (1, 'H', ?)", (ts,))
+    conn.execute(
+        "INSERT INTO camera_nodes (device_id, hive_id, api_key_hash, created_at)"
+        " VALUES ('cam-1', 1, 'x', ?)",
+        (ts,),
+    )
+    conn.execute(
+        "INSERT INTO photos (hive_id, device_id, boot_id, captured_at,"
+        " captured_at_source, ingested_at, sequence, photo_path,"
+        " file_size_bytes, sha256)"
+        " VALUES (1, 'cam-1', 1, ?, 'device_ntp', ?, 1, 'p.jpg', 10, 'abc')",
+        (ts, ts),
+    )
+    conn.commit()
+    conn.close()
+
+    upgrade(cfg, "004")
+    conn = sqlite3.connect(str(db_path))
+    assert conn.execute("SELECT trigger_reason FROM photos").fetchone()[0] == "scheduled"
+    conn.close()
+
+
+def test_trigger_reason_check_constraint(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "head")
+    conn = sqlite3.connect(str(db_path))
+    sql = conn.execute("SELECT sql FROM sqlite_master WHERE name='photos'").fetchone()[0]
+    assert "trigger_reason IN ('scheduled','activity','boot')" in sql
+    conn.close()
+
+
+def test_downgrade_drops_trigger_reason(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "004")
+    downgrade(cfg, "003")
+    conn = sqlite3.connect(str(db_path))
+    assert "trigger_reason" not in _photo_columns(conn)
+    conn.close()
@@ -0,0 +1,45 @@
+"""Test migration 005 creates camera_wake_telemetry."""
+import os
+import sqlite3
+
+import pytest
+from alembic.command import downgrade, upgrade
+from alembic.config import Config
+
+
+@pytest.fixture
+def alembic_config(tmp_path, monkeypatch):
+    db_path = tmp_path / "test.db"
+    monkeypatch.setenv("DB_PATH", str(db_path))
+    cfg = Config(os.path.join(os.path.dirname(__file__), "..", "alembic.ini"))
+    cfg.set_main_option("sqlalchemy.url", f"sqlite:///{db_path}")
+    return cfg, db_path
+
+
+def test_migration_creates_wake_telemetry(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "head")
+    conn = sqlite3.connect(str(db_path))
+    sql = conn.execute(
+        "SELECT sql FROM sqlite_master WHERE name='camera_wake_telemetry'"
+    ).fetchone()[0]
+    assert "ON DELETE CASCADE" in sql
+    assert "battery_mv" in sql
+    assert "prev_awake_ms" in sql
+    index = conn.execute(
+        "SELECT name FROM sqlite_master WHERE name='idx_wake_telemetry_device_time'"
+    ).fetchone()
+    assert index is not None
+    conn.close()
+
+
+def test_downgrade_drops_wake_telemetry(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "005")
+    downgrade(cfg, "004")
+    conn = sqlite3.connect(str(db_path))
+    row = conn.execute(
+        "SELECT name FROM sqlite_master WHERE name='camera_wake_telemetry'"
+    ).fetchone()
+    assert row is None
+    conn.close()
@@ -0,0 +1,39 @@
+"""Test migration 006 adds photo thumbnail columns."""
+import os
+import sqlite3
+
+import pytest
+from alembic.command import downgrade, upgrade
+from alembic.config import Config
+
+
+@pytest.fixture
+def alembic_config(tmp_path, monkeypatch):
+    db_path = tmp_path / "test.db"
+    monkeypatch.setenv("DB_PATH", str(db_path))
+    cfg = Config(os.path.join(os.path.dirname(__file__), "..", "alembic.ini"))
+    cfg.set_main_option("sqlalchemy.url", f"sqlite:///{db_path}")
+    return cfg, db_path
+
+
+def _columns(conn, table):
+    return [row[1] for row in conn.execute(f"PRAGMA table_info({table})")]
+
+
+def test_migration_adds_thumbnail_columns(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "head")
+    conn = sqlite3.connect(str(db_path))
+    assert "thumbnail_path" in _columns(conn, "photos")
+    assert "thumbnail_ms" in _columns(conn, "camera_wake_telemetry")
+    conn.close()
+
+
+def test_downgrade_drops_thumbnail_columns(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "006")
+    downgrade(cfg, "005")
+    conn = sqlite3.connect(str(db_path))
+    assert "thumbnail_path" not in _columns(conn, "photos")
+    assert "thumbnail_ms" not in _columns(conn, "camera_wake_telemetry")
+    conn.close()
@@ -0,0 +1,45 @@
+"""Test migration 007 adds the photo_uploads table."""
+import os
+import sqlite3
+
+import pytest
+from alembic.command import downgrade, upgrade
+from alembic.config import Config
+
+
+@pytest.fixture
+def alembic_config(tmp_path, monkeypatch):
+    db_path = tmp_path / "test.db"
+    monkeypatch.setenv("DB_PATH", str(db_path))
+    cfg = Config(os.path.join(os.path.dirname(__file__), "..", "alembic.ini"))
+    cfg.set_main_option("sqlalchemy.url", f"sqlite:///{db_path}")
+    return cfg, db_path
+
+
+def test_migration_creates_photo_uploads(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "head")
+    conn = sqlite3.connect(str(db_path))
+    sql = conn.execute(
+        "SELECT sql FROM sqlite_master WHERE name='photo_uploads'"
+    ).fetchone()[0]
+    assert "UNIQUE(device_id, boot_id, sequence)" in sql
+    assert "received" in sql
+    assert "crc32" in sql
+    index = conn.execute(
+        "SELECT name FROM sqlite_master WHERE name='idx_photo_uploads_updated'"
+    ).fetchone()
+    assert index is not None
+    conn.close()
+
+
+def test_downgrade_drops_photo_uploads(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "007")
+    downgrade(cfg, "006")
+    conn = sqlite3.connect(str(db_path))
+    row = conn.execute(
+        "SELECT name FROM sqlite_master WHERE name='photo_uploads'"
+    ).fetchone()
+    assert row is None
+    conn.close()
@@ -0,0 +1,42 @@
+"""Test migration 008 adds the (hive_id, id) readings index."""
+import os
+import sqlite3
+
+import pytest
+from alembic.command import downgrade, upgrade
+from alembic.config import Config
+
+
+@pytest.fixture
+def alembic_config(tmp_path, monkeypatch):
+    db_path = tmp_path / "test.db"
+    monkeypatch.setenv("DB_PATH", str(db_path))
+    cfg = Config(os.path.join(os.path.dirname(__file__), "..", "alembic.ini"))
+    cfg.set_main_option("sqlalchemy.url", f"sqlite:///{db_path}")
+    return cfg, db_path
+
+
+def test_migration_creates_hive_id_index(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "head")
+    conn = sqlite3.connect(str(db_path))
+    sql = conn.execute(
+        "SELECT sql FROM sqlite_master WHERE name='idx_readings_hive_id'"
+    ).fetchone()[0]
+    assert "sensor_readings(hive_id, id)" in sql
+    conn.close()
+
+
+def test_downgrade_drops_hive_id_index(alembic_config):
+    cfg, db_path = alembic_config
+    upgrade(cfg, "008")
+    downgrade(cfg, "007")
+    conn = sqlite3.connect(str(db_path))
+    row = conn.execute(
+        "SELECT name FROM sqlite_master WHERE name='idx_readings_hive_id'"
+    ).fetchone()
+    assert row is None
+    assert conn.execute(
+        "SELECT name FROM sqlite_master WHERE name='sensor_readings'"
+    ).fetchone() is not None
+    conn.close()
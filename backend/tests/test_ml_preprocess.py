@@ -0,0 +1,177 @@
+"""Tests for native photo pre-processing (waggle._preprocess) and its worker path."""
+
+import io
+import json
+import struct
+
+import pytest
+from sqlalchemy import select
+from sqlalchemy.ext.asyncio import AsyncSession
+
+from waggle.database import create_engine_from_url, init_db
+from waggle.models import CameraNode, Hive, MlDetection, Photo
+from waggle.services import ml_preprocess
+from waggle.services.ml_preprocess import Letterboxed, letterbox_jpeg
+from waggle.services.ml_worker import process_one
+from waggle.utils.timestamps import utc_now
+
+needs_native = pytest.mark.skipif(
+    not ml_preprocess.NATIVE_AVAILABLE, reason="waggle._preprocess not built"
+)
+
+S = 640
+PAD = 114
+
+
+def _jpeg(width: int, height: int, color=(200, 40, 90)) -> bytes:
+    image_mod = pytest.importorskip("PIL.Image")
+    buf = io.BytesIO()
+    image_mod.new("RGB", (width, height), color).save(buf, "JPEG", quality=95)
+    return buf.getvalue()
+
+
+def _u8(lb: Letterboxed, c: int, x: int, y: int) -> int:
+    return lb.data[c * S * S + y * S + x]
+
+
+# --- Letterbox ---
+
+
+@needs_native
+@pytest.mark.parametrize(
+    "size,scale,pad,new",
+    [
+        ((800, 600), 0.8, (0, 80), (640, 480)),  # SVGA: full-size decode, resized
+        ((640, 480), 1.0, (0, 80), (640, 480)),  # VGA: no resize
+        ((1600, 1200), 0.4, (0, 80), (640, 480)),  # UXGA: decoded at 1/2
+        ((300, 400), 1.6, (80, 0), (480, 640)),  # Upscaled, portrait
+        ((300, 200), 640 / 300, (0, 106), (640, 427)),  # Odd padding goes after
+    ],
+)
+def test_letterbox_geometry(size, scale, pad, new):
+    color = (200, 40, 90)
+    lb = letterbox_jpeg(_jpeg(*size, color), dtype="uint8")
+    assert (lb.orig_w, lb.orig_h) == size
+    assert lb.scale == pytest.approx(scale)
+    assert (lb.pad_x, lb.pad_y) == pad
+    assert len(lb.data) == 3 * S * S
+
+    pad_x, pad_y = pad
+    new_w, new_h = new
+    for c in range(3):
+        # Image corners carry the photo, the canvas around it the pad value
+        for x, y in ((pad_x, pad_y), (pad_x + new_w - 1, pad_y + new_h - 1)):
+            assert abs(_u8(lb, c, x, y) - color[c]) <= 3
+        if pad_y:
+            assert _u8(lb, c, S // 2, pad_y - 1) == PAD
+            assert _u8(lb, c, S // 2, pad_y + new_h) == PAD
+        if pad_x:
+            assert _u8(lb, c, pad_x - 1, S // 2) == PAD
+            assert _u8(lb, c, pad_x + new_w, S // 2) == PAD
+
+
+@needs_native
+def test_letterbox_dtypes_agree():
+    jpeg = _jpeg(800, 600)
+    u8 = letterbox_jpeg(jpeg, dtype="uint8").data
+    i8 = letterbox_jpeg(jpeg, dtype="int8").data
+    f32 = letterbox_jpeg(jpeg).data
+    assert len(f32) == 4 * len(u8)
+    floats = struct.unpack(f"<{len(u8)}f", f32)
+    for i in range(0, len(u8), 997):
+        assert struct.unpack("b", i8[i : i + 1])[0] == u8[i] - 128
+        assert floats[i] == pytest.approx(u8[i] / 255, abs=1e-6)
+
+
+@needs_native
+def test_letterbox_rejects_bad_input():
+    with pytest.raises(ValueError):
+        letterbox_jpeg(b"")
+    with pytest.raises(ValueError):
+        letterbox_jpeg(b"\xff\xd8\xff" + b"\x00" * 100)
+    with pytest.raises(ValueError):
+        letterbox_jpeg(_jpeg(64, 64), dtype="float16")
+    with pytest.raises(ValueError):
+        letterbox_jpeg(_jpeg(64, 64), size=0)
+
+
+def test_to_original_maps_and_clips_boxes():
+    lb = Letterboxed(bytearray(), S, "float32", 800, 600, 0.8, 0, 80)
+    assert lb.to_original([80.0, 120.0, 160.0, 200.0]) == [100.0, 50.0, 200.0, 150.0]
+    # Boxes reaching into the padding stop at the photo's edge
+    assert lb.to_original([-4.0, 40.0, 650.0, 600.0]) == [0.0, 0.0, 800.0, 600.0]
+
+
+# --- Worker ---
+
+
+class _Boxes:
+    cls = [0]
+    conf = [0.9]
+    xyxy = [[80.0, 120.0, 160.0, 200.0]]  # Model-input pixels
+
+
+class _Result:
+    boxes = _Boxes()
+
+
+class InputRecordingModel:
+    """Mock YOLO model returning one bee and recording what it was given."""
+
+    names = {0: "bee"}
+    model_hash = "mock-hash-abc123"
+
+    def __init__(self):
+        self.sources = []
+
+    def __call__(self, source, verbose=False):
+        self.sources.append(source)
+        return [_Result()]
+
+
+@needs_native
+async def test_process_one_with_native_preprocess(tmp_path, monkeypatch):
+    engine = create_engine_from_url(f"sqlite+aiosqlite:///{tmp_path / 'test.db'}")
+    await init_db(engine)
+    photo_dir = tmp_path / "photos"
+    (photo_dir / "1").mkdir(parents=True)
+    jpeg = _jpeg(800, 600)
+    (photo_dir / "1" / "cam-01_1_0_test.jpg").write_bytes(jpeg)
+
+    async with AsyncSession(engine) as session:
+        session.add(Hive(id=1, name="Test Hive", created_at=utc_now()))
+        await session.flush()
+        session.add(
+            CameraNode(device_id="cam-01", hive_id=1, api_key_hash="x", created_at=utc_now())
+        )
+        await session.flush()
+        session.add(
+            Photo(
+                hive_id=1,
+                device_id="cam-01",
+                boot_id=1,
+                captured_at=utc_now(),
+                captured_at_source="device_rtc",
+                ingested_at=utc_now(),
+                sequence=0,
+                photo_path="1/cam-01_1_0_test.jpg",
+                file_size_bytes=len(jpeg),
+                sha256="abc123",
+            )
+        )
+        await session.commit()
+
+    # The model gets the Letterboxed input itself, so no torch is needed
+    monkeypatch.setattr(Letterboxed, "tensor", lambda self: self)
+    model = InputRecordingModel()
+    try:
+        assert await process_one(engine, model, str(photo_dir), preprocess=True) is not None
+        (source,) = model.sources
+        assert (source.orig_w, source.orig_h, source.pad_x, source.pad_y) == (800, 600, 0, 80)
+
+        async with AsyncSession(engine) as session:
+            detection = (await session.execute(select(MlDetection))).scalar_one()
+        # Boxes are stored in photo pixels
+        assert json.loads(detection.detections_json)[0]["bbox"] == [100.0, 50.0, 200.0, 150.0]
+    finally:
+        await engine.dispose()
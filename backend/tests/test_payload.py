@@ -60,8 +60,13 @@ def _build_phase2_payload(
     period_ms=60000,
     lane_mask=15,
     stuck_mask=0,
+    trace=None,
 ) -> bytes:
-    """Build a valid 48-byte Phase 2 payload."""
+    """Build a valid 48-byte Phase 2 payload.
+
+    trace: (attempt, capture_age_ms, retry_ms, bridge_rx_ms, bridge_hold_us)
+    for a traced payload, written to bytes 28-39.
+    """
     # Bytes 0-16: data fields (same struct format as Phase 1)
     data = struct.pack(
         "<BBHihHHHB",
@@ -83,6 +88,8 @@ def _build_phase2_payload(
     # Build 48-byte payload: 17 data + 1 CRC + 10 traffic + 20 reserved
     payload = data + bytes([crc_val]) + traffic + b"\x00" * (48 - 18 - len(traffic))
     assert len(payload) == 48
+    if trace is not None:
+        payload = payload[:28] + struct.pack("<BBHHIH", 1, *trace) + payload[40:]
     return payload
 
 
@@ -221,3 +228,66 @@ def test_phase2_bad_crc():
     payload[17] ^= 0xFF
     with pytest.raises(PayloadError, match="CRC"):
         deserialize_payload(bytes(payload))
+
+
+# ---------------------------------------------------------------------------
+# Latency trace (Phase 2 bytes 28-39)
+# ---------------------------------------------------------------------------
+
+
+def test_phase2_trace_fields_parsed():
+    p = deserialize_payload(_build_phase2_payload(trace=(2, 31, 1002, 0xDEADBEEF, 250)))
+    assert p["trace_attempt"] == 2
+    assert p["trace_capture_age_ms"] == 31
+    assert p["trace_retry_ms"] == 1002
+    assert p["trace_bridge_rx_ms"] == 0xDEADBEEF
+    assert p["trace_bridge_hold_us"] == 250
+
+
+def test_phase2_untraced_has_no_trace_keys():
+    p = deserialize_payload(_build_phase2_payload())
+    assert not any(key.startswith("trace_") for key in p)
+
+
+def test_phase2_unknown_trace_version_ignored():
+    raw = bytearray(_build_phase2_payload(trace=(1, 5, 0, 100, 80)))
+    raw[28] = 2  # Newer layout: not understood, fields still valid
+    p = deserialize_payload(bytes(raw))
+    assert "trace_attempt" not in p
+    assert p["bees_in"] == 100
+
+
+# ---------------------------------------------------------------------------
+# Thermal array (44-byte) payloads
+# ---------------------------------------------------------------------------
+
+
+def _build_thermal_payload(hive_id=3, sequence=77, base_x16=560, q=(0, 9, 0xFF), flags=0):
+    data = struct.pack("<BBHBBh", hive_id, 0x04, sequence, len(q), flags, base_x16)
+    data += bytes(q) + b"\xFF" * (32 - len(q)) + bytes(3)
+    return data + bytes([crc8(data)])
+
+
+def test_thermal_payload_parsed():
+    p = deserialize_payload(_build_thermal_payload(flags=0x02))
+    assert p["hive_id"] == 3
+    assert p["msg_type"] == 0x04
+    assert p["sequence"] == 77
+    assert p["thermal_flags"] == 0x02
+    # 560/16 = 35.0 C base, 1/8 C steps, 0xFF = no reading
+    assert p["probes_c"] == [35.0, 36.125, None]
+
+
+def test_thermal_bad_crc():
+    raw = bytearray(_build_thermal_payload())
+    raw[10] ^= 0x01
+    with pytest.raises(PayloadError, match="CRC"):
+        deserialize_payload(bytes(raw))
+
+
+def test_thermal_wrong_msg_type():
+    raw = bytearray(_build_thermal_payload())
+    raw[1] = 0x02
+    raw[43] = crc8(bytes(raw[:43]))
+    with pytest.raises(PayloadError, match="msg_type"):
+        deserialize_payload(bytes(raw))
@@ -50,7 +50,9 @@ def _create_photo_file(photo_dir: str, relative_path: str) -> str:
     return full_path
 
 
-async def _insert_photo_row(engine, photo_path: str, sequence: int = 1) -> int:
+async def _insert_photo_row(
+    engine, photo_path: str, sequence: int = 1, thumbnail_path: str | None = None
+) -> int:
     """Helper: insert a Photo row and return its id."""
     now = utc_now()
     async with AsyncSession(engine) as session:
@@ -62,6 +64,7 @@ async def _insert_photo_row(engine, photo_path: str, sequence: int = 1) -> int:
             captured_at_source="ingested",
             sequence=sequence,
             photo_path=photo_path,
+            thumbnail_path=thumbnail_path,
             file_size_bytes=54,
             sha256="a" * 64,
             width=800,
@@ -162,6 +165,22 @@ async def test_known_files_not_quarantined(setup_photo_env):
     assert os.path.exists(os.path.join(photo_dir, rel_path))
 
 
+async def test_known_thumbnails_not_quarantined(setup_photo_env):
+    """Thumbnails referenced by a photo row are not orphans."""
+    engine, photo_dir = setup_photo_env
+
+    rel_path = "hive_1/known.jpg"
+    thumb_path = "hive_1/known_thumb.jpg"
+    _create_photo_file(photo_dir, rel_path)
+    _create_photo_file(photo_dir, thumb_path)
+    await _insert_photo_row(engine, rel_path, sequence=11, thumbnail_path=thumb_path)
+
+    result = await cleanup_photos(engine, photo_dir)
+
+    assert result["orphan_quarantined"] == 0
+    assert os.path.exists(os.path.join(photo_dir, thumb_path))
+
+
 async def test_full_cleanup_all_passes(setup_photo_env):
     """All three passes run together correctly."""
     engine, photo_dir = setup_photo_env
@@ -53,13 +53,20 @@ async def _create_photo(
     ml_status="completed",
     file_synced=0,
     row_synced=0,
+    thumbnail=False,
 ):
-    """Helper to create a photo record with matching file."""
-    relative_path = f"1/2026-02-08/cam-01_1_{uuid4().hex[:8]}.jpg"
+    """Helper to create a photo record with matching file (and thumbnail)."""
+    stem = f"1/2026-02-08/cam-01_1_{uuid4().hex[:8]}"
+    relative_path = f"{stem}.jpg"
     full_path = os.path.join(photo_dir, relative_path)
     os.makedirs(os.path.dirname(full_path), exist_ok=True)
     with open(full_path, "wb") as f:
         f.write(b"\xff\xd8\xff" + b"\x00" * 100)
+    thumbnail_path = None
+    if thumbnail:
+        thumbnail_path = f"{stem}_thumb.jpg"
+        with open(os.path.join(photo_dir, thumbnail_path), "wb") as f:
+            f.write(b"\xff\xd8\xff" + b"\x00" * 10)
 
     seq = randint(0, 65535)
     async with AsyncSession(engine) as session:
@@ -72,6 +79,7 @@ async def _create_photo(
             ingested_at=ingested_at,
             sequence=seq,
             photo_path=relative_path,
+            thumbnail_path=thumbnail_path,
             file_size_bytes=103,
             sha256=uuid4().hex,
             ml_status=ml_status,
@@ -107,6 +115,21 @@ async def test_prune_old_completed_photos(setup_prune_env):
         assert result.scalar_one_or_none() is None
 
 
+async def test_prune_deletes_thumbnail(setup_prune_env):
+    """Pruning a photo also removes its thumbnail file."""
+    engine, photo_dir = setup_prune_env
+    _, full_path = await _create_photo(
+        engine, photo_dir, ingested_at=_days_ago(31), ml_status="completed", thumbnail=True
+    )
+    thumb_path = full_path[:-4] + "_thumb.jpg"
+    assert os.path.exists(thumb_path)
+
+    count = await prune_photos(engine, photo_dir, retention_days=30)
+
+    assert count == 1
+    assert not os.path.exists(thumb_path)
+
+
 async def test_prune_respects_retention(setup_prune_env):
     """Photo newer than retention period is not pruned."""
     engine, photo_dir = setup_prune_env
@@ -0,0 +1,296 @@
+"""Tests for resumable (chunked) photo uploads."""
+
+import os
+import zlib
+
+import bcrypt
+import pytest
+from httpx import ASGITransport, AsyncClient
+from sqlalchemy.ext.asyncio import AsyncSession
+
+from waggle.database import create_engine_from_url, init_db
+from waggle.main import create_app
+from waggle.models import CameraNode, Hive, Photo, PhotoUpload
+from waggle.routers import photos
+from waggle.utils.timestamps import utc_now
+
+API_KEY = "test-api-key"
+DEVICE_KEY = "a" * 32
+DEVICE_ID = "cam-test-01"
+
+# Minimal valid JPEG header followed by non-repeating filler so chunk
+# boundaries matter
+PHOTO = b"\xff\xd8\xff\xe0" + bytes(range(256)) * 2
+
+
+@pytest.fixture
+async def app_with_camera(tmp_path):
+    """Create app with a hive, camera node, and photo directory."""
+    db_path = tmp_path / "test.db"
+    photo_dir = tmp_path / "photos"
+    photo_dir.mkdir()
+    (photo_dir / ".waggle-sentinel").write_text("waggle photo storage sentinel")
+
+    application = create_app(
+        db_url=f"sqlite+aiosqlite:///{db_path}",
+        api_key=API_KEY,
+    )
+
+    class MockSettings:
+        PHOTO_DIR = str(photo_dir)
+        MAX_PHOTO_SIZE = 204800
+        MAX_QUEUE_DEPTH = 50
+        DISK_USAGE_THRESHOLD = 0.90
+        MAX_UPLOAD_CHUNK = 200
+        UPLOAD_EXPIRY_HOURS = 24
+
+    application.state.settings = MockSettings()
+    application.include_router(photos.create_router(None), prefix="/api")
+
+    engine = create_engine_from_url(f"sqlite+aiosqlite:///{db_path}", is_worker=False)
+    await init_db(engine)
+    application.state.engine = engine
+
+    async with AsyncSession(engine) as session:
+        session.add(Hive(id=1, name="Test Hive", created_at=utc_now()))
+        await session.commit()
+        key_hash = bcrypt.hashpw(DEVICE_KEY.encode(), bcrypt.gensalt(rounds=4)).decode()
+        session.add(
+            CameraNode(
+                device_id=DEVICE_ID,
+                hive_id=1,
+                api_key_hash=key_hash,
+                created_at=utc_now(),
+            )
+        )
+        await session.commit()
+
+    yield application
+    await engine.dispose()
+
+
+@pytest.fixture
+async def client(app_with_camera):
+    transport = ASGITransport(app=app_with_camera)
+    async with AsyncClient(transport=transport, base_url="http://test") as c:
+        yield c
+
+
+HEADERS = {"X-Device-Id": DEVICE_ID, "X-API-Key": DEVICE_KEY}
+
+
+async def _create(client, *, data=PHOTO, crc32=None, sequence=1, boot_id=100,
+                  thumbnail=None, total_size=None):
+    form = {
+        "hive_id": "1",
+        "sequence": str(sequence),
+        "boot_id": str(boot_id),
+        "captured_at": "2026-10-18T12:00:00.000Z",
+        "captured_at_source": "device_ntp",
+        "trigger_reason": "activity",
+        "total_size": str(len(data) if total_size is None else total_size),
+        "crc32": str(zlib.crc32(data) if crc32 is None else crc32),
+    }
+    files = {"thumbnail": ("thumb.jpg", thumbnail, "image/jpeg")} if thumbnail else None
+    return await client.post("/api/photos/uploads", headers=HEADERS, data=form, files=files)
+
+
+async def _put(client, upload_id, offset, chunk, crc=None, headers=None):
+    return await client.put(
+        f"/api/photos/uploads/{upload_id}",
+        headers={
+            **HEADERS,
+            "X-Upload-Offset": str(offset),
+            "X-Chunk-CRC32": f"{zlib.crc32(chunk) if crc is None else crc:08x}",
+            "Content-Type": "application/octet-stream",
+            **(headers or {}),
+        },
+        content=chunk,
+    )
+
+
+async def _send_all(client, upload_id, data=PHOTO, start=0, size=200):
+    resp = None
+    offset = start
+    while offset < len(data):
+        chunk = data[offset:offset + size]
+        resp = await _put(client, upload_id, offset, chunk)
+        assert resp.status_code == 200, resp.text
+        offset = resp.json()["offset"]
+    return resp
+
+
+async def test_create_upload(client):
+    resp = await _create(client)
+    assert resp.status_code == 201
+    body = resp.json()
+    assert body["offset"] == 0
+    assert body["total_size"] == len(PHOTO)
+    assert body["chunk_size"] == 200
+    assert body["complete"] is False
+    assert body["upload_id"]
+
+
+async def test_chunked_upload_stores_photo(client, app_with_camera):
+    upload_id = (await _create(client)).json()["upload_id"]
+    resp = await _send_all(client, upload_id)
+    body = resp.json()
+    assert body["complete"] is True
+    assert body["status"] == "queued"
+
+    photo_dir = app_with_camera.state.settings.PHOTO_DIR
+    async with AsyncSession(app_with_camera.state.engine) as session:
+        photo = await session.get(Photo, body["photo_id"])
+        assert photo.trigger_reason == "activity"
+        assert photo.file_size_bytes == len(PHOTO)
+        assert await session.get(PhotoUpload, upload_id) is None
+    with open(os.path.join(photo_dir, photo.photo_path), "rb") as f:
+        assert f.read() == PHOTO
+    assert os.listdir(os.path.join(photo_dir, photos.UPLOADS_SUBDIR)) == []
+
+
+async def test_recreate_resumes_from_acked_offset(client):
+    upload_id = (await _create(client, sequence=2)).json()["upload_id"]
+    resp = await _put(client, upload_id, 0, PHOTO[:200])
+    assert resp.json()["offset"] == 200
+
+    # Connection lost, device wakes again and re-announces the photo
+    resumed = await _create(client, sequence=2)
+    assert resumed.status_code == 200
+    assert resumed.json()["upload_id"] == upload_id
+    assert resumed.json()["offset"] == 200
+
+    resp = await _send_all(client, upload_id, start=200)
+    assert resp.json()["complete"] is True
+
+
+async def test_offset_mismatch_returns_acked_offset(client):
+    upload_id = (await _create(client, sequence=3)).json()["upload_id"]
+    await _put(client, upload_id, 0, PHOTO[:100])
+    resp = await _put(client, upload_id, 200, PHOTO[200:300])
+    assert resp.status_code == 409
+    assert resp.json()["offset"] == 100
+
+
+async def test_resent_chunk_is_rejected_without_moving_offset(client):
+    upload_id = (await _create(client, sequence=4)).json()["upload_id"]
+    await _put(client, upload_id, 0, PHOTO[:100])
+    # Response to the first PUT was lost; the device resends it
+    resp = await _put(client, upload_id, 0, PHOTO[:100])
+    assert resp.status_code == 409
+    assert resp.json()["offset"] == 100
+
+
+async def test_chunk_crc_mismatch(client):
+    upload_id = (await _create(client, sequence=5)).json()["upload_id"]
+    resp = await _put(client, upload_id, 0, PHOTO[:100], crc=zlib.crc32(b"other"))
+    assert resp.status_code == 422
+    assert resp.json()["error"]["code"] == "CRC_MISMATCH"
+    assert resp.json()["offset"] == 0
+
+
+async def test_whole_photo_crc_mismatch_discards_upload(client, app_with_camera):
+    upload_id = (await _create(client, sequence=6, crc32=1234)).json()["upload_id"]
+    resp = await _put(client, upload_id, 0, PHOTO[:200])
+    resp = await _put(client, upload_id, 200, PHOTO[200:400])
+    resp = await _put(client, upload_id, 400, PHOTO[400:])
+    assert resp.status_code == 422
+    assert resp.json()["error"]["code"] == "UPLOAD_CORRUPT"
+    async with AsyncSession(app_with_camera.state.engine) as session:
+        assert await session.get(PhotoUpload, upload_id) is None
+
+
+async def test_create_after_completion_is_duplicate(client):
+    upload_id = (await _create(client, sequence=7)).json()["upload_id"]
+    photo_id = (await _send_all(client, upload_id)).json()["photo_id"]
+
+    resp = await _create(client, sequence=7)
+    assert resp.status_code == 200
+    body = resp.json()
+    assert body["status"] == "duplicate"
+    assert body["complete"] is True
+    assert body["photo_id"] == photo_id
+
+
+async def test_thumbnail_sent_with_create(client, app_with_camera):
+    thumb = b"\xff\xd8\xff\xe0" + b"\x02" * 20
+    upload_id = (await _create(client, sequence=8, thumbnail=thumb)).json()["upload_id"]
+    photo_id = (await _send_all(client, upload_id)).json()["photo_id"]
+    async with AsyncSession(app_with_camera.state.engine) as session:
+        photo = await session.get(Photo, photo_id)
+    thumb_file = os.path.join(app_with_camera.state.settings.PHOTO_DIR, photo.thumbnail_path)
+    with open(thumb_file, "rb") as f:
+        assert f.read() == thumb
+
+
+async def test_chunk_too_large(client):
+    upload_id = (await _create(client, sequence=9)).json()["upload_id"]
+    resp = await _put(client, upload_id, 0, PHOTO[:201])
+    assert resp.status_code == 413
+
+
+async def test_chunked_transfer_too_large(client, app_with_camera):
+    """Without Content-Length the cap is enforced while the body streams in."""
+    upload_id = (await _create(client, sequence=14)).json()["upload_id"]
+    sent = []
+
+    async def body():
+        for i in range(0, 400, 50):
+            sent.append(i)
+            yield PHOTO[i:i + 50]
+
+    resp = await client.put(
+        f"/api/photos/uploads/{upload_id}",
+        headers={
+            **HEADERS,
+            "X-Upload-Offset": "0",
+            "X-Chunk-CRC32": f"{zlib.crc32(PHOTO[:400]):08x}",
+            "Content-Type": "application/octet-stream",
+        },
+        content=body(),
+    )
+    assert resp.status_code == 413
+    assert len(sent) < 8  # Rejected mid-body, not after reading it all
+    async with AsyncSession(app_with_camera.state.engine) as session:
+        assert (await session.get(PhotoUpload, upload_id)).received == 0
+
+
+async def test_zero_setting_is_not_replaced_by_default(client, app_with_camera):
+    app_with_camera.state.settings.MAX_QUEUE_DEPTH = 0
+    resp = await _create(client, sequence=15)
+    assert resp.status_code == 429
+    assert resp.headers["X-Capture-Pause"] == "900"
+
+
+async def test_total_size_limits(client, app_with_camera):
+    app_with_camera.state.settings.MAX_PHOTO_SIZE = 100
+    resp = await _create(client, sequence=10)
+    assert resp.status_code == 400
+
+
+async def test_chunk_wrong_key(client):
+    upload_id = (await _create(client, sequence=11)).json()["upload_id"]
+    resp = await _put(
+        client, upload_id, 0, PHOTO[:100], headers={"X-API-Key": "wrong-key-" + "x" * 22}
+    )
+    assert resp.status_code == 401
+
+
+async def test_unknown_upload(client):
+    resp = await _put(client, "does-not-exist", 0, PHOTO[:100])
+    assert resp.status_code == 404
+
+
+async def test_stale_uploads_expire(client, app_with_camera):
+    upload_id = (await _create(client, sequence=12)).json()["upload_id"]
+    async with AsyncSession(app_with_camera.state.engine) as session:
+        upload = await session.get(PhotoUpload, upload_id)
+        upload.updated_at = "2020-01-01T00:00:00.000Z"
+        await session.commit()
+
+    # Any create sweeps expired uploads
+    await _create(client, sequence=13)
+    async with AsyncSession(app_with_camera.state.engine) as session:
+        assert await session.get(PhotoUpload, upload_id) is None
+    part_dir = os.path.join(app_with_camera.state.settings.PHOTO_DIR, photos.UPLOADS_SUBDIR)
+    assert f"{upload_id}.part" not in os.listdir(part_dir)
@@ -10,7 +10,7 @@ from sqlalchemy.ext.asyncio import AsyncSession
 
 from waggle.database import create_engine_from_url, init_db
 from waggle.main import create_app
-from waggle.models import CameraNode, Hive, Photo
+from waggle.models import CameraNode, CameraWakeTelemetry, Hive, Photo
 from waggle.routers import photos
 from waggle.utils.timestamps import utc_now
 
@@ -92,21 +92,30 @@ async def _upload(
     data=None,
     captured_at="",
     captured_at_source="",
+    trigger_reason=None,
+    headers=None,
+    thumbnail=None,
 ):
     """Helper to upload a photo."""
     if data is None:
         data = JPEG_HEADER
+    form = {
+        "hive_id": str(hive_id),
+        "sequence": str(sequence),
+        "boot_id": str(boot_id),
+        "captured_at": captured_at,
+        "captured_at_source": captured_at_source,
+    }
+    if trigger_reason is not None:
+        form["trigger_reason"] = trigger_reason
+    files = {"photo": ("test.jpg", data, "image/jpeg")}
+    if thumbnail is not None:
+        files["thumbnail"] = ("thumb.jpg", thumbnail, "image/jpeg")
     return await client.post(
         "/api/photos/upload",
-        headers={"X-Device-Id": device_id, "X-API-Key": device_key},
-        files={"photo": ("test.jpg", data, "image/jpeg")},
-        data={
-            "hive_id": str(hive_id),
-            "sequence": str(sequence),
-            "boot_id": str(boot_id),
-            "captured_at": captured_at,
-            "captured_at_source": captured_at_source,
-        },
+        headers={"X-Device-Id": device_id, "X-API-Key": device_key, **(headers or {})},
+        files=files,
+        data=form,
     )
 
 
@@ -170,6 +179,24 @@ async def test_photo_upload_queue_full(client, app_with_camera):
     # Third should be rejected
     resp = await _upload(client, sequence=3, boot_id=200)
     assert resp.status_code == 429
+    # ... and the camera asked to stop capturing for a while
+    assert resp.headers["X-Capture-Pause"] == "900"
+
+
+async def test_photo_upload_disk_full_requests_pause(client, app_with_camera):
+    app_with_camera.state.settings.DISK_USAGE_THRESHOLD = 0.0
+    app_with_camera.state.settings.CAPTURE_PAUSE_SEC = 3600
+    resp = await _upload(client, sequence=4, boot_id=200)
+    assert resp.status_code == 507
+    assert resp.headers["X-Capture-Pause"] == "3600"
+
+
+async def test_photo_upload_capture_pause_disabled(client, app_with_camera):
+    app_with_camera.state.settings.MAX_QUEUE_DEPTH = 0
+    app_with_camera.state.settings.CAPTURE_PAUSE_SEC = 0
+    resp = await _upload(client, sequence=5, boot_id=200)
+    assert resp.status_code == 429
+    assert "X-Capture-Pause" not in resp.headers
 
 
 async def test_photo_upload_no_auth(client):
@@ -193,3 +220,105 @@ async def test_photo_upload_normalizes_captured_at(client, app_with_camera):
             )
         ).scalar_one()
         assert photo.captured_at_source == "ingested"
+
+
+async def _stored_trigger_reason(app, sequence, boot_id):
+    async with AsyncSession(app.state.engine) as session:
+        photo = (
+            await session.execute(
+                select(Photo).where(Photo.sequence == sequence, Photo.boot_id == boot_id)
+            )
+        ).scalar_one()
+        return photo.trigger_reason
+
+
+async def test_photo_upload_trigger_reason_defaults_to_scheduled(client, app_with_camera):
+    """Firmware that predates activity wakes omits trigger_reason."""
+    resp = await _upload(client, sequence=60, boot_id=400)
+    assert resp.status_code == 200
+    assert await _stored_trigger_reason(app_with_camera, 60, 400) == "scheduled"
+
+
+async def test_photo_upload_trigger_reason_activity(client, app_with_camera):
+    resp = await _upload(client, sequence=61, boot_id=400, trigger_reason="activity")
+    assert resp.status_code == 200
+    assert await _stored_trigger_reason(app_with_camera, 61, 400) == "activity"
+
+
+async def test_photo_upload_trigger_reason_invalid(client):
+    resp = await _upload(client, sequence=62, boot_id=400, trigger_reason="motion")
+    assert resp.status_code == 400
+
+
+async def test_photo_upload_stores_wake_telemetry(client, app_with_camera):
+    header = "v=1,boot=312,cam=410,wifi=1830,pup=640,pawake=3900,vbat=3987,wfail=1,ufail=0"
+    resp = await _upload(
+        client, sequence=70, boot_id=500, headers={"X-Wake-Telemetry": header}
+    )
+    assert resp.status_code == 200
+    photo_id = resp.json()["photo_id"]
+    async with AsyncSession(app_with_camera.state.engine) as session:
+        row = (
+            await session.execute(
+                select(CameraWakeTelemetry).where(CameraWakeTelemetry.photo_id == photo_id)
+            )
+        ).scalar_one()
+        assert row.device_id == DEVICE_ID
+        assert row.boot_ms == 312
+        assert row.camera_init_ms == 410
+        assert row.wifi_ms == 1830
+        assert row.prev_awake_ms == 3900
+        assert row.battery_mv == 3987
+        assert row.wifi_failures == 1
+        assert row.nvs_ms is None
+
+
+async def test_photo_upload_bad_wake_telemetry_ignored(client, app_with_camera):
+    resp = await _upload(
+        client, sequence=71, boot_id=500, headers={"X-Wake-Telemetry": "garbage"}
+    )
+    assert resp.status_code == 200
+    async with AsyncSession(app_with_camera.state.engine) as session:
+        rows = (await session.execute(select(CameraWakeTelemetry))).scalars().all()
+        assert rows == []
+
+
+async def test_photo_upload_with_thumbnail(client, app_with_camera):
+    thumb = b"\xff\xd8\xff\xe0" + b"\x01" * 30
+    resp = await _upload(client, sequence=80, boot_id=600, thumbnail=thumb)
+    assert resp.status_code == 200
+    async with AsyncSession(app_with_camera.state.engine) as session:
+        photo = (
+            await session.execute(
+                select(Photo).where(Photo.sequence == 80, Photo.boot_id == 600)
+            )
+        ).scalar_one()
+    assert photo.thumbnail_path == photo.photo_path[:-4] + "_thumb.jpg"
+    thumb_file = os.path.join(app_with_camera.state.settings.PHOTO_DIR, photo.thumbnail_path)
+    with open(thumb_file, "rb") as f:
+        assert f.read() == thumb
+
+
+async def test_photo_upload_without_thumbnail(client, app_with_camera):
+    resp = await _upload(client, sequence=81, boot_id=600)
+    assert resp.status_code == 200
+    async with AsyncSession(app_with_camera.state.engine) as session:
+        photo = (
+            await session.execute(
+                select(Photo).where(Photo.sequence == 81, Photo.boot_id == 600)
+            )
+        ).scalar_one()
+    assert photo.thumbnail_path is None
+
+
+async def test_photo_upload_invalid_thumbnail(client):
+    resp = await _upload(client, sequence=82, boot_id=600, thumbnail=b"\x89PNG" + b"\x00" * 10)
+    assert resp.status_code == 400
+
+
+async def test_photo_upload_oversized_thumbnail(client, app_with_camera):
+    app_with_camera.state.settings.MAX_THUMBNAIL_SIZE = 50
+    resp = await _upload(
+        client, sequence=83, boot_id=600, thumbnail=b"\xff\xd8\xff" + b"\x00" * 100
+    )
+    assert resp.status_code == 400
@@ -0,0 +1,128 @@
+"""Tests for the compressed time-series store (waggle._tsstore)."""
+
+import os
+
+import pytest
+
+from waggle.services.tsstore import (
+    BLOCK_ROWS,
+    bound_to_ms,
+    iso_to_ms,
+)
+
+_tsstore = pytest.importorskip("waggle._tsstore")
+
+T0 = iso_to_ms("2026-02-01T00:00:00.000Z")
+
+
+def _row(i: int, *, traffic: bool = False, t_ms: int | None = None) -> tuple:
+    values = ((30000 + i) / 1000.0, (3500 + i % 7) / 100.0, None, 10132 / 10.0, 3700 / 1000.0)
+    bc = (10_000 + i, 60000, i % 50, i % 40, 15, 0) if traffic else (None, 0, 0, 0, 0, 0)
+    return (i, T0 + i * 60_000 if t_ms is None else t_ms, *values, i % 65536, 0, *bc)
+
+
+# --- Store ---
+
+
+def test_store_round_trip(tmp_path):
+    store = _tsstore.Store(str(tmp_path))
+    rows = [_row(i, traffic=i % 3 == 0) for i in range(1, 601)]
+    store.append(2, rows)
+
+    info = store.info(2)
+    assert info["blocks"] == 1
+    assert info["rows"] == 600
+    assert info["traffic_rows"] == 200
+    assert info["high_water_id"] == 600
+
+    total, got = store.readings(2, T0, T0 + 10**9, 0, 1000, descending=False)
+    assert total == 600
+    assert got[0] == (1, "2026-02-01T00:01:00.000Z", 30.001, 35.01, None, 1013.2, 3.7, 1, 0)
+    assert [r[0] for r in got] == list(range(1, 601))
+
+    total, traffic = store.traffic(2, T0, T0 + 10**9, 0, 10)
+    assert total == 200
+    assert traffic[0] == (10_003, 3, "2026-02-01T00:03:00.000Z", 60000, 3, 3, 15, 0, 0)
+
+
+def test_store_keeps_inexact_floats(tmp_path):
+    store = _tsstore.Store(str(tmp_path))
+    rows = [list(_row(i)) for i in range(1, 11)]
+    rows[4][3] = 35.123456789  # Not a temp_c_x100 value: column falls back to XOR coding
+    store.append(1, [tuple(r) for r in rows])
+    _, got = store.readings(1, T0, T0 + 10**9, 0, 20, descending=False)
+    assert [r[3] for r in got] == [r[3] for r in rows]
+
+
+def test_store_offsets_and_bounds_across_blocks(tmp_path):
+    store = _tsstore.Store(str(tmp_path))
+    rows = [_row(i, traffic=i % 2 == 0) for i in range(1, 5 * BLOCK_ROWS + 1)]
+    for b in range(5):
+        store.append(1, rows[b * BLOCK_ROWS : (b + 1) * BLOCK_ROWS])
+
+    t_from, t_to = T0 + 700 * 60_000, T0 + 2000 * 60_000
+    expected = [r[0] for r in rows if t_from <= r[1] <= t_to][::-1]
+    for offset in (0, 1, 511, 512, 1000, len(expected) - 1, len(expected) + 5):
+        total, got = store.readings(1, t_from, t_to, offset, 100)
+        assert total == len(expected)
+        assert [r[0] for r in got] == expected[offset : offset + 100]
+
+
+def test_store_late_rows_sorted_by_time(tmp_path):
+    store = _tsstore.Store(str(tmp_path))
+    store.append(1, [_row(i) for i in range(1, 101)])
+    # A backlog of readings observed before the first block's newest ones
+    store.append(1, [_row(i, t_ms=T0 + (i - 100) * 60_000 + 30_000) for i in range(101, 121)])
+
+    total, got = store.readings(1, T0, T0 + 10**9, 0, 1000, descending=False)
+    times = [iso_to_ms(r[1]) for r in got]
+    assert total == 120
+    assert times == sorted(times)
+
+
+def test_store_rejects_rows_at_or_below_high_water(tmp_path):
+    store = _tsstore.Store(str(tmp_path))
+    store.append(1, [_row(i) for i in range(1, 11)])
+    with pytest.raises(OSError, match="high-water"):
+        store.append(1, [_row(10)])
+
+
+def test_store_ignores_torn_tail(tmp_path):
+    store = _tsstore.Store(str(tmp_path))
+    store.append(1, [_row(i) for i in range(1, 11)])
+    path = tmp_path / "hive_1.wts"
+    good_size = path.stat().st_size
+    with open(path, "ab") as f:
+        f.write(b"WTSB" + os.urandom(100))  # Crash mid-append
+
+    reader = _tsstore.Store(str(tmp_path))
+    assert reader.info(1)["rows"] == 10
+    reader.append(1, [_row(i) for i in range(11, 21)])
+    assert _tsstore.Store(str(tmp_path)).info(1)["rows"] == 20
+    assert path.stat().st_size > good_size
+
+
+# --- Bounds ---
+
+
+@pytest.mark.parametrize(
+    "bound, upper, expected",
+    [
+        ("2026-02-01T00:00:00.000Z", False, "2026-02-01T00:00:00.000Z"),
+        ("2026-02-01T00:00:00.000Z", True, "2026-02-01T00:00:00.000Z"),
+        ("2026-02-01", False, "2026-02-01T00:00:00.000Z"),
+        ("2026-02-01", True, "2026-01-31T23:59:59.999Z"),
+        ("2026-02-01T12", True, "2026-02-01T11:59:59.999Z"),
+        ("2026", False, "2026-01-01T00:00:00.000Z"),
+    ],
+)
+def test_bound_to_ms(bound, upper, expected):
+    assert bound_to_ms(bound, upper=upper) == iso_to_ms(expected)
+
+
+@pytest.mark.parametrize(
+    "bound", ["", "2026-1", "2026-02-3", "2026-02-30", "yesterday", "2026-02-01Z"]
+)
+def test_bound_to_ms_rejects_non_prefixes(bound):
+    assert bound_to_ms(bound, upper=False) is None
+
@@ -0,0 +1,71 @@
+"""Tests for X-Wake-Telemetry header parsing."""
+
+from waggle.utils.wake_telemetry import parse_wake_telemetry
+
+FULL = (
+    "v=1,boot=312,nvs=4,cam=410,warm=180,thumb=240,cap=95,wifi=1830,sync=0,"
+    "pup=640,ptd=85,pawake=3900,vbat=3987,wfail=0,ufail=2"
+)
+
+
+def test_parse_full_header():
+    t = parse_wake_telemetry(FULL)
+    assert t == {
+        "boot_ms": 312,
+        "nvs_ms": 4,
+        "camera_init_ms": 410,
+        "warmup_ms": 180,
+        "thumbnail_ms": 240,
+        "capture_ms": 95,
+        "wifi_ms": 1830,
+        "time_sync_ms": 0,
+        "prev_upload_ms": 640,
+        "prev_teardown_ms": 85,
+        "prev_awake_ms": 3900,
+        "battery_mv": 3987,
+        "wifi_failures": 0,
+        "upload_failures": 2,
+    }
+
+
+def test_first_wake_has_no_previous_phases():
+    t = parse_wake_telemetry("v=1,boot=300,nvs=3,vbat=0,wfail=0,ufail=0")
+    assert t is not None
+    assert t["prev_upload_ms"] is None
+    assert t["prev_awake_ms"] is None
+    # vbat=0 means no divider fitted
+    assert t["battery_mv"] is None
+
+
+def test_unknown_keys_ignored():
+    t = parse_wake_telemetry("v=1,boot=300,rssi_x=12")
+    assert t is not None
+    assert t["boot_ms"] == 300
+
+
+def test_whitespace_tolerated():
+    t = parse_wake_telemetry("v=1, boot=300 , cam=10")
+    assert t is not None
+    assert t["camera_init_ms"] == 10
+
+
+def test_missing_header():
+    assert parse_wake_telemetry(None) is None
+    assert parse_wake_telemetry("") is None
+
+
+def test_unsupported_version():
+    assert parse_wake_telemetry("v=2,boot=300") is None
+    assert parse_wake_telemetry("boot=300") is None
+
+
+def test_malformed_values_rejected():
+    assert parse_wake_telemetry("v=1,boot=abc") is None
+    assert parse_wake_telemetry("v=1,boot") is None
+    assert parse_wake_telemetry("v=1,=5") is None
+    assert parse_wake_telemetry("v=1,boot=-5") is None
+    assert parse_wake_telemetry("v=1,boot=99999999999") is None
+
+
+def test_oversized_header_rejected():
+    assert parse_wake_telemetry("v=1," + "boot=1," * 200) is None
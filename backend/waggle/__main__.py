@@ -1,4 +1,4 @@
-"""Entry point: python -m waggle [api|worker|bridge|notify|sync|ml]"""
+"""Entry point: python -m waggle [api|worker|bridge|alerts|tsstore|notify|sync|ml]"""
 
 import asyncio
 import os
@@ -64,6 +64,29 @@ def run_ml():
     )
 
 
+def run_alerts():
+    """Run the alert engine for readings stored by the native ingestd."""
+    settings = Settings()
+
+    from waggle.services.alert_listener import run_alert_listener
+
+    asyncio.run(run_alert_listener(settings.DB_URL, settings.MQTT_HOST, settings.MQTT_PORT))
+
+
+def run_tsstore():
+    """Seal readings into the compressed time-series store."""
+    settings = Settings()
+    if not settings.TSSTORE_DIR:
+        print("Error: TSSTORE_DIR must be set for the time-series store.")
+        sys.exit(1)
+
+    from waggle.services.tsstore import run_exporter
+
+    asyncio.run(
+        run_exporter(settings.DB_URL, settings.TSSTORE_DIR, settings.TSSTORE_EXPORT_SEC)
+    )
+
+
 def run_sync_service():
     settings = Settings()
 
@@ -95,6 +118,10 @@ def main():
     elif command == "bridge":
         print("Bridge not yet wired (serial loop). Use 'api' for now.")
         sys.exit(1)
+    elif command == "alerts":
+        run_alerts()
+    elif command == "tsstore":
+        run_tsstore()
     elif command == "ml":
         run_ml()
     elif command == "notify":
@@ -103,7 +130,7 @@ def main():
         run_sync_service()
     else:
         print(f"Unknown command: {command}")
-        print("Usage: python -m waggle [api|worker|bridge|ml|notify|sync]")
+        print("Usage: python -m waggle [api|worker|bridge|alerts|tsstore|ml|notify|sync]")
         sys.exit(1)
 
 
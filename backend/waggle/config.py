@@ -19,6 +19,13 @@ class Settings(BaseSettings):
     # Database
     DB_PATH: str = "/var/lib/waggle/waggle.db"
 
+    # Time-series store (empty = raw queries stay on SQLite)
+    TSSTORE_DIR: str = ""
+    TSSTORE_EXPORT_SEC: int = 60
+
+    # Shared-memory latest-state table (empty = hub status queries use SQLite)
+    LATEST_STATE_PATH: str = ""
+
     # MQTT
     MQTT_HOST: str = "127.0.0.1"
     MQTT_PORT: int = 1883
@@ -49,6 +56,10 @@ class Settings(BaseSettings):
     MAX_QUEUE_DEPTH: int = 50
     DISK_USAGE_THRESHOLD: float = 0.90
     MAX_PHOTO_SIZE: int = 204800  # 200 KB
+    MAX_THUMBNAIL_SIZE: int = 32768  # 32 KB
+    MAX_UPLOAD_CHUNK: int = 32768  # Resumable upload chunk cap
+    UPLOAD_EXPIRY_HOURS: int = 24  # Unfinished resumable uploads are dropped after this
+    CAPTURE_PAUSE_SEC: int = 900  # X-Capture-Pause on queue/disk rejections; 0 = never
     PHOTO_DIR: str = "/var/lib/waggle/photos"
     PHOTO_RETENTION_DAYS: int = 30
     EXPECTED_MODEL_HASH: str | None = None
@@ -78,6 +78,15 @@ correlation_alerts_fired = Counter(
     "Total correlation alerts fired",
     labelnames=["type"],
 )
+
+# --- Reading latency (waggle/services/latency.py) ---
+reading_hop_latency = Histogram(
+    "waggle_reading_hop_seconds",
+    "Latency of each hop from sensor read to database row, in seconds",
+    labelnames=["hop"],
+    buckets=(0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5,
+             1.0, 2.5, 5.0, 10.0, 30.0, 60.0),
+)
 stuck_lanes_current = Gauge(
     "waggle_stuck_lanes_current",
     "Current number of stuck lanes per hive",
@@ -13,6 +13,8 @@ from waggle.auth import (
     install_auth_error_handler,
 )
 from waggle.database import create_engine_from_url, init_db
+from waggle.services.latest_state import open_latest_state
+from waggle.services.tsstore import open_store
 
 
 def _error_response(status_code: int, code: str, message: str, details: dict | None = None):
@@ -51,6 +53,8 @@ def create_app(
     app.state.engine = engine
     app.state.api_key = api_key
     app.state.settings = settings
+    app.state.tsstore = open_store(getattr(settings, "TSSTORE_DIR", ""))
+    app.state.latest_state = open_latest_state(getattr(settings, "LATEST_STATE_PATH", ""))
     verify_key = create_api_key_dependency(api_key)
     verify_admin = create_admin_key_dependency(admin_api_key)
 
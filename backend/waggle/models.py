@@ -105,6 +105,7 @@ class SensorReading(Base):
         ),
         Index("idx_readings_hive_time", "hive_id", "observed_at"),
         Index("idx_readings_time", "observed_at"),
+        Index("idx_readings_hive_id", "hive_id", "id"),
     )
 
 
@@ -244,10 +245,14 @@ class Photo(Base):
     )
     sequence: Mapped[int] = mapped_column(Integer, nullable=False)
     photo_path: Mapped[str] = mapped_column(Text, nullable=False)
+    thumbnail_path: Mapped[str | None] = mapped_column(Text, nullable=True)
     file_size_bytes: Mapped[int] = mapped_column(Integer, nullable=False)
     sha256: Mapped[str] = mapped_column(Text, nullable=False)
     width: Mapped[int] = mapped_column(Integer, nullable=False, server_default="800")
     height: Mapped[int] = mapped_column(Integer, nullable=False, server_default="600")
+    trigger_reason: Mapped[str] = mapped_column(
+        Text, nullable=False, server_default=text("'scheduled'")
+    )
     ml_status: Mapped[str] = mapped_column(
         Text, nullable=False, server_default=text("'pending'")
     )
@@ -273,6 +278,10 @@ class Photo(Base):
             "captured_at_source IN ('device_ntp', 'device_rtc', 'ingested')",
             name="ck_photo_captured_source",
         ),
+        CheckConstraint(
+            "trigger_reason IN ('scheduled', 'activity', 'boot')",
+            name="ck_photo_trigger_reason",
+        ),
         UniqueConstraint(
             "device_id", "boot_id", "sequence", name="uq_photos_device_boot_seq"
         ),
@@ -292,6 +301,81 @@ class Photo(Base):
     )
 
 
+class CameraWakeTelemetry(Base):
+    __tablename__ = "camera_wake_telemetry"
+
+    id: Mapped[int] = mapped_column(Integer, primary_key=True, autoincrement=True)
+    photo_id: Mapped[int] = mapped_column(
+        Integer, ForeignKey("photos.id", ondelete="CASCADE"), nullable=False
+    )
+    device_id: Mapped[str] = mapped_column(
+        Text, ForeignKey("camera_nodes.device_id"), nullable=False
+    )
+    hive_id: Mapped[int] = mapped_column(
+        Integer, ForeignKey("hives.id", ondelete="RESTRICT"), nullable=False
+    )
+    recorded_at: Mapped[str] = mapped_column(Text, nullable=False)
+    boot_ms: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    nvs_ms: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    camera_init_ms: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    warmup_ms: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    thumbnail_ms: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    capture_ms: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    wifi_ms: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    time_sync_ms: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    prev_upload_ms: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    prev_teardown_ms: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    prev_awake_ms: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    battery_mv: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    wifi_failures: Mapped[int | None] = mapped_column(Integer, nullable=True)
+    upload_failures: Mapped[int | None] = mapped_column(Integer, nullable=True)
+
+    __table_args__ = (
+        UniqueConstraint("photo_id", name="uq_wake_telemetry_photo"),
+        Index("idx_wake_telemetry_device_time", "device_id", desc("recorded_at")),
+    )
+
+
+class PhotoUpload(Base):
+    __tablename__ = "photo_uploads"
+
+    id: Mapped[str] = mapped_column(Text, primary_key=True)
+    device_id: Mapped[str] = mapped_column(
+        Text, ForeignKey("camera_nodes.device_id"), nullable=False
+    )
+    hive_id: Mapped[int] = mapped_column(
+        Integer, ForeignKey("hives.id", ondelete="RESTRICT"), nullable=False
+    )
+    boot_id: Mapped[int] = mapped_column(Integer, nullable=False)
+    sequence: Mapped[int] = mapped_column(Integer, nullable=False)
+    captured_at: Mapped[str] = mapped_column(Text, nullable=False)
+    captured_at_source: Mapped[str] = mapped_column(Text, nullable=False)
+    trigger_reason: Mapped[str] = mapped_column(
+        Text, nullable=False, server_default=text("'scheduled'")
+    )
+    total_size: Mapped[int] = mapped_column(Integer, nullable=False)
+    crc32: Mapped[int] = mapped_column(Integer, nullable=False)
+    received: Mapped[int] = mapped_column(Integer, nullable=False, server_default="0")
+    has_thumbnail: Mapped[int] = mapped_column(Integer, nullable=False, server_default="0")
+    created_at: Mapped[str] = mapped_column(Text, nullable=False)
+    updated_at: Mapped[str] = mapped_column(Text, nullable=False)
+
+    __table_args__ = (
+        CheckConstraint("total_size > 0", name="ck_photo_upload_total_size"),
+        CheckConstraint(
+            "trigger_reason IN ('scheduled', 'activity', 'boot')",
+            name="ck_photo_upload_trigger_reason",
+        ),
+        CheckConstraint(
+            "received >= 0 AND received <= total_size", name="ck_photo_upload_received"
+        ),
+        UniqueConstraint(
+            "device_id", "boot_id", "sequence", name="uq_photo_uploads_device_boot_seq"
+        ),
+        Index("idx_photo_uploads_updated", "updated_at"),
+    )
+
+
 class MlDetection(Base):
     __tablename__ = "ml_detections"
 
@@ -100,6 +100,85 @@ def _latest_traffic_from_row(
     )
 
 
+def _hives_with_latest_stmt():
+    """Hives left-joined with their latest reading and latest traffic."""
+    # Latest reading subquery using row_number window function
+    latest_subq = (
+        select(
+            SensorReading.hive_id,
+            SensorReading.weight_kg,
+            SensorReading.temp_c,
+            SensorReading.humidity_pct,
+            SensorReading.pressure_hpa,
+            SensorReading.battery_v,
+            SensorReading.observed_at,
+            SensorReading.flags,
+            func.row_number()
+            .over(
+                partition_by=SensorReading.hive_id,
+                order_by=desc(SensorReading.observed_at),
+            )
+            .label("rn"),
+        )
+        .subquery()
+    )
+    traffic_subq = _latest_traffic_subquery()
+    return (
+        select(
+            Hive,
+            latest_subq.c.weight_kg,
+            latest_subq.c.temp_c,
+            latest_subq.c.humidity_pct,
+            latest_subq.c.pressure_hpa,
+            latest_subq.c.battery_v,
+            latest_subq.c.observed_at,
+            latest_subq.c.flags,
+            traffic_subq.c.bc_observed_at,
+            traffic_subq.c.bc_bees_in,
+            traffic_subq.c.bc_bees_out,
+            traffic_subq.c.bc_net_out,
+            traffic_subq.c.bc_total_traffic,
+        )
+        .outerjoin(
+            latest_subq,
+            (Hive.id == latest_subq.c.hive_id) & (latest_subq.c.rn == 1),
+        )
+        .outerjoin(
+            traffic_subq,
+            (Hive.id == traffic_subq.c.hive_id) & (traffic_subq.c.bc_rn == 1),
+        )
+    )
+
+
+def _latest_from_row(row) -> tuple:
+    """(hive, latest reading, latest traffic) from a _hives_with_latest_stmt row."""
+    return (
+        row[0],
+        _latest_reading_from_row(row),
+        _latest_traffic_from_row(row[8], row[9], row[10], row[11], row[12]),
+    )
+
+
+def _latest_from_table(latest_state, hives) -> list[tuple] | None:
+    """(hive, latest reading, latest traffic) from the latest-state table.
+
+    None when the table cannot answer (not seeded yet, a slot busy); the
+    caller then queries SQLite.
+    """
+    states = latest_state.hives([hive.id for hive in hives])
+    if states is None:
+        return None
+    entries = []
+    for hive in hives:
+        reading, traffic = states[hive.id]
+        entries.append((
+            hive,
+            LatestReading(**reading) if reading is not None else None,
+            LatestTrafficOut(**traffic) if traffic is not None else None,
+        ))
+    return entries
+
+
 async def _compute_activity_scores(session, hive_ids: list[int]) -> dict[int, int | None]:
     """Compute activity_score_today for a set of hive IDs.
 
@@ -290,84 +369,28 @@ def create_router(verify_key):
             count_stmt = select(func.count()).select_from(Hive)
             total = (await session.execute(count_stmt)).scalar_one()
 
-            # Latest reading subquery using row_number window function
-            latest_subq = (
-                select(
-                    SensorReading.hive_id,
-                    SensorReading.weight_kg,
-                    SensorReading.temp_c,
-                    SensorReading.humidity_pct,
-                    SensorReading.pressure_hpa,
-                    SensorReading.battery_v,
-                    SensorReading.observed_at,
-                    SensorReading.flags,
-                    func.row_number()
-                    .over(
-                        partition_by=SensorReading.hive_id,
-                        order_by=desc(SensorReading.observed_at),
-                    )
-                    .label("rn"),
+            entries = None
+            if request.app.state.latest_state is not None:
+                page_stmt = select(Hive).order_by(Hive.name.asc()).limit(limit).offset(offset)
+                hives = (await session.execute(page_stmt)).scalars().all()
+                entries = _latest_from_table(request.app.state.latest_state, hives)
+            if entries is None:
+                stmt = (
+                    _hives_with_latest_stmt()
+                    .order_by(Hive.name.asc())
+                    .limit(limit)
+                    .offset(offset)
                 )
-                .subquery()
-            )
-
-            # Latest traffic subquery
-            traffic_subq = _latest_traffic_subquery()
-
-            # Main query: hives left-joined with latest reading and latest traffic
-            stmt = (
-                select(
-                    Hive,
-                    latest_subq.c.weight_kg,
-                    latest_subq.c.temp_c,
-                    latest_subq.c.humidity_pct,
-                    latest_subq.c.pressure_hpa,
-                    latest_subq.c.battery_v,
-                    latest_subq.c.observed_at,
-                    latest_subq.c.flags,
-                    traffic_subq.c.bc_observed_at,
-                    traffic_subq.c.bc_bees_in,
-                    traffic_subq.c.bc_bees_out,
-                    traffic_subq.c.bc_net_out,
-                    traffic_subq.c.bc_total_traffic,
-                )
-                .outerjoin(
-                    latest_subq,
-                    (Hive.id == latest_subq.c.hive_id) & (latest_subq.c.rn == 1),
-                )
-                .outerjoin(
-                    traffic_subq,
-                    (Hive.id == traffic_subq.c.hive_id) & (traffic_subq.c.bc_rn == 1),
-                )
-                .order_by(Hive.name.asc())
-                .limit(limit)
-                .offset(offset)
-            )
-
-            result = await session.execute(stmt)
-            rows = result.all()
+                result = await session.execute(stmt)
+                entries = [_latest_from_row(row) for row in result.all()]
 
             # Collect hive IDs for activity score and Phase 3 data
-            hive_ids = [row[0].id for row in rows]
+            hive_ids = [hive.id for hive, _, _ in entries]
             activity_scores = await _compute_activity_scores(session, hive_ids)
             p3_data = await _fetch_phase3_data(session, hive_ids)
 
             items = []
-            for row in rows:
-                hive = row[0]
-                # Build a namespace-like object for the reading columns
-                class _ReadingRow:
-                    pass
-                r = _ReadingRow()
-                r.weight_kg = row[1]
-                r.temp_c = row[2]
-                r.humidity_pct = row[3]
-                r.pressure_hpa = row[4]
-                r.battery_v = row[5]
-                r.observed_at = row[6]
-                r.flags = row[7]
-                latest = _latest_reading_from_row(r)
-                traffic = _latest_traffic_from_row(row[8], row[9], row[10], row[11], row[12])
+            for hive, latest, traffic in entries:
                 p3 = p3_data.get(hive.id, {})
                 items.append(_hive_out(
                     hive, latest, traffic, activity_scores.get(hive.id),
@@ -383,75 +406,23 @@ def create_router(verify_key):
     async def get_hive(hive_id: int, request: Request):
         engine = request.app.state.engine
         async with AsyncSession(engine) as session:
-            # Latest reading subquery
-            latest_subq = (
-                select(
-                    SensorReading.hive_id,
-                    SensorReading.weight_kg,
-                    SensorReading.temp_c,
-                    SensorReading.humidity_pct,
-                    SensorReading.pressure_hpa,
-                    SensorReading.battery_v,
-                    SensorReading.observed_at,
-                    SensorReading.flags,
-                    func.row_number()
-                    .over(
-                        partition_by=SensorReading.hive_id,
-                        order_by=desc(SensorReading.observed_at),
-                    )
-                    .label("rn"),
-                )
-                .subquery()
-            )
-
-            # Latest traffic subquery
-            traffic_subq = _latest_traffic_subquery()
-
-            stmt = (
-                select(
-                    Hive,
-                    latest_subq.c.weight_kg,
-                    latest_subq.c.temp_c,
-                    latest_subq.c.humidity_pct,
-                    latest_subq.c.pressure_hpa,
-                    latest_subq.c.battery_v,
-                    latest_subq.c.observed_at,
-                    latest_subq.c.flags,
-                    traffic_subq.c.bc_observed_at,
-                    traffic_subq.c.bc_bees_in,
-                    traffic_subq.c.bc_bees_out,
-                    traffic_subq.c.bc_net_out,
-                    traffic_subq.c.bc_total_traffic,
-                )
-                .outerjoin(
-                    latest_subq,
-                    (Hive.id == latest_subq.c.hive_id) & (latest_subq.c.rn == 1),
-                )
-                .outerjoin(
-                    traffic_subq,
-                    (Hive.id == traffic_subq.c.hive_id) & (traffic_subq.c.bc_rn == 1),
-                )
-                .where(Hive.id == hive_id)
-            )
-
-            result = await session.execute(stmt)
-            row = result.first()
-            if row is None:
-                raise HTTPException(status_code=404, detail="Hive not found")
-
-            hive = row[0]
-            class _ReadingRow:
-                pass
-            r = _ReadingRow()
-            r.weight_kg = row[1]
-            r.temp_c = row[2]
-            r.humidity_pct = row[3]
-            r.pressure_hpa = row[4]
-            r.battery_v = row[5]
-            r.observed_at = row[6]
-            r.flags = row[7]
-            latest = _latest_reading_from_row(r)
-            traffic = _latest_traffic_from_row(row[8], row[9], row[10], row[11], row[12])
+            entry = None
+            if request.app.state.latest_state is not None:
+                hive = (
+                    await session.execute(select(Hive).where(Hive.id == hive_id))
+                ).scalar_one_or_none()
+                if hive is None:
+                    raise HTTPException(status_code=404, detail="Hive not found")
+                entries = _latest_from_table(request.app.state.latest_state, [hive])
+                entry = entries[0] if entries is not None else None
+            if entry is None:
+                stmt = _hives_with_latest_stmt().where(Hive.id == hive_id)
+                row = (await session.execute(stmt)).first()
+                if row is None:
+                    raise HTTPException(status_code=404, detail="Hive not found")
+                entry = _latest_from_row(row)
+
+            hive, latest, traffic = entry
             activity_scores = await _compute_activity_scores(session, [hive_id])
             p3_data = await _fetch_phase3_data(session, [hive_id])
             p3 = p3_data.get(hive_id, {})
@@ -6,18 +6,381 @@ import os
 import shutil
 import time
 import uuid
+import zlib
 from datetime import UTC, datetime, timedelta
 
 import bcrypt
 from fastapi import APIRouter, File, Form, HTTPException, Query, Request, UploadFile
 from fastapi.responses import FileResponse, JSONResponse
-from sqlalchemy import func, select
+from sqlalchemy import delete, func, select
 from sqlalchemy.exc import IntegrityError
 from sqlalchemy.ext.asyncio import AsyncSession
 
-from waggle.models import CameraNode, Hive, Photo
+from waggle.models import CameraNode, CameraWakeTelemetry, Hive, Photo, PhotoUpload
 from waggle.schemas import PhotoOutLocal, PhotosResponse
 from waggle.utils.timestamps import utc_now
+from waggle.utils.wake_telemetry import parse_wake_telemetry
+
+# Why the camera woke: its sleep timer, an activity line from the sensor
+# node, or a cold power-on.
+PHOTO_TRIGGER_REASONS = ("scheduled", "activity", "boot")
+
+
+# Resumable uploads keep their part files here (hidden, so the orphan
+# cleanup pass skips them).
+UPLOADS_SUBDIR = ".uploads"
+
+JPEG_MAGIC = b"\xff\xd8\xff"
+
+
+def _setting(request: Request, name: str, default):
+    settings = request.app.state.settings if hasattr(request.app.state, "settings") else None
+    value = getattr(settings, name, None)
+    return value if value is not None else default
+
+
+def _photo_dir(request: Request) -> str:
+    return _setting(request, "PHOTO_DIR", None) or os.environ.get(
+        "PHOTO_DIR", "/var/lib/waggle/photos"
+    )
+
+
+def _storage_unavailable(photo_dir: str) -> JSONResponse | None:
+    """Return a 503 response if the photo volume is not mounted."""
+    sentinel = os.path.join(photo_dir, ".waggle-sentinel")
+    if os.path.exists(sentinel):
+        return None
+    return JSONResponse(
+        status_code=503,
+        content={
+            "error": {
+                "code": "STORAGE_UNAVAILABLE",
+                "message": "Photo storage is unavailable",
+            }
+        },
+    )
+
+
+def _normalize_trigger_reason(trigger_reason: str) -> str:
+    # Older firmware omits trigger_reason; treat as a scheduled wake
+    trigger_reason = (trigger_reason or "").strip() or "scheduled"
+    if trigger_reason not in PHOTO_TRIGGER_REASONS:
+        raise HTTPException(status_code=400, detail="Invalid trigger_reason value")
+    return trigger_reason
+
+
+async def _authenticate_device(
+    request: Request, session: AsyncSession, hive_id: int | None
+) -> CameraNode:
+    """Check X-Device-Id / X-API-Key and, if given, the hive binding."""
+    device_id = request.headers.get("X-Device-Id")
+    device_key = request.headers.get("X-API-Key")
+    if not device_id or not device_key:
+        raise HTTPException(status_code=401, detail="Missing or invalid device credentials")
+
+    node = await session.get(CameraNode, device_id)
+    if not node:
+        raise HTTPException(status_code=404, detail="Device not registered")
+
+    # Validate API key against bcrypt hash
+    if not bcrypt.checkpw(device_key.encode("utf-8"), node.api_key_hash.encode("utf-8")):
+        raise HTTPException(status_code=401, detail="Missing or invalid device credentials")
+
+    # Validate hive binding
+    if hive_id is not None and node.hive_id != hive_id:
+        raise HTTPException(status_code=400, detail="hive_id does not match device binding")
+
+    return node
+
+
+async def _read_thumbnail(thumbnail: UploadFile | None, max_thumbnail_size: int) -> bytes | None:
+    """Optional thumbnail from the same wake (same checks as the photo, smaller cap)."""
+    if thumbnail is None:
+        return None
+    thumb_data = await thumbnail.read(max_thumbnail_size + 1)
+    if len(thumb_data) < 3 or thumb_data[:3] != JPEG_MAGIC:
+        raise HTTPException(status_code=400, detail="Thumbnail is not a valid JPEG")
+    if len(thumb_data) > max_thumbnail_size:
+        raise HTTPException(
+            status_code=400,
+            detail=f"Thumbnail exceeds maximum size of {max_thumbnail_size} bytes",
+        )
+    return thumb_data
+
+
+async def _existing_photo_id(
+    session: AsyncSession, device_id: str, boot_id: int, sequence: int
+) -> int | None:
+    return (
+        await session.execute(
+            select(Photo.id).where(
+                Photo.device_id == device_id,
+                Photo.boot_id == boot_id,
+                Photo.sequence == sequence,
+            )
+        )
+    ).scalar_one_or_none()
+
+
+async def _admission_error(
+    session: AsyncSession,
+    photo_dir: str,
+    hive_id: int,
+    max_queue_depth: int,
+    disk_threshold: float,
+    capture_pause_s: int = 0,
+) -> JSONResponse | None:
+    """Rate limit, ML queue backpressure and disk checks for a new photo.
+
+    Queue and disk rejections ask the camera to stop capturing for
+    capture_pause_s (X-Capture-Pause, honoured by the node's wake stub):
+    unlike the rate limit they will not clear within a capture interval.
+    """
+    pause = {"X-Capture-Pause": str(capture_pause_s)} if capture_pause_s > 0 else {}
+    # Rate limit: >10/min/hive
+    one_min_ago = (
+        (datetime.now(UTC) - timedelta(minutes=1)).strftime("%Y-%m-%dT%H:%M:%S.%f")[:-3]
+        + "Z"
+    )
+    rate_count = (
+        await session.execute(
+            select(func.count())
+            .select_from(Photo)
+            .where(
+                Photo.hive_id == hive_id,
+                Photo.ingested_at >= one_min_ago,
+            )
+        )
+    ).scalar()
+    if rate_count >= 10:
+        return JSONResponse(
+            status_code=429,
+            content={
+                "error": {"code": "RATE_LIMITED", "message": "Upload rate limit exceeded"}
+            },
+            headers={"Retry-After": "60"},
+        )
+
+    # Queue backpressure
+    queue_count = (
+        await session.execute(
+            select(func.count())
+            .select_from(Photo)
+            .where(Photo.ml_status.in_(["pending", "processing"]))
+        )
+    ).scalar()
+    if queue_count >= max_queue_depth:
+        return JSONResponse(
+            status_code=429,
+            content={
+                "error": {"code": "RATE_LIMITED", "message": "ML queue depth exceeded"}
+            },
+            headers={"Retry-After": "60", **pause},
+        )
+
+    # Disk usage check
+    try:
+        usage = shutil.disk_usage(photo_dir)
+        if usage.used / usage.total >= disk_threshold:
+            return JSONResponse(
+                status_code=507,
+                content={
+                    "error": {
+                        "code": "STORAGE_FULL",
+                        "message": "Disk usage exceeds threshold",
+                    }
+                },
+                headers=pause,
+            )
+    except OSError:
+        pass  # If we can't check, proceed
+
+    return None
+
+
+async def _store_photo(
+    request: Request,
+    session: AsyncSession,
+    node: CameraNode,
+    *,
+    photo_dir: str,
+    hive_id: int,
+    boot_id: int,
+    sequence: int,
+    captured_at: str,
+    captured_at_source: str,
+    trigger_reason: str,
+    data: bytes,
+    thumb_data: bytes | None,
+) -> dict:
+    """Write a validated photo (and thumbnail) to disk and insert its row.
+
+    Commits the session.  A concurrent duplicate returns the existing id.
+    """
+    device_id = node.device_id
+
+    # SHA256
+    sha256 = hashlib.sha256(data).hexdigest()
+
+    # Normalize captured_at / captured_at_source
+    now = utc_now()
+    if not captured_at or not captured_at.strip():
+        captured_at = now
+        captured_at_source = "ingested"
+    elif not captured_at_source or not captured_at_source.strip():
+        captured_at_source = "device_rtc"
+
+    # Generate storage path
+    date_str = now[:10]  # YYYY-MM-DD
+    sanitized_ts = captured_at.replace(":", "-")
+    stem = f"{hive_id}/{date_str}/{device_id}_{boot_id}_{sequence}_{sanitized_ts}"
+    relative_path = f"{stem}.jpg"
+    full_path = os.path.join(photo_dir, relative_path)
+    dir_path = os.path.dirname(full_path)
+    thumb_relative_path = f"{stem}_thumb.jpg" if thumb_data is not None else None
+    thumb_full_path = (
+        os.path.join(photo_dir, thumb_relative_path) if thumb_relative_path else None
+    )
+
+    # Atomic write
+    os.makedirs(dir_path, exist_ok=True)
+    tmp_name = f".tmp_{uuid.uuid4()}.jpg"
+    tmp_path = os.path.join(dir_path, tmp_name)
+    thumb_tmp_path = os.path.join(dir_path, f".tmp_{uuid.uuid4()}.jpg")
+
+    try:
+        # Write temp file(s)
+        with open(tmp_path, "wb") as f:
+            f.write(data)
+        if thumb_data is not None:
+            with open(thumb_tmp_path, "wb") as f:
+                f.write(thumb_data)
+
+        # Insert DB row
+        try:
+            photo_row = Photo(
+                hive_id=hive_id,
+                device_id=device_id,
+                boot_id=boot_id,
+                captured_at=captured_at,
+                captured_at_source=captured_at_source,
+                ingested_at=now,
+                sequence=sequence,
+                trigger_reason=trigger_reason,
+                photo_path=relative_path,
+                thumbnail_path=thumb_relative_path,
+                file_size_bytes=len(data),
+                sha256=sha256,
+            )
+            session.add(photo_row)
+            await session.flush()
+            photo_id = photo_row.id
+
+            # Wake telemetry is best-effort: a bad header never
+            # costs the photo.
+            telemetry = parse_wake_telemetry(request.headers.get("X-Wake-Telemetry"))
+            if telemetry is not None:
+                session.add(
+                    CameraWakeTelemetry(
+                        photo_id=photo_id,
+                        device_id=device_id,
+                        hive_id=hive_id,
+                        recorded_at=now,
+                        **telemetry,
+                    )
+                )
+                await session.flush()
+        except IntegrityError:
+            await session.rollback()
+            # Race condition: duplicate detected at DB level
+            existing = await _existing_photo_id(session, device_id, boot_id, sequence)
+            for path in (tmp_path, thumb_tmp_path):
+                if os.path.exists(path):
+                    os.unlink(path)
+            return {"photo_id": existing, "status": "duplicate"}
+
+        # Rename temp to final
+        os.rename(tmp_path, full_path)
+        if thumb_full_path is not None:
+            os.rename(thumb_tmp_path, thumb_full_path)
+
+        # Update last_seen_at
+        node.last_seen_at = now
+        await session.commit()
+
+        return {"photo_id": photo_id, "status": "queued"}
+    except Exception:
+        # Cleanup on failure
+        for path in (tmp_path, full_path, thumb_tmp_path, thumb_full_path):
+            if path and os.path.exists(path):
+                os.unlink(path)
+        await session.rollback()
+        raise
+
+
+# --- Resumable uploads ---
+#
+# For weak links the camera can send a photo in chunks instead of one
+# multipart POST:
+#
+#   POST /photos/uploads              metadata + total_size + crc32 (and an
+#                                     optional thumbnail) -> upload_id, offset
+#   PUT  /photos/uploads/{upload_id}  raw bytes at X-Upload-Offset, checked
+#                                     against X-Chunk-CRC32 -> new offset
+#
+# Re-posting the same (device, boot_id, sequence) returns the existing
+# upload and its acknowledged offset, so a transfer broken by a dropped
+# connection or a deep sleep continues where it stopped.  The chunk that
+# completes the upload stores the photo exactly like /photos/upload.
+
+
+def _upload_paths(photo_dir: str, upload_id: str) -> tuple[str, str]:
+    base = os.path.join(photo_dir, UPLOADS_SUBDIR, upload_id)
+    return f"{base}.part", f"{base}_thumb.part"
+
+
+def _discard_upload_files(photo_dir: str, upload_id: str) -> None:
+    for path in _upload_paths(photo_dir, upload_id):
+        try:
+            os.unlink(path)
+        except FileNotFoundError:
+            pass
+
+
+async def _expire_uploads(session: AsyncSession, photo_dir: str, expiry_hours: int) -> None:
+    cutoff = (
+        (datetime.now(UTC) - timedelta(hours=expiry_hours)).strftime("%Y-%m-%dT%H:%M:%S.%f")[
+            :-3
+        ]
+        + "Z"
+    )
+    stale = (
+        await session.execute(select(PhotoUpload.id).where(PhotoUpload.updated_at < cutoff))
+    ).scalars().all()
+    if not stale:
+        return
+    await session.execute(delete(PhotoUpload).where(PhotoUpload.id.in_(stale)))
+    await session.commit()
+    for upload_id in stale:
+        _discard_upload_files(photo_dir, upload_id)
+
+
+def _upload_state(upload: PhotoUpload, chunk_size: int) -> dict:
+    return {
+        "upload_id": upload.id,
+        "offset": upload.received,
+        "total_size": upload.total_size,
+        "chunk_size": chunk_size,
+        "complete": False,
+    }
+
+
+def _offset_error(status_code: int, code: str, message: str, offset: int) -> JSONResponse:
+    # The acknowledged offset rides along so the device can resync
+    return JSONResponse(
+        status_code=status_code,
+        content={"error": {"code": code, "message": message}, "offset": offset},
+    )
 
 
 def create_router(verify_key) -> APIRouter:
@@ -27,64 +390,35 @@ def create_router(verify_key) -> APIRouter:
     async def upload_photo(
         request: Request,
         photo: UploadFile = File(...),
+        thumbnail: UploadFile | None = File(None),
         hive_id: int = Form(...),
         sequence: int = Form(...),
         boot_id: int = Form(...),
         captured_at: str = Form(""),
         captured_at_source: str = Form(""),
+        trigger_reason: str = Form("scheduled"),
     ):
-        settings = (
-            request.app.state.settings if hasattr(request.app.state, "settings") else None
-        )
-        photo_dir = (
-            getattr(settings, "PHOTO_DIR", None)
-            or os.environ.get("PHOTO_DIR", "/var/lib/waggle/photos")
-        )
-        max_photo_size = getattr(settings, "MAX_PHOTO_SIZE", None) or 204800
-        max_queue_depth = getattr(settings, "MAX_QUEUE_DEPTH", None) or 50
-        disk_threshold = getattr(settings, "DISK_USAGE_THRESHOLD", None) or 0.90
+        photo_dir = _photo_dir(request)
+        max_photo_size = _setting(request, "MAX_PHOTO_SIZE", 204800)
+        max_thumbnail_size = _setting(request, "MAX_THUMBNAIL_SIZE", 32768)
+        max_queue_depth = _setting(request, "MAX_QUEUE_DEPTH", 50)
+        disk_threshold = _setting(request, "DISK_USAGE_THRESHOLD", 0.90)
+        capture_pause_s = _setting(request, "CAPTURE_PAUSE_SEC", 900)
 
         # 1. Sentinel guard
-        sentinel = os.path.join(photo_dir, ".waggle-sentinel")
-        if not os.path.exists(sentinel):
-            return JSONResponse(
-                status_code=503,
-                content={
-                    "error": {
-                        "code": "STORAGE_UNAVAILABLE",
-                        "message": "Photo storage is unavailable",
-                    }
-                },
-            )
+        unavailable = _storage_unavailable(photo_dir)
+        if unavailable is not None:
+            return unavailable
 
-        # 2. Validate device auth
-        device_id = request.headers.get("X-Device-Id")
-        device_key = request.headers.get("X-API-Key")
-        if not device_id or not device_key:
-            raise HTTPException(status_code=401, detail="Missing or invalid device credentials")
+        trigger_reason = _normalize_trigger_reason(trigger_reason)
 
         async with AsyncSession(request.app.state.engine) as session:
-            node = await session.get(CameraNode, device_id)
-            if not node:
-                raise HTTPException(status_code=404, detail="Device not registered")
-
-            # 3. Validate API key against bcrypt hash
-            if not bcrypt.checkpw(
-                device_key.encode("utf-8"), node.api_key_hash.encode("utf-8")
-            ):
-                raise HTTPException(
-                    status_code=401, detail="Missing or invalid device credentials"
-                )
-
-            # 4. Validate hive binding
-            if node.hive_id != hive_id:
-                raise HTTPException(
-                    status_code=400, detail="hive_id does not match device binding"
-                )
+            # 2-4. Device auth, API key and hive binding
+            node = await _authenticate_device(request, session, hive_id)
 
             # 5. Read file and validate JPEG magic bytes
             data = await photo.read(max_photo_size + 1)
-            if len(data) < 3 or data[:3] != b"\xff\xd8\xff":
+            if len(data) < 3 or data[:3] != JPEG_MAGIC:
                 raise HTTPException(status_code=400, detail="Not a valid JPEG")
 
             # 6. Size enforcement
@@ -94,162 +428,289 @@ def create_router(verify_key) -> APIRouter:
                     detail=f"Photo exceeds maximum size of {max_photo_size} bytes",
                 )
 
-            # 7. SHA256
-            sha256 = hashlib.sha256(data).hexdigest()
+            # 6b. Optional thumbnail
+            thumb_data = await _read_thumbnail(thumbnail, max_thumbnail_size)
 
-            # 8. Idempotency check (before rate limiting)
-            existing = (
-                await session.execute(
-                    select(Photo.id).where(
-                        Photo.device_id == device_id,
-                        Photo.boot_id == boot_id,
-                        Photo.sequence == sequence,
-                    )
-                )
-            ).scalar_one_or_none()
+            # 7. Idempotency check (before rate limiting)
+            existing = await _existing_photo_id(session, node.device_id, boot_id, sequence)
             if existing is not None:
                 return {"photo_id": existing, "status": "duplicate"}
 
-            # 9. Rate limit: >10/min/hive
-            one_min_ago = (
-                (datetime.now(UTC) - timedelta(minutes=1)).strftime("%Y-%m-%dT%H:%M:%S.%f")[:-3]
-                + "Z"
+            # 8-10. Rate limit, queue backpressure, disk usage
+            rejection = await _admission_error(
+                session, photo_dir, hive_id, max_queue_depth, disk_threshold, capture_pause_s
+            )
+            if rejection is not None:
+                return rejection
+
+            # 11. Store file(s), insert row, update last_seen_at
+            return await _store_photo(
+                request,
+                session,
+                node,
+                photo_dir=photo_dir,
+                hive_id=hive_id,
+                boot_id=boot_id,
+                sequence=sequence,
+                captured_at=captured_at,
+                captured_at_source=captured_at_source,
+                trigger_reason=trigger_reason,
+                data=data,
+                thumb_data=thumb_data,
             )
-            rate_count = (
-                await session.execute(
-                    select(func.count())
-                    .select_from(Photo)
-                    .where(
-                        Photo.hive_id == hive_id,
-                        Photo.ingested_at >= one_min_ago,
-                    )
-                )
-            ).scalar()
-            if rate_count >= 10:
-                return JSONResponse(
-                    status_code=429,
-                    content={
-                        "error": {"code": "RATE_LIMITED", "message": "Upload rate limit exceeded"}
-                    },
-                    headers={"Retry-After": "60"},
-                )
 
-            # 10. Queue backpressure
-            queue_count = (
+    @router.post("/photos/uploads")
+    async def create_photo_upload(
+        request: Request,
+        thumbnail: UploadFile | None = File(None),
+        hive_id: int = Form(...),
+        sequence: int = Form(...),
+        boot_id: int = Form(...),
+        total_size: int = Form(...),
+        crc32: int = Form(...),
+        captured_at: str = Form(""),
+        captured_at_source: str = Form(""),
+        trigger_reason: str = Form("scheduled"),
+    ):
+        photo_dir = _photo_dir(request)
+        max_photo_size = _setting(request, "MAX_PHOTO_SIZE", 204800)
+        max_thumbnail_size = _setting(request, "MAX_THUMBNAIL_SIZE", 32768)
+        max_queue_depth = _setting(request, "MAX_QUEUE_DEPTH", 50)
+        disk_threshold = _setting(request, "DISK_USAGE_THRESHOLD", 0.90)
+        capture_pause_s = _setting(request, "CAPTURE_PAUSE_SEC", 900)
+        chunk_size = _setting(request, "MAX_UPLOAD_CHUNK", 32768)
+        expiry_hours = _setting(request, "UPLOAD_EXPIRY_HOURS", 24)
+
+        unavailable = _storage_unavailable(photo_dir)
+        if unavailable is not None:
+            return unavailable
+
+        trigger_reason = _normalize_trigger_reason(trigger_reason)
+        if total_size <= 0 or total_size > max_photo_size:
+            raise HTTPException(
+                status_code=400,
+                detail=f"total_size must be 1..{max_photo_size} bytes",
+            )
+        if not 0 <= crc32 <= 0xFFFFFFFF:
+            raise HTTPException(status_code=400, detail="Invalid crc32 value")
+
+        async with AsyncSession(request.app.state.engine) as session:
+            node = await _authenticate_device(request, session, hive_id)
+            device_id = node.device_id  # Commits below expire ORM attributes
+            thumb_data = await _read_thumbnail(thumbnail, max_thumbnail_size)
+
+            await _expire_uploads(session, photo_dir, expiry_hours)
+
+            # Already stored (e.g. the completing response was lost)
+            existing = await _existing_photo_id(session, device_id, boot_id, sequence)
+            if existing is not None:
+                return {
+                    "photo_id": existing,
+                    "status": "duplicate",
+                    "offset": total_size,
+                    "total_size": total_size,
+                    "complete": True,
+                }
+
+            upload = (
                 await session.execute(
-                    select(func.count())
-                    .select_from(Photo)
-                    .where(Photo.ml_status.in_(["pending", "processing"]))
-                )
-            ).scalar()
-            if queue_count >= max_queue_depth:
-                return JSONResponse(
-                    status_code=429,
-                    content={
-                        "error": {"code": "RATE_LIMITED", "message": "ML queue depth exceeded"}
-                    },
-                    headers={"Retry-After": "60"},
+                    select(PhotoUpload).where(
+                        PhotoUpload.device_id == device_id,
+                        PhotoUpload.boot_id == boot_id,
+                        PhotoUpload.sequence == sequence,
+                    )
                 )
+            ).scalar_one_or_none()
+            if upload is not None:
+                if upload.total_size == total_size and upload.crc32 == crc32:
+                    return _upload_state(upload, chunk_size)
+                # Same capture key but different bytes: the device lost
+                # its copy and is starting over.
+                stale_id = upload.id
+                await session.delete(upload)
+                await session.commit()
+                _discard_upload_files(photo_dir, stale_id)
 
-            # 11. Disk usage check
-            try:
-                usage = shutil.disk_usage(photo_dir)
-                if usage.used / usage.total >= disk_threshold:
-                    return JSONResponse(
-                        status_code=507,
-                        content={
-                            "error": {
-                                "code": "STORAGE_FULL",
-                                "message": "Disk usage exceeds threshold",
-                            }
-                        },
-                    )
-            except OSError:
-                pass  # If we can't check, proceed
+            rejection = await _admission_error(
+                session, photo_dir, hive_id, max_queue_depth, disk_threshold, capture_pause_s
+            )
+            if rejection is not None:
+                return rejection
 
-            # 12. Normalize captured_at / captured_at_source
             now = utc_now()
-            if not captured_at or not captured_at.strip():
-                captured_at = now
-                captured_at_source = "ingested"
-            elif not captured_at_source or not captured_at_source.strip():
-                captured_at_source = "device_rtc"
-
-            # 13. Generate storage path
-            date_str = now[:10]  # YYYY-MM-DD
-            sanitized_ts = captured_at.replace(":", "-")
-            relative_path = (
-                f"{hive_id}/{date_str}/{device_id}_{boot_id}_{sequence}_{sanitized_ts}.jpg"
+            upload_id = uuid.uuid4().hex
+            upload = PhotoUpload(
+                id=upload_id,
+                device_id=device_id,
+                hive_id=hive_id,
+                boot_id=boot_id,
+                sequence=sequence,
+                captured_at=captured_at,
+                captured_at_source=captured_at_source,
+                trigger_reason=trigger_reason,
+                total_size=total_size,
+                crc32=crc32,
+                received=0,
+                has_thumbnail=1 if thumb_data is not None else 0,
+                created_at=now,
+                updated_at=now,
             )
-            full_path = os.path.join(photo_dir, relative_path)
-            dir_path = os.path.dirname(full_path)
-
-            # 14. Atomic write
-            os.makedirs(dir_path, exist_ok=True)
-            tmp_name = f".tmp_{uuid.uuid4()}.jpg"
-            tmp_path = os.path.join(dir_path, tmp_name)
-
+            part_path, thumb_part_path = _upload_paths(photo_dir, upload_id)
+            os.makedirs(os.path.dirname(part_path), exist_ok=True)
+            open(part_path, "wb").close()
+            if thumb_data is not None:
+                with open(thumb_part_path, "wb") as f:
+                    f.write(thumb_data)
+
+            state = _upload_state(upload, chunk_size)
+            session.add(upload)
             try:
-                # Write temp file
-                with open(tmp_path, "wb") as f:
-                    f.write(data)
-
-                # Insert DB row
-                try:
-                    photo_row = Photo(
-                        hive_id=hive_id,
-                        device_id=device_id,
-                        boot_id=boot_id,
-                        captured_at=captured_at,
-                        captured_at_source=captured_at_source,
-                        ingested_at=now,
-                        sequence=sequence,
-                        photo_path=relative_path,
-                        file_size_bytes=len(data),
-                        sha256=sha256,
-                    )
-                    session.add(photo_row)
-                    await session.flush()
-                    photo_id = photo_row.id
-                except IntegrityError:
-                    await session.rollback()
-                    # Race condition: duplicate detected at DB level
-                    existing = (
-                        await session.execute(
-                            select(Photo.id).where(
-                                Photo.device_id == device_id,
-                                Photo.boot_id == boot_id,
-                                Photo.sequence == sequence,
-                            )
+                await session.commit()
+            except IntegrityError:
+                # Concurrent create for the same capture: use the winner
+                await session.rollback()
+                _discard_upload_files(photo_dir, upload_id)
+                upload = (
+                    await session.execute(
+                        select(PhotoUpload).where(
+                            PhotoUpload.device_id == device_id,
+                            PhotoUpload.boot_id == boot_id,
+                            PhotoUpload.sequence == sequence,
                         )
-                    ).scalar_one_or_none()
-                    if os.path.exists(tmp_path):
-                        os.unlink(tmp_path)
-                    return {"photo_id": existing, "status": "duplicate"}
+                    )
+                ).scalar_one()
+                return _upload_state(upload, chunk_size)
+
+            return JSONResponse(status_code=201, content=state)
+
+    @router.put("/photos/uploads/{upload_id}")
+    async def put_photo_upload_chunk(request: Request, upload_id: str):
+        photo_dir = _photo_dir(request)
+        chunk_size = _setting(request, "MAX_UPLOAD_CHUNK", 32768)
+
+        unavailable = _storage_unavailable(photo_dir)
+        if unavailable is not None:
+            return unavailable
+
+        try:
+            offset = int(request.headers.get("X-Upload-Offset", ""))
+            chunk_crc = int(request.headers.get("X-Chunk-CRC32", ""), 16)
+        except ValueError:
+            raise HTTPException(
+                status_code=400, detail="X-Upload-Offset and X-Chunk-CRC32 are required"
+            ) from None
+        if offset < 0:
+            raise HTTPException(status_code=400, detail="Invalid X-Upload-Offset")
+
+        too_large = HTTPException(
+            status_code=413, detail=f"Chunk exceeds maximum size of {chunk_size} bytes"
+        )
+        declared = request.headers.get("Content-Length")
+        if declared is not None and declared.isdigit() and int(declared) > chunk_size:
+            raise too_large
+
+        # Content-Length may be absent (chunked transfer): stop reading as
+        # soon as the cap is passed, before a database session is opened
+        body = bytearray()
+        async for part in request.stream():
+            body += part
+            if len(body) > chunk_size:
+                raise too_large
+        chunk = bytes(body)
+        if not chunk:
+            raise HTTPException(status_code=400, detail="Empty chunk")
 
-                # Rename temp to final
-                os.rename(tmp_path, full_path)
+        async with AsyncSession(request.app.state.engine) as session:
+            node = await _authenticate_device(request, session, None)
+            upload = await session.get(PhotoUpload, upload_id)
+            if upload is None or upload.device_id != node.device_id:
+                raise HTTPException(status_code=404, detail="Upload not found")
+
+            if offset != upload.received:
+                return _offset_error(
+                    409, "OFFSET_MISMATCH", "Chunk does not start at the acknowledged offset",
+                    upload.received,
+                )
+            if offset + len(chunk) > upload.total_size:
+                raise HTTPException(status_code=400, detail="Chunk runs past total_size")
+            if zlib.crc32(chunk) != chunk_crc:
+                return _offset_error(
+                    422, "CRC_MISMATCH", "Chunk CRC32 does not match", upload.received
+                )
 
-                # 15. Update last_seen_at
-                node.last_seen_at = now
+            # Data first, then the offset: a crash in between only costs a
+            # resend of this chunk.
+            part_path, thumb_part_path = _upload_paths(photo_dir, upload_id)
+            with open(part_path, "r+b") as f:
+                f.seek(offset)
+                f.write(chunk)
+                f.truncate()
+                f.flush()
+                os.fsync(f.fileno())
+
+            upload.received = offset + len(chunk)
+            upload.updated_at = utc_now()
+            if upload.received < upload.total_size:
+                state = _upload_state(upload, chunk_size)
                 await session.commit()
+                return state
 
-                return {"photo_id": photo_id, "status": "queued"}
-            except Exception:
-                # Cleanup on failure
-                if os.path.exists(tmp_path):
-                    os.unlink(tmp_path)
-                if os.path.exists(full_path):
-                    os.unlink(full_path)
-                await session.rollback()
-                raise
+            # Final chunk: verify the whole photo before storing it
+            with open(part_path, "rb") as f:
+                data = f.read()
+            if zlib.crc32(data) != upload.crc32 or data[:3] != JPEG_MAGIC:
+                await session.delete(upload)
+                await session.commit()
+                _discard_upload_files(photo_dir, upload_id)
+                return _offset_error(
+                    422, "UPLOAD_CORRUPT", "Assembled photo failed verification; start over",
+                    0,
+                )
 
-    @router.get("/photos/{photo_id}/image")
-    async def serve_photo_image(
+            thumb_data = None
+            if upload.has_thumbnail:
+                with open(thumb_part_path, "rb") as f:
+                    thumb_data = f.read()
+
+            fields = {
+                "hive_id": upload.hive_id,
+                "boot_id": upload.boot_id,
+                "sequence": upload.sequence,
+                "captured_at": upload.captured_at,
+                "captured_at_source": upload.captured_at_source,
+                "trigger_reason": upload.trigger_reason,
+            }
+            await session.delete(upload)
+            result = await _store_photo(
+                request,
+                session,
+                node,
+                photo_dir=photo_dir,
+                data=data,
+                thumb_data=thumb_data,
+                **fields,
+            )
+            if result["status"] == "duplicate":
+                # The store rolled back, taking the upload delete with it
+                await session.execute(delete(PhotoUpload).where(PhotoUpload.id == upload_id))
+                await session.commit()
+            _discard_upload_files(photo_dir, upload_id)
+
+            return {
+                **result,
+                "upload_id": upload_id,
+                "offset": len(data),
+                "total_size": len(data),
+                "complete": True,
+            }
+
+    async def _serve_photo_file(
         request: Request,
         photo_id: int,
-        token: str | None = Query(default=None),
-        expires: int | None = Query(default=None),
+        token: str | None,
+        expires: int | None,
+        *,
+        thumbnail: bool,
     ):
         settings = (
             request.app.state.settings
@@ -314,7 +775,10 @@ def create_router(verify_key) -> APIRouter:
             if not photo:
                 raise HTTPException(status_code=404, detail="Photo not found")
 
-            full_path = os.path.join(photo_dir, photo.photo_path)
+            relative_path = photo.thumbnail_path if thumbnail else photo.photo_path
+            if not relative_path:
+                raise HTTPException(status_code=404, detail="Thumbnail not found")
+            full_path = os.path.join(photo_dir, relative_path)
             if not os.path.exists(full_path):
                 raise HTTPException(status_code=404, detail="Photo not found")
 
@@ -324,6 +788,26 @@ def create_router(verify_key) -> APIRouter:
             headers={"Cache-Control": f"private, max-age={signing_ttl}"},
         )
 
+    @router.get("/photos/{photo_id}/image")
+    async def serve_photo_image(
+        request: Request,
+        photo_id: int,
+        token: str | None = Query(default=None),
+        expires: int | None = Query(default=None),
+    ):
+        return await _serve_photo_file(request, photo_id, token, expires, thumbnail=False)
+
+    @router.get("/photos/{photo_id}/thumbnail")
+    async def serve_photo_thumbnail(
+        request: Request,
+        photo_id: int,
+        token: str | None = Query(default=None),
+        expires: int | None = Query(default=None),
+    ):
+        # Same auth as the full image; signed tokens are per photo, so a
+        # listed token is valid for both.
+        return await _serve_photo_file(request, photo_id, token, expires, thumbnail=True)
+
     @router.get(
         "/hives/{hive_id}/photos",
         dependencies=[verify_key] if verify_key else [],
@@ -410,6 +894,11 @@ def create_router(verify_key) -> APIRouter:
                 local_url = (
                     f"{base_url}/api/photos/{p.id}/image?token={token}&expires={expires_at}"
                 )
+                thumb_url = (
+                    f"{base_url}/api/photos/{p.id}/thumbnail?token={token}&expires={expires_at}"
+                    if p.thumbnail_path
+                    else None
+                )
 
                 items.append(
                     PhotoOutLocal(
@@ -420,8 +909,10 @@ def create_router(verify_key) -> APIRouter:
                         captured_at=p.captured_at,
                         captured_at_source=p.captured_at_source,
                         sequence=p.sequence,
+                        trigger_reason=p.trigger_reason,
                         local_image_url=local_url,
                         local_image_expires_at=expires_at,
+                        local_thumbnail_url=thumb_url,
                         file_size_bytes=p.file_size_bytes,
                         sha256=p.sha256,
                         ml_status=p.ml_status,
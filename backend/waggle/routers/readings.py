@@ -8,6 +8,7 @@ from sqlalchemy.ext.asyncio import AsyncSession
 
 from waggle.models import Hive, SensorReading
 from waggle.schemas import AggregatedReading, ReadingOut, ReadingsResponse
+from waggle.services.tsstore import query_readings
 
 
 async def _verify_hive_exists(session: AsyncSession, hive_id: int) -> None:
@@ -53,7 +54,7 @@ def create_router(verify_key):
 
             if interval == "raw":
                 return await _raw_readings(
-                    session, hive_id, start, end, limit, offset
+                    session, hive_id, start, end, limit, offset, request.app.state.tsstore
                 )
             else:
                 return await _aggregated_readings(
@@ -88,8 +89,24 @@ async def _raw_readings(
     end: str | None,
     limit: int,
     offset: int,
+    store=None,
 ) -> ReadingsResponse:
-    """Return individual readings ordered by observed_at DESC."""
+    """Return individual readings ordered by observed_at DESC.
+
+    Served from the time-series store when it is enabled and holds the hive.
+    """
+    if store is not None:
+        stored = await query_readings(store, session, hive_id, start, end, limit, offset)
+        if stored is not None:
+            total, rows = stored
+            return ReadingsResponse(
+                items=[ReadingOut(**r) for r in rows],
+                interval="raw",
+                total=total,
+                limit=limit,
+                offset=offset,
+            )
+
     base = select(SensorReading).where(SensorReading.hive_id == hive_id)
     count_base = (
         select(func.count())
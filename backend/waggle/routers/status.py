@@ -1,10 +1,10 @@
-"""Hub status endpoint returning system health information."""
+"""Hub status endpoints: system health and per-hop reading latency."""
 
 import shutil
 import time
 from datetime import UTC
 
-from fastapi import APIRouter, Request
+from fastapi import APIRouter, HTTPException, Query, Request
 from sqlalchemy import desc, func, select, text
 from sqlalchemy.ext.asyncio import AsyncSession
 
@@ -18,7 +18,8 @@ from waggle.models import (
     Photo,
     SensorReading,
 )
-from waggle.schemas import HubStatusOut, ServiceHealth
+from waggle.schemas import HubLatencyOut, HubStatusOut, ReadingTraceOut, ServiceHealth
+from waggle.services.latency import latency_tracker
 
 _START_TIME = time.monotonic()
 
@@ -30,14 +31,22 @@ def create_router():
     async def hub_status(request: Request):
         engine = request.app.state.engine
 
+        # Last ingest and stuck lanes from the latest-state table when the
+        # ingestion path keeps one
+        latest_state = request.app.state.latest_state
+        hub_latest = latest_state.hub() if latest_state is not None else None
+
         async with AsyncSession(engine) as session:
             # Last ingested reading
-            result = await session.execute(
-                select(SensorReading.ingested_at)
-                .order_by(desc(SensorReading.ingested_at))
-                .limit(1)
-            )
-            last_ingest = result.scalar_one_or_none()
+            if hub_latest is not None:
+                last_ingest = hub_latest[0]
+            else:
+                result = await session.execute(
+                    select(SensorReading.ingested_at)
+                    .order_by(desc(SensorReading.ingested_at))
+                    .limit(1)
+                )
+                last_ingest = result.scalar_one_or_none()
 
             # Hive count
             result = await session.execute(select(func.count()).select_from(Hive))
@@ -73,21 +82,24 @@ def create_router():
             phase2_nodes_active = result.scalar_one()
 
             # Stuck lanes - latest bee_count per hive, sum popcount of stuck_mask
-            result = await session.execute(
-                text(
-                    "SELECT COALESCE(SUM("
-                    "  (stuck_mask & 1) + ((stuck_mask >> 1) & 1) + "
-                    "  ((stuck_mask >> 2) & 1) + ((stuck_mask >> 3) & 1) + "
-                    "  ((stuck_mask >> 4) & 1) + ((stuck_mask >> 5) & 1) + "
-                    "  ((stuck_mask >> 6) & 1) + ((stuck_mask >> 7) & 1)"
-                    "), 0) "
-                    "FROM (SELECT stuck_mask FROM bee_counts bc1 "
-                    "WHERE bc1.observed_at = (SELECT MAX(bc2.observed_at) "
-                    "FROM bee_counts bc2 "
-                    "WHERE bc2.hive_id = bc1.hive_id))"
+            if hub_latest is not None:
+                stuck_lanes_total = hub_latest[1]
+            else:
+                result = await session.execute(
+                    text(
+                        "SELECT COALESCE(SUM("
+                        "  (stuck_mask & 1) + ((stuck_mask >> 1) & 1) + "
+                        "  ((stuck_mask >> 2) & 1) + ((stuck_mask >> 3) & 1) + "
+                        "  ((stuck_mask >> 4) & 1) + ((stuck_mask >> 5) & 1) + "
+                        "  ((stuck_mask >> 6) & 1) + ((stuck_mask >> 7) & 1)"
+                        "), 0) "
+                        "FROM (SELECT stuck_mask FROM bee_counts bc1 "
+                        "WHERE bc1.observed_at = (SELECT MAX(bc2.observed_at) "
+                        "FROM bee_counts bc2 "
+                        "WHERE bc2.hive_id = bc1.hive_id))"
+                    )
                 )
-            )
-            stuck_lanes_total = result.scalar()
+                stuck_lanes_total = result.scalar()
 
             # Photos in last 24h
             result = await session.execute(
@@ -177,4 +189,18 @@ def create_router():
             sync_pending_files=sync_pending_files,
         )
 
+    @router.get("/hub/latency", response_model=HubLatencyOut)
+    async def hub_latency(recent: int = Query(20, ge=0, le=256)):
+        """Per-hop latency histograms and the most recent reading traces."""
+        return latency_tracker.summary(recent)
+
+    @router.get(
+        "/hub/latency/trace/{hive_id}/{sequence}", response_model=ReadingTraceOut
+    )
+    async def hub_latency_trace(hive_id: int, sequence: int):
+        trace = latency_tracker.trace(hive_id, sequence)
+        if trace is None:
+            raise HTTPException(status_code=404, detail="No trace for this reading")
+        return trace
+
     return router
@@ -13,6 +13,7 @@ from waggle.schemas import (
     TrafficResponse,
     TrafficSummaryOut,
 )
+from waggle.services.tsstore import query_traffic
 
 
 def create_router(verify_key):
@@ -35,7 +36,14 @@ def create_router(verify_key):
 
             if interval == "raw":
                 return await _raw_traffic(
-                    session, hive_id, from_time, to_time, order, limit, offset
+                    session,
+                    hive_id,
+                    from_time,
+                    to_time,
+                    order,
+                    limit,
+                    offset,
+                    request.app.state.tsstore,
                 )
             else:
                 return await _aggregated_traffic(
@@ -163,7 +171,21 @@ async def _get_hive_or_404(session, hive_id):
     return hive
 
 
-async def _raw_traffic(session, hive_id, from_time, to_time, order, limit, offset):
+async def _raw_traffic(session, hive_id, from_time, to_time, order, limit, offset, store=None):
+    if store is not None:
+        stored = await query_traffic(
+            store, session, hive_id, from_time or None, to_time or None, order, limit, offset
+        )
+        if stored is not None:
+            total, rows = stored
+            return TrafficResponse(
+                items=[TrafficRecordOut(**r) for r in rows],
+                interval="raw",
+                total=total,
+                limit=limit,
+                offset=offset,
+            )
+
     where_clauses = ["hive_id = :hive_id"]
     params = {"hive_id": hive_id}
 
@@ -261,6 +261,33 @@ class HubStatusOut(BaseModel):
     sync_pending_files: int = 0
 
 
+class LatencyBucketOut(BaseModel):
+    le_ms: float | None  # None: the open-ended last bucket
+    count: int
+
+
+class HopLatencyOut(BaseModel):
+    count: int
+    mean_ms: float | None
+    max_ms: float | None
+    p50_ms: float | None
+    p95_ms: float | None
+    p99_ms: float | None
+    buckets: list[LatencyBucketOut]
+
+
+class ReadingTraceOut(BaseModel):
+    hive_id: int
+    sequence: int
+    attempt: int | None = None
+    hops_ms: dict[str, float]
+
+
+class HubLatencyOut(BaseModel):
+    hops: dict[str, HopLatencyOut]
+    recent: list[ReadingTraceOut]
+
+
 # --- Camera Nodes ---
 
 
@@ -290,8 +317,10 @@ class PhotoOutLocal(BaseModel):
     captured_at: str
     captured_at_source: Literal["device_ntp", "device_rtc", "ingested"]
     sequence: int
+    trigger_reason: Literal["scheduled", "activity", "boot"] = "scheduled"
     local_image_url: str
     local_image_expires_at: int
+    local_thumbnail_url: str | None = None
     file_size_bytes: int
     sha256: str
     ml_status: Literal["pending", "processing", "completed", "failed"]
@@ -310,7 +339,9 @@ class PhotoRowCloud(BaseModel):
     captured_at: str
     captured_at_source: Literal["device_ntp", "device_rtc", "ingested"]
     sequence: int
+    trigger_reason: Literal["scheduled", "activity", "boot"] = "scheduled"
     supabase_path: str | None = None
+    thumbnail_path: str | None = None
     file_size_bytes: int
     sha256: str
     ml_status: Literal["pending", "processing", "completed", "failed"]
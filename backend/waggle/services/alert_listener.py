@@ -0,0 +1,100 @@
+"""Alert listener: runs the alert engine for readings stored by ingestd.
+
+The native ingestion daemon (backend/native/ingestd) writes readings
+straight to SQLite and, after each committed batch, publishes every stored
+reading to waggle/{hive_id}/ingested.  This service subscribes to those
+messages and calls AlertEngine.check_reading with the same dict
+IngestionService passes, so alert rules stay in Python.  With the native
+alert windows built (waggle._alerts) that is a StreamingAlertEngine, whose
+windows are re-seeded after every reconnect since readings published while
+disconnected were missed.
+"""
+
+import asyncio
+import json
+import logging
+
+from waggle.database import create_engine_from_url, init_db
+from waggle.services.alert_engine import AlertEngine
+from waggle.services.alert_stream import StreamingAlertEngine, create_alert_engine
+
+logger = logging.getLogger(__name__)
+
+INGESTED_TOPIC = "waggle/+/ingested"
+
+RECONNECT_DELAY_SEC = 5.0
+
+READING_FIELDS = (
+    "weight_kg",
+    "temp_c",
+    "humidity_pct",
+    "pressure_hpa",
+    "battery_v",
+    "observed_at",
+    "flags",
+)
+TRAFFIC_FIELDS = ("bees_in", "bees_out", "period_ms", "lane_mask", "stuck_mask")
+
+
+def parse_ingested(payload: bytes | str) -> tuple[int, dict] | None:
+    """Parse an ingested message into (hive_id, reading) for check_reading.
+
+    Returns None for malformed messages.
+    """
+    try:
+        msg = json.loads(payload)
+    except (ValueError, UnicodeDecodeError):
+        return None
+    if not isinstance(msg, dict):
+        return None
+    hive_id = msg.get("hive_id")
+    if not isinstance(hive_id, int) or not 1 <= hive_id <= 250:
+        return None
+    if not isinstance(msg.get("observed_at"), str):
+        return None
+
+    reading = {field: msg.get(field) for field in READING_FIELDS}
+    if "bees_in" in msg:
+        for field in TRAFFIC_FIELDS:
+            reading[field] = msg.get(field)
+    return hive_id, reading
+
+
+async def handle_message(alert_engine: AlertEngine, payload: bytes | str) -> list[dict]:
+    """Run the alert rules for one ingested message; returns fired alerts."""
+    parsed = parse_ingested(payload)
+    if parsed is None:
+        logger.warning("Ignoring malformed ingested message: %.120r", payload)
+        return []
+    hive_id, reading = parsed
+    return await alert_engine.check_reading(hive_id, reading)
+
+
+async def run_alert_listener(db_url: str, mqtt_host: str, mqtt_port: int) -> None:
+    """Subscribe to ingested readings and evaluate alerts until cancelled."""
+    import aiomqtt
+
+    engine = create_engine_from_url(db_url, is_worker=True)
+    await init_db(engine)
+    alert_engine = create_alert_engine(engine)
+
+    try:
+        while True:
+            try:
+                async with aiomqtt.Client(mqtt_host, mqtt_port) as client:
+                    await client.subscribe(INGESTED_TOPIC)
+                    if isinstance(alert_engine, StreamingAlertEngine):
+                        alert_engine.reset()
+                    logger.info("Listening on %s at %s:%d", INGESTED_TOPIC, mqtt_host, mqtt_port)
+                    async for message in client.messages:
+                        try:
+                            await handle_message(alert_engine, message.payload)
+                        except Exception:
+                            logger.exception("Alert check failed for %s", message.topic)
+            except aiomqtt.MqttError as e:
+                logger.warning(
+                    "MQTT connection lost (%s); retrying in %.0fs", e, RECONNECT_DELAY_SEC
+                )
+                await asyncio.sleep(RECONNECT_DELAY_SEC)
+    finally:
+        await engine.dispose()
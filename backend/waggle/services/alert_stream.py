@@ -0,0 +1,233 @@
+"""Streaming evaluation of the reading alert rules.
+
+AlertEngine.check_reading answers each of its look-back rules
+(POSSIBLE_SWARM, ABSCONDING, ROBBING, LOW_ACTIVITY) with a SQL query over
+the hive's recent readings, plus a cooldown query per rule, for every
+reading.  StreamingAlertEngine keeps those windows in memory instead, in the
+native ``waggle._alerts`` extension (backend/native/alerts): per-hive deques
+of the last one and two hours with running sums and max-weight deques, and
+eligible traffic per UTC day.  Each reading updates them in O(1) and the
+rule checks read the results; the cooldown is only queried when a rule's
+thresholds are met.  Alerts are fired by AlertEngine itself, so they have
+the same type, severity, message and shape.
+
+The first reading of a hive seeds its windows from SQLite (the last two
+hours of readings and a week of daily traffic).  A reading observed before
+the hive's previous one, or with a non-canonical observed_at, is evaluated
+with SQL as before and the hive is seeded again on its next reading.  Set
+``WAGGLE_NATIVE_ALERTS=0`` to always use SQL.
+"""
+
+import logging
+import os
+from datetime import UTC, datetime, timedelta
+from typing import NamedTuple
+
+from sqlalchemy import text
+from sqlalchemy.ext.asyncio import AsyncEngine, AsyncSession
+
+from waggle.services.alert_engine import AlertEngine
+from waggle.services.tsstore import iso_to_ms
+
+try:
+    if os.environ.get("WAGGLE_NATIVE_ALERTS", "1") == "0":
+        raise ImportError("native alert windows disabled")
+    from waggle import _alerts
+except ImportError:
+    _alerts = None
+
+logger = logging.getLogger(__name__)
+
+NATIVE_AVAILABLE = _alerts is not None
+
+_EPOCH = datetime(1970, 1, 1, tzinfo=UTC)
+_DAY_MS = 86_400_000
+
+SEED_ROWS_SQL = text(
+    "SELECT sr.observed_at, sr.weight_kg, sr.flags, bc.bees_in, bc.bees_out, bc.stuck_mask"
+    " FROM sensor_readings sr"
+    " LEFT JOIN bee_counts bc ON bc.reading_id = sr.id"
+    " WHERE sr.hive_id = :hive_id"
+    "   AND sr.observed_at >= :from_2h"
+    " ORDER BY sr.observed_at, sr.id"
+)
+
+# Same eligibility as the LOW_ACTIVITY query, for days before the seeded rows
+SEED_DAYS_SQL = text(
+    "SELECT substr(bc.observed_at, 1, 10) AS day, COUNT(*), SUM(bc.total_traffic)"
+    " FROM bee_counts bc"
+    " JOIN sensor_readings sr ON sr.id = bc.reading_id"
+    " WHERE bc.hive_id = :hive_id"
+    "   AND bc.observed_at >= :week_start"
+    "   AND bc.observed_at < :from_2h"
+    "   AND (sr.flags & 0x02) = 0"
+    "   AND (sr.flags & 0x40) = 0"
+    "   AND bc.stuck_mask = 0"
+    " GROUP BY day"
+)
+
+# Private key carrying the window results through AlertEngine.check_reading
+_WINDOWS_KEY = "_windows"
+
+
+class WindowResult(NamedTuple):
+    traffic_rows_1h: int
+    swarm_weight: bool
+    swarm: tuple | None
+    absconding: tuple | None
+    robbing: tuple | None
+    low_activity: tuple | None
+
+
+def _iso(ms: int) -> str:
+    return (_EPOCH + timedelta(milliseconds=ms)).strftime("%Y-%m-%dT%H:%M:%S.%f")[:-3] + "Z"
+
+
+def _row(t_ms: int, reading: dict) -> tuple:
+    bees_in = reading.get("bees_in")
+    traffic = (None, 0, 0) if bees_in is None else (
+        bees_in,
+        reading.get("bees_out") or 0,
+        reading.get("stuck_mask") or 0,
+    )
+    return (t_ms, reading.get("weight_kg"), reading.get("flags") or 0, *traffic)
+
+
+class StreamingAlertEngine(AlertEngine):
+    """AlertEngine with the look-back rules answered from in-memory windows.
+
+    check_reading expects traffic fields in the reading dict only when the
+    reading's bee_counts row was stored, as IngestionService and ingestd
+    pass them.
+    """
+
+    def __init__(self, engine: AsyncEngine):
+        super().__init__(engine)
+        if _alerts is None:
+            raise RuntimeError("waggle._alerts is not built")
+        self._windows = _alerts.Windows()
+
+    def reset(self) -> None:
+        """Forget every hive; each is seeded from SQLite on its next reading.
+
+        Call after readings may have been stored without passing through
+        check_reading (e.g. a dropped subscription).
+        """
+        self._windows.clear()
+
+    async def check_reading(self, hive_id: int, reading: dict) -> list[dict]:
+        t_ms = iso_to_ms(reading.get("observed_at"))
+        if t_ms is None:
+            self._windows.forget(hive_id)
+            return await super().check_reading(hive_id, reading)
+
+        if hive_id in self._windows:
+            in_order = self._windows.add(hive_id, _row(t_ms, reading))
+        else:
+            in_order = await self._seed(hive_id, t_ms)
+        if not in_order:
+            # Late reading: its windows are in the past
+            logger.debug("Out-of-order reading for hive %d, using SQL", hive_id)
+            self._windows.forget(hive_id)
+            return await super().check_reading(hive_id, reading)
+
+        result = WindowResult(*self._windows.evaluate(hive_id, reading.get("weight_kg")))
+        return await super().check_reading(hive_id, {**reading, _WINDOWS_KEY: result})
+
+    async def _seed(self, hive_id: int, t_ms: int) -> bool:
+        """Load the hive's windows up to and including the stored reading at t_ms.
+
+        Returns False (nothing seeded) if the hive has readings observed
+        after t_ms, i.e. this one arrived late.
+        """
+        from_2h = _iso(t_ms - 2 * 3_600_000)
+        week_start = _iso((t_ms // _DAY_MS - 7) * _DAY_MS)
+        async with AsyncSession(self.engine) as session:
+            rows = (
+                await session.execute(SEED_ROWS_SQL, {"hive_id": hive_id, "from_2h": from_2h})
+            ).fetchall()
+            if rows and iso_to_ms(rows[-1][0]) > t_ms:
+                return False
+            days = (
+                await session.execute(
+                    SEED_DAYS_SQL,
+                    {"hive_id": hive_id, "week_start": week_start, "from_2h": from_2h},
+                )
+            ).fetchall()
+        self._windows.seed(
+            hive_id,
+            [
+                (iso_to_ms(r[0]), r[1], r[2], r[3], r[4] or 0, r[5] or 0)
+                for r in rows
+                if iso_to_ms(r[0]) is not None
+            ],
+            [(iso_to_ms(d[0] + "T00:00:00.000Z") // _DAY_MS, d[1], d[2]) for d in days],
+        )
+        return True
+
+    # ---- Rule checks ----
+
+    async def _check_swarm(self, session: AsyncSession, hive_id: int, reading: dict) -> bool:
+        windows = reading.get(_WINDOWS_KEY)
+        if windows is None:
+            return await super()._check_swarm(session, hive_id, reading)
+        if not windows.swarm_weight:
+            return False
+        return not await self._cooldown_active(session, hive_id, "POSSIBLE_SWARM", 720)
+
+    async def _check_swarm_correlation(
+        self, session: AsyncSession, hive_id: int, reading: dict
+    ) -> tuple[float, int, int] | None | bool:
+        windows = reading.get(_WINDOWS_KEY)
+        if windows is None:
+            return await super()._check_swarm_correlation(session, hive_id, reading)
+        if reading.get("weight_kg") is None or windows.traffic_rows_1h == 0:
+            return None
+        if windows.swarm is None:
+            return False
+        if await self._cooldown_active(session, hive_id, "POSSIBLE_SWARM", 720):
+            return False
+        return windows.swarm
+
+    async def _check_absconding(
+        self, session: AsyncSession, hive_id: int, reading: dict
+    ) -> tuple[float, int, int] | bool:
+        windows = reading.get(_WINDOWS_KEY)
+        if windows is None:
+            return await super()._check_absconding(session, hive_id, reading)
+        if windows.absconding is None:
+            return False
+        if await self._cooldown_active(session, hive_id, "ABSCONDING", 1440):
+            return False
+        return windows.absconding
+
+    async def _check_robbing(
+        self, session: AsyncSession, hive_id: int, reading: dict
+    ) -> tuple[float, int, int, int] | bool:
+        windows = reading.get(_WINDOWS_KEY)
+        if windows is None:
+            return await super()._check_robbing(session, hive_id, reading)
+        if windows.robbing is None:
+            return False
+        if await self._cooldown_active(session, hive_id, "ROBBING", 240):
+            return False
+        return windows.robbing
+
+    async def _check_low_activity(
+        self, session: AsyncSession, hive_id: int, reading: dict
+    ) -> tuple[int, float, int] | bool:
+        windows = reading.get(_WINDOWS_KEY)
+        if windows is None:
+            return await super()._check_low_activity(session, hive_id, reading)
+        if windows.low_activity is None:
+            return False
+        if await self._cooldown_active(session, hive_id, "LOW_ACTIVITY", 1440):
+            return False
+        return windows.low_activity
+
+
+def create_alert_engine(engine: AsyncEngine) -> AlertEngine:
+    """StreamingAlertEngine when the native windows are built, else AlertEngine."""
+    if NATIVE_AVAILABLE:
+        return StreamingAlertEngine(engine)
+    return AlertEngine(engine)
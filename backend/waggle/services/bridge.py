@@ -1,9 +1,12 @@
 """Bridge service: processes raw COBS-encoded serial frames into MQTT-ready JSON dicts."""
 
 import logging
+import time
 
+from waggle.services.latency import SerialClock
 from waggle.utils.cobs import CobsDecodeError, cobs_decode
-from waggle.utils.payload import PayloadError, deserialize_payload
+from waggle.utils.frames import decode_frames
+from waggle.utils.payload import MSG_TYPE_THERMAL, PayloadError, deserialize_payload
 from waggle.utils.timestamps import utc_now
 
 logger = logging.getLogger(__name__)
@@ -11,15 +14,43 @@ logger = logging.getLogger(__name__)
 _MAC_LENGTH = 6
 _VALID_FRAME_LENGTHS = {
     38,  # 6 MAC + 32 payload (Phase 1, msg_type=0x01)
+    50,  # 6 MAC + 44 payload (thermal array, msg_type=0x04; not a reading)
     54,  # 6 MAC + 48 payload (Phase 2, msg_type=0x02)
 }
 
 _TRAFFIC_FIELDS = ("bees_in", "bees_out", "period_ms", "lane_mask", "stuck_mask")
 
+# A partial frame longer than this without a delimiter is line noise
+_MAX_PENDING = 256
+
 
 class BridgeProcessor:
     """Processes raw COBS-encoded serial frames into MQTT-ready JSON dicts."""
 
+    def __init__(self) -> None:
+        self._pending = b""  # Bytes after the last delimiter seen by process_buffer
+        self._serial_clock = SerialClock()
+
+    def _trace(self, payload: dict, hub_read_ms: float, hub_rx: float) -> dict | None:
+        """Latency trace for the message, from a traced Phase 2 payload (else None).
+
+        node/radio/bridge come from the payload's trace; serial is estimated
+        against the bridge clock.  hub_rx (epoch seconds) lets the ingestion
+        side time the MQTT hop.
+        """
+        if "trace_attempt" not in payload:
+            return None
+        bridge_ms = payload["trace_bridge_hold_us"] / 1000.0
+        bridge_write_ms = payload["trace_bridge_rx_ms"] + bridge_ms
+        return {
+            "attempt": payload["trace_attempt"],
+            "node_ms": payload["trace_capture_age_ms"],
+            "radio_ms": payload["trace_retry_ms"],
+            "bridge_ms": bridge_ms,
+            "serial_ms": round(self._serial_clock.hop_ms(bridge_write_ms, hub_read_ms), 3),
+            "hub_rx": hub_rx,
+        }
+
     def process_frame(self, raw_frame: bytes) -> tuple[str, dict] | None:
         """Process a single COBS-encoded frame.
 
@@ -31,10 +62,10 @@ class BridgeProcessor:
         except CobsDecodeError:
             return None
 
-        # 2. Validate frame length (38 for Phase 1, 54 for Phase 2)
+        # 2. Validate frame length (38 for Phase 1, 54 for Phase 2, 50 for thermal)
         if len(decoded) not in _VALID_FRAME_LENGTHS:
             logger.warning(
-                "Unexpected frame length %d bytes (expected 38 or 54)",
+                "Unexpected frame length %d bytes (expected 38, 50 or 54)",
                 len(decoded),
             )
             return None
@@ -51,9 +82,13 @@ class BridgeProcessor:
             payload = deserialize_payload(payload_bytes)
         except PayloadError:
             return None
+        if payload["msg_type"] == MSG_TYPE_THERMAL:
+            logger.debug("Skipping thermal array frame from hive %d", payload["hive_id"])
+            return None
 
         # 7. Set observed_at to current UTC time
         observed_at = utc_now()
+        hub_read_ms = time.monotonic() * 1000.0
 
         # 8. Build MQTT topic and JSON dict
         topic = f"waggle/{payload['hive_id']}/sensors"
@@ -78,5 +113,59 @@ class BridgeProcessor:
             for field in _TRAFFIC_FIELDS:
                 msg[field] = payload[field]
 
-        # 10. Return topic and dict
+        # 10. Latency trace for traced Phase 2 payloads
+        trace = self._trace(payload, hub_read_ms, time.time())
+        if trace is not None:
+            msg["trace"] = trace
+
+        # 11. Return topic and dict
         return topic, msg
+
+    def process_buffer(self, data: bytes) -> list[tuple[str, dict]]:
+        """Process a raw serial read containing any number of 0x00-delimited frames.
+
+        Complete frames are decoded in one call (native decoder when built)
+        and returned as (topic, payload_dict) pairs in arrival order; a
+        trailing partial frame is kept for the next call.  All frames in one
+        read share an observed_at.
+        """
+        buf = self._pending + data if self._pending else data
+        result = decode_frames(buf)
+        self._pending = bytes(buf[result.consumed:])
+        if len(self._pending) > _MAX_PENDING:
+            logger.warning("Dropping %d bytes without a frame delimiter", len(self._pending))
+            self._pending = b""
+        if result.bad_length:
+            logger.warning(
+                "%d frame(s) with unexpected length (expected 38, 50 or 54)", result.bad_length
+            )
+        if result.skipped:
+            logger.debug("Skipped %d thermal array frame(s)", result.skipped)
+
+        observed_at = utc_now()
+        hub_read_ms = time.monotonic() * 1000.0
+        hub_rx = time.time()
+        out = []
+        for frame in result.frames:
+            msg = {
+                "schema_version": 2,
+                "hive_id": frame["hive_id"],
+                "msg_type": frame["msg_type"],
+                "sequence": frame["sequence"],
+                "weight_g": frame["weight_g"],
+                "temp_c_x100": frame["temp_c_x100"],
+                "humidity_x100": frame["humidity_x100"],
+                "pressure_hpa_x10": frame["pressure_hpa_x10"],
+                "battery_mv": frame["battery_mv"],
+                "flags": frame["flags"],
+                "sender_mac": frame["sender_mac"],
+                "observed_at": observed_at,
+            }
+            if frame["msg_type"] == 0x02:
+                for field in _TRAFFIC_FIELDS:
+                    msg[field] = frame[field]
+                trace = self._trace(frame, hub_read_ms, hub_rx)
+                if trace is not None:
+                    msg["trace"] = trace
+            out.append((f"waggle/{frame['hive_id']}/sensors", msg))
+        return out
@@ -11,6 +11,8 @@ from sqlalchemy.ext.asyncio import AsyncEngine, AsyncSession
 from waggle.config import Settings
 from waggle.models import Hive, SensorReading
 from waggle.services.alert_engine import AlertEngine
+from waggle.services.latency import latency_tracker
+from waggle.services.latest_state import LatestState, seed_table
 from waggle.utils.timestamps import is_system_time_valid, utc_now, validate_observed_at
 
 logger = logging.getLogger(__name__)
@@ -44,11 +46,16 @@ class IngestionService:
     """Processes MQTT sensor messages through the validation/dedup/storage pipeline."""
 
     def __init__(
-        self, engine: AsyncEngine, settings: Settings, alert_engine: AlertEngine
+        self,
+        engine: AsyncEngine,
+        settings: Settings,
+        alert_engine: AlertEngine,
+        latest_state: LatestState | None = None,
     ):
         self.engine = engine
         self.settings = settings
         self.alert_engine = alert_engine
+        self.latest_state = latest_state  # Opened writable; see latest_state.py
         self._dedup_cache: dict[int, dict[int, float]] = {}  # hive_id -> {sequence: timestamp}
 
     async def warm_dedup_cache(self) -> None:
@@ -68,11 +75,18 @@ class IngestionService:
                     self._dedup_cache[hive_id] = {}
                 self._dedup_cache[hive_id][sequence] = time.monotonic()
 
+    async def warm_latest_state(self) -> None:
+        """Rebuild the shared-memory latest-state table from the DB on startup."""
+        if self.latest_state is not None:
+            await seed_table(self.engine, self.latest_state)
+
     async def process_message(self, topic: str, payload: dict) -> bool:
         """Process a single MQTT sensor message.
 
         Returns True if stored, False if dropped.
         """
+        received_at = time.time()
+
         # 1. System time check
         if not is_system_time_valid(self.settings.MIN_VALID_YEAR):
             logger.warning("System time invalid, dropping message")
@@ -202,6 +216,8 @@ class IngestionService:
         # 12. DB insert (INSERT OR IGNORE for MQTT redelivery dedup via unique index)
         ingested_at = utc_now()
         sender_mac = payload.get("sender_mac", "")
+        traffic_stored = False
+        db_start = time.perf_counter()
 
         async with AsyncSession(self.engine) as session:
             async with session.begin():
@@ -283,6 +299,7 @@ class IngestionService:
                                     "sender_mac": sender_mac,
                                 },
                             )
+                            traffic_stored = True
                             logger.info(
                                 "Traffic ingested: hive=%d in=%d out=%d period=%dms",
                                 hive_id,
@@ -301,19 +318,51 @@ class IngestionService:
                             hive_id,
                         )
 
-        # 15. Add traffic fields to converted dict if present
-        if payload.get("msg_type") == 2:
+        # 15. Latency of this reading's hops (the node's only if it sent a trace)
+        self._record_latency(
+            hive_id, sequence, payload.get("trace"), received_at,
+            (time.perf_counter() - db_start) * 1000.0,
+        )
+
+        # 16. Add traffic fields to converted dict if its bee_counts row was stored
+        if traffic_stored:
             converted["bees_in"] = payload.get("bees_in")
             converted["bees_out"] = payload.get("bees_out")
             converted["period_ms"] = payload.get("period_ms")
             converted["lane_mask"] = payload.get("lane_mask")
             converted["stuck_mask"] = payload.get("stuck_mask")
 
-        # 16. Trigger alert engine
+        # 17. Latest-state table for the status endpoints
+        if self.latest_state is not None:
+            self.latest_state.record(
+                hive_id, ingested_at, converted, sequence,
+                converted if traffic_stored else None,
+            )
+
+        # 18. Trigger alert engine
         await self.alert_engine.check_reading(hive_id, converted)
 
         return True
 
+    def _record_latency(
+        self, hive_id: int, sequence: int, trace, received_at: float, db_ms: float
+    ) -> None:
+        hops = {"db": db_ms}
+        info = {}
+        if isinstance(trace, dict):
+            try:
+                hops.update(
+                    node=float(trace["node_ms"]),
+                    radio=float(trace["radio_ms"]),
+                    bridge=float(trace["bridge_ms"]),
+                    serial=float(trace["serial_ms"]),
+                    mqtt=(received_at - float(trace["hub_rx"])) * 1000.0,
+                )
+                info["attempt"] = int(trace["attempt"])
+            except (KeyError, TypeError, ValueError):
+                logger.debug("Ignoring malformed trace: hive=%d seq=%d", hive_id, sequence)
+        latency_tracker.record(hive_id, sequence, hops, **info)
+
     def _validate_traffic(self, payload: dict) -> bool:
         """Validate Phase 2 traffic fields."""
         try:
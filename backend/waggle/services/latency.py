@@ -0,0 +1,160 @@
+"""Per-hop latency of sensor readings, from the node's sensor reads to the database row.
+
+Each hop is measured where it happens and carried with the reading:
+
+  node    sensor reads done -> first ESP-NOW attempt    (payload trace, node)
+  radio   first attempt -> the attempt that got through (payload trace, node)
+  bridge  ESP-NOW receive callback -> serial write      (payload trace, bridge)
+  serial  serial write -> BridgeProcessor read          (BridgeProcessor, estimated)
+  mqtt    BridgeProcessor read -> IngestionService      (wall clock, same host)
+  db      IngestionService insert transaction           (IngestionService)
+  total   sum of the hops known for the reading
+
+The node and bridge stamps live in the Phase 2 payload's reserved bytes
+(firmware/sensor/src/payload.h); BridgeProcessor turns them into the
+message's ``trace`` dict and IngestionService adds its own hops when the
+reading is stored.  Readings are correlated by ``(hive_id, sequence)``.
+
+The bridge and hub clocks are not synchronised, so the serial hop is the
+excess over the fastest transfer seen recently (see SerialClock): a queue
+building up on the serial link shows, the fixed wire time does not.
+
+``latency_tracker`` is a process-wide singleton; histograms cover the
+readings stored by this process.
+"""
+
+from __future__ import annotations
+
+import bisect
+import threading
+from collections import OrderedDict, deque
+
+from waggle.health import reading_hop_latency
+
+HOPS = ("node", "radio", "bridge", "serial", "mqtt", "db", "total")
+
+# Histogram bucket upper bounds in ms (log scale); the last bucket is open
+BUCKET_BOUNDS_MS = (
+    0.1, 0.25, 0.5, 1, 2.5, 5, 10, 25, 50, 100, 250, 500,
+    1000, 2500, 5000, 10000, 30000, 60000,
+)
+
+RECENT_TRACES = 256
+
+# Window for the serial clock offset: long enough to include a fast
+# transfer, short enough to follow the bridge crystal's drift
+SERIAL_WINDOW = 64
+
+
+class HopHistogram:
+    """Count, sum, max and log-scale buckets of one hop's latencies (ms)."""
+
+    def __init__(self) -> None:
+        self.counts = [0] * (len(BUCKET_BOUNDS_MS) + 1)
+        self.count = 0
+        self.sum_ms = 0.0
+        self.max_ms = 0.0
+
+    def add(self, ms: float) -> None:
+        self.counts[bisect.bisect_left(BUCKET_BOUNDS_MS, ms)] += 1
+        self.count += 1
+        self.sum_ms += ms
+        self.max_ms = max(self.max_ms, ms)
+
+    def percentile(self, q: float) -> float | None:
+        """Upper bound of the bucket holding the q-th percentile (max_ms for the open bucket)."""
+        if self.count == 0:
+            return None
+        rank = q / 100.0 * self.count
+        seen = 0
+        for i, n in enumerate(self.counts):
+            seen += n
+            if n and seen >= rank:
+                return BUCKET_BOUNDS_MS[i] if i < len(BUCKET_BOUNDS_MS) else self.max_ms
+        return self.max_ms
+
+    def summary(self) -> dict:
+        return {
+            "count": self.count,
+            "mean_ms": round(self.sum_ms / self.count, 3) if self.count else None,
+            "max_ms": round(self.max_ms, 3) if self.count else None,
+            "p50_ms": self.percentile(50),
+            "p95_ms": self.percentile(95),
+            "p99_ms": self.percentile(99),
+            "buckets": [
+                {"le_ms": BUCKET_BOUNDS_MS[i] if i < len(BUCKET_BOUNDS_MS) else None, "count": n}
+                for i, n in enumerate(self.counts)
+            ],
+        }
+
+
+class LatencyTracker:
+    """Per-hop histograms plus the most recent traces by (hive_id, sequence)."""
+
+    def __init__(self, recent: int = RECENT_TRACES) -> None:
+        self._lock = threading.Lock()
+        self._recent_max = recent
+        self.reset()
+
+    def reset(self) -> None:
+        with self._lock:
+            self._hops = {hop: HopHistogram() for hop in HOPS}
+            self._recent: OrderedDict[tuple[int, int], dict] = OrderedDict()
+
+    def record(self, hive_id: int, sequence: int, hops: dict[str, float], **info) -> dict:
+        """Add one stored reading's hop latencies (ms); returns the trace kept for it.
+
+        Unknown hop names are ignored; ``total`` is the sum of the known
+        hops.  ``info`` (e.g. the transmit attempt) is kept with the trace.
+        """
+        hops = {hop: max(float(ms), 0.0) for hop, ms in hops.items() if hop in HOPS[:-1]}
+        hops["total"] = sum(hops.values())
+        trace = {"hive_id": hive_id, "sequence": sequence, **info, "hops_ms": hops}
+        with self._lock:
+            for hop, ms in hops.items():
+                self._hops[hop].add(ms)
+            key = (hive_id, sequence)
+            self._recent.pop(key, None)
+            self._recent[key] = trace
+            while len(self._recent) > self._recent_max:
+                self._recent.popitem(last=False)
+        for hop, ms in hops.items():
+            reading_hop_latency.labels(hop=hop).observe(ms / 1000.0)
+        return trace
+
+    def trace(self, hive_id: int, sequence: int) -> dict | None:
+        with self._lock:
+            return self._recent.get((hive_id, sequence))
+
+    def summary(self, recent: int = 20) -> dict:
+        with self._lock:
+            traces = list(self._recent.values())[-recent:] if recent > 0 else []
+            return {
+                "hops": {hop: h.summary() for hop, h in self._hops.items()},
+                "recent": list(reversed(traces)),
+            }
+
+
+class SerialClock:
+    """Serial hop estimate from the bridge's millis() and the hub's monotonic clock.
+
+    The offset between the clocks is taken as the smallest
+    (hub_read - bridge_write) over the last SERIAL_WINDOW frames; each
+    frame's hop is its excess over that.  A bridge clock that goes
+    backwards (restart, 49-day wrap) starts the window again.
+    """
+
+    def __init__(self, window: int = SERIAL_WINDOW) -> None:
+        self._samples: deque[float] = deque(maxlen=window)
+        self._last_bridge_ms: float | None = None
+
+    def hop_ms(self, bridge_write_ms: float, hub_read_ms: float) -> float:
+        if self._last_bridge_ms is not None and bridge_write_ms < self._last_bridge_ms:
+            self._samples.clear()
+        self._last_bridge_ms = bridge_write_ms
+        sample = hub_read_ms - bridge_write_ms
+        self._samples.append(sample)
+        return sample - min(self._samples)
+
+
+latency_tracker = LatencyTracker()
@@ -0,0 +1,206 @@
+"""Shared-memory table of each hive's latest reading and traffic.
+
+The ingestion path (ingestd, or IngestionService) merges every committed
+reading into a fixed-layout table at LATEST_STATE_PATH (a file under
+/dev/shm) through the native ``waggle._latest`` module
+(backend/native/latest), and the hives and hub status endpoints read each
+hive's newest sensor_readings and bee_counts rows from it in O(1) instead
+of running a row_number() window over SQLite.  Slots are sequence-locked,
+so a reader never waits for the writer.
+
+A writer empties the table when it starts, rebuilds it from SQLite
+(seed_table) and only then marks it seeded.  Readers use the table only
+when it is seeded and every slot they need reads consistently; otherwise,
+or without the native module, the endpoints query SQLite as before.
+"""
+
+import logging
+import os
+import time
+
+from sqlalchemy import text
+from sqlalchemy.ext.asyncio import AsyncEngine, AsyncSession
+
+try:
+    if os.environ.get("WAGGLE_NATIVE_LATEST", "1") == "0":
+        raise ImportError("native latest-state table disabled")
+    from waggle import _latest
+except ImportError:
+    _latest = None
+
+logger = logging.getLogger(__name__)
+
+NATIVE_AVAILABLE = _latest is not None
+
+# A reader retries opening a table the writer has not created yet
+REOPEN_SEC = 5.0
+
+_SEED_READINGS_SQL = (
+    "SELECT hive_id, observed_at, weight_kg, temp_c, humidity_pct, pressure_hpa, "
+    "battery_v, flags, sequence FROM ("
+    "  SELECT *, row_number() OVER (PARTITION BY hive_id ORDER BY observed_at DESC) AS rn "
+    "  FROM sensor_readings"
+    ") WHERE rn = 1"
+)
+_SEED_TRAFFIC_SQL = (
+    "SELECT hive_id, observed_at, bees_in, bees_out, period_ms, lane_mask, stuck_mask FROM ("
+    "  SELECT *, row_number() OVER (PARTITION BY hive_id ORDER BY observed_at DESC) AS rn "
+    "  FROM bee_counts"
+    ") WHERE rn = 1"
+)
+_SEED_INGESTED_SQL = "SELECT hive_id, MAX(ingested_at) FROM sensor_readings GROUP BY hive_id"
+
+
+class LatestState:
+    """The table at one path, mapped on first use."""
+
+    def __init__(self, path: str, *, writable: bool = False):
+        self.path = path
+        self.writable = writable
+        self._table = None
+        self._next_open = 0.0
+
+    def table(self):
+        """The mapped table, or None if it cannot be opened (yet)."""
+        if self._table is None and time.monotonic() >= self._next_open:
+            try:
+                self._table = _latest.Table(self.path, writable=self.writable)
+            except OSError as exc:
+                self._next_open = time.monotonic() + REOPEN_SEC
+                logger.debug("Latest-state table unavailable: %s", exc)
+        return self._table
+
+    def _seeded_table(self):
+        table = self.table()
+        return table if table is not None and table.seeded() else None
+
+    # ---- readers ----
+
+    def hives(self, hive_ids: list[int]) -> dict[int, tuple[dict | None, dict | None]] | None:
+        """(latest reading, latest traffic) per hive, or None to use SQLite.
+
+        The dicts carry the LatestReading / LatestTrafficOut fields; either
+        is None when the hive has no such row.
+        """
+        table = self._seeded_table()
+        if table is None:
+            return None
+        result = {}
+        for hive_id in hive_ids:
+            if not 0 <= hive_id < _latest.SLOTS:
+                return None
+            state = table.read(hive_id)
+            if state is None:
+                return None
+            _, reading, traffic = state
+            result[hive_id] = (_reading_dict(reading), _traffic_dict(traffic))
+        return result
+
+    def hub(self) -> tuple[str | None, int] | None:
+        """(last_ingest_at, stuck_lanes_total) over every hive, or None."""
+        table = self._seeded_table()
+        if table is None:
+            return None
+        states = table.read_all()
+        if states is None:
+            return None
+        last_ingest = None
+        stuck_lanes = 0
+        for _, ingested_at, _, traffic in states:
+            if ingested_at is not None and (last_ingest is None or ingested_at > last_ingest):
+                last_ingest = ingested_at
+            if traffic is not None:
+                stuck_lanes += bin(traffic[5]).count("1")
+        return last_ingest, stuck_lanes
+
+    # ---- writer ----
+
+    def record(
+        self, hive_id: int, ingested_at: str, converted: dict, sequence: int, traffic: dict | None
+    ) -> None:
+        """Merge one committed reading (IngestionService's converted dict)."""
+        table = self.table()
+        if table is None:
+            return
+        reading = (
+            converted["observed_at"],
+            converted["weight_kg"],
+            converted["temp_c"],
+            converted["humidity_pct"],
+            converted["pressure_hpa"],
+            converted["battery_v"],
+            converted["flags"],
+            sequence,
+        )
+        bc = None
+        if traffic is not None:
+            bc = (
+                converted["observed_at"],
+                traffic["bees_in"],
+                traffic["bees_out"],
+                traffic["period_ms"],
+                traffic["lane_mask"],
+                traffic["stuck_mask"],
+            )
+        if not table.update(hive_id, ingested_at, reading, bc):
+            logger.warning("Latest-state slot for hive %d stayed locked", hive_id)
+
+
+async def seed_table(engine: AsyncEngine, state: LatestState) -> bool:
+    """Rebuild the table from SQLite and mark it seeded.
+
+    The table is emptied before SQLite is read, so a reading another writer
+    commits meanwhile is either in the query or merged after the reset.
+    """
+    table = state.table()
+    if table is None:
+        return False
+    table.reset()
+    async with AsyncSession(engine) as session:
+        readings = (await session.execute(text(_SEED_READINGS_SQL))).all()
+        traffic = (await session.execute(text(_SEED_TRAFFIC_SQL))).all()
+        ingested = (await session.execute(text(_SEED_INGESTED_SQL))).all()
+    for hive_id, *row in readings:
+        table.update(hive_id, None, tuple(row), None)
+    for hive_id, *row in traffic:
+        table.update(hive_id, None, None, tuple(row))
+    for hive_id, ingested_at in ingested:
+        table.update(hive_id, ingested_at, None, None)
+    table.mark_seeded()
+    logger.info("Latest-state table seeded: %d hives", len(readings))
+    return True
+
+
+def open_latest_state(path: str, *, writable: bool = False) -> LatestState | None:
+    """LatestState for path, or None if unset or the native module is not built."""
+    if not path or _latest is None:
+        return None
+    return LatestState(path, writable=writable)
+
+
+def _reading_dict(reading) -> dict | None:
+    if reading is None:
+        return None
+    observed_at, weight_kg, temp_c, humidity_pct, pressure_hpa, battery_v, flags, _ = reading
+    return {
+        "weight_kg": weight_kg,
+        "temp_c": temp_c,
+        "humidity_pct": humidity_pct,
+        "pressure_hpa": pressure_hpa,
+        "battery_v": battery_v,
+        "observed_at": observed_at,
+        "flags": flags,
+    }
+
+
+def _traffic_dict(traffic) -> dict | None:
+    if traffic is None:
+        return None
+    observed_at, bees_in, bees_out, _, _, _ = traffic
+    return {
+        "observed_at": observed_at,
+        "bees_in": bees_in,
+        "bees_out": bees_out,
+        "net_out": bees_out - bees_in,
+        "total_traffic": bees_in + bees_out,
+    }
@@ -0,0 +1,74 @@
+"""Native photo pre-processing for the ML worker.
+
+Given a photo path, ultralytics decodes the full-size JPEG with OpenCV,
+letterboxes it to the model input and converts it to a float tensor, and
+on a Pi that costs about as much as YOLOv8-nano itself.  The native
+``waggle._preprocess`` module (backend/native/preprocess) does the same in
+one pass: libjpeg-turbo decodes at a DCT-domain scale near the input size,
+and SSE2/NEON kernels resize into the padded planar canvas and normalise
+it.  The worker feeds the result to the model as a ready BCHW tensor, which
+ultralytics uses as is, and maps the boxes back to photo pixels.
+
+Without the module (or with WAGGLE_NATIVE_PREPROCESS=0) the worker passes
+the photo path to the model as before.
+"""
+
+import os
+from dataclasses import dataclass
+
+try:
+    if os.environ.get("WAGGLE_NATIVE_PREPROCESS", "1") == "0":
+        raise ImportError("native pre-processing disabled")
+    from waggle import _preprocess
+except ImportError:
+    _preprocess = None
+
+NATIVE_AVAILABLE = _preprocess is not None
+
+# YOLOv8's default imgsz; the model was trained at this size
+INPUT_SIZE = 640
+
+
+@dataclass(frozen=True)
+class Letterboxed:
+    """A photo as a planar size x size model input, and where it sits in it."""
+
+    data: bytearray
+    size: int
+    dtype: str
+    orig_w: int
+    orig_h: int
+    scale: float
+    pad_x: int
+    pad_y: int
+
+    def tensor(self):
+        """The input as a (1, 3, size, size) torch tensor sharing data."""
+        import torch
+
+        dtypes = {"float32": torch.float32, "int8": torch.int8, "uint8": torch.uint8}
+        return torch.frombuffer(self.data, dtype=dtypes[self.dtype]).view(
+            1, 3, self.size, self.size
+        )
+
+    def to_original(self, bbox: list[float]) -> list[float]:
+        """Map an [x1, y1, x2, y2] box in input pixels back to the photo."""
+        x1, y1, x2, y2 = bbox
+        return [
+            min(max((x1 - self.pad_x) / self.scale, 0.0), float(self.orig_w)),
+            min(max((y1 - self.pad_y) / self.scale, 0.0), float(self.orig_h)),
+            min(max((x2 - self.pad_x) / self.scale, 0.0), float(self.orig_w)),
+            min(max((y2 - self.pad_y) / self.scale, 0.0), float(self.orig_h)),
+        ]
+
+
+def letterbox_jpeg(jpeg: bytes, size: int = INPUT_SIZE, dtype: str = "float32") -> Letterboxed:
+    """Decode and letterbox a JPEG.  ValueError if it cannot be decoded."""
+    data, orig_w, orig_h, scale, pad_x, pad_y = _preprocess.letterbox(jpeg, size, dtype)
+    return Letterboxed(data, size, dtype, orig_w, orig_h, scale, pad_x, pad_y)
+
+
+def letterbox_file(path: str, size: int = INPUT_SIZE, dtype: str = "float32") -> Letterboxed:
+    """letterbox_jpeg() of the file at path."""
+    with open(path, "rb") as f:
+        return letterbox_jpeg(f.read(), size, dtype)
@@ -13,6 +13,7 @@ from sqlalchemy.ext.asyncio import AsyncSession
 
 from waggle.database import create_engine_from_url, init_db
 from waggle.models import MlDetection, Photo
+from waggle.services import ml_preprocess
 from waggle.utils.timestamps import utc_now
 
 logger = logging.getLogger(__name__)
@@ -59,10 +60,23 @@ def load_model(model_path: str, expected_hash: str | None = None):
     return model
 
 
-def _parse_detections(results, model) -> list[dict]:
+def _run_model(model, full_path: str, preprocess: bool):
+    """Run the model on one photo; returns (results, Letterboxed or None).
+
+    With preprocess the photo is decoded and letterboxed natively and the
+    model gets the input tensor, so its boxes are in input pixels.
+    """
+    if not preprocess:
+        return model(full_path, verbose=False), None
+    letterboxed = ml_preprocess.letterbox_file(full_path)
+    return model(letterboxed.tensor(), verbose=False), letterboxed
+
+
+def _parse_detections(results, model, letterboxed=None) -> list[dict]:
     """Parse YOLO results into a list of detection dicts.
 
     Each detection has: class (str), confidence (float), bbox ([x1, y1, x2, y2]).
+    Boxes are in photo pixels; letterboxed maps them back from model input.
     """
     detections = []
     if not results or len(results) == 0:
@@ -82,6 +96,8 @@ def _parse_detections(results, model) -> list[dict]:
         conf = float(confs[i]) if not isinstance(confs[i], float) else confs[i]
         bbox_raw = bboxes[i]
         bbox = [float(v) for v in bbox_raw] if not isinstance(bbox_raw, list) else bbox_raw
+        if letterboxed is not None:
+            bbox = letterboxed.to_original(bbox)
 
         class_name = names.get(cls_id, f"class_{cls_id}")
         detections.append(
@@ -124,10 +140,13 @@ async def process_one(
     photo_dir: str,
     confidence_threshold: float = 0.25,
     model_path: str | None = None,
+    preprocess: bool = False,
 ) -> int | None:
     """Process one pending photo through ML inference.
 
-    Returns the photo ID if processed, None if nothing to do or claimed by another worker.
+    With preprocess the photo is pre-processed natively (ml_preprocess)
+    instead of by the model.  Returns the photo ID if processed, None if
+    nothing to do or claimed by another worker.
     """
     async with AsyncSession(engine) as session:
         # 1. Query for next pending photo
@@ -169,14 +188,16 @@ async def process_one(
     full_path = os.path.join(photo_dir, photo_path)
 
     try:
-        # Time the inference
+        # Time the inference (including decode and pre-processing)
         t_start = time.monotonic()
-        results = await asyncio.to_thread(model, str(full_path), verbose=False)
+        results, letterboxed = await asyncio.to_thread(
+            _run_model, model, str(full_path), preprocess
+        )
         t_end = time.monotonic()
         inference_ms = max(1, int((t_end - t_start) * 1000))
 
         # 4. Parse all detections (raw, before filtering)
-        all_detections = _parse_detections(results, model)
+        all_detections = _parse_detections(results, model, letterboxed)
 
         # 5. Compute varroa_max_confidence from ALL detections (before filtering)
         varroa_confs = [d["confidence"] for d in all_detections if d["class"] == "varroa"]
@@ -290,6 +311,7 @@ async def run_worker(
     confidence_threshold: float = 0.25,
     poll_interval: float = 2.0,
     max_iterations: int | None = None,
+    native_preprocess: bool = True,
 ) -> None:
     """Main entry point that runs the polling loop.
 
@@ -301,8 +323,11 @@ async def run_worker(
         confidence_threshold: Minimum confidence to include a detection.
         poll_interval: Seconds to sleep when no pending photos found.
         max_iterations: Stop after N iterations (for testing). None = run forever.
+        native_preprocess: Pre-process photos natively when waggle._preprocess is built.
     """
     logger.info("Starting ML worker: model=%s photo_dir=%s", model_path, photo_dir)
+    preprocess = native_preprocess and ml_preprocess.NATIVE_AVAILABLE
+    logger.info("Photo pre-processing: %s", "native" if preprocess else "ultralytics")
 
     model = load_model(model_path, expected_hash=expected_hash)
 
@@ -330,6 +355,7 @@ async def run_worker(
                 photo_dir,
                 confidence_threshold=confidence_threshold,
                 model_path=model_path,
+                preprocess=preprocess,
             )
 
             if result is None:
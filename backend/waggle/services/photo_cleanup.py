@@ -62,10 +62,14 @@ async def _quarantine_orphan_files(engine, photo_dir: str) -> int:
     quarantine_dir = os.path.join(photo_dir, ".quarantine")
     count = 0
 
-    # Get all photo_path values from DB
+    # Get all photo_path / thumbnail_path values from DB
     async with AsyncSession(engine) as session:
-        result = await session.execute(select(Photo.photo_path))
-        db_paths = {row[0] for row in result.all()}
+        result = await session.execute(select(Photo.photo_path, Photo.thumbnail_path))
+        db_paths = set()
+        for photo_path, thumbnail_path in result.all():
+            db_paths.add(photo_path)
+            if thumbnail_path:
+                db_paths.add(thumbnail_path)
 
     # Walk filesystem looking for .jpg files
     for dirpath, _dirnames, filenames in os.walk(photo_dir):
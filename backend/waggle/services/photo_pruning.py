@@ -66,6 +66,15 @@ async def prune_photos(
                     logger.warning("Failed to delete photo file: %s", full_path)
                     continue
 
+            # Thumbnail is best-effort; cleanup quarantines any leftover
+            if photo.thumbnail_path:
+                thumb_path = os.path.join(photo_dir, photo.thumbnail_path)
+                if os.path.exists(thumb_path):
+                    try:
+                        os.unlink(thumb_path)
+                    except OSError:
+                        logger.warning("Failed to delete thumbnail file: %s", thumb_path)
+
             # Delete DB row (CASCADE deletes ml_detections)
             await session.execute(
                 text("DELETE FROM photos WHERE id = :id"),
@@ -0,0 +1,412 @@
+"""Compressed time-series store for raw readings and traffic.
+
+``python -m waggle tsstore`` copies each hive's readings (with their
+bee_counts row joined in) from SQLite into TSSTORE_DIR in sealed blocks of
+BLOCK_ROWS rows, using the native ``waggle._tsstore`` engine
+(backend/native/tsstore): per-column delta / delta-of-delta coding packed
+with Stream VByte, one append-only file per hive that the API mmaps.
+Only full blocks are sealed, so a hive's store always holds exactly its
+readings up to a high-water id.
+
+The raw readings and raw traffic endpoints serve stored rows from the
+store and the rows above the high-water id ("fresh" rows) from SQLite.
+SQLite stays the source of truth: whenever the two cannot be combined
+exactly (a filter bound that is not a timestamp prefix, fresh rows older
+than stored ones, or no native engine) the query goes to SQLite as before.
+"""
+
+import asyncio
+import logging
+import os
+import re
+from datetime import UTC, datetime, timedelta
+
+from sqlalchemy import text
+from sqlalchemy.ext.asyncio import AsyncEngine, AsyncSession
+
+from waggle.database import create_engine_from_url, init_db
+
+try:
+    if os.environ.get("WAGGLE_NATIVE_TSSTORE", "1") == "0":
+        raise ImportError("native time-series store disabled")
+    from waggle import _tsstore
+except ImportError:
+    _tsstore = None
+
+logger = logging.getLogger(__name__)
+
+NATIVE_AVAILABLE = _tsstore is not None
+BLOCK_ROWS = _tsstore.BLOCK_ROWS if _tsstore is not None else 512
+
+# Unbounded query limits, ms since the epoch
+T_MIN = -(2**62)
+T_MAX = 2**62
+
+_EPOCH = datetime(1970, 1, 1, tzinfo=UTC)
+_CANONICAL = re.compile(r"^\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}\.\d{3}Z$")
+# Smallest value of every position, for padding a prefix bound
+_BOUND_TEMPLATE = "0000-01-01T00:00:00.000Z"
+# Prefixes ending inside a month or day could pad to the wrong month/day
+_PARTIAL_FIELD_LENGTHS = {6, 9}
+
+
+def open_store(path: str):
+    """Open the store at path, or None if unset or the engine is not built."""
+    if not path or _tsstore is None:
+        return None
+    os.makedirs(path, exist_ok=True)
+    return _tsstore.Store(path)
+
+
+def iso_to_ms(value: str) -> int | None:
+    """Canonical observed_at (YYYY-MM-DDTHH:MM:SS.mmmZ) to ms, else None."""
+    if not isinstance(value, str) or not _CANONICAL.match(value):
+        return None
+    try:
+        dt = datetime.strptime(value, "%Y-%m-%dT%H:%M:%S.%fZ").replace(tzinfo=UTC)
+    except ValueError:
+        return None
+    return (dt - _EPOCH) // timedelta(milliseconds=1)
+
+
+def bound_to_ms(bound: str, *, upper: bool) -> int | None:
+    """Inclusive ms bound selecting the same rows as SQLite's string filter.
+
+    ``observed_at >= bound`` / ``observed_at <= bound`` compare strings, so
+    a prefix such as ``2026-02-08`` or ``2026-02-08T12:00`` works as a
+    bound.  A prefix selects from its smallest completion (lower bound) or
+    up to just before it (upper bound, as every completion is longer and
+    so sorts after it).  Returns None for anything else; the caller then
+    queries SQLite.
+    """
+    length = len(bound)
+    if length == 0 or length > len(_BOUND_TEMPLATE) or length in _PARTIAL_FIELD_LENGTHS:
+        return None
+    ms = iso_to_ms(bound + _BOUND_TEMPLATE[length:])
+    if ms is None:
+        return None
+    if upper and length < len(_BOUND_TEMPLATE):
+        return ms - 1
+    return ms
+
+
+def _query_bounds(start: str | None, end: str | None) -> tuple[int, int] | None:
+    t_from = T_MIN if start is None else bound_to_ms(start, upper=False)
+    t_to = T_MAX if end is None else bound_to_ms(end, upper=True)
+    if t_from is None or t_to is None:
+        return None
+    return t_from, t_to
+
+
+def _range_sql(column: str, start: str | None, end: str | None, params: dict) -> str:
+    clauses = ""
+    if start is not None:
+        clauses += f" AND {column} >= :start"
+        params["start"] = start
+    if end is not None:
+        clauses += f" AND {column} <= :end"
+        params["end"] = end
+    return clauses
+
+
+# --- Queries ---
+
+READING_COLUMNS = (
+    "id",
+    "observed_at",
+    "weight_kg",
+    "temp_c",
+    "humidity_pct",
+    "pressure_hpa",
+    "battery_v",
+    "sequence",
+    "flags",
+)
+TRAFFIC_COLUMNS = (
+    "id",
+    "reading_id",
+    "observed_at",
+    "period_ms",
+    "bees_in",
+    "bees_out",
+    "lane_mask",
+    "stuck_mask",
+    "flags",
+)
+
+
+def _reading_dict(hive_id: int, row) -> dict:
+    d = dict(zip(READING_COLUMNS, row, strict=True))
+    d["hive_id"] = hive_id
+    return d
+
+
+def _traffic_dict(hive_id: int, row) -> dict:
+    d = dict(zip(TRAFFIC_COLUMNS, row, strict=True))
+    d["hive_id"] = hive_id
+    d["net_out"] = d["bees_out"] - d["bees_in"]
+    d["total_traffic"] = d["bees_in"] + d["bees_out"]
+    return d
+
+
+def _hive_info(store, hive_id: int) -> dict | None:
+    try:
+        info = store.info(hive_id)
+    except OSError:
+        logger.exception("Time-series store unreadable for hive %d", hive_id)
+        return None
+    return info if info["blocks"] else None
+
+
+def _store_page(store_query, offset: int, limit: int) -> tuple[int, list] | None:
+    try:
+        return store_query(offset, limit)
+    except OSError:
+        logger.exception("Time-series store query failed")
+        return None
+
+
+async def _combine(
+    session: AsyncSession,
+    store_query,
+    fresh_sql: str,
+    params: dict,
+    info: dict,
+    newest_first: bool,
+    limit: int,
+    offset: int,
+) -> tuple[int, list] | None:
+    """Page over stored rows plus fresh rows; None if they interleave.
+
+    fresh_sql selects the fresh rows in range; it is wrapped for the count
+    and for the page.  Fresh rows have larger ids than every stored row, so
+    when none is older than the newest stored row they sort after all of
+    them and the page is plain offset arithmetic.  Store errors are logged
+    and also return None, so a damaged file degrades to SQLite.
+    """
+    result = await session.execute(
+        text(f"SELECT COUNT(*), MIN(observed_at) FROM ({fresh_sql})"), params
+    )
+    fresh_total, fresh_oldest = result.one()
+    if fresh_total:
+        oldest = iso_to_ms(fresh_oldest)
+        if oldest is None or oldest < info["t_max"]:
+            return None
+
+    order = "DESC" if newest_first else "ASC"
+    page_sql = f"SELECT * FROM ({fresh_sql}) ORDER BY observed_at {order} LIMIT :lim OFFSET :off"
+
+    if newest_first:
+        fresh_rows = []
+        if offset < fresh_total:
+            result = await session.execute(text(page_sql), {**params, "lim": limit, "off": offset})
+            fresh_rows = [tuple(r) for r in result]
+        stored = _store_page(store_query, max(0, offset - fresh_total), limit - len(fresh_rows))
+        if stored is None:
+            return None
+        stored_total, stored_rows = stored
+        return stored_total + fresh_total, fresh_rows + stored_rows
+
+    stored = _store_page(store_query, offset, limit)
+    if stored is None:
+        return None
+    stored_total, stored_rows = stored
+    fresh_rows = []
+    remaining = limit - len(stored_rows)
+    fresh_offset = max(0, offset - stored_total)
+    if remaining > 0 and fresh_offset < fresh_total:
+        result = await session.execute(
+            text(page_sql), {**params, "lim": remaining, "off": fresh_offset}
+        )
+        fresh_rows = [tuple(r) for r in result]
+    return stored_total + fresh_total, stored_rows + fresh_rows
+
+
+async def query_readings(
+    store,
+    session: AsyncSession,
+    hive_id: int,
+    start: str | None,
+    end: str | None,
+    limit: int,
+    offset: int,
+) -> tuple[int, list[dict]] | None:
+    """Raw readings newest first, as (total, ReadingOut dicts); None = use SQLite."""
+    bounds = _query_bounds(start, end)
+    if bounds is None:
+        return None
+    info = _hive_info(store, hive_id)
+    if info is None:
+        return None
+
+    params = {"hive_id": hive_id, "hwm": info["high_water_id"]}
+    fresh_sql = (
+        f"SELECT {', '.join(READING_COLUMNS)} FROM sensor_readings "
+        "WHERE hive_id = :hive_id AND id > :hwm" + _range_sql("observed_at", start, end, params)
+    )
+
+    def store_query(off: int, lim: int):
+        return store.readings(hive_id, bounds[0], bounds[1], off, lim, descending=True)
+
+    combined = await _combine(session, store_query, fresh_sql, params, info, True, limit, offset)
+    if combined is None:
+        return None
+    total, rows = combined
+    return total, [_reading_dict(hive_id, r) for r in rows]
+
+
+async def query_traffic(
+    store,
+    session: AsyncSession,
+    hive_id: int,
+    start: str | None,
+    end: str | None,
+    order: str,
+    limit: int,
+    offset: int,
+) -> tuple[int, list[dict]] | None:
+    """Raw traffic records, as (total, TrafficRecordOut dicts); None = use SQLite."""
+    bounds = _query_bounds(start, end)
+    if bounds is None:
+        return None
+    info = _hive_info(store, hive_id)
+    if info is None:
+        return None
+
+    params = {"hive_id": hive_id, "hwm": info["high_water_id"]}
+    columns = ", ".join(f"b.{c}" for c in TRAFFIC_COLUMNS)
+    fresh_sql = (
+        f"SELECT {columns} FROM sensor_readings r JOIN bee_counts b ON b.reading_id = r.id "
+        "WHERE r.hive_id = :hive_id AND r.id > :hwm"
+        + _range_sql("b.observed_at", start, end, params)
+    )
+    newest_first = order != "asc"
+
+    def store_query(off: int, lim: int):
+        return store.traffic(hive_id, bounds[0], bounds[1], off, lim, descending=newest_first)
+
+    combined = await _combine(
+        session, store_query, fresh_sql, params, info, newest_first, limit, offset
+    )
+    if combined is None:
+        return None
+    total, rows = combined
+    return total, [_traffic_dict(hive_id, r) for r in rows]
+
+
+# --- Exporter ---
+
+EXPORT_SQL = (
+    "SELECT r.id, r.observed_at, r.weight_kg, r.temp_c, r.humidity_pct, r.pressure_hpa, "
+    "r.battery_v, r.sequence, r.flags, b.id, b.observed_at, b.flags, b.period_ms, "
+    "b.bees_in, b.bees_out, b.lane_mask, b.stuck_mask "
+    "FROM sensor_readings r LEFT JOIN bee_counts b ON b.reading_id = r.id "
+    "WHERE r.hive_id = :hive_id AND r.id > :after ORDER BY r.id LIMIT :limit"
+)
+
+
+def _export_row(row) -> tuple | None:
+    """Row tuple for Store.append, or None if the store cannot hold it exactly."""
+    (rid, observed_at, weight, temp, hum, pres, batt, seq, flags,
+     bc_id, bc_observed_at, bc_flags, period, bees_in, bees_out, lane, stuck) = row
+    t_ms = iso_to_ms(observed_at)
+    if t_ms is None:
+        return None
+    if bc_id is None:
+        traffic = (None, 0, 0, 0, 0, 0)
+    elif bc_observed_at != observed_at or bc_flags != flags:
+        return None  # The store keeps one timestamp and flags byte per row
+    else:
+        traffic = (bc_id, period, bees_in, bees_out, lane, stuck)
+    return (rid, t_ms, weight, temp, hum, pres, batt, seq, flags, *traffic)
+
+
+async def export_hive(engine: AsyncEngine, store, hive_id: int) -> int:
+    """Seal every full block of the hive's unexported readings; returns rows sealed.
+
+    Stops at a block holding a row the store cannot represent (a
+    non-canonical observed_at); that hive's newer rows stay on SQLite.
+    """
+    sealed = 0
+    while True:
+        after = store.info(hive_id)["high_water_id"]
+        async with AsyncSession(engine) as session:
+            result = await session.execute(
+                text(EXPORT_SQL), {"hive_id": hive_id, "after": after, "limit": BLOCK_ROWS}
+            )
+            rows = result.all()
+        if len(rows) < BLOCK_ROWS:
+            return sealed
+        block = [_export_row(r) for r in rows]
+        if any(r is None for r in block):
+            bad = next(rows[i][0] for i, r in enumerate(block) if r is None)
+            logger.warning("Hive %d: reading %d cannot be stored; export paused", hive_id, bad)
+            return sealed
+        store.append(hive_id, block)
+        sealed += len(block)
+
+
+async def export_all(engine: AsyncEngine, store, skip: frozenset[int] = frozenset()) -> int:
+    async with AsyncSession(engine) as session:
+        result = await session.execute(text("SELECT id FROM hives ORDER BY id"))
+        hive_ids = list(result.scalars())
+    sealed = 0
+    for hive_id in hive_ids:
+        if hive_id not in skip:
+            sealed += await export_hive(engine, store, hive_id)
+    return sealed
+
+
+async def check_consistency(engine: AsyncEngine, store) -> list[int]:
+    """Hives whose stored row count differs from SQLite up to the high-water id.
+
+    A mismatch means the database was replaced or restored under the store;
+    delete the hive's file to rebuild it.
+    """
+    bad = []
+    async with AsyncSession(engine) as session:
+        hive_ids = list((await session.execute(text("SELECT id FROM hives"))).scalars())
+        for hive_id in hive_ids:
+            info = store.info(hive_id)
+            if info["blocks"] == 0:
+                continue
+            count = (
+                await session.execute(
+                    text(
+                        "SELECT COUNT(*) FROM sensor_readings "
+                        "WHERE hive_id = :hive_id AND id <= :hwm"
+                    ),
+                    {"hive_id": hive_id, "hwm": info["high_water_id"]},
+                )
+            ).scalar_one()
+            if count != info["rows"]:
+                bad.append(hive_id)
+    return bad
+
+
+async def run_exporter(db_url: str, store_dir: str, interval_sec: int) -> None:
+    """Seal full blocks every interval_sec until cancelled."""
+    store = open_store(store_dir)
+    if store is None:
+        raise RuntimeError(
+            "TSSTORE_DIR is unset or waggle._tsstore is not built (pip install -e .)"
+        )
+    engine = create_engine_from_url(db_url, is_worker=True)
+    await init_db(engine)
+    try:
+        mismatched = await check_consistency(engine, store)
+        for hive_id in mismatched:
+            logger.error(
+                "Hive %d: store does not match the database; remove %s/hive_%d.wts to rebuild",
+                hive_id,
+                store_dir,
+                hive_id,
+            )
+        skip = frozenset(mismatched)
+        while True:
+            sealed = await export_all(engine, store, skip)
+            if sealed:
+                logger.info("Sealed %d readings into %s", sealed, store_dir)
+            await asyncio.sleep(interval_sec)
+    finally:
+        await engine.dispose()
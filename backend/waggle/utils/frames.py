@@ -0,0 +1,87 @@
+"""Buffer-at-a-time decoding of the bridge serial stream.
+
+The stream is a sequence of ``[COBS(MAC + payload)][0x00]`` frames.
+``decode_frames`` splits a read buffer on the delimiters and returns the
+valid frames as dicts (``deserialize_payload`` fields plus ``sender_mac``)
+together with how many bytes were consumed; anything after the last
+delimiter is a partial frame to prepend to the next read.  Valid thermal
+array frames (msg_type 0x04) are not readings: they are counted as skipped
+rather than returned or rejected.
+
+The native ``waggle._frames`` extension (backend/native, built by setup.py
+from the firmware's COBS and payload code) is used when it is installed;
+the pure-Python path below is the fallback and the reference behaviour.
+Set ``WAGGLE_NATIVE_FRAMES=0`` to force the fallback.
+"""
+
+import os
+from typing import NamedTuple
+
+from waggle.utils.cobs import CobsDecodeError, cobs_decode
+from waggle.utils.payload import MSG_TYPE_THERMAL, PayloadError, deserialize_payload
+
+try:
+    if os.environ.get("WAGGLE_NATIVE_FRAMES", "1") == "0":
+        raise ImportError("native frame decoder disabled")
+    from waggle import _frames
+except ImportError:
+    _frames = None
+
+NATIVE_AVAILABLE = _frames is not None
+
+_MAC_LENGTH = 6
+_VALID_FRAME_LENGTHS = {38, 50, 54}
+
+
+class DecodeResult(NamedTuple):
+    frames: list[dict]
+    consumed: int  # Bytes up to and including the last delimiter
+    invalid: int  # Non-empty frames rejected (COBS, length, CRC or msg_type)
+    bad_length: int  # ... of which had an unexpected decoded length
+    skipped: int = 0  # Valid frames that are not readings (thermal array)
+
+
+def decode_frames_py(buf: bytes) -> DecodeResult:
+    """Pure-Python reference decoder (same results as the native one)."""
+    frames: list[dict] = []
+    invalid = 0
+    bad_length = 0
+    skipped = 0
+    consumed = buf.rfind(b"\x00") + 1
+    if consumed == 0:
+        return DecodeResult(frames, 0, 0, 0, 0)
+
+    for raw in bytes(buf[: consumed - 1]).split(b"\x00"):
+        if not raw:
+            continue
+        try:
+            decoded = cobs_decode(raw)
+        except CobsDecodeError:
+            invalid += 1
+            continue
+        if len(decoded) not in _VALID_FRAME_LENGTHS:
+            invalid += 1
+            bad_length += 1
+            continue
+        try:
+            payload = deserialize_payload(bytes(decoded[_MAC_LENGTH:]))
+        except PayloadError:
+            invalid += 1
+            continue
+        if payload["msg_type"] == MSG_TYPE_THERMAL:
+            skipped += 1
+            continue
+        payload["sender_mac"] = ":".join(f"{b:02X}" for b in decoded[:_MAC_LENGTH])
+        frames.append(payload)
+
+    return DecodeResult(frames, consumed, invalid, bad_length, skipped)
+
+
+def decode_frames_native(buf: bytes) -> DecodeResult:
+    """Native decoder; raises RuntimeError if the extension is not built."""
+    if _frames is None:
+        raise RuntimeError("waggle._frames is not built")
+    return DecodeResult(*_frames.decode(buf))
+
+
+decode_frames = decode_frames_native if NATIVE_AVAILABLE else decode_frames_py
@@ -1,4 +1,8 @@
-"""Binary payload deserializer for ESP32 sensor frames (32-byte Phase 1, 48-byte Phase 2)."""
+"""Binary payload deserializer for ESP32 sensor frames.
+
+32-byte Phase 1 and 48-byte Phase 2 readings, and the 44-byte brood thermal
+array (msg_type 0x04) a node with DS18B20 probes sends after its reading.
+"""
 
 import struct
 
@@ -18,15 +22,72 @@ _COMMON_FORMAT = "<BBHihHHHB"
 # bees_in(u16), bees_out(u16), period_ms(u32), lane_mask(u8), stuck_mask(u8)
 _TRAFFIC_FORMAT = "<HHIBB"
 
-_VALID_LENGTHS = {32, 48}
-_MSG_TYPE_FOR_LENGTH = {32: 0x01, 48: 0x02}
+# Phase 2 latency trace (bytes 28-39, outside the CRC; version 0 = absent):
+# version(u8), tx_attempt(u8), capture_age_ms(u16), retry_ms(u16),
+# bridge_rx_ms(u32), bridge_hold_us(u16)
+_TRACE_FORMAT = "<BBHHIH"
+_TRACE_OFFSET = 28
+TRACE_VERSION = 1
+TRACE_FIELDS = (
+    "trace_attempt",
+    "trace_capture_age_ms",
+    "trace_retry_ms",
+    "trace_bridge_rx_ms",
+    "trace_bridge_hold_us",
+)
+
+# Thermal array (44 bytes, CRC-8 over bytes 0-42 at byte 43):
+# hive_id(u8), msg_type(u8), seq(u16), probe_count(u8), thermal_flags(u8),
+# base_x16(i16), then one byte per probe in 1/8 C steps above the base
+_THERMAL_FORMAT = "<BBHBBh"
+_THERMAL_Q_OFFSET = 8
+THERMAL_LENGTH = 44
+THERMAL_MAX_PROBES = 32
+_THERMAL_Q_NONE = 0xFF  # Probe gave no reading this wake
+
+MSG_TYPE_THERMAL = 0x04
+
+_VALID_LENGTHS = {32, 48, THERMAL_LENGTH}
+_MSG_TYPE_FOR_LENGTH = {32: 0x01, 48: 0x02, THERMAL_LENGTH: MSG_TYPE_THERMAL}
+
+
+def _deserialize_thermal(data: bytes) -> dict:
+    expected_crc = crc8(data[:THERMAL_LENGTH - 1])
+    actual_crc = data[THERMAL_LENGTH - 1]
+    if expected_crc != actual_crc:
+        raise PayloadError(
+            f"CRC mismatch: expected 0x{expected_crc:02X}, got 0x{actual_crc:02X}"
+        )
+
+    hive_id, msg_type, sequence, probe_count, thermal_flags, base_x16 = struct.unpack_from(
+        _THERMAL_FORMAT, data, 0
+    )
+    if msg_type != MSG_TYPE_THERMAL:
+        raise PayloadError(
+            f"Expected msg_type 0x{MSG_TYPE_THERMAL:02X} for {THERMAL_LENGTH}-byte payload, "
+            f"got 0x{msg_type:02X}"
+        )
+    if probe_count > THERMAL_MAX_PROBES:
+        raise PayloadError(f"Thermal payload claims {probe_count} probes")
+
+    q = data[_THERMAL_Q_OFFSET:_THERMAL_Q_OFFSET + probe_count]
+    return {
+        "hive_id": hive_id,
+        "msg_type": msg_type,
+        "sequence": sequence,
+        "thermal_flags": thermal_flags,
+        # base + 2 * q sixteenths; None for a probe that failed this wake
+        "probes_c": [None if v == _THERMAL_Q_NONE else (base_x16 + 2 * v) / 16 for v in q],
+    }
 
 
 def deserialize_payload(data: bytes) -> dict:
     if len(data) not in _VALID_LENGTHS:
         raise PayloadError(
-            f"Expected 32 or 48-byte payload, got {len(data)} bytes length"
+            f"Expected 32, 44 or 48-byte payload, got {len(data)} bytes length"
         )
+    if len(data) == THERMAL_LENGTH:
+        return _deserialize_thermal(data)
 
     # Verify CRC-8 over bytes 0-16 (same for both phases)
     expected_crc = crc8(data[:17])
@@ -69,5 +130,8 @@ def deserialize_payload(data: bytes) -> dict:
             "lane_mask": lane_mask,
             "stuck_mask": stuck_mask,
         })
+        version, *trace = struct.unpack_from(_TRACE_FORMAT, data, _TRACE_OFFSET)
+        if version == TRACE_VERSION:
+            result.update(zip(TRACE_FIELDS, trace))
 
     return result
@@ -0,0 +1,64 @@
+"""Parse the camera node's X-Wake-Telemetry upload header.
+
+The header is a comma-separated list of key=value pairs with integer
+values, e.g. ``v=1,boot=312,nvs=4,cam=410,...,vbat=3987,wfail=0,ufail=0``.
+Durations are milliseconds; p-prefixed keys describe the previous wake,
+whose upload and teardown finish after that wake's own upload was sent.
+"""
+
+# Header key -> camera_wake_telemetry column
+FIELD_MAP = {
+    "boot": "boot_ms",
+    "nvs": "nvs_ms",
+    "cam": "camera_init_ms",
+    "warm": "warmup_ms",
+    "thumb": "thumbnail_ms",
+    "cap": "capture_ms",
+    "wifi": "wifi_ms",
+    "sync": "time_sync_ms",
+    "pup": "prev_upload_ms",
+    "ptd": "prev_teardown_ms",
+    "pawake": "prev_awake_ms",
+    "vbat": "battery_mv",
+    "wfail": "wifi_failures",
+    "ufail": "upload_failures",
+}
+
+SUPPORTED_VERSION = 1
+MAX_HEADER_LEN = 512
+MAX_VALUE = 10_000_000  # ~2.8 h in ms; anything larger is garbage
+
+
+def parse_wake_telemetry(header: str | None) -> dict[str, int | None] | None:
+    """Parse a telemetry header into column values.
+
+    Returns None if the header is absent, malformed, or an unsupported
+    version.  Unknown keys are ignored so firmware can add fields ahead of
+    the hub; known keys that are missing come back as None.  A battery
+    reading of 0 means "not measured" and is stored as None.
+    """
+    if not header or len(header) > MAX_HEADER_LEN:
+        return None
+
+    pairs: dict[str, int] = {}
+    for item in header.split(","):
+        key, sep, raw = item.strip().partition("=")
+        if not sep or not key:
+            return None
+        try:
+            value = int(raw)
+        except ValueError:
+            return None
+        if value < 0 or value > MAX_VALUE:
+            return None
+        pairs[key] = value
+
+    if pairs.get("v") != SUPPORTED_VERSION:
+        return None
+
+    result: dict[str, int | None] = {
+        column: pairs.get(key) for key, column in FIELD_MAP.items()
+    }
+    if result["battery_mv"] == 0:
+        result["battery_mv"] = None
+    return result
@@ -0,0 +1,230 @@
+// Waggle Firmware — Native micro-benchmark harness for hot paths.
+//
+// Header-only; shared by the [env:bench] programs of the sensor and
+// bridge firmware.  Each case runs a small kernel in a calibrated loop
+// and reports:
+//   ns/op      median wall time per call over BENCH_REPEATS runs
+//   bytes/s    throughput, for cases that declare bytes per op
+//   allocs/op  heap allocations per call (firmware kernels should be 0)
+//
+// Results are printed as a table and written as JSON (--out, default
+// bench_results.json) so runs can be compared with compare.py.
+//
+// Exactly one translation unit per program defines BENCH_MAIN before
+// including this header; that TU provides the allocation counters.
+//
+//   #define BENCH_MAIN
+//   #include "bench.h"
+//   int main(int argc, char** argv) {
+//       bench::Suite suite("sensor", argc, argv);
+//       suite.run("crc8/17B", 17, [&] { bench::do_not_optimize(crc8(buf, 17)); });
+//       return suite.finish();
+//   }
+//
+// Options: --out FILE, --filter SUBSTRING, --min-time-ms N
+
+#ifndef WAGGLE_BENCH_H
+#define WAGGLE_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+
+#define BENCH_REPEATS 5
+
+namespace bench {
+
+// Heap allocations since program start (see BENCH_MAIN below)
+extern volatile size_t g_allocs;
+
+// Keep a value (and everything it depends on) from being optimised out.
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Force pending stores to memory so writes into buffers count.
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+struct Result {
+    std::string name;
+    uint64_t    iterations;     // Per timed run
+    double      ns_per_op;
+    double      bytes_per_sec;  // 0 when the case declares no bytes
+    double      allocs_per_op;
+};
+
+class Suite {
+public:
+    Suite(const char* name, int argc, char** argv)
+        : name_(name), out_path_("bench_results.json"), min_time_ms_(200) {
+        for (int i = 1; i < argc; i++) {
+            const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+            if (v != nullptr && strcmp(argv[i], "--out") == 0) {
+                out_path_ = v; i++;
+            } else if (v != nullptr && strcmp(argv[i], "--filter") == 0) {
+                filter_ = v; i++;
+            } else if (v != nullptr && strcmp(argv[i], "--min-time-ms") == 0) {
+                min_time_ms_ = atoi(v); i++;
+            } else {
+                fprintf(stderr, "usage: %s [--out FILE] [--filter SUBSTRING] [--min-time-ms N]\n",
+                        argv[0]);
+                exit(2);
+            }
+        }
+        if (min_time_ms_ < 1) {
+            min_time_ms_ = 1;
+        }
+        printf("%-32s %12s %12s %14s %10s\n", "case", "iterations", "ns/op", "MB/s", "allocs/op");
+    }
+
+    // Time fn().  bytes_per_op is the input size processed per call (0 if
+    // throughput is meaningless for this case).
+    template <typename F>
+    void run(const char* name, size_t bytes_per_op, F fn) {
+        if (!filter_.empty() && strstr(name, filter_.c_str()) == nullptr) {
+            return;
+        }
+
+        // Calibrate: grow the loop until one run takes ~1/BENCH_REPEATS of
+        // the time budget.
+        double budget_ns = min_time_ms_ * 1e6 / BENCH_REPEATS;
+        uint64_t iters = 1;
+        double ns = time_loop(fn, iters);
+        while (ns < budget_ns && iters < (1ULL << 40)) {
+            uint64_t next = (ns <= 0) ? iters * 10
+                          : (uint64_t)(iters * std::min(10.0, budget_ns * 1.2 / ns));
+            iters = std::max(next, iters + 1);
+            ns = time_loop(fn, iters);
+        }
+
+        std::vector<double> per_op;
+        size_t allocs_before = g_allocs;
+        for (int r = 0; r < BENCH_REPEATS; r++) {
+            per_op.push_back(time_loop(fn, iters) / (double)iters);
+        }
+        size_t allocs = g_allocs - allocs_before;
+        std::sort(per_op.begin(), per_op.end());
+
+        Result res;
+        res.name = name;
+        res.iterations = iters;
+        res.ns_per_op = per_op[BENCH_REPEATS / 2];
+        res.bytes_per_sec = (bytes_per_op > 0 && res.ns_per_op > 0)
+                          ? bytes_per_op * 1e9 / res.ns_per_op : 0.0;
+        res.allocs_per_op = (double)allocs / ((double)iters * BENCH_REPEATS);
+        results_.push_back(res);
+
+        printf("%-32s %12llu %12.2f %14.1f %10.3f\n", name, (unsigned long long)iters,
+               res.ns_per_op, res.bytes_per_sec / 1e6, res.allocs_per_op);
+    }
+
+    // Write the JSON report.  Returns a process exit code.
+    int finish() {
+        FILE* f = fopen(out_path_.c_str(), "w");
+        if (f == nullptr) {
+            fprintf(stderr, "cannot write %s\n", out_path_.c_str());
+            return 1;
+        }
+        fprintf(f, "{\n  \"suite\": \"%s\",\n  \"compiler\": \"%s\",\n  \"results\": [\n",
+                name_.c_str(), compiler());
+        for (size_t i = 0; i < results_.size(); i++) {
+            const Result& r = results_[i];
+            fprintf(f, "    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, "
+                       "\"bytes_per_sec\": %.1f, \"allocs_per_op\": %.4f}%s\n",
+                    r.name.c_str(), (unsigned long long)r.iterations, r.ns_per_op,
+                    r.bytes_per_sec, r.allocs_per_op, (i + 1 < results_.size()) ? "," : "");
+        }
+        fprintf(f, "  ]\n}\n");
+        fclose(f);
+        printf("\nwrote %s\n", out_path_.c_str());
+        return 0;
+    }
+
+private:
+    template <typename F>
+    static double time_loop(F& fn, uint64_t iters) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iters; i++) {
+            fn();
+        }
+        clobber_memory();
+        auto t1 = std::chrono::steady_clock::now();
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    }
+
+    static const char* compiler() {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#else
+        return "unknown";
+#endif
+    }
+
+    std::string name_;
+    std::string out_path_;
+    std::string filter_;
+    int min_time_ms_;
+    std::vector<Result> results_;
+};
+
+}  // namespace bench
+
+// ── Allocation counting (one TU per program) ──────────────────────────
+// glibc: interpose malloc/calloc/realloc so C and C++ allocations are
+// both seen.  Elsewhere only operator new is counted.
+#ifdef BENCH_MAIN
+
+volatile size_t bench::g_allocs = 0;
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) {
+    bench::g_allocs = bench::g_allocs + 1;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    bench::g_allocs = bench::g_allocs + 1;
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    bench::g_allocs = bench::g_allocs + 1;
+    return __libc_realloc(ptr, size);
+}
+}  // extern "C"
+#else
+void* operator new(size_t size) {
+    bench::g_allocs = bench::g_allocs + 1;
+    void* p = malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+#endif  // __GLIBC__
+
+#endif  // BENCH_MAIN
+
+#endif  // WAGGLE_BENCH_H
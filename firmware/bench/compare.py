@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""Compare two firmware benchmark result files.
+
+Usage:
+    python3 firmware/bench/compare.py baseline.json current.json [--threshold 10]
+
+Prints ns/op for every case in both files and exits non-zero if any case
+got slower by more than --threshold percent, or started allocating.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return data.get("suite", "?"), {r["name"]: r for r in data["results"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument(
+        "--threshold", type=float, default=10.0, help="allowed slowdown in percent"
+    )
+    args = parser.parse_args()
+
+    base_suite, base = load(args.baseline)
+    cur_suite, cur = load(args.current)
+    if base_suite != cur_suite:
+        print(f"warning: comparing suite {base_suite!r} against {cur_suite!r}")
+
+    regressions = 0
+    print(f"{'case':<32} {'base ns/op':>12} {'cur ns/op':>12} {'delta':>8}  allocs/op")
+    for name in sorted(set(base) | set(cur)):
+        if name not in base or name not in cur:
+            where = "baseline" if name in base else "current"
+            print(f"{name:<32} (only in {where})")
+            continue
+        b, c = base[name], cur[name]
+        delta = (c["ns_per_op"] - b["ns_per_op"]) / b["ns_per_op"] * 100 if b["ns_per_op"] else 0
+        allocs = f"{b['allocs_per_op']:.3f} -> {c['allocs_per_op']:.3f}"
+        flag = ""
+        if delta > args.threshold or c["allocs_per_op"] > b["allocs_per_op"]:
+            flag = "  REGRESSION"
+            regressions += 1
+        print(
+            f"{name:<32} {b['ns_per_op']:>12.2f} {c['ns_per_op']:>12.2f} "
+            f"{delta:>+7.1f}%  {allocs}{flag}"
+        )
+
+    if regressions:
+        print(f"\n{regressions} regression(s) above {args.threshold:.0f}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
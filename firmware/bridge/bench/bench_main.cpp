@@ -0,0 +1,88 @@
+/**
+ * Waggle Bridge — Native benchmarks for the bridge hot path.
+ *
+ * Host-only.  Times what on_data_recv() does for every ESP-NOW packet:
+ *   cobs_encode/<N>B   COBS encoding of a Phase 1 (38 B) / Phase 2 (54 B)
+ *                      frame, plus the zero-free worst case
+ *   frame/<N>B         the full per-packet path: MAC + payload copy,
+ *                      COBS encode, delimiter
+ *
+ * Build and run:
+ *   pio run -e bench && .pio/build/bench/program --out bench_bridge.json
+ * Compare two runs with ../bench/compare.py.
+ */
+
+#define BENCH_MAIN
+#include "bench.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/cobs.h"
+#include "../src/config.h"
+
+// Fill a payload the way the sensor does: small fields with plenty of
+// zero bytes and a zeroed reserved tail.
+static void fill_payload(uint8_t* p, size_t len) {
+    memset(p, 0, len);
+    for (size_t i = 0; i < len && i < 28; i++) {
+        p[i] = (uint8_t)((i % 3 == 0) ? 0x00 : i * 29 + 7);
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::Suite suite("bridge", argc, argv);
+
+    static const uint8_t mac[MAC_LEN] = {0x24, 0x6F, 0x28, 0xA1, 0xB2, 0xC3};
+    uint8_t payload_p1[PAYLOAD_LEN_P1];
+    uint8_t payload_p2[PAYLOAD_LEN_P2];
+    fill_payload(payload_p1, sizeof(payload_p1));
+    fill_payload(payload_p2, sizeof(payload_p2));
+
+    uint8_t frame_p1[FRAME_LEN_P1];
+    uint8_t frame_p2[FRAME_LEN_P2];
+    memcpy(frame_p1, mac, MAC_LEN);
+    memcpy(frame_p1 + MAC_LEN, payload_p1, PAYLOAD_LEN_P1);
+    memcpy(frame_p2, mac, MAC_LEN);
+    memcpy(frame_p2 + MAC_LEN, payload_p2, PAYLOAD_LEN_P2);
+
+    uint8_t no_zeros[MAX_DECODED_SIZE];
+    for (size_t i = 0; i < sizeof(no_zeros); i++) {
+        no_zeros[i] = (uint8_t)(i + 1);
+    }
+
+    uint8_t encoded[COBS_MAX_OUTPUT];
+
+    // ---- COBS encoder alone ----
+    suite.run("cobs_encode/38B", FRAME_LEN_P1, [&] {
+        bench::do_not_optimize(frame_p1);
+        bench::do_not_optimize(cobs_encode(frame_p1, FRAME_LEN_P1, encoded));
+        bench::clobber_memory();
+    });
+    suite.run("cobs_encode/54B", FRAME_LEN_P2, [&] {
+        bench::do_not_optimize(frame_p2);
+        bench::do_not_optimize(cobs_encode(frame_p2, FRAME_LEN_P2, encoded));
+        bench::clobber_memory();
+    });
+    suite.run("cobs_encode/64B-nozero", sizeof(no_zeros), [&] {
+        bench::do_not_optimize(no_zeros);
+        bench::do_not_optimize(cobs_encode(no_zeros, sizeof(no_zeros), encoded));
+        bench::clobber_memory();
+    });
+
+    // ---- Full per-packet path (minus Serial.write) ----
+    uint8_t wire[WIRE_MAX];
+    auto frame_path = [&](const uint8_t* data, size_t data_len) {
+        uint8_t frame[MAX_DECODED_SIZE];
+        memcpy(frame, mac, MAC_LEN);
+        memcpy(frame + MAC_LEN, data, data_len);
+        size_t n = cobs_encode(frame, MAC_LEN + data_len, wire);
+        wire[n] = FRAME_DELIMITER;
+        bench::do_not_optimize(n);
+        bench::clobber_memory();
+    };
+    suite.run("frame/38B", FRAME_LEN_P1, [&] { frame_path(payload_p1, PAYLOAD_LEN_P1); });
+    suite.run("frame/54B", FRAME_LEN_P2, [&] { frame_path(payload_p2, PAYLOAD_LEN_P2); });
+
+    return suite.finish();
+}
@@ -0,0 +1,393 @@
+/**
+ * Waggle Bridge — Serial frame recorder and replayer.
+ *
+ * Host-only (Linux).  Captures the bridge → hub byte stream into a .wfl
+ * frame log (see framelog.h) and plays it back into a pseudo-terminal, so
+ * field traffic can be fed to the Python bridge and worker again — in real
+ * time, accelerated, or as fast as the consumer reads.
+ *
+ *   framelog record --device /dev/ttyUSB0 --out field.wfl [--tee-link /tmp/ttyWAGGLE]
+ *   framelog replay field.wfl --link /tmp/ttyWAGGLE [--speed 10]
+ *   framelog info field.wfl
+ *
+ * record owns the serial port; --tee-link passes every byte straight
+ * through to a pty so the hub keeps running on the capture while it is
+ * recorded (point SERIAL_DEVICE at the link).  Timestamps are taken when
+ * the read() holding a frame's delimiter returns, so frames arriving in one
+ * USB transfer share a timestamp.
+ *
+ * Build: pio run -e framelog  →  .pio/build/framelog/program
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+
+#include "../host/host_io.h"
+#include "../src/config.h"
+#include "framelog.h"
+
+static volatile sig_atomic_t s_stop = 0;
+
+static void on_signal(int) {
+    s_stop = 1;
+}
+
+static void install_signals() {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;  // No SA_RESTART: read()/poll() return EINTR
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+}
+
+static void usage() {
+    fprintf(stderr,
+        "usage: framelog record --device DEV --out FILE [--baud N] [--tee-link PATH]\n"
+        "                       [--duration-s N] [--flush-ms N]\n"
+        "       framelog replay FILE [--speed X] [--link PATH | --out PATH]\n"
+        "                       [--start-delay-s N] [--loop N]\n"
+        "       framelog info FILE\n"
+        "  --speed X   1 = real time (default), 10 = ten times faster, 0 = unpaced\n");
+    exit(2);
+}
+
+static const char* arg_value(int argc, char** argv, int* i) {
+    if (*i + 1 >= argc) {
+        usage();
+    }
+    return argv[++*i];
+}
+
+// ---- record ----
+
+static int cmd_record(int argc, char** argv) {
+    const char* device = nullptr;
+    const char* out = nullptr;
+    const char* tee_link = nullptr;
+    uint32_t baud = SERIAL_BAUD;
+    uint32_t duration_s = 0;
+    uint32_t flush_ms = 1000;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--device") == 0)          device = arg_value(argc, argv, &i);
+        else if (strcmp(argv[i], "--out") == 0)        out = arg_value(argc, argv, &i);
+        else if (strcmp(argv[i], "--tee-link") == 0)   tee_link = arg_value(argc, argv, &i);
+        else if (strcmp(argv[i], "--baud") == 0)       baud = (uint32_t)atol(arg_value(argc, argv, &i));
+        else if (strcmp(argv[i], "--duration-s") == 0) duration_s = (uint32_t)atol(arg_value(argc, argv, &i));
+        else if (strcmp(argv[i], "--flush-ms") == 0)   flush_ms = (uint32_t)atol(arg_value(argc, argv, &i));
+        else usage();
+    }
+    if (device == nullptr || out == nullptr) {
+        usage();
+    }
+
+    int in = (strcmp(device, "-") == 0) ? STDIN_FILENO : open(device, O_RDONLY | O_NOCTTY);
+    if (in < 0) {
+        perror(device);
+        return 1;
+    }
+    if (isatty(in) && !host_tty_raw(in, baud)) {
+        fprintf(stderr, "cannot configure %s\n", device);
+        return 1;
+    }
+
+    int tee = -1;
+    int tee_slave = -1;
+    if (tee_link != nullptr) {
+        char slave[64];
+        tee = host_open_pty(tee_link, slave, sizeof(slave), &tee_slave);
+        if (tee < 0) {
+            return 1;
+        }
+        fprintf(stderr, "tee: %s -> %s\n", slave, tee_link);
+    }
+
+    FrameLogWriter log;
+    if (!log.open(out, host_wall_ns(), isatty(in) ? baud : 0)) {
+        perror(out);
+        return 1;
+    }
+    install_signals();
+
+    static uint8_t frame[FRAMELOG_MAX_FRAME];
+    size_t flen = 0;
+    bool overflow = false;
+    uint64_t t0 = host_mono_ns();
+    uint64_t end = duration_s ? t0 + (uint64_t)duration_s * 1000000000ULL : 0;
+    uint64_t next_flush = t0 + (uint64_t)flush_ms * 1000000ULL;
+    uint64_t truncated = 0;
+    bool eof = false;
+
+    fprintf(stderr, "recording %s -> %s (Ctrl-C to stop)\n", device, out);
+    while (!s_stop && !eof) {
+        struct pollfd pfd = {in, POLLIN, 0};
+        int r = poll(&pfd, 1, 200);
+        uint64_t now = host_mono_ns();
+        if (end != 0 && now >= end) {
+            break;
+        }
+        if (now >= next_flush) {
+            log.flush();
+            next_flush = now + (uint64_t)flush_ms * 1000000ULL;
+        }
+        if (r <= 0) {
+            continue;
+        }
+
+        uint8_t buf[4096];
+        ssize_t n = read(in, buf, sizeof(buf));
+        if (n <= 0) {
+            eof = (n == 0);
+            if (n < 0 && errno != EINTR && errno != EAGAIN) {
+                perror("read");
+                break;
+            }
+            continue;
+        }
+        uint64_t t_ns = host_mono_ns() - t0;
+        if (tee >= 0) {
+            host_write_all(tee, buf, (size_t)n);
+        }
+
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] != FRAME_DELIMITER) {
+                if (flen < sizeof(frame)) {
+                    frame[flen++] = buf[i];
+                } else {
+                    overflow = true;
+                }
+                continue;
+            }
+            if (!log.append(t_ns, frame, flen, overflow ? FRAMELOG_TRUNCATED : 0)) {
+                perror("write log");
+                return 1;
+            }
+            truncated += overflow;
+            flen = 0;
+            overflow = false;
+        }
+    }
+    if (flen > 0) {
+        log.append(host_mono_ns() - t0, frame, flen,
+                   FRAMELOG_UNTERMINATED | (overflow ? FRAMELOG_TRUNCATED : 0));
+    }
+
+    double elapsed = (host_mono_ns() - t0) / 1e9;
+    log.close();
+    fprintf(stderr, "recorded %llu frames (%llu truncated), %llu bytes in %.1f s\n",
+            (unsigned long long)log.records(), (unsigned long long)truncated,
+            (unsigned long long)log.bytes(), elapsed);
+
+    if (tee >= 0) {
+        close(tee_slave);
+        unlink(tee_link);
+    }
+    return 0;
+}
+
+// ---- replay ----
+
+static int cmd_replay(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+    }
+    const char* path = argv[2];
+    const char* link = nullptr;
+    const char* out = nullptr;
+    double speed = 1.0;
+    uint32_t start_delay_s = 3;
+    uint32_t loops = 1;
+
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--speed") == 0)              speed = atof(arg_value(argc, argv, &i));
+        else if (strcmp(argv[i], "--link") == 0)          link = arg_value(argc, argv, &i);
+        else if (strcmp(argv[i], "--out") == 0)           out = arg_value(argc, argv, &i);
+        else if (strcmp(argv[i], "--start-delay-s") == 0) start_delay_s = (uint32_t)atol(arg_value(argc, argv, &i));
+        else if (strcmp(argv[i], "--loop") == 0)          loops = (uint32_t)atol(arg_value(argc, argv, &i));
+        else usage();
+    }
+    if (speed < 0 || loops == 0) {
+        usage();
+    }
+
+    FrameLogReader log;
+    if (!log.open(path)) {
+        fprintf(stderr, "%s: not a frame log\n", path);
+        return 1;
+    }
+
+    int fd;
+    int slave_fd = -1;
+    if (out != nullptr) {
+        fd = (strcmp(out, "-") == 0) ? STDOUT_FILENO
+                                     : open(out, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            perror(out);
+            return 1;
+        }
+    } else {
+        char slave[64];
+        fd = host_open_pty(link, slave, sizeof(slave), &slave_fd);
+        if (fd < 0) {
+            return 1;
+        }
+        fprintf(stderr, "pty: %s%s%s\n", slave, link ? " -> " : "", link ? link : "");
+        if (start_delay_s > 0) {
+            fprintf(stderr, "starting in %u s...\n", start_delay_s);
+            sleep(start_delay_s);
+        }
+    }
+    install_signals();
+
+    uint64_t frames = 0, bytes = 0;
+    uint64_t max_late_ns = 0;
+    uint64_t t0 = host_mono_ns();
+    uint64_t loop_offset_ns = 0;  // Capture time at which the current pass starts
+    uint64_t last_t_ns = 0;
+    static uint8_t wire[FRAMELOG_MAX_FRAME + 1];
+
+    for (uint32_t pass = 0; pass < loops && !s_stop; pass++) {
+        log.rewind();
+        FrameLogRecord rec;
+        uint64_t first_t_ns = 0;
+        bool first = true;
+        while (!s_stop && log.next(&rec)) {
+            if (first) {
+                first_t_ns = rec.t_ns;
+                first = false;
+            }
+            uint64_t capture_ns = loop_offset_ns + (rec.t_ns - first_t_ns);
+            last_t_ns = capture_ns;
+            if (speed > 0) {
+                uint64_t due = t0 + (uint64_t)(capture_ns / speed);
+                uint64_t now = host_mono_ns();
+                if (now < due) {
+                    host_sleep_until_ns(due);
+                } else {
+                    max_late_ns = std::max(max_late_ns, now - due);
+                }
+            }
+            memcpy(wire, rec.data, rec.len);
+            size_t n = rec.len;
+            if (!(rec.flags & FRAMELOG_UNTERMINATED)) {
+                wire[n++] = FRAME_DELIMITER;
+            }
+            if (!host_write_all(fd, wire, n)) {
+                return 1;
+            }
+            frames++;
+            bytes += n;
+        }
+        // Next pass starts one second (capture time) after this one ended
+        loop_offset_ns = last_t_ns + 1000000000ULL;
+    }
+
+    double elapsed = (host_mono_ns() - t0) / 1e9;
+    fprintf(stderr, "replayed %llu frames, %llu bytes in %.2f s (%.0f frames/s, %.2fx capture time)",
+            (unsigned long long)frames, (unsigned long long)bytes, elapsed,
+            elapsed > 0 ? frames / elapsed : 0.0,
+            elapsed > 0 ? last_t_ns / 1e9 / elapsed : 0.0);
+    if (speed > 0) {
+        fprintf(stderr, ", max %.1f ms behind schedule", max_late_ns / 1e6);
+    }
+    fprintf(stderr, "\n");
+
+    if (slave_fd >= 0) {
+        tcdrain(fd);
+        close(slave_fd);
+    }
+    if (link != nullptr) {
+        unlink(link);
+    }
+    return 0;
+}
+
+// ---- info ----
+
+static int cmd_info(int argc, char** argv) {
+    if (argc != 3) {
+        usage();
+    }
+    FrameLogReader log;
+    if (!log.open(argv[2])) {
+        fprintf(stderr, "%s: not a frame log\n", argv[2]);
+        return 1;
+    }
+
+    std::map<uint16_t, uint64_t> lengths;
+    std::map<uint64_t, uint64_t> per_second;
+    uint64_t frames = 0, bytes = 0, truncated = 0, empty = 0;
+    uint64_t first_ns = 0, last_ns = 0, max_gap_ns = 0;
+    FrameLogRecord rec;
+    while (log.next(&rec)) {
+        if (frames == 0) {
+            first_ns = rec.t_ns;
+        } else {
+            max_gap_ns = std::max(max_gap_ns, rec.t_ns - last_ns);
+        }
+        last_ns = rec.t_ns;
+        frames++;
+        bytes += rec.len;
+        truncated += (rec.flags & FRAMELOG_TRUNCATED) != 0;
+        empty += (rec.len == 0);
+        lengths[rec.len]++;
+        per_second[rec.t_ns / 1000000000ULL]++;
+    }
+
+    const FrameLogHeader& h = log.header();
+    time_t start = (time_t)(h.start_wall_ns / 1000000000LL);
+    struct tm tm;
+    gmtime_r(&start, &tm);
+    char when[32];
+    strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%SZ", &tm);
+
+    double span = (last_ns - first_ns) / 1e9;
+    uint64_t peak = 0;
+    for (const auto& s : per_second) {
+        peak = std::max(peak, s.second);
+    }
+    printf("captured      %s (baud %u)\n", when, h.baud);
+    printf("frames        %llu (%llu empty, %llu truncated), %llu frame bytes\n",
+           (unsigned long long)frames, (unsigned long long)empty,
+           (unsigned long long)truncated, (unsigned long long)bytes);
+    printf("duration      %.1f s, mean %.2f frames/s, peak %llu frames/s\n", span,
+           span > 0 ? frames / span : 0.0, (unsigned long long)peak);
+    printf("max gap       %.1f s\n", max_gap_ns / 1e9);
+    if (log.torn_bytes() > 0) {
+        printf("torn tail     %zu bytes ignored\n", log.torn_bytes());
+    }
+    printf("encoded length histogram (55 = Phase 2, 39 = Phase 1):\n");
+    for (const auto& l : lengths) {
+        printf("  %5u  %llu\n", l.first, (unsigned long long)l.second);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+    }
+    if (strcmp(argv[1], "record") == 0) {
+        return cmd_record(argc, argv);
+    }
+    if (strcmp(argv[1], "replay") == 0) {
+        return cmd_replay(argc, argv);
+    }
+    if (strcmp(argv[1], "info") == 0) {
+        return cmd_info(argc, argv);
+    }
+    usage();
+    return 2;
+}
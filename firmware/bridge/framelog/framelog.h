@@ -0,0 +1,190 @@
+/**
+ * Waggle Bridge — Raw serial frame log (.wfl) format.
+ *
+ * A capture of the byte stream the bridge sends to the hub, one record per
+ * 0x00-delimited COBS frame, with the time the delimiter arrived.  Frames
+ * are stored exactly as received (still COBS-encoded, delimiter stripped),
+ * including corrupt or oversized ones, so a replay feeds the Python bridge
+ * the same bytes it saw in the field.
+ *
+ * Layout (little-endian, no padding; the file is read through mmap):
+ *
+ *   header   "WFL1"  u16 version  u16 flags  i64 start_wall_ns  u32 baud  u32 reserved
+ *   record   u64 t_ns  u16 len  u8 flags  u8 reserved  len bytes of frame
+ *
+ * t_ns is monotonic time since the start of the capture.  A record cut
+ * short by a crash or power loss is ignored by the reader.
+ */
+
+#ifndef WAGGLE_BRIDGE_FRAMELOG_H
+#define WAGGLE_BRIDGE_FRAMELOG_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr char     FRAMELOG_MAGIC[4]     = {'W', 'F', 'L', '1'};
+static constexpr uint16_t FRAMELOG_VERSION      = 1;
+static constexpr size_t   FRAMELOG_HEADER_SIZE  = 24;
+static constexpr size_t   FRAMELOG_RECORD_SIZE  = 12;  // Record header, before the frame
+static constexpr size_t   FRAMELOG_MAX_FRAME    = 4096;
+
+// Record flags
+static constexpr uint8_t  FRAMELOG_TRUNCATED    = 1 << 0;  // Frame longer than MAX_FRAME, tail dropped
+static constexpr uint8_t  FRAMELOG_UNTERMINATED = 1 << 1;  // Capture stopped before the delimiter
+
+struct FrameLogHeader {
+    int64_t  start_wall_ns;  // CLOCK_REALTIME at the start of the capture
+    uint32_t baud;           // Serial speed of the capture (0 = unknown)
+};
+
+struct FrameLogRecord {
+    uint64_t       t_ns;     // Since the start of the capture
+    uint16_t       len;
+    uint8_t        flags;
+    const uint8_t* data;     // Points into the mapping
+};
+
+// ---- Writer ----
+
+/** Appends records through stdio buffering; flush() to make them durable. */
+class FrameLogWriter {
+public:
+    FrameLogWriter() : _f(nullptr), _records(0), _bytes(0) {}
+    ~FrameLogWriter() { close(); }
+
+    bool open(const char* path, int64_t start_wall_ns, uint32_t baud) {
+        _f = fopen(path, "wb");
+        if (_f == nullptr) {
+            return false;
+        }
+        uint8_t h[FRAMELOG_HEADER_SIZE];
+        memset(h, 0, sizeof(h));
+        memcpy(h, FRAMELOG_MAGIC, 4);
+        memcpy(h + 4, &FRAMELOG_VERSION, 2);
+        memcpy(h + 8, &start_wall_ns, 8);
+        memcpy(h + 16, &baud, 4);
+        _bytes = sizeof(h);
+        return fwrite(h, 1, sizeof(h), _f) == sizeof(h);
+    }
+
+    bool append(uint64_t t_ns, const uint8_t* data, size_t len, uint8_t flags) {
+        if (len > FRAMELOG_MAX_FRAME) {
+            len = FRAMELOG_MAX_FRAME;
+            flags |= FRAMELOG_TRUNCATED;
+        }
+        uint8_t h[FRAMELOG_RECORD_SIZE];
+        uint16_t len16 = (uint16_t)len;
+        memcpy(h, &t_ns, 8);
+        memcpy(h + 8, &len16, 2);
+        h[10] = flags;
+        h[11] = 0;
+        if (fwrite(h, 1, sizeof(h), _f) != sizeof(h) || fwrite(data, 1, len, _f) != len) {
+            return false;
+        }
+        _records++;
+        _bytes += sizeof(h) + len;
+        return true;
+    }
+
+    bool flush() { return _f != nullptr && fflush(_f) == 0; }
+
+    void close() {
+        if (_f != nullptr) {
+            fclose(_f);
+            _f = nullptr;
+        }
+    }
+
+    uint64_t records() const { return _records; }
+    uint64_t bytes() const { return _bytes; }
+
+private:
+    FILE*    _f;
+    uint64_t _records;
+    uint64_t _bytes;
+};
+
+// ---- Reader ----
+
+/** Maps a log read-only and walks its records without copying. */
+class FrameLogReader {
+public:
+    FrameLogReader() : _base(nullptr), _size(0), _pos(0) {}
+    ~FrameLogReader() { close(); }
+
+    /** Returns false if the file is missing, unmappable or not a v1 log. */
+    bool open(const char* path) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < FRAMELOG_HEADER_SIZE) {
+            ::close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        _base = (const uint8_t*)p;
+        _size = (size_t)st.st_size;
+        madvise(p, _size, MADV_SEQUENTIAL);
+
+        uint16_t version;
+        memcpy(&version, _base + 4, 2);
+        if (memcmp(_base, FRAMELOG_MAGIC, 4) != 0 || version != FRAMELOG_VERSION) {
+            close();
+            return false;
+        }
+        memcpy(&_header.start_wall_ns, _base + 8, 8);
+        memcpy(&_header.baud, _base + 16, 4);
+        rewind();
+        return true;
+    }
+
+    void close() {
+        if (_base != nullptr) {
+            munmap((void*)_base, _size);
+            _base = nullptr;
+        }
+    }
+
+    const FrameLogHeader& header() const { return _header; }
+
+    void rewind() { _pos = FRAMELOG_HEADER_SIZE; }
+
+    /** Next complete record, or false at the end (or at a torn tail). */
+    bool next(FrameLogRecord* rec) {
+        if (_size - _pos < FRAMELOG_RECORD_SIZE) {
+            return false;
+        }
+        const uint8_t* h = _base + _pos;
+        memcpy(&rec->t_ns, h, 8);
+        memcpy(&rec->len, h + 8, 2);
+        rec->flags = h[10];
+        if (_size - _pos - FRAMELOG_RECORD_SIZE < rec->len) {
+            return false;
+        }
+        rec->data = h + FRAMELOG_RECORD_SIZE;
+        _pos += FRAMELOG_RECORD_SIZE + rec->len;
+        return true;
+    }
+
+    /** Bytes left after the last complete record (non-zero after a crash). */
+    size_t torn_bytes() const { return _size - _pos; }
+
+private:
+    const uint8_t* _base;
+    size_t         _size;
+    size_t         _pos;
+    FrameLogHeader _header;
+};
+
+#endif  // WAGGLE_BRIDGE_FRAMELOG_H
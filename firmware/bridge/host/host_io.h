@@ -0,0 +1,143 @@
+/**
+ * Waggle Bridge — Host-side I/O helpers for the Linux tools.
+ *
+ * Shared by the load generator (loadgen/), the frame recorder
+ * (framelog/) and the sensor's fleet provisioning tool
+ * (firmware/sensor/provtool/): clocks, absolute sleeps, raw serial setup
+ * and a pseudo-terminal that looks to the hub like the bridge's USB
+ * serial port.
+ * Not part of the ESP32 build.
+ */
+
+#ifndef WAGGLE_BRIDGE_HOST_IO_H
+#define WAGGLE_BRIDGE_HOST_IO_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// ---- Clocks ----
+
+inline uint64_t host_mono_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+inline int64_t host_wall_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+inline void host_sleep_until_ns(uint64_t deadline) {
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(deadline / 1000000000ULL);
+    ts.tv_nsec = (long)(deadline % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+// ---- File descriptors ----
+
+inline bool host_write_all(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("write");
+            return false;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+inline speed_t host_baud_constant(uint32_t baud) {
+    switch (baud) {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+        default:      return B0;
+    }
+}
+
+/**
+ * Put a tty into raw 8N1 mode (no echo, no line discipline, 0x00 passes
+ * through).  baud = 0 leaves the speed alone (pseudo-terminals).
+ * Returns false on an unsupported baud rate or a termios error.
+ */
+inline bool host_tty_raw(int fd, uint32_t baud) {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        return false;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN]  = 1;
+    tio.c_cc[VTIME] = 0;
+    if (baud != 0) {
+        speed_t speed = host_baud_constant(baud);
+        if (speed == B0) {
+            fprintf(stderr, "unsupported baud rate %u\n", (unsigned)baud);
+            return false;
+        }
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+    }
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+/**
+ * Create a pseudo-terminal for the hub to open in place of /dev/ttyUSB0.
+ *
+ * Returns the master fd (write frames here) and fills slave_path.  The
+ * slave is held open in raw mode via *slave_fd so writes queue instead of
+ * failing with EIO until the consumer opens it.  With link set, a symlink
+ * to the slave is created (remove it with unlink() on exit).
+ * Returns -1 on error.
+ */
+inline int host_open_pty(const char* link, char* slave_path, size_t slave_len, int* slave_fd) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+    const char* name = ptsname(master);
+    if (name == nullptr) {
+        perror("ptsname");
+        return -1;
+    }
+    snprintf(slave_path, slave_len, "%s", name);
+
+    *slave_fd = open(slave_path, O_RDWR | O_NOCTTY);
+    if (*slave_fd < 0) {
+        perror("open pty slave");
+        return -1;
+    }
+    host_tty_raw(*slave_fd, 0);
+
+    if (link != nullptr) {
+        unlink(link);
+        if (symlink(slave_path, link) != 0) {
+            perror("symlink");
+            return -1;
+        }
+    }
+    return master;
+}
+
+#endif  // WAGGLE_BRIDGE_HOST_IO_H
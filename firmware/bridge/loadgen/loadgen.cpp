@@ -0,0 +1,520 @@
+/**
+ * Waggle Bridge — Synthetic apiary load generator.
+ *
+ * Host-only (Linux).  Pretends to be a bridge with N sensor nodes behind
+ * it: builds Phase 1 / Phase 2 payloads with the sensor firmware's own
+ * payload builders, prepends a per-hive MAC, COBS-encodes with the
+ * bridge's encoder and writes [COBS][0x00] frames to a pseudo-terminal,
+ * byte for byte what the Pi reads from /dev/ttyUSB0.
+ *
+ * Each hive reports every --interval-ms (staggered), with optional loss
+ * (frame never reaches the bridge; sequence still advances), duplicates
+ * (ESP-NOW retransmit after a lost ACK) and corruption (payload bit flip,
+ * fails CRC-8).  Writes are paced at --baud like the real UART.
+ *
+ * With --db the tool then watches the hub's SQLite database and reports
+ * end-to-end ingest throughput and latency percentiles (pty write →
+ * sensor_readings.ingested_at) plus missing and duplicate rows.
+ *
+ * Build and run (the consumer opens the printed pty path):
+ *   pio run -e loadgen
+ *   .pio/build/loadgen/program --hives 100 --interval-ms 1000 --duration-s 60 \
+ *       --link /tmp/ttyWAGGLE --db /var/lib/waggle/waggle.db
+ *   python -m benchmarks.serial_pipeline --device /tmp/ttyWAGGLE ...   (backend/)
+ */
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#ifndef LOADGEN_NO_SQLITE
+#include <sqlite3.h>
+#endif
+
+#include "../host/host_io.h"
+#include "../src/cobs.h"
+#include "../src/config.h"
+#include "../../sensor/src/payload.h"
+
+#define MAX_HIVES 250  // hives.id CHECK constraint on the hub
+
+// ---- Options ----
+
+struct Options {
+    int         hives        = 20;
+    uint32_t    interval_ms  = 60000;
+    uint32_t    duration_s   = 60;
+    uint32_t    phase1_pct   = 0;
+    double      loss_pct     = 0.0;
+    double      dup_pct      = 0.0;
+    double      corrupt_pct  = 0.0;
+    uint32_t    baud         = SERIAL_BAUD;
+    uint32_t    start_delay_s = 3;
+    uint32_t    drain_s      = 10;
+    uint32_t    seed         = 0;
+    const char* link         = nullptr;
+    const char* out          = nullptr;
+    const char* db           = nullptr;
+};
+
+// ---- Per-hive state and send log ----
+
+struct Hive {
+    uint8_t  id;
+    uint8_t  mac[MAC_LEN];
+    uint16_t sequence;
+    int32_t  base_weight_g;
+    uint64_t next_due_ns;
+};
+
+enum Fate : uint8_t { SENT, SENT_TWICE, CORRUPTED, LOST };
+
+struct SendRecord {
+    uint8_t  hive_id;
+    uint16_t sequence;
+    uint8_t  fate;
+    int64_t  sent_ms;     // Wall clock (CLOCK_REALTIME), ms since epoch
+    int64_t  stored_ms;   // ingested_at of the first matching row, 0 = none
+    uint16_t rows;        // Matching rows found in sensor_readings
+};
+
+static uint32_t s_rng = 1;
+
+static uint32_t rng_next() {
+    // xorshift32
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double rng_pct() {
+    return (rng_next() % 1000000) / 10000.0;  // [0, 100)
+}
+
+// ---- Payload synthesis ----
+
+// Realistic values that pass the hub's range checks.  Traffic follows
+// the local time of day; flags stay 0 so no reading is nulled.
+static size_t build_payload(Hive* h, bool phase1, uint8_t* out) {
+    time_t now = time(nullptr);
+    struct tm lt;
+    localtime_r(&now, &lt);
+    double hour = lt.tm_hour + lt.tm_min / 60.0;
+    double sun = sin((hour - 6.0) / 12.0 * M_PI);  // >0 between 06:00 and 18:00
+    if (sun < 0) {
+        sun = 0;
+    }
+
+    int32_t  weight   = h->base_weight_g - (int32_t)(300 * sun) + (int32_t)(rng_next() % 50);
+    int16_t  temp     = (int16_t)(1500 + 800 * sun + (int)(rng_next() % 40));
+    uint16_t humidity = (uint16_t)(5500 + rng_next() % 1000);
+    uint16_t pressure = (uint16_t)(10100 + rng_next() % 60);
+    uint16_t battery  = (uint16_t)(3700 + rng_next() % 400);
+
+    if (phase1) {
+        sensor_payload_t p;
+        payload_build(&p, h->id, h->sequence, weight, temp, humidity, pressure, battery, 0);
+        memcpy(out, &p, sizeof(p));
+        return sizeof(p);
+    }
+
+    uint16_t bees_in  = (uint16_t)(sun * 400 + rng_next() % 20);
+    uint16_t bees_out = (uint16_t)(sun * 400 + rng_next() % 20);
+    bee_count_payload_t p;
+    payload_build_v2(&p, h->id, h->sequence, weight, temp, humidity, pressure, battery, 0,
+                     bees_in, bees_out, 60000, 0x0F, 0x00);
+    memcpy(out, &p, sizeof(p));
+    return sizeof(p);
+}
+
+// [MAC][payload] → COBS → 0x00.  Returns the wire length.
+static size_t frame_wire(const Hive* h, const uint8_t* payload, size_t len, uint8_t* wire) {
+    uint8_t frame[MAX_DECODED_SIZE];
+    memcpy(frame, h->mac, MAC_LEN);
+    memcpy(frame + MAC_LEN, payload, len);
+    size_t n = cobs_encode(frame, MAC_LEN + len, wire);
+    wire[n++] = FRAME_DELIMITER;
+    return n;
+}
+
+// ---- Ingest measurement (SQLite) ----
+
+#ifndef LOADGEN_NO_SQLITE
+
+// Parse the hub's canonical "YYYY-MM-DDTHH:MM:SS.mmmZ" into epoch ms.
+static int64_t parse_iso_ms(const char* s) {
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    int ms = 0;
+    if (sscanf(s, "%d-%d-%dT%d:%d:%d.%dZ", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+               &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &ms) != 7) {
+        return 0;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    return (int64_t)timegm(&tm) * 1000 + ms;
+}
+
+static void format_iso_ms(int64_t ms, char* out, size_t len) {
+    time_t secs = (time_t)(ms / 1000);
+    struct tm tm;
+    gmtime_r(&secs, &tm);
+    snprintf(out, len, "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", tm.tm_year + 1900,
+             tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, (int)(ms % 1000));
+}
+
+// Match rows ingested since start_ms to the send log.  Returns the number
+// of records with at least one row.
+static size_t match_rows(sqlite3* db, int64_t start_ms, int hives,
+                         std::vector<SendRecord>& log,
+                         std::vector<std::vector<int32_t> >& index) {
+    char since[80];
+    format_iso_ms(start_ms, since, sizeof(since));
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db,
+            "SELECT hive_id, sequence, ingested_at FROM sensor_readings "
+            "WHERE ingested_at >= ?1 AND hive_id BETWEEN 1 AND ?2",
+            -1, &stmt, nullptr) != SQLITE_OK) {
+        fprintf(stderr, "sqlite: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    sqlite3_bind_text(stmt, 1, since, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 2, hives);
+
+    for (SendRecord& r : log) {
+        r.rows = 0;
+        r.stored_ms = 0;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int hive = sqlite3_column_int(stmt, 0);
+        int seq  = sqlite3_column_int(stmt, 1);
+        const char* at = (const char*)sqlite3_column_text(stmt, 2);
+        if (hive < 1 || hive > hives || seq < 0 || seq > 65535 || at == nullptr) {
+            continue;
+        }
+        int32_t idx = index[hive][seq];
+        if (idx < 0) {
+            continue;
+        }
+        SendRecord& r = log[idx];
+        int64_t ms = parse_iso_ms(at);
+        if (r.rows == 0 || ms < r.stored_ms) {
+            r.stored_ms = ms;
+        }
+        r.rows++;
+    }
+    sqlite3_finalize(stmt);
+
+    size_t matched = 0;
+    for (const SendRecord& r : log) {
+        matched += (r.rows > 0);
+    }
+    return matched;
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t i = (size_t)ceil(p / 100.0 * sorted.size());
+    return sorted[i == 0 ? 0 : i - 1];
+}
+
+static void report_ingest(const Options& opt, int64_t start_ms, std::vector<SendRecord>& log) {
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(opt.db, &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        fprintf(stderr, "cannot open %s: %s\n", opt.db, sqlite3_errmsg(db));
+        sqlite3_close(db);
+        return;
+    }
+    sqlite3_busy_timeout(db, 1000);
+
+    // (hive, sequence) → log index; a hive sending > 65536 frames in one
+    // run would alias, so only the latest record per key is tracked.
+    std::vector<std::vector<int32_t> > index(opt.hives + 1, std::vector<int32_t>(65536, -1));
+    size_t expected = 0;
+    for (size_t i = 0; i < log.size(); i++) {
+        index[log[i].hive_id][log[i].sequence] = (int32_t)i;
+        expected += (log[i].fate == SENT || log[i].fate == SENT_TWICE);
+    }
+
+    // Drain: poll until everything deliverable arrived, or nothing new for
+    // two seconds, or --drain-s expires
+    uint64_t deadline = host_mono_ns() + (uint64_t)opt.drain_s * 1000000000ULL;
+    size_t matched = 0;
+    size_t last = (size_t)-1;
+    uint64_t last_change = host_mono_ns();
+    for (;;) {
+        matched = match_rows(db, start_ms, opt.hives, log, index);
+        uint64_t now = host_mono_ns();
+        if (matched != last) {
+            last = matched;
+            last_change = now;
+        }
+        if (matched >= expected || now >= deadline ||
+            now - last_change >= 2000000000ULL) {
+            break;
+        }
+        usleep(250000);
+    }
+    sqlite3_close(db);
+
+    std::vector<double> latency;
+    size_t missing = 0, dup_rows = 0, leaked = 0;
+    int64_t first_sent = 0, last_stored = 0;
+    for (const SendRecord& r : log) {
+        bool deliverable = (r.fate == SENT || r.fate == SENT_TWICE);
+        if (r.rows > 0) {
+            if (!deliverable) {
+                leaked++;  // Lost or corrupted frame was stored
+                continue;
+            }
+            latency.push_back((double)(r.stored_ms - r.sent_ms));
+            dup_rows += r.rows - 1;
+            if (first_sent == 0 || r.sent_ms < first_sent) {
+                first_sent = r.sent_ms;
+            }
+            last_stored = std::max(last_stored, r.stored_ms);
+        } else if (deliverable) {
+            missing++;
+        }
+    }
+    std::sort(latency.begin(), latency.end());
+
+    double span_s = (last_stored - first_sent) / 1000.0;
+    printf("\ningest (%s)\n", opt.db);
+    printf("  stored         %zu / %zu deliverable frames (%zu missing)\n",
+           latency.size(), expected, missing);
+    printf("  duplicates     %zu extra rows, %zu lost/corrupt frames stored\n",
+           dup_rows, leaked);
+    printf("  throughput     %.1f rows/s\n", span_s > 0 ? latency.size() / span_s : 0.0);
+    printf("  latency ms     p50 %.0f  p90 %.0f  p99 %.0f  p99.9 %.0f  max %.0f\n",
+           percentile(latency, 50), percentile(latency, 90), percentile(latency, 99),
+           percentile(latency, 99.9), latency.empty() ? 0.0 : latency.back());
+    printf("  (ingested_at has 1 ms resolution; pty write and hub share one clock)\n");
+}
+
+#endif  // LOADGEN_NO_SQLITE
+
+// ---- Main ----
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --hives N          simulated hives, 1-%d (default 20)\n"
+        "  --interval-ms N    report interval per hive (default 60000)\n"
+        "  --duration-s N     run time (default 60)\n"
+        "  --phase1-pct N     share of 32-byte Phase 1 payloads (default 0)\n"
+        "  --loss-pct F       frames lost before the bridge (default 0)\n"
+        "  --dup-pct F        frames delivered twice (default 0)\n"
+        "  --corrupt-pct F    frames with a flipped bit (default 0)\n"
+        "  --baud N           UART pacing, 0 = unpaced (default %u)\n"
+        "  --link PATH        symlink to the pty (e.g. /tmp/ttyWAGGLE)\n"
+        "  --out PATH         write to a file instead of a pty ('-' = stdout)\n"
+        "  --start-delay-s N  wait for the consumer to open the pty (default 3)\n"
+        "  --db PATH          report ingest latency from this SQLite database\n"
+        "  --drain-s N        max wait for the pipeline to catch up (default 10)\n"
+        "  --seed N           PRNG seed (default: time)\n",
+        argv0, MAX_HIVES, (unsigned)SERIAL_BAUD);
+    exit(2);
+}
+
+static void parse_args(int argc, char** argv, Options* opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (v == nullptr) {
+            usage(argv[0]);
+        }
+        i++;
+        if (strcmp(a, "--hives") == 0)              opt->hives = atoi(v);
+        else if (strcmp(a, "--interval-ms") == 0)   opt->interval_ms = (uint32_t)atol(v);
+        else if (strcmp(a, "--duration-s") == 0)    opt->duration_s = (uint32_t)atol(v);
+        else if (strcmp(a, "--phase1-pct") == 0)    opt->phase1_pct = (uint32_t)atol(v);
+        else if (strcmp(a, "--loss-pct") == 0)      opt->loss_pct = atof(v);
+        else if (strcmp(a, "--dup-pct") == 0)       opt->dup_pct = atof(v);
+        else if (strcmp(a, "--corrupt-pct") == 0)   opt->corrupt_pct = atof(v);
+        else if (strcmp(a, "--baud") == 0)          opt->baud = (uint32_t)atol(v);
+        else if (strcmp(a, "--link") == 0)          opt->link = v;
+        else if (strcmp(a, "--out") == 0)           opt->out = v;
+        else if (strcmp(a, "--start-delay-s") == 0) opt->start_delay_s = (uint32_t)atol(v);
+        else if (strcmp(a, "--db") == 0)            opt->db = v;
+        else if (strcmp(a, "--drain-s") == 0)       opt->drain_s = (uint32_t)atol(v);
+        else if (strcmp(a, "--seed") == 0)          opt->seed = (uint32_t)atol(v);
+        else usage(argv[0]);
+    }
+    if (opt->hives < 1 || opt->hives > MAX_HIVES || opt->interval_ms == 0 ||
+        opt->phase1_pct > 100) {
+        usage(argv[0]);
+    }
+#ifdef LOADGEN_NO_SQLITE
+    if (opt->db != nullptr) {
+        fprintf(stderr, "built without SQLite; --db is unavailable\n");
+        exit(2);
+    }
+#endif
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    parse_args(argc, argv, &opt);
+    s_rng = opt.seed ? opt.seed : (uint32_t)(time(nullptr) ^ getpid());
+    if (s_rng == 0) {
+        s_rng = 1;
+    }
+
+    // Output
+    int fd = -1;
+    int slave_fd = -1;
+    if (opt.out != nullptr) {
+        fd = (strcmp(opt.out, "-") == 0) ? STDOUT_FILENO
+                                         : open(opt.out, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            perror(opt.out);
+            return 1;
+        }
+    } else {
+        char slave[64];
+        fd = host_open_pty(opt.link, slave, sizeof(slave), &slave_fd);
+        if (fd < 0) {
+            return 1;
+        }
+        fprintf(stderr, "pty: %s%s%s\n", slave, opt.link ? " -> " : "", opt.link ? opt.link : "");
+    }
+
+    // Hives: random starting sequences so back-to-back runs don't collide
+    // with the ingestion dedup cache (30 min TTL)
+    std::vector<Hive> hives(opt.hives);
+    for (int i = 0; i < opt.hives; i++) {
+        Hive& h = hives[i];
+        h.id = (uint8_t)(i + 1);
+        const uint8_t mac[MAC_LEN] = {0x24, 0x6F, 0x28, 0x10, 0x00, h.id};
+        memcpy(h.mac, mac, MAC_LEN);
+        h.sequence = (uint16_t)rng_next();
+        h.base_weight_g = 30000 + (int32_t)(rng_next() % 30000);
+    }
+
+    double rate = opt.hives * 1000.0 / opt.interval_ms;
+    fprintf(stderr, "%d hives, %.1f frames/s offered, %u s, loss %.1f%% dup %.1f%% corrupt %.1f%%\n",
+            opt.hives, rate, opt.duration_s, opt.loss_pct, opt.dup_pct, opt.corrupt_pct);
+    if (opt.start_delay_s > 0 && opt.out == nullptr) {
+        fprintf(stderr, "starting in %u s...\n", opt.start_delay_s);
+        sleep(opt.start_delay_s);
+    }
+
+    uint64_t t0 = host_mono_ns();
+    uint64_t interval_ns = (uint64_t)opt.interval_ms * 1000000ULL;
+    for (int i = 0; i < opt.hives; i++) {
+        hives[i].next_due_ns = t0 + interval_ns * i / opt.hives;  // Staggered
+    }
+    uint64_t end = t0 + (uint64_t)opt.duration_s * 1000000000ULL;
+    int64_t start_wall = host_wall_ns() / 1000000;
+
+    // UART pacing: 10 bits per byte on the wire
+    double ns_per_byte = opt.baud ? 1e10 / opt.baud : 0.0;
+    uint64_t line_free_ns = t0;
+
+    std::vector<SendRecord> log;
+    uint64_t frames = 0, bytes = 0, late = 0;
+    uint8_t payload[PAYLOAD_LEN_P2];
+    uint8_t wire[WIRE_MAX];
+
+    for (;;) {
+        Hive* h = &hives[0];
+        for (Hive& c : hives) {
+            if (c.next_due_ns < h->next_due_ns) {
+                h = &c;
+            }
+        }
+        if (h->next_due_ns >= end) {
+            break;
+        }
+        uint64_t due = std::max(h->next_due_ns, line_free_ns);
+        host_sleep_until_ns(due);
+        if (due > h->next_due_ns + 1000000ULL) {
+            late++;  // UART (or the reader) can't keep up with the offered rate
+        }
+        h->next_due_ns += interval_ns;
+
+        bool phase1 = (rng_next() % 100) < opt.phase1_pct;
+        size_t len = build_payload(h, phase1, payload);
+
+        SendRecord rec;
+        rec.hive_id = h->id;
+        rec.sequence = h->sequence++;
+        rec.stored_ms = 0;
+        rec.rows = 0;
+
+        if (rng_pct() < opt.loss_pct) {
+            rec.fate = LOST;
+            rec.sent_ms = host_wall_ns() / 1000000;
+            log.push_back(rec);
+            continue;
+        }
+        if (rng_pct() < opt.corrupt_pct) {
+            payload[4 + rng_next() % 12] ^= (uint8_t)(1u << (rng_next() % 8));
+            rec.fate = CORRUPTED;
+        } else {
+            rec.fate = (rng_pct() < opt.dup_pct) ? SENT_TWICE : SENT;
+        }
+
+        size_t n = frame_wire(h, payload, len, wire);
+        int copies = (rec.fate == SENT_TWICE) ? 2 : 1;
+        rec.sent_ms = host_wall_ns() / 1000000;
+        for (int c = 0; c < copies; c++) {
+            if (!host_write_all(fd, wire, n)) {
+                return 1;
+            }
+            frames++;
+            bytes += n;
+        }
+        line_free_ns = host_mono_ns() + (uint64_t)(ns_per_byte * n * copies);
+        log.push_back(rec);
+    }
+
+    double elapsed = (host_mono_ns() - t0) / 1e9;
+    size_t lost = 0, corrupted = 0, twice = 0;
+    for (const SendRecord& r : log) {
+        lost += (r.fate == LOST);
+        corrupted += (r.fate == CORRUPTED);
+        twice += (r.fate == SENT_TWICE);
+    }
+    printf("generated        %zu reports in %.1f s (%.1f/s)\n", log.size(), elapsed,
+           log.size() / elapsed);
+    printf("written          %llu frames, %llu bytes (%.0f B/s)\n",
+           (unsigned long long)frames, (unsigned long long)bytes, bytes / elapsed);
+    printf("faults           %zu lost, %zu duplicated, %zu corrupted\n", lost, twice, corrupted);
+    if (late > 0) {
+        printf("late             %llu frames behind schedule (UART at %u baud saturated?)\n",
+               (unsigned long long)late, opt.baud);
+    }
+    fflush(stdout);
+
+#ifndef LOADGEN_NO_SQLITE
+    if (opt.db != nullptr) {
+        report_ingest(opt, start_wall, log);
+    }
+#else
+    (void)start_wall;
+#endif
+
+    if (slave_fd >= 0) {
+        // Let the consumer drain what is still queued in the pty
+        tcdrain(fd);
+        close(slave_fd);
+    }
+    if (opt.link != nullptr) {
+        unlink(opt.link);
+    }
+    return 0;
+}
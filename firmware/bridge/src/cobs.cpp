@@ -1,5 +1,5 @@
 /**
- * Waggle Bridge — COBS encoder implementation.
+ * Waggle Bridge — COBS encoder and decoder implementation.
  *
  * Algorithm:
  *   Walk the input, collecting runs of non-zero bytes. Each run is preceded
@@ -8,11 +8,17 @@
  *   an implicit zero). If a run reaches 254 non-zero bytes (code would be
  *   0xFF), the block is flushed WITHOUT an implicit zero.
  *
- * This matches the Python encoder in backend/waggle/utils/cobs.py exactly.
+ * Decoding reverses this: each code byte is followed by (code - 1) data
+ *   bytes, then an implicit zero unless the code was 0xFF or the frame ends.
+ *
+ * This matches the Python encoder and decoder in backend/waggle/utils/cobs.py
+ * exactly.
  */
 
 #include "cobs.h"
 
+#include <string.h>
+
 size_t cobs_encode(const uint8_t* input, size_t len, uint8_t* output) {
     size_t write_idx = 0;
     size_t code_idx  = 0;
@@ -52,3 +58,37 @@ size_t cobs_encode(const uint8_t* input, size_t len, uint8_t* output) {
 
     return write_idx;
 }
+
+size_t cobs_decode(const uint8_t* input, size_t len, uint8_t* output, size_t out_cap) {
+    size_t read_idx  = 0;
+    size_t write_idx = 0;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    while (read_idx < len) {
+        uint8_t code = input[read_idx++];
+        if (code == 0) {
+            return 0;  // A code byte can never be zero
+        }
+
+        size_t n_data = (size_t)code - 1;
+        if (n_data > len - read_idx || n_data > out_cap - write_idx) {
+            return 0;  // Truncated block or output overflow
+        }
+        memcpy(output + write_idx, input + read_idx, n_data);
+        read_idx += n_data;
+        write_idx += n_data;
+
+        // Implicit zero after a short block, except at the end of the frame
+        if (code < 0xFF && read_idx < len) {
+            if (write_idx >= out_cap) {
+                return 0;
+            }
+            output[write_idx++] = 0;
+        }
+    }
+
+    return write_idx;
+}
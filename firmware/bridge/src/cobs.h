@@ -1,5 +1,5 @@
 /**
- * Waggle Bridge — COBS (Consistent Overhead Byte Stuffing) encoder.
+ * Waggle Bridge — COBS (Consistent Overhead Byte Stuffing) encoder and decoder.
  *
  * Encodes arbitrary binary data so that the output contains no zero bytes,
  * allowing 0x00 to be used as an unambiguous frame delimiter on the serial
@@ -7,6 +7,8 @@
  *
  * This implementation MUST produce output identical to the Python encoder
  * in backend/waggle/utils/cobs.py so the Pi can decode frames correctly.
+ * The decoder is used on the hub side by the native frame decoder
+ * (backend/native) and the host tools.
  */
 
 #ifndef WAGGLE_BRIDGE_COBS_H
@@ -29,4 +31,19 @@
  */
 size_t cobs_encode(const uint8_t* input, size_t len, uint8_t* output);
 
+/**
+ * Decode one COBS frame (without its 0x00 delimiter).
+ *
+ * @param input    Encoded bytes.
+ * @param len      Number of encoded bytes.
+ * @param output   Destination buffer; decoded data is always shorter than
+ *                 the input, so len bytes is always enough.
+ * @param out_cap  Size of `output`.
+ * @return         Number of decoded bytes, or 0 if the frame is malformed
+ *                 (empty, zero code byte, truncated block, or does not fit).
+ *
+ * Accepts exactly what backend/waggle/utils/cobs.py cobs_decode() accepts.
+ */
+size_t cobs_decode(const uint8_t* input, size_t len, uint8_t* output, size_t out_cap);
+
 #endif // WAGGLE_BRIDGE_COBS_H
@@ -4,6 +4,9 @@
  * The bridge receives ESP-NOW payloads from sensor nodes (32-byte Phase 1
  * or 48-byte Phase 2), prepends the sender's 6-byte MAC, COBS-encodes the
  * frame (38 or 54 bytes), and ships it over USB serial to the Pi hub.
+ * Payloads lost on the air are rebuilt from FEC parity when the node
+ * sends it (UPLINK_FEC_GROUP in the sensor firmware).  44-byte thermal
+ * array payloads (msg_type 0x04) are forwarded as 50-byte frames.
  */
 
 #ifndef WAGGLE_BRIDGE_CONFIG_H
@@ -28,9 +31,41 @@ static constexpr size_t FRAME_LEN_P1         = MAC_LEN + PAYLOAD_LEN_P1;  // 38
 static constexpr size_t PAYLOAD_LEN_P2       = 48;
 static constexpr size_t FRAME_LEN_P2         = MAC_LEN + PAYLOAD_LEN_P2;  // 54 bytes
 
+// FEC parity payload (msg_type 0x03, firmware/sensor/src/fec.h): consumed
+// by the bridge, which forwards the Phase 2 payload it rebuilds instead.
+static constexpr size_t PAYLOAD_LEN_PARITY   = 32;
+
+// Thermal array: 44-byte brood temperature payload (msg_type 0x04,
+// firmware/sensor/src/thermal.h) -> 50-byte frame
+static constexpr size_t PAYLOAD_LEN_THERMAL  = 44;
+static constexpr size_t FRAME_LEN_THERMAL    = MAC_LEN + PAYLOAD_LEN_THERMAL;  // 50 bytes
+
+// Sensor nodes whose recent payloads are kept for FEC rebuilds; the
+// least recently heard node is dropped when a new one appears.
+static constexpr size_t FEC_PEERS            = 16;
+
+// Optional RSSI trailer: [MAC][payload][rssi:int8] (39, 51 or 55 bytes).
+// Built with -DBRIDGE_RSSI_TRAILER=1 (env:bridge-rssi) for apiaries with
+// several bridges; the hub aggregator (backend/native/aggregator) uses it
+// to pick the best-placed bridge and strips it before the hub decoders.
+// 0 means unknown.
+#ifndef BRIDGE_RSSI_TRAILER
+#define BRIDGE_RSSI_TRAILER 0
+#endif
+static constexpr size_t RSSI_TRAILER_LEN     = BRIDGE_RSSI_TRAILER ? 1 : 0;
+
+// Before IDF 5.1 the ESP-NOW receive callback has no RSSI, so the bridge
+// sniffs it from the action frame carrying each packet (promiscuous mode,
+// management frames only).  Senders remembered, and how old a sniffed
+// RSSI may be when the ESP-NOW callback for the same packet runs.
+static constexpr size_t   RSSI_PEERS         = 16;
+static constexpr uint32_t RSSI_MAX_AGE_MS    = 50;
+
 // Maximum decoded frame size (must hold the largest frame)
 static constexpr size_t MAX_DECODED_SIZE     = 64;
 
+static_assert(FRAME_LEN_P2 + RSSI_TRAILER_LEN <= MAX_DECODED_SIZE, "frame buffer too small");
+
 // COBS worst-case output for N bytes = N + ceil(N/254) bytes.
 // For 64 bytes: 64 + 1 = 65 (max). We allocate 70 for safety.
 static constexpr size_t COBS_MAX_OUTPUT      = 70;
@@ -4,10 +4,18 @@
  * Data flow:
  *   1. Sensor node sends payload via ESP-NOW (32 bytes Phase 1, 48 bytes Phase 2).
  *   2. ESP-NOW callback fires with sender MAC (6 bytes) + payload.
- *   3. We build a frame: [MAC][payload] (38 or 54 bytes).
- *   4. COBS-encode the frame and append 0x00 delimiter.
+ *   3. We build a frame: [MAC][payload] (38 or 54 bytes), plus a 1-byte
+ *      RSSI trailer when built with BRIDGE_RSSI_TRAILER (env:bridge-rssi).
+ *   4. Stamp the bridge half of a Phase 2 payload's latency trace (receive
+ *      time and hold time; see firmware/sensor/src/payload.h), then
+ *      COBS-encode the frame and append 0x00 delimiter.
  *   5. Write [COBS bytes][0x00 delimiter] to Serial (USB).
  *   6. Pi hub reads from /dev/ttyUSBx, decodes COBS, and processes.
+ *
+ * FEC parity payloads (msg_type 0x03, 32 bytes) are not forwarded.  The
+ * bridge keeps each node's recent Phase 2 payloads and, when a parity
+ * shows exactly one of its group missing, rebuilds that payload and
+ * forwards it as if it had arrived (see firmware/sensor/src/fec.h).
  */
 
 #ifndef UNIT_TEST  // Exclude hardware code from native test builds
@@ -20,6 +28,7 @@
 
 #include "cobs.h"
 #include "config.h"
+#include "../../sensor/src/fec.h"
 
 // LED state toggle for visual feedback
 static volatile bool led_state = false;
@@ -27,14 +36,158 @@ static volatile bool led_state = false;
 // Error counter for unexpected payload sizes (for diagnostics)
 static volatile uint32_t err_bad_len = 0;
 
+// Payloads rebuilt from FEC parity (for diagnostics)
+static volatile uint32_t fec_recovered = 0;
+
+// Recent payloads per sensor node.  Only touched from the receive callback.
+struct FecPeer {
+    uint8_t    mac[MAC_LEN];
+    bool       used;
+    uint32_t   last_ms;
+    FecDecoder decoder;
+};
+static FecPeer fec_peers[FEC_PEERS];
+
+// The decoder for `mac`, taking over the least recently heard slot for a
+// node not seen before.
+static FecDecoder* fec_decoder_for(const uint8_t* mac) {
+    uint32_t now = millis();
+    FecPeer* victim = &fec_peers[0];
+    for (size_t i = 0; i < FEC_PEERS; i++) {
+        FecPeer* peer = &fec_peers[i];
+        if (peer->used && memcmp(peer->mac, mac, MAC_LEN) == 0) {
+            peer->last_ms = now;
+            return &peer->decoder;
+        }
+        if (!peer->used) {
+            if (victim->used) {
+                victim = peer;
+            }
+        } else if (victim->used && (now - peer->last_ms) > (now - victim->last_ms)) {
+            victim = peer;
+        }
+    }
+    memcpy(victim->mac, mac, MAC_LEN);
+    victim->used = true;
+    victim->last_ms = now;
+    fec_decoder_reset(&victim->decoder);
+    return &victim->decoder;
+}
+
+#if BRIDGE_RSSI_TRAILER && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 1, 0)
+/*
+ * RSSI of ESP-NOW packets on IDF 4.4, whose receive callback has none.
+ * Each packet arrives as an 802.11 action frame (vendor-specific category,
+ * Espressif OUI); the promiscuous callback sees that frame, with its
+ * rx_ctrl.rssi, just before ESP-NOW delivers the payload.  Both callbacks
+ * run in the WiFi task, so the table needs no locking.
+ */
+struct RssiPeer {
+    uint8_t  mac[MAC_LEN];
+    int8_t   rssi;
+    uint32_t at_ms;
+};
+static RssiPeer rssi_peers[RSSI_PEERS];
+static size_t   rssi_next = 0;  // Slot for the next new sender (round robin)
+
+static constexpr size_t ESPNOW_HDR_LEN = 24;  // 802.11 management header
+static constexpr size_t ESPNOW_SRC_OFF = 10;  // Transmitter address (addr2)
+
+static void on_promisc_rx(void* buf, wifi_promiscuous_pkt_type_t type) {
+    if (type != WIFI_PKT_MGMT) {
+        return;
+    }
+    const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)buf;
+    const uint8_t* f = pkt->payload;
+    // Action frame (subtype 13), category 127 (vendor specific), OUI 18:FE:34
+    if (pkt->rx_ctrl.sig_len < ESPNOW_HDR_LEN + 4 || f[0] != 0xD0 ||
+        f[ESPNOW_HDR_LEN] != 127 || f[ESPNOW_HDR_LEN + 1] != 0x18 ||
+        f[ESPNOW_HDR_LEN + 2] != 0xFE || f[ESPNOW_HDR_LEN + 3] != 0x34) {
+        return;
+    }
+    const uint8_t* src = f + ESPNOW_SRC_OFF;
+    RssiPeer* peer = nullptr;
+    for (size_t i = 0; i < RSSI_PEERS; i++) {
+        if (memcmp(rssi_peers[i].mac, src, MAC_LEN) == 0) {
+            peer = &rssi_peers[i];
+            break;
+        }
+    }
+    if (peer == nullptr) {
+        peer = &rssi_peers[rssi_next];
+        rssi_next = (rssi_next + 1) % RSSI_PEERS;
+        memcpy(peer->mac, src, MAC_LEN);
+    }
+    peer->rssi = (int8_t)pkt->rx_ctrl.rssi;
+    peer->at_ms = millis();
+}
+
+// The sniffed RSSI of the packet `mac` just sent, or 0 if none is fresh
+static int8_t sniffed_rssi(const uint8_t* mac) {
+    for (size_t i = 0; i < RSSI_PEERS; i++) {
+        const RssiPeer& peer = rssi_peers[i];
+        if (memcmp(peer.mac, mac, MAC_LEN) == 0) {
+            return millis() - peer.at_ms <= RSSI_MAX_AGE_MS ? peer.rssi : 0;
+        }
+    }
+    return 0;
+}
+
+static void rssi_sniff_begin() {
+    wifi_promiscuous_filter_t filter;
+    filter.filter_mask = WIFI_PROMIS_FILTER_MASK_MGMT;
+    esp_wifi_set_promiscuous_filter(&filter);
+    esp_wifi_set_promiscuous_rx_cb(on_promisc_rx);
+    esp_wifi_set_promiscuous(true);
+}
+#endif
+
+/**
+ * Frame [MAC][payload] (+ RSSI trailer), COBS-encode it and write it to
+ * the hub.  rx_ms/rx_us are millis()/micros() taken on entry to the
+ * receive callback, for the payload's latency trace.
+ */
+static void forward_frame(const uint8_t* mac, const uint8_t* data, size_t data_len, int8_t rssi,
+                          uint32_t rx_ms, uint32_t rx_us) {
+    // Build frame: [6-byte MAC][payload]
+    size_t frame_len = MAC_LEN + data_len;
+    uint8_t frame[MAX_DECODED_SIZE];
+    memcpy(frame, mac, MAC_LEN);
+    memcpy(frame + MAC_LEN, data, data_len);
+
+    // Traced payloads only; the hold time runs up to the serial write
+    payload_stamp_bridge(frame + MAC_LEN, data_len, rx_ms, micros() - rx_us);
+
+#if BRIDGE_RSSI_TRAILER
+    // [rssi] for the hub's multi-bridge aggregator; 0 = unknown
+    frame[frame_len++] = (uint8_t)rssi;
+#else
+    (void)rssi;
+#endif
+
+    // COBS-encode the frame
+    uint8_t encoded[COBS_MAX_OUTPUT];
+    size_t encoded_len = cobs_encode(frame, frame_len, encoded);
+
+    // Write to serial: [COBS data][0x00 delimiter]
+    Serial.write(encoded, encoded_len);
+    Serial.write(FRAME_DELIMITER);
+
+    // Toggle LED for visual feedback
+    led_state = !led_state;
+    digitalWrite(LED_PIN, led_state ? HIGH : LOW);
+}
+
 /**
  * ESP-NOW receive callback.
  *
  * Called from the WiFi task when an ESP-NOW packet arrives.
  * We validate the length, build the frame, COBS-encode, and write to Serial.
  *
- * Accepts Phase 1 payloads (32 bytes) and Phase 2 payloads (48 bytes).
- * The bridge does NOT parse payload content — it just forwards to the Pi hub.
+ * Accepts Phase 1 payloads (32 bytes), Phase 2 payloads (48 bytes) and
+ * thermal array payloads (44 bytes, msg_type 0x04).
+ * The bridge does NOT parse payload content — it just forwards to the Pi
+ * hub — except to keep Phase 2 payloads for FEC and to apply parity.
  *
  * Note: Serial.write() is safe to call from the ESP-NOW callback context
  * on ESP32 Arduino core because it only copies to the TX buffer.
@@ -42,35 +195,53 @@ static volatile uint32_t err_bad_len = 0;
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
 static void on_data_recv(const esp_now_recv_info_t* info, const uint8_t* data, int data_len) {
     const uint8_t* mac = info->src_addr;
+    int8_t rssi = (int8_t)info->rx_ctrl->rssi;
 #else
 static void on_data_recv(const uint8_t* mac, const uint8_t* data, int data_len) {
+#if BRIDGE_RSSI_TRAILER
+    int8_t rssi = sniffed_rssi(mac);
+#else
+    int8_t rssi = 0;
+#endif
 #endif
+    uint32_t rx_ms = millis();
+    uint32_t rx_us = micros();
 
-    // Validate expected payload size: Phase 1 (32 bytes) or Phase 2 (48 bytes)
-    if (data_len != (int)PAYLOAD_LEN_P1 && data_len != (int)PAYLOAD_LEN_P2) {
-        log_w("Unexpected payload size: %d (expected %d or %d)",
-              data_len, PAYLOAD_LEN_P1, PAYLOAD_LEN_P2);
+    bool parity = (data_len == (int)PAYLOAD_LEN_PARITY && data[1] == MSG_TYPE_PARITY);
+    bool thermal = (data_len == (int)PAYLOAD_LEN_THERMAL && data[1] == MSG_TYPE_THERMAL);
+
+    // Validate expected payload size: Phase 1 (32 bytes), Phase 2 (48 bytes)
+    // or thermal array (44 bytes)
+    if (!parity && !thermal && data_len != (int)PAYLOAD_LEN_P1 &&
+        data_len != (int)PAYLOAD_LEN_P2) {
+        log_w("Unexpected payload size: %d (expected %d, %d or %d)",
+              data_len, PAYLOAD_LEN_P1, PAYLOAD_LEN_P2, PAYLOAD_LEN_THERMAL);
         err_bad_len++;
         return;
     }
 
-    // Build frame: [6-byte MAC][payload]
-    const size_t frame_len = MAC_LEN + (size_t)data_len;
-    uint8_t frame[MAX_DECODED_SIZE];
-    memcpy(frame, mac, MAC_LEN);
-    memcpy(frame + MAC_LEN, data, (size_t)data_len);
-
-    // COBS-encode the frame
-    uint8_t encoded[COBS_MAX_OUTPUT];
-    size_t encoded_len = cobs_encode(frame, frame_len, encoded);
-
-    // Write to serial: [COBS data][0x00 delimiter]
-    Serial.write(encoded, encoded_len);
-    Serial.write(FRAME_DELIMITER);
+    if (parity) {
+        parity_payload_t p;
+        memcpy(&p, data, sizeof(p));
+        bee_count_payload_t rebuilt;
+        FecStatus status = fec_decoder_recover(fec_decoder_for(mac), &p, &rebuilt);
+        if (status == FEC_RECOVERED) {
+            fec_recovered++;
+            log_i("FEC: rebuilt hive %u seq %u", rebuilt.hive_id, rebuilt.sequence);
+            forward_frame(mac, (const uint8_t*)&rebuilt, sizeof(rebuilt), rssi, rx_ms, rx_us);
+        } else if (status != FEC_COMPLETE) {
+            log_w("FEC: hive %u seq %u+%u not recoverable (%u)",
+                  p.hive_id, p.first_seq, p.count, status);
+        }
+        return;
+    }
 
-    // Toggle LED for visual feedback
-    led_state = !led_state;
-    digitalWrite(LED_PIN, led_state ? HIGH : LOW);
+    if (data_len == (int)PAYLOAD_LEN_P2) {
+        bee_count_payload_t p;
+        memcpy(&p, data, sizeof(p));
+        fec_decoder_note(fec_decoder_for(mac), &p);
+    }
+    forward_frame(mac, data, (size_t)data_len, rssi, rx_ms, rx_us);
 }
 
 void setup() {
@@ -104,6 +275,9 @@ void setup() {
     }
 
     esp_now_register_recv_cb(on_data_recv);
+#if BRIDGE_RSSI_TRAILER && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 1, 0)
+    rssi_sniff_begin();
+#endif
 
     log_i("Waggle Bridge ready — listening for ESP-NOW packets");
 }
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Stand-in hub for the camera upload benchmark.
+
+Accepts POST /api/photos/upload the way the hub does at the HTTP level
+(HTTP/1.1 keep-alive, pipelined requests answered in order) without
+touching a database, so upload_bench can measure connection reuse and
+pipelining on a desktop.
+
+A WiFi link is simulated with --rtt-ms: every new connection pays one
+round trip before its first request is read (TCP handshake), and every
+response is delivered half a round trip after the request finished
+processing.  --process-ms is the hub's per-request handling time,
+served one request at a time per connection like uvicorn does.
+
+    python3 standin_server.py --port 8099 --rtt-ms 20 --process-ms 5
+"""
+
+import argparse
+import asyncio
+import json
+
+MAX_HEAD = 16384
+
+
+async def handle(reader, writer, args, stats):
+    loop = asyncio.get_running_loop()
+    stats["connections"] += 1
+    await asyncio.sleep(args.rtt_ms / 1000)
+
+    # Responses are written in request order by a single writer task;
+    # each one carries the loop time at which it may be delivered.
+    outbox = asyncio.Queue()
+
+    async def deliver():
+        while True:
+            item = await outbox.get()
+            if item is None:
+                break
+            due, data = item
+            delay = due - loop.time()
+            if delay > 0:
+                await asyncio.sleep(delay)
+            writer.write(data)
+            await writer.drain()
+
+    sender = asyncio.create_task(deliver())
+    served = 0
+    try:
+        while True:
+            try:
+                head = await reader.readuntil(b"\r\n\r\n")
+            except (asyncio.IncompleteReadError, asyncio.LimitOverrunError):
+                break
+            lines = head.decode("latin-1").split("\r\n")
+            method, path, _ = lines[0].split(" ", 2)
+            headers = {}
+            for line in lines[1:]:
+                if ":" in line:
+                    k, v = line.split(":", 1)
+                    headers[k.strip().lower()] = v.strip()
+            length = int(headers.get("content-length", "0"))
+            await reader.readexactly(length)
+
+            await asyncio.sleep(args.process_ms / 1000)
+            served += 1
+            stats["requests"] += 1
+            stats["bytes"] += length
+
+            ok = method == "POST" and path == "/api/photos/upload"
+            close = (args.max_requests > 0 and served >= args.max_requests) or \
+                headers.get("connection", "").lower() == "close"
+            body = json.dumps({"photo_id": stats["requests"], "status": "queued"}
+                              if ok else {"detail": "Not Found"}).encode()
+            status = "200 OK" if ok else "404 Not Found"
+            resp = (f"HTTP/1.1 {status}\r\n"
+                    f"content-type: application/json\r\n"
+                    f"content-length: {len(body)}\r\n"
+                    + ("connection: close\r\n" if close else "")
+                    + "\r\n").encode() + body
+            await outbox.put((loop.time() + args.rtt_ms / 2000, resp))
+            if close:
+                break
+    finally:
+        await outbox.put(None)
+        await sender
+        writer.close()
+
+
+async def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8099)
+    parser.add_argument("--rtt-ms", type=float, default=20.0,
+                        help="simulated WiFi round-trip time")
+    parser.add_argument("--process-ms", type=float, default=5.0,
+                        help="per-request handling time")
+    parser.add_argument("--max-requests", type=int, default=0,
+                        help="close keep-alive connections after N requests (0 = never)")
+    args = parser.parse_args()
+
+    stats = {"connections": 0, "requests": 0, "bytes": 0}
+    server = await asyncio.start_server(
+        lambda r, w: handle(r, w, args, stats), args.host, args.port, limit=MAX_HEAD)
+    print(f"Stand-in hub on http://{args.host}:{args.port} "
+          f"(rtt {args.rtt_ms} ms, process {args.process_ms} ms)", flush=True)
+    try:
+        async with server:
+            await server.serve_forever()
+    finally:
+        print(json.dumps(stats), flush=True)
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
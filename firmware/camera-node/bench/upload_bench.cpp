@@ -0,0 +1,318 @@
+// Waggle Camera Node — Upload benchmark against the stand-in hub.
+//
+// Host-only (POSIX sockets).  Sends the same multipart photo uploads the
+// camera does, framed and parsed with http_pipeline, in three modes:
+//
+//   fresh      new TCP connection per image (what upload_photo() does)
+//   keepalive  one connection, one request in flight
+//   pipelined  one connection, --depth requests in flight
+//
+// and reports images per second plus an estimated radio energy per
+// image.  Energy is modelled, not measured: the ESP32 modem is assumed
+// to stay active for the whole upload window at --radio-ma and --volts,
+// so it scales directly with wall time.
+//
+// Build and run (stand-in server in another shell):
+//   python3 bench/standin_server.py --rtt-ms 20
+//   pio run -e bench && .pio/build/bench/program --images 32
+// Add --json for machine-readable output.
+
+#include "../src/http_pipeline.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+// ── Options ───────────────────────────────────────────────────────────
+
+struct Options {
+    const char* url      = "http://127.0.0.1:8099/api/photos/upload";
+    int         images   = 32;
+    size_t      size     = 40000;   // ~VGA JPEG at quality 12
+    int         depth    = 4;
+    double      radio_ma = 160.0;   // ESP32 modem active, mixed TX/RX
+    double      volts    = 3.3;
+    bool        json     = false;
+};
+
+struct Result {
+    const char* mode;
+    int    ok;
+    int    connections;
+    double seconds;
+};
+
+static double now_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ── Request building ──────────────────────────────────────────────────
+
+static const char* BOUNDARY = "----WaggleCamBoundary7d2a";
+
+static void append_field(std::string& out, const char* name, const std::string& value) {
+    out += std::string("--") + BOUNDARY + "\r\n";
+    out += std::string("Content-Disposition: form-data; name=\"") + name + "\"\r\n\r\n";
+    out += value + "\r\n";
+}
+
+// Full request (head + multipart body) for capture number `seq`.
+static std::string build_request(const char* host, uint16_t port, const char* path,
+                                 uint32_t seq, const std::string& jpeg) {
+    std::string body;
+    append_field(body, "hive_id", "1");
+    append_field(body, "boot_id", "3735928559");
+    append_field(body, "sequence", std::to_string(seq));
+    append_field(body, "captured_at", "2026-02-08T14:30:00.123Z");
+    append_field(body, "captured_at_source", "device_ntp");
+    append_field(body, "trigger_reason", "scheduled");
+    body += std::string("--") + BOUNDARY + "\r\n"
+            "Content-Disposition: form-data; name=\"photo\"; filename=\"capture.jpg\"\r\n"
+            "Content-Type: image/jpeg\r\n\r\n";
+    body += jpeg;
+    body += std::string("\r\n--") + BOUNDARY + "--\r\n";
+
+    std::string content_type = std::string("multipart/form-data; boundary=") + BOUNDARY;
+    char head[512];
+    size_t n = http_format_post_head(head, sizeof(head), host, port, path,
+                                     content_type.c_str(),
+                                     "X-API-Key: bench\r\nX-Device-Id: bench\r\n",
+                                     body.size());
+    return std::string(head, n) + body;
+}
+
+// ── Connection ────────────────────────────────────────────────────────
+
+struct Conn {
+    int     fd = -1;
+    uint8_t rx[256];
+    size_t  rx_len = 0;
+    size_t  rx_off = 0;
+};
+
+static bool conn_open(Conn& c, const char* host, uint16_t port) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* res = nullptr;
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%u", (unsigned)port);
+    if (getaddrinfo(host, port_str, &hints, &res) != 0) {
+        return false;
+    }
+    c.fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    bool ok = c.fd >= 0 && connect(c.fd, res->ai_addr, res->ai_addrlen) == 0;
+    freeaddrinfo(res);
+    if (!ok) {
+        return false;
+    }
+    int one = 1;
+    setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    c.rx_len = c.rx_off = 0;
+    return true;
+}
+
+static void conn_close(Conn& c) {
+    if (c.fd >= 0) {
+        close(c.fd);
+        c.fd = -1;
+    }
+}
+
+static bool conn_send(Conn& c, const std::string& data) {
+    size_t off = 0;
+    while (off < data.size()) {
+        ssize_t n = send(c.fd, data.data() + off, data.size() - off, 0);
+        if (n <= 0) {
+            return false;
+        }
+        off += (size_t)n;
+    }
+    return true;
+}
+
+// Read one response; returns its status, or -1 on a broken stream.
+// *close_after is set when the server will not answer further requests.
+static int conn_read_response(Conn& c, bool* close_after) {
+    HttpResponseParser p;
+    http_parser_reset(&p);
+    while (p.state != HTTP_DONE) {
+        if (c.rx_off == c.rx_len) {
+            ssize_t n = recv(c.fd, c.rx, sizeof(c.rx), 0);
+            if (n <= 0) {
+                return -1;
+            }
+            c.rx_len = (size_t)n;
+            c.rx_off = 0;
+        }
+        c.rx_off += http_parser_feed(&p, c.rx + c.rx_off, c.rx_len - c.rx_off);
+        if (p.state == HTTP_ERROR) {
+            return -1;
+        }
+    }
+    *close_after = p.conn_close;
+    return p.status;
+}
+
+// ── Modes ─────────────────────────────────────────────────────────────
+
+// depth == 0 means a fresh connection per image.
+static Result run_mode(const char* mode, const Options& opt, int depth,
+                       const char* host, uint16_t port, const char* path,
+                       const std::string& jpeg) {
+    Result r = {mode, 0, 0, 0.0};
+    std::vector<std::string> reqs;
+    for (int i = 0; i < opt.images; i++) {
+        reqs.push_back(build_request(host, port, path, (uint32_t)i, jpeg));
+    }
+
+    Conn c;
+    int sent = 0;
+    int acked = 0;
+    double t0 = now_s();
+
+    while (acked < opt.images) {
+        if (c.fd < 0) {
+            if (!conn_open(c, host, port)) {
+                fprintf(stderr, "%s: connect failed\n", mode);
+                break;
+            }
+            r.connections++;
+            sent = acked;   // Anything unanswered on the old connection is resent
+        }
+
+        int window = depth == 0 ? 1 : depth;
+        while (sent < opt.images && sent - acked < window) {
+            if (!conn_send(c, reqs[sent])) {
+                break;
+            }
+            sent++;
+        }
+
+        bool close_after = false;
+        int status = conn_read_response(c, &close_after);
+        if (status < 0) {
+            conn_close(c);
+            continue;
+        }
+        if (status >= 200 && status < 300) {
+            r.ok++;
+        }
+        acked++;
+        if (close_after || depth == 0) {
+            conn_close(c);
+        }
+    }
+
+    r.seconds = now_s() - t0;
+    conn_close(c);
+    return r;
+}
+
+// ── Main ──────────────────────────────────────────────────────────────
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--url URL] [--images N] [--size BYTES] [--depth N]\n"
+            "          [--radio-ma MA] [--volts V] [--json]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(a, "--json") == 0) {
+            opt.json = true;
+        } else if (v != nullptr && strcmp(a, "--url") == 0) {
+            opt.url = v; i++;
+        } else if (v != nullptr && strcmp(a, "--images") == 0) {
+            opt.images = atoi(v); i++;
+        } else if (v != nullptr && strcmp(a, "--size") == 0) {
+            opt.size = (size_t)atol(v); i++;
+        } else if (v != nullptr && strcmp(a, "--depth") == 0) {
+            opt.depth = atoi(v); i++;
+        } else if (v != nullptr && strcmp(a, "--radio-ma") == 0) {
+            opt.radio_ma = atof(v); i++;
+        } else if (v != nullptr && strcmp(a, "--volts") == 0) {
+            opt.volts = atof(v); i++;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opt.images < 1 || opt.depth < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    char host[64], path[128];
+    uint16_t port;
+    if (!http_parse_url(opt.url, host, sizeof(host), &port, path, sizeof(path))) {
+        fprintf(stderr, "unsupported URL: %s\n", opt.url);
+        return 2;
+    }
+
+    // Incompressible filler is enough — the hub only checks JPEG magic
+    std::string jpeg(opt.size, '\0');
+    uint32_t x = 0x9E3779B9u;
+    for (size_t i = 0; i < jpeg.size(); i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        jpeg[i] = (char)(x & 0xFF);
+    }
+    jpeg[0] = (char)0xFF; jpeg[1] = (char)0xD8; jpeg[2] = (char)0xFF;
+
+    Result results[3] = {
+        run_mode("fresh",     opt, 0,         host, port, path, jpeg),
+        run_mode("keepalive", opt, 1,         host, port, path, jpeg),
+        run_mode("pipelined", opt, opt.depth, host, port, path, jpeg),
+    };
+
+    if (opt.json) {
+        printf("{\"images\":%d,\"size\":%zu,\"depth\":%d,\"radio_ma\":%.1f,\"volts\":%.2f,\"modes\":[",
+               opt.images, opt.size, opt.depth, opt.radio_ma, opt.volts);
+    } else {
+        printf("%d images x %zu bytes, pipeline depth %d, radio model %.0f mA @ %.1f V\n\n",
+               opt.images, opt.size, opt.depth, opt.radio_ma, opt.volts);
+        printf("%-10s %5s %6s %10s %10s %12s\n",
+               "mode", "ok", "conns", "img/s", "ms/img", "mJ/img");
+    }
+    for (int i = 0; i < 3; i++) {
+        const Result& r = results[i];
+        double ips = r.seconds > 0 ? opt.images / r.seconds : 0.0;
+        double ms_per = r.seconds * 1000.0 / opt.images;
+        double mj_per = (r.seconds / opt.images) * (opt.radio_ma / 1000.0) * opt.volts * 1000.0;
+        if (opt.json) {
+            printf("%s{\"mode\":\"%s\",\"ok\":%d,\"connections\":%d,\"seconds\":%.4f,"
+                   "\"images_per_sec\":%.2f,\"ms_per_image\":%.2f,\"mj_per_image\":%.2f}",
+                   i ? "," : "", r.mode, r.ok, r.connections, r.seconds, ips, ms_per, mj_per);
+        } else {
+            printf("%-10s %5d %6d %10.2f %10.2f %12.2f\n",
+                   r.mode, r.ok, r.connections, ips, ms_per, mj_per);
+        }
+    }
+    if (opt.json) {
+        printf("]}\n");
+    }
+
+    for (int i = 0; i < 3; i++) {
+        if (results[i].ok != opt.images) {
+            return 1;
+        }
+    }
+    return 0;
+}
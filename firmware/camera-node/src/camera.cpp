@@ -6,6 +6,10 @@
 
 #include <Arduino.h>
 
+// Frame size / quality chosen at init, restored after a thumbnail grab
+static framesize_t s_full_size    = CAMERA_FRAMESIZE;
+static int         s_full_quality = CAMERA_QUALITY;
+
 // ── AI-Thinker ESP32-CAM pin configuration ──────────────────────────
 static camera_config_t make_camera_config() {
     camera_config_t config;
@@ -53,6 +57,9 @@ static camera_config_t make_camera_config() {
         log_w("No PSRAM — falling back to SVGA/quality 16");
     }
 
+    s_full_size    = config.frame_size;
+    s_full_quality = config.jpeg_quality;
+
     return config;
 }
 
@@ -96,13 +103,69 @@ bool camera_init() {
     return true;
 }
 
-camera_fb_t* camera_capture() {
+void camera_warmup() {
     // Discard first frame — auto-exposure often needs one frame to settle
     camera_fb_t* discard = esp_camera_fb_get();
     if (discard != nullptr) {
         esp_camera_fb_return(discard);
     }
+}
+
+// Switch the sensor frame size and drop frames until one arrives at the
+// new size (buffers queued before the switch keep the old size).
+static bool switch_framesize(framesize_t size, int quality, uint16_t width) {
+    sensor_t* s = esp_camera_sensor_get();
+    if (s == nullptr || s->set_framesize(s, size) != 0) {
+        log_e("Failed to set framesize %d", size);
+        return false;
+    }
+    s->set_quality(s, quality);
+
+    for (int i = 0; i < CAMERA_RESIZE_MAX_GRABS; i++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (fb == nullptr) {
+            continue;
+        }
+        bool ready = (fb->width == width);
+        esp_camera_fb_return(fb);
+        if (ready) {
+            return true;
+        }
+    }
+    log_w("Framesize %d not settled after %d grabs", size, CAMERA_RESIZE_MAX_GRABS);
+    return false;
+}
+
+uint8_t* camera_capture_thumbnail(size_t* out_len) {
+    *out_len = 0;
+    uint8_t* copy = nullptr;
+
+    if (switch_framesize(CAMERA_THUMB_FRAMESIZE, CAMERA_THUMB_QUALITY,
+                         resolution[CAMERA_THUMB_FRAMESIZE].width)) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (fb == nullptr) {
+            log_e("Thumbnail capture failed");
+        } else if (fb->len > CAMERA_THUMB_MAX_BYTES) {
+            log_w("Thumbnail too large (%u bytes) — dropped", fb->len);
+        } else {
+            copy = (uint8_t*)malloc(fb->len);
+            if (copy != nullptr) {
+                memcpy(copy, fb->buf, fb->len);
+                *out_len = fb->len;
+                log_i("Captured thumbnail: %u bytes, %ux%u", fb->len, fb->width, fb->height);
+            }
+        }
+        if (fb != nullptr) {
+            esp_camera_fb_return(fb);
+        }
+    }
+
+    // Restore full-size frames for camera_capture()
+    switch_framesize(s_full_size, s_full_quality, resolution[s_full_size].width);
+    return copy;
+}
 
+camera_fb_t* camera_capture() {
     camera_fb_t* fb = esp_camera_fb_get();
     if (fb == nullptr) {
         log_e("Camera capture failed");
@@ -11,6 +11,16 @@
 // Returns true on success, false if the camera driver fails to start.
 bool camera_init();
 
+// Grab and discard one frame so auto-exposure can settle.
+// Call once after camera_init(), before camera_capture().
+void camera_warmup();
+
+// Grab a thumbnail-size JPEG (CAMERA_THUMB_FRAMESIZE) and copy it into a
+// heap buffer owned by the caller (free with free()), then switch the
+// sensor back to the frame size chosen at init.  Returns nullptr on
+// failure; the full frame size is restored either way.
+uint8_t* camera_capture_thumbnail(size_t* out_len);
+
 // Capture a single JPEG frame.
 // Returns a pointer to the framebuffer (caller must release with camera_release),
 // or nullptr on failure.
@@ -5,14 +5,48 @@
 
 #define DEFAULT_SLEEP_SEC   900       // 15 minutes between captures
 #define WIFI_TIMEOUT_MS     15000     // 15 seconds to connect
+#define UPLOAD_TIMEOUT_MS   15000     // Server response timeout per upload
+#define UPLOAD_PIPELINE_DEPTH 4       // Session requests in flight (see wifi_upload.h)
+#define UPLOAD_CHUNK_RETRIES  3       // Failed chunks in a row before resuming next wake
 #define NTP_SERVER          "pool.ntp.org"
 #define NTP_SYNC_INTERVAL   86400     // Re-sync NTP every 24 hours
 #define CAMERA_QUALITY      12        // JPEG quality (0-63, lower = better)
 #define CAMERA_FRAMESIZE    FRAMESIZE_VGA
 
+// Thumbnail grabbed in the same wake as the full frame (NVS "thumb")
+#define CAMERA_THUMB_FRAMESIZE  FRAMESIZE_QQVGA   // 160x120
+#define CAMERA_THUMB_QUALITY    20
+#define CAMERA_THUMB_MAX_BYTES  16384             // Thumbnails larger than this are dropped
+#define CAMERA_RESIZE_MAX_GRABS 4                 // Frames discarded after a size switch
+
+// ── Wake stub schedule (wake_stub.h) ───────────────────────────────
+// Night window in local minutes of day (NVS night_start / night_end,
+// local = UTC + NVS utc_off minutes); equal start and end disable it.
+#define WAKE_NIGHT_START_MIN      0
+#define WAKE_NIGHT_END_MIN        0
+#define WAKE_UTC_OFFSET_MIN       0
+#define WAKE_BATTERY_FLOOR_MV     3300      // NVS bat_floor; 0 disables
+#define WAKE_BATTERY_RECHECK_SEC  21600     // Boot to re-measure a low battery every 6 h
+#define CAPTURE_PAUSE_MAX_SEC     604800    // Clamp for the hub's X-Capture-Pause
+
 // ── NVS namespace ───────────────────────────────────────────────────
 #define NVS_NAMESPACE       "waggle"
 
 // ── LED ─────────────────────────────────────────────────────────────
 // AI-Thinker ESP32-CAM has a white flash LED on GPIO4
 #define FLASH_LED_PIN       4
+
+// ── Activity wake line ──────────────────────────────────────────────
+// Driven HIGH by the sensor node (ACTIVITY_TRIGGER_PIN) when bee traffic
+// spikes.  GPIO13 is an RTC GPIO that the AI-Thinker camera bus leaves
+// free, so it can serve as the EXT0 deep-sleep wake source.  Wire it to
+// the sensor node's trigger output with a common ground.
+#define TRIGGER_WAKE_PIN    GPIO_NUM_13
+#define TRIGGER_WAKE_LEVEL  1         // Wake when the line goes HIGH
+
+// ── Battery monitoring ──────────────────────────────────────────────
+// Battery sensed through a resistor divider on an ADC2 pin, sampled
+// before WiFi starts.  Set BATTERY_ADC_PIN to -1 if no divider is fitted.
+#define BATTERY_ADC_PIN       14
+#define BATTERY_DIVIDER_RATIO 2       // 100k/100k divider
+#define BATTERY_ADC_SAMPLES   8
@@ -0,0 +1,247 @@
+// Waggle Camera Node — HTTP/1.1 framing implementation.
+
+#include "http_pipeline.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ── Helpers ───────────────────────────────────────────────────────────
+
+// Case-insensitive "starts with"; returns pointer past prefix or nullptr.
+static const char* match_prefix(const char* s, const char* prefix) {
+    while (*prefix) {
+        if (tolower((unsigned char)*s) != tolower((unsigned char)*prefix)) {
+            return nullptr;
+        }
+        s++;
+        prefix++;
+    }
+    return s;
+}
+
+static const char* skip_spaces(const char* s) {
+    while (*s == ' ' || *s == '\t') {
+        s++;
+    }
+    return s;
+}
+
+// Case-insensitive substring search (header values are short).
+static bool contains_token(const char* s, const char* token) {
+    size_t n = strlen(token);
+    size_t len = strlen(s);
+    for (size_t i = 0; i + n <= len; i++) {
+        if (match_prefix(s + i, token) != nullptr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ── URL parsing ───────────────────────────────────────────────────────
+
+bool http_parse_url(const char* url,
+                    char* host, size_t host_len,
+                    uint16_t* port,
+                    char* path, size_t path_len) {
+    const char* p = match_prefix(url, "http://");
+    if (p == nullptr) {
+        return false;
+    }
+
+    const char* host_end = p;
+    while (*host_end && *host_end != ':' && *host_end != '/') {
+        host_end++;
+    }
+    size_t n = (size_t)(host_end - p);
+    if (n == 0 || n >= host_len) {
+        return false;
+    }
+    memcpy(host, p, n);
+    host[n] = '\0';
+
+    *port = 80;
+    p = host_end;
+    if (*p == ':') {
+        char* end = nullptr;
+        long value = strtol(p + 1, &end, 10);
+        if (end == p + 1 || value <= 0 || value > 65535) {
+            return false;
+        }
+        *port = (uint16_t)value;
+        p = end;
+    }
+
+    if (*p == '\0') {
+        p = "/";
+    } else if (*p != '/') {
+        return false;
+    }
+    if (strlen(p) >= path_len) {
+        return false;
+    }
+    strcpy(path, p);
+    return true;
+}
+
+// ── Request framing ───────────────────────────────────────────────────
+
+size_t http_format_post_head(char* out, size_t cap,
+                             const char* host, uint16_t port, const char* path,
+                             const char* content_type,
+                             const char* extra_headers,
+                             size_t content_length) {
+    char host_field[80];
+    if (port == 80) {
+        snprintf(host_field, sizeof(host_field), "%s", host);
+    } else {
+        snprintf(host_field, sizeof(host_field), "%s:%u", host, (unsigned)port);
+    }
+
+    int n = snprintf(out, cap,
+                     "POST %s HTTP/1.1\r\n"
+                     "Host: %s\r\n"
+                     "Connection: keep-alive\r\n"
+                     "Content-Type: %s\r\n"
+                     "Content-Length: %lu\r\n"
+                     "%s"
+                     "\r\n",
+                     path, host_field, content_type,
+                     (unsigned long)content_length,
+                     extra_headers ? extra_headers : "");
+    if (n < 0 || (size_t)n >= cap) {
+        return 0;
+    }
+    return (size_t)n;
+}
+
+// ── Response parsing ──────────────────────────────────────────────────
+
+void http_parser_reset(HttpResponseParser* p) {
+    memset(p, 0, sizeof(HttpResponseParser));
+    p->state = HTTP_STATUS_LINE;
+}
+
+// Handle one complete line (CR/LF stripped) for the line-based states.
+static void handle_line(HttpResponseParser* p) {
+    const char* line = p->line;
+
+    switch (p->state) {
+        case HTTP_STATUS_LINE: {
+            const char* rest = match_prefix(line, "HTTP/1.");
+            if (rest == nullptr || rest[0] == '\0' || rest[1] != ' ') {
+                p->state = HTTP_ERROR;
+                return;
+            }
+            p->status = atoi(rest + 2);
+            if (p->status < 100 || p->status > 599) {
+                p->state = HTTP_ERROR;
+                return;
+            }
+            p->state = HTTP_HEADERS;
+            return;
+        }
+
+        case HTTP_HEADERS: {
+            if (p->line_len == 0) {
+                // End of headers — decide how the body is delimited
+                bool no_body = (p->status < 200 || p->status == 204 || p->status == 304);
+                if (p->status < 200) {
+                    // Interim response (e.g. 100 Continue): a final one follows
+                    bool close = p->conn_close;
+                    http_parser_reset(p);
+                    p->conn_close = close;
+                } else if (no_body) {
+                    p->state = HTTP_DONE;
+                } else if (p->chunked) {
+                    p->state = HTTP_CHUNK_SIZE;
+                } else if (p->has_length) {
+                    p->state = (p->remaining > 0) ? HTTP_BODY : HTTP_DONE;
+                } else {
+                    // Body delimited by close — unusable for pipelining
+                    p->conn_close = true;
+                    p->state = HTTP_DONE;
+                }
+                return;
+            }
+            const char* v;
+            if ((v = match_prefix(line, "Content-Length:")) != nullptr) {
+                p->has_length = true;
+                p->remaining = (uint32_t)strtoul(skip_spaces(v), nullptr, 10);
+            } else if ((v = match_prefix(line, "Transfer-Encoding:")) != nullptr) {
+                p->chunked = contains_token(v, "chunked");
+            } else if ((v = match_prefix(line, "Connection:")) != nullptr) {
+                p->conn_close = contains_token(v, "close");
+            } else if ((v = match_prefix(line, "X-Capture-Pause:")) != nullptr) {
+                long pause = strtol(skip_spaces(v), nullptr, 10);
+                p->capture_pause_s = pause > 0 ? (uint32_t)pause : 0;
+            }
+            return;
+        }
+
+        case HTTP_CHUNK_SIZE: {
+            char* end = nullptr;
+            unsigned long size = strtoul(line, &end, 16);
+            if (end == line) {
+                p->state = HTTP_ERROR;
+                return;
+            }
+            p->remaining = (uint32_t)size;
+            p->state = (size == 0) ? HTTP_TRAILERS : HTTP_CHUNK_DATA;
+            return;
+        }
+
+        case HTTP_CHUNK_END:
+            p->state = (p->line_len == 0) ? HTTP_CHUNK_SIZE : HTTP_ERROR;
+            return;
+
+        case HTTP_TRAILERS:
+            if (p->line_len == 0) {
+                p->state = HTTP_DONE;
+            }
+            return;
+
+        default:
+            return;
+    }
+}
+
+size_t http_parser_feed(HttpResponseParser* p, const uint8_t* data, size_t len) {
+    size_t i = 0;
+
+    while (i < len && p->state != HTTP_DONE && p->state != HTTP_ERROR) {
+        if (p->state == HTTP_BODY || p->state == HTTP_CHUNK_DATA) {
+            size_t take = len - i;
+            if (take > p->remaining) {
+                take = p->remaining;
+            }
+            p->remaining -= (uint32_t)take;
+            i += take;
+            if (p->remaining == 0) {
+                p->state = (p->state == HTTP_BODY) ? HTTP_DONE : HTTP_CHUNK_END;
+            }
+            continue;
+        }
+
+        // Line-based states
+        char c = (char)data[i++];
+        if (c == '\r') {
+            continue;
+        }
+        if (c == '\n') {
+            p->line[p->line_len] = '\0';
+            handle_line(p);
+            p->line_len = 0;
+            continue;
+        }
+        if (p->line_len + 1 >= HTTP_MAX_LINE) {
+            p->state = HTTP_ERROR;
+            break;
+        }
+        p->line[p->line_len++] = c;
+    }
+
+    return i;
+}
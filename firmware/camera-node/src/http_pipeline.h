@@ -0,0 +1,79 @@
+// Waggle Camera Node — Minimal HTTP/1.1 framing for keep-alive uploads.
+//
+// Pure helpers (no Arduino, no sockets) shared by the upload session in
+// wifi_upload.cpp and the host-side upload benchmark:
+//   - split an http:// URL into host, port and path
+//   - format a POST request head
+//   - incrementally parse responses arriving back-to-back on one
+//     connection, so pipelined requests can be matched to their
+//     responses in order
+//
+// Only what the hub returns is supported: Content-Length or chunked
+// bodies, which are skipped (uploads only need the status code and the
+// hub's X-Capture-Pause header).
+
+#ifndef HTTP_PIPELINE_H
+#define HTTP_PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HTTP_MAX_LINE 256
+
+// ── URL parsing ───────────────────────────────────────────────────────
+
+// Parse "http://host[:port][/path]".  Returns false for other schemes
+// (https is left to HTTPClient) or if a field does not fit its buffer.
+bool http_parse_url(const char* url,
+                    char* host, size_t host_len,
+                    uint16_t* port,
+                    char* path, size_t path_len);
+
+// ── Request framing ───────────────────────────────────────────────────
+
+// Format a keep-alive POST request head, ending with the blank line.
+// extra_headers is inserted verbatim (each line CRLF-terminated) and may
+// be nullptr.  Returns the head length, or 0 if it does not fit in cap.
+size_t http_format_post_head(char* out, size_t cap,
+                             const char* host, uint16_t port, const char* path,
+                             const char* content_type,
+                             const char* extra_headers,
+                             size_t content_length);
+
+// ── Response parsing ──────────────────────────────────────────────────
+
+enum HttpParseState {
+    HTTP_STATUS_LINE = 0,
+    HTTP_HEADERS,
+    HTTP_BODY,
+    HTTP_CHUNK_SIZE,
+    HTTP_CHUNK_DATA,
+    HTTP_CHUNK_END,      // CRLF after chunk data
+    HTTP_TRAILERS,
+    HTTP_DONE,
+    HTTP_ERROR
+};
+
+struct HttpResponseParser {
+    HttpParseState state;
+    char     line[HTTP_MAX_LINE];
+    size_t   line_len;
+    int      status;          // Status code of the current response
+    bool     chunked;
+    bool     conn_close;      // Server sent "Connection: close"
+    uint32_t capture_pause_s; // X-Capture-Pause seconds (0 = none)
+    bool     has_length;
+    uint32_t remaining;       // Body or chunk bytes still to skip
+};
+
+// Reset for the next response on the connection.
+void http_parser_reset(HttpResponseParser* p);
+
+// Consume bytes from a response stream.  Stops right after a complete
+// response (state == HTTP_DONE) so the caller can record it, reset, and
+// feed the rest of the buffer into the next response.  Returns the
+// number of bytes consumed; state HTTP_ERROR means the stream is
+// unusable and the connection must be dropped.
+size_t http_parser_feed(HttpResponseParser* p, const uint8_t* data, size_t len);
+
+#endif // HTTP_PIPELINE_H
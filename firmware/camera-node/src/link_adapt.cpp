@@ -0,0 +1,146 @@
+// Waggle Camera Node — WiFi link adaptation implementation.
+
+#include "link_adapt.h"
+#include "upload_resume.h"
+
+#include <string.h>
+
+// ── History ───────────────────────────────────────────────────────────
+
+void link_history_init(LinkHistory* h) {
+    memset(h, 0, sizeof(*h));
+    h->magic = LINK_HISTORY_MAGIC;
+}
+
+void link_history_record(LinkHistory* h, const LinkSample* s) {
+    if (h->magic != LINK_HISTORY_MAGIC || h->next >= LINK_HISTORY_LEN) {
+        link_history_init(h);
+    }
+    h->samples[h->next] = *s;
+    h->next = (uint8_t)((h->next + 1) % LINK_HISTORY_LEN);
+    if (h->count < LINK_HISTORY_LEN) {
+        h->count++;
+    }
+}
+
+const LinkSample* link_history_recent(const LinkHistory* h, uint8_t age) {
+    if (h->magic != LINK_HISTORY_MAGIC || age >= h->count || h->count > LINK_HISTORY_LEN) {
+        return nullptr;
+    }
+    uint8_t slot = (uint8_t)((h->next + LINK_HISTORY_LEN - 1 - age) % LINK_HISTORY_LEN);
+    return &h->samples[slot];
+}
+
+uint32_t link_sample_rate_bps(const LinkSample* s) {
+    if (s->bytes == 0) {
+        return 0;
+    }
+    uint32_t ms = s->busy_ms ? s->busy_ms : 1;
+    return (uint32_t)((uint64_t)s->bytes * 1000 / ms);
+}
+
+// ── Plan ──────────────────────────────────────────────────────────────
+
+// Median of n values (mean of the middle two for even n); sorts v.
+static int32_t median(int32_t* v, int n) {
+    for (int i = 1; i < n; i++) {
+        int32_t x = v[i];
+        int j = i - 1;
+        while (j >= 0 && v[j] > x) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = x;
+    }
+    return (n % 2) ? v[n / 2] : (int32_t)(((int64_t)v[n / 2 - 1] + v[n / 2]) / 2);
+}
+
+static uint8_t tier_for_rssi(int32_t rssi) {
+    if (rssi >= LINK_RSSI_GOOD_DBM) return LINK_GOOD;
+    if (rssi >= LINK_RSSI_POOR_DBM) return LINK_FAIR;
+    if (rssi >= LINK_RSSI_BAD_DBM)  return LINK_POOR;
+    return LINK_BAD;
+}
+
+LinkPlan link_plan_choose(const LinkHistory* h) {
+    LinkPlan plan;
+    plan.tier = LINK_UNKNOWN;
+    plan.tx_power_qdbm = LINK_TX_POWER_MAX_QDBM;
+    plan.protocols = LINK_PROTO_BGN;
+    plan.ht40 = false;
+    plan.chunk_bytes = UPLOAD_CHUNK_INITIAL;
+    plan.chunk_retries = LINK_RETRIES_FAIR;
+
+    const LinkSample* latest = link_history_recent(h, 0);
+    if (latest == nullptr) {
+        return plan;
+    }
+
+    int32_t rssi[LINK_WINDOW];
+    int32_t rate[LINK_WINDOW];
+    int n_rssi = 0, n_rate = 0;
+    for (uint8_t age = 0; age < LINK_WINDOW; age++) {
+        const LinkSample* s = link_history_recent(h, age);
+        if (s == nullptr) {
+            break;
+        }
+        if (s->rssi_dbm != LINK_RSSI_NONE) {
+            rssi[n_rssi++] = s->rssi_dbm;
+        }
+        uint32_t bps = link_sample_rate_bps(s);
+        if (bps != 0) {
+            rate[n_rate++] = (int32_t)(bps > 0x7FFFFFFFu ? 0x7FFFFFFFu : bps);
+        }
+    }
+
+    // Tier: median RSSI, one worse after a troubled wake, POOR at best
+    // after a failed connect
+    int32_t rssi_med = n_rssi ? median(rssi, n_rssi) : LINK_RSSI_BAD_DBM;
+    uint8_t tier = n_rssi ? tier_for_rssi(rssi_med) : (uint8_t)LINK_POOR;
+    bool connected = (latest->rssi_dbm != LINK_RSSI_NONE);
+    if (!connected) {
+        if (tier < LINK_POOR) tier = LINK_POOR;
+    } else if ((latest->retries != 0 || !latest->completed) && tier < LINK_BAD) {
+        tier++;
+    }
+    plan.tier = tier;
+
+    if (tier == LINK_GOOD) {
+        int32_t headroom_db = rssi_med - LINK_RSSI_TARGET_DBM;
+        int32_t power = LINK_TX_POWER_MAX_QDBM - 4 * headroom_db;
+        if (power < LINK_TX_POWER_MIN_QDBM) power = LINK_TX_POWER_MIN_QDBM;
+        if (power > LINK_TX_POWER_MAX_QDBM) power = LINK_TX_POWER_MAX_QDBM;
+        plan.tx_power_qdbm = (uint8_t)power;
+        plan.ht40 = (rssi_med >= LINK_RSSI_HT40_DBM);
+        plan.chunk_retries = LINK_RETRIES_GOOD;
+    } else if (tier == LINK_POOR || tier == LINK_BAD) {
+        plan.chunk_retries = LINK_RETRIES_POOR;
+        if (tier == LINK_BAD) {
+            plan.protocols = LINK_PROTO_11B;
+        }
+    }
+
+    // First chunk: UPLOAD_CHUNK_TARGET_MS at the median recent throughput
+    uint32_t chunk = UPLOAD_CHUNK_INITIAL;
+    if (n_rate != 0) {
+        uint64_t ideal = (uint64_t)median(rate, n_rate) * UPLOAD_CHUNK_TARGET_MS / 1000;
+        chunk = (uint32_t)(ideal > UPLOAD_CHUNK_MAX ? UPLOAD_CHUNK_MAX : ideal);
+    }
+    if (tier == LINK_POOR && chunk > UPLOAD_CHUNK_INITIAL / 2) {
+        chunk = UPLOAD_CHUNK_INITIAL / 2;
+    } else if (tier == LINK_BAD) {
+        chunk = UPLOAD_CHUNK_MIN;
+    }
+    plan.chunk_bytes = chunk_size_clamp(chunk);
+    return plan;
+}
+
+const char* link_tier_name(uint8_t tier) {
+    switch (tier) {
+        case LINK_GOOD: return "good";
+        case LINK_FAIR: return "fair";
+        case LINK_POOR: return "poor";
+        case LINK_BAD:  return "bad";
+        default:        return "unknown";
+    }
+}
@@ -0,0 +1,115 @@
+// Waggle Camera Node — WiFi link adaptation.
+//
+// Pure logic (no Arduino, no driver calls) behind the radio settings of
+// each wake.  After every wake the firmware records what the link did —
+// RSSI after association, failed upload requests, bytes the hub
+// acknowledged and the time spent sending them — in a short history kept
+// in RTC memory.  Before the next connect, link_plan_choose() turns the
+// recent history into a LinkPlan:
+//
+//   tier      GOOD / FAIR / POOR / BAD from the median RSSI of the last
+//             LINK_WINDOW wakes, one tier worse if the latest wake needed
+//             retries or did not finish; POOR at best after a failed
+//             connect
+//   TX power  lowered on a GOOD link by the RSSI headroom over
+//             LINK_RSSI_TARGET_DBM (less PA current for the same
+//             delivery); full power on every other tier
+//   protocol  802.11b/g/n; 802.11b only on a BAD link, where the DSSS
+//             rates hold on a few dB longer than OFDM.  HT40 on a strong
+//             GOOD link
+//   chunking  first chunk sized from the median throughput of recent
+//             wakes (UPLOAD_CHUNK_TARGET_MS worth, see upload_resume.h);
+//             smaller chunks and more retries per wake on POOR / BAD
+//
+// The RSSI is what the camera receives from the access point, so it does
+// not depend on the TX power the camera used; the plan has no feedback
+// loop through its own power setting.
+//
+// TX power is in the driver's units of 0.25 dBm; protocol bits match
+// WIFI_PROTOCOL_11B / 11G / 11N.
+
+#ifndef LINK_ADAPT_H
+#define LINK_ADAPT_H
+
+#include <stdint.h>
+
+#define LINK_HISTORY_MAGIC      0x4C4E4B31u  // "LNK1"
+#define LINK_HISTORY_LEN        8
+#define LINK_WINDOW             4            // Recent wakes a plan looks at
+
+#define LINK_RSSI_NONE          0            // Connect failed: no RSSI
+
+// Tier thresholds on the median RSSI (dBm)
+#define LINK_RSSI_GOOD_DBM      -60
+#define LINK_RSSI_POOR_DBM      -75
+#define LINK_RSSI_BAD_DBM       -83
+#define LINK_RSSI_HT40_DBM      -55
+// A lowered TX power aims to leave the link this strong
+#define LINK_RSSI_TARGET_DBM    -67
+
+#define LINK_TX_POWER_MAX_QDBM  78           // 19.5 dBm, the driver default
+#define LINK_TX_POWER_MIN_QDBM  34           // 8.5 dBm
+
+#define LINK_PROTO_11B          0x01
+#define LINK_PROTO_11G          0x02
+#define LINK_PROTO_11N          0x04
+#define LINK_PROTO_BGN          (LINK_PROTO_11B | LINK_PROTO_11G | LINK_PROTO_11N)
+
+// Failed chunk requests allowed per wake before the photo waits for the
+// next one (UPLOAD_CHUNK_RETRIES before link adaptation)
+#define LINK_RETRIES_GOOD       2
+#define LINK_RETRIES_FAIR       3
+#define LINK_RETRIES_POOR       5
+
+enum LinkTier : uint8_t {
+    LINK_UNKNOWN = 0,            // No history (power-on)
+    LINK_GOOD    = 1,
+    LINK_FAIR    = 2,
+    LINK_POOR    = 3,
+    LINK_BAD     = 4,
+};
+
+// One wake's link, recorded at the end of the wake
+struct LinkSample {
+    int8_t   rssi_dbm;           // After association; LINK_RSSI_NONE = no connect
+    uint8_t  tx_power_qdbm;      // Plan in force this wake
+    uint8_t  retries;            // Failed upload requests
+    bool     completed;          // Hub stored the photo
+    uint32_t bytes;              // Bytes the hub acknowledged
+    uint32_t busy_ms;            // Time spent in those upload requests
+};
+
+struct LinkHistory {
+    uint32_t   magic;            // LINK_HISTORY_MAGIC once written
+    uint8_t    count;            // Samples held (<= LINK_HISTORY_LEN)
+    uint8_t    next;             // Slot the next sample goes to
+    LinkSample samples[LINK_HISTORY_LEN];
+};
+
+struct LinkPlan {
+    uint8_t  tier;               // LinkTier
+    uint8_t  tx_power_qdbm;      // Max TX power, 0.25 dBm units
+    uint8_t  protocols;          // LINK_PROTO_* bits
+    bool     ht40;               // 40 MHz channel (else 20 MHz)
+    uint32_t chunk_bytes;        // First upload chunk this wake
+    uint8_t  chunk_retries;      // Failed chunks before giving up this wake
+};
+
+void link_history_init(LinkHistory* h);
+
+// Append one wake; a history that was never written is initialised
+// first.  The oldest sample is dropped once LINK_HISTORY_LEN are held.
+void link_history_record(LinkHistory* h, const LinkSample* s);
+
+// Most recent sample (0 = newest), or nullptr if there are not that many.
+const LinkSample* link_history_recent(const LinkHistory* h, uint8_t age);
+
+// Achieved upload throughput in bytes/s, 0 if nothing was sent.
+uint32_t link_sample_rate_bps(const LinkSample* s);
+
+// Radio settings for the next wake (see the top of this file).
+LinkPlan link_plan_choose(const LinkHistory* h);
+
+const char* link_tier_name(uint8_t tier);
+
+#endif // LINK_ADAPT_H
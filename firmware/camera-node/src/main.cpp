@@ -3,29 +3,63 @@
 // Lifecycle on each wake from deep sleep:
 //   1. Read NVS config (device_id, api_key, hive_id, wifi_ssid, wifi_pass, hub_url)
 //   2. Init camera (FRAMESIZE_VGA, JPEG quality 12)
-//   3. Capture JPEG frame
+//   3. Capture JPEG frame (plus a QQVGA thumbnail unless NVS "thumb" is off)
 //   4. Connect to WiFi (timeout 15 s)
 //   5. NTP sync (if first boot or >24 h since last sync)
-//   6. HTTP POST multipart to {hub_url}/api/hives/{hive_id}/photos
+//   6. Upload in resumable chunks to {hub_url}/api/photos/uploads,
+//      after finishing any upload a previous wake left pending (on a
+//      good link, both go back-to-back over one keep-alive session)
 //   7. Disconnect WiFi
 //   8. Deinit camera
-//   9. Deep sleep for configured interval (default 15 minutes)
+//   9. Deep sleep until the next scheduled capture (default 15 minutes)
+//
+// A photo whose upload breaks part-way is kept in LittleFS
+// (pending_upload.h); the hub remembers the acknowledged offset, so the
+// next wake sends only the rest.  Hubs without the resumable endpoint
+// get the single multipart POST to /api/photos/upload.
+//
+// Every phase is timed by telemetry.h and reported to the hub with the
+// next upload in the X-Wake-Telemetry header.
+//
+// Each wake's RSSI, failed upload requests and achieved throughput are
+// kept in RTC memory; link_adapt.h picks the next wake's TX power,
+// 802.11 protocol set, bandwidth and upload chunking from them.
+//
+// Besides the timer, the camera also wakes on EXT0 when the sensor node
+// raises its activity line (TRIGGER_WAKE_PIN) during a traffic spike.
+// An activity wake captures immediately but does not reset the schedule:
+// the following sleep only covers the time left until the scheduled
+// capture.  Each upload carries the wake reason as trigger_reason.
 //
 // Unlike the sensor node (which uses light sleep to keep ISRs running),
 // the camera node uses deep sleep since there are no background tasks
 // between captures.  This saves significant power.
+//
+// Timer wakes that would not capture — night, battery below the floor,
+// a pause requested by the hub, or a wake that came early — never reach
+// setup(): the deep-sleep wake stub (wake_stub.h) checks the schedule
+// left in RTC memory and goes back to sleep before the bootloader runs.
 
 #include <Arduino.h>
 #include <esp_sleep.h>
+#include <esp_system.h>
+#include <driver/rtc_io.h>
+#include <time.h>
 
 #include "config.h"
 #include "nvs_config.h"
 #include "camera.h"
 #include "wifi_upload.h"
+#include "pending_upload.h"
 #include "ntp_sync.h"
+#include "telemetry.h"
+#include "wake_stub.h"
+#include "link_adapt.h"
 
 // ── RTC data — survives deep sleep ──────────────────────────────────
 RTC_DATA_ATTR static uint32_t s_boot_count = 0;
+RTC_DATA_ATTR static uint32_t s_boot_id = 0;          // Random per power-on
+RTC_DATA_ATTR static LinkHistory s_link_history;      // Zeroed on power-on
 
 // ── First-boot detection ────────────────────────────────────────────
 static bool is_first_boot() {
@@ -33,22 +67,156 @@ static bool is_first_boot() {
     return (reason == ESP_RST_POWERON || reason == ESP_RST_UNKNOWN);
 }
 
-// ── Build the upload URL from hub_url and hive_id ───────────────────
-static String build_upload_url(const char* hub_url, const char* hive_id) {
+// ── Wake reason → trigger_reason sent with the upload ──────────────
+static const char* wake_trigger_reason() {
+    switch (esp_sleep_get_wakeup_cause()) {
+        case ESP_SLEEP_WAKEUP_EXT0:  return "activity";
+        case ESP_SLEEP_WAKEUP_TIMER: return "scheduled";
+        default:                     return "boot";
+    }
+}
+
+// ── Build an API URL from hub_url ───────────────────────────────────
+static String build_api_url(const char* hub_url, const char* path) {
     String url = String(hub_url);
     // Strip trailing slash if present
     if (url.endsWith("/")) {
         url.remove(url.length() - 1);
     }
-    url += "/api/hives/";
-    url += hive_id;
-    url += "/photos";
+    url += path;
     return url;
 }
 
+// Worth keeping the photo for another attempt (vs. done or rejected)
+static bool upload_retryable(int http_code) {
+    return http_code < 0 || http_code >= 500 || http_code == 408
+        || http_code == 422 || http_code == 429;
+}
+
+// 404/405 from /api/photos/uploads: hub without resumable uploads
+static bool resumable_unsupported(int http_code) {
+    return http_code == 404 || http_code == 405;
+}
+
+// ── Backlog over one connection ─────────────────────────────────────
+// On a good link the pending photo and this wake's capture are sent as
+// two pipelined POSTs on one keep-alive connection instead of paying
+// connection setup for each.  Sets each photo's HTTP status, -1 if it
+// was not answered (send it again through the per-photo path).  Returns
+// false if no session could be opened (e.g. an https hub URL).
+static bool upload_backlog(const DeviceConfig& cfg, const PendingUpload& pending,
+                           const PhotoUploadMeta& meta, const camera_fb_t* fb,
+                           int* pending_code, int* http_code) {
+    static UploadSession session;  // WiFiClient plus receive buffer: off the task stack
+    String url = build_api_url(cfg.hub_url, "/api/photos/upload");
+    if (!upload_session_begin(session, url.c_str(), cfg.api_key, cfg.device_id,
+                              UPLOAD_PIPELINE_DEPTH)) {
+        return false;
+    }
+    int p = upload_session_send(session, pending_meta(pending), pending.jpeg, pending.jpeg_len);
+    int c = upload_session_send(session, meta, fb->buf, fb->len);
+    upload_session_end(session);
+    *pending_code = (p < 0) ? -1 : session.results[p];
+    *http_code = (c < 0) ? -1 : session.results[c];
+    return true;
+}
+
+// ── Link history ────────────────────────────────────────────────────
+// One sample per wake that tried to connect (rssi LINK_RSSI_NONE if the
+// connect failed).
+static void record_link(const LinkPlan& plan, int8_t rssi, bool completed) {
+    UploadLinkStats stats = upload_link_stats();
+    LinkSample sample;
+    sample.rssi_dbm = rssi;
+    sample.tx_power_qdbm = plan.tx_power_qdbm;
+    sample.retries = stats.retries > 255 ? 255 : (uint8_t)stats.retries;
+    sample.completed = completed;
+    sample.bytes = stats.bytes;
+    sample.busy_ms = stats.busy_ms;
+    link_history_record(&s_link_history, &sample);
+    log_i("Link: rssi %d dBm, %u retries, %u B in %u ms (%u B/s)", rssi, sample.retries,
+          sample.bytes, sample.busy_ms, link_sample_rate_bps(&sample));
+}
+
+// ── Arm the activity wake line ──────────────────────────────────────
+// Skipped while the line is still HIGH from the trigger that woke us,
+// otherwise EXT0 would wake the camera again immediately.  Returns
+// whether EXT0 was armed.
+static bool arm_trigger_wake() {
+    rtc_gpio_init(TRIGGER_WAKE_PIN);
+    rtc_gpio_set_direction(TRIGGER_WAKE_PIN, RTC_GPIO_MODE_INPUT_ONLY);
+    rtc_gpio_pullup_dis(TRIGGER_WAKE_PIN);
+    rtc_gpio_pulldown_en(TRIGGER_WAKE_PIN);  // Idle LOW if the sensor is unplugged
+
+    if (rtc_gpio_get_level(TRIGGER_WAKE_PIN) == TRIGGER_WAKE_LEVEL) {
+        log_w("Activity line still asserted — timer wake only this cycle");
+        return false;
+    }
+    esp_sleep_enable_ext0_wakeup(TRIGGER_WAKE_PIN, TRIGGER_WAKE_LEVEL);
+    return true;
+}
+
+// ── Wake stub schedule ──────────────────────────────────────────────
+// What the stub checks on the following wakes.  next_capture_s is set
+// by enter_deep_sleep().
+static void update_wake_schedule(const DeviceConfig& cfg, int interval_sec) {
+    WakeSchedule* sched = wake_stub_schedule();
+    uint32_t now = (uint32_t)time(nullptr);
+    sched->interval_s = (uint32_t)interval_sec;
+    sched->time_valid = ntp_synced();
+    sched->utc_offset_min = (int16_t)cfg.utc_offset_min;
+    sched->night_start_min = (uint16_t)(cfg.night_start_min % WAKE_MINUTES_PER_DAY);
+    sched->night_end_min = (uint16_t)(cfg.night_end_min % WAKE_MINUTES_PER_DAY);
+    sched->battery_floor_mv = (uint16_t)cfg.battery_floor_mv;
+    sched->battery_recheck_s = WAKE_BATTERY_RECHECK_SEC;
+    if (telemetry_battery_mv() != 0) {
+        sched->battery_mv = telemetry_battery_mv();
+        sched->battery_checked_s = now;
+    }
+    if (upload_capture_pause_s() != 0) {
+        sched->skip_until_s = now + upload_capture_pause_s();
+    }
+}
+
 // ── Enter deep sleep ────────────────────────────────────────────────
-static void enter_deep_sleep(int sleep_sec) {
-    int duration = (sleep_sec > 0) ? sleep_sec : DEFAULT_SLEEP_SEC;
+// Timer and boot wakes start a new interval; activity wakes sleep only
+// for what remains of the current one so scheduled captures keep their
+// cadence.  With a configuration (cfg != nullptr) the wake stub checks
+// the following wakes; without one every wake boots.
+static void enter_deep_sleep(const DeviceConfig* cfg, bool activity_wake) {
+    int sleep_sec = (cfg != nullptr) ? cfg->sleep_sec : 0;
+    int interval = (sleep_sec > 0) ? sleep_sec : DEFAULT_SLEEP_SEC;
+    int duration = interval;
+    uint32_t now = (uint32_t)time(nullptr);
+    WakeSchedule* sched = wake_stub_schedule();
+
+    if (activity_wake) {
+        int64_t remaining = (int64_t)sched->next_capture_s - now;
+        // Clock stepped (NTP) or schedule already due — start a new interval
+        if (remaining <= 0 || remaining > duration) {
+            sched->next_capture_s = now + duration;
+        } else {
+            duration = (int)remaining;
+        }
+    } else {
+        sched->next_capture_s = now + duration;
+    }
+
+    bool ext0_armed = false;
+    if (cfg != nullptr && cfg->trigger_wake) {
+        ext0_armed = arm_trigger_wake();
+    }
+    if (cfg != nullptr) {
+        update_wake_schedule(*cfg, interval);
+        wake_stub_arm(ext0_armed);
+    } else {
+        wake_stub_disarm();
+    }
+
+    // Whatever ran since the last phase mark is teardown
+    telemetry_mark(TEL_TEARDOWN);
+    telemetry_finish();
+
     log_i("Entering deep sleep for %d s (boot #%u)", duration, s_boot_count);
     esp_sleep_enable_timer_wakeup((uint64_t)duration * 1000000ULL);
     esp_deep_sleep_start();
@@ -57,44 +225,83 @@ static void enter_deep_sleep(int sleep_sec) {
 
 // ── Arduino setup (runs on every wake from deep sleep) ──────────────
 void setup() {
+    telemetry_begin();
     Serial.begin(115200);
     delay(10);
 
+    // RTC memory is cleared on power-on, so a fresh boot_id is drawn
+    // whenever the (boot_id, sequence) pair would otherwise repeat.
+    if (s_boot_id == 0) {
+        s_boot_id = (esp_random() & 0x7FFFFFFF) | 1;
+    }
     s_boot_count++;
-    log_i("Waggle camera boot #%u — rst_reason=%d", s_boot_count, esp_reset_reason());
+
+    const char* trigger_reason = wake_trigger_reason();
+    bool activity_wake = (strcmp(trigger_reason, "activity") == 0);
+    uint32_t stub_skips = wake_stub_take_skipped();
+    telemetry_note_stub_skips(stub_skips);
+    log_i("Waggle camera boot #%u — rst_reason=%d trigger=%s (stub skipped %u wakes)",
+          s_boot_count, esp_reset_reason(), trigger_reason, stub_skips);
 
     // ── 1. Load NVS configuration ───────────────────────────────────
     DeviceConfig cfg;
     if (!nvs_load_config(cfg)) {
         log_e("Configuration incomplete — cannot operate. Sleeping.");
-        enter_deep_sleep(DEFAULT_SLEEP_SEC);
+        enter_deep_sleep(nullptr, activity_wake);
         return;
     }
 
+    // Battery must be read before WiFi claims ADC2
+    telemetry_sample_battery();
+    telemetry_mark(TEL_NVS);
+
     // ── 2. Init camera ──────────────────────────────────────────────
     if (!camera_init()) {
         log_e("Camera init failed — sleeping");
-        enter_deep_sleep(cfg.sleep_sec);
+        enter_deep_sleep(&cfg, activity_wake);
         return;
     }
 
+    telemetry_mark(TEL_CAMERA_INIT);
+
     // ── 3. Capture JPEG frame ───────────────────────────────────────
+    camera_warmup();
+    telemetry_mark(TEL_WARMUP);
+
+    // Thumbnail first, while the sensor is settled; its cost (two frame
+    // size switches plus one small grab) is reported as the thumb phase.
+    uint8_t* thumb = nullptr;
+    size_t thumb_len = 0;
+    if (cfg.thumbnail) {
+        thumb = camera_capture_thumbnail(&thumb_len);
+    }
+    telemetry_mark(TEL_THUMBNAIL);
+
     camera_fb_t* fb = camera_capture();
+    telemetry_mark(TEL_CAPTURE);
     if (fb == nullptr) {
         log_e("Capture failed — deinit and sleep");
+        free(thumb);
         camera_deinit();
-        enter_deep_sleep(cfg.sleep_sec);
+        enter_deep_sleep(&cfg, activity_wake);
         return;
     }
 
     log_i("Photo captured: %u bytes", fb->len);
 
     // ── 4. Connect to WiFi ──────────────────────────────────────────
-    if (!wifi_connect(cfg.wifi_ssid, cfg.wifi_pass, WIFI_TIMEOUT_MS)) {
+    LinkPlan link_plan = link_plan_choose(&s_link_history);
+    upload_set_link_plan(link_plan);
+    bool wifi_ok = wifi_connect(cfg.wifi_ssid, cfg.wifi_pass, WIFI_TIMEOUT_MS, &link_plan);
+    telemetry_mark(TEL_WIFI);
+    telemetry_note_wifi(wifi_ok);
+    if (!wifi_ok) {
         log_e("WiFi failed — releasing frame and sleeping");
+        record_link(link_plan, LINK_RSSI_NONE, false);
+        free(thumb);
         camera_release(fb);
         camera_deinit();
-        enter_deep_sleep(cfg.sleep_sec);
+        enter_deep_sleep(&cfg, activity_wake);
         return;
     }
 
@@ -106,19 +313,81 @@ void setup() {
         }
     }
 
+    telemetry_mark(TEL_TIME_SYNC);
+
     String timestamp = get_timestamp_iso8601();
     log_i("Timestamp: %s", timestamp.c_str());
+    int8_t rssi = wifi_rssi();
+    const LinkSample* prev_link = link_history_recent(&s_link_history, 0);
+    telemetry_note_link(link_plan.tier, link_plan.tx_power_qdbm, rssi,
+                        prev_link ? link_sample_rate_bps(prev_link) : 0);
+    String wake_telemetry = telemetry_header();
 
     // ── 6. Upload photo ─────────────────────────────────────────────
-    String url = build_upload_url(cfg.hub_url, cfg.hive_id);
-    int http_code = upload_photo(
-        url.c_str(),
-        cfg.api_key,
-        cfg.device_id,
-        fb->buf,
-        fb->len,
-        timestamp.c_str()
-    );
+    PhotoUploadMeta meta;
+    meta.hive_id            = cfg.hive_id;
+    meta.boot_id            = s_boot_id;
+    meta.sequence           = s_boot_count;
+    meta.captured_at        = timestamp.c_str();
+    meta.captured_at_source = ntp_synced() ? "device_ntp" : "device_rtc";
+    meta.trigger_reason     = trigger_reason;
+    meta.wake_telemetry     = wake_telemetry.c_str();
+    meta.thumbnail          = thumb;
+    meta.thumbnail_len      = thumb_len;
+
+    String uploads_url = build_api_url(cfg.hub_url, "/api/photos/uploads");
+
+    // Finish what an earlier wake could not.  While it stays pending
+    // (link still bad), this wake's photo cannot take its slot.
+    PendingUpload pending;
+    bool have_pending = pending_exists() && pending_load(pending);
+    int pending_code = -1;
+    int http_code = -1;
+    bool backlog_sent = have_pending && link_plan.tier == LINK_GOOD
+                     && upload_backlog(cfg, pending, meta, fb, &pending_code, &http_code);
+
+    if (have_pending) {
+        if (!backlog_sent || pending_code < 0) {
+            log_i("Resuming pending photo seq %u", pending.sequence);
+            pending_code = upload_photo_resumable(uploads_url.c_str(), cfg.api_key,
+                                                  cfg.device_id, pending_meta(pending),
+                                                  pending.jpeg, pending.jpeg_len);
+            if (resumable_unsupported(pending_code)) {
+                pending_code = upload_photo(
+                    build_api_url(cfg.hub_url, "/api/photos/upload").c_str(),
+                    cfg.api_key, cfg.device_id, pending_meta(pending),
+                    pending.jpeg, pending.jpeg_len);
+            }
+        }
+        if (!upload_retryable(pending_code)) {
+            pending_clear();
+        }
+        pending_free(pending);
+    }
+
+    if (!backlog_sent || http_code < 0) {
+        http_code = upload_photo_resumable(
+            uploads_url.c_str(),
+            cfg.api_key,
+            cfg.device_id,
+            meta,
+            fb->buf,
+            fb->len
+        );
+        if (resumable_unsupported(http_code)) {
+            String url = build_api_url(cfg.hub_url, "/api/photos/upload");
+            http_code = upload_photo(url.c_str(), cfg.api_key, cfg.device_id,
+                                     meta, fb->buf, fb->len);
+        } else if (upload_retryable(http_code)) {
+            pending_save(meta, fb->buf, fb->len);
+        }
+    } else if (upload_retryable(http_code)) {
+        pending_save(meta, fb->buf, fb->len);
+    }
+
+    telemetry_mark(TEL_UPLOAD);
+    telemetry_note_upload(http_code >= 200 && http_code < 300);
+    record_link(link_plan, rssi, http_code >= 200 && http_code < 300);
 
     if (http_code >= 200 && http_code < 300) {
         log_i("Upload successful: HTTP %d", http_code);
@@ -129,12 +398,13 @@ void setup() {
     // ── 7. Disconnect WiFi ──────────────────────────────────────────
     wifi_disconnect();
 
-    // ── 8. Release frame and deinit camera ──────────────────────────
+    // ── 8. Release frames and deinit camera ─────────────────────────
+    free(thumb);
     camera_release(fb);
     camera_deinit();
 
     // ── 9. Deep sleep ───────────────────────────────────────────────
-    enter_deep_sleep(cfg.sleep_sec);
+    enter_deep_sleep(&cfg, activity_wake);
 }
 
 // ── loop() — never reached (deep sleep restarts from setup()) ───────
@@ -5,6 +5,7 @@
 
 #include <Arduino.h>
 #include <time.h>
+#include <sys/time.h>
 #include <esp_sntp.h>
 
 // ── Track last sync time in RTC memory (survives deep sleep) ────────
@@ -57,19 +58,21 @@ bool ntp_synced() {
 }
 
 String get_timestamp_iso8601() {
-    time_t now;
-    time(&now);
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    time_t now = tv.tv_sec;
     struct tm timeinfo;
     gmtime_r(&now, &timeinfo);
 
-    char buf[25];  // "2026-02-08T14:30:00Z" = 20 chars + null
-    snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02dZ",
+    char buf[25];  // "2026-02-08T14:30:00.123Z" = 24 chars + null
+    snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
              timeinfo.tm_year + 1900,
              timeinfo.tm_mon + 1,
              timeinfo.tm_mday,
              timeinfo.tm_hour,
              timeinfo.tm_min,
-             timeinfo.tm_sec);
+             timeinfo.tm_sec,
+             (int)(tv.tv_usec / 1000));
 
     return String(buf);
 }
@@ -15,8 +15,9 @@ bool ntp_init();
 // Returns true if the year is >= 2024 (i.e., not the 1970 epoch default).
 bool ntp_synced();
 
-// Get the current time as an ISO 8601 string (e.g. "2026-02-08T14:30:00Z").
-// Returns "1970-01-01T00:00:00Z" if NTP has not synced yet.
+// Get the current time as an ISO 8601 string with milliseconds
+// (e.g. "2026-02-08T14:30:00.123Z"), the format the hub stores.
+// Returns a 1970-based time if NTP has not synced yet.
 String get_timestamp_iso8601();
 
 // Check whether an NTP sync is needed.
@@ -33,11 +33,20 @@ bool nvs_load_config(DeviceConfig& cfg) {
     prefs_get_str(prefs, "wifi_pass",  cfg.wifi_pass,  sizeof(cfg.wifi_pass));
     prefs_get_str(prefs, "hub_url",    cfg.hub_url,    sizeof(cfg.hub_url));
     cfg.sleep_sec = prefs.getInt("sleep_sec", 0);
+    cfg.trigger_wake = prefs.getBool("trig_wake", true);
+    cfg.thumbnail = prefs.getBool("thumb", true);
+    cfg.night_start_min = prefs.getInt("night_start", WAKE_NIGHT_START_MIN);
+    cfg.night_end_min = prefs.getInt("night_end", WAKE_NIGHT_END_MIN);
+    cfg.utc_offset_min = prefs.getInt("utc_off", WAKE_UTC_OFFSET_MIN);
+    cfg.battery_floor_mv = prefs.getInt("bat_floor", WAKE_BATTERY_FLOOR_MV);
 
     prefs.end();
 
-    log_i("NVS config loaded: device_id=%s hive_id=%s hub_url=%s sleep=%d",
-          cfg.device_id, cfg.hive_id, cfg.hub_url, cfg.sleep_sec);
+    log_i("NVS config loaded: device_id=%s hive_id=%s hub_url=%s sleep=%d trig_wake=%d thumb=%d "
+          "night=%d-%d utc_off=%d bat_floor=%d",
+          cfg.device_id, cfg.hive_id, cfg.hub_url, cfg.sleep_sec, cfg.trigger_wake,
+          cfg.thumbnail, cfg.night_start_min, cfg.night_end_min, cfg.utc_offset_min,
+          cfg.battery_floor_mv);
 
     // Minimal viable config: must have device_id and wifi_ssid
     bool valid = (strlen(cfg.device_id) > 0) && (strlen(cfg.wifi_ssid) > 0);
@@ -61,6 +70,12 @@ bool nvs_save_config(const DeviceConfig& cfg) {
     prefs.putString("wifi_pass",  cfg.wifi_pass);
     prefs.putString("hub_url",    cfg.hub_url);
     prefs.putInt("sleep_sec",     cfg.sleep_sec);
+    prefs.putBool("trig_wake",    cfg.trigger_wake);
+    prefs.putBool("thumb",        cfg.thumbnail);
+    prefs.putInt("night_start",   cfg.night_start_min);
+    prefs.putInt("night_end",     cfg.night_end_min);
+    prefs.putInt("utc_off",       cfg.utc_offset_min);
+    prefs.putInt("bat_floor",     cfg.battery_floor_mv);
 
     prefs.end();
 
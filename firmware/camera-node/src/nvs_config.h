@@ -15,11 +15,19 @@ struct DeviceConfig {
     char wifi_pass[65];   // WiFi password (up to 64 chars + null)
     char hub_url[128];    // Hub base URL, e.g. "http://192.168.1.50:8000"
     int  sleep_sec;       // Deep sleep interval in seconds (0 = use DEFAULT_SLEEP_SEC)
+    bool trigger_wake;    // Also wake on the sensor node's activity line (default true)
+    bool thumbnail;       // Upload a thumbnail alongside the full frame (default true)
+    int  night_start_min; // Night window, local minutes of day (start == end: none)
+    int  night_end_min;
+    int  utc_offset_min;  // Local time = UTC + offset
+    int  battery_floor_mv; // Wake stub skips captures below this (0 = never)
 };
 
 // Load configuration from NVS "waggle" namespace.
 // Populates all fields of cfg.  Missing string fields are set to empty (""),
-// missing sleep_sec is set to 0 (caller should fall back to DEFAULT_SLEEP_SEC).
+// missing sleep_sec is set to 0 (caller should fall back to DEFAULT_SLEEP_SEC),
+// missing trigger_wake and thumbnail are set to true, and the wake stub
+// fields default to the WAKE_* values in config.h.
 // Returns true if at least device_id and wifi_ssid are non-empty (minimal viable config).
 bool nvs_load_config(DeviceConfig& cfg);
 
@@ -0,0 +1,173 @@
+// Waggle Camera Node — Pending upload storage implementation.
+
+#include "pending_upload.h"
+#include "upload_resume.h"
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#define PENDING_PATH     "/pending.bin"
+#define PENDING_MAGIC    0x55504757   // "WGPU"
+#define PENDING_VERSION  1
+
+// ── On-flash record: header followed by the JPEG bytes ──────────────
+struct PendingHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    char     hive_id[8];
+    uint32_t boot_id;
+    uint32_t sequence;
+    char     captured_at[25];
+    char     captured_at_source[12];
+    char     trigger_reason[10];
+    uint32_t jpeg_len;
+    uint32_t jpeg_crc32;
+};
+
+// -1 = unknown (power-on), 0 = none, 1 = stored
+RTC_DATA_ATTR static int8_t s_pending_state = -1;
+
+static bool s_mounted = false;
+
+static bool mount() {
+    if (!s_mounted) {
+        // Format on first use: the partition only ever holds this file
+        s_mounted = LittleFS.begin(true);
+        if (!s_mounted) {
+            log_e("LittleFS mount failed");
+        }
+    }
+    return s_mounted;
+}
+
+static void copy_field(char* dst, size_t cap, const char* src) {
+    strncpy(dst, src ? src : "", cap - 1);
+    dst[cap - 1] = '\0';
+}
+
+bool pending_exists() {
+    if (s_pending_state < 0) {
+        s_pending_state = (mount() && LittleFS.exists(PENDING_PATH)) ? 1 : 0;
+    }
+    return s_pending_state == 1;
+}
+
+bool pending_save(const PhotoUploadMeta& meta, const uint8_t* jpeg, size_t jpeg_len) {
+    if (pending_exists()) {
+        log_w("Pending slot busy — photo seq %u not kept", meta.sequence);
+        return false;
+    }
+    if (!mount()) {
+        return false;
+    }
+
+    PendingHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = PENDING_MAGIC;
+    h.version = PENDING_VERSION;
+    copy_field(h.hive_id, sizeof(h.hive_id), meta.hive_id);
+    h.boot_id = meta.boot_id;
+    h.sequence = meta.sequence;
+    copy_field(h.captured_at, sizeof(h.captured_at), meta.captured_at);
+    copy_field(h.captured_at_source, sizeof(h.captured_at_source), meta.captured_at_source);
+    copy_field(h.trigger_reason, sizeof(h.trigger_reason), meta.trigger_reason);
+    h.jpeg_len = (uint32_t)jpeg_len;
+    h.jpeg_crc32 = upload_crc32(0, jpeg, jpeg_len);
+
+    File f = LittleFS.open(PENDING_PATH, "w");
+    if (!f) {
+        log_e("Cannot open %s for writing", PENDING_PATH);
+        return false;
+    }
+    bool ok = f.write((const uint8_t*)&h, sizeof(h)) == sizeof(h)
+           && f.write(jpeg, jpeg_len) == jpeg_len;
+    f.close();
+    if (!ok) {
+        log_e("Pending write failed (flash full?)");
+        LittleFS.remove(PENDING_PATH);
+        return false;
+    }
+
+    s_pending_state = 1;
+    log_i("Kept photo seq %u (%u bytes) for resume on next wake", meta.sequence, jpeg_len);
+    return true;
+}
+
+bool pending_load(PendingUpload& out) {
+    out.jpeg = nullptr;
+    out.jpeg_len = 0;
+    if (!pending_exists() || !mount()) {
+        return false;
+    }
+
+    File f = LittleFS.open(PENDING_PATH, "r");
+    if (!f) {
+        s_pending_state = 0;
+        return false;
+    }
+
+    PendingHeader h;
+    bool ok = f.read((uint8_t*)&h, sizeof(h)) == sizeof(h)
+           && h.magic == PENDING_MAGIC
+           && h.version == PENDING_VERSION
+           && h.jpeg_len > 0
+           && f.size() == sizeof(h) + h.jpeg_len;
+    if (ok) {
+        out.jpeg = (uint8_t*)ps_malloc(h.jpeg_len);
+        if (out.jpeg == nullptr) {
+            out.jpeg = (uint8_t*)malloc(h.jpeg_len);
+        }
+        ok = out.jpeg != nullptr
+          && f.read(out.jpeg, h.jpeg_len) == h.jpeg_len
+          && upload_crc32(0, out.jpeg, h.jpeg_len) == h.jpeg_crc32;
+    }
+    f.close();
+
+    if (!ok) {
+        log_w("Discarding unreadable pending upload");
+        pending_free(out);
+        pending_clear();
+        return false;
+    }
+
+    h.hive_id[sizeof(h.hive_id) - 1] = '\0';
+    h.captured_at[sizeof(h.captured_at) - 1] = '\0';
+    h.captured_at_source[sizeof(h.captured_at_source) - 1] = '\0';
+    h.trigger_reason[sizeof(h.trigger_reason) - 1] = '\0';
+    memcpy(out.hive_id, h.hive_id, sizeof(out.hive_id));
+    out.boot_id = h.boot_id;
+    out.sequence = h.sequence;
+    memcpy(out.captured_at, h.captured_at, sizeof(out.captured_at));
+    memcpy(out.captured_at_source, h.captured_at_source, sizeof(out.captured_at_source));
+    memcpy(out.trigger_reason, h.trigger_reason, sizeof(out.trigger_reason));
+    out.jpeg_len = h.jpeg_len;
+    return true;
+}
+
+PhotoUploadMeta pending_meta(const PendingUpload& p) {
+    PhotoUploadMeta meta;
+    meta.hive_id            = p.hive_id;
+    meta.boot_id            = p.boot_id;
+    meta.sequence           = p.sequence;
+    meta.captured_at        = p.captured_at;
+    meta.captured_at_source = p.captured_at_source;
+    meta.trigger_reason     = p.trigger_reason;
+    meta.wake_telemetry     = nullptr;   // Belongs to the wake that sends it
+    meta.thumbnail          = nullptr;
+    meta.thumbnail_len      = 0;
+    return meta;
+}
+
+void pending_free(PendingUpload& p) {
+    free(p.jpeg);
+    p.jpeg = nullptr;
+    p.jpeg_len = 0;
+}
+
+void pending_clear() {
+    if (mount() && LittleFS.exists(PENDING_PATH)) {
+        LittleFS.remove(PENDING_PATH);
+    }
+    s_pending_state = 0;
+}
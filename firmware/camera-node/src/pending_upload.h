@@ -0,0 +1,46 @@
+// Waggle Camera Node — Pending upload kept in flash across deep sleep.
+//
+// When a resumable upload cannot finish, the JPEG and its metadata are
+// written to LittleFS so the next wake can re-announce the same
+// (boot_id, sequence) and continue from the offset the hub already
+// acknowledged.  One slot: a newer failure does not replace an upload
+// that is still being resumed.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "wifi_upload.h"
+
+struct PendingUpload {
+    char     hive_id[8];
+    uint32_t boot_id;
+    uint32_t sequence;
+    char     captured_at[25];
+    char     captured_at_source[12];
+    char     trigger_reason[10];
+    uint8_t* jpeg;            // Heap copy (PSRAM when available), free with pending_free()
+    size_t   jpeg_len;
+};
+
+// True if a pending upload is stored.  Uses an RTC hint, so LittleFS is
+// only mounted after power-on or when an upload is actually pending.
+bool pending_exists();
+
+// Store the photo described by meta (thumbnail and telemetry are not
+// kept).  Returns false if the slot is taken or the write fails.
+bool pending_save(const PhotoUploadMeta& meta, const uint8_t* jpeg, size_t jpeg_len);
+
+// Load the stored upload; the JPEG is CRC-checked.  A corrupt record is
+// deleted.  Returns false if nothing usable is stored.
+bool pending_load(PendingUpload& out);
+
+// Metadata view for upload_photo_resumable(); valid while p is.
+PhotoUploadMeta pending_meta(const PendingUpload& p);
+
+// Release the JPEG buffer from pending_load().
+void pending_free(PendingUpload& p);
+
+// Delete the stored upload (finished or rejected by the hub).
+void pending_clear();
@@ -0,0 +1,125 @@
+// Waggle Camera Node — Wake telemetry implementation.
+
+#include "telemetry.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+// ── Previous-wake data — survives deep sleep ────────────────────────
+struct PrevWake {
+    bool     valid;
+    uint32_t upload_ms;
+    uint32_t teardown_ms;
+    uint32_t awake_ms;
+};
+
+RTC_DATA_ATTR static PrevWake s_prev = {false, 0, 0, 0};
+RTC_DATA_ATTR static uint16_t s_wifi_failures   = 0;  // Consecutive failed connects
+RTC_DATA_ATTR static uint16_t s_upload_failures = 0;  // Consecutive failed uploads
+
+// ── This wake ───────────────────────────────────────────────────────
+static uint32_t s_phase_ms[TEL_PHASE_COUNT];
+static uint32_t s_last_mark_ms = 0;
+static uint16_t s_battery_mv   = 0;
+static uint32_t s_stub_skips   = 0;
+static uint8_t  s_link_tier    = 0;
+static uint8_t  s_link_txp     = 0;
+static int8_t   s_link_rssi    = 0;
+static uint32_t s_link_prev_bps = 0;
+
+// Keys in TelemetryPhase order; upload and teardown are only ever
+// reported for the previous wake.
+static const char* const PHASE_KEYS[TEL_PHASE_COUNT] = {
+    "boot", "nvs", "cam", "warm", "thumb", "cap", "wifi", "sync", nullptr, nullptr
+};
+
+void telemetry_begin() {
+    memset(s_phase_ms, 0, sizeof(s_phase_ms));
+    s_last_mark_ms = millis();
+    s_phase_ms[TEL_BOOT] = s_last_mark_ms;
+    s_battery_mv = 0;
+}
+
+void telemetry_mark(TelemetryPhase phase) {
+    uint32_t now = millis();
+    s_phase_ms[phase] += now - s_last_mark_ms;
+    s_last_mark_ms = now;
+}
+
+void telemetry_sample_battery() {
+#if BATTERY_ADC_PIN >= 0
+    uint32_t sum = 0;
+    for (int i = 0; i < BATTERY_ADC_SAMPLES; i++) {
+        sum += analogReadMilliVolts(BATTERY_ADC_PIN);
+    }
+    s_battery_mv = (uint16_t)((sum / BATTERY_ADC_SAMPLES) * BATTERY_DIVIDER_RATIO);
+    log_i("Battery: %u mV", s_battery_mv);
+#endif
+}
+
+uint16_t telemetry_battery_mv() {
+    return s_battery_mv;
+}
+
+void telemetry_note_stub_skips(uint32_t skipped) {
+    s_stub_skips = skipped;
+}
+
+void telemetry_note_link(uint8_t tier, uint8_t tx_power_qdbm, int8_t rssi_dbm,
+                         uint32_t prev_rate_bps) {
+    s_link_tier = tier;
+    s_link_txp = tx_power_qdbm;
+    s_link_rssi = rssi_dbm;
+    s_link_prev_bps = prev_rate_bps;
+}
+
+void telemetry_note_wifi(bool ok) {
+    s_wifi_failures = ok ? 0 : (uint16_t)(s_wifi_failures + 1);
+}
+
+void telemetry_note_upload(bool ok) {
+    s_upload_failures = ok ? 0 : (uint16_t)(s_upload_failures + 1);
+}
+
+String telemetry_header() {
+    String out = "v=1";
+    for (int i = 0; i < TEL_PHASE_COUNT; i++) {
+        if (PHASE_KEYS[i] == nullptr) {
+            continue;
+        }
+        out += ",";
+        out += PHASE_KEYS[i];
+        out += "=";
+        out += s_phase_ms[i];
+    }
+    if (s_prev.valid) {
+        out += ",pup=";    out += s_prev.upload_ms;
+        out += ",ptd=";    out += s_prev.teardown_ms;
+        out += ",pawake="; out += s_prev.awake_ms;
+    }
+    out += ",vbat=";  out += s_battery_mv;
+    out += ",wfail="; out += s_wifi_failures;
+    out += ",ufail="; out += s_upload_failures;
+    out += ",sskip="; out += s_stub_skips;
+    out += ",link=";  out += s_link_tier;
+    out += ",txp=";   out += s_link_txp;
+    out += ",rssi=";  out += -(int)s_link_rssi;
+    out += ",ptput="; out += s_link_prev_bps;
+    return out;
+}
+
+void telemetry_finish() {
+    uint32_t awake = millis();
+    log_i("Wake telemetry: boot=%u nvs=%u cam=%u warm=%u thumb=%u cap=%u wifi=%u "
+          "sync=%u upload=%u teardown=%u awake=%u ms",
+          s_phase_ms[TEL_BOOT], s_phase_ms[TEL_NVS], s_phase_ms[TEL_CAMERA_INIT],
+          s_phase_ms[TEL_WARMUP], s_phase_ms[TEL_THUMBNAIL], s_phase_ms[TEL_CAPTURE],
+          s_phase_ms[TEL_WIFI],
+          s_phase_ms[TEL_TIME_SYNC], s_phase_ms[TEL_UPLOAD],
+          s_phase_ms[TEL_TEARDOWN], awake);
+
+    s_prev.valid       = true;
+    s_prev.upload_ms   = s_phase_ms[TEL_UPLOAD];
+    s_prev.teardown_ms = s_phase_ms[TEL_TEARDOWN];
+    s_prev.awake_ms    = awake;
+}
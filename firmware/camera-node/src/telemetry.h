@@ -0,0 +1,69 @@
+// Waggle Camera Node — Wake-cycle timing and energy telemetry.
+// Times each phase of a wake (boot through teardown), samples battery
+// voltage and tracks consecutive WiFi/upload failures.  Counters and the
+// phases that finish after the upload (upload, teardown, total awake
+// time) are kept in RTC memory and reported with the next upload.
+//
+// Sent as a compact X-Wake-Telemetry header of comma-separated
+// key=value pairs, e.g.:
+//   v=1,boot=312,nvs=4,cam=410,warm=180,thumb=240,cap=95,wifi=1830,sync=0,
+//   pup=640,ptd=85,pawake=3900,vbat=3987,wfail=0,ufail=0,sskip=3,
+//   link=1,txp=50,rssi=58,ptput=41250
+// Durations are milliseconds, vbat is millivolts (0 = not measured),
+// p-prefixed keys describe the previous wake (omitted after power-on),
+// sskip counts wakes the deep-sleep stub skipped since the last boot.
+// link is this wake's LinkTier, txp its TX power in 0.25 dBm, rssi the
+// association RSSI as -dBm (values are unsigned) and ptput the previous
+// wake's upload throughput in bytes/s (link_adapt.h).
+
+#pragma once
+
+#include <Arduino.h>
+
+// ── Wake phases, in the order they run ──────────────────────────────
+enum TelemetryPhase {
+    TEL_BOOT = 0,       // Reset to setup() entry
+    TEL_NVS,            // Config load
+    TEL_CAMERA_INIT,    // Sensor power-up and driver init
+    TEL_WARMUP,         // Discarded auto-exposure frame
+    TEL_THUMBNAIL,      // Thumbnail grab incl. frame size switches (0 when off)
+    TEL_CAPTURE,        // Frame grab
+    TEL_WIFI,           // Association + DHCP
+    TEL_TIME_SYNC,      // NTP (0 when skipped)
+    TEL_UPLOAD,         // HTTP POST
+    TEL_TEARDOWN,       // WiFi off, camera deinit
+    TEL_PHASE_COUNT
+};
+
+// Start a wake: records the boot phase.  Call first thing in setup().
+void telemetry_begin();
+
+// Close the given phase: it is charged with the time since the previous
+// mark (or since telemetry_begin()).
+void telemetry_mark(TelemetryPhase phase);
+
+// Sample the battery divider on BATTERY_ADC_PIN.  Must run before WiFi
+// starts (ADC2 is unavailable while the radio is on).
+void telemetry_sample_battery();
+
+// Last battery sample in mV (0 = not measured).
+uint16_t telemetry_battery_mv();
+
+// Wakes the deep-sleep stub skipped before this boot (wake_stub.h).
+void telemetry_note_stub_skips(uint32_t skipped);
+
+// Link plan in force this wake, the RSSI it connected at and the
+// previous wake's upload throughput (bytes/s, 0 = unknown).
+void telemetry_note_link(uint8_t tier, uint8_t tx_power_qdbm, int8_t rssi_dbm,
+                         uint32_t prev_rate_bps);
+
+// Record the outcome of this wake's WiFi connect / upload.
+void telemetry_note_wifi(bool ok);
+void telemetry_note_upload(bool ok);
+
+// Header value for this upload (see format above).
+String telemetry_header();
+
+// Persist this wake's upload/teardown/awake time for the next report.
+// Call immediately before deep sleep.
+void telemetry_finish();
@@ -0,0 +1,157 @@
+// Waggle Camera Node — Resumable upload helpers implementation.
+
+#include "upload_resume.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ── CRC-32 ────────────────────────────────────────────────────────────
+// Nibble table: 64 bytes of flash, ~2x slower than a 1 KB byte table,
+// still well under a millisecond per chunk on the ESP32.
+
+static const uint32_t CRC_NIBBLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t upload_crc32(uint32_t crc, const uint8_t* data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+        crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+// ── Adaptive chunk size ───────────────────────────────────────────────
+
+uint32_t chunk_size_clamp(uint32_t size) {
+    if (size < UPLOAD_CHUNK_MIN) {
+        size = UPLOAD_CHUNK_MIN;
+    }
+    if (size > UPLOAD_CHUNK_MAX) {
+        size = UPLOAD_CHUNK_MAX;
+    }
+    return size - (size % UPLOAD_CHUNK_ALIGN);
+}
+
+void chunk_sizer_init(ChunkSizer* cs) {
+    cs->size = UPLOAD_CHUNK_INITIAL;
+    cs->rate_bps = 0;
+}
+
+void chunk_sizer_update(ChunkSizer* cs, uint32_t bytes, uint32_t elapsed_ms, bool ok) {
+    if (!ok) {
+        cs->size = chunk_size_clamp(cs->size / 2);
+        return;
+    }
+
+    if (elapsed_ms == 0) {
+        elapsed_ms = 1;
+    }
+    cs->rate_bps = (uint32_t)((uint64_t)bytes * 1000 / elapsed_ms);
+
+    uint64_t ideal = (uint64_t)cs->rate_bps * UPLOAD_CHUNK_TARGET_MS / 1000;
+    uint64_t ceiling = (uint64_t)cs->size * 2;
+    if (ideal > ceiling) {
+        ideal = ceiling;
+    }
+    // A short final chunk says little about the link, so it never
+    // shrinks the size.
+    if (ideal < cs->size && bytes < cs->size) {
+        return;
+    }
+    cs->size = chunk_size_clamp((uint32_t)(ideal > UPLOAD_CHUNK_MAX ? UPLOAD_CHUNK_MAX : ideal));
+}
+
+// ── Reply parsing ─────────────────────────────────────────────────────
+
+// Find the value that follows "key": and return a pointer to it.
+static const char* find_value(const char* json, const char* key) {
+    size_t key_len = strlen(key);
+    const char* p = json;
+    while ((p = strchr(p, '"')) != nullptr) {
+        p++;
+        if (strncmp(p, key, key_len) == 0 && p[key_len] == '"') {
+            const char* v = p + key_len + 1;
+            while (*v == ' ' || *v == '\t' || *v == '\r' || *v == '\n') {
+                v++;
+            }
+            if (*v == ':') {
+                v++;
+                while (*v == ' ' || *v == '\t' || *v == '\r' || *v == '\n') {
+                    v++;
+                }
+                return v;
+            }
+        }
+        // Skip to the end of this string token
+        while (*p && *p != '"') {
+            if (*p == '\\' && p[1]) {
+                p++;
+            }
+            p++;
+        }
+        if (*p == '"') {
+            p++;
+        }
+    }
+    return nullptr;
+}
+
+bool json_find_uint(const char* json, const char* key, uint32_t* out) {
+    const char* v = find_value(json, key);
+    if (v == nullptr || *v < '0' || *v > '9') {
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long long value = strtoull(v, &end, 10);
+    if (value > 0xFFFFFFFFULL) {
+        return false;
+    }
+    *out = (uint32_t)value;
+    return true;
+}
+
+bool json_find_bool(const char* json, const char* key, bool* out) {
+    const char* v = find_value(json, key);
+    if (v == nullptr) {
+        return false;
+    }
+    if (strncmp(v, "true", 4) == 0) {
+        *out = true;
+        return true;
+    }
+    if (strncmp(v, "false", 5) == 0) {
+        *out = false;
+        return true;
+    }
+    return false;
+}
+
+bool json_find_string(const char* json, const char* key, char* out, size_t cap) {
+    const char* v = find_value(json, key);
+    if (v == nullptr || *v != '"' || cap == 0) {
+        return false;
+    }
+    v++;
+    size_t n = 0;
+    while (*v && *v != '"') {
+        if (*v == '\\') {
+            return false;   // Escapes never appear in ids we parse
+        }
+        if (n + 1 >= cap) {
+            return false;
+        }
+        out[n++] = *v++;
+    }
+    if (*v != '"') {
+        return false;
+    }
+    out[n] = '\0';
+    return true;
+}
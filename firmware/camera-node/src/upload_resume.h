@@ -0,0 +1,65 @@
+// Waggle Camera Node — Resumable upload helpers.
+//
+// Pure logic (no Arduino, no sockets) behind upload_photo_resumable():
+//   - CRC-32 (IEEE, same value as Python's zlib.crc32) for the per-chunk
+//     and whole-photo checks
+//   - chunk sizing that follows observed link throughput
+//   - pulling the few fields the device needs out of the hub's JSON
+//     replies
+//
+// Protocol (see routers/photos.py):
+//   POST {hub}/api/photos/uploads           -> upload_id, offset, chunk_size
+//   PUT  {hub}/api/photos/uploads/{id}      X-Upload-Offset, X-Chunk-CRC32
+// Re-posting the same (boot_id, sequence) returns the acknowledged
+// offset, so a transfer broken on a weak link continues on the next
+// attempt or wake.
+
+#ifndef UPLOAD_RESUME_H
+#define UPLOAD_RESUME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ── CRC-32 ────────────────────────────────────────────────────────────
+
+// Continue a CRC-32 over len more bytes; start with crc = 0.
+uint32_t upload_crc32(uint32_t crc, const uint8_t* data, size_t len);
+
+// ── Adaptive chunk size ───────────────────────────────────────────────
+//
+// Aims for chunks that take about UPLOAD_CHUNK_TARGET_MS on the current
+// link: long enough to amortise request overhead, short enough that a
+// drop loses little.  Grows at most 2x per good chunk and halves on a
+// failed one.
+
+#define UPLOAD_CHUNK_MIN        2048
+#define UPLOAD_CHUNK_MAX        32768
+#define UPLOAD_CHUNK_INITIAL    8192
+#define UPLOAD_CHUNK_TARGET_MS  1500
+#define UPLOAD_CHUNK_ALIGN      512
+
+struct ChunkSizer {
+    uint32_t size;          // Next chunk size in bytes
+    uint32_t rate_bps;      // Last observed throughput (bytes/s, 0 = unknown)
+};
+
+void chunk_sizer_init(ChunkSizer* cs);
+
+// Clamp to UPLOAD_CHUNK_MIN..MAX, rounded down to UPLOAD_CHUNK_ALIGN.
+uint32_t chunk_size_clamp(uint32_t size);
+
+// Record the outcome of one chunk: bytes sent, wall time for the request
+// and whether the hub acknowledged it.  Updates cs->size.
+void chunk_sizer_update(ChunkSizer* cs, uint32_t bytes, uint32_t elapsed_ms, bool ok);
+
+// ── Reply parsing ─────────────────────────────────────────────────────
+//
+// Minimal lookups for flat JSON objects ({"key": value, ...}); nested
+// objects are searched too, first match wins.  Return false if the key
+// is missing or has the wrong type.
+
+bool json_find_uint(const char* json, const char* key, uint32_t* out);
+bool json_find_bool(const char* json, const char* key, bool* out);
+bool json_find_string(const char* json, const char* key, char* out, size_t cap);
+
+#endif // UPLOAD_RESUME_H
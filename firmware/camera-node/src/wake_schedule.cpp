@@ -0,0 +1,100 @@
+// Waggle Camera Node — Wake schedule decision (see wake_schedule.h).
+//
+// Everything here may run from the wake stub, before the bootloader has
+// mapped flash: keep to WAKE_STUB_CODE functions and plain arithmetic.
+
+#include "wake_schedule.h"
+
+static uint32_t WAKE_STUB_CODE local_minute(const WakeSchedule* s, uint32_t now_s) {
+    int32_t offset_s = (int32_t)s->utc_offset_min * 60;
+    uint32_t local_s = now_s + (uint32_t)offset_s;  // Wraps correctly for negative offsets
+    return (local_s % 86400u) / 60u;
+}
+
+bool WAKE_STUB_CODE wake_schedule_is_night(const WakeSchedule* s, uint32_t now_s) {
+    if (s->night_start_min == s->night_end_min) {
+        return false;
+    }
+    uint32_t m = local_minute(s, now_s);
+    if (s->night_start_min < s->night_end_min) {
+        return m >= s->night_start_min && m < s->night_end_min;
+    }
+    return m >= s->night_start_min || m < s->night_end_min;  // Across midnight
+}
+
+// Seconds from now_s to the end of the night window (now_s is inside it).
+static uint32_t WAKE_STUB_CODE night_left_s(const WakeSchedule* s, uint32_t now_s) {
+    uint32_t m = local_minute(s, now_s);
+    uint32_t minutes = (s->night_end_min + WAKE_MINUTES_PER_DAY - m) % WAKE_MINUTES_PER_DAY;
+    uint32_t into_minute = (now_s + (uint32_t)((int32_t)s->utc_offset_min * 60)) % 60u;
+    return minutes * 60u - into_minute;
+}
+
+static WakeDecision WAKE_STUB_CODE skip(WakeSchedule* s, uint8_t reason, uint32_t sleep_s) {
+    if (s->skipped[reason] != 0xFFFF) {
+        s->skipped[reason]++;
+    }
+    WakeDecision d;
+    d.boot = false;
+    d.reason = reason;
+    d.sleep_s = sleep_s;
+    return d;
+}
+
+WakeDecision WAKE_STUB_CODE wake_schedule_decide(WakeSchedule* s, uint32_t now_s,
+                                                 bool activity_wake) {
+    WakeDecision boot;
+    boot.boot = true;
+    boot.reason = WAKE_SKIP_NONE;
+    boot.sleep_s = 0;
+    if (s->magic != WAKE_SCHEDULE_MAGIC || s->interval_s == 0) {
+        return boot;
+    }
+
+    if (!activity_wake && now_s + WAKE_EARLY_SLACK_S < s->next_capture_s) {
+        return skip(s, WAKE_SKIP_EARLY, s->next_capture_s - now_s);
+    }
+
+    // The first active reason (in priority order) is reported; the wake
+    // is held back until the last of them has cleared.
+    uint8_t reason = WAKE_SKIP_NONE;
+    uint32_t blocked_until = now_s;
+    if (s->skip_until_s > now_s) {
+        reason = WAKE_SKIP_SERVER;
+        blocked_until = s->skip_until_s;
+    }
+    if (s->battery_floor_mv != 0 && s->battery_mv != 0 && s->battery_mv < s->battery_floor_mv) {
+        uint32_t recheck_at = s->battery_checked_s + s->battery_recheck_s;
+        if (recheck_at > now_s) {
+            if (reason == WAKE_SKIP_NONE) {
+                reason = WAKE_SKIP_BATTERY;
+            }
+            if (recheck_at > blocked_until) {
+                blocked_until = recheck_at;
+            }
+        }
+    }
+    if (s->time_valid && wake_schedule_is_night(s, now_s)) {
+        if (reason == WAKE_SKIP_NONE) {
+            reason = WAKE_SKIP_NIGHT;
+        }
+        uint32_t night_end = now_s + night_left_s(s, now_s);
+        if (night_end > blocked_until) {
+            blocked_until = night_end;
+        }
+    }
+    if (reason == WAKE_SKIP_NONE) {
+        return boot;
+    }
+
+    if (!activity_wake || s->next_capture_s <= now_s) {
+        // First whole interval at or after blocked_until (and after now)
+        uint32_t target = (blocked_until > now_s) ? blocked_until : now_s + 1;
+        if (s->next_capture_s < target) {
+            uint32_t behind = target - s->next_capture_s;
+            uint32_t steps = (behind + s->interval_s - 1) / s->interval_s;
+            s->next_capture_s += steps * s->interval_s;
+        }
+    }
+    return skip(s, reason, s->next_capture_s - now_s);
+}
@@ -0,0 +1,80 @@
+// Waggle Camera Node — Capture schedule checked by the deep-sleep wake stub.
+//
+// Pure logic (no Arduino, no registers) behind the wake stub in
+// wake_stub.cpp.  Before each deep sleep the full firmware writes a
+// WakeSchedule into RTC memory; on the next wake the stub calls
+// wake_schedule_decide() before anything else boots, and either lets the
+// boot continue (a capture is due) or goes straight back to deep sleep.
+// Reasons to skip a wake:
+//
+//   early    a timer wake that arrived before the scheduled capture (RTC
+//            slow-clock drift); sleep out the rest
+//   server   the hub asked for a pause (X-Capture-Pause on an upload)
+//   battery  the last measured battery was below the floor; one wake per
+//            battery_recheck_s still boots to measure it again
+//   night    local time inside the night window (needs an NTP-set clock)
+//
+// A skipped timer wake moves next_capture_s forward in whole intervals,
+// past the end of every active reason, so the cadence is kept.  A skipped
+// activity wake sleeps until the capture already scheduled.
+//
+// Times are 32-bit epoch seconds.  The decision code is also compiled
+// into RTC fast memory for the stub (WAKE_STUB_CODE), so it uses no
+// library calls, no 64-bit division and no switch tables.
+
+#ifndef WAKE_SCHEDULE_H
+#define WAKE_SCHEDULE_H
+
+#include <stdint.h>
+
+#ifdef UNIT_TEST
+#define WAKE_STUB_CODE
+#else
+#include <esp_attr.h>
+#define WAKE_STUB_CODE RTC_IRAM_ATTR
+#endif
+
+#define WAKE_SCHEDULE_MAGIC   0x5753434Bu  // "WSCK"
+#define WAKE_EARLY_SLACK_S    5            // Timer wakes this close count as due
+#define WAKE_MINUTES_PER_DAY  1440
+
+enum WakeSkipReason : uint8_t {
+    WAKE_SKIP_NONE    = 0,
+    WAKE_SKIP_EARLY   = 1,
+    WAKE_SKIP_SERVER  = 2,
+    WAKE_SKIP_BATTERY = 3,
+    WAKE_SKIP_NIGHT   = 4,
+    WAKE_SKIP_COUNT
+};
+
+struct WakeSchedule {
+    uint32_t magic;              // WAKE_SCHEDULE_MAGIC once written
+    uint32_t next_capture_s;     // Scheduled capture (epoch s)
+    uint32_t interval_s;         // Capture interval
+    bool     time_valid;         // Clock set from NTP (night rule needs it)
+    int16_t  utc_offset_min;     // Local time = UTC + offset
+    uint16_t night_start_min;    // Local minute of day; start == end: no night
+    uint16_t night_end_min;
+    uint16_t battery_mv;         // Last full-boot measurement, 0 = unknown
+    uint16_t battery_floor_mv;   // 0 = no battery rule
+    uint32_t battery_checked_s;  // When battery_mv was measured
+    uint32_t battery_recheck_s;  // Boot to re-measure after this long
+    uint32_t skip_until_s;       // Hub-requested pause, 0 = none
+    uint16_t skipped[WAKE_SKIP_COUNT];  // Wakes skipped by the stub, per reason
+};
+
+struct WakeDecision {
+    bool     boot;      // true: continue the full boot
+    uint8_t  reason;    // WakeSkipReason when !boot
+    uint32_t sleep_s;   // Deep sleep before the next wake when !boot
+};
+
+// Decide a wake at now_s.  On a skip the schedule is updated (next
+// capture, skip counters) and the sleep length returned; a schedule that
+// was never written always boots.
+WakeDecision wake_schedule_decide(WakeSchedule* s, uint32_t now_s, bool activity_wake);
+
+// Whether local minute-of-day falls inside the night window.
+bool wake_schedule_is_night(const WakeSchedule* s, uint32_t now_s);
+
+#endif // WAKE_SCHEDULE_H
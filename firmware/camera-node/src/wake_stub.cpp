@@ -0,0 +1,128 @@
+// Waggle Camera Node — Deep-sleep wake stub implementation.
+//
+// esp_wake_deep_sleep() runs before the bootloader, with flash unmapped:
+// it may only touch RTC memory (RTC_DATA_ATTR data, RTC_IRAM_ATTR code),
+// peripheral registers and ROM functions (libgcc's 64-bit division is in
+// ROM).  Going back to sleep from the stub follows the ESP-IDF wake stub
+// documentation: program the RTC sleep timer, point RTC_ENTRY_ADDR_REG
+// back at the stub and toggle RTC_CNTL_SLEEP_EN.  The power-down and
+// wake-source configuration esp_deep_sleep_start() wrote stays in the RTC
+// registers, except that EXT0 is dropped for a sleep that starts with
+// the activity line still HIGH (it would wake again at once).
+
+#include "wake_stub.h"
+#include "config.h"
+
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_sleep.h>
+#include <driver/rtc_io.h>
+#include <soc/rtc.h>
+#include <soc/rtc_cntl_reg.h>
+#include <soc/rtc_io_reg.h>
+#include <time.h>
+
+#if __has_include(<esp32/clk.h>)
+#include <esp32/clk.h>           // esp_clk_slowclk_cal_get() (ESP-IDF 4.x)
+#else
+#include <esp_private/esp_clk.h>
+#endif
+
+// ── RTC state ───────────────────────────────────────────────────────
+// Epoch time and RTC slow-clock ticks at wake_stub_arm(), and the tick
+// period (microseconds, Q13.19) to convert between them.
+struct StubClock {
+    uint32_t epoch_s;
+    uint64_t ticks;
+    uint32_t cal;
+    bool     ext0_armed;
+    uint8_t  trigger_rtc_io;
+};
+
+RTC_DATA_ATTR static WakeSchedule s_schedule = {};
+RTC_DATA_ATTR static StubClock    s_clock = {};
+
+// ── Stub helpers (RTC fast memory) ──────────────────────────────────
+
+static uint64_t RTC_IRAM_ATTR stub_rtc_ticks() {
+    SET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_UPDATE);
+    while (GET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_VALID) == 0) {
+    }
+    SET_PERI_REG_MASK(RTC_CNTL_INT_CLR_REG, RTC_CNTL_TIME_VALID_INT_CLR);
+    return (uint64_t)READ_PERI_REG(RTC_CNTL_TIME0_REG) |
+           ((uint64_t)READ_PERI_REG(RTC_CNTL_TIME1_REG) << 32);
+}
+
+static bool RTC_IRAM_ATTR stub_trigger_high() {
+    uint32_t in = REG_GET_FIELD(RTC_GPIO_IN_REG, RTC_GPIO_IN_NEXT);
+    return ((in >> s_clock.trigger_rtc_io) & 1u) == TRIGGER_WAKE_LEVEL;
+}
+
+static void RTC_IRAM_ATTR stub_sleep(uint32_t sleep_s, bool ext0) {
+    uint64_t ticks = (((uint64_t)sleep_s * 1000000ULL) << RTC_CLK_CAL_FRACT) / s_clock.cal;
+    uint64_t target = stub_rtc_ticks() + ticks;
+    WRITE_PERI_REG(RTC_CNTL_SLP_TIMER0_REG, (uint32_t)target);
+    WRITE_PERI_REG(RTC_CNTL_SLP_TIMER1_REG, (uint32_t)(target >> 32));
+
+    uint32_t wake = RTC_TIMER_TRIG_EN | (ext0 ? RTC_EXT0_TRIG_EN : 0);
+    REG_SET_FIELD(RTC_CNTL_WAKEUP_STATE_REG, RTC_CNTL_WAKEUP_ENA, wake);
+
+    REG_WRITE(RTC_ENTRY_ADDR_REG, (uint32_t)&esp_wake_deep_sleep);
+    CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+    SET_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+    while (true) {
+        // Sleep starts within a few cycles
+    }
+}
+
+// ── The stub ────────────────────────────────────────────────────────
+// Replaces the weak ESP-IDF default.  Returning continues the normal boot.
+extern "C" void RTC_IRAM_ATTR esp_wake_deep_sleep(void) {
+    esp_default_wake_deep_sleep();
+    if (s_schedule.magic != WAKE_SCHEDULE_MAGIC || s_clock.cal == 0) {
+        return;
+    }
+
+    uint32_t cause = REG_GET_FIELD(RTC_CNTL_WAKEUP_STATE_REG, RTC_CNTL_WAKEUP_CAUSE);
+    bool activity = (cause & RTC_EXT0_TRIG_EN) != 0;
+    if (!activity && (cause & RTC_TIMER_TRIG_EN) == 0) {
+        return;
+    }
+
+    uint64_t elapsed_us = ((stub_rtc_ticks() - s_clock.ticks) * s_clock.cal) >> RTC_CLK_CAL_FRACT;
+    uint32_t now_s = s_clock.epoch_s + (uint32_t)(elapsed_us / 1000000ULL);
+
+    WakeDecision d = wake_schedule_decide(&s_schedule, now_s, activity);
+    if (d.boot) {
+        return;
+    }
+    stub_sleep(d.sleep_s, s_clock.ext0_armed && !stub_trigger_high());
+}
+
+// ── Full-firmware side ──────────────────────────────────────────────
+
+WakeSchedule* wake_stub_schedule() {
+    return &s_schedule;
+}
+
+void wake_stub_arm(bool ext0_armed) {
+    s_clock.epoch_s = (uint32_t)time(nullptr);
+    s_clock.ticks = rtc_time_get();
+    s_clock.cal = esp_clk_slowclk_cal_get();
+    s_clock.ext0_armed = ext0_armed;
+    s_clock.trigger_rtc_io = (uint8_t)rtc_io_number_get(TRIGGER_WAKE_PIN);
+    s_schedule.magic = WAKE_SCHEDULE_MAGIC;
+}
+
+void wake_stub_disarm() {
+    s_schedule.magic = 0;
+}
+
+uint32_t wake_stub_take_skipped() {
+    uint32_t total = 0;
+    for (int r = 0; r < WAKE_SKIP_COUNT; r++) {
+        total += s_schedule.skipped[r];
+        s_schedule.skipped[r] = 0;
+    }
+    return total;
+}
@@ -0,0 +1,35 @@
+// Waggle Camera Node — Deep-sleep wake stub.
+//
+// A full wake costs the ROM and second-stage bootloader, Arduino start-up,
+// Serial, NVS and camera init before setup() can decide anything.  The
+// stub (esp_wake_deep_sleep, in RTC fast memory) runs straight after the
+// ROM instead: it reads the RTC timer, checks the WakeSchedule the last
+// full wake left in RTC memory (wake_schedule.h) and, when no capture is
+// due, re-arms the sleep timer and goes back to deep sleep within a few
+// milliseconds.  Only wakes that capture pay for the boot.
+//
+// Before each deep sleep, fill wake_stub_schedule() and call
+// wake_stub_arm().  Wakes the stub skipped are counted per reason and
+// reported by the next full wake (telemetry "sskip").
+
+#pragma once
+
+#include <stdint.h>
+
+#include "wake_schedule.h"
+
+// The schedule the stub will check, kept in RTC memory.  next_capture_s
+// is the scheduled capture for this and later wakes.
+WakeSchedule* wake_stub_schedule();
+
+// Record the time reference the stub converts RTC ticks with, mark the
+// schedule valid and note whether EXT0 (activity line) was armed.  Call
+// immediately before esp_deep_sleep_start().
+void wake_stub_arm(bool ext0_armed);
+
+// Disable the stub's checks: the next wake boots whatever the schedule.
+void wake_stub_disarm();
+
+// Wakes skipped by the stub since the last call; the per-reason counters
+// are reset.
+uint32_t wake_stub_take_skipped();
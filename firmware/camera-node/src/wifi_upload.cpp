@@ -2,17 +2,29 @@
 
 #include "wifi_upload.h"
 #include "config.h"
+#include "upload_resume.h"
 
 #include <Arduino.h>
 #include <WiFi.h>
 #include <HTTPClient.h>
+#include <esp_wifi.h>
 
 // ── WiFi Connection ─────────────────────────────────────────────────
 
-bool wifi_connect(const char* ssid, const char* pass, uint32_t timeout_ms) {
+bool wifi_connect(const char* ssid, const char* pass, uint32_t timeout_ms,
+                  const LinkPlan* plan) {
     log_i("Connecting to WiFi SSID: %s", ssid);
 
     WiFi.mode(WIFI_STA);
+    if (plan != nullptr) {
+        // Protocol and bandwidth only take effect before association
+        esp_wifi_set_protocol(WIFI_IF_STA, plan->protocols);
+        esp_wifi_set_bandwidth(WIFI_IF_STA, plan->ht40 ? WIFI_BW_HT40 : WIFI_BW_HT20);
+        esp_wifi_set_max_tx_power((int8_t)plan->tx_power_qdbm);
+        log_i("Link plan: %s, tx %.2f dBm, proto 0x%x, %s, chunk %u B x%u retries",
+              link_tier_name(plan->tier), plan->tx_power_qdbm / 4.0f, plan->protocols,
+              plan->ht40 ? "HT40" : "HT20", plan->chunk_bytes, plan->chunk_retries);
+    }
     WiFi.begin(ssid, pass);
 
     unsigned long start = millis();
@@ -31,6 +43,10 @@ bool wifi_connect(const char* ssid, const char* pass, uint32_t timeout_ms) {
     return true;
 }
 
+int8_t wifi_rssi() {
+    return (WiFi.status() == WL_CONNECTED) ? (int8_t)WiFi.RSSI() : LINK_RSSI_NONE;
+}
+
 void wifi_disconnect() {
     WiFi.disconnect(true);   // true = erase AP credentials from RAM
     WiFi.mode(WIFI_OFF);
@@ -39,34 +55,112 @@ void wifi_disconnect() {
 
 // ── Multipart Upload ────────────────────────────────────────────────
 //
-// Builds a multipart/form-data body in memory with a single "file" part
-// containing the JPEG data.  The boundary is a fixed string (safe since
-// we control both ends and JPEG data won't contain it).
+// Builds a multipart/form-data body in memory: one text part per
+// metadata field, an optional "thumbnail" part, then a "photo" part
+// containing the full JPEG.
+// The boundary is a fixed string (safe since we control both ends and
+// JPEG data won't contain it).
 
 static const char* BOUNDARY = "----WaggleCamBoundary7d2a";
 
-int upload_photo(const char* url, const char* api_key, const char* device_id,
-                 const uint8_t* jpeg_data, size_t jpeg_len,
-                 const char* timestamp) {
+// ── Capture pause requested by the hub ──────────────────────────────
+// Any upload response may carry X-Capture-Pause: <seconds>; the latest
+// one this wake is kept for the wake stub (upload_capture_pause_s()).
 
-    if (WiFi.status() != WL_CONNECTED) {
-        log_e("upload_photo called but WiFi not connected");
-        return -1;
+static const char* PAUSE_HEADER = "X-Capture-Pause";
+static uint32_t s_capture_pause_s = 0;
+
+static void collect_pause_header(HTTPClient& http) {
+    static const char* keys[] = {PAUSE_HEADER};
+    http.collectHeaders(keys, 1);
+}
+
+static void note_capture_pause(long pause) {
+    if (pause < 0) pause = 0;
+    if (pause > CAPTURE_PAUSE_MAX_SEC) pause = CAPTURE_PAUSE_MAX_SEC;
+    s_capture_pause_s = (uint32_t)pause;
+    log_i("Hub requested a capture pause of %u s", s_capture_pause_s);
+}
+
+static void note_pause_header(HTTPClient& http) {
+    if (http.hasHeader(PAUSE_HEADER)) {
+        note_capture_pause(http.header(PAUSE_HEADER).toInt());
+    }
+}
+
+uint32_t upload_capture_pause_s() {
+    return s_capture_pause_s;
+}
+
+// ── Link use this wake ──────────────────────────────────────────────
+
+static UploadLinkStats s_link_stats = {0, 0, 0};
+static uint8_t s_chunk_retries = UPLOAD_CHUNK_RETRIES;
+
+UploadLinkStats upload_link_stats() {
+    return s_link_stats;
+}
+
+static void note_link_request(uint32_t bytes, uint32_t elapsed_ms, bool ok) {
+    s_link_stats.busy_ms += elapsed_ms;
+    if (ok) {
+        s_link_stats.bytes += bytes;
+    } else if (s_link_stats.retries < UINT16_MAX) {
+        s_link_stats.retries++;
+    }
+}
+
+static void append_field(String& out, const char* name, const String& value) {
+    out += String("--") + BOUNDARY + "\r\n";
+    out += String("Content-Disposition: form-data; name=\"") + name + "\"\r\n\r\n";
+    out += value;
+    out += "\r\n";
+}
+
+// Assemble the complete multipart body into one heap buffer (caller
+// frees).  We use PSRAM-aware malloc since JPEG can be large
+// (VGA ~30-80 KB).  extra_fields holds already-encoded parts appended
+// after the metadata; jpeg_data may be nullptr to omit the photo part.
+// Returns nullptr if allocation fails.
+static uint8_t* build_multipart_body(const PhotoUploadMeta& meta,
+                                     const String& extra_fields,
+                                     const uint8_t* jpeg_data, size_t jpeg_len,
+                                     size_t* out_len) {
+    // Metadata fields (+ thumbnail part header) (text)
+    String part_header;
+    append_field(part_header, "hive_id",            String(meta.hive_id));
+    append_field(part_header, "boot_id",            String(meta.boot_id));
+    append_field(part_header, "sequence",           String(meta.sequence));
+    append_field(part_header, "captured_at",        String(meta.captured_at));
+    append_field(part_header, "captured_at_source", String(meta.captured_at_source));
+    append_field(part_header, "trigger_reason",     String(meta.trigger_reason));
+    part_header += extra_fields;
+
+    bool has_thumb = (meta.thumbnail != nullptr && meta.thumbnail_len > 0);
+    size_t thumb_len = has_thumb ? meta.thumbnail_len : 0;
+    if (has_thumb) {
+        part_header += String("--") + BOUNDARY + "\r\n"
+            "Content-Disposition: form-data; name=\"thumbnail\"; filename=\"thumb.jpg\"\r\n"
+            "Content-Type: image/jpeg\r\n\r\n";
     }
 
-    // ── Build multipart body ────────────────────────────────────────
-    // Header part (text)
-    String part_header = String("--") + BOUNDARY + "\r\n"
-        "Content-Disposition: form-data; name=\"file\"; filename=\"capture.jpg\"\r\n"
-        "Content-Type: image/jpeg\r\n\r\n";
+    // Photo part header (text) — closes the thumbnail part if present
+    String photo_header;
+    if (jpeg_data != nullptr) {
+        photo_header = String(has_thumb ? "\r\n" : "") + "--" + BOUNDARY + "\r\n"
+            "Content-Disposition: form-data; name=\"photo\"; filename=\"capture.jpg\"\r\n"
+            "Content-Type: image/jpeg\r\n\r\n";
+    } else {
+        jpeg_len = 0;
+    }
 
-    // Footer part (text)
-    String part_footer = String("\r\n--") + BOUNDARY + "--\r\n";
+    // Footer part (text) — closes the last file part, if any
+    bool file_open = (jpeg_data != nullptr) || has_thumb;
+    String part_footer = String(file_open ? "\r\n" : "") + "--" + BOUNDARY + "--\r\n";
 
-    size_t total_len = part_header.length() + jpeg_len + part_footer.length();
+    size_t total_len = part_header.length() + thumb_len + photo_header.length()
+                     + jpeg_len + part_footer.length();
 
-    // ── Assemble into a contiguous buffer ───────────────────────────
-    // We use PSRAM-aware malloc since JPEG can be large (VGA ~30-80 KB)
     uint8_t* body = (uint8_t*)ps_malloc(total_len);
     if (body == nullptr) {
         // Fallback to regular malloc if PSRAM not available
@@ -74,38 +168,71 @@ int upload_photo(const char* url, const char* api_key, const char* device_id,
     }
     if (body == nullptr) {
         log_e("Failed to allocate %u bytes for multipart body", total_len);
-        return -1;
+        return nullptr;
     }
 
     size_t offset = 0;
     memcpy(body + offset, part_header.c_str(), part_header.length());
     offset += part_header.length();
-    memcpy(body + offset, jpeg_data, jpeg_len);
+    if (has_thumb) {
+        memcpy(body + offset, meta.thumbnail, thumb_len);
+        offset += thumb_len;
+    }
+    memcpy(body + offset, photo_header.c_str(), photo_header.length());
+    offset += photo_header.length();
+    if (jpeg_len > 0) {
+        memcpy(body + offset, jpeg_data, jpeg_len);
+    }
     offset += jpeg_len;
     memcpy(body + offset, part_footer.c_str(), part_footer.length());
 
+    *out_len = total_len;
+    return body;
+}
+
+int upload_photo(const char* url, const char* api_key, const char* device_id,
+                 const PhotoUploadMeta& meta,
+                 const uint8_t* jpeg_data, size_t jpeg_len) {
+
+    if (WiFi.status() != WL_CONNECTED) {
+        log_e("upload_photo called but WiFi not connected");
+        return -1;
+    }
+
+    size_t total_len = 0;
+    uint8_t* body = build_multipart_body(meta, String(), jpeg_data, jpeg_len, &total_len);
+    if (body == nullptr) {
+        return -1;
+    }
+
     // ── HTTP POST ───────────────────────────────────────────────────
     HTTPClient http;
     http.begin(url);
-    http.setTimeout(15000);  // 15 s server response timeout
+    http.setTimeout(UPLOAD_TIMEOUT_MS);
+    collect_pause_header(http);
 
     // Custom headers
     http.addHeader("X-API-Key", api_key);
-    http.addHeader("X-Device-ID", device_id);
-    http.addHeader("X-Timestamp", timestamp);
+    http.addHeader("X-Device-Id", device_id);
+    if (meta.wake_telemetry != nullptr) {
+        http.addHeader("X-Wake-Telemetry", meta.wake_telemetry);
+    }
 
     String content_type = String("multipart/form-data; boundary=") + BOUNDARY;
     http.addHeader("Content-Type", content_type);
 
-    log_i("Uploading %u bytes to %s", total_len, url);
+    log_i("Uploading %u bytes to %s (trigger=%s)", total_len, url, meta.trigger_reason);
     unsigned long t0 = millis();
 
     int http_code = http.POST(body, total_len);
 
     unsigned long elapsed = millis() - t0;
 
+    note_link_request(jpeg_len, elapsed, http_code >= 200 && http_code < 300);
+
     if (http_code > 0) {
         log_i("Upload complete: HTTP %d (%lu ms)", http_code, elapsed);
+        note_pause_header(http);
         // Read and discard response body to free resources
         http.getString();
     } else {
@@ -118,3 +245,348 @@ int upload_photo(const char* url, const char* api_key, const char* device_id,
 
     return http_code;
 }
+
+// ── Resumable Upload ────────────────────────────────────────────────
+//
+// Announce the photo (metadata, size, CRC-32 and the thumbnail) with a
+// multipart POST, then PUT the JPEG in CRC-checked chunks from the
+// offset the hub reports.  One HTTPClient with connection reuse carries
+// every request.  The chunk size carries over between wakes in RTC
+// memory, so a weak link starts small next time too; a link plan
+// replaces it with a size drawn from several wakes.
+
+RTC_DATA_ATTR static ChunkSizer s_chunk_sizer = {0, 0};
+
+void upload_set_link_plan(const LinkPlan& plan) {
+    s_chunk_sizer.size = plan.chunk_bytes;
+    s_chunk_retries = plan.chunk_retries;
+}
+
+static bool is_2xx(int code) {
+    return code >= 200 && code < 300;
+}
+
+static void add_device_headers(HTTPClient& http, const char* api_key, const char* device_id) {
+    http.addHeader("X-API-Key", api_key);
+    http.addHeader("X-Device-Id", device_id);
+}
+
+int upload_photo_resumable(const char* uploads_url, const char* api_key, const char* device_id,
+                           const PhotoUploadMeta& meta,
+                           const uint8_t* jpeg_data, size_t jpeg_len) {
+
+    if (WiFi.status() != WL_CONNECTED) {
+        log_e("upload_photo_resumable called but WiFi not connected");
+        return -1;
+    }
+    if (s_chunk_sizer.size == 0) {
+        chunk_sizer_init(&s_chunk_sizer);
+    }
+
+    uint32_t crc = upload_crc32(0, jpeg_data, jpeg_len);
+
+    // ── Announce (creates the upload, or finds the one to resume) ───
+    String fields;
+    append_field(fields, "total_size", String((uint32_t)jpeg_len));
+    append_field(fields, "crc32",      String(crc));
+
+    size_t body_len = 0;
+    uint8_t* body = build_multipart_body(meta, fields, nullptr, 0, &body_len);
+    if (body == nullptr) {
+        return -1;
+    }
+
+    HTTPClient http;
+    http.setReuse(true);
+    http.setTimeout(UPLOAD_TIMEOUT_MS);
+    collect_pause_header(http);
+    http.begin(uploads_url);
+    add_device_headers(http, api_key, device_id);
+    http.addHeader("Content-Type", String("multipart/form-data; boundary=") + BOUNDARY);
+
+    int code = http.POST(body, body_len);
+    free(body);
+    String reply = (code > 0) ? http.getString() : String();
+    note_pause_header(http);
+
+    if (!is_2xx(code)) {
+        // 404/405: hub predates resumable uploads — caller falls back
+        log_w("Resumable announce failed: HTTP %d", code);
+        http.end();
+        return code;
+    }
+
+    bool complete = false;
+    if (json_find_bool(reply.c_str(), "complete", &complete) && complete) {
+        log_i("Hub already has photo seq %u", meta.sequence);
+        http.end();
+        return code;
+    }
+
+    char upload_id[40];
+    uint32_t offset = 0;
+    uint32_t server_chunk = UPLOAD_CHUNK_MAX;
+    if (!json_find_string(reply.c_str(), "upload_id", upload_id, sizeof(upload_id))
+            || !json_find_uint(reply.c_str(), "offset", &offset)
+            || offset > jpeg_len) {
+        log_e("Resumable announce: unexpected reply");
+        http.end();
+        return -1;
+    }
+    json_find_uint(reply.c_str(), "chunk_size", &server_chunk);
+
+    if (offset > 0) {
+        log_i("Resuming upload %s at %u/%u bytes", upload_id, offset, jpeg_len);
+    }
+
+    // ── Send chunks ─────────────────────────────────────────────────
+    String chunk_url = String(uploads_url) + "/" + upload_id;
+    int failures = 0;
+
+    while (true) {
+        size_t n = jpeg_len - offset;
+        if (n > s_chunk_sizer.size) n = s_chunk_sizer.size;
+        if (n > server_chunk) n = server_chunk;
+
+        char crc_hex[9];
+        snprintf(crc_hex, sizeof(crc_hex), "%08x", upload_crc32(0, jpeg_data + offset, n));
+
+        http.begin(chunk_url);
+        add_device_headers(http, api_key, device_id);
+        http.addHeader("Content-Type", "application/octet-stream");
+        http.addHeader("X-Upload-Offset", String(offset));
+        http.addHeader("X-Chunk-CRC32", crc_hex);
+        bool last = (offset + n == jpeg_len);
+        if (last && meta.wake_telemetry != nullptr) {
+            // The completing request stores the photo, so it carries telemetry
+            http.addHeader("X-Wake-Telemetry", meta.wake_telemetry);
+        }
+
+        unsigned long t0 = millis();
+        code = http.PUT((uint8_t*)(jpeg_data + offset), n);
+        uint32_t elapsed = (uint32_t)(millis() - t0);
+        reply = (code > 0) ? http.getString() : String();
+        note_pause_header(http);
+
+        uint32_t acked = offset;
+        bool has_offset = json_find_uint(reply.c_str(), "offset", &acked) && acked <= jpeg_len;
+
+        if (is_2xx(code) && has_offset) {
+            chunk_sizer_update(&s_chunk_sizer, n, elapsed, true);
+            note_link_request(acked > offset ? acked - offset : 0, elapsed, true);
+            failures = 0;
+            offset = acked;
+            if (json_find_bool(reply.c_str(), "complete", &complete) && complete) {
+                log_i("Resumable upload complete: HTTP %d, next chunk %u bytes (%u B/s)",
+                      code, s_chunk_sizer.size, s_chunk_sizer.rate_bps);
+                http.end();
+                return code;
+            }
+            continue;
+        }
+
+        if (code == 409 && has_offset && acked != offset) {
+            // Hub acknowledged more (or less) than we thought — resync
+            log_w("Resync upload offset %u -> %u", offset, acked);
+            offset = acked;
+            continue;
+        }
+
+        if (code > 0 && code != 422 && code != 429 && code < 500) {
+            // Upload gone (expired) or rejected — nothing to resume
+            log_e("Chunk rejected: HTTP %d", code);
+            http.end();
+            return code;
+        }
+
+        // Transport error, CRC mismatch or hub trouble: smaller chunk, retry
+        chunk_sizer_update(&s_chunk_sizer, n, elapsed, false);
+        note_link_request(0, elapsed, false);
+        failures++;
+        log_w("Chunk at %u failed (HTTP %d, %u ms) — retry %d/%d with %u bytes",
+              offset, code, elapsed, failures, s_chunk_retries, s_chunk_sizer.size);
+        http.end();   // Drop a possibly wedged connection
+        if (failures >= s_chunk_retries) {
+            log_e("Giving up at %u/%u bytes; will resume next wake", offset, jpeg_len);
+            return (code > 0) ? code : -1;
+        }
+    }
+}
+
+// ── Upload Sessions ─────────────────────────────────────────────────
+//
+// Requests are written with WiFiClient directly (HTTPClient waits for
+// each response before the next request).  Responses are parsed with
+// http_pipeline; bytes read past the end of one response stay in s.rx
+// for the next.
+
+// Mark every unanswered request as lost and stop using the connection.
+static void session_break(UploadSession& s) {
+    while (s.acked < s.sent) {
+        s.results[s.acked++] = -1;
+    }
+    s.broken = true;
+    s.client.stop();
+}
+
+// Read the response to the oldest in-flight request.  Returns false if
+// the connection dropped, timed out or sent garbage.
+static bool session_read_response(UploadSession& s, uint32_t timeout_ms) {
+    http_parser_reset(&s.parser);
+    unsigned long start = millis();
+
+    while (s.parser.state != HTTP_DONE) {
+        if (s.rx_off == s.rx_len) {
+            int avail = s.client.available();
+            if (avail <= 0) {
+                if (!s.client.connected() || millis() - start >= timeout_ms) {
+                    return false;
+                }
+                delay(1);
+                continue;
+            }
+            int n = s.client.read(s.rx, sizeof(s.rx));
+            if (n <= 0) {
+                return false;
+            }
+            s.rx_len = (size_t)n;
+            s.rx_off = 0;
+        }
+        s.rx_off += http_parser_feed(&s.parser, s.rx + s.rx_off, s.rx_len - s.rx_off);
+        if (s.parser.state == HTTP_ERROR) {
+            log_e("Session: malformed response");
+            return false;
+        }
+    }
+
+    s.results[s.acked++] = s.parser.status;
+    if (s.parser.capture_pause_s != 0) {
+        note_capture_pause((long)s.parser.capture_pause_s);
+    }
+    if (s.parser.conn_close) {
+        // Server will not answer anything queued behind this response
+        log_w("Session: server closed connection after request %u", s.acked);
+        session_break(s);
+    }
+    return true;
+}
+
+bool upload_session_begin(UploadSession& s, const char* url,
+                          const char* api_key, const char* device_id,
+                          uint8_t depth) {
+    s.sent = 0;
+    s.acked = 0;
+    s.broken = true;
+    s.rx_len = 0;
+    s.rx_off = 0;
+    s.api_key = api_key;
+    s.device_id = device_id;
+    s.depth = depth < 1 ? 1
+            : (depth > UPLOAD_SESSION_MAX_REQUESTS ? UPLOAD_SESSION_MAX_REQUESTS : depth);
+
+    if (WiFi.status() != WL_CONNECTED) {
+        log_e("upload_session_begin called but WiFi not connected");
+        return false;
+    }
+    if (!http_parse_url(url, s.host, sizeof(s.host), &s.port, s.path, sizeof(s.path))) {
+        log_w("Session: unsupported URL %s (falling back to per-photo uploads)", url);
+        return false;
+    }
+
+    s.started_ms = millis();
+    if (!s.client.connect(s.host, s.port)) {
+        log_e("Session: connect to %s:%u failed", s.host, s.port);
+        note_link_request(0, millis() - s.started_ms, false);
+        return false;
+    }
+    s.client.setNoDelay(true);
+    s.broken = false;
+    log_i("Session: connected to %s:%u in %lu ms (depth %u)",
+          s.host, s.port, millis() - s.started_ms, s.depth);
+    return true;
+}
+
+int upload_session_send(UploadSession& s, const PhotoUploadMeta& meta,
+                        const uint8_t* jpeg_data, size_t jpeg_len) {
+    if (s.broken || s.sent >= UPLOAD_SESSION_MAX_REQUESTS) {
+        return -1;
+    }
+
+    // Bound the pipeline: drain the oldest response before writing more
+    while ((uint8_t)(s.sent - s.acked) >= s.depth) {
+        if (!session_read_response(s, UPLOAD_TIMEOUT_MS)) {
+            session_break(s);
+        }
+        if (s.broken) {
+            return -1;
+        }
+    }
+
+    size_t body_len = 0;
+    uint8_t* body = build_multipart_body(meta, String(), jpeg_data, jpeg_len, &body_len);
+    if (body == nullptr) {
+        return -1;
+    }
+
+    String extra = String("X-API-Key: ") + s.api_key + "\r\n"
+                 + "X-Device-Id: " + s.device_id + "\r\n";
+    if (meta.wake_telemetry != nullptr) {
+        extra += String("X-Wake-Telemetry: ") + meta.wake_telemetry + "\r\n";
+    }
+    String content_type = String("multipart/form-data; boundary=") + BOUNDARY;
+
+    char head[640];
+    size_t head_len = http_format_post_head(head, sizeof(head), s.host, s.port, s.path,
+                                            content_type.c_str(), extra.c_str(), body_len);
+    if (head_len == 0) {
+        log_e("Session: request head too large");
+        free(body);
+        return -1;
+    }
+
+    bool ok = s.client.write((const uint8_t*)head, head_len) == head_len
+           && s.client.write(body, body_len) == body_len;
+    free(body);
+    if (!ok) {
+        log_e("Session: write failed on request %u", s.sent);
+        session_break(s);
+        return -1;
+    }
+
+    log_i("Session: queued request %u (%u bytes, %u in flight)",
+          s.sent, body_len, (uint8_t)(s.sent + 1 - s.acked));
+    s.jpeg_lens[s.sent] = (uint32_t)jpeg_len;
+    return s.sent++;
+}
+
+void upload_session_flush(UploadSession& s, uint32_t timeout_ms) {
+    unsigned long start = millis();
+    while (!s.broken && s.acked < s.sent) {
+        unsigned long spent = millis() - start;
+        if (spent >= timeout_ms || !session_read_response(s, timeout_ms - spent)) {
+            session_break(s);
+        }
+    }
+}
+
+int upload_session_end(UploadSession& s) {
+    upload_session_flush(s, UPLOAD_TIMEOUT_MS);
+    s.client.stop();
+    s.broken = true;
+
+    // The session counts as one busy period for the link stats; every
+    // request without a 2xx is a retry.
+    int ok = 0;
+    uint32_t bytes = 0;
+    for (uint8_t i = 0; i < s.sent; i++) {
+        if (is_2xx(s.results[i])) {
+            ok++;
+            bytes += s.jpeg_lens[i];
+        } else {
+            note_link_request(0, 0, false);
+        }
+    }
+    note_link_request(bytes, millis() - s.started_ms, true);
+    log_i("Session: %d/%u uploads accepted", ok, s.sent);
+    return ok;
+}
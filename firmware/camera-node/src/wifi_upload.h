@@ -1,30 +1,151 @@
 // Waggle Camera Node — WiFi connection and HTTP photo upload.
 // Connects to WiFi, POSTs a multipart/form-data JPEG to the hub,
-// and disconnects to save power.
+// and disconnects to save power.  Bursts of photos can share one
+// keep-alive connection through an upload session.
 
 #pragma once
 
 #include <stdint.h>
 #include <stddef.h>
+#include <WiFiClient.h>
+
+#include "http_pipeline.h"
+#include "link_adapt.h"
 
 // Connect to WiFi with the given credentials.
-// Blocks up to timeout_ms waiting for connection.
+// Blocks up to timeout_ms waiting for connection.  With a plan, its TX
+// power, protocol set and bandwidth are applied before associating.
 // Returns true on successful connection, false on timeout.
-bool wifi_connect(const char* ssid, const char* pass, uint32_t timeout_ms);
+bool wifi_connect(const char* ssid, const char* pass, uint32_t timeout_ms,
+                  const LinkPlan* plan = nullptr);
+
+// RSSI of the current association in dBm (LINK_RSSI_NONE if not connected).
+int8_t wifi_rssi();
 
 // Disconnect from WiFi and turn off the radio to save power.
 void wifi_disconnect();
 
+// ── Per-photo metadata sent as multipart form fields ────────────────
+struct PhotoUploadMeta {
+    const char* hive_id;             // Hive the camera is bound to
+    uint32_t    boot_id;             // Random per power-on (dedup key with sequence)
+    uint32_t    sequence;            // Capture number within this boot_id
+    const char* captured_at;         // ISO 8601 with ms, e.g. "2026-02-08T14:30:00.123Z"
+    const char* captured_at_source;  // "device_ntp" or "device_rtc"
+    const char* trigger_reason;      // "scheduled", "activity" or "boot"
+    const char* wake_telemetry;      // X-Wake-Telemetry header value (nullptr = omit)
+    const uint8_t* thumbnail;        // Optional thumbnail JPEG (nullptr = omit)
+    size_t      thumbnail_len;
+};
+
 // Upload a JPEG photo to the hub via HTTP POST multipart/form-data.
 //
-// url:        Full endpoint URL, e.g. "http://192.168.1.50:8000/api/hives/3/photos"
-// api_key:    API key sent in X-API-Key header
-// device_id:  Device UUID sent in X-Device-ID header
+// url:        Full endpoint URL, e.g. "http://192.168.1.50:8000/api/photos/upload"
+// api_key:    Device API key sent in X-API-Key header
+// device_id:  Device UUID sent in X-Device-Id header
+// meta:       Form fields describing the capture (see PhotoUploadMeta);
+//             a thumbnail, if present, is sent as a "thumbnail" part
+//             ahead of the full frame in the same request
 // jpeg_data:  Pointer to JPEG image bytes
 // jpeg_len:   Length of JPEG data in bytes
-// timestamp:  ISO 8601 timestamp string sent in X-Timestamp header
 //
-// Returns HTTP status code (200/201 on success), or -1 on connection/transport error.
+// Returns HTTP status code (200 on success), or -1 on connection/transport error.
 int upload_photo(const char* url, const char* api_key, const char* device_id,
-                 const uint8_t* jpeg_data, size_t jpeg_len,
-                 const char* timestamp);
+                 const PhotoUploadMeta& meta,
+                 const uint8_t* jpeg_data, size_t jpeg_len);
+
+// ── Link use this wake (link_adapt.h) ───────────────────────────────
+struct UploadLinkStats {
+    uint32_t bytes;      // Photo bytes the hub acknowledged
+    uint32_t busy_ms;    // Time in the requests that carried photo bytes
+    uint16_t retries;    // Failed requests
+};
+
+// Chunk size and per-wake chunk retries for the resumable uploads that
+// follow (defaults: UPLOAD_CHUNK_INITIAL, UPLOAD_CHUNK_RETRIES).
+void upload_set_link_plan(const LinkPlan& plan);
+
+UploadLinkStats upload_link_stats();
+
+// Capture pause the hub asked for in an upload response this wake
+// (X-Capture-Pause: <seconds>, clamped to CAPTURE_PAUSE_MAX_SEC);
+// 0 if none.  The wake stub skips captures until it has passed.
+uint32_t upload_capture_pause_s();
+
+// ── Resumable upload (weak links) ───────────────────────────────────
+//
+// Upload a photo in CRC-checked chunks via {hub}/api/photos/uploads.
+// The hub keeps what it has acknowledged, so calling this again for the
+// same (boot_id, sequence) — later this wake or after deep sleep —
+// continues from that offset instead of resending the whole image.
+// Chunk size follows observed throughput (see upload_resume.h), starting
+// from the link plan's first chunk.
+//
+// uploads_url: e.g. "http://192.168.1.50:8000/api/photos/uploads"
+//
+// Returns a 2xx status once the hub has stored the photo (or already had
+// it).  404/405 mean the hub has no resumable endpoint — fall back to
+// upload_photo().  -1, 408, 422, 429 and 5xx are worth retrying later;
+// other 4xx mean the upload was rejected.
+int upload_photo_resumable(const char* uploads_url, const char* api_key, const char* device_id,
+                           const PhotoUploadMeta& meta,
+                           const uint8_t* jpeg_data, size_t jpeg_len);
+
+// ── Upload sessions (keep-alive + pipelining) ───────────────────────
+//
+// For burst or backlog uploads: one TCP connection carries many photo
+// POSTs, written back-to-back without waiting for each response.  Up to
+// `depth` requests are in flight; responses are matched to requests in
+// order.  The hub dedups on (boot_id, sequence), so any request whose
+// result is -1 (connection dropped before its response arrived) can be
+// retried safely with upload_photo() or a new session.  The session's
+// requests count towards upload_link_stats() and upload_capture_pause_s()
+// like single uploads do.
+//
+// Plain http:// only — upload_session_begin() returns false for https
+// URLs and callers fall back to upload_photo().
+
+#define UPLOAD_SESSION_MAX_REQUESTS 16
+#define UPLOAD_SESSION_RX_BUF       256
+
+struct UploadSession {
+    WiFiClient client;
+    char       host[64];
+    uint16_t   port;
+    char       path[96];
+    const char* api_key;
+    const char* device_id;
+    uint8_t    depth;                   // Max requests in flight
+    uint8_t    sent;                    // Requests written
+    uint8_t    acked;                   // Responses read
+    bool       broken;                  // Connection unusable; no more sends
+    int        results[UPLOAD_SESSION_MAX_REQUESTS];  // HTTP status per request, -1 = lost
+    uint32_t   jpeg_lens[UPLOAD_SESSION_MAX_REQUESTS]; // Photo bytes per request (link stats)
+    unsigned long started_ms;           // Connect start (link stats busy time)
+    HttpResponseParser parser;
+    uint8_t    rx[UPLOAD_SESSION_RX_BUF];  // Bytes read past the current response
+    size_t     rx_len;
+    size_t     rx_off;
+};
+
+// Open a keep-alive connection to the hub.  depth is clamped to
+// 1..UPLOAD_SESSION_MAX_REQUESTS (1 = keep-alive without pipelining).
+// Returns false if the URL is not plain http or the connect fails.
+bool upload_session_begin(UploadSession& s, const char* url,
+                          const char* api_key, const char* device_id,
+                          uint8_t depth);
+
+// Queue one photo on the session.  Blocks only while `depth` requests
+// are already in flight, reading the oldest response first.
+// Returns the request index into s.results, or -1 if the session is
+// full or broken (the photo was not sent).
+int upload_session_send(UploadSession& s, const PhotoUploadMeta& meta,
+                        const uint8_t* jpeg_data, size_t jpeg_len);
+
+// Wait for every outstanding response, up to timeout_ms in total.
+// Requests still unanswered afterwards are marked -1.
+void upload_session_flush(UploadSession& s, uint32_t timeout_ms);
+
+// Flush and close the connection.  Returns the number of requests that
+// got a 2xx response.
+int upload_session_end(UploadSession& s);
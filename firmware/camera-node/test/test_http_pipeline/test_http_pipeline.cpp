@@ -0,0 +1,299 @@
+// Waggle Camera Node — Native unit tests for HTTP/1.1 keep-alive framing.
+//
+// Runs on the host (no ESP32 required) via:
+//   pio test -e native
+//
+// Tests:
+//   1. URL parsing (default port, explicit port, bare host, https rejected)
+//   2. POST head formatting (Host with/without port, extra headers, overflow)
+//   3. Content-Length response parsed to completion
+//   4. Two pipelined responses in one buffer are split correctly
+//   5. Responses fed one byte at a time
+//   6. Chunked bodies, 204, Connection: close, close-delimited bodies
+//   7. Interim 100 Continue is skipped
+//   8. Malformed status line and overlong lines are errors
+//   9. X-Capture-Pause is read per response
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/http_pipeline.h"
+
+// ── Helpers ───────────────────────────────────────────────────────────
+
+static const uint8_t* bytes(const char* s) {
+    return (const uint8_t*)s;
+}
+
+// Feed a whole stream, collecting status codes of completed responses.
+// Returns the number of responses; -1 if the parser hit an error.
+static int parse_all(const char* stream, size_t len, int* statuses, int max,
+                     bool* last_close) {
+    HttpResponseParser p;
+    http_parser_reset(&p);
+    int count = 0;
+    size_t off = 0;
+    while (off < len) {
+        off += http_parser_feed(&p, bytes(stream) + off, len - off);
+        if (p.state == HTTP_ERROR) {
+            return -1;
+        }
+        if (p.state == HTTP_DONE) {
+            if (count < max) {
+                statuses[count] = p.status;
+            }
+            count++;
+            if (last_close != NULL) {
+                *last_close = p.conn_close;
+            }
+            http_parser_reset(&p);
+        }
+    }
+    return count;
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// URL parsing
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_parse_url_with_port(void) {
+    char host[64], path[64];
+    uint16_t port = 0;
+    TEST_ASSERT_TRUE(http_parse_url("http://192.168.1.50:8000/api/photos/upload",
+                                    host, sizeof(host), &port, path, sizeof(path)));
+    TEST_ASSERT_EQUAL_STRING("192.168.1.50", host);
+    TEST_ASSERT_EQUAL_UINT16(8000, port);
+    TEST_ASSERT_EQUAL_STRING("/api/photos/upload", path);
+}
+
+void test_parse_url_defaults(void) {
+    char host[64], path[64];
+    uint16_t port = 0;
+    TEST_ASSERT_TRUE(http_parse_url("http://waggle.local", host, sizeof(host),
+                                    &port, path, sizeof(path)));
+    TEST_ASSERT_EQUAL_STRING("waggle.local", host);
+    TEST_ASSERT_EQUAL_UINT16(80, port);
+    TEST_ASSERT_EQUAL_STRING("/", path);
+}
+
+void test_parse_url_rejects(void) {
+    char host[8], path[64];
+    uint16_t port = 0;
+    TEST_ASSERT_FALSE(http_parse_url("https://hub/x", host, sizeof(host), &port, path, sizeof(path)));
+    TEST_ASSERT_FALSE(http_parse_url("http://:80/x", host, sizeof(host), &port, path, sizeof(path)));
+    TEST_ASSERT_FALSE(http_parse_url("http://hub:0/x", host, sizeof(host), &port, path, sizeof(path)));
+    TEST_ASSERT_FALSE(http_parse_url("http://hub:99999/x", host, sizeof(host), &port, path, sizeof(path)));
+    // Host longer than the buffer
+    TEST_ASSERT_FALSE(http_parse_url("http://averylonghostname/x", host, sizeof(host), &port, path, sizeof(path)));
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Request framing
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_format_post_head(void) {
+    char head[256];
+    size_t n = http_format_post_head(head, sizeof(head), "hub", 8000, "/api/photos/upload",
+                                     "image/jpeg", "X-API-Key: k\r\n", 1234);
+    TEST_ASSERT_EQUAL(strlen(head), n);
+    TEST_ASSERT_NOT_NULL(strstr(head, "POST /api/photos/upload HTTP/1.1\r\n"));
+    TEST_ASSERT_NOT_NULL(strstr(head, "Host: hub:8000\r\n"));
+    TEST_ASSERT_NOT_NULL(strstr(head, "Connection: keep-alive\r\n"));
+    TEST_ASSERT_NOT_NULL(strstr(head, "Content-Length: 1234\r\n"));
+    TEST_ASSERT_NOT_NULL(strstr(head, "X-API-Key: k\r\n"));
+    // Ends with the blank line
+    TEST_ASSERT_EQUAL_STRING("\r\n\r\n", head + n - 4);
+}
+
+void test_format_post_head_default_port(void) {
+    char head[256];
+    http_format_post_head(head, sizeof(head), "hub", 80, "/", "text/plain", NULL, 0);
+    TEST_ASSERT_NOT_NULL(strstr(head, "Host: hub\r\n"));
+}
+
+void test_format_post_head_overflow(void) {
+    char head[32];
+    TEST_ASSERT_EQUAL(0, http_format_post_head(head, sizeof(head), "hub", 80, "/upload",
+                                               "image/jpeg", NULL, 10));
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Response parsing
+// ═══════════════════════════════════════════════════════════════════════
+
+static const char RESP_OK[] =
+    "HTTP/1.1 200 OK\r\n"
+    "content-type: application/json\r\n"
+    "content-length: 34\r\n"
+    "\r\n"
+    "{\"photo_id\":1,\"status\":\"queued\"}\r\n";
+
+static const char RESP_429[] =
+    "HTTP/1.1 429 Too Many Requests\r\n"
+    "Content-Length: 2\r\n"
+    "Retry-After: 60\r\n"
+    "\r\n"
+    "{}";
+
+void test_content_length_response(void) {
+    int st[4];
+    bool close = true;
+    TEST_ASSERT_EQUAL(1, parse_all(RESP_OK, strlen(RESP_OK), st, 4, &close));
+    TEST_ASSERT_EQUAL(200, st[0]);
+    TEST_ASSERT_FALSE(close);
+}
+
+void test_pipelined_responses_split_in_order(void) {
+    char stream[512];
+    snprintf(stream, sizeof(stream), "%s%s%s", RESP_OK, RESP_429, RESP_OK);
+    int st[4];
+    TEST_ASSERT_EQUAL(3, parse_all(stream, strlen(stream), st, 4, NULL));
+    TEST_ASSERT_EQUAL(200, st[0]);
+    TEST_ASSERT_EQUAL(429, st[1]);
+    TEST_ASSERT_EQUAL(200, st[2]);
+}
+
+void test_byte_at_a_time(void) {
+    char stream[512];
+    snprintf(stream, sizeof(stream), "%s%s", RESP_429, RESP_OK);
+    size_t len = strlen(stream);
+
+    HttpResponseParser p;
+    http_parser_reset(&p);
+    int done = 0;
+    int statuses[2] = {0, 0};
+    for (size_t i = 0; i < len; i++) {
+        TEST_ASSERT_EQUAL(1, http_parser_feed(&p, bytes(stream) + i, 1));
+        TEST_ASSERT_NOT_EQUAL(HTTP_ERROR, p.state);
+        if (p.state == HTTP_DONE) {
+            statuses[done++] = p.status;
+            http_parser_reset(&p);
+        }
+    }
+    TEST_ASSERT_EQUAL(2, done);
+    TEST_ASSERT_EQUAL(429, statuses[0]);
+    TEST_ASSERT_EQUAL(200, statuses[1]);
+}
+
+void test_chunked_response(void) {
+    const char* stream =
+        "HTTP/1.1 201 Created\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5;ext=1\r\nhello\r\n"
+        "A\r\n0123456789\r\n"
+        "0\r\n"
+        "X-Trailer: y\r\n"
+        "\r\n";
+    char both[512];
+    snprintf(both, sizeof(both), "%s%s", stream, RESP_OK);
+    int st[4];
+    TEST_ASSERT_EQUAL(2, parse_all(both, strlen(both), st, 4, NULL));
+    TEST_ASSERT_EQUAL(201, st[0]);
+    TEST_ASSERT_EQUAL(200, st[1]);
+}
+
+void test_no_content_and_close(void) {
+    const char* stream =
+        "HTTP/1.1 204 No Content\r\n\r\n"
+        "HTTP/1.1 503 Service Unavailable\r\n"
+        "Connection: close\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+    int st[4];
+    bool close = false;
+    TEST_ASSERT_EQUAL(2, parse_all(stream, strlen(stream), st, 4, &close));
+    TEST_ASSERT_EQUAL(204, st[0]);
+    TEST_ASSERT_EQUAL(503, st[1]);
+    TEST_ASSERT_TRUE(close);
+}
+
+void test_close_delimited_body_forces_close(void) {
+    const char* stream = "HTTP/1.0 200 OK\r\n\r\n";
+    int st[1];
+    bool close = false;
+    TEST_ASSERT_EQUAL(1, parse_all(stream, strlen(stream), st, 1, &close));
+    TEST_ASSERT_TRUE(close);
+}
+
+void test_interim_continue_skipped(void) {
+    char stream[512];
+    snprintf(stream, sizeof(stream), "HTTP/1.1 100 Continue\r\n\r\n%s", RESP_OK);
+    int st[2];
+    TEST_ASSERT_EQUAL(1, parse_all(stream, strlen(stream), st, 2, NULL));
+    TEST_ASSERT_EQUAL(200, st[0]);
+}
+
+void test_malformed_status_is_error(void) {
+    const char* stream = "HTTQ/1.1 200 OK\r\n\r\n";
+    int st[1];
+    TEST_ASSERT_EQUAL(-1, parse_all(stream, strlen(stream), st, 1, NULL));
+}
+
+void test_overlong_header_is_error(void) {
+    char stream[HTTP_MAX_LINE + 64];
+    strcpy(stream, "HTTP/1.1 200 OK\r\nX-Long: ");
+    size_t n = strlen(stream);
+    memset(stream + n, 'a', HTTP_MAX_LINE);
+    stream[n + HTTP_MAX_LINE] = '\0';
+    int st[1];
+    TEST_ASSERT_EQUAL(-1, parse_all(stream, strlen(stream), st, 1, NULL));
+}
+
+void test_capture_pause_header(void) {
+    const char* stream =
+        "HTTP/1.1 429 Too Many Requests\r\n"
+        "x-capture-pause: 900\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n"
+        "HTTP/1.1 507 Insufficient Storage\r\n"
+        "X-Capture-Pause: -5\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+    HttpResponseParser p;
+    http_parser_reset(&p);
+    size_t len = strlen(stream);
+    size_t off = http_parser_feed(&p, bytes(stream), len);
+    TEST_ASSERT_EQUAL(HTTP_DONE, p.state);
+    TEST_ASSERT_EQUAL_UINT32(900, p.capture_pause_s);
+
+    // Not carried over to the next response; negative values are ignored
+    http_parser_reset(&p);
+    http_parser_feed(&p, bytes(stream) + off, len - off);
+    TEST_ASSERT_EQUAL(HTTP_DONE, p.state);
+    TEST_ASSERT_EQUAL(507, p.status);
+    TEST_ASSERT_EQUAL_UINT32(0, p.capture_pause_s);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Test runner
+// ═══════════════════════════════════════════════════════════════════════
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    // URL parsing
+    RUN_TEST(test_parse_url_with_port);
+    RUN_TEST(test_parse_url_defaults);
+    RUN_TEST(test_parse_url_rejects);
+
+    // Request framing
+    RUN_TEST(test_format_post_head);
+    RUN_TEST(test_format_post_head_default_port);
+    RUN_TEST(test_format_post_head_overflow);
+
+    // Response parsing
+    RUN_TEST(test_content_length_response);
+    RUN_TEST(test_pipelined_responses_split_in_order);
+    RUN_TEST(test_byte_at_a_time);
+    RUN_TEST(test_chunked_response);
+    RUN_TEST(test_no_content_and_close);
+    RUN_TEST(test_close_delimited_body_forces_close);
+    RUN_TEST(test_interim_continue_skipped);
+    RUN_TEST(test_malformed_status_is_error);
+    RUN_TEST(test_overlong_header_is_error);
+    RUN_TEST(test_capture_pause_header);
+
+    return UNITY_END();
+}
@@ -0,0 +1,260 @@
+// Waggle Camera Node — Native unit tests for WiFi link adaptation.
+//
+// Runs on the host (no ESP32 required) via:
+//   pio test -e native
+//
+// Tests:
+//   1. No history: driver defaults (full power, b/g/n, HT20, initial chunk)
+//   2. History ring keeps the newest LINK_HISTORY_LEN wakes; bad magic resets
+//   3. Throughput from bytes and busy time
+//   4. Strong link: lowest TX power, HT40, fewer retries, chunk from throughput
+//   5. GOOD link TX power follows the RSSI headroom over the target
+//   6. FAIR link: full power, HT20, default retries
+//   7. A wake with retries or an unfinished upload drops one tier
+//   8. Median RSSI shrugs off one outlier; only the last LINK_WINDOW count
+//   9. Failed connects: full power, small chunks, more retries
+//  10. BAD link: 802.11b only, minimum chunk
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/link_adapt.h"
+#include "../src/upload_resume.h"
+
+// ── Helpers ───────────────────────────────────────────────────────────
+
+static LinkSample sample(int8_t rssi, uint32_t rate_bps, uint8_t retries = 0,
+                         bool completed = true) {
+    LinkSample s;
+    memset(&s, 0, sizeof(s));
+    s.rssi_dbm = rssi;
+    s.tx_power_qdbm = LINK_TX_POWER_MAX_QDBM;
+    s.retries = retries;
+    s.completed = completed;
+    s.busy_ms = rate_bps ? 2000 : 0;
+    s.bytes = rate_bps * 2;
+    return s;
+}
+
+static void record(LinkHistory* h, int8_t rssi, uint32_t rate_bps, int times = 1) {
+    LinkSample s = sample(rssi, rate_bps);
+    for (int i = 0; i < times; i++) {
+        link_history_record(h, &s);
+    }
+}
+
+static LinkHistory fresh(void) {
+    LinkHistory h;
+    link_history_init(&h);
+    return h;
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// History
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_no_history_defaults(void) {
+    LinkHistory h = fresh();
+    LinkPlan p = link_plan_choose(&h);
+    TEST_ASSERT_EQUAL_UINT8(LINK_UNKNOWN, p.tier);
+    TEST_ASSERT_EQUAL_UINT8(LINK_TX_POWER_MAX_QDBM, p.tx_power_qdbm);
+    TEST_ASSERT_EQUAL_HEX8(LINK_PROTO_BGN, p.protocols);
+    TEST_ASSERT_FALSE(p.ht40);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_CHUNK_INITIAL, p.chunk_bytes);
+    TEST_ASSERT_EQUAL_UINT8(LINK_RETRIES_FAIR, p.chunk_retries);
+
+    // RTC memory after power-on is all zeros
+    LinkHistory zero;
+    memset(&zero, 0, sizeof(zero));
+    TEST_ASSERT_EQUAL_UINT8(LINK_UNKNOWN, link_plan_choose(&zero).tier);
+}
+
+void test_history_ring(void) {
+    LinkHistory h = fresh();
+    for (int i = 0; i < LINK_HISTORY_LEN + 3; i++) {
+        LinkSample s = sample((int8_t)(-40 - i), 1000);
+        link_history_record(&h, &s);
+    }
+    TEST_ASSERT_EQUAL_UINT8(LINK_HISTORY_LEN, h.count);
+    TEST_ASSERT_EQUAL_INT8(-40 - (LINK_HISTORY_LEN + 2), link_history_recent(&h, 0)->rssi_dbm);
+    TEST_ASSERT_EQUAL_INT8(-40 - 3, link_history_recent(&h, LINK_HISTORY_LEN - 1)->rssi_dbm);
+    TEST_ASSERT_NULL(link_history_recent(&h, LINK_HISTORY_LEN));
+
+    // Garbage (e.g. a layout change across a firmware update) starts over
+    memset(&h, 0xA5, sizeof(h));
+    TEST_ASSERT_NULL(link_history_recent(&h, 0));
+    LinkSample s = sample(-50, 1000);
+    link_history_record(&h, &s);
+    TEST_ASSERT_EQUAL_UINT32(LINK_HISTORY_MAGIC, h.magic);
+    TEST_ASSERT_EQUAL_UINT8(1, h.count);
+    TEST_ASSERT_EQUAL_INT8(-50, link_history_recent(&h, 0)->rssi_dbm);
+}
+
+void test_sample_rate(void) {
+    LinkSample s = sample(-50, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, link_sample_rate_bps(&s));
+    s.bytes = 60000;
+    s.busy_ms = 1500;
+    TEST_ASSERT_EQUAL_UINT32(40000, link_sample_rate_bps(&s));
+    s.busy_ms = 0;  // Faster than the millisecond clock
+    TEST_ASSERT_EQUAL_UINT32(60000000, link_sample_rate_bps(&s));
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Plans
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_strong_link(void) {
+    LinkHistory h = fresh();
+    record(&h, -48, 20000, 4);
+    LinkPlan p = link_plan_choose(&h);
+    TEST_ASSERT_EQUAL_UINT8(LINK_GOOD, p.tier);
+    TEST_ASSERT_EQUAL_UINT8(LINK_TX_POWER_MIN_QDBM, p.tx_power_qdbm);
+    TEST_ASSERT_EQUAL_HEX8(LINK_PROTO_BGN, p.protocols);
+    TEST_ASSERT_TRUE(p.ht40);
+    TEST_ASSERT_EQUAL_UINT8(LINK_RETRIES_GOOD, p.chunk_retries);
+    // 20 kB/s for UPLOAD_CHUNK_TARGET_MS, aligned down
+    TEST_ASSERT_EQUAL_UINT32(chunk_size_clamp(20000 * UPLOAD_CHUNK_TARGET_MS / 1000),
+                             p.chunk_bytes);
+
+    // A fast link asks for the largest chunk
+    h = fresh();
+    record(&h, -48, 400000, 2);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_CHUNK_MAX, link_plan_choose(&h).chunk_bytes);
+}
+
+void test_good_link_power_headroom(void) {
+    LinkHistory h = fresh();
+    record(&h, -58, 20000, 3);
+    LinkPlan p = link_plan_choose(&h);
+    TEST_ASSERT_EQUAL_UINT8(LINK_GOOD, p.tier);
+    // 9 dB over the target: 9 dB below full power
+    TEST_ASSERT_EQUAL_UINT8(LINK_TX_POWER_MAX_QDBM - 4 * 9, p.tx_power_qdbm);
+    TEST_ASSERT_FALSE(p.ht40);
+
+    h = fresh();
+    record(&h, LINK_RSSI_GOOD_DBM, 20000);
+    p = link_plan_choose(&h);
+    TEST_ASSERT_EQUAL_UINT8(LINK_GOOD, p.tier);
+    TEST_ASSERT_EQUAL_UINT8(
+        LINK_TX_POWER_MAX_QDBM - 4 * (LINK_RSSI_GOOD_DBM - LINK_RSSI_TARGET_DBM),
+        p.tx_power_qdbm);
+}
+
+void test_fair_link(void) {
+    LinkHistory h = fresh();
+    record(&h, -70, 8000, 4);
+    LinkPlan p = link_plan_choose(&h);
+    TEST_ASSERT_EQUAL_UINT8(LINK_FAIR, p.tier);
+    TEST_ASSERT_EQUAL_UINT8(LINK_TX_POWER_MAX_QDBM, p.tx_power_qdbm);
+    TEST_ASSERT_EQUAL_HEX8(LINK_PROTO_BGN, p.protocols);
+    TEST_ASSERT_FALSE(p.ht40);
+    TEST_ASSERT_EQUAL_UINT8(LINK_RETRIES_FAIR, p.chunk_retries);
+    TEST_ASSERT_EQUAL_UINT32(chunk_size_clamp(12000), p.chunk_bytes);
+}
+
+void test_trouble_drops_a_tier(void) {
+    LinkHistory h = fresh();
+    record(&h, -50, 20000, 3);
+    LinkSample s = sample(-50, 20000, 2);  // Needed retries
+    link_history_record(&h, &s);
+    LinkPlan p = link_plan_choose(&h);
+    TEST_ASSERT_EQUAL_UINT8(LINK_FAIR, p.tier);
+    TEST_ASSERT_EQUAL_UINT8(LINK_TX_POWER_MAX_QDBM, p.tx_power_qdbm);
+    TEST_ASSERT_FALSE(p.ht40);
+
+    // An unfinished upload counts too; the next clean wake recovers
+    s = sample(-50, 20000, 0, false);
+    link_history_record(&h, &s);
+    TEST_ASSERT_EQUAL_UINT8(LINK_FAIR, link_plan_choose(&h).tier);
+    record(&h, -50, 20000);
+    TEST_ASSERT_EQUAL_UINT8(LINK_GOOD, link_plan_choose(&h).tier);
+
+    // POOR turns BAD
+    h = fresh();
+    record(&h, -80, 3000, 3);
+    s = sample(-80, 3000, 1);
+    link_history_record(&h, &s);
+    TEST_ASSERT_EQUAL_UINT8(LINK_BAD, link_plan_choose(&h).tier);
+}
+
+void test_median_and_window(void) {
+    LinkHistory h = fresh();
+    record(&h, -50, 20000);
+    record(&h, -50, 20000);
+    record(&h, -90, 20000);  // One bad wake
+    record(&h, -50, 20000);
+    TEST_ASSERT_EQUAL_UINT8(LINK_GOOD, link_plan_choose(&h).tier);
+
+    // Older wakes than the window are ignored
+    h = fresh();
+    record(&h, -88, 1000, LINK_WINDOW);
+    record(&h, -52, 20000, LINK_WINDOW);
+    TEST_ASSERT_EQUAL_UINT8(LINK_GOOD, link_plan_choose(&h).tier);
+
+    // Even count: mean of the middle two (-60 and -70 -> -65, FAIR)
+    h = fresh();
+    record(&h, -50, 20000);
+    record(&h, -60, 20000);
+    record(&h, -70, 20000);
+    record(&h, -80, 20000);
+    TEST_ASSERT_EQUAL_UINT8(LINK_FAIR, link_plan_choose(&h).tier);
+}
+
+void test_failed_connect(void) {
+    LinkHistory h = fresh();
+    record(&h, -48, 20000, 3);
+    LinkSample s = sample(LINK_RSSI_NONE, 0, 0, false);
+    link_history_record(&h, &s);
+    LinkPlan p = link_plan_choose(&h);
+    TEST_ASSERT_EQUAL_UINT8(LINK_POOR, p.tier);
+    TEST_ASSERT_EQUAL_UINT8(LINK_TX_POWER_MAX_QDBM, p.tx_power_qdbm);
+    TEST_ASSERT_EQUAL_HEX8(LINK_PROTO_BGN, p.protocols);
+    TEST_ASSERT_EQUAL_UINT8(LINK_RETRIES_POOR, p.chunk_retries);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_CHUNK_INITIAL / 2, p.chunk_bytes);
+
+    // Nothing but failed connects
+    h = fresh();
+    link_history_record(&h, &s);
+    link_history_record(&h, &s);
+    p = link_plan_choose(&h);
+    TEST_ASSERT_EQUAL_UINT8(LINK_POOR, p.tier);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_CHUNK_INITIAL / 2, p.chunk_bytes);
+}
+
+void test_bad_link(void) {
+    LinkHistory h = fresh();
+    record(&h, -88, 1500, 4);
+    LinkPlan p = link_plan_choose(&h);
+    TEST_ASSERT_EQUAL_UINT8(LINK_BAD, p.tier);
+    TEST_ASSERT_EQUAL_HEX8(LINK_PROTO_11B, p.protocols);
+    TEST_ASSERT_EQUAL_UINT8(LINK_TX_POWER_MAX_QDBM, p.tx_power_qdbm);
+    TEST_ASSERT_EQUAL_UINT8(LINK_RETRIES_POOR, p.chunk_retries);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_CHUNK_MIN, p.chunk_bytes);
+    TEST_ASSERT_EQUAL_STRING("bad", link_tier_name(p.tier));
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Test runner
+// ═══════════════════════════════════════════════════════════════════════
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    // History
+    RUN_TEST(test_no_history_defaults);
+    RUN_TEST(test_history_ring);
+    RUN_TEST(test_sample_rate);
+
+    // Plans
+    RUN_TEST(test_strong_link);
+    RUN_TEST(test_good_link_power_headroom);
+    RUN_TEST(test_fair_link);
+    RUN_TEST(test_trouble_drops_a_tier);
+    RUN_TEST(test_median_and_window);
+    RUN_TEST(test_failed_connect);
+    RUN_TEST(test_bad_link);
+
+    return UNITY_END();
+}
@@ -0,0 +1,179 @@
+// Waggle Camera Node — Native unit tests for resumable upload helpers.
+//
+// Runs on the host (no ESP32 required) via:
+//   pio test -e native
+//
+// Tests:
+//   1. CRC-32 matches zlib.crc32 (check value, empty input, incremental)
+//   2. Chunk size grows on fast links, shrinks on slow links and failures
+//   3. Chunk size stays within bounds and aligned
+//   4. JSON lookups for the hub's upload replies
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/upload_resume.h"
+
+// ═══════════════════════════════════════════════════════════════════════
+// CRC-32
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_crc32_check_value(void) {
+    // Standard CRC-32 check value; zlib.crc32(b"123456789") == 0xCBF43926
+    const uint8_t data[] = "123456789";
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, upload_crc32(0, data, 9));
+}
+
+void test_crc32_empty(void) {
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, upload_crc32(0, nullptr, 0));
+}
+
+void test_crc32_incremental_matches_whole(void) {
+    uint8_t data[1024];
+    for (int i = 0; i < 1024; i++) {
+        data[i] = (uint8_t)i;
+    }
+    // zlib.crc32(bytes(range(256)) * 4) == 0xB70B4C26
+    TEST_ASSERT_EQUAL_HEX32(0xB70B4C26, upload_crc32(0, data, sizeof(data)));
+
+    uint32_t crc = 0;
+    crc = upload_crc32(crc, data, 100);
+    crc = upload_crc32(crc, data + 100, 500);
+    crc = upload_crc32(crc, data + 600, 424);
+    TEST_ASSERT_EQUAL_HEX32(0xB70B4C26, crc);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Adaptive chunk size
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_chunk_initial(void) {
+    ChunkSizer cs;
+    chunk_sizer_init(&cs);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_CHUNK_INITIAL, cs.size);
+    TEST_ASSERT_EQUAL_UINT32(0, cs.rate_bps);
+}
+
+void test_chunk_grows_on_fast_link_capped_at_double(void) {
+    ChunkSizer cs;
+    chunk_sizer_init(&cs);
+    // 8 KB in 50 ms = 160 KB/s; ideal for 1.5 s is far above 2x
+    chunk_sizer_update(&cs, 8192, 50, true);
+    TEST_ASSERT_EQUAL_UINT32(16384, cs.size);
+    chunk_sizer_update(&cs, 16384, 50, true);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_CHUNK_MAX, cs.size);
+    chunk_sizer_update(&cs, 32768, 50, true);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_CHUNK_MAX, cs.size);
+}
+
+void test_chunk_shrinks_on_slow_link(void) {
+    ChunkSizer cs;
+    chunk_sizer_init(&cs);
+    // 8 KB took 4 s (2 KB/s) -> 1.5 s worth is 3 KB
+    chunk_sizer_update(&cs, 8192, 4000, true);
+    TEST_ASSERT_EQUAL_UINT32(2048, cs.rate_bps);
+    TEST_ASSERT_EQUAL_UINT32(3072, cs.size);
+}
+
+void test_chunk_short_final_chunk_does_not_shrink(void) {
+    ChunkSizer cs;
+    chunk_sizer_init(&cs);
+    // 600-byte tail sent in a round trip says nothing about bandwidth
+    chunk_sizer_update(&cs, 600, 300, true);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_CHUNK_INITIAL, cs.size);
+}
+
+void test_chunk_halves_on_failure_with_floor(void) {
+    ChunkSizer cs;
+    chunk_sizer_init(&cs);
+    chunk_sizer_update(&cs, 8192, 15000, false);
+    TEST_ASSERT_EQUAL_UINT32(4096, cs.size);
+    chunk_sizer_update(&cs, 4096, 15000, false);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_CHUNK_MIN, cs.size);
+    chunk_sizer_update(&cs, 2048, 15000, false);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_CHUNK_MIN, cs.size);
+}
+
+void test_chunk_zero_elapsed(void) {
+    ChunkSizer cs;
+    chunk_sizer_init(&cs);
+    chunk_sizer_update(&cs, 8192, 0, true);
+    TEST_ASSERT_EQUAL_UINT32(16384, cs.size);
+    TEST_ASSERT_EQUAL_UINT32(0, cs.size % UPLOAD_CHUNK_ALIGN);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Reply parsing
+// ═══════════════════════════════════════════════════════════════════════
+
+static const char* CREATED =
+    "{\"upload_id\":\"3f2a9c0d4e5b6a7c8d9e0f1a2b3c4d5e\",\"offset\":16384,"
+    "\"total_size\":80211,\"chunk_size\":32768,\"complete\":false}";
+
+void test_json_create_reply(void) {
+    char id[40];
+    uint32_t offset = 0, chunk = 0;
+    bool complete = true;
+    TEST_ASSERT_TRUE(json_find_string(CREATED, "upload_id", id, sizeof(id)));
+    TEST_ASSERT_EQUAL_STRING("3f2a9c0d4e5b6a7c8d9e0f1a2b3c4d5e", id);
+    TEST_ASSERT_TRUE(json_find_uint(CREATED, "offset", &offset));
+    TEST_ASSERT_EQUAL_UINT32(16384, offset);
+    TEST_ASSERT_TRUE(json_find_uint(CREATED, "chunk_size", &chunk));
+    TEST_ASSERT_EQUAL_UINT32(32768, chunk);
+    TEST_ASSERT_TRUE(json_find_bool(CREATED, "complete", &complete));
+    TEST_ASSERT_FALSE(complete);
+}
+
+void test_json_error_reply(void) {
+    const char* body =
+        "{\"error\": {\"code\": \"OFFSET_MISMATCH\", \"message\": \"offset\"}, \"offset\": 4096}";
+    uint32_t offset = 0;
+    char code[24];
+    // "offset" inside the message string is not a key
+    TEST_ASSERT_TRUE(json_find_uint(body, "offset", &offset));
+    TEST_ASSERT_EQUAL_UINT32(4096, offset);
+    TEST_ASSERT_TRUE(json_find_string(body, "code", code, sizeof(code)));
+    TEST_ASSERT_EQUAL_STRING("OFFSET_MISMATCH", code);
+}
+
+void test_json_missing_and_wrong_type(void) {
+    uint32_t v = 7;
+    bool b = false;
+    char s[8];
+    TEST_ASSERT_FALSE(json_find_uint(CREATED, "photo_id", &v));
+    TEST_ASSERT_EQUAL_UINT32(7, v);
+    TEST_ASSERT_FALSE(json_find_uint(CREATED, "upload_id", &v));
+    TEST_ASSERT_FALSE(json_find_bool(CREATED, "offset", &b));
+    // Too small a buffer
+    TEST_ASSERT_FALSE(json_find_string(CREATED, "upload_id", s, sizeof(s)));
+    TEST_ASSERT_FALSE(json_find_uint("{\"offset\":99999999999}", "offset", &v));
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Test runner
+// ═══════════════════════════════════════════════════════════════════════
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    // CRC-32
+    RUN_TEST(test_crc32_check_value);
+    RUN_TEST(test_crc32_empty);
+    RUN_TEST(test_crc32_incremental_matches_whole);
+
+    // Adaptive chunk size
+    RUN_TEST(test_chunk_initial);
+    RUN_TEST(test_chunk_grows_on_fast_link_capped_at_double);
+    RUN_TEST(test_chunk_shrinks_on_slow_link);
+    RUN_TEST(test_chunk_short_final_chunk_does_not_shrink);
+    RUN_TEST(test_chunk_halves_on_failure_with_floor);
+    RUN_TEST(test_chunk_zero_elapsed);
+
+    // Reply parsing
+    RUN_TEST(test_json_create_reply);
+    RUN_TEST(test_json_error_reply);
+    RUN_TEST(test_json_missing_and_wrong_type);
+
+    return UNITY_END();
+}
@@ -0,0 +1,217 @@
+// Waggle Camera Node — Native unit tests for the wake stub schedule.
+//
+// Runs on the host (no ESP32 required) via:
+//   pio test -e native
+//
+// Tests:
+//   1. A schedule that was never written always boots
+//   2. A due timer wake boots; an early one sleeps out the rest
+//   3. Night window (same day, across midnight, UTC offset) skips whole
+//      intervals to the first capture after the night
+//   4. The night rule needs an NTP-set clock
+//   5. Low battery skips until the recheck wake, which boots
+//   6. Hub pause skips until it ends; the latest-clearing reason wins
+//   7. Activity wakes: blocked ones keep the scheduled capture
+//   8. Skip counters per reason
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/wake_schedule.h"
+
+// ── Helpers ───────────────────────────────────────────────────────────
+
+static const uint32_t DAY0 = 1780272000u;  // 2026-06-01T00:00:00Z
+static const uint32_t INTERVAL = 900;
+
+static uint32_t at(uint32_t hour, uint32_t minute) {
+    return DAY0 + hour * 3600u + minute * 60u;
+}
+
+static WakeSchedule schedule(uint32_t next_capture) {
+    WakeSchedule s;
+    memset(&s, 0, sizeof(s));
+    s.magic = WAKE_SCHEDULE_MAGIC;
+    s.interval_s = INTERVAL;
+    s.next_capture_s = next_capture;
+    s.time_valid = true;
+    s.battery_recheck_s = 6 * 3600;
+    return s;
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Timer wakes
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_unwritten_schedule_boots(void) {
+    WakeSchedule s;
+    memset(&s, 0, sizeof(s));
+    s.night_start_min = 0;
+    s.night_end_min = 1439;
+    TEST_ASSERT_TRUE(wake_schedule_decide(&s, at(3, 0), false).boot);
+
+    s = schedule(at(3, 0));
+    s.interval_s = 0;
+    TEST_ASSERT_TRUE(wake_schedule_decide(&s, at(3, 0), false).boot);
+}
+
+void test_due_boots_early_sleeps(void) {
+    WakeSchedule s = schedule(at(12, 0));
+    TEST_ASSERT_TRUE(wake_schedule_decide(&s, at(12, 0), false).boot);
+    // Within the slack counts as due
+    TEST_ASSERT_TRUE(wake_schedule_decide(&s, at(12, 0) - WAKE_EARLY_SLACK_S, false).boot);
+
+    WakeDecision d = wake_schedule_decide(&s, at(11, 59), false);
+    TEST_ASSERT_FALSE(d.boot);
+    TEST_ASSERT_EQUAL_UINT8(WAKE_SKIP_EARLY, d.reason);
+    TEST_ASSERT_EQUAL_UINT32(60, d.sleep_s);
+    TEST_ASSERT_EQUAL_UINT32(at(12, 0), s.next_capture_s);
+}
+
+void test_night_skips_to_first_slot_after_night(void) {
+    // 21:00-05:00 local at UTC+10: night is 11:00-19:00 UTC
+    WakeSchedule s = schedule(at(11, 0));
+    s.night_start_min = 21 * 60;
+    s.night_end_min = 5 * 60;
+    s.utc_offset_min = 600;
+    TEST_ASSERT_TRUE(wake_schedule_is_night(&s, at(11, 0)));
+    TEST_ASSERT_FALSE(wake_schedule_is_night(&s, at(10, 59)));
+    TEST_ASSERT_FALSE(wake_schedule_is_night(&s, at(19, 0)));
+
+    WakeDecision d = wake_schedule_decide(&s, at(11, 0), false);
+    TEST_ASSERT_FALSE(d.boot);
+    TEST_ASSERT_EQUAL_UINT8(WAKE_SKIP_NIGHT, d.reason);
+    // 11:00 + 32 x 15 min = 19:00, the first slot outside the night
+    TEST_ASSERT_EQUAL_UINT32(at(19, 0), s.next_capture_s);
+    TEST_ASSERT_EQUAL_UINT32(8 * 3600, d.sleep_s);
+    TEST_ASSERT_TRUE(wake_schedule_decide(&s, at(19, 0), false).boot);
+
+    // Same-day window, off-cadence schedule: cadence is kept
+    WakeSchedule day = schedule(at(1, 7));
+    day.night_start_min = 60;
+    day.night_end_min = 4 * 60 + 30;
+    d = wake_schedule_decide(&day, at(1, 7), false);
+    TEST_ASSERT_FALSE(d.boot);
+    TEST_ASSERT_EQUAL_UINT32(at(4, 37), day.next_capture_s);
+    TEST_ASSERT_EQUAL_UINT32(0, (day.next_capture_s - at(1, 7)) % INTERVAL);
+}
+
+void test_night_needs_valid_clock(void) {
+    WakeSchedule s = schedule(at(23, 0));
+    s.night_start_min = 22 * 60;
+    s.night_end_min = 6 * 60;
+    s.time_valid = false;
+    TEST_ASSERT_TRUE(wake_schedule_decide(&s, at(23, 0), false).boot);
+}
+
+void test_low_battery_skips_until_recheck(void) {
+    WakeSchedule s = schedule(at(8, 0));
+    s.battery_floor_mv = 3300;
+    s.battery_mv = 3250;
+    s.battery_checked_s = at(7, 45);
+
+    WakeDecision d = wake_schedule_decide(&s, at(8, 0), false);
+    TEST_ASSERT_FALSE(d.boot);
+    TEST_ASSERT_EQUAL_UINT8(WAKE_SKIP_BATTERY, d.reason);
+    TEST_ASSERT_EQUAL_UINT32(at(13, 45), s.next_capture_s);  // 7:45 + 6 h
+    TEST_ASSERT_TRUE(wake_schedule_decide(&s, at(13, 45), false).boot);
+
+    // Battery above the floor, unknown, or rule off
+    WakeSchedule ok = schedule(at(8, 0));
+    ok.battery_floor_mv = 3300;
+    ok.battery_mv = 3400;
+    ok.battery_checked_s = at(7, 45);
+    TEST_ASSERT_TRUE(wake_schedule_decide(&ok, at(8, 0), false).boot);
+    ok.battery_mv = 0;
+    TEST_ASSERT_TRUE(wake_schedule_decide(&ok, at(8, 0), false).boot);
+    ok.battery_mv = 3000;
+    ok.battery_floor_mv = 0;
+    TEST_ASSERT_TRUE(wake_schedule_decide(&ok, at(8, 0), false).boot);
+}
+
+void test_server_pause_and_longest_reason(void) {
+    WakeSchedule s = schedule(at(9, 0));
+    s.skip_until_s = at(10, 10);
+    WakeDecision d = wake_schedule_decide(&s, at(9, 0), false);
+    TEST_ASSERT_FALSE(d.boot);
+    TEST_ASSERT_EQUAL_UINT8(WAKE_SKIP_SERVER, d.reason);
+    TEST_ASSERT_EQUAL_UINT32(at(10, 15), s.next_capture_s);
+    TEST_ASSERT_TRUE(wake_schedule_decide(&s, at(10, 15), false).boot);
+
+    // Pause ends at 20:30, the night at 22:00: reported as the pause,
+    // held back until the night is over
+    WakeSchedule both = schedule(at(20, 0));
+    both.skip_until_s = at(20, 30);
+    both.night_start_min = 19 * 60;
+    both.night_end_min = 22 * 60;
+    d = wake_schedule_decide(&both, at(20, 0), false);
+    TEST_ASSERT_EQUAL_UINT8(WAKE_SKIP_SERVER, d.reason);
+    TEST_ASSERT_EQUAL_UINT32(at(22, 0), both.next_capture_s);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Activity wakes
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_activity_wake(void) {
+    // Not early-checked: activity wakes boot between scheduled captures
+    WakeSchedule s = schedule(at(12, 0));
+    TEST_ASSERT_TRUE(wake_schedule_decide(&s, at(11, 52), true).boot);
+
+    // Blocked: sleep until the capture already scheduled, unchanged
+    s.skip_until_s = at(11, 55);
+    WakeDecision d = wake_schedule_decide(&s, at(11, 52), true);
+    TEST_ASSERT_FALSE(d.boot);
+    TEST_ASSERT_EQUAL_UINT8(WAKE_SKIP_SERVER, d.reason);
+    TEST_ASSERT_EQUAL_UINT32(480, d.sleep_s);
+    TEST_ASSERT_EQUAL_UINT32(at(12, 0), s.next_capture_s);
+
+    // Blocked past the scheduled capture: move to the next slot
+    s.skip_until_s = at(12, 20);
+    s.next_capture_s = at(11, 50);
+    d = wake_schedule_decide(&s, at(11, 52), true);
+    TEST_ASSERT_EQUAL_UINT32(at(12, 20), s.next_capture_s);
+    TEST_ASSERT_EQUAL_UINT32(28 * 60, d.sleep_s);
+}
+
+void test_skip_counters(void) {
+    WakeSchedule s = schedule(at(2, 0));
+    s.night_start_min = 0;
+    s.night_end_min = 6 * 60;
+    wake_schedule_decide(&s, at(1, 58), false);  // Early
+    wake_schedule_decide(&s, at(2, 0), false);   // Night
+    s.next_capture_s = at(2, 0);
+    wake_schedule_decide(&s, at(2, 0), false);   // Night
+    wake_schedule_decide(&s, at(6, 0), false);   // Boots
+    TEST_ASSERT_EQUAL_UINT16(1, s.skipped[WAKE_SKIP_EARLY]);
+    TEST_ASSERT_EQUAL_UINT16(2, s.skipped[WAKE_SKIP_NIGHT]);
+    TEST_ASSERT_EQUAL_UINT16(0, s.skipped[WAKE_SKIP_NONE]);
+
+    s.skipped[WAKE_SKIP_NIGHT] = 0xFFFF;
+    s.next_capture_s = at(2, 0);
+    wake_schedule_decide(&s, at(2, 0), false);
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, s.skipped[WAKE_SKIP_NIGHT]);  // Saturates
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Test runner
+// ═══════════════════════════════════════════════════════════════════════
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    // Timer wakes
+    RUN_TEST(test_unwritten_schedule_boots);
+    RUN_TEST(test_due_boots_early_sleeps);
+    RUN_TEST(test_night_skips_to_first_slot_after_night);
+    RUN_TEST(test_night_needs_valid_clock);
+    RUN_TEST(test_low_battery_skips_until_recheck);
+    RUN_TEST(test_server_pause_and_longest_reason);
+
+    // Activity wakes
+    RUN_TEST(test_activity_wake);
+    RUN_TEST(test_skip_counters);
+
+    return UNITY_END();
+}
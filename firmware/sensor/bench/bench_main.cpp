@@ -0,0 +1,147 @@
+// Waggle Sensor Node — Native benchmarks for the sensor hot paths.
+//
+// Host-only.  Times the code that runs on every wake or in the beam ISRs:
+//   crc8                over the 17-byte CRC span and a whole payload
+//   payload_build(_v2)  Phase 1 / Phase 2 payload assembly incl. CRC
+//   lane/event          bee counter state machine, per beam/timeout event
+//   activity/record     activity trigger, per counted transit
+//
+// Build and run:
+//   pio run -e bench && .pio/build/bench/program --out bench_sensor.json
+// Compare two runs with ../bench/compare.py.
+
+#define BENCH_MAIN
+#include "bench.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/activity_trigger.h"
+#include "../src/bee_counter.h"
+#include "../src/payload.h"
+#include "../src/tunnel_config.h"
+
+// ── Lane event trace ──────────────────────────────────────────────────
+// A deterministic mix of what the ISRs and main loop feed the state
+// machine: IN and OUT transits, debounce bounces, half transits that time
+// out, and periodic timeout checks, spread over NUM_CHANNELS lanes.
+
+enum TraceOp : uint8_t { EV_A, EV_B, EV_TIMEOUT };
+
+struct TraceEvent {
+    uint8_t  op;
+    uint8_t  lane;
+    uint32_t now_ms;
+};
+
+#define TRACE_LEN 4096
+
+static TraceEvent s_trace[TRACE_LEN];
+
+static void build_trace() {
+    uint32_t t = 0;
+    uint32_t rng = 0x1234567u;
+    size_t n = 0;
+    while (n + 4 <= TRACE_LEN) {
+        rng = rng * 1103515245u + 12345u;
+        uint8_t lane = (uint8_t)((rng >> 16) % NUM_CHANNELS);
+        uint32_t transit = MIN_TRANSIT_MS + (rng >> 8) % 60;
+        switch ((rng >> 24) % 4) {
+            case 0:   // Inbound transit
+                s_trace[n++] = {EV_A, lane, t};
+                s_trace[n++] = {EV_B, lane, t + transit};
+                break;
+            case 1:   // Outbound transit
+                s_trace[n++] = {EV_B, lane, t};
+                s_trace[n++] = {EV_A, lane, t + transit};
+                break;
+            case 2:   // Bounce within the debounce window
+                s_trace[n++] = {EV_A, lane, t};
+                s_trace[n++] = {EV_A, lane, t + DEBOUNCE_MS - 1};
+                break;
+            default:  // Bee turns back: half transit left to time out
+                s_trace[n++] = {EV_B, lane, t};
+                break;
+        }
+        t += transit + REFRACTORY_MS;
+        s_trace[n++] = {EV_TIMEOUT, lane, t};
+        t += MAX_TRANSIT_MS / 4;
+    }
+    while (n < TRACE_LEN) {
+        s_trace[n++] = {EV_TIMEOUT, 0, t};
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::Suite suite("sensor", argc, argv);
+
+    // ── CRC-8 ──
+    uint8_t buf[sizeof(bee_count_payload_t)];
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)(i * 37 + 11);
+    }
+    suite.run("crc8/17B", 17, [&] {
+        bench::do_not_optimize(buf);
+        bench::do_not_optimize(crc8(buf, 17));
+    });
+    suite.run("crc8/48B", sizeof(buf), [&] {
+        bench::do_not_optimize(buf);
+        bench::do_not_optimize(crc8(buf, sizeof(buf)));
+    });
+
+    // ── Payload assembly ──
+    sensor_payload_t p1;
+    uint16_t seq = 0;
+    suite.run("payload_build", sizeof(p1), [&] {
+        payload_build(&p1, 3, seq++, 41250, 3412, 6120, 10132, 3870, FLAG_FIRST_BOOT);
+        bench::do_not_optimize(p1);
+    });
+    bee_count_payload_t p2;
+    suite.run("payload_build_v2", sizeof(p2), [&] {
+        payload_build_v2(&p2, 3, seq++, 41250, 3412, 6120, 10132, 3870, 0,
+                         142, 97, 60000, 0x0F, 0x00);
+        bench::do_not_optimize(p2);
+    });
+
+    // ── Bee counter state machine ──
+    build_trace();
+    LaneData lanes[NUM_CHANNELS];
+    memset(lanes, 0, sizeof(lanes));
+    size_t idx = 0;
+    uint32_t epoch = 0;
+    suite.run("lane/event", 0, [&] {
+        const TraceEvent& ev = s_trace[idx];
+        LaneData* lane = &lanes[ev.lane];
+        uint32_t now = epoch + ev.now_ms;
+        if (ev.op == EV_A) {
+            lane_beam_a_event(lane, now);
+        } else if (ev.op == EV_B) {
+            lane_beam_b_event(lane, now);
+        } else {
+            lane_check_timeout(lane, now);
+        }
+        if (++idx == TRACE_LEN) {
+            idx = 0;
+            epoch += s_trace[TRACE_LEN - 1].now_ms + STUCK_BEAM_MS;
+        }
+        bench::do_not_optimize(lanes);
+    });
+
+    // ── Activity trigger ──
+    ActivityTriggerConfig cfg = {
+        ACTIVITY_WINDOW_MS, ACTIVITY_IN_THRESHOLD, ACTIVITY_OUT_THRESHOLD,
+        ACTIVITY_HOLD_MS, ACTIVITY_HOLDOFF_MS,
+    };
+    ActivityTrigger trig;
+    activity_trigger_init(&trig, &cfg);
+    uint32_t now = 0;
+    bool inbound = false;
+    suite.run("activity/record", 0, [&] {
+        now += 37;
+        inbound = !inbound;
+        bench::do_not_optimize(activity_trigger_record(&trig, now, inbound));
+        activity_trigger_poll(&trig, now);
+    });
+
+    return suite.finish();
+}
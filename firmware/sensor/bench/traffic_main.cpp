@@ -0,0 +1,439 @@
+// Waggle Sensor Node — Trace-driven bee counter accuracy and throughput.
+//
+// Host-only.  Synthesises beam-break traces with a known ground truth,
+// runs each through the counter engines below and reports, per traffic
+// intensity, the count error and the beam events processed per second.
+//
+// Traffic model, per bee:
+//   arrivals     Poisson at the given rate over the whole entrance, each on
+//                a uniformly chosen lane, --in-pct percent inbound.  Bees on
+//                one lane are not queued, so at high rates they tailgate.
+//   speed        beam-to-beam transit time is log-normal (median
+//                TRANSIT_MEDIAN_MS); each beam stays broken for the bee's
+//                body length, BODY_FACTOR times the transit time
+//   turn-backs   TURNBACK_PCT percent break the first beam and retreat
+//   loiterers    LOITER_PCT percent stop for 0.3-3 s before the second beam
+//   occlusion    overlapping breaks of one beam merge: only the first
+//                falling edge of a merged break reaches the ISR
+//   noise        BOUNCE_PCT percent of breaks chatter with 1-3 extra
+//                falling edges in their first 5 ms, and short glitches
+//                (sunlight, dust) arrive at GLITCH_PER_MIN per beam
+//
+// The ground truth counts every bee that crosses both beams (loiterers
+// included, turn-backs not) in the period its second beam breaks.  Edges
+// are delivered at millis() resolution and the counters are collected with
+// lanes_collect() every --period-s seconds, as the wake cycle does.
+//
+// Engines:
+//   isr      the firmware: beam events in order; lane_check_timeout() runs
+//            only inside lanes_collect() at each snapshot
+//   polled   as isr, plus lane_check_timeout() on every lane each POLL_MS
+//            (its events/s include those checks)
+//
+// The counter settings are the tunnel_config.h timing constants.  Build
+// with overrides to compare settings, e.g.
+//   PLATFORMIO_BUILD_FLAGS="-DREFRACTORY_MS=20" pio run -e traffic
+//
+// Build and run:
+//   pio run -e traffic && .pio/build/traffic/program --rates 1,5,20,40
+//
+// Options:
+//   --rates LIST      bees/s over the entrance, comma separated
+//                     (default 0.5,2,5,10,20,40)
+//   --seconds N       simulated seconds per rate (default 600)
+//   --period-s N      snapshot interval (default WAKE_INTERVAL_SEC)
+//   --in-pct N        share of inbound bees in percent (default 50)
+//   --seed N          PRNG seed (default 1)
+//   --min-time-ms N   minimum timed replay per rate and engine (default 200)
+//   --csv FILE        write one row per rate and engine
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "../src/bee_counter.h"
+#include "../src/config.h"
+#include "../src/tunnel_config.h"
+
+// ── Traffic model ─────────────────────────────────────────────────────
+#define TRANSIT_MEDIAN_MS  30.0   // ~12 mm beam spacing at 0.4 m/s
+#define TRANSIT_SIGMA      0.45   // Log-normal spread of the transit time
+#define BODY_FACTOR        1.2    // Beam break length / transit time
+#define TURNBACK_PCT       5
+#define LOITER_PCT         1
+#define BOUNCE_PCT         20
+#define GLITCH_PER_MIN     0.5
+
+#define TRACE_START_MS     1000   // Clear of the zeroed debounce timestamps
+#define DRAIN_MS           5000   // No arrivals this close to the end
+#define POLL_MS            10
+#define ALL_LANES          ((uint8_t)((1 << NUM_CHANNELS) - 1))
+
+enum TraceOp : uint8_t { EV_A, EV_B };
+
+struct TraceEvent {
+    uint32_t now_ms;
+    uint8_t  op;
+    uint8_t  lane;
+};
+
+struct Trace {
+    std::vector<TraceEvent> events;
+    std::vector<uint32_t>   true_in;    // Per snapshot period
+    std::vector<uint32_t>   true_out;
+    uint32_t start_ms;
+    uint32_t period_ms;
+    uint64_t bees;
+    uint64_t turnbacks;
+    uint64_t loiterers;
+};
+
+class Rng {
+public:
+    explicit Rng(uint32_t seed) : s_(seed ? seed : 1) {}
+
+    uint32_t next() {
+        // xorshift32
+        s_ ^= s_ << 13;
+        s_ ^= s_ >> 17;
+        s_ ^= s_ << 5;
+        return s_;
+    }
+
+    double unit() { return (next() + 1.0) / 4294967297.0; }  // (0, 1)
+
+    double normal() { return sqrt(-2.0 * log(unit())) * cos(2.0 * M_PI * unit()); }
+
+    double exponential(double mean) { return -log(unit()) * mean; }
+
+private:
+    uint32_t s_;
+};
+
+// ── Trace generation ──────────────────────────────────────────────────
+
+struct Interval {
+    uint64_t start_us;
+    uint64_t end_us;
+};
+
+struct Edge {
+    uint64_t at_us;
+    uint8_t  lane;
+    uint8_t  op;
+
+    bool operator<(const Edge& o) const {
+        if (at_us != o.at_us) return at_us < o.at_us;
+        if (lane != o.lane) return lane < o.lane;
+        return op < o.op;
+    }
+};
+
+// Merge one beam's breaks and emit a falling edge per merged break, plus
+// bounce edges while it is broken.
+static void beam_edges(std::vector<Interval>& breaks, uint8_t lane, uint8_t op, Rng& rng,
+                       std::vector<Edge>* edges) {
+    std::sort(breaks.begin(), breaks.end(),
+              [](const Interval& a, const Interval& b) { return a.start_us < b.start_us; });
+    size_t i = 0;
+    while (i < breaks.size()) {
+        Interval cur = breaks[i++];
+        while (i < breaks.size() && breaks[i].start_us <= cur.end_us) {
+            cur.end_us = std::max(cur.end_us, breaks[i++].end_us);
+        }
+        edges->push_back({cur.start_us, lane, op});
+        if (rng.next() % 100 < BOUNCE_PCT) {
+            uint32_t n = 1 + rng.next() % 3;
+            for (uint32_t k = 0; k < n; k++) {
+                uint64_t at = cur.start_us + 200 + rng.next() % 4800;
+                if (at < cur.end_us) {
+                    edges->push_back({at, lane, op});
+                }
+            }
+        }
+    }
+}
+
+static Trace build_trace(double rate, uint32_t periods, uint32_t period_ms, uint8_t in_pct,
+                         uint32_t seed) {
+    Rng rng(seed);
+    Trace tr;
+    tr.start_ms = TRACE_START_MS;
+    tr.period_ms = period_ms;
+    tr.true_in.assign(periods, 0);
+    tr.true_out.assign(periods, 0);
+    tr.bees = tr.turnbacks = tr.loiterers = 0;
+
+    const uint64_t start_us = (uint64_t)tr.start_ms * 1000ULL;
+    const uint64_t end_us = start_us + (uint64_t)periods * period_ms * 1000ULL;
+    std::vector<Interval> breaks[NUM_CHANNELS][2];
+
+    // Bees
+    double t = start_us + (rate > 0 ? rng.exponential(1e6 / rate) : (double)end_us);
+    while (t < end_us - DRAIN_MS * 1000.0) {
+        uint8_t lane = (uint8_t)(rng.next() % NUM_CHANNELS);
+        bool inbound = (rng.next() % 100) < in_pct;
+        uint8_t first = inbound ? EV_A : EV_B;  // Beam A is the outer beam
+        double transit_us = TRANSIT_MEDIAN_MS * 1000.0 * exp(TRANSIT_SIGMA * rng.normal());
+        double body_us = BODY_FACTOR * transit_us;
+        uint64_t at = (uint64_t)t;
+        uint32_t kind = rng.next() % 100;
+
+        if (kind < TURNBACK_PCT) {
+            breaks[lane][first].push_back({at, at + (uint64_t)body_us});
+            tr.turnbacks++;
+        } else {
+            double hold_us = 0;
+            if (kind < TURNBACK_PCT + LOITER_PCT) {
+                hold_us = (300 + rng.next() % 2700) * 1000.0;
+                tr.loiterers++;
+            }
+            uint64_t second = at + (uint64_t)(hold_us + transit_us);
+            breaks[lane][first].push_back({at, at + (uint64_t)(hold_us + body_us)});
+            breaks[lane][1 - first].push_back({second, second + (uint64_t)body_us});
+            uint32_t period = (uint32_t)((second / 1000ULL - tr.start_ms) / period_ms);
+            if (inbound) {
+                tr.true_in[period]++;
+            } else {
+                tr.true_out[period]++;
+            }
+        }
+        tr.bees++;
+        t += rng.exponential(1e6 / rate);
+    }
+
+    // Glitches, then merge each beam's breaks into edges
+    std::vector<Edge> edges;
+    double glitch_mean_us = 60e6 / GLITCH_PER_MIN;
+    for (uint8_t lane = 0; lane < NUM_CHANNELS; lane++) {
+        for (uint8_t op = EV_A; op <= EV_B; op++) {
+            for (double g = start_us + rng.exponential(glitch_mean_us); g < end_us;
+                 g += rng.exponential(glitch_mean_us)) {
+                breaks[lane][op].push_back({(uint64_t)g, (uint64_t)g + 50 + rng.next() % 450});
+            }
+            beam_edges(breaks[lane][op], lane, op, rng, &edges);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    tr.events.reserve(edges.size());
+    for (const Edge& e : edges) {
+        tr.events.push_back({(uint32_t)(e.at_us / 1000ULL), e.op, e.lane});
+    }
+    return tr;
+}
+
+// ── Engines ───────────────────────────────────────────────────────────
+
+struct Engine {
+    const char* name;
+    uint32_t    poll_ms;  // lane_check_timeout() interval, 0 = snapshots only
+};
+
+static const Engine ENGINES[] = {
+    {"isr",    0},
+    {"polled", POLL_MS},
+};
+
+struct EngineResult {
+    uint64_t counted_in;
+    uint64_t counted_out;
+    uint64_t period_abs_err;  // Sum over periods of |in error| + |out error|
+    uint32_t stuck_periods;
+};
+
+static EngineResult run_engine(const Engine& eng, const Trace& tr) {
+    LaneData lanes[NUM_CHANNELS];
+    memset(lanes, 0, sizeof(lanes));
+
+    EngineResult r;
+    memset(&r, 0, sizeof(r));
+    size_t period = 0;
+    uint32_t last_snap = tr.start_ms;
+    uint32_t next_snap = tr.start_ms + tr.period_ms;
+    uint32_t next_poll = eng.poll_ms ? tr.start_ms + eng.poll_ms : UINT32_MAX;
+
+    // Run the polls and snapshots due at or before until_ms, in time order
+    auto advance = [&](uint32_t until_ms) {
+        while (next_snap <= until_ms || next_poll <= until_ms) {
+            if (next_poll < next_snap) {
+                for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                    lane_check_timeout(&lanes[ch], next_poll);
+                }
+                next_poll += eng.poll_ms;
+                continue;
+            }
+            BeeCountSnapshot s = lanes_collect(lanes, ALL_LANES, next_snap, last_snap);
+            r.counted_in += s.bees_in;
+            r.counted_out += s.bees_out;
+            r.period_abs_err += (uint64_t)abs((int32_t)s.bees_in - (int32_t)tr.true_in[period]);
+            r.period_abs_err += (uint64_t)abs((int32_t)s.bees_out - (int32_t)tr.true_out[period]);
+            if (s.stuck_mask != 0) {
+                r.stuck_periods++;
+            }
+            period++;
+            last_snap = next_snap;
+            next_snap = (period < tr.true_in.size()) ? next_snap + tr.period_ms : UINT32_MAX;
+        }
+    };
+
+    for (const TraceEvent& ev : tr.events) {
+        advance(ev.now_ms);
+        if (ev.op == EV_A) {
+            lane_beam_a_event(&lanes[ev.lane], ev.now_ms);
+        } else {
+            lane_beam_b_event(&lanes[ev.lane], ev.now_ms);
+        }
+    }
+    advance(tr.start_ms + (uint32_t)tr.true_in.size() * tr.period_ms);
+    return r;
+}
+
+// ── Report ────────────────────────────────────────────────────────────
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--rates LIST] [--seconds N] [--period-s N] [--in-pct N] [--seed N]\n"
+            "          [--min-time-ms N] [--csv FILE]\n", argv0);
+    exit(2);
+}
+
+static bool parse_rates(const char* s, std::vector<double>* rates) {
+    rates->clear();
+    while (*s != '\0') {
+        char* end;
+        double r = strtod(s, &end);
+        if (end == s || r < 0) {
+            return false;
+        }
+        rates->push_back(r);
+        s = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return false;
+        }
+    }
+    return !rates->empty();
+}
+
+static void print_err(uint64_t counted, uint64_t truth) {
+    if (truth == 0) {
+        printf(" %8s", "-");
+    } else {
+        printf(" %+7.2f%%", 100.0 * ((double)counted - (double)truth) / (double)truth);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<double> rates = {0.5, 2, 5, 10, 20, 40};
+    uint32_t seconds = 600;
+    uint32_t period_s = WAKE_INTERVAL_SEC;
+    uint32_t in_pct = 50;
+    uint32_t seed = 1;
+    uint32_t min_time_ms = 200;
+    const char* csv_path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (v == nullptr) {
+            usage(argv[0]);
+        } else if (strcmp(argv[i], "--rates") == 0) {
+            if (!parse_rates(v, &rates)) usage(argv[0]);
+            i++;
+        } else if (strcmp(argv[i], "--seconds") == 0) {
+            seconds = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--period-s") == 0) {
+            period_s = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--in-pct") == 0) {
+            in_pct = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--min-time-ms") == 0) {
+            min_time_ms = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            csv_path = v; i++;
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (in_pct > 100 || period_s == 0 || period_s * 1000ULL <= DRAIN_MS ||
+        seconds < period_s || seconds > 86400) {
+        usage(argv[0]);
+    }
+    uint32_t periods = seconds / period_s;
+
+    FILE* csv = nullptr;
+    if (csv_path != nullptr) {
+        csv = fopen(csv_path, "w");
+        if (csv == nullptr) {
+            fprintf(stderr, "cannot write %s\n", csv_path);
+            return 1;
+        }
+        fprintf(csv, "bees_per_s,engine,events,true_in,true_out,counted_in,counted_out,"
+                     "period_mae,stuck_periods,events_per_s\n");
+    }
+
+    printf("settings  debounce %d ms, transit %d-%d ms, refractory %d ms, stuck %d ms\n",
+           DEBOUNCE_MS, MIN_TRANSIT_MS, MAX_TRANSIT_MS, REFRACTORY_MS, STUCK_BEAM_MS);
+    printf("traffic   %u x %u s periods per rate, %u%% inbound, %d lanes, seed %u\n\n",
+           periods, period_s, in_pct, NUM_CHANNELS, seed);
+    printf("%7s %-7s %8s %8s %8s %8s %9s %6s %10s\n", "bees/s", "engine", "true in",
+           "true out", "in err", "out err", "MAE/per", "stuck", "Mevents/s");
+
+    for (double rate : rates) {
+        Trace tr = build_trace(rate, periods, period_s * 1000, (uint8_t)in_pct, seed);
+        uint64_t true_in = 0, true_out = 0;
+        for (uint32_t p = 0; p < periods; p++) {
+            true_in += tr.true_in[p];
+            true_out += tr.true_out[p];
+        }
+
+        for (const Engine& eng : ENGINES) {
+            EngineResult r = run_engine(eng, tr);
+
+            // Replay until min_time_ms has passed for a stable rate
+            uint64_t runs = 0;
+            double elapsed_s = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            do {
+                EngineResult again = run_engine(eng, tr);
+                if (again.counted_in != r.counted_in) {
+                    fprintf(stderr, "%s: non-deterministic result\n", eng.name);
+                    return 1;
+                }
+                runs++;
+                elapsed_s = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - t0).count();
+            } while (elapsed_s * 1000.0 < min_time_ms);
+            double events_per_s = elapsed_s > 0 ? tr.events.size() * runs / elapsed_s : 0.0;
+            double mae = (double)r.period_abs_err / periods;
+
+            printf("%7.1f %-7s %8llu %8llu", rate, eng.name, (unsigned long long)true_in,
+                   (unsigned long long)true_out);
+            print_err(r.counted_in, true_in);
+            print_err(r.counted_out, true_out);
+            printf(" %9.2f %6u %10.1f\n", mae, r.stuck_periods, events_per_s / 1e6);
+
+            if (csv != nullptr) {
+                fprintf(csv, "%.3f,%s,%zu,%llu,%llu,%llu,%llu,%.3f,%u,%.0f\n", rate, eng.name,
+                        tr.events.size(), (unsigned long long)true_in,
+                        (unsigned long long)true_out, (unsigned long long)r.counted_in,
+                        (unsigned long long)r.counted_out, mae, r.stuck_periods,
+                        events_per_s);
+            }
+        }
+        printf("        %zu events (%.2f per bee), %llu turn-backs, %llu loiterers\n",
+               tr.events.size(), tr.bees ? (double)tr.events.size() / tr.bees : 0.0,
+               (unsigned long long)tr.turnbacks, (unsigned long long)tr.loiterers);
+    }
+
+    if (csv != nullptr) {
+        fclose(csv);
+    }
+    return 0;
+}
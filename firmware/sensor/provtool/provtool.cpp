@@ -0,0 +1,535 @@
+/**
+ * Waggle Sensor Node — Fleet provisioning tool.
+ *
+ * Host-only (Linux).  Commissions a batch of sensor nodes plugged in over
+ * USB, one thread per serial port, using the binary protocol of
+ * src/provision_proto.h (the firmware's own framing and request codecs).
+ * Each node must be in provisioning mode (GPIO27 held LOW at boot).
+ *
+ * Per node: HELLO (retried while the board boots; opening the port may
+ * reset it), WRITE_CONFIG of every NVS key with the read-back verified,
+ * optional TARE and CALIBRATE, a final READ_CONFIG check, and an optional
+ * REBOOT.  A table of results is printed at the end; the exit status is
+ * non-zero if any node failed.
+ *
+ * Manifest: CSV with a header row; blank lines and '#' comments skipped.
+ *   port,hive_id,bridge_mac[,hx_scale][,hx_offset][,tare][,calibrate_g]
+ *   /dev/ttyUSB0,1,AA:BB:CC:DD:EE:FF,,,1,500
+ * Empty optional fields keep the node's current value; tare = 1 zeroes
+ * the load cell (scale empty), calibrate_g > 0 then calibrates with that
+ * many grams placed within --place-ms.
+ *
+ * Build and run:
+ *   pio run -e provtool
+ *   .pio/build/provtool/program fleet.csv --reboot
+ */
+
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../bridge/host/host_io.h"
+#include "../src/provision_proto.h"
+
+#define HX711_SAMPLE_MS 100  // 10 SPS with RATE tied low
+
+// ---- Options ----
+
+struct Options {
+    const char* manifest    = nullptr;
+    uint32_t    baud        = 115200;
+    uint32_t    boot_ms     = 10000;
+    uint32_t    reply_ms    = 2000;
+    uint16_t    settle_ms   = 2000;
+    uint16_t    place_ms    = 10000;
+    uint8_t     samples     = 20;
+    bool        reboot      = false;
+};
+
+// ---- Manifest ----
+
+struct Job {
+    int         line;
+    std::string port;
+    uint8_t     hive_id;
+    uint8_t     bridge_mac[6];
+    bool        set_scale;
+    float       hx_scale;
+    bool        set_offset;
+    int32_t     hx_offset;
+    bool        tare;
+    float       calibrate_g;   // 0 = no calibration
+
+    // Result
+    bool        ok;
+    std::string error;
+    bool        have_node_mac;
+    uint8_t     node_mac[6];
+    ProvConfig  final_config;
+    double      seconds;
+};
+
+static bool parse_mac(const char* s, uint8_t* mac) {
+    unsigned int m[6];
+    char tail;
+    if (sscanf(s, "%x:%x:%x:%x:%x:%x%c", &m[0], &m[1], &m[2], &m[3], &m[4], &m[5], &tail) != 6) {
+        return false;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (m[i] > 0xFF) {
+            return false;
+        }
+        mac[i] = (uint8_t)m[i];
+    }
+    return true;
+}
+
+static std::string trim(const std::string& s) {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    size_t b = s.find_last_not_of(" \t\r\n");
+    return a == std::string::npos ? std::string() : s.substr(a, b - a + 1);
+}
+
+static std::vector<std::string> split_csv(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (;;) {
+        size_t comma = line.find(',', start);
+        fields.push_back(trim(line.substr(start, comma == std::string::npos ? std::string::npos
+                                                                            : comma - start)));
+        if (comma == std::string::npos) {
+            return fields;
+        }
+        start = comma + 1;
+    }
+}
+
+static bool parse_number(const std::string& s, double* out) {
+    char* end = nullptr;
+    *out = strtod(s.c_str(), &end);
+    return !s.empty() && *end == '\0' && isfinite(*out);
+}
+
+static bool load_manifest(const char* path, std::vector<Job>* jobs) {
+    FILE* f = fopen(path, "r");
+    if (f == nullptr) {
+        perror(path);
+        return false;
+    }
+    enum { PORT, HIVE, BRIDGE, SCALE, OFFSET, TARE, CALIBRATE, N_COLS };
+    static const char* const names[N_COLS] = {
+        "port", "hive_id", "bridge_mac", "hx_scale", "hx_offset", "tare", "calibrate_g",
+    };
+    int col[N_COLS];
+    bool have_header = false;
+    bool ok = true;
+    char buf[512];
+    int line = 0;
+
+    while (fgets(buf, sizeof(buf), f) != nullptr) {
+        line++;
+        std::string text = trim(buf);
+        if (text.empty() || text[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> fields = split_csv(text);
+
+        if (!have_header) {
+            for (int c = 0; c < N_COLS; c++) {
+                col[c] = -1;
+                for (size_t i = 0; i < fields.size(); i++) {
+                    if (fields[i] == names[c]) {
+                        col[c] = (int)i;
+                    }
+                }
+            }
+            if (col[PORT] < 0 || col[HIVE] < 0 || col[BRIDGE] < 0) {
+                fprintf(stderr, "%s:%d: header needs port, hive_id and bridge_mac\n", path, line);
+                ok = false;
+                break;
+            }
+            have_header = true;
+            continue;
+        }
+
+        auto field = [&](int c) -> std::string {
+            return (col[c] >= 0 && (size_t)col[c] < fields.size()) ? fields[col[c]] : std::string();
+        };
+        auto fail = [&](const char* what) {
+            fprintf(stderr, "%s:%d: %s\n", path, line, what);
+            ok = false;
+        };
+
+        Job j = Job();
+        j.line = line;
+        j.port = field(PORT);
+        double v;
+        if (j.port.empty()) {
+            fail("port is empty");
+            continue;
+        }
+        if (!parse_number(field(HIVE), &v) || v < 1 || v > 250 || v != floor(v)) {
+            fail("hive_id must be 1-250");
+            continue;
+        }
+        j.hive_id = (uint8_t)v;
+        if (!parse_mac(field(BRIDGE).c_str(), j.bridge_mac)) {
+            fail("bridge_mac must be AA:BB:CC:DD:EE:FF");
+            continue;
+        }
+        if (!field(SCALE).empty()) {
+            if (!parse_number(field(SCALE), &v) || v == 0.0) {
+                fail("hx_scale must be a non-zero number");
+                continue;
+            }
+            j.set_scale = true;
+            j.hx_scale = (float)v;
+        }
+        if (!field(OFFSET).empty()) {
+            if (!parse_number(field(OFFSET), &v) || v != floor(v) || fabs(v) > 2147483647.0) {
+                fail("hx_offset must be an integer");
+                continue;
+            }
+            j.set_offset = true;
+            j.hx_offset = (int32_t)v;
+        }
+        std::string tare = field(TARE);
+        if (tare != "" && tare != "0" && tare != "1") {
+            fail("tare must be 0 or 1");
+            continue;
+        }
+        j.tare = (tare == "1");
+        if (!field(CALIBRATE).empty()) {
+            if (!parse_number(field(CALIBRATE), &v) || v < 0) {
+                fail("calibrate_g must be a weight in grams");
+                continue;
+            }
+            j.calibrate_g = (float)v;
+        }
+
+        for (const Job& other : *jobs) {
+            if (other.port == j.port) {
+                fail("port listed twice");
+            } else if (other.hive_id == j.hive_id) {
+                fail("hive_id listed twice");
+            }
+        }
+        jobs->push_back(j);
+    }
+    fclose(f);
+
+    if (ok && jobs->empty()) {
+        fprintf(stderr, "%s: no nodes listed\n", path);
+        ok = false;
+    }
+    return ok;
+}
+
+// ---- Serial link ----
+
+static std::mutex s_print_lock;
+
+static void job_log(const Job& j, const char* fmt, ...) {
+    std::lock_guard<std::mutex> guard(s_print_lock);
+    fprintf(stderr, "[%s hive %u] ", j.port.c_str(), j.hive_id);
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
+
+struct Link {
+    int        fd = -1;
+    uint8_t    seq = 0;
+    ProvReader reader;
+
+    ~Link() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    bool open_port(const char* port, uint32_t baud) {
+        fd = open(port, O_RDWR | O_NOCTTY);
+        if (fd < 0) {
+            return false;
+        }
+        prov_reader_reset(&reader);
+        return host_tty_raw(fd, baud);
+    }
+
+    // Send one request and wait for its reply (matching cmd and seq).
+    // Anything else the node prints meanwhile is skipped.
+    bool transact(uint8_t cmd, const void* body, size_t len, ProvMessage* reply,
+                  uint32_t timeout_ms) {
+        ProvMessage req;
+        prov_message(&req, cmd, ++seq, 0, body, len);
+        uint8_t wire[PROV_MAX_WIRE];
+        size_t n = prov_encode(&req, wire);
+        if (!host_write_all(fd, wire, n)) {
+            return false;
+        }
+
+        uint64_t deadline = host_mono_ns() + (uint64_t)timeout_ms * 1000000ULL;
+        for (;;) {
+            uint64_t now = host_mono_ns();
+            if (now >= deadline) {
+                return false;
+            }
+            struct pollfd p = {fd, POLLIN, 0};
+            int r = poll(&p, 1, (int)((deadline - now + 999999ULL) / 1000000ULL));
+            if (r < 0 && errno != EINTR) {
+                return false;
+            }
+            if (r <= 0) {
+                continue;
+            }
+            uint8_t buf[256];
+            ssize_t got = read(fd, buf, sizeof(buf));
+            if (got <= 0) {
+                if (got < 0 && errno == EINTR) {
+                    continue;
+                }
+                return false;  // Port gone (board unplugged)
+            }
+            for (ssize_t i = 0; i < got; i++) {
+                if (prov_reader_push(&reader, buf[i], reply) == PROV_PUSH_MESSAGE &&
+                    reply->cmd == (cmd | PROV_REPLY) && reply->seq == seq) {
+                    return true;
+                }
+            }
+        }
+    }
+};
+
+static const char* status_name(uint8_t status) {
+    switch (status) {
+        case PROV_STATUS_OK:          return "ok";
+        case PROV_STATUS_UNKNOWN_CMD: return "unknown command";
+        case PROV_STATUS_BAD_ARG:     return "bad argument";
+        case PROV_STATUS_HX711:       return "HX711 not ready";
+        case PROV_STATUS_NO_WEIGHT:   return "no weight detected";
+        case PROV_STATUS_NVS:         return "NVS write failed";
+        case PROV_STATUS_VERIFY:      return "NVS read-back mismatch";
+        default:                      return "unknown status";
+    }
+}
+
+// ---- One node ----
+
+static bool fail(Job* j, const char* fmt, ...) {
+    char buf[160];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    j->error = buf;
+    return false;
+}
+
+static bool provision_node(Job* j, const Options& opt) {
+    Link link;
+    if (!link.open_port(j->port.c_str(), opt.baud)) {
+        return fail(j, "open: %s", strerror(errno));
+    }
+
+    // HELLO until the node answers (boot, or still in the text console)
+    ProvMessage reply;
+    uint64_t boot_deadline = host_mono_ns() + (uint64_t)opt.boot_ms * 1000000ULL;
+    bool hello = false;
+    while (!hello && host_mono_ns() < boot_deadline) {
+        hello = link.transact(PROV_CMD_HELLO, nullptr, 0, &reply, 500);
+    }
+    if (!hello) {
+        return fail(j, "no reply (node not in provisioning mode?)");
+    }
+    ProvHello h;
+    if (reply.len != sizeof(h)) {
+        return fail(j, "HELLO: unexpected reply length %u", reply.len);
+    }
+    memcpy(&h, reply.body, sizeof(h));
+    if (h.proto_version != PROV_PROTO_VERSION) {
+        return fail(j, "protocol version %u, expected %u", h.proto_version, PROV_PROTO_VERSION);
+    }
+    memcpy(j->node_mac, h.node_mac, 6);
+    j->have_node_mac = true;
+
+    // Every key in one write; the reply is what NVS now holds
+    ProvConfig want = h.config;
+    want.hive_id = j->hive_id;
+    want.bridge_mac_set = 1;
+    memcpy(want.bridge_mac, j->bridge_mac, 6);
+    if (j->set_scale) {
+        want.hx_scale = j->hx_scale;
+    }
+    if (j->set_offset) {
+        want.hx_offset = j->hx_offset;
+    }
+    if (!link.transact(PROV_CMD_WRITE_CONFIG, &want, sizeof(want), &reply, opt.reply_ms)) {
+        return fail(j, "WRITE_CONFIG: no reply");
+    }
+    if (reply.status != PROV_STATUS_OK) {
+        return fail(j, "WRITE_CONFIG: %s", status_name(reply.status));
+    }
+    if (reply.len != sizeof(want) || memcmp(reply.body, &want, sizeof(want)) != 0) {
+        return fail(j, "WRITE_CONFIG: read-back differs");
+    }
+
+    uint32_t sampling_ms = (uint32_t)opt.samples * HX711_SAMPLE_MS;
+    if (j->tare) {
+        job_log(*j, "taring (scale must be empty)");
+        ProvTareArgs args = {opt.settle_ms, opt.samples};
+        if (!link.transact(PROV_CMD_TARE, &args, sizeof(args), &reply,
+                           opt.settle_ms + sampling_ms + opt.reply_ms)) {
+            return fail(j, "TARE: no reply");
+        }
+        if (reply.status != PROV_STATUS_OK || reply.len != sizeof(int32_t)) {
+            return fail(j, "TARE: %s", status_name(reply.status));
+        }
+        memcpy(&want.hx_offset, reply.body, sizeof(int32_t));
+    }
+    if (j->calibrate_g > 0.0f) {
+        job_log(*j, "calibrating: place %.1f g within %.1f s", j->calibrate_g,
+                opt.place_ms / 1000.0);
+        ProvCalibrateArgs args = {j->calibrate_g, opt.place_ms, opt.samples};
+        if (!link.transact(PROV_CMD_CALIBRATE, &args, sizeof(args), &reply,
+                           opt.place_ms + sampling_ms + opt.reply_ms)) {
+            return fail(j, "CALIBRATE: no reply");
+        }
+        if (reply.status != PROV_STATUS_OK || reply.len != sizeof(float)) {
+            return fail(j, "CALIBRATE: %s", status_name(reply.status));
+        }
+        memcpy(&want.hx_scale, reply.body, sizeof(float));
+    }
+
+    // Final check of everything the node will boot with
+    if (!link.transact(PROV_CMD_READ_CONFIG, nullptr, 0, &reply, opt.reply_ms) ||
+        reply.len != sizeof(ProvConfig)) {
+        return fail(j, "READ_CONFIG: no reply");
+    }
+    memcpy(&j->final_config, reply.body, sizeof(ProvConfig));
+    if (memcmp(&j->final_config, &want, sizeof(want)) != 0) {
+        return fail(j, "final config differs from what was written");
+    }
+
+    if (opt.reboot && !link.transact(PROV_CMD_REBOOT, nullptr, 0, &reply, opt.reply_ms)) {
+        return fail(j, "REBOOT: no reply");
+    }
+    return true;
+}
+
+static void run_job(Job* j, const Options& opt) {
+    uint64_t t0 = host_mono_ns();
+    j->ok = provision_node(j, opt);
+    j->seconds = (host_mono_ns() - t0) / 1e9;
+    if (j->ok) {
+        job_log(*j, "done in %.1f s", j->seconds);
+    } else {
+        job_log(*j, "FAILED: %s", j->error.c_str());
+    }
+}
+
+// ---- Main ----
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s MANIFEST.csv [options]\n"
+        "  --baud N           serial speed (default 115200)\n"
+        "  --boot-ms N        wait for each node to answer (default 10000)\n"
+        "  --reply-ms N       reply timeout per request (default 2000)\n"
+        "  --settle-ms N      wait before taring (default 2000)\n"
+        "  --place-ms N       time to place the calibration weight (default 10000)\n"
+        "  --samples N        HX711 readings averaged, 1-100 (default 20)\n"
+        "  --reboot           restart each node once provisioned\n",
+        argv0);
+    exit(2);
+}
+
+static void parse_args(int argc, char** argv, Options* opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strcmp(a, "--reboot") == 0) {
+            opt->reboot = true;
+            continue;
+        }
+        if (a[0] != '-') {
+            if (opt->manifest != nullptr) {
+                usage(argv[0]);
+            }
+            opt->manifest = a;
+            continue;
+        }
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (v == nullptr) {
+            usage(argv[0]);
+        }
+        i++;
+        long n = atol(v);
+        if (strcmp(a, "--baud") == 0)              opt->baud = (uint32_t)n;
+        else if (strcmp(a, "--boot-ms") == 0)      opt->boot_ms = (uint32_t)n;
+        else if (strcmp(a, "--reply-ms") == 0)     opt->reply_ms = (uint32_t)n;
+        else if (strcmp(a, "--settle-ms") == 0 && n >= 0 && n <= 65535) opt->settle_ms = (uint16_t)n;
+        else if (strcmp(a, "--place-ms") == 0 && n >= 0 && n <= 65535)  opt->place_ms = (uint16_t)n;
+        else if (strcmp(a, "--samples") == 0 && n >= 1 && n <= 100)     opt->samples = (uint8_t)n;
+        else usage(argv[0]);
+    }
+    if (opt->manifest == nullptr || opt->reply_ms == 0) {
+        usage(argv[0]);
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    parse_args(argc, argv, &opt);
+
+    std::vector<Job> jobs;
+    if (!load_manifest(opt.manifest, &jobs)) {
+        return 2;
+    }
+    fprintf(stderr, "provisioning %zu node(s)\n", jobs.size());
+
+    std::vector<std::thread> threads;
+    for (Job& j : jobs) {
+        threads.emplace_back(run_job, &j, std::cref(opt));
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    int failed = 0;
+    printf("%-16s %-17s %4s %-17s %11s %11s %6s  %s\n", "port", "node_mac", "hive",
+           "bridge_mac", "hx_offset", "hx_scale", "secs", "result");
+    for (const Job& j : jobs) {
+        char node[18] = "-", bridge[18];
+        if (j.have_node_mac) {
+            snprintf(node, sizeof(node), "%02X:%02X:%02X:%02X:%02X:%02X", j.node_mac[0],
+                     j.node_mac[1], j.node_mac[2], j.node_mac[3], j.node_mac[4], j.node_mac[5]);
+        }
+        snprintf(bridge, sizeof(bridge), "%02X:%02X:%02X:%02X:%02X:%02X", j.bridge_mac[0],
+                 j.bridge_mac[1], j.bridge_mac[2], j.bridge_mac[3], j.bridge_mac[4],
+                 j.bridge_mac[5]);
+        if (j.ok) {
+            printf("%-16s %-17s %4u %-17s %11ld %11.4f %6.1f  ok\n", j.port.c_str(), node,
+                   j.hive_id, bridge, (long)j.final_config.hx_offset, j.final_config.hx_scale,
+                   j.seconds);
+        } else {
+            printf("%-16s %-17s %4u %-17s %11s %11s %6.1f  FAILED: %s\n", j.port.c_str(), node,
+                   j.hive_id, bridge, "-", "-", j.seconds, j.error.c_str());
+            failed++;
+        }
+    }
+    printf("%zu provisioned, %d failed\n", jobs.size() - failed, failed);
+    return failed ? 1 : 0;
+}
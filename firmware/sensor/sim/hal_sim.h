@@ -0,0 +1,649 @@
+// Waggle Sensor Node — Linux simulation HAL backend.
+//
+// Runs the real wake cycle (node.h) and the real pure modules (bee
+// counter state machine, activity trigger, payload builder) on the host
+// against a simulated board:
+//
+//   virtual time   a 64-bit microsecond clock; millis() wraps at 2^32 ms
+//                  exactly like the ESP32.  Delays, sensor reads, radio
+//                  attempts and light sleep advance it; nothing waits.
+//   beam edges     a time-ordered queue of GPIO edges, delivered as the
+//                  beam ISRs would (including while light sleeping),
+//                  from scripted transits and/or a diurnal traffic model
+//   sensors        HX711 / BME280 / battery values from a script callback
+//   thermal array  an optional chain of DS18B20 probes across the brood
+//                  nest; conversion time runs on the virtual clock
+//   ESP-NOW        delivery with configurable loss, mirroring the retry
+//                  loop in comms_send() and the single attempt of
+//                  comms_send_once(); delivered frames go to a sink
+//   GPIO           output levels are kept per pin; rising edges on the
+//                  camera wake line are counted
+//   power          time is accounted to the power.h states as the ESP32
+//                  build would spend it, with or without power
+//                  management, for the per-cycle average current
+//
+// Header-only and free of globals, so several simulated nodes can run in
+// one process.  Used by sim/sim_main.cpp and test/test_node_sim.
+
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <queue>
+#include <vector>
+
+#include "../src/hal.h"
+#include "../src/config.h"
+#include "../src/onewire.h"
+#include "../src/payload.h"
+#include "../src/tunnel_config.h"
+
+#define SIM_NUM_PINS 40
+
+// ── Virtual costs of hardware operations (microseconds) ──────────────
+#define SIM_COST_SENSORS_INIT_US   5000     // HX711 ready + BME280 probe
+#define SIM_COST_WEIGHT_US         450000   // get_units(5) at 10 SPS
+#define SIM_COST_BME280_US         10000    // Forced-mode measurement
+#define SIM_COST_ADC_US            100
+#define SIM_COST_RADIO_INIT_US     20000    // WiFi STA + ESP-NOW bring-up
+#define SIM_COST_RADIO_TX_US       2000     // Send + delivery callback
+
+// DS18B20 chain over the RMT 1-Wire backend (70 µs slots): the first
+// wake's ROM search (~192 slots per probe), then every wake one reset
+// plus SKIP ROM / CONVERT T, and per probe a reset, MATCH ROM and a
+// 9-byte scratchpad read.  The waits inside the RMT driver hold the
+// busy lock; the rest of the 750 ms conversion is a power_wait_ms().
+#define SIM_COST_THERMAL_SEARCH_US 14500    // Per probe, first wake only
+#define SIM_COST_THERMAL_START_US  2500
+#define SIM_COST_THERMAL_PROBE_US  12500
+
+// Part of SIM_COST_WEIGHT_US spent blocked in power_wait_ms() between
+// HX711 conversions; the rest (shift-out, polls) runs with the busy lock.
+// Other waits happen inside libraries with the lock held.
+#define SIM_WAIT_WEIGHT_US         447500
+
+// Values the sensor script provides for the current instant.
+struct SimReadings {
+    float    weight_g;
+    float    temp_c;
+    float    humidity_pct;
+    float    pressure_hpa;
+    uint16_t battery_mv;
+    bool     hx711_ok;
+    bool     bme280_ok;
+};
+
+typedef void (*SimSensorScript)(void* ctx, uint64_t now_ms, SimReadings* out);
+
+// Called for every ESP-NOW frame the bridge acknowledges.
+typedef void (*SimFrameSink)(void* ctx, uint64_t now_ms, const uint8_t* data, size_t len);
+
+// Default script: 40 kg hive losing ~0.5 kg to foragers by mid-afternoon,
+// 15 ± 8 °C diurnal temperature, steady humidity and pressure, battery
+// draining 2 mV per day from 4100 mV.
+inline void sim_default_script(void* ctx, uint64_t now_ms, SimReadings* out) {
+    (void)ctx;
+    const double day_ms = 86400000.0;
+    double day_frac = fmod((double)now_ms, day_ms) / day_ms;
+    double sun = sin((day_frac - 0.25) * 2.0 * M_PI);  // 1 at noon, -1 at midnight
+    out->weight_g     = (float)(40000.0 - 250.0 * (sun > 0 ? sun : 0));
+    out->temp_c       = (float)(15.0 + 8.0 * sun);
+    out->humidity_pct = 60.0f;
+    out->pressure_hpa = 1013.2f;
+    double mv = 4100.0 - 2.0 * (double)now_ms / day_ms;
+    out->battery_mv   = (uint16_t)(mv > 0 ? mv : 0);
+    out->hx711_ok     = true;
+    out->bme280_ok    = true;
+}
+
+class SimHal : public Hal<SimHal> {
+    friend class Hal<SimHal>;
+
+public:
+    SimHal()
+        : now_us_(0), sleep_us_(0), wakes_(0), rng_(0x9E3779B9u),
+          hive_id_(1), configured_(true), power_on_reset_(true),
+          script_(sim_default_script), script_ctx_(nullptr),
+          sink_(nullptr), sink_ctx_(nullptr), radio_loss_pct_(0),
+          lane_mask_(0), last_snapshot_ms_(0),
+          trigger_enabled_(false), trigger_pin_(0),
+          peak_per_min_(0), in_pct_(50), gen_next_us_(0),
+          frames_sent_(0), frames_lost_(0), send_attempts_(0),
+          wake_line_rises_(0), injected_in_(0), injected_out_(0),
+          hx711_ok_(false), bme280_ok_(false),
+          thermal_probes_(0), brood_c_(34.5f), thermal_searched_(false), thermal_convert_us_(0),
+          pm_(true), busy_depth_(0), radio_on_(false), sleeps_while_busy_(0) {
+        static const uint8_t default_mac[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x01};
+        memcpy(bridge_mac_, default_mac, 6);
+        memset(pins_, 0, sizeof(pins_));
+        memset(lanes_, 0, sizeof(lanes_));
+        memset(&trigger_, 0, sizeof(trigger_));
+        memset(last_frame_, 0, sizeof(last_frame_));
+        memset(&cycle_profile_, 0, sizeof(cycle_profile_));
+        memset(&run_profile_, 0, sizeof(run_profile_));
+    }
+
+    // ── Scenario setup ──
+
+    void set_seed(uint32_t seed) { rng_ = seed ? seed : 1; }
+
+    // Provisioned values; configured = false simulates an empty NVS.
+    void set_provisioning(uint8_t hive_id, const uint8_t* bridge_mac, bool configured) {
+        hive_id_ = hive_id;
+        memcpy(bridge_mac_, bridge_mac, 6);
+        configured_ = configured;
+    }
+
+    void set_sensor_script(SimSensorScript script, void* ctx) {
+        script_ = script;
+        script_ctx_ = ctx;
+    }
+
+    void set_frame_sink(SimFrameSink sink, void* ctx) {
+        sink_ = sink;
+        sink_ctx_ = ctx;
+    }
+
+    // Percentage of ESP-NOW attempts that are not acknowledged.
+    void set_radio_loss_pct(uint8_t pct) { radio_loss_pct_ = pct; }
+
+    // DS18B20 probes on the 1-Wire bus (default 0: no thermal array).
+    // Readings model the brood nest: brood_c at the middle of the chain,
+    // falling towards the script's ambient temperature at both ends.
+    void set_thermal_probes(uint8_t count, float brood_c) {
+        thermal_probes_ = count > THERMAL_MAX_PROBES ? THERMAL_MAX_PROBES : count;
+        brood_c_ = brood_c;
+        thermal_searched_ = false;
+    }
+
+    // true (default): DFS and automatic light sleep, as with
+    // POWER_MANAGEMENT; false: fixed 240 MHz while awake.
+    void set_power_management(bool on) { pm_ = on; }
+
+    // Diurnal traffic model: transits arrive as a Poisson process whose
+    // rate follows the sun, peaking at peak_per_min at noon and zero
+    // between 18:00 and 06:00.  in_pct percent are inbound.
+    void set_traffic(uint32_t peak_per_min, uint8_t in_pct) {
+        peak_per_min_ = peak_per_min;
+        in_pct_ = in_pct;
+        gen_next_us_ = now_us_;
+    }
+
+    // Queue one beam edge (beam_b = false for the outer beam A).
+    void schedule_edge(uint64_t at_ms, uint8_t lane, bool beam_b) {
+        SimEdge e = {at_ms * 1000ULL, lane, beam_b};
+        edges_.push(e);
+    }
+
+    // Queue a full transit: the first beam at at_ms, the second beam
+    // transit_ms later (A→B inbound, B→A outbound).
+    void schedule_transit(uint64_t at_ms, uint8_t lane, bool inbound, uint32_t transit_ms) {
+        schedule_edge(at_ms, lane, !inbound);
+        schedule_edge(at_ms + transit_ms, lane, inbound);
+        if (inbound) {
+            injected_in_++;
+        } else {
+            injected_out_++;
+        }
+    }
+
+    // ── Inspection ──
+
+    uint64_t now_us() const          { return now_us_; }
+    uint64_t now_ms() const          { return now_us_ / 1000ULL; }
+    uint64_t asleep_us() const       { return sleep_us_; }
+    uint64_t awake_us() const        { return now_us_ - sleep_us_; }
+    uint64_t wakes() const           { return wakes_; }
+    uint64_t frames_sent() const     { return frames_sent_; }
+    uint64_t frames_lost() const     { return frames_lost_; }
+    uint64_t send_attempts() const   { return send_attempts_; }
+    uint64_t wake_line_rises() const { return wake_line_rises_; }
+    uint64_t injected_in() const     { return injected_in_; }
+    uint64_t injected_out() const    { return injected_out_; }
+    uint64_t sleeps_while_busy() const { return sleeps_while_busy_; }
+    const PowerProfile& run_profile() const { return run_profile_; }
+    bool     pin_level(uint8_t pin) const { return pin < SIM_NUM_PINS && pins_[pin]; }
+    const uint8_t* last_frame() const { return last_frame_; }
+
+private:
+    struct SimEdge {
+        uint64_t at_us;
+        uint8_t  lane;
+        bool     beam_b;
+    };
+
+    struct EdgeLater {
+        bool operator()(const SimEdge& a, const SimEdge& b) const { return a.at_us > b.at_us; }
+    };
+
+    // ── Virtual clock ──
+
+    uint32_t random_u32() {
+        // xorshift32
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 17;
+        rng_ ^= rng_ << 5;
+        return rng_;
+    }
+
+    double random_unit() {
+        return (random_u32() + 1.0) / 4294967297.0;  // (0, 1)
+    }
+
+    // Generate model traffic up to until_us into the edge queue.
+    void generate_traffic(uint64_t until_us) {
+        if (peak_per_min_ == 0) {
+            return;
+        }
+        const uint64_t day_us = 86400000000ULL;
+        while (gen_next_us_ <= until_us) {
+            double day_frac = (double)(gen_next_us_ % day_us) / (double)day_us;
+            double sun = sin((day_frac - 0.25) * 2.0 * M_PI);
+            if (sun <= 0) {
+                gen_next_us_ += 60000000ULL;  // Night: no flights, step a minute
+                continue;
+            }
+            double per_us = peak_per_min_ * sun / 60e6;
+            uint64_t at_ms = gen_next_us_ / 1000ULL;
+            uint8_t lane = (uint8_t)(random_u32() % NUM_CHANNELS);
+            bool inbound = (random_u32() % 100) < in_pct_;
+            uint32_t transit_ms = 20 + random_u32() % 60;
+            schedule_transit(at_ms, lane, inbound, transit_ms);
+            gen_next_us_ += (uint64_t)(-log(random_unit()) / per_us) + 1;
+        }
+    }
+
+    // Deliver every queued edge up to t_us in order, then set the clock.
+    void advance_to(uint64_t t_us) {
+        generate_traffic(t_us);
+        while (!edges_.empty() && edges_.top().at_us <= t_us) {
+            SimEdge e = edges_.top();
+            edges_.pop();
+            if (e.at_us > now_us_) {
+                now_us_ = e.at_us;
+            }
+            beam_isr(e.lane, e.beam_b);
+        }
+        if (t_us > now_us_) {
+            now_us_ = t_us;
+        }
+    }
+
+    void advance_us(uint64_t us) { advance_to(now_us_ + us); }
+
+    // ── Power accounting (mirrors power.cpp) ──
+
+    PowerState awake_state(bool waiting) const {
+        if (radio_on_) {
+            return POWER_RADIO;
+        }
+        if (!pm_) {
+            return POWER_ACTIVE;
+        }
+        if (waiting) {
+            return POWER_SLEEP;
+        }
+        return (busy_depth_ > 0) ? POWER_ACTIVE : POWER_IDLE;
+    }
+
+    void account(PowerState state, uint64_t us) {
+        cycle_profile_.us[state] += us;
+        run_profile_.us[state] += us;
+    }
+
+    // Run for cpu_us, then block for wait_us.
+    void spend(uint64_t cpu_us, uint64_t wait_us) {
+        account(awake_state(false), cpu_us);
+        account(awake_state(true), wait_us);
+        advance_us(cpu_us + wait_us);
+    }
+
+    // Same work as DEFINE_ISR_A / DEFINE_ISR_B in bee_counter.cpp.
+    void beam_isr(uint8_t ch, bool beam_b) {
+        if (ch >= NUM_CHANNELS || !(lane_mask_ & (1 << ch))) {
+            return;  // Interrupt not attached
+        }
+        uint32_t now = millis_impl();
+        LaneData* lane = &lanes_[ch];
+        bool counted;
+        if (beam_b) {
+            uint32_t before = lane->bees_in;
+            lane_beam_b_event(lane, now);
+            counted = (lane->bees_in != before);
+        } else {
+            uint32_t before = lane->bees_out;
+            lane_beam_a_event(lane, now);
+            counted = (lane->bees_out != before);
+        }
+        if (counted && trigger_enabled_ &&
+            activity_trigger_record(&trigger_, now, beam_b)) {
+            gpio_write_impl(trigger_pin_, true);
+        }
+    }
+
+    // ── Time and power ──
+
+    uint32_t millis_impl()              { return (uint32_t)(now_us_ / 1000ULL); }
+    void     delay_ms_impl(uint32_t ms) { spend(0, (uint64_t)ms * 1000ULL); }
+
+    void light_sleep_us_impl(uint64_t us) {
+        if (busy_depth_ > 0) {
+            sleeps_while_busy_++;
+        }
+        account(POWER_SLEEP, us);
+        advance_us(us);
+        sleep_us_ += us;
+        wakes_++;
+    }
+
+    void power_init_impl() {}
+
+    void cpu_busy_impl(bool busy) {
+        if (busy) {
+            busy_depth_++;
+        } else if (busy_depth_ > 0) {
+            busy_depth_--;
+        }
+    }
+
+    PowerProfile power_profile_impl(bool reset) {
+        PowerProfile p = cycle_profile_;
+        if (reset) {
+            memset(&cycle_profile_, 0, sizeof(cycle_profile_));
+        }
+        return p;
+    }
+
+    // Light sleep never resets the chip, so the reset reason stays
+    // POWERON for the whole run, as on hardware.
+    bool first_boot_impl() { return power_on_reset_; }
+
+    // ── GPIO ──
+
+    void gpio_output_impl(uint8_t pin) { (void)pin; }
+
+    void gpio_write_impl(uint8_t pin, bool high) {
+        if (pin >= SIM_NUM_PINS) {
+            return;
+        }
+        if (high && !pins_[pin] && trigger_enabled_ && pin == trigger_pin_) {
+            wake_line_rises_++;
+        }
+        pins_[pin] = high;
+    }
+
+    // ── Sensors (mirror sensors.cpp error handling and scaling) ──
+
+    SimReadings read_script() {
+        SimReadings r;
+        script_(script_ctx_, now_ms(), &r);
+        return r;
+    }
+
+    uint8_t sensors_init_impl() {
+        spend(SIM_COST_SENSORS_INIT_US, 0);
+        SimReadings r = read_script();
+        hx711_ok_ = r.hx711_ok;
+        bme280_ok_ = r.bme280_ok;
+        uint8_t flags = 0;
+        if (!hx711_ok_) {
+            flags |= FLAG_HX711_ERROR;
+        }
+        if (!bme280_ok_) {
+            flags |= FLAG_BME280_ERROR;
+        }
+        return flags;
+    }
+
+    int32_t read_weight_g_impl(uint8_t* flags) {
+        spend(SIM_COST_WEIGHT_US - SIM_WAIT_WEIGHT_US, SIM_WAIT_WEIGHT_US);
+        SimReadings r = read_script();
+        if (!hx711_ok_ || !r.hx711_ok) {
+            *flags |= FLAG_HX711_ERROR;
+            return 0;
+        }
+        return (int32_t)r.weight_g;
+    }
+
+    int16_t read_temperature_x100_impl(uint8_t* flags) {
+        spend(SIM_COST_BME280_US, 0);
+        SimReadings r = read_script();
+        if (!bme280_ok_ || !r.bme280_ok || isnan(r.temp_c)) {
+            *flags |= FLAG_BME280_ERROR;
+            return 0;
+        }
+        return (int16_t)(r.temp_c * 100.0f);
+    }
+
+    uint16_t read_humidity_x100_impl(uint8_t* flags) {
+        SimReadings r = read_script();
+        if (!bme280_ok_ || !r.bme280_ok || isnan(r.humidity_pct)) {
+            *flags |= FLAG_BME280_ERROR;
+            return 0;
+        }
+        return (uint16_t)(r.humidity_pct * 100.0f);
+    }
+
+    uint16_t read_pressure_x10_impl(uint8_t* flags) {
+        SimReadings r = read_script();
+        if (!bme280_ok_ || !r.bme280_ok || isnan(r.pressure_hpa)) {
+            *flags |= FLAG_BME280_ERROR;
+            return 0;
+        }
+        return (uint16_t)(r.pressure_hpa * 10.0f);
+    }
+
+    uint16_t read_battery_mv_impl() {
+        spend(SIM_COST_ADC_US, 0);
+        return read_script().battery_mv;
+    }
+
+    // ── Thermal array (mirrors thermal.cpp) ──
+
+    uint8_t thermal_start_impl() {
+        if (thermal_probes_ == 0) {
+            return 0;  // One reset pulse without presence; not worth modelling
+        }
+        if (!thermal_searched_) {
+            spend((uint64_t)SIM_COST_THERMAL_SEARCH_US * thermal_probes_, 0);
+            thermal_searched_ = true;
+        }
+        spend(SIM_COST_THERMAL_START_US, 0);
+        thermal_convert_us_ = now_us_;
+        return thermal_probes_;
+    }
+
+    void thermal_collect_impl(ThermalReading* out) {
+        uint64_t ready_us = thermal_convert_us_ + (uint64_t)DS18B20_CONVERT_MS * 1000ULL;
+        if (now_us_ < ready_us) {
+            spend(0, ready_us - now_us_);
+        }
+        float ambient = read_script().temp_c;
+        float mid = (thermal_probes_ - 1) / 2.0f;
+        out->count = thermal_probes_;
+        out->flags = 0;
+        for (uint8_t i = 0; i < THERMAL_MAX_PROBES; i++) {
+            if (i >= thermal_probes_) {
+                out->temp_x16[i] = THERMAL_NO_READING;
+                continue;
+            }
+            spend(SIM_COST_THERMAL_PROBE_US, 0);
+            float x = (mid > 0) ? (i - mid) / mid : 0.0f;  // -1 .. 1 across the nest
+            float c = ambient + (brood_c_ - ambient) * expf(-2.0f * x * x);
+            out->temp_x16[i] = (int16_t)lroundf(c * 16.0f);
+        }
+    }
+
+    // ── ESP-NOW radio ──
+
+    bool radio_init_impl(const uint8_t* bridge_mac) {
+        (void)bridge_mac;
+        radio_on_ = true;
+        spend(SIM_COST_RADIO_INIT_US, 0);
+        return true;
+    }
+
+    void radio_deinit_impl() { radio_on_ = false; }
+
+    // One transmission; true if the bridge acknowledged it.
+    bool radio_attempt(const uint8_t* data, size_t len) {
+        send_attempts_++;
+        spend(0, SIM_COST_RADIO_TX_US);
+        if ((random_u32() % 100) < radio_loss_pct_) {
+            return false;
+        }
+        frames_sent_++;
+        memcpy(last_frame_, data, len < sizeof(last_frame_) ? len : sizeof(last_frame_));
+        if (sink_ != nullptr) {
+            sink_(sink_ctx_, now_ms(), data, len);
+        }
+        return true;
+    }
+
+    // Same attempt/retry schedule as comms_send().
+    bool radio_send_impl(const uint8_t* data, size_t len) {
+        for (int attempt = 1; attempt <= ESPNOW_MAX_RETRIES; attempt++) {
+            if (radio_attempt(data, len)) {
+                return true;
+            }
+            if (attempt < ESPNOW_MAX_RETRIES) {
+                spend(0, (uint64_t)ESPNOW_RETRY_MS * 1000ULL);
+            }
+        }
+        frames_lost_++;
+        return false;
+    }
+
+    // comms_send_reading(): radio_send_impl() with the latency trace
+    // stamped before each attempt.
+    bool radio_send_reading_impl(bee_count_payload_t* p, uint32_t capture_ms) {
+        uint32_t first_ms = millis_impl();
+        for (int attempt = 1; attempt <= ESPNOW_MAX_RETRIES; attempt++) {
+            uint32_t now = millis_impl();
+            payload_stamp_trace(p, first_ms - capture_ms, now - first_ms, (uint8_t)attempt);
+            if (radio_attempt((const uint8_t*)p, PAYLOAD_SIZE_V2)) {
+                return true;
+            }
+            if (attempt < ESPNOW_MAX_RETRIES) {
+                spend(0, (uint64_t)ESPNOW_RETRY_MS * 1000ULL);
+            }
+        }
+        frames_lost_++;
+        return false;
+    }
+
+    // comms_send_once(): a single attempt.
+    bool radio_send_once_impl(const uint8_t* data, size_t len) {
+        if (radio_attempt(data, len)) {
+            return true;
+        }
+        frames_lost_++;
+        return false;
+    }
+
+    // ── Provisioning (the console is not simulated) ──
+
+    void           provision_check_impl()         {}
+    void           provision_load_impl()          {}
+    uint8_t        provision_hive_id_impl()       { return hive_id_; }
+    const uint8_t* provision_bridge_mac_impl()    { return bridge_mac_; }
+    bool           provision_is_configured_impl() { return configured_ && hive_id_ != 0; }
+
+    // ── Bee counter ──
+
+    void bee_counter_init_impl(uint8_t lane_mask) {
+        lane_mask_ = lane_mask;
+        last_snapshot_ms_ = millis_impl();
+        memset(lanes_, 0, sizeof(lanes_));
+    }
+
+    BeeCountSnapshot bee_counter_snapshot_impl() {
+        uint32_t now = millis_impl();
+        BeeCountSnapshot snap = lanes_collect(lanes_, lane_mask_, now, last_snapshot_ms_);
+        last_snapshot_ms_ = now;
+        return snap;
+    }
+
+    // ── Activity trigger ──
+
+    void activity_trigger_begin_impl(uint8_t pin, const ActivityTriggerConfig* cfg) {
+        trigger_pin_ = pin;
+        gpio_write_impl(pin, false);
+        activity_trigger_init(&trigger_, cfg);
+        trigger_enabled_ = true;
+    }
+
+    uint32_t activity_trigger_service_impl() {
+        if (!trigger_enabled_) {
+            return 0;
+        }
+        uint32_t now = millis_impl();
+        if (activity_trigger_poll(&trigger_, now)) {
+            gpio_write_impl(trigger_pin_, false);
+        }
+        return activity_trigger_release_in_ms(&trigger_, now);
+    }
+
+    uint32_t activity_trigger_count_impl()       { return trigger_.fire_count; }
+    uint8_t  activity_trigger_last_reason_impl() { return trigger_.reason; }
+
+    // ── State ──
+
+    uint64_t now_us_;
+    uint64_t sleep_us_;
+    uint64_t wakes_;
+    uint32_t rng_;
+
+    uint8_t  hive_id_;
+    uint8_t  bridge_mac_[6];
+    bool     configured_;
+    bool     power_on_reset_;
+
+    SimSensorScript script_;
+    void*           script_ctx_;
+    SimFrameSink    sink_;
+    void*           sink_ctx_;
+    uint8_t         radio_loss_pct_;
+
+    bool     pins_[SIM_NUM_PINS];
+    LaneData lanes_[NUM_CHANNELS];
+    uint8_t  lane_mask_;
+    uint32_t last_snapshot_ms_;
+
+    ActivityTrigger trigger_;
+    bool     trigger_enabled_;
+    uint8_t  trigger_pin_;
+
+    std::priority_queue<SimEdge, std::vector<SimEdge>, EdgeLater> edges_;
+    uint32_t peak_per_min_;
+    uint8_t  in_pct_;
+    uint64_t gen_next_us_;
+
+    uint64_t frames_sent_;
+    uint64_t frames_lost_;
+    uint64_t send_attempts_;
+    uint64_t wake_line_rises_;
+    uint64_t injected_in_;
+    uint64_t injected_out_;
+    uint8_t  last_frame_[PAYLOAD_SIZE_V2];
+
+    bool     hx711_ok_;
+    bool     bme280_ok_;
+
+    uint8_t  thermal_probes_;
+    float    brood_c_;
+    bool     thermal_searched_;
+    uint64_t thermal_convert_us_;
+
+    bool         pm_;
+    uint32_t     busy_depth_;
+    bool         radio_on_;
+    uint64_t     sleeps_while_busy_;
+    PowerProfile cycle_profile_;
+    PowerProfile run_profile_;
+};
+
+#endif // HAL_SIM_H
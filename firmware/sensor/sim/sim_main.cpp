@@ -0,0 +1,261 @@
+// Waggle Sensor Node — Host simulator for the full wake cycle.
+//
+// Runs SensorNode<SimHal> — the same wake cycle main.cpp runs on the
+// ESP32 — for a number of simulated days in virtual time and prints a
+// summary: wakes, frames delivered and lost, bees injected versus
+// counted, camera wake line assertions, time spent awake and the average
+// supply current from the power profile.  The frame sink runs the
+// bridge's FEC decoder, so payloads rebuilt from parity count as
+// delivered.
+//
+// Build and run:
+//   pio run -e sim && .pio/build/sim/program --days 365 --traffic 120
+//   pio run -e sim && .pio/build/sim/program --sweep --fec 4
+//
+// Options:
+//   --days N        simulated days (default 30)
+//   --traffic N     peak transits per minute at noon (default 60, 0 = none)
+//   --in-pct N      share of inbound transits in percent (default 50)
+//   --loss N        ESP-NOW attempt loss in percent (default 0)
+//   --seed N        PRNG seed (default 1)
+//   --probes N      DS18B20 probes on the thermal array (default 0)
+//   --fec K         send once plus parity every K payloads (default
+//                   UPLINK_FEC_GROUP; 0 = acknowledged with retries)
+//   --sweep         compare retries against --fec K (default 4) across
+//                   loss rates: delivery, radio time and charge per reading
+//   --no-pm         fixed 240 MHz while awake (POWER_MANAGEMENT 0)
+//   --csv FILE      write every delivered payload as a CSV row
+//   --verbose       print firmware log lines (slow)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "../src/node.h"
+#include "hal_sim.h"
+
+struct SinkState {
+    FILE*      csv;
+    uint64_t   readings;    // Payloads received or rebuilt
+    uint64_t   recovered;   // ... of which rebuilt from parity
+    uint64_t   bees_in;
+    uint64_t   bees_out;
+    uint64_t   crc_errors;
+    uint64_t   first_boot_flags;
+    uint64_t   thermals;    // Thermal array payloads received
+    FecDecoder fec;
+};
+
+static void on_reading(SinkState* s, uint64_t now_ms, const bee_count_payload_t& p) {
+    s->readings++;
+    if (crc8((const uint8_t*)&p, 17) != p.crc) {
+        s->crc_errors++;
+    }
+    s->bees_in  += p.bees_in;
+    s->bees_out += p.bees_out;
+    if (p.flags & FLAG_FIRST_BOOT) {
+        s->first_boot_flags++;
+    }
+    if (s->csv != nullptr) {
+        fprintf(s->csv, "%.3f,%u,%u,%d,%d,%u,%u,%u,0x%02X,%u,%u,%u,0x%02X\n",
+                now_ms / 1000.0, p.hive_id, p.sequence, p.weight_g, p.temp_c_x100,
+                p.humidity_x100, p.pressure_hpa_x10, p.battery_mv, p.flags,
+                p.bees_in, p.bees_out, p.period_ms, p.stuck_mask);
+    }
+}
+
+static void on_frame(void* ctx, uint64_t now_ms, const uint8_t* data, size_t len) {
+    SinkState* s = (SinkState*)ctx;
+    if (len == sizeof(parity_payload_t)) {
+        parity_payload_t parity;
+        memcpy(&parity, data, sizeof(parity));
+        bee_count_payload_t rebuilt;
+        if (fec_decoder_recover(&s->fec, &parity, &rebuilt) == FEC_RECOVERED) {
+            s->recovered++;
+            on_reading(s, now_ms, rebuilt);
+        }
+        return;
+    }
+    if (len == sizeof(thermal_payload_t)) {
+        s->thermals++;
+        return;
+    }
+    if (len != sizeof(bee_count_payload_t)) {
+        return;
+    }
+    bee_count_payload_t p;
+    memcpy(&p, data, sizeof(p));
+    fec_decoder_note(&s->fec, &p);
+    on_reading(s, now_ms, p);
+}
+
+struct SimOptions {
+    uint32_t days;
+    uint32_t traffic;
+    uint32_t in_pct;
+    uint32_t loss;
+    uint32_t seed;
+    uint32_t fec;
+    uint32_t probes;
+    bool     pm;
+};
+
+// Run one node on `hal` for opt.days of virtual time.
+static void run(const SimOptions& opt, SinkState* sink, SimHal* hal) {
+    hal->set_seed(opt.seed);
+    hal->set_traffic(opt.traffic, (uint8_t)opt.in_pct);
+    hal->set_radio_loss_pct((uint8_t)opt.loss);
+    hal->set_power_management(opt.pm);
+    hal->set_thermal_probes((uint8_t)opt.probes, 34.5f);
+    hal->set_frame_sink(on_frame, sink);
+
+    uint16_t sequence = 0;
+    SensorNode<SimHal> node(*hal, &sequence, (uint8_t)opt.fec);
+
+    const uint64_t end_us = (uint64_t)opt.days * 86400000000ULL;
+    while (hal->now_us() < end_us) {
+        node.wake();
+    }
+}
+
+// Retries versus FEC across loss rates.  Charge is the whole supply
+// (sleep included) divided by the readings that reached the hub.
+static void sweep(SimOptions opt) {
+    static const uint32_t losses[] = {0, 5, 10, 20, 30, 40};
+    uint32_t fec = opt.fec ? opt.fec : 4;
+    printf("loss  uplink   delivered  attempts/rdg  radio ms/rdg  mC/rdg  avg mA\n");
+    for (size_t i = 0; i < sizeof(losses) / sizeof(losses[0]); i++) {
+        for (int mode = 0; mode < 2; mode++) {
+            opt.loss = losses[i];
+            opt.fec = mode ? fec : 0;
+            SinkState sink;
+            memset(&sink, 0, sizeof(sink));
+            SimHal hal;
+            run(opt, &sink, &hal);
+            const PowerProfile& p = hal.run_profile();
+            double readings = sink.readings ? (double)sink.readings : 1.0;
+            double avg_ma = power_profile_avg_ma(&p);
+            char label[16];
+            snprintf(label, sizeof(label), mode ? "fec k=%u" : "retries", fec);
+            printf("%3u%%  %-8s %8.2f%%  %12.2f  %12.2f  %6.2f  %6.3f\n",
+                   losses[i], label, 100.0 * sink.readings / (double)(hal.wakes() ? hal.wakes() : 1),
+                   hal.send_attempts() / readings, p.us[POWER_RADIO] / 1e3 / readings,
+                   avg_ma * (hal.now_us() / 1e6) / readings, avg_ma);
+        }
+    }
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--days N] [--traffic N] [--in-pct N] [--loss N] [--seed N]\n"
+            "          [--probes N] [--fec K] [--sweep] [--no-pm] [--csv FILE] [--verbose]\n",
+            argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    SimOptions opt;
+    opt.days = 30;
+    opt.traffic = 60;
+    opt.in_pct = 50;
+    opt.loss = 0;
+    opt.seed = 1;
+    opt.fec = UPLINK_FEC_GROUP;
+    opt.probes = 0;
+    opt.pm = true;
+    bool sweep_loss = false;
+    const char* csv_path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(argv[i], "--verbose") == 0) {
+            hal_log_enabled() = true;
+        } else if (strcmp(argv[i], "--no-pm") == 0) {
+            opt.pm = false;
+        } else if (strcmp(argv[i], "--sweep") == 0) {
+            sweep_loss = true;
+        } else if (v == nullptr) {
+            usage(argv[0]);
+        } else if (strcmp(argv[i], "--days") == 0) {
+            opt.days = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--traffic") == 0) {
+            opt.traffic = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--in-pct") == 0) {
+            opt.in_pct = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--loss") == 0) {
+            opt.loss = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            opt.seed = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--probes") == 0) {
+            opt.probes = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--fec") == 0) {
+            opt.fec = (uint32_t)atoi(v); i++;
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            csv_path = v; i++;
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (opt.in_pct > 100 || opt.loss > 100 || opt.fec == 1 || opt.fec > FEC_MAX_GROUP ||
+        opt.probes > THERMAL_MAX_PROBES) {
+        usage(argv[0]);
+    }
+    if (sweep_loss) {
+        sweep(opt);
+        return 0;
+    }
+
+    SinkState sink;
+    memset(&sink, 0, sizeof(sink));
+    if (csv_path != nullptr) {
+        sink.csv = fopen(csv_path, "w");
+        if (sink.csv == nullptr) {
+            fprintf(stderr, "cannot write %s\n", csv_path);
+            return 1;
+        }
+        fprintf(sink.csv, "t_s,hive_id,sequence,weight_g,temp_c_x100,humidity_x100,"
+                          "pressure_hpa_x10,battery_mv,flags,bees_in,bees_out,"
+                          "period_ms,stuck_mask\n");
+    }
+
+    SimHal hal;
+    auto t0 = std::chrono::steady_clock::now();
+    run(opt, &sink, &hal);
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (sink.csv != nullptr) {
+        fclose(sink.csv);
+    }
+
+    double sim_days = hal.now_us() / 86400e6;
+    printf("simulated        %.2f days in %.2f s (%.0f days/s)\n",
+           sim_days, wall_s, wall_s > 0 ? sim_days / wall_s : 0.0);
+    printf("wakes            %llu\n", (unsigned long long)hal.wakes());
+    printf("frames           %llu delivered, %llu lost, %llu attempts, %llu CRC errors\n",
+           (unsigned long long)hal.frames_sent(), (unsigned long long)hal.frames_lost(),
+           (unsigned long long)hal.send_attempts(), (unsigned long long)sink.crc_errors);
+    printf("readings         %llu at the hub (%llu rebuilt from parity, uplink %s)\n",
+           (unsigned long long)sink.readings, (unsigned long long)sink.recovered,
+           opt.fec ? "fec" : "retries");
+    if (opt.probes != 0) {
+        printf("thermal          %llu payloads from %u probes\n",
+               (unsigned long long)sink.thermals, opt.probes);
+    }
+    printf("bees in          %llu counted / %llu injected\n",
+           (unsigned long long)sink.bees_in, (unsigned long long)hal.injected_in());
+    printf("bees out         %llu counted / %llu injected\n",
+           (unsigned long long)sink.bees_out, (unsigned long long)hal.injected_out());
+    printf("camera wakes     %llu\n", (unsigned long long)hal.wake_line_rises());
+    printf("awake            %.3f%% of the time\n",
+           hal.now_us() ? 100.0 * hal.awake_us() / hal.now_us() : 0.0);
+    const PowerProfile& p = hal.run_profile();
+    uint64_t wakes = hal.wakes() ? hal.wakes() : 1;
+    printf("current          %.3f mA avg (power management %s)\n",
+           power_profile_avg_ma(&p), opt.pm ? "on" : "off");
+    printf("per cycle        active %.1f ms, idle %.1f ms, radio %.1f ms, sleep %.1f ms\n",
+           p.us[POWER_ACTIVE] / 1e3 / wakes, p.us[POWER_IDLE] / 1e3 / wakes,
+           p.us[POWER_RADIO] / 1e3 / wakes, p.us[POWER_SLEEP] / 1e3 / wakes);
+    return 0;
+}
@@ -0,0 +1,184 @@
+// Waggle Sensor Node — Activity trigger implementation.
+//
+// The sliding-window logic (activity_trigger_init/record/poll) is pure
+// and tested natively; the GPIO glue at the bottom is ESP32 only.  The
+// transit path runs in the beam ISR and is ISR_CODE (see isr_io.h).
+
+#include "activity_trigger.h"
+#include "isr_io.h"
+
+#include <string.h>
+
+// ── Pure sliding-window logic (testable on any platform) ─────────────
+
+// Rotate the bucket ring forward so the head bucket covers now_ms.
+// Buckets that fall out of the window are subtracted from the sums.
+static void ISR_CODE advance_window(ActivityTrigger* t, uint32_t now_ms) {
+    if (!t->started) {
+        t->started = true;
+        t->bucket_start_ms = now_ms;
+        return;
+    }
+
+    uint32_t elapsed = now_ms - t->bucket_start_ms;
+    if (elapsed < t->bucket_ms) {
+        return;
+    }
+
+    uint32_t steps = elapsed / t->bucket_ms;
+    t->bucket_start_ms += steps * t->bucket_ms;
+
+    if (steps >= ACTIVITY_BUCKETS) {
+        // Whole window expired — nothing left to subtract piecemeal
+        for (uint32_t i = 0; i < ACTIVITY_BUCKETS; i++) {
+            t->in_buckets[i]  = 0;
+            t->out_buckets[i] = 0;
+        }
+        t->in_sum  = 0;
+        t->out_sum = 0;
+        return;
+    }
+
+    for (uint32_t i = 0; i < steps; i++) {
+        t->head = (uint8_t)((t->head + 1) % ACTIVITY_BUCKETS);
+        t->in_sum  -= t->in_buckets[t->head];
+        t->out_sum -= t->out_buckets[t->head];
+        t->in_buckets[t->head]  = 0;
+        t->out_buckets[t->head] = 0;
+    }
+}
+
+void activity_trigger_init(ActivityTrigger* t, const ActivityTriggerConfig* cfg) {
+    memset(t, 0, sizeof(ActivityTrigger));
+    t->cfg = *cfg;
+    t->bucket_ms = cfg->window_ms / ACTIVITY_BUCKETS;
+    if (t->bucket_ms == 0) {
+        t->bucket_ms = 1;
+    }
+    t->reason = ACTIVITY_REASON_NONE;
+}
+
+bool ISR_CODE activity_trigger_record(ActivityTrigger* t, uint32_t now_ms, bool inbound) {
+    advance_window(t, now_ms);
+
+    // Saturate rather than wrap; a bucket never realistically fills
+    if (inbound) {
+        if (t->in_buckets[t->head] < 0xFFFF && t->in_sum < 0xFFFF) {
+            t->in_buckets[t->head]++;
+            t->in_sum++;
+        }
+    } else {
+        if (t->out_buckets[t->head] < 0xFFFF && t->out_sum < 0xFFFF) {
+            t->out_buckets[t->head]++;
+            t->out_sum++;
+        }
+    }
+
+    // Line already raised — the current trigger is still being served
+    if (t->asserted) {
+        return false;
+    }
+    // Holdoff: don't wake the camera again too soon
+    if (t->fired_once && (now_ms - t->fired_ms) < t->cfg.holdoff_ms) {
+        return false;
+    }
+
+    uint8_t reason = ACTIVITY_REASON_NONE;
+    if (t->cfg.in_threshold != 0 && t->in_sum >= t->cfg.in_threshold) {
+        reason = ACTIVITY_REASON_IN;
+    } else if (t->cfg.out_threshold != 0 && t->out_sum >= t->cfg.out_threshold) {
+        reason = ACTIVITY_REASON_OUT;
+    }
+    if (reason == ACTIVITY_REASON_NONE) {
+        return false;
+    }
+
+    t->asserted    = true;
+    t->asserted_ms = now_ms;
+    t->fired_ms    = now_ms;
+    t->fired_once  = true;
+    t->reason      = reason;
+    t->fire_count++;
+    return true;
+}
+
+bool activity_trigger_poll(ActivityTrigger* t, uint32_t now_ms) {
+    if (t->asserted && (now_ms - t->asserted_ms) >= t->cfg.hold_ms) {
+        t->asserted = false;
+        return true;
+    }
+    return false;
+}
+
+uint32_t activity_trigger_release_in_ms(const ActivityTrigger* t, uint32_t now_ms) {
+    if (!t->asserted) {
+        return 0;
+    }
+    uint32_t held = now_ms - t->asserted_ms;
+    if (held >= t->cfg.hold_ms) {
+        return 1;  // Overdue — release at the next opportunity
+    }
+    return t->cfg.hold_ms - held;
+}
+
+// ── Hardware-specific GPIO glue (ESP32 only) ──────────────────────────
+#ifndef UNIT_TEST
+
+#include <Arduino.h>
+
+static ActivityTrigger s_trigger;
+static uint8_t  s_pin     = 0;
+static bool     s_enabled = false;
+static portMUX_TYPE s_trig_mux = portMUX_INITIALIZER_UNLOCKED;
+
+void activity_trigger_begin(uint8_t pin, const ActivityTriggerConfig* cfg) {
+    s_pin = pin;
+    pinMode(s_pin, OUTPUT);
+    digitalWrite(s_pin, LOW);
+
+    portENTER_CRITICAL(&s_trig_mux);
+    activity_trigger_init(&s_trigger, cfg);
+    s_enabled = true;
+    portEXIT_CRITICAL(&s_trig_mux);
+}
+
+void ISR_CODE activity_trigger_on_transit(uint32_t now_ms, bool inbound) {
+    if (!s_enabled) {
+        return;
+    }
+    portENTER_CRITICAL_ISR(&s_trig_mux);
+    bool fire = activity_trigger_record(&s_trigger, now_ms, inbound);
+    portEXIT_CRITICAL_ISR(&s_trig_mux);
+
+    if (fire) {
+        isr_gpio_write(s_pin, true);
+    }
+}
+
+uint32_t activity_trigger_service() {
+    if (!s_enabled) {
+        return 0;
+    }
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&s_trig_mux);
+    bool release = activity_trigger_poll(&s_trigger, now);
+    uint32_t next = activity_trigger_release_in_ms(&s_trigger, now);
+    portEXIT_CRITICAL(&s_trig_mux);
+
+    if (release) {
+        digitalWrite(s_pin, LOW);
+        log_i("Camera wake line released");
+    }
+    return next;
+}
+
+uint8_t activity_trigger_last_reason() {
+    return s_trigger.reason;
+}
+
+uint32_t activity_trigger_count() {
+    return s_trigger.fire_count;
+}
+
+#endif // UNIT_TEST
@@ -0,0 +1,94 @@
+// Waggle Sensor Node — Activity trigger for the camera wake line.
+//
+// Watches the bee counter's transit stream and raises a GPIO line wired
+// to the camera node's EXT0 wake input when traffic spikes (robbing,
+// wasp attacks, swarming) so the camera captures between its scheduled
+// wakes.
+//
+// Detection uses a sliding window split into ACTIVITY_BUCKETS equal
+// buckets.  Each counted transit increments the current bucket; the
+// window sums are maintained incrementally so recording a transit is
+// O(1) and safe to call from the beam ISRs.  The trigger fires when the
+// IN or OUT count within the window reaches its threshold (a threshold
+// of 0 disables that direction), then the line is held for hold_ms and
+// further triggers are suppressed for holdoff_ms.
+//
+// The logic below is pure (no GPIO) so it can be exercised natively
+// against recorded or synthetic traffic traces.
+
+#ifndef ACTIVITY_TRIGGER_H
+#define ACTIVITY_TRIGGER_H
+
+#include <stdint.h>
+
+#define ACTIVITY_BUCKETS 8
+
+// ── Trigger reasons ───────────────────────────────────────────────────
+#define ACTIVITY_REASON_NONE  0
+#define ACTIVITY_REASON_IN    1   // Inbound rate crossed threshold
+#define ACTIVITY_REASON_OUT   2   // Outbound rate crossed threshold
+
+struct ActivityTriggerConfig {
+    uint32_t window_ms;      // Sliding window length
+    uint16_t in_threshold;   // IN transits per window (0 = disabled)
+    uint16_t out_threshold;  // OUT transits per window (0 = disabled)
+    uint32_t hold_ms;        // How long the wake line stays asserted
+    uint32_t holdoff_ms;     // Minimum time between trigger assertions
+};
+
+struct ActivityTrigger {
+    ActivityTriggerConfig cfg;
+    uint32_t bucket_ms;                    // window_ms / ACTIVITY_BUCKETS
+    uint32_t bucket_start_ms;              // Start time of the head bucket
+    uint16_t in_buckets[ACTIVITY_BUCKETS];
+    uint16_t out_buckets[ACTIVITY_BUCKETS];
+    uint16_t in_sum;                       // Sum of in_buckets
+    uint16_t out_sum;                      // Sum of out_buckets
+    uint8_t  head;                         // Index of the current bucket
+    bool     started;                      // First transit seen
+    bool     asserted;                     // Wake line currently raised
+    bool     fired_once;                   // holdoff applies
+    uint8_t  reason;                       // ACTIVITY_REASON_* of last trigger
+    uint32_t asserted_ms;                  // Time the line was raised
+    uint32_t fired_ms;                     // Time of the last trigger
+    uint32_t fire_count;                   // Triggers since init
+};
+
+// ── Pure logic (testable on any platform) ─────────────────────────────
+
+// Reset state and apply cfg.  window_ms is rounded down to a multiple of
+// ACTIVITY_BUCKETS (minimum one millisecond per bucket).
+void activity_trigger_init(ActivityTrigger* t, const ActivityTriggerConfig* cfg);
+
+// Record one counted transit at now_ms.  Returns true if this transit
+// fired the trigger (the caller should raise the wake line).
+bool activity_trigger_record(ActivityTrigger* t, uint32_t now_ms, bool inbound);
+
+// Advance time.  Returns true if the wake line should be released now
+// (it was asserted and hold_ms has elapsed).
+bool activity_trigger_poll(ActivityTrigger* t, uint32_t now_ms);
+
+// Milliseconds until the asserted line is due for release, or 0 if the
+// line is not asserted.  Never returns 0 while asserted (min 1 ms).
+uint32_t activity_trigger_release_in_ms(const ActivityTrigger* t, uint32_t now_ms);
+
+// ── Hardware interface (not available in native tests) ────────────────
+#ifndef UNIT_TEST
+
+// Configure the wake line GPIO (driven LOW) and the trigger parameters.
+void activity_trigger_begin(uint8_t pin, const ActivityTriggerConfig* cfg);
+
+// Called from the beam ISRs for every counted transit.
+void activity_trigger_on_transit(uint32_t now_ms, bool inbound);
+
+// Release the line if its hold has elapsed.  Returns milliseconds until
+// the next release is due (0 = line idle).  Call from the main loop.
+uint32_t activity_trigger_service();
+
+// Reason of the most recent trigger and number of triggers since boot.
+uint8_t  activity_trigger_last_reason();
+uint32_t activity_trigger_count();
+
+#endif // UNIT_TEST
+
+#endif // ACTIVITY_TRIGGER_H
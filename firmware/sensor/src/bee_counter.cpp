@@ -3,19 +3,31 @@
 // Each lane runs an independent state machine driven by beam-break
 // interrupts.  The state machine logic (lane_beam_a_event,
 // lane_beam_b_event, lane_check_timeout) is separated from the
-// ISR/GPIO glue so it can be tested natively.
+// ISR/GPIO glue so it can be tested natively.  Everything the beam ISR
+// calls is ISR_CODE (IRAM on the ESP32, see isr_io.h).
 
 #include "bee_counter.h"
+#include "isr_io.h"
 #include "tunnel_config.h"
 
 // ── Pure state machine logic (testable on any platform) ───────────────
 
-void lane_beam_a_event(LaneData* lane, uint32_t now_ms) {
+// Leave cooldown once the refractory period has passed.  Beam events
+// call this themselves: lane_check_timeout() only runs at the snapshot
+// on each wake, so without it a lane would count one bee per wake.
+static void ISR_CODE expire_cooldown(LaneData* lane, uint32_t now_ms) {
+    if (lane->state == LANE_COOLDOWN && (now_ms - lane->state_enter_ms) >= REFRACTORY_MS) {
+        lane->state = LANE_IDLE;
+    }
+}
+
+void ISR_CODE lane_beam_a_event(LaneData* lane, uint32_t now_ms) {
     // Debounce: ignore if too soon after last A edge
     if ((now_ms - lane->last_edge_a_ms) < DEBOUNCE_MS) {
         return;
     }
     lane->last_edge_a_ms = now_ms;
+    expire_cooldown(lane, now_ms);
 
     switch (lane->state) {
         case LANE_IDLE:
@@ -43,12 +55,13 @@ void lane_beam_a_event(LaneData* lane, uint32_t now_ms) {
     }
 }
 
-void lane_beam_b_event(LaneData* lane, uint32_t now_ms) {
+void ISR_CODE lane_beam_b_event(LaneData* lane, uint32_t now_ms) {
     // Debounce: ignore if too soon after last B edge
     if ((now_ms - lane->last_edge_b_ms) < DEBOUNCE_MS) {
         return;
     }
     lane->last_edge_b_ms = now_ms;
+    expire_cooldown(lane, now_ms);
 
     switch (lane->state) {
         case LANE_IDLE:
@@ -105,145 +118,334 @@ void lane_check_timeout(LaneData* lane, uint32_t now_ms) {
     }
 }
 
+BeeCountSnapshot lanes_collect(LaneData* lanes, uint8_t lane_mask,
+                               uint32_t now_ms, uint32_t last_snapshot_ms) {
+    BeeCountSnapshot snap;
+    uint32_t total_in  = 0;
+    uint32_t total_out = 0;
+    snap.stuck_mask = 0;
+
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        if (!(lane_mask & (1 << ch))) {
+            continue;
+        }
+
+        // Check for timeouts / stuck beams before reading the counters
+        lane_check_timeout(&lanes[ch], now_ms);
+
+        // Accumulate per-lane counts, each clamped to uint16 range
+        uint32_t in_count  = lanes[ch].bees_in;
+        uint32_t out_count = lanes[ch].bees_out;
+        total_in  += (in_count  > 65535) ? 65535 : in_count;
+        total_out += (out_count > 65535) ? 65535 : out_count;
+
+        // Reset ISR counters
+        lanes[ch].bees_in  = 0;
+        lanes[ch].bees_out = 0;
+
+        if (lanes[ch].stuck) {
+            snap.stuck_mask |= (1 << ch);
+            lanes[ch].stuck = false;  // Clear after reporting
+        }
+    }
+
+    // Clamp total to uint16 range
+    snap.bees_in   = (total_in  > 65535) ? 65535 : (uint16_t)total_in;
+    snap.bees_out  = (total_out > 65535) ? 65535 : (uint16_t)total_out;
+    snap.period_ms = now_ms - last_snapshot_ms;
+    snap.lane_mask = lane_mask;
+    return snap;
+}
+
+// ── ISR instrumentation (pure) ────────────────────────────────────────
+
+void ISR_CODE isr_hist_record(IsrHist* h, uint32_t cycles) {
+    uint32_t bucket = 0;
+    if (cycles >= (1u << ISR_HIST_FIRST_LOG2)) {
+        bucket = (31u - (uint32_t)__builtin_clz(cycles)) - ISR_HIST_FIRST_LOG2 + 1;
+        if (bucket >= ISR_HIST_BUCKETS) {
+            bucket = ISR_HIST_BUCKETS - 1;
+        }
+    }
+    h->count[bucket]++;
+    if (cycles > h->max_cycles) {
+        h->max_cycles = cycles;
+    }
+}
+
+uint32_t isr_hist_bucket_limit(uint8_t bucket) {
+    if (bucket >= ISR_HIST_BUCKETS - 1) {
+        return UINT32_MAX;
+    }
+    return 1u << (ISR_HIST_FIRST_LOG2 + bucket);
+}
+
+uint32_t isr_hist_percentile(const IsrHist* h, uint8_t pct) {
+    uint64_t total = 0;
+    for (int b = 0; b < ISR_HIST_BUCKETS; b++) {
+        total += h->count[b];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    // Smallest bucket whose cumulative count reaches pct% of the samples
+    uint64_t target = (total * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (uint8_t b = 0; b < ISR_HIST_BUCKETS; b++) {
+        seen += h->count[b];
+        if (seen >= target && seen > 0) {
+            return isr_hist_bucket_limit(b);
+        }
+    }
+    return UINT32_MAX;
+}
+
 // ── Hardware-specific ISR and GPIO code (ESP32 only) ──────────────────
 #ifndef UNIT_TEST
 
 #include <Arduino.h>
-#include <esp_attr.h>
-
-// Module state
-static LaneData s_lanes[NUM_CHANNELS];
+#include <driver/gpio.h>
+#include <esp_intr_alloc.h>
+#include <esp_sleep.h>
+
+#include "activity_trigger.h"
+
+// Module state.  Everything the ISR reads is in DRAM: the pin numbers are
+// copied out of the flash-resident BEAM_A_PINS / BEAM_B_PINS at init.
+static LaneData     s_lanes[NUM_CHANNELS];
+static LaneIsrStats s_isr_stats[NUM_CHANNELS];
+static uint8_t  s_pin_a[NUM_CHANNELS];
+static uint8_t  s_pin_b[NUM_CHANNELS];
+static uint32_t s_beam_mask_lo = 0;   // Beam pins 0-31
+static uint32_t s_beam_mask_hi = 0;   // Beam pins 32-39
+static uint32_t s_armed_high_lo = 0;  // Beam pins waiting for release
+static uint32_t s_armed_high_hi = 0;
 static uint8_t  s_lane_mask = 0;
 static uint32_t s_last_snapshot_ms = 0;
+static gpio_isr_handle_t s_isr_handle = nullptr;
 static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
 
-// ── ISR handlers (one pair per lane, generated with macros) ───────────
-// Each beam gets its own ISR that reads the pin state and calls the
-// state machine transition function.  IRAM_ATTR keeps the ISR in
-// fast internal RAM.
-
-#define DEFINE_ISR_A(ch)                                         \
-    static void IRAM_ATTR isr_beam_a_##ch() {                   \
-        if (digitalRead(BEAM_A_PINS[ch]) == LOW) {               \
-            portENTER_CRITICAL_ISR(&s_mux);                      \
-            lane_beam_a_event(&s_lanes[ch], millis());           \
-            portEXIT_CRITICAL_ISR(&s_mux);                       \
-        }                                                        \
-    }
-
-#define DEFINE_ISR_B(ch)                                         \
-    static void IRAM_ATTR isr_beam_b_##ch() {                   \
-        if (digitalRead(BEAM_B_PINS[ch]) == LOW) {               \
-            portENTER_CRITICAL_ISR(&s_mux);                      \
-            lane_beam_b_event(&s_lanes[ch], millis());           \
-            portEXIT_CRITICAL_ISR(&s_mux);                       \
-        }                                                        \
-    }
-
-DEFINE_ISR_A(0)
-DEFINE_ISR_A(1)
-DEFINE_ISR_A(2)
-DEFINE_ISR_A(3)
-
-DEFINE_ISR_B(0)
-DEFINE_ISR_B(1)
-DEFINE_ISR_B(2)
-DEFINE_ISR_B(3)
-
-// ISR function pointer arrays for dynamic attachment
-static void (*const s_isr_a[NUM_CHANNELS])() = {
-    isr_beam_a_0, isr_beam_a_1, isr_beam_a_2, isr_beam_a_3
-};
-static void (*const s_isr_b[NUM_CHANNELS])() = {
-    isr_beam_b_0, isr_beam_b_1, isr_beam_b_2, isr_beam_b_3
-};
+ISR_INLINE bool pin_pending(uint8_t pin, uint32_t lo, uint32_t hi) {
+    return (pin < 32) ? ((lo >> pin) & 1u) : ((hi >> (pin - 32)) & 1u);
+}
+
+// ── Beam edge handling ────────────────────────────────────────────────
+// One break (falling edge) on a beam pin.  Only acted on if the beam
+// still reads broken (active LOW); a counted transit is forwarded to the
+// activity trigger outside the critical section (it takes its own lock).
+// Returns whether the beam was still broken.
+static bool ISR_CODE beam_edge(int ch, bool beam_b, uint32_t now, uint32_t entry) {
+    uint32_t start = isr_cycles();
+    bool broken = !isr_gpio_read(beam_b ? s_pin_b[ch] : s_pin_a[ch]);
+    bool counted = false;
+
+    portENTER_CRITICAL_ISR(&s_mux);
+    LaneData* lane = &s_lanes[ch];
+    LaneIsrStats* stats = &s_isr_stats[ch];
+    stats->edges++;
+    if (!broken) {
+        stats->late++;
+    } else if (beam_b) {
+        uint32_t before = lane->bees_in;
+        lane_beam_b_event(lane, now);
+        counted = (lane->bees_in != before);
+    } else {
+        uint32_t before = lane->bees_out;
+        lane_beam_a_event(lane, now);
+        counted = (lane->bees_out != before);
+    }
+    isr_hist_record(&stats->entry, start - entry);
+    isr_hist_record(&stats->duration, isr_cycles() - start);
+    portEXIT_CRITICAL_ISR(&s_mux);
+
+    if (counted) {
+        activity_trigger_on_transit(now, beam_b);
+    }
+    return broken;
+}
+
+// ── Level-triggered edges ─────────────────────────────────────────────
+// Edge interrupts are not latched while the chip light-sleeps, and only
+// level interrupts can be GPIO wake sources.  So each beam pin is armed
+// LOW_LEVEL (waiting for a break) or HIGH_LEVEL (waiting for the
+// release), and the ISR flips it: a LOW_LEVEL interrupt is a falling
+// edge, a HIGH_LEVEL one re-arms for the next break.  Either interrupt
+// wakes the chip, and the level is still there when the ISR runs after
+// the wake.
+ISR_INLINE void beam_arm(uint8_t pin, bool high) {
+    uint32_t* armed = (pin < 32) ? &s_armed_high_lo : &s_armed_high_hi;
+    uint32_t bit = 1u << (pin & 31);
+    if (high) {
+        *armed |= bit;
+    } else {
+        *armed &= ~bit;
+    }
+    isr_gpio_set_intr_type(pin, high ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+}
+
+static void ISR_CODE beam_pin_event(int ch, bool beam_b, uint32_t now, uint32_t entry) {
+    uint8_t pin = beam_b ? s_pin_b[ch] : s_pin_a[ch];
+    if (pin_pending(pin, s_armed_high_lo, s_armed_high_hi)) {
+        beam_arm(pin, false);  // Released
+    } else if (beam_edge(ch, beam_b, now, entry)) {
+        beam_arm(pin, true);
+    }
+}
+
+// The GPIO interrupt handler for every beam pin.  Registered directly with
+// gpio_isr_register() rather than through attachInterrupt(), so the whole
+// path from the interrupt vector is ours and IRAM resident; no other
+// sensor code takes GPIO interrupts.  Status bits are cleared after the
+// pins are re-armed, since a level interrupt re-asserts until then.
+static void ISR_CODE beam_isr(void* arg) {
+    (void)arg;
+    uint32_t entry = isr_cycles();
+    uint32_t pending_lo = GPIO.status & s_beam_mask_lo;
+    uint32_t pending_hi = GPIO.status1.intr_st & s_beam_mask_hi;
+    if ((pending_lo | pending_hi) == 0) {
+        return;
+    }
+
+    uint32_t now = isr_millis();
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        if (pin_pending(s_pin_a[ch], pending_lo, pending_hi)) {
+            beam_pin_event(ch, false, now, entry);
+        }
+        if (pin_pending(s_pin_b[ch], pending_lo, pending_hi)) {
+            beam_pin_event(ch, true, now, entry);
+        }
+    }
+    GPIO.status_w1tc = pending_lo;
+    GPIO.status1_w1tc.val = pending_hi;
+}
+
+static void beam_pin_setup(uint8_t pin) {
+    // Input with pull-up (beam break = active LOW), armed for a break and
+    // enabled as a light-sleep wake source
+    pinMode(pin, INPUT_PULLUP);
+    gpio_wakeup_enable((gpio_num_t)pin, GPIO_INTR_LOW_LEVEL);
+    if (pin < 32) {
+        s_beam_mask_lo |= 1u << pin;
+    } else {
+        s_beam_mask_hi |= 1u << (pin - 32);
+    }
+}
 
 void bee_counter_init(uint8_t lane_mask) {
     s_lane_mask = lane_mask;
     s_last_snapshot_ms = millis();
+    s_beam_mask_lo = 0;
+    s_beam_mask_hi = 0;
+    s_armed_high_lo = 0;
+    s_armed_high_hi = 0;
 
     for (int ch = 0; ch < NUM_CHANNELS; ch++) {
         // Zero-init lane data
         memset(&s_lanes[ch], 0, sizeof(LaneData));
+        memset(&s_isr_stats[ch], 0, sizeof(LaneIsrStats));
         s_lanes[ch].state = LANE_IDLE;
+        s_pin_a[ch] = BEAM_A_PINS[ch];
+        s_pin_b[ch] = BEAM_B_PINS[ch];
 
         if (!(lane_mask & (1 << ch))) {
             continue;  // Lane not enabled
         }
+        beam_pin_setup(s_pin_a[ch]);
+        beam_pin_setup(s_pin_b[ch]);
+    }
 
-        // Configure pins as input with pull-up (beam break = active LOW)
-        pinMode(BEAM_A_PINS[ch], INPUT_PULLUP);
-        pinMode(BEAM_B_PINS[ch], INPUT_PULLUP);
-
-        // Attach interrupts on FALLING edge (beam broken)
-        attachInterrupt(digitalPinToInterrupt(BEAM_A_PINS[ch]),
-                        s_isr_a[ch], FALLING);
-        attachInterrupt(digitalPinToInterrupt(BEAM_B_PINS[ch]),
-                        s_isr_b[ch], FALLING);
+    if (s_isr_handle == nullptr) {
+        esp_err_t err = gpio_isr_register(beam_isr, nullptr, ESP_INTR_FLAG_IRAM, &s_isr_handle);
+        if (err != ESP_OK) {
+            log_e("Beam ISR registration failed: %d", err);
+            return;
+        }
+    }
+    esp_sleep_enable_gpio_wakeup();
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        if (lane_mask & (1 << ch)) {
+            gpio_intr_enable((gpio_num_t)s_pin_a[ch]);
+            gpio_intr_enable((gpio_num_t)s_pin_b[ch]);
+        }
     }
 }
 
 void bee_counter_deinit() {
     for (int ch = 0; ch < NUM_CHANNELS; ch++) {
         if (s_lane_mask & (1 << ch)) {
-            detachInterrupt(digitalPinToInterrupt(BEAM_A_PINS[ch]));
-            detachInterrupt(digitalPinToInterrupt(BEAM_B_PINS[ch]));
+            gpio_intr_disable((gpio_num_t)s_pin_a[ch]);
+            gpio_intr_disable((gpio_num_t)s_pin_b[ch]);
+            gpio_wakeup_disable((gpio_num_t)s_pin_a[ch]);
+            gpio_wakeup_disable((gpio_num_t)s_pin_b[ch]);
         }
     }
+    if (s_isr_handle != nullptr) {
+        esp_intr_free(s_isr_handle);
+        s_isr_handle = nullptr;
+    }
+    s_beam_mask_lo = 0;
+    s_beam_mask_hi = 0;
     s_lane_mask = 0;
 }
 
 BeeCountSnapshot bee_counter_snapshot() {
-    BeeCountSnapshot snap;
     uint32_t now = millis();
 
     portENTER_CRITICAL(&s_mux);
-
-    snap.bees_in  = 0;
-    snap.bees_out = 0;
-    snap.stuck_mask = 0;
-
+    BeeCountSnapshot snap = lanes_collect(s_lanes, s_lane_mask, now, s_last_snapshot_ms);
+    s_last_snapshot_ms = now;
+    uint32_t edges = 0;
+    uint32_t late = 0;
+    uint32_t max_cycles = 0;
     for (int ch = 0; ch < NUM_CHANNELS; ch++) {
-        if (!(s_lane_mask & (1 << ch))) {
-            continue;
-        }
-
-        // Check for timeouts / stuck beams while in critical section
-        lane_check_timeout(&s_lanes[ch], now);
-
-        // Accumulate counters (clamping handled below)
-        uint32_t in_count  = s_lanes[ch].bees_in;
-        uint32_t out_count = s_lanes[ch].bees_out;
-
-        // Reset ISR counters
-        s_lanes[ch].bees_in  = 0;
-        s_lanes[ch].bees_out = 0;
-
-        // Accumulate (may exceed uint16 range; clamped below)
-        snap.bees_in  += (in_count  > 65535) ? 65535 : (uint16_t)in_count;
-        snap.bees_out += (out_count > 65535) ? 65535 : (uint16_t)out_count;
+        edges += s_isr_stats[ch].edges;
+        late += s_isr_stats[ch].late;
+        max_cycles = max(max_cycles, s_isr_stats[ch].duration.max_cycles);
+    }
+    portEXIT_CRITICAL(&s_mux);
 
-        if (s_lanes[ch].stuck) {
-            snap.stuck_mask |= (1 << ch);
-            s_lanes[ch].stuck = false;  // Clear after reporting
-        }
+    if (edges != 0) {
+        log_i("Beam ISR since boot: %u edges, %u late, longest %u us",
+              edges, late, max_cycles / getCpuFrequencyMhz());
     }
+    return snap;
+}
 
-    snap.period_ms = now - s_last_snapshot_ms;
-    s_last_snapshot_ms = now;
-    snap.lane_mask = s_lane_mask;
+// ── ISR statistics ────────────────────────────────────────────────────
 
+void bee_counter_isr_stats(LaneIsrStats* out, bool reset) {
+    portENTER_CRITICAL(&s_mux);
+    memcpy(out, s_isr_stats, sizeof(s_isr_stats));
+    if (reset) {
+        memset(s_isr_stats, 0, sizeof(s_isr_stats));
+    }
     portEXIT_CRITICAL(&s_mux);
+}
 
-    // Clamp total to uint16 range
-    if (snap.bees_in > 65535) {
-        snap.bees_in = 65535;
-    }
-    if (snap.bees_out > 65535) {
-        snap.bees_out = 65535;
+static void print_hist(const char* name, const IsrHist* h, uint32_t mhz) {
+    Serial.printf("  %-8s p50 <%u p99 <%u max %u cycles |", name,
+                  isr_hist_percentile(h, 50), isr_hist_percentile(h, 99), h->max_cycles);
+    for (int b = 0; b < ISR_HIST_BUCKETS; b++) {
+        Serial.printf(" %u", h->count[b]);
     }
+    Serial.printf("  (max %.2f us)\n", (double)h->max_cycles / mhz);
+}
 
-    return snap;
+void bee_counter_print_isr_stats() {
+    LaneIsrStats stats[NUM_CHANNELS];
+    bee_counter_isr_stats(stats, false);
+    uint32_t mhz = getCpuFrequencyMhz();
+
+    Serial.printf("--- Beam ISR (CPU %u MHz; buckets <%u, then x2 up to >=%u cycles) ---\n",
+                  mhz, isr_hist_bucket_limit(0), isr_hist_bucket_limit(ISR_HIST_BUCKETS - 2));
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        if (!(s_lane_mask & (1 << ch))) {
+            continue;
+        }
+        Serial.printf("lane %d: %u edges, %u late\n", ch, stats[ch].edges, stats[ch].late);
+        print_hist("entry", &stats[ch].entry, mhz);
+        print_hist("duration", &stats[ch].duration, mhz);
+    }
 }
 
 #endif // UNIT_TEST
@@ -10,6 +10,14 @@
 //
 // ISR-driven: counters are incremented in interrupt context.
 // Call bee_counter_snapshot() to atomically read and reset.
+//
+// The edge path (the GPIO ISR, the lane state machine and the activity
+// trigger) is IRAM resident and uses only the flash-safe primitives in
+// isr_io.h, so beams are counted while NVS writes disable the flash cache.
+// Beam pins are level-triggered GPIO wake sources, so edges are also seen
+// while the chip light-sleeps (see power.h).
+// Each lane keeps cycle-count histograms of its edge handling; read them
+// with bee_counter_isr_stats() or the provisioning console's ISR_STATS.
 
 #ifndef BEE_COUNTER_H
 #define BEE_COUNTER_H
@@ -59,6 +67,42 @@ void lane_beam_b_event(LaneData* lane, uint32_t now_ms);
 // Check for timeout/stuck conditions.  Call periodically from main loop.
 void lane_check_timeout(LaneData* lane, uint32_t now_ms);
 
+// Build a snapshot from the enabled lanes at now_ms and reset their
+// counters and stuck flags.  Runs lane_check_timeout() first.  Per-lane
+// and total counts clamp at 65535.  The caller provides the locking.
+BeeCountSnapshot lanes_collect(LaneData* lanes, uint8_t lane_mask,
+                               uint32_t now_ms, uint32_t last_snapshot_ms);
+
+// ── ISR instrumentation ───────────────────────────────────────────────
+// Log2 histograms of CPU cycles.  Bucket 0 holds < 2^ISR_HIST_FIRST_LOG2
+// cycles, bucket b holds [2^(FIRST_LOG2+b-1), 2^(FIRST_LOG2+b)) and the
+// last bucket everything from 2^17 cycles (~546 us at 240 MHz) up.
+#define ISR_HIST_BUCKETS     12
+#define ISR_HIST_FIRST_LOG2  7
+
+struct IsrHist {
+    uint32_t count[ISR_HIST_BUCKETS];
+    uint32_t max_cycles;
+};
+
+struct LaneIsrStats {
+    uint32_t edges;     // Beam interrupts handled
+    uint32_t late;      // Beam already clear when read: a glitch, or a
+                        // break shorter than the interrupt latency
+    IsrHist  entry;     // Cycles from GPIO interrupt entry to this edge
+    IsrHist  duration;  // Cycles spent handling the edge
+};
+
+// Add one sample.  Safe to call from the ISR.
+void isr_hist_record(IsrHist* h, uint32_t cycles);
+
+// Exclusive upper bound of a bucket in cycles (UINT32_MAX for the last).
+uint32_t isr_hist_bucket_limit(uint8_t bucket);
+
+// Upper bound of the bucket holding the pct-th percentile sample, or 0
+// if the histogram is empty.
+uint32_t isr_hist_percentile(const IsrHist* h, uint8_t pct);
+
 // ── Hardware interface (not available in native tests) ────────────────
 #ifndef UNIT_TEST
 
@@ -66,6 +110,13 @@ void bee_counter_init(uint8_t lane_mask);
 void bee_counter_deinit();
 BeeCountSnapshot bee_counter_snapshot();
 
+// Copy every lane's ISR statistics into out[NUM_CHANNELS], then zero them
+// if reset is set.
+void bee_counter_isr_stats(LaneIsrStats* out, bool reset);
+
+// Print the enabled lanes' ISR histograms to Serial.
+void bee_counter_print_isr_stats();
+
 #endif // UNIT_TEST
 
 #endif // BEE_COUNTER_H
@@ -2,6 +2,7 @@
 
 #include "comms.h"
 #include "config.h"
+#include "power.h"
 
 #include <Arduino.h>
 #include <WiFi.h>
@@ -10,20 +11,26 @@
 #include <string.h>
 
 // ── Delivery callback state ─────────────────────────────────────────
-static volatile bool send_done     = false;
+// comms_send() blocks on send_sem rather than polling, so the CPU can
+// drop its clock (and light-sleep) while the frame is in the air.
 static volatile bool send_success  = false;
+static SemaphoreHandle_t send_sem  = nullptr;
 
 static uint8_t peer_mac[6];
 
-// ── Callback: delivery result ───────────────────────────────────────
+// ── Callback: delivery result (WiFi task) ───────────────────────────
 static void on_data_sent(const uint8_t* mac, esp_now_send_status_t status) {
-    send_done    = true;
     send_success = (status == ESP_NOW_SEND_SUCCESS);
+    xSemaphoreGive(send_sem);
 }
 
 // ── Init ────────────────────────────────────────────────────────────
 bool comms_init(const uint8_t* bridge_mac) {
     memcpy(peer_mac, bridge_mac, 6);
+    if (send_sem == nullptr) {
+        send_sem = xSemaphoreCreateBinary();
+    }
+    power_radio(true);
 
     // Wi-Fi must be initialised for ESP-NOW even though we don't join an AP.
     WiFi.mode(WIFI_STA);
@@ -57,37 +64,95 @@ bool comms_init(const uint8_t* bridge_mac) {
     return true;
 }
 
-// ── Send with retries ───────────────────────────────────────────────
-bool comms_send(const uint8_t* data, size_t len) {
-    for (int attempt = 1; attempt <= ESPNOW_MAX_RETRIES; attempt++) {
-        send_done    = false;
-        send_success = false;
+// ── One transmission, waiting for the delivery callback ─────────────
+static bool send_attempt(const uint8_t* data, size_t len, esp_err_t* err) {
+    send_success = false;
+    xSemaphoreTake(send_sem, 0);  // Drop a late result from a timed-out attempt
 
-        esp_err_t err = esp_now_send(peer_mac, data, len);
-        if (err != ESP_OK) {
-            log_w("esp_now_send error 0x%X (attempt %d/%d)",
-                  err, attempt, ESPNOW_MAX_RETRIES);
-            delay(ESPNOW_RETRY_MS);
-            continue;
-        }
+    *err = esp_now_send(peer_mac, data, len);
+    if (*err != ESP_OK) {
+        return false;
+    }
 
-        // Wait for the delivery callback (timeout ~500 ms)
-        unsigned long t0 = millis();
-        while (!send_done && (millis() - t0 < 500)) {
-            delay(1);
-        }
+    // Wait for the delivery callback (timeout 500 ms)
+    power_wait_begin();
+    bool done = (xSemaphoreTake(send_sem, pdMS_TO_TICKS(500)) == pdTRUE);
+    power_wait_end();
+    return done && send_success;
+}
+
+// ── Send with retries ───────────────────────────────────────────────
+// stamp(ctx, attempt) runs before each attempt (nullptr: none).
+typedef void (*attempt_stamp_fn)(void* ctx, int attempt);
 
-        if (send_success) {
+static bool send_with_retries(const uint8_t* data, size_t len,
+                              attempt_stamp_fn stamp, void* ctx) {
+    for (int attempt = 1; attempt <= ESPNOW_MAX_RETRIES; attempt++) {
+        if (stamp != nullptr) {
+            stamp(ctx, attempt);
+        }
+        esp_err_t err;
+        if (send_attempt(data, len, &err)) {
             log_i("Payload delivered (attempt %d/%d)", attempt, ESPNOW_MAX_RETRIES);
             return true;
         }
 
-        log_w("Delivery failed (attempt %d/%d)", attempt, ESPNOW_MAX_RETRIES);
+        if (err != ESP_OK) {
+            log_w("esp_now_send error 0x%X (attempt %d/%d)",
+                  err, attempt, ESPNOW_MAX_RETRIES);
+        } else {
+            log_w("Delivery failed (attempt %d/%d)", attempt, ESPNOW_MAX_RETRIES);
+        }
         if (attempt < ESPNOW_MAX_RETRIES) {
-            delay(ESPNOW_RETRY_MS);
+            power_wait_ms(ESPNOW_RETRY_MS);
         }
     }
 
     log_e("All %d send attempts failed", ESPNOW_MAX_RETRIES);
     return false;
 }
+
+bool comms_send(const uint8_t* data, size_t len) {
+    return send_with_retries(data, len, nullptr, nullptr);
+}
+
+// ── Send a reading, stamping its latency trace ──────────────────────
+struct ReadingTrace {
+    bee_count_payload_t* p;
+    uint32_t capture_ms;
+    uint32_t first_ms;
+};
+
+static void stamp_reading(void* ctx, int attempt) {
+    ReadingTrace* t = (ReadingTrace*)ctx;
+    uint32_t now = millis();
+    if (attempt == 1) {
+        t->first_ms = now;
+    }
+    payload_stamp_trace(t->p, t->first_ms - t->capture_ms, now - t->first_ms,
+                        (uint8_t)attempt);
+}
+
+bool comms_send_reading(bee_count_payload_t* p, uint32_t capture_ms) {
+    ReadingTrace trace = {p, capture_ms, 0};
+    return send_with_retries((const uint8_t*)p, PAYLOAD_SIZE_V2, stamp_reading, &trace);
+}
+
+// ── Send once (FEC uplink) ──────────────────────────────────────────
+bool comms_send_once(const uint8_t* data, size_t len) {
+    esp_err_t err;
+    bool acked = send_attempt(data, len, &err);
+    if (err != ESP_OK) {
+        log_w("esp_now_send error 0x%X", err);
+    } else if (!acked) {
+        log_w("Payload not acknowledged (no retry, parity covers it)");
+    }
+    return acked;
+}
+
+// ── Shutdown ────────────────────────────────────────────────────────
+void comms_deinit() {
+    esp_now_deinit();
+    WiFi.mode(WIFI_OFF);
+    power_radio(false);
+}
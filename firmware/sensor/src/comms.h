@@ -9,6 +9,8 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#include "payload.h"
+
 // Initialise ESP-NOW and register the bridge as a peer.
 // bridge_mac must point to a 6-byte MAC address.
 // Returns true on success.
@@ -19,4 +21,19 @@ bool comms_init(const uint8_t* bridge_mac);
 // Returns true if delivery was acknowledged.
 bool comms_send(const uint8_t* data, size_t len);
 
+// comms_send() for a reading: before every attempt the payload's latency
+// trace (payload.h) is stamped with the attempt number, the time from
+// `capture_ms` (millis() when the sensor reads finished) to the first
+// attempt, and the time spent in retries since.
+bool comms_send_reading(bee_count_payload_t* p, uint32_t capture_ms);
+
+// Send `len` bytes once, for the FEC uplink (UPLINK_FEC_GROUP): no retry,
+// the parity payload covers a loss.  Still waits for the transmission to
+// finish.  Returns true if it was acknowledged.
+bool comms_send_once(const uint8_t* data, size_t len);
+
+// Tear down ESP-NOW and stop Wi-Fi.  The WiFi driver holds a PM lock
+// while it runs, so the node must call this before it sleeps.
+void comms_deinit();
+
 #endif // COMMS_H
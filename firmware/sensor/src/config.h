@@ -23,14 +23,34 @@
 #define PROVISION_PIN    27   // GPIO27 — active LOW enters provisioning
 #define LED_PIN           2   // GPIO2  — on-board LED
 
+// ── Brood thermal array (DS18B20 chain, thermal.h) ──────────────────
+// One 1-Wire bus, 4.7 k pull-up to 3.3 V, probes powered from VDD
+// (3-wire; parasite power is not supported).  Slots are generated by a
+// pair of RMT channels sharing the pin (onewire_rmt.h).  No probes found
+// means no thermal payload.
+#define ONEWIRE_PIN             19  // GPIO19
+#define ONEWIRE_RMT_TX_CHANNEL   0
+#define ONEWIRE_RMT_RX_CHANNEL   1
+
 // ── Timing ──────────────────────────────────────────────────────────
 #define WAKE_INTERVAL_SEC  60 // Deep-sleep duration between readings
 
+// ── Power management ────────────────────────────────────────────────
+// 1: DFS with PM locks and automatic light sleep (power.h).
+// 0: fixed 240 MHz and timer light sleep, for before/after comparisons.
+#define POWER_MANAGEMENT   1
+
 // ── ESP-NOW ─────────────────────────────────────────────────────────
 #define ESPNOW_CHANNEL     1  // Wi-Fi channel for ESP-NOW
 #define ESPNOW_MAX_RETRIES 3  // Transmit attempts before giving up
 #define ESPNOW_RETRY_MS  100  // Delay between retries (ms)
 
+// Uplink forward error correction (fec.h).
+// 0: every payload is retried until acknowledged (above).
+// K (2..FEC_MAX_GROUP): every payload is sent once, plus a parity payload
+// after each K; the bridge rebuilds one lost payload per group.
+#define UPLINK_FEC_GROUP   0
+
 // ── Battery thresholds ──────────────────────────────────────────────
 #define LOW_BATTERY_MV  3300  // Below this → LOW_BATTERY flag set
 
@@ -0,0 +1,156 @@
+// Waggle Sensor Node — Forward error correction for uplink payloads.
+//
+// With UPLINK_FEC_GROUP = K the node sends every Phase 2 payload once,
+// without retries, and after every K consecutive sequences a parity
+// payload (msg_type 0x03, payload.h) holding the XOR of their protected
+// bytes.  The receiver keeps the last FEC_HISTORY payloads per node; when
+// the parity arrives and exactly one of the K is missing, XOR-ing the
+// parity with the K-1 it has gives back the missing bytes, and the
+// embedded CRC-8 confirms the result.  One lost packet per group is
+// repaired at the cost of one extra transmission per K readings,
+// instead of up to ESPNOW_MAX_RETRIES attempts with radio-on gaps.
+//
+// The encoder runs on the sensor node (node.h), the decoder on the bridge
+// (firmware/bridge/src/main.cpp) and in the simulator's frame sink.
+// Header-only like payload.h: the bridge includes it from here.
+
+#ifndef FEC_H
+#define FEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "payload.h"
+
+#define FEC_MAX_GROUP  8              // Largest K a parity payload may cover
+#define FEC_HISTORY    FEC_MAX_GROUP  // Payloads the decoder keeps per node
+
+// ── Encoder (sensor node) ───────────────────────────────────────────
+struct FecEncoder {
+    uint8_t  hive_id;
+    uint16_t first_seq;
+    uint8_t  count;                // Payloads folded into parity so far
+    uint8_t  parity[PARITY_LEN];
+};
+
+inline void fec_encoder_reset(FecEncoder* e) {
+    memset(e, 0, sizeof(*e));
+}
+
+// Fold one payload into the current group.  A payload that does not
+// follow the group (node restart, different hive) starts a new group.
+// Returns true once `group` payloads are covered: send the parity
+// (fec_build_parity) and reset the encoder.
+inline bool fec_encoder_add(FecEncoder* e, const bee_count_payload_t* p, uint8_t group) {
+    if (e->count != 0 &&
+        (p->hive_id != e->hive_id || p->sequence != (uint16_t)(e->first_seq + e->count))) {
+        fec_encoder_reset(e);
+    }
+    if (e->count == 0) {
+        e->hive_id = p->hive_id;
+        e->first_seq = p->sequence;
+    }
+    const uint8_t* bytes = (const uint8_t*)p + PARITY_OFFSET;
+    for (uint8_t i = 0; i < PARITY_LEN; i++) {
+        e->parity[i] ^= bytes[i];
+    }
+    e->count++;
+    return e->count >= group;
+}
+
+inline void fec_build_parity(parity_payload_t* out, const FecEncoder* e) {
+    memset(out, 0, sizeof(parity_payload_t));
+    out->hive_id   = e->hive_id;
+    out->msg_type  = MSG_TYPE_PARITY;
+    out->first_seq = e->first_seq;
+    out->count     = e->count;
+    memcpy(out->parity, e->parity, PARITY_LEN);
+    out->crc = crc8((const uint8_t*)out, offsetof(parity_payload_t, crc));
+}
+
+// ── Decoder (bridge / hub side) ─────────────────────────────────────
+// Payload history of one node.  Slot seq % FEC_HISTORY holds that
+// sequence's protected bytes.
+struct FecDecoder {
+    uint16_t sequence[FEC_HISTORY];
+    bool     valid[FEC_HISTORY];
+    uint8_t  bytes[FEC_HISTORY][PARITY_LEN];
+};
+
+enum FecStatus : uint8_t {
+    FEC_COMPLETE = 0,   // Nothing in the group was lost
+    FEC_RECOVERED,      // One payload rebuilt into *out
+    FEC_TOO_MANY_LOST,  // Two or more lost; parity cannot help
+    FEC_BAD_PARITY,     // Parity CRC/count invalid, or rebuild failed its CRC
+};
+
+inline void fec_decoder_reset(FecDecoder* d) {
+    memset(d, 0, sizeof(*d));
+}
+
+// Record a received Phase 2 payload.  Payloads failing their CRC are
+// ignored (they could not be used to rebuild anything).
+inline void fec_decoder_note(FecDecoder* d, const bee_count_payload_t* p) {
+    if (p->msg_type != MSG_TYPE_BEE_COUNT || crc8((const uint8_t*)p, 17) != p->crc) {
+        return;
+    }
+    uint8_t slot = (uint8_t)(p->sequence % FEC_HISTORY);
+    d->sequence[slot] = p->sequence;
+    d->valid[slot] = true;
+    memcpy(d->bytes[slot], (const uint8_t*)p + PARITY_OFFSET, PARITY_LEN);
+}
+
+// True if the history holds payload `seq`.
+inline bool fec_decoder_has(const FecDecoder* d, uint16_t seq) {
+    uint8_t slot = (uint8_t)(seq % FEC_HISTORY);
+    return d->valid[slot] && d->sequence[slot] == seq;
+}
+
+// Apply a parity payload.  On FEC_RECOVERED the missing payload is
+// written to *out (and recorded, so a repeated parity finds nothing
+// missing).
+inline FecStatus fec_decoder_recover(FecDecoder* d, const parity_payload_t* parity,
+                                     bee_count_payload_t* out) {
+    if (parity->msg_type != MSG_TYPE_PARITY || parity->count < 2 ||
+        parity->count > FEC_MAX_GROUP ||
+        crc8((const uint8_t*)parity, offsetof(parity_payload_t, crc)) != parity->crc) {
+        return FEC_BAD_PARITY;
+    }
+
+    uint8_t rebuilt[PARITY_LEN];
+    memcpy(rebuilt, parity->parity, PARITY_LEN);
+    uint8_t  lost = 0;
+    uint16_t lost_seq = 0;
+    for (uint8_t i = 0; i < parity->count; i++) {
+        uint16_t seq = (uint16_t)(parity->first_seq + i);
+        if (!fec_decoder_has(d, seq)) {
+            lost++;
+            lost_seq = seq;
+            continue;
+        }
+        const uint8_t* bytes = d->bytes[seq % FEC_HISTORY];
+        for (uint8_t j = 0; j < PARITY_LEN; j++) {
+            rebuilt[j] ^= bytes[j];
+        }
+    }
+    if (lost == 0) {
+        return FEC_COMPLETE;
+    }
+    if (lost > 1) {
+        return FEC_TOO_MANY_LOST;
+    }
+
+    memset(out, 0, sizeof(bee_count_payload_t));
+    out->hive_id  = parity->hive_id;
+    out->msg_type = MSG_TYPE_BEE_COUNT;
+    out->sequence = lost_seq;
+    memcpy((uint8_t*)out + PARITY_OFFSET, rebuilt, PARITY_LEN);
+    if (crc8((const uint8_t*)out, 17) != out->crc) {
+        return FEC_BAD_PARITY;
+    }
+    fec_decoder_note(d, out);
+    return FEC_RECOVERED;
+}
+
+#endif // FEC_H
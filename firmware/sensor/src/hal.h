@@ -0,0 +1,164 @@
+// Waggle Sensor Node — Hardware abstraction layer (compile-time backends).
+//
+// The wake cycle in node.h talks to hardware only through Hal<Impl>.
+// Backends derive from it CRTP-style and provide the *_impl methods:
+//
+//   Esp32Hal (hal_esp32.h)   inline forwarders to Arduino / ESP-IDF and
+//                            the existing sensors, comms, provision,
+//                            bee_counter and activity_trigger modules
+//   SimHal   (../sim/)       Linux simulation with virtual time, scripted
+//                            sensors, GPIO beam edges and ESP-NOW delivery
+//
+// Dispatch is resolved at compile time and every forwarder is inline, so
+// the ESP32 build compiles to the same direct calls main.cpp made before.
+//
+// Impl must define (private is fine with `friend class Hal<Impl>;`):
+//
+//   uint32_t millis_impl();
+//   void     delay_ms_impl(uint32_t ms);
+//   void     light_sleep_us_impl(uint64_t us);   // timer wake; ISRs keep running
+//   bool     first_boot_impl();
+//   void     power_init_impl();
+//   void     cpu_busy_impl(bool busy);
+//   PowerProfile power_profile_impl(bool reset);
+//   void     gpio_output_impl(uint8_t pin);
+//   void     gpio_write_impl(uint8_t pin, bool high);
+//   uint8_t  sensors_init_impl();
+//   int32_t  read_weight_g_impl(uint8_t* flags);
+//   int16_t  read_temperature_x100_impl(uint8_t* flags);
+//   uint16_t read_humidity_x100_impl(uint8_t* flags);
+//   uint16_t read_pressure_x10_impl(uint8_t* flags);
+//   uint16_t read_battery_mv_impl();
+//   uint8_t  thermal_start_impl();
+//   void     thermal_collect_impl(ThermalReading* out);
+//   bool     radio_init_impl(const uint8_t* bridge_mac);
+//   bool     radio_send_impl(const uint8_t* data, size_t len);
+//   bool     radio_send_once_impl(const uint8_t* data, size_t len);
+//   bool     radio_send_reading_impl(bee_count_payload_t* p, uint32_t capture_ms);
+//   void     radio_deinit_impl();
+//   void     provision_check_impl();
+//   void     provision_load_impl();
+//   uint8_t  provision_hive_id_impl();
+//   const uint8_t* provision_bridge_mac_impl();
+//   bool     provision_is_configured_impl();
+//   void     bee_counter_init_impl(uint8_t lane_mask);
+//   BeeCountSnapshot bee_counter_snapshot_impl();
+//   void     activity_trigger_begin_impl(uint8_t pin, const ActivityTriggerConfig* cfg);
+//   uint32_t activity_trigger_service_impl();
+//   uint32_t activity_trigger_count_impl();
+//   uint8_t  activity_trigger_last_reason_impl();
+//
+// Semantics match the module functions of the same name (see sensors.h,
+// thermal.h, comms.h, provision.h, bee_counter.h, activity_trigger.h,
+// power.h).
+// cpu_busy is power_busy(); delay_ms blocks without the busy lock.
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "activity_trigger.h"
+#include "bee_counter.h"
+#include "power.h"
+#include "thermal.h"
+
+// ── Logging on native builds ──────────────────────────────────────────
+// The ESP32 core provides log_i/log_w/log_e.  Native builds route them
+// to hal_log(), which is silent unless hal_log_enabled() is set.
+#ifdef UNIT_TEST
+#include <stdarg.h>
+#include <stdio.h>
+
+inline bool& hal_log_enabled() {
+    static bool enabled = false;
+    return enabled;
+}
+
+inline void hal_log(char level, const char* fmt, ...) {
+    if (!hal_log_enabled()) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "[%c] ", level);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+#ifndef log_i
+#define log_i(fmt, ...) hal_log('I', fmt, ##__VA_ARGS__)
+#define log_w(fmt, ...) hal_log('W', fmt, ##__VA_ARGS__)
+#define log_e(fmt, ...) hal_log('E', fmt, ##__VA_ARGS__)
+#define log_d(fmt, ...) hal_log('D', fmt, ##__VA_ARGS__)
+#endif
+#endif // UNIT_TEST
+
+template <typename Impl>
+class Hal {
+public:
+    // ── Time and power ──
+    uint32_t millis()                   { return impl().millis_impl(); }
+    void     delay_ms(uint32_t ms)      { impl().delay_ms_impl(ms); }
+    void     light_sleep_us(uint64_t us) { impl().light_sleep_us_impl(us); }
+    bool     first_boot()               { return impl().first_boot_impl(); }
+    void     power_init()               { impl().power_init_impl(); }
+    void     cpu_busy(bool busy)        { impl().cpu_busy_impl(busy); }
+    PowerProfile power_profile(bool reset) { return impl().power_profile_impl(reset); }
+
+    // ── GPIO ──
+    void gpio_output(uint8_t pin)            { impl().gpio_output_impl(pin); }
+    void gpio_write(uint8_t pin, bool high)  { impl().gpio_write_impl(pin, high); }
+
+    // ── Sensors ──
+    uint8_t  sensors_init()                        { return impl().sensors_init_impl(); }
+    int32_t  read_weight_g(uint8_t* flags)         { return impl().read_weight_g_impl(flags); }
+    int16_t  read_temperature_x100(uint8_t* flags) { return impl().read_temperature_x100_impl(flags); }
+    uint16_t read_humidity_x100(uint8_t* flags)    { return impl().read_humidity_x100_impl(flags); }
+    uint16_t read_pressure_x10(uint8_t* flags)     { return impl().read_pressure_x10_impl(flags); }
+    uint16_t read_battery_mv()                     { return impl().read_battery_mv_impl(); }
+
+    // ── Brood thermal array (DS18B20 chain) ──
+    uint8_t thermal_start()                     { return impl().thermal_start_impl(); }
+    void    thermal_collect(ThermalReading* out) { impl().thermal_collect_impl(out); }
+
+    // ── ESP-NOW radio ──
+    bool radio_init(const uint8_t* bridge_mac)      { return impl().radio_init_impl(bridge_mac); }
+    bool radio_send(const uint8_t* data, size_t len) { return impl().radio_send_impl(data, len); }
+    bool radio_send_once(const uint8_t* data, size_t len) {
+        return impl().radio_send_once_impl(data, len);
+    }
+    bool radio_send_reading(bee_count_payload_t* p, uint32_t capture_ms) {
+        return impl().radio_send_reading_impl(p, capture_ms);
+    }
+    void radio_deinit()                              { impl().radio_deinit_impl(); }
+
+    // ── Provisioning ──
+    void           provision_check()         { impl().provision_check_impl(); }
+    void           provision_load()          { impl().provision_load_impl(); }
+    uint8_t        provision_hive_id()       { return impl().provision_hive_id_impl(); }
+    const uint8_t* provision_bridge_mac()    { return impl().provision_bridge_mac_impl(); }
+    bool           provision_is_configured() { return impl().provision_is_configured_impl(); }
+
+    // ── Bee counter (beam ISRs live in the backend) ──
+    void bee_counter_init(uint8_t lane_mask) { impl().bee_counter_init_impl(lane_mask); }
+    BeeCountSnapshot bee_counter_snapshot()  { return impl().bee_counter_snapshot_impl(); }
+
+    // ── Activity trigger (camera wake line) ──
+    void activity_trigger_begin(uint8_t pin, const ActivityTriggerConfig* cfg) {
+        impl().activity_trigger_begin_impl(pin, cfg);
+    }
+    uint32_t activity_trigger_service()     { return impl().activity_trigger_service_impl(); }
+    uint32_t activity_trigger_count()       { return impl().activity_trigger_count_impl(); }
+    uint8_t  activity_trigger_last_reason() { return impl().activity_trigger_last_reason_impl(); }
+
+protected:
+    Hal() {}
+
+private:
+    Impl& impl() { return *static_cast<Impl*>(this); }
+};
+
+#endif // HAL_H
@@ -0,0 +1,89 @@
+// Waggle Sensor Node — ESP32 HAL backend.
+//
+// Inline forwarders from Hal<Esp32Hal> to Arduino / ESP-IDF and the
+// hardware modules.  Stateless; every call compiles to the direct call
+// it wraps.
+
+#ifndef HAL_ESP32_H
+#define HAL_ESP32_H
+
+#ifndef UNIT_TEST
+
+#include <Arduino.h>
+#include <esp_sleep.h>
+
+#include "hal.h"
+#include "sensors.h"
+#include "thermal.h"
+#include "comms.h"
+#include "provision.h"
+#include "bee_counter.h"
+#include "activity_trigger.h"
+#include "power.h"
+
+class Esp32Hal : public Hal<Esp32Hal> {
+    friend class Hal<Esp32Hal>;
+
+    // ── Time and power ──
+    uint32_t millis_impl()                { return ::millis(); }
+    void     delay_ms_impl(uint32_t ms)   { ::power_wait_ms(ms); }
+    void     light_sleep_us_impl(uint64_t us) { ::power_sleep_us(us); }
+    void     power_init_impl()            { ::power_init(); }
+    void     cpu_busy_impl(bool busy)     { ::power_busy(busy); }
+    PowerProfile power_profile_impl(bool reset) { return ::power_profile(reset); }
+
+    // POWERON or UNKNOWN (brownout recovery) indicate a fresh start.
+    // DEEPSLEEP indicates a normal wake cycle (not first boot).
+    bool first_boot_impl() {
+        esp_reset_reason_t reason = esp_reset_reason();
+        return (reason == ESP_RST_POWERON || reason == ESP_RST_UNKNOWN);
+    }
+
+    // ── GPIO ──
+    void gpio_output_impl(uint8_t pin)           { pinMode(pin, OUTPUT); }
+    void gpio_write_impl(uint8_t pin, bool high) { digitalWrite(pin, high ? HIGH : LOW); }
+
+    // ── Sensors ──
+    uint8_t  sensors_init_impl()                        { return ::sensors_init(); }
+    int32_t  read_weight_g_impl(uint8_t* flags)         { return ::read_weight_g(flags); }
+    int16_t  read_temperature_x100_impl(uint8_t* flags) { return ::read_temperature_x100(flags); }
+    uint16_t read_humidity_x100_impl(uint8_t* flags)    { return ::read_humidity_x100(flags); }
+    uint16_t read_pressure_x10_impl(uint8_t* flags)     { return ::read_pressure_x10(flags); }
+    uint16_t read_battery_mv_impl()                     { return ::read_battery_mv(); }
+
+    // ── Brood thermal array ──
+    uint8_t thermal_start_impl()                     { return ::thermal_start(); }
+    void    thermal_collect_impl(ThermalReading* out) { ::thermal_collect(out); }
+
+    // ── ESP-NOW radio ──
+    bool radio_init_impl(const uint8_t* bridge_mac)            { return ::comms_init(bridge_mac); }
+    bool radio_send_impl(const uint8_t* data, size_t len)      { return ::comms_send(data, len); }
+    bool radio_send_once_impl(const uint8_t* data, size_t len) { return ::comms_send_once(data, len); }
+    bool radio_send_reading_impl(bee_count_payload_t* p, uint32_t capture_ms) {
+        return ::comms_send_reading(p, capture_ms);
+    }
+    void radio_deinit_impl()                                   { ::comms_deinit(); }
+
+    // ── Provisioning ──
+    void           provision_check_impl()         { ::provision_check(); }
+    void           provision_load_impl()          { ::provision_load(); }
+    uint8_t        provision_hive_id_impl()       { return ::provision_hive_id(); }
+    const uint8_t* provision_bridge_mac_impl()    { return ::provision_bridge_mac(); }
+    bool           provision_is_configured_impl() { return ::provision_is_configured(); }
+
+    // ── Bee counter ──
+    void bee_counter_init_impl(uint8_t lane_mask)  { ::bee_counter_init(lane_mask); }
+    BeeCountSnapshot bee_counter_snapshot_impl()   { return ::bee_counter_snapshot(); }
+
+    // ── Activity trigger ──
+    void activity_trigger_begin_impl(uint8_t pin, const ActivityTriggerConfig* cfg) {
+        ::activity_trigger_begin(pin, cfg);
+    }
+    uint32_t activity_trigger_service_impl()     { return ::activity_trigger_service(); }
+    uint32_t activity_trigger_count_impl()       { return ::activity_trigger_count(); }
+    uint8_t  activity_trigger_last_reason_impl() { return ::activity_trigger_last_reason(); }
+};
+
+#endif // UNIT_TEST
+
+#endif // HAL_ESP32_H
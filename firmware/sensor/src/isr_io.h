@@ -0,0 +1,74 @@
+// Waggle Sensor Node — Flash-safe primitives for the beam interrupt path.
+//
+// The beam ISR is registered with ESP_INTR_FLAG_IRAM, so it keeps running
+// while the flash cache is disabled (NVS writes from the provisioning
+// console, OTA).  Everything it reaches must then be in IRAM or DRAM:
+// functions marked ISR_CODE, data in RAM (const tables such as
+// BEAM_A_PINS live in flash), and no Arduino calls.  digitalRead(),
+// digitalWrite() and millis() are not guaranteed to be IRAM resident, so
+// the helpers below read and write the GPIO registers and the esp_timer
+// counter directly; they are forced inline into their ISR_CODE callers.
+//
+// Switch statements in ISR_CODE must not become jump tables (the table
+// would be in flash): the sensor env builds with -fno-jump-tables.
+//
+// In native builds (UNIT_TEST) only ISR_CODE is defined, and is empty.
+
+#ifndef ISR_IO_H
+#define ISR_IO_H
+
+#include <stdint.h>
+
+#ifdef UNIT_TEST
+
+#define ISR_CODE
+
+#else
+
+#include <esp_attr.h>
+#include <esp_timer.h>
+#include <soc/gpio_struct.h>
+#include <xtensa/core-macros.h>
+
+#define ISR_CODE   IRAM_ATTR
+#define ISR_INLINE static inline __attribute__((always_inline))
+
+// Input level of GPIO 0-39.
+ISR_INLINE bool isr_gpio_read(uint8_t pin) {
+    return (pin < 32) ? ((GPIO.in >> pin) & 1u) : ((GPIO.in1.data >> (pin - 32)) & 1u);
+}
+
+// Drive output GPIO 0-33.
+ISR_INLINE void isr_gpio_write(uint8_t pin, bool high) {
+    if (pin < 32) {
+        if (high) {
+            GPIO.out_w1ts = 1u << pin;
+        } else {
+            GPIO.out_w1tc = 1u << pin;
+        }
+    } else if (high) {
+        GPIO.out1_w1ts.val = 1u << (pin - 32);
+    } else {
+        GPIO.out1_w1tc.val = 1u << (pin - 32);
+    }
+}
+
+// Interrupt type of GPIO 0-39 (GPIO_INTR_LOW_LEVEL, ...).  Leaves the
+// pin's enable and wakeup bits alone.
+ISR_INLINE void isr_gpio_set_intr_type(uint8_t pin, uint32_t type) {
+    GPIO.pin[pin].int_type = type;
+}
+
+// millis() from esp_timer_get_time(), which is IRAM resident.
+ISR_INLINE uint32_t isr_millis() {
+    return (uint32_t)(esp_timer_get_time() / 1000ULL);
+}
+
+// CPU cycle counter (CCOUNT); wraps every ~17.9 s at 240 MHz.
+ISR_INLINE uint32_t isr_cycles() {
+    return XTHAL_GET_CCOUNT();
+}
+
+#endif // UNIT_TEST
+
+#endif // ISR_IO_H
@@ -0,0 +1,287 @@
+// Waggle Sensor Node — Wake cycle, written against the HAL.
+//
+// Lifecycle on each wake:
+//   0. Log the previous cycle's average current (power profile)
+//   1. Check provisioning pin (GPIO27) — if LOW, enter serial console
+//   2. Load NVS config (hive ID, bridge MAC, calibration)
+//   3. Verify configuration — if unconfigured, blink and light-sleep
+//   4. Initialise bee counter and activity trigger (first wake only)
+//   5. Start the brood thermal array converting (thermal.h), if fitted
+//   6. Initialise and read all sensors
+//   7. Take bee counter snapshot
+//   8. Build 48-byte payload with CRC-8 (msg_type 0x02); its latency
+//      trace is stamped per transmit attempt, relative to this point
+//   9. Collect the thermal array into a 44-byte payload (msg_type 0x04);
+//      its 750 ms conversion has run during steps 6-8
+//  10. Transmit via ESP-NOW (up to 3 retries, or once plus a parity
+//      payload every UPLINK_FEC_GROUP readings — fec.h), then stop the radio
+//  11. Light sleep for WAKE_INTERVAL_SEC (ISRs remain active)
+//
+// The max-frequency PM lock is held from the start of the wake until the
+// sleep; blocking waits in the backend drop it (power.h).
+//
+// The bee counter ISRs also feed the activity trigger, which raises the
+// camera node's wake line when traffic spikes.  Light sleep is split so
+// the line is released once its hold time has elapsed.
+//
+// SensorNode<Impl> is instantiated with Esp32Hal in main.cpp and with
+// SimHal by the host simulator and native tests.
+
+#ifndef NODE_H
+#define NODE_H
+
+#include <stdint.h>
+
+#include "hal.h"
+#include "config.h"
+#include "fec.h"
+#include "payload.h"
+#include "tunnel_config.h"
+
+// ── Bee counter lane configuration ──────────────────────────────────
+// Enable all 4 lanes by default.  Override via NVS in future.
+#define DEFAULT_LANE_MASK  0x0F
+
+static_assert(UPLINK_FEC_GROUP == 0 ||
+              (UPLINK_FEC_GROUP >= 2 && UPLINK_FEC_GROUP <= FEC_MAX_GROUP),
+              "UPLINK_FEC_GROUP must be 0 or 2..FEC_MAX_GROUP");
+
+template <typename Impl>
+class SensorNode {
+public:
+    // sequence points at storage that survives sleep (RTC memory on the
+    // ESP32).  fec_group selects the uplink (UPLINK_FEC_GROUP semantics;
+    // the simulator compares both).
+    SensorNode(Hal<Impl>& hal, uint16_t* sequence, uint8_t fec_group = UPLINK_FEC_GROUP)
+        : hal_(hal), sequence_(sequence),
+          fec_group_(fec_group > FEC_MAX_GROUP ? FEC_MAX_GROUP : fec_group),
+          power_ready_(false), bee_counter_ready_(false) {
+        fec_encoder_reset(&fec_);
+    }
+
+    // One full wake: provision check, read, transmit, light sleep.
+    // setup() and loop() both call this.
+    void wake() {
+        if (!power_ready_) {
+            hal_.power_init();
+            power_ready_ = true;
+        }
+        hal_.cpu_busy(true);
+        log_i("Waggle sensor wake — seq=%u", *sequence_);
+        log_power_profile();
+
+        // Provisioning check (never returns if pin is LOW)
+        hal_.provision_check();
+        hal_.provision_load();
+
+        if (!hal_.provision_is_configured()) {
+            log_w("Not configured (hive_id=%u) — blinking and sleeping",
+                  hal_.provision_hive_id());
+            blink_unconfigured();
+            // Use light sleep even when unconfigured so the next wake can retry
+            enter_light_sleep();
+            return;
+        }
+
+        // Bee counter must run before the first sleep so ISRs count
+        if (!bee_counter_ready_) {
+            start_bee_counter();
+            log_i("Bee counter initialised, lane_mask=0x%02X", DEFAULT_LANE_MASK);
+        }
+
+        // The probes convert while the other sensors are read
+        uint8_t probes = hal_.thermal_start();
+
+        bee_count_payload_t payload;
+        build_payload(&payload);
+        uint32_t capture_ms = hal_.millis();
+
+        log_i("Payload: hive=%u seq=%u wt=%d t=%d h=%u p=%u bat=%u flags=0x%02X "
+              "in=%u out=%u period=%u lanes=0x%02X stuck=0x%02X crc=0x%02X",
+              payload.hive_id, payload.sequence, payload.weight_g,
+              payload.temp_c_x100, payload.humidity_x100, payload.pressure_hpa_x10,
+              payload.battery_mv, payload.flags,
+              payload.bees_in, payload.bees_out, payload.period_ms,
+              payload.lane_mask, payload.stuck_mask, payload.crc);
+
+        thermal_payload_t thermal;
+        if (probes != 0) {
+            build_thermal(&thermal);
+        }
+
+        // Transmit via ESP-NOW
+        bool radio_up = hal_.radio_init(hal_.provision_bridge_mac());
+        if (!radio_up) {
+            log_e("ESP-NOW init failed — skipping transmission");
+        }
+        if (fec_group_ >= 2) {
+            send_with_parity(&payload, capture_ms, radio_up);
+        } else if (radio_up && !hal_.radio_send_reading(&payload, capture_ms)) {
+            log_e("Payload delivery failed after retries");
+        }
+        if (probes != 0 && radio_up) {
+            send_thermal(&thermal);
+        }
+        hal_.radio_deinit();
+
+        // Increment sequence and sleep
+        (*sequence_)++;
+        enter_light_sleep();
+    }
+
+private:
+    // ── Average current of the cycle that just ended ──
+    void log_power_profile() {
+        PowerProfile p = hal_.power_profile(true);
+        uint64_t total_us = power_profile_total_us(&p);
+        if (total_us == 0) {
+            return;
+        }
+        log_i("Last cycle: %.2f mA avg over %u ms (active %u, idle %u, radio %u, sleep %u ms)",
+              power_profile_avg_ma(&p), (uint32_t)(total_us / 1000),
+              (uint32_t)(p.us[POWER_ACTIVE] / 1000), (uint32_t)(p.us[POWER_IDLE] / 1000),
+              (uint32_t)(p.us[POWER_RADIO] / 1000), (uint32_t)(p.us[POWER_SLEEP] / 1000));
+    }
+
+    // ── Bee counter + activity trigger bring-up ──
+    void start_bee_counter() {
+        static const ActivityTriggerConfig trigger_cfg = {
+            ACTIVITY_WINDOW_MS,
+            ACTIVITY_IN_THRESHOLD,
+            ACTIVITY_OUT_THRESHOLD,
+            ACTIVITY_HOLD_MS,
+            ACTIVITY_HOLDOFF_MS,
+        };
+        hal_.activity_trigger_begin(ACTIVITY_TRIGGER_PIN, &trigger_cfg);
+        hal_.bee_counter_init(DEFAULT_LANE_MASK);
+        bee_counter_ready_ = true;
+    }
+
+    // ── Read sensors and bee counts into a Phase 2 payload ──
+    void build_payload(bee_count_payload_t* payload) {
+        uint8_t  flags    = hal_.sensors_init();
+        int32_t  weight   = hal_.read_weight_g(&flags);
+        int16_t  temp     = hal_.read_temperature_x100(&flags);
+        uint16_t humidity = hal_.read_humidity_x100(&flags);
+        uint16_t pressure = hal_.read_pressure_x10(&flags);
+        uint16_t battery  = hal_.read_battery_mv();
+
+        if (hal_.first_boot()) {
+            flags |= FLAG_FIRST_BOOT;
+        }
+        if (battery < LOW_BATTERY_MV) {
+            flags |= FLAG_LOW_BATTERY;
+        }
+
+        // Bee counts accumulated since the last wake
+        BeeCountSnapshot bee_snap = hal_.bee_counter_snapshot();
+        if (hal_.activity_trigger_count() != 0) {
+            log_i("Activity triggers since boot: %u (last reason=%u)",
+                  hal_.activity_trigger_count(), hal_.activity_trigger_last_reason());
+        }
+
+        if (bee_snap.bees_in == 65535 || bee_snap.bees_out == 65535) {
+            flags |= FLAG_MEASUREMENT_CLAMPED;
+        }
+        if (bee_snap.stuck_mask != 0) {
+            flags |= FLAG_COUNTER_STUCK;
+        }
+
+        payload_build_v2(payload,
+                         hal_.provision_hive_id(),
+                         *sequence_,
+                         weight,
+                         temp,
+                         humidity,
+                         pressure,
+                         battery,
+                         flags,
+                         bee_snap.bees_in,
+                         bee_snap.bees_out,
+                         bee_snap.period_ms,
+                         bee_snap.lane_mask,
+                         bee_snap.stuck_mask);
+    }
+
+    // ── Thermal array readings into a thermal payload ──
+    void build_thermal(thermal_payload_t* thermal) {
+        ThermalReading reading;
+        hal_.thermal_collect(&reading);
+        payload_build_thermal(thermal, hal_.provision_hive_id(), *sequence_,
+                              reading.temp_x16, reading.count, reading.flags);
+        log_i("Thermal: %u probes, base=%d/16 C, flags=0x%02X", thermal->probe_count,
+              thermal->base_x16, thermal->thermal_flags);
+    }
+
+    // Same uplink policy as the Phase 2 payload; parity covers only
+    // Phase 2 payloads, so under FEC a lost thermal payload stays lost.
+    void send_thermal(const thermal_payload_t* thermal) {
+        bool sent = (fec_group_ >= 2)
+                        ? hal_.radio_send_once((const uint8_t*)thermal, PAYLOAD_SIZE_THERMAL)
+                        : hal_.radio_send((const uint8_t*)thermal, PAYLOAD_SIZE_THERMAL);
+        if (!sent) {
+            log_e("Thermal payload delivery failed");
+        }
+    }
+
+    // ── FEC uplink: send once, parity after every fec_group_ payloads ──
+    // A payload that could not be sent is still folded into the parity,
+    // so the bridge can rebuild it if it is the only one missing.  The
+    // trace lies outside the parity span; a rebuilt payload has none.
+    void send_with_parity(bee_count_payload_t* payload, uint32_t capture_ms, bool radio_up) {
+        if (radio_up) {
+            payload_stamp_trace(payload, hal_.millis() - capture_ms, 0, 1);
+            hal_.radio_send_once((const uint8_t*)payload, PAYLOAD_SIZE_V2);
+        }
+        if (!fec_encoder_add(&fec_, payload, fec_group_)) {
+            return;
+        }
+        parity_payload_t parity;
+        fec_build_parity(&parity, &fec_);
+        fec_encoder_reset(&fec_);
+        log_i("Parity: seq %u..%u", parity.first_seq,
+              (uint16_t)(parity.first_seq + parity.count - 1));
+        if (radio_up) {
+            hal_.radio_send_once((const uint8_t*)&parity, PAYLOAD_SIZE_PARITY);
+        }
+    }
+
+    // ── Light sleep (ISRs keep running) ──
+    // While the camera wake line is asserted, sleep only until its release
+    // is due, drop the line, then sleep out the remainder of the interval.
+    void enter_light_sleep() {
+        log_i("Light sleeping for %d s (seq will be %u)", WAKE_INTERVAL_SEC, *sequence_);
+        hal_.cpu_busy(false);
+        uint64_t remaining_us = (uint64_t)WAKE_INTERVAL_SEC * 1000000ULL;
+
+        uint32_t release_ms;
+        while ((release_ms = hal_.activity_trigger_service()) != 0 &&
+               (uint64_t)release_ms * 1000ULL < remaining_us) {
+            hal_.light_sleep_us((uint64_t)release_ms * 1000ULL);
+            remaining_us -= (uint64_t)release_ms * 1000ULL;
+        }
+
+        hal_.light_sleep_us(remaining_us);
+        // Execution resumes here after light sleep
+    }
+
+    // ── Blink pattern for unconfigured state ──
+    void blink_unconfigured() {
+        hal_.gpio_output(LED_PIN);
+        for (int i = 0; i < 5; i++) {
+            hal_.gpio_write(LED_PIN, true);
+            hal_.delay_ms(100);
+            hal_.gpio_write(LED_PIN, false);
+            hal_.delay_ms(100);
+        }
+    }
+
+    Hal<Impl>& hal_;
+    uint16_t*  sequence_;
+    uint8_t    fec_group_;
+    FecEncoder fec_;
+    bool       power_ready_;
+    bool       bee_counter_ready_;
+};
+
+#endif // NODE_H
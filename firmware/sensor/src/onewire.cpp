@@ -0,0 +1,132 @@
+// Waggle Sensor Node — 1-Wire protocol implementation (see onewire.h).
+
+#include "onewire.h"
+
+#include <string.h>
+
+uint8_t onewire_crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t j = 0; j < 8; j++) {
+            crc = (crc & 0x01) ? (uint8_t)((crc >> 1) ^ 0x8C) : (uint8_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+void onewire_write_byte(OneWireBus* bus, uint8_t value) {
+    bus->ops->write_bits(bus->ctx, value, 8);
+}
+
+uint8_t onewire_read_byte(OneWireBus* bus) {
+    return bus->ops->read_bits(bus->ctx, 8);
+}
+
+// ── ROM search ──────────────────────────────────────────────────────
+// Each pass walks the 64 ROM bits.  Every device still selected answers
+// a read slot with its bit and then its complement; 0/1 or 1/0 means all
+// agree, 0/0 is a discrepancy.  At a discrepancy the pass takes the path
+// it took last time below last_discrepancy, 1 at it and 0 above it, so
+// each pass walks the tree of ROM codes one leaf further.
+uint8_t onewire_search(OneWireBus* bus, uint8_t (*roms)[ONEWIRE_ROM_LEN], uint8_t max,
+                       uint8_t family) {
+    uint8_t rom[ONEWIRE_ROM_LEN];
+    memset(rom, 0, sizeof(rom));
+    uint8_t last_discrepancy = 0;
+    uint8_t found = 0;
+
+    while (found < max) {
+        if (!bus->ops->reset(bus->ctx)) {
+            break;
+        }
+        onewire_write_byte(bus, ONEWIRE_CMD_SEARCH_ROM);
+
+        uint8_t last_zero = 0;
+        bool ok = true;
+        for (uint8_t bit = 1; bit <= 64; bit++) {
+            uint8_t pair = bus->ops->read_bits(bus->ctx, 2);
+            bool id_bit = (pair & 0x01) != 0;
+            bool cmp_bit = (pair & 0x02) != 0;
+            if (id_bit && cmp_bit) {
+                ok = false;  // Nobody answered (device left mid-search)
+                break;
+            }
+
+            uint8_t byte = (uint8_t)((bit - 1) / 8);
+            uint8_t mask = (uint8_t)(1u << ((bit - 1) % 8));
+            bool dir;
+            if (id_bit != cmp_bit) {
+                dir = id_bit;
+            } else if (bit < last_discrepancy) {
+                dir = (rom[byte] & mask) != 0;
+            } else {
+                dir = (bit == last_discrepancy);
+            }
+            if (!dir && id_bit == cmp_bit) {
+                last_zero = bit;
+            }
+
+            if (dir) {
+                rom[byte] |= mask;
+            } else {
+                rom[byte] &= (uint8_t)~mask;
+            }
+            bus->ops->write_bits(bus->ctx, dir ? 1 : 0, 1);
+        }
+        if (!ok) {
+            break;
+        }
+
+        if (onewire_crc8(rom, ONEWIRE_ROM_LEN) == 0 && (family == 0 || rom[0] == family)) {
+            memcpy(roms[found], rom, ONEWIRE_ROM_LEN);
+            found++;
+        }
+        last_discrepancy = last_zero;
+        if (last_discrepancy == 0) {
+            break;  // That was the last device
+        }
+    }
+    return found;
+}
+
+// ── DS18B20 ─────────────────────────────────────────────────────────
+
+bool onewire_convert_all(OneWireBus* bus) {
+    if (!bus->ops->reset(bus->ctx)) {
+        return false;
+    }
+    onewire_write_byte(bus, ONEWIRE_CMD_SKIP_ROM);
+    onewire_write_byte(bus, DS18B20_CMD_CONVERT_T);
+    return true;
+}
+
+Ds18b20Status ds18b20_read(OneWireBus* bus, const uint8_t* rom, int16_t* temp_x16) {
+    if (!bus->ops->reset(bus->ctx)) {
+        return DS18B20_NO_PRESENCE;
+    }
+    onewire_write_byte(bus, ONEWIRE_CMD_MATCH_ROM);
+    for (uint8_t i = 0; i < ONEWIRE_ROM_LEN; i++) {
+        onewire_write_byte(bus, rom[i]);
+    }
+    onewire_write_byte(bus, DS18B20_CMD_READ_SCRATCH);
+
+    uint8_t pad[DS18B20_SCRATCHPAD_LEN];
+    uint8_t all = 0xFF;
+    for (uint8_t i = 0; i < DS18B20_SCRATCHPAD_LEN; i++) {
+        pad[i] = onewire_read_byte(bus);
+        all &= pad[i];
+    }
+    if (all == 0xFF) {
+        return DS18B20_NO_PRESENCE;  // Pull-up only: the probe did not answer
+    }
+    if (onewire_crc8(pad, DS18B20_SCRATCHPAD_LEN) != 0) {
+        return DS18B20_BAD_CRC;
+    }
+    uint16_t raw = (uint16_t)(pad[0] | (pad[1] << 8));
+    if (raw == DS18B20_POWER_ON_RAW) {
+        return DS18B20_NOT_CONVERTED;
+    }
+    *temp_x16 = (int16_t)raw;
+    return DS18B20_OK;
+}
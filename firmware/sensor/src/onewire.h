@@ -0,0 +1,77 @@
+// Waggle Sensor Node — 1-Wire bus protocol and DS18B20 commands.
+//
+// Pure protocol layer: ROM search, convert-all, scratchpad reads and the
+// Dallas/Maxim CRC, written against a OneWireBus that only knows how to
+// reset the bus and move slots.  The ESP32 backend (onewire_rmt.h)
+// generates the slots with the RMT peripheral; the native tests drive a
+// simulated chain of probes.
+//
+// Bits go LSB first, as on the wire.  Probes must be powered from VDD:
+// no strong pull-up is driven during conversions (parasite power is not
+// supported).
+
+#ifndef ONEWIRE_H
+#define ONEWIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ── Bus backend ─────────────────────────────────────────────────────
+struct OneWireOps {
+    // Reset pulse; true if at least one device answered with presence.
+    bool    (*reset)(void* ctx);
+    // Write the low `nbits` bits of value (1-8), LSB first.
+    void    (*write_bits)(void* ctx, uint8_t value, uint8_t nbits);
+    // Generate `nbits` read slots (1-8); the bits, LSB first.
+    uint8_t (*read_bits)(void* ctx, uint8_t nbits);
+};
+
+struct OneWireBus {
+    const OneWireOps* ops;
+    void*             ctx;
+};
+
+// ── ROM and function commands ───────────────────────────────────────
+#define ONEWIRE_ROM_LEN            8
+#define ONEWIRE_CMD_SEARCH_ROM     0xF0
+#define ONEWIRE_CMD_MATCH_ROM      0x55
+#define ONEWIRE_CMD_SKIP_ROM       0xCC
+#define DS18B20_CMD_CONVERT_T      0x44
+#define DS18B20_CMD_READ_SCRATCH   0xBE
+
+#define DS18B20_FAMILY             0x28
+#define DS18B20_SCRATCHPAD_LEN     9
+#define DS18B20_CONVERT_MS         750     // 12-bit conversion, worst case
+#define DS18B20_POWER_ON_RAW       0x0550  // 85 °C: reset value, never converted
+
+enum Ds18b20Status : uint8_t {
+    DS18B20_OK = 0,
+    DS18B20_NO_PRESENCE,    // Nobody answered the reset, or all-ones read back
+    DS18B20_BAD_CRC,        // Scratchpad CRC mismatch (noise, bad contact)
+    DS18B20_NOT_CONVERTED,  // Still the power-on value
+};
+
+// Dallas/Maxim CRC-8 (x^8 + x^5 + x^4 + 1, reflected 0x8C, init 0).
+// A ROM code or scratchpad including its CRC byte checks to 0.
+uint8_t onewire_crc8(const uint8_t* data, size_t len);
+
+void    onewire_write_byte(OneWireBus* bus, uint8_t value);
+uint8_t onewire_read_byte(OneWireBus* bus);
+
+// Enumerate the bus with the ROM search algorithm (Maxim AN187).  Stores
+// up to `max` CRC-valid ROM codes of `family` (0 = any) and returns how
+// many were stored.  The order depends only on the ROM codes, so it is
+// the same on every search of the same chain.
+uint8_t onewire_search(OneWireBus* bus, uint8_t (*roms)[ONEWIRE_ROM_LEN], uint8_t max,
+                       uint8_t family);
+
+// Start a temperature conversion on every probe at once (SKIP ROM +
+// CONVERT T).  Returns false if no device answered the reset.  Results
+// are ready DS18B20_CONVERT_MS later.
+bool onewire_convert_all(OneWireBus* bus);
+
+// Read one probe's scratchpad (MATCH ROM + READ SCRATCHPAD) and return
+// its temperature in 1/16 °C.
+Ds18b20Status ds18b20_read(OneWireBus* bus, const uint8_t* rom, int16_t* temp_x16);
+
+#endif // ONEWIRE_H
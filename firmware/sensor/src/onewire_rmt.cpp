@@ -0,0 +1,195 @@
+// Waggle Sensor Node — 1-Wire RMT backend (see onewire_rmt.h).
+
+#include "onewire_rmt.h"
+
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <driver/rmt.h>
+#include <freertos/ringbuf.h>
+#include <soc/gpio_sig_map.h>
+
+// ── Slot timing (µs; 1 tick = 1 µs at clk_div 80) ──────────────────────
+#define ONEWIRE_RESET_LOW_US      480
+#define ONEWIRE_RESET_WAIT_US     70    // Then presence, then RX idle
+#define ONEWIRE_PRESENCE_MIN_US   60    // Shortest presence pulse (datasheet)
+#define ONEWIRE_SLOT_US           70
+#define ONEWIRE_WRITE1_LOW_US     6
+#define ONEWIRE_WRITE0_LOW_US     60
+#define ONEWIRE_READ_LOW_US       6
+#define ONEWIRE_READ_SAMPLE_US    15    // Low for longer: a device sent 0
+
+// RX ends a capture once the line has been high this long; longer than
+// any high gap inside a transaction (presence wait, slot recovery).
+#define ONEWIRE_RX_IDLE_US        100
+#define ONEWIRE_RX_FILTER_TICKS   30    // APB ticks (375 ns): glitch filter
+#define ONEWIRE_RX_TIMEOUT_MS     20
+#define ONEWIRE_RX_RING_BYTES     512
+
+#define ONEWIRE_CLK_DIV           80    // 80 MHz APB → 1 µs ticks
+
+static rmt_item32_t slot_item(uint32_t low_us) {
+    rmt_item32_t item;
+    item.level0 = 0;
+    item.duration0 = low_us;
+    item.level1 = 1;
+    item.duration1 = (low_us < ONEWIRE_SLOT_US) ? ONEWIRE_SLOT_US - low_us : 1;
+    return item;
+}
+
+// Send `count` items and return the captured line as alternating
+// (level, duration) runs in *runs; returns the number of items received.
+static size_t transact(OneWireRmt* r, const rmt_item32_t* items, size_t count,
+                       rmt_item32_t** runs) {
+    rmt_channel_t rx = (rmt_channel_t)r->rx_channel;
+    RingbufHandle_t ring = (RingbufHandle_t)r->rx_ring;
+
+    // Drop anything left from an earlier capture
+    size_t stale_len = 0;
+    void* stale;
+    while ((stale = xRingbufferReceive(ring, &stale_len, 0)) != nullptr) {
+        vRingbufferReturnItem(ring, stale);
+    }
+
+    rmt_rx_start(rx, true);
+    rmt_write_items((rmt_channel_t)r->tx_channel, items, count, true);
+
+    size_t len = 0;
+    *runs = (rmt_item32_t*)xRingbufferReceive(ring, &len, pdMS_TO_TICKS(ONEWIRE_RX_TIMEOUT_MS));
+    rmt_rx_stop(rx);
+    return (*runs != nullptr) ? len / sizeof(rmt_item32_t) : 0;
+}
+
+static void release(OneWireRmt* r, rmt_item32_t* runs) {
+    if (runs != nullptr) {
+        vRingbufferReturnItem((RingbufHandle_t)r->rx_ring, runs);
+    }
+}
+
+// Call fn(level, duration) for each run of the capture, in order.  A run
+// of duration 0 marks the end (the idle threshold was reached).
+template <typename Fn>
+static void for_each_run(const rmt_item32_t* runs, size_t n, Fn fn) {
+    for (size_t i = 0; i < n; i++) {
+        if (runs[i].duration0 == 0) {
+            return;
+        }
+        fn(runs[i].level0, runs[i].duration0);
+        if (runs[i].duration1 == 0) {
+            return;
+        }
+        fn(runs[i].level1, runs[i].duration1);
+    }
+}
+
+// ── OneWireOps ──────────────────────────────────────────────────────
+
+static bool rmt_reset(void* ctx) {
+    OneWireRmt* r = (OneWireRmt*)ctx;
+    rmt_item32_t item;
+    item.level0 = 0;
+    item.duration0 = ONEWIRE_RESET_LOW_US;
+    item.level1 = 1;
+    item.duration1 = ONEWIRE_RESET_WAIT_US;
+
+    rmt_item32_t* runs = nullptr;
+    size_t n = transact(r, &item, 1, &runs);
+
+    // The first low run is our reset pulse; a later one is a presence pulse.
+    bool presence = false;
+    int lows = 0;
+    for_each_run(runs, n, [&](uint32_t level, uint32_t us) {
+        if (level == 0 && lows++ > 0 && us >= ONEWIRE_PRESENCE_MIN_US) {
+            presence = true;
+        }
+    });
+    release(r, runs);
+    return presence;
+}
+
+static void rmt_write_bits(void* ctx, uint8_t value, uint8_t nbits) {
+    OneWireRmt* r = (OneWireRmt*)ctx;
+    rmt_item32_t items[8];
+    for (uint8_t i = 0; i < nbits; i++) {
+        items[i] = slot_item((value >> i) & 0x01 ? ONEWIRE_WRITE1_LOW_US : ONEWIRE_WRITE0_LOW_US);
+    }
+    rmt_write_items((rmt_channel_t)r->tx_channel, items, nbits, true);
+}
+
+static uint8_t rmt_read_bits(void* ctx, uint8_t nbits) {
+    OneWireRmt* r = (OneWireRmt*)ctx;
+    rmt_item32_t items[8];
+    for (uint8_t i = 0; i < nbits; i++) {
+        items[i] = slot_item(ONEWIRE_READ_LOW_US);
+    }
+
+    rmt_item32_t* runs = nullptr;
+    size_t n = transact(r, items, nbits, &runs);
+
+    // One low run per slot; slots the capture missed read as 1 (idle bus).
+    uint8_t value = (uint8_t)((1u << nbits) - 1);
+    uint8_t slot = 0;
+    for_each_run(runs, n, [&](uint32_t level, uint32_t us) {
+        if (level != 0 || slot >= nbits) {
+            return;
+        }
+        if (us > ONEWIRE_READ_SAMPLE_US) {
+            value &= (uint8_t)~(1u << slot);
+        }
+        slot++;
+    });
+    release(r, runs);
+    return value;
+}
+
+static const OneWireOps RMT_OPS = {rmt_reset, rmt_write_bits, rmt_read_bits};
+
+// ── Open / close ────────────────────────────────────────────────────
+
+bool onewire_rmt_open(OneWireRmt* rmt, OneWireBus* bus) {
+    gpio_num_t pin = (gpio_num_t)rmt->pin;
+    rmt_channel_t tx = (rmt_channel_t)rmt->tx_channel;
+    rmt_channel_t rx = (rmt_channel_t)rmt->rx_channel;
+
+    rmt_config_t tx_cfg = RMT_DEFAULT_CONFIG_TX(pin, tx);
+    tx_cfg.clk_div = ONEWIRE_CLK_DIV;
+    tx_cfg.tx_config.idle_output_en = true;
+    tx_cfg.tx_config.idle_level = RMT_IDLE_LEVEL_HIGH;
+    if (rmt_config(&tx_cfg) != ESP_OK || rmt_driver_install(tx, 0, 0) != ESP_OK) {
+        log_e("1-Wire: RMT TX channel %u install failed", rmt->tx_channel);
+        return false;
+    }
+
+    rmt_config_t rx_cfg = RMT_DEFAULT_CONFIG_RX(pin, rx);
+    rx_cfg.clk_div = ONEWIRE_CLK_DIV;
+    rx_cfg.rx_config.filter_en = true;
+    rx_cfg.rx_config.filter_ticks_thresh = ONEWIRE_RX_FILTER_TICKS;
+    rx_cfg.rx_config.idle_threshold = ONEWIRE_RX_IDLE_US;
+    if (rmt_config(&rx_cfg) != ESP_OK ||
+        rmt_driver_install(rx, ONEWIRE_RX_RING_BYTES, 0) != ESP_OK) {
+        log_e("1-Wire: RMT RX channel %u install failed", rmt->rx_channel);
+        rmt_driver_uninstall(tx);
+        return false;
+    }
+    RingbufHandle_t ring = nullptr;
+    rmt_get_ringbuf_handle(rx, &ring);
+    rmt->rx_ring = ring;
+
+    // rmt_config() made the pin a plain output, then a plain input.  Make
+    // it open drain with both signals routed, so TX only ever pulls low
+    // and RX sees the probes as well as our own slots.
+    gpio_set_direction(pin, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_pull_mode(pin, GPIO_PULLUP_ONLY);
+    gpio_matrix_out(pin, RMT_SIG_OUT0_IDX + rmt->tx_channel, false, false);
+    gpio_matrix_in(pin, RMT_SIG_IN0_IDX + rmt->rx_channel, false);
+
+    bus->ops = &RMT_OPS;
+    bus->ctx = rmt;
+    return true;
+}
+
+void onewire_rmt_close(OneWireRmt* rmt) {
+    rmt_driver_uninstall((rmt_channel_t)rmt->rx_channel);
+    rmt_driver_uninstall((rmt_channel_t)rmt->tx_channel);
+    rmt->rx_ring = nullptr;
+    gpio_set_direction((gpio_num_t)rmt->pin, GPIO_MODE_INPUT);
+}
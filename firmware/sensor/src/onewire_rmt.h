@@ -0,0 +1,45 @@
+// Waggle Sensor Node — 1-Wire bus backend on the ESP32 RMT peripheral.
+//
+// Two RMT channels share one open-drain pin: the TX channel drives the
+// reset pulse and up to eight time slots per transaction from its item
+// memory, the RX channel records the line so presence pulses and read
+// bits are measured in hardware.  Slot timing therefore does not depend
+// on interrupt latency, the CPU clock or the scheduler, and interrupts
+// (the beam ISRs) are never disabled.  Between transactions the line
+// idles high, which 1-Wire allows for any length of time.
+//
+// Timing (1 µs RMT ticks, standard speed):
+//   reset   480 µs low, presence sampled over the following 480 µs
+//   write 1   6 µs low, 64 µs recovery
+//   write 0  60 µs low, 10 µs recovery
+//   read      6 µs low, released; the bit is 1 if the line is back high
+//             within ONEWIRE_READ_SAMPLE_US
+//
+// Uses the legacy driver/rmt.h API of the Arduino-ESP32 2.x framework.
+
+#ifndef ONEWIRE_RMT_H
+#define ONEWIRE_RMT_H
+
+#ifndef UNIT_TEST
+
+#include <stdint.h>
+
+#include "onewire.h"
+
+struct OneWireRmt {
+    uint8_t pin;
+    uint8_t tx_channel;
+    uint8_t rx_channel;
+    void*   rx_ring;     // RX ring buffer, while open
+};
+
+// Install both RMT channels on rmt->pin and bind `bus` to them.  Returns
+// false if the driver could not be installed.
+bool onewire_rmt_open(OneWireRmt* rmt, OneWireBus* bus);
+
+// Uninstall the channels; the line is left to the pull-up.
+void onewire_rmt_close(OneWireRmt* rmt);
+
+#endif // UNIT_TEST
+
+#endif // ONEWIRE_RMT_H
@@ -2,6 +2,8 @@
 //
 // Phase 1: 32-byte sensor payload (msg_type 0x01)
 // Phase 2: 48-byte bee-counting payload (msg_type 0x02)
+// FEC:     32-byte parity payload (msg_type 0x03, see fec.h)
+// Thermal: 44-byte brood-frame temperature array (msg_type 0x04)
 //
 // Phase 2 payload format (little-endian):
 //   Offset  Size  Type     Field
@@ -20,7 +22,44 @@
 //   22      4     uint32   period_ms (LE)
 //   26      1     uint8    lane_mask
 //   27      1     uint8    stuck_mask
-//   28-47   20    reserved (zeros)
+//   28-39   12    latency trace (payload_trace_t; zeros when absent)
+//   40-47   8     reserved (zeros)
+//
+// Latency trace (reserved bytes 28-39, outside the CRC: diagnostic only).
+// The node fills bytes 28-33 before every transmit attempt, the bridge
+// bytes 34-39 before writing the frame to the hub:
+//   Offset  Size  Type     Field
+//   28      1     uint8    version (TRACE_VERSION; 0 = no trace)
+//   29      1     uint8    tx_attempt (1-based attempt that carried this copy)
+//   30      2     uint16   capture_age_ms (sensor reads done -> first attempt)
+//   32      2     uint16   retry_ms (first attempt -> this attempt)
+//   34      4     uint32   bridge_rx_ms (bridge millis() in the receive callback)
+//   38      2     uint16   bridge_hold_us (receive callback -> serial write)
+//
+// Parity payload format (little-endian), sent after every K Phase 2
+// payloads when UPLINK_FEC_GROUP is set:
+//   Offset  Size  Type     Field
+//   0       1     uint8    hive_id
+//   1       1     uint8    msg_type (0x03 = parity)
+//   2       2     uint16   first_seq (sequence of the first covered payload)
+//   4       1     uint8    count (K, covered payloads first_seq..+K-1)
+//   5       24    uint8[]  XOR of bytes 4-27 of the covered payloads
+//   29      1     uint8    CRC-8 over bytes 0-28
+//   30-31   2     reserved (zeros)
+//
+// Thermal payload format (little-endian), sent after the Phase 2 payload
+// of the same wake when a DS18B20 chain is fitted (thermal.h):
+//   Offset  Size  Type     Field
+//   0       1     uint8    hive_id
+//   1       1     uint8    msg_type (0x04 = thermal array)
+//   2       2     uint16   sequence (same as the wake's Phase 2 payload)
+//   4       1     uint8    probe_count (0-32, probes found on the bus)
+//   5       1     uint8    thermal_flags (THERMAL_FLAG_*)
+//   6       2     int16    base_x16 (1/16 °C, coldest probe rounded down)
+//   8       32    uint8[]  q per probe in bus order: base_x16 + 2*q (1/16 °C),
+//                          i.e. base + q * 0.125 °C; 0xFF = no reading
+//   40-42   3     reserved (zeros)
+//   43      1     uint8    CRC-8 over bytes 0-42
 
 #ifndef PAYLOAD_H
 #define PAYLOAD_H
@@ -31,6 +70,8 @@
 // ── Message types ───────────────────────────────────────────────────
 #define MSG_TYPE_SENSOR      0x01
 #define MSG_TYPE_BEE_COUNT   0x02
+#define MSG_TYPE_PARITY      0x03
+#define MSG_TYPE_THERMAL     0x04
 
 // ── Flag bits ───────────────────────────────────────────────────────
 #define FLAG_FIRST_BOOT          (1 << 0)  // Bit 0
@@ -44,6 +85,28 @@
 // ── Payload sizes ─────────────────────────────────────────────────────
 #define PAYLOAD_SIZE       32   // Phase 1: sensor only
 #define PAYLOAD_SIZE_V2    48   // Phase 2: sensor + bee counting
+#define PAYLOAD_SIZE_PARITY 32  // FEC parity over K Phase 2 payloads
+#define PAYLOAD_SIZE_THERMAL 44 // Brood-frame temperature array
+
+// Phase 2 bytes a parity payload protects: everything after the sequence
+// up to stuck_mask, CRC included (hive_id and msg_type are per node, the
+// sequence follows from first_seq, the rest is reserved).
+#define PARITY_OFFSET       4
+#define PARITY_LEN          24
+
+// Phase 2 latency trace, in the first reserved bytes
+#define TRACE_OFFSET        28
+#define TRACE_VERSION       1
+
+// ── Thermal array ───────────────────────────────────────────────────
+#define THERMAL_MAX_PROBES       32
+#define THERMAL_Q_NONE           0xFF      // Probe gave no reading this wake
+#define THERMAL_Q_MAX            254       // 31.75 °C above the coldest probe
+#define THERMAL_NO_READING       INT16_MIN // Builder input for a failed probe
+
+#define THERMAL_FLAG_BUS_ERROR   (1 << 0)  // No presence pulse on convert-all
+#define THERMAL_FLAG_READ_ERROR  (1 << 1)  // A probe failed (CRC, absent, unconverted)
+#define THERMAL_FLAG_CLAMPED     (1 << 2)  // A reading exceeded the 0.125 °C range
 
 // ── Packed payload struct (Phase 1 — 32 bytes) ───────────────────────
 // Packed to guarantee the exact binary layout on all compilers.
@@ -83,11 +146,51 @@ typedef struct {
     uint32_t period_ms;         // 22-25
     uint8_t  lane_mask;         // 26
     uint8_t  stuck_mask;        // 27
-    // Bytes 28-47: reserved
+    // Bytes 28-47: reserved; 28-39 carry the latency trace (payload_trace_t)
     uint8_t  reserved[20];      // 28-47
 } bee_count_payload_t;
 #pragma pack(pop)
 
+// ── Packed latency trace (12 bytes at Phase 2 offset 28) ─────────────
+#pragma pack(push, 1)
+typedef struct {
+    uint8_t  version;           // 28
+    uint8_t  tx_attempt;        // 29
+    uint16_t capture_age_ms;    // 30-31
+    uint16_t retry_ms;          // 32-33
+    uint32_t bridge_rx_ms;      // 34-37
+    uint16_t bridge_hold_us;    // 38-39
+} payload_trace_t;
+#pragma pack(pop)
+
+// ── Packed parity struct (FEC — 32 bytes) ───────────────────────────
+#pragma pack(push, 1)
+typedef struct {
+    uint8_t  hive_id;           // 0
+    uint8_t  msg_type;          // 1  (0x03 for parity)
+    uint16_t first_seq;         // 2-3
+    uint8_t  count;             // 4
+    uint8_t  parity[PARITY_LEN]; // 5-28
+    uint8_t  crc;               // 29 (CRC-8 over bytes 0-28)
+    uint8_t  reserved[2];       // 30-31
+} parity_payload_t;
+#pragma pack(pop)
+
+// ── Packed thermal struct (44 bytes) ─────────────────────────────────
+#pragma pack(push, 1)
+typedef struct {
+    uint8_t  hive_id;           // 0
+    uint8_t  msg_type;          // 1  (0x04 for thermal array)
+    uint16_t sequence;          // 2-3
+    uint8_t  probe_count;       // 4
+    uint8_t  thermal_flags;     // 5
+    int16_t  base_x16;          // 6-7
+    uint8_t  q[THERMAL_MAX_PROBES]; // 8-39
+    uint8_t  reserved[3];       // 40-42
+    uint8_t  crc;               // 43 (CRC-8 over bytes 0-42)
+} thermal_payload_t;
+#pragma pack(pop)
+
 // ── CRC-8 (poly 0x07, init 0x00) ───────────────────────────────────
 // Matches the Python reference implementation.
 // Test vector: crc8((uint8_t*)"123456789", 9) == 0xF4
@@ -168,4 +271,92 @@ inline void payload_build_v2(bee_count_payload_t* p,
     p->stuck_mask        = stuck_mask;
 }
 
+// ── Build a thermal array payload (44 bytes) ────────────────────────
+// temp_x16 holds `count` probe readings in 1/16 °C (the DS18B20 raw
+// format), THERMAL_NO_READING for a probe that failed.  Readings are
+// stored as 0.125 °C steps above the coldest one (rounded down, so off
+// by at most the probe's own 1/16 °C resolution); a reading more than
+// 31.75 °C above it is clamped and flagged.
+inline void payload_build_thermal(thermal_payload_t* p,
+                                  uint8_t  hive_id,
+                                  uint16_t sequence,
+                                  const int16_t* temp_x16,
+                                  uint8_t  count,
+                                  uint8_t  thermal_flags)
+{
+    memset(p, 0, sizeof(thermal_payload_t));
+    memset(p->q, THERMAL_Q_NONE, sizeof(p->q));
+    if (count > THERMAL_MAX_PROBES) {
+        count = THERMAL_MAX_PROBES;
+    }
+
+    int16_t base = INT16_MAX;
+    for (uint8_t i = 0; i < count; i++) {
+        if (temp_x16[i] == THERMAL_NO_READING) {
+            thermal_flags |= THERMAL_FLAG_READ_ERROR;
+        } else if (temp_x16[i] < base) {
+            base = temp_x16[i];
+        }
+    }
+    if (base == INT16_MAX) {
+        base = 0;  // No readings at all
+    }
+    base = (int16_t)(base & ~1);  // Even, so every step is a whole 1/8 °C
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (temp_x16[i] == THERMAL_NO_READING) {
+            continue;
+        }
+        int32_t steps = ((int32_t)temp_x16[i] - base) / 2;
+        if (steps > THERMAL_Q_MAX) {
+            steps = THERMAL_Q_MAX;
+            thermal_flags |= THERMAL_FLAG_CLAMPED;
+        }
+        p->q[i] = (uint8_t)steps;
+    }
+
+    p->hive_id       = hive_id;
+    p->msg_type      = MSG_TYPE_THERMAL;
+    p->sequence      = sequence;
+    p->probe_count   = count;
+    p->thermal_flags = thermal_flags;
+    p->base_x16      = base;
+    p->crc = crc8((const uint8_t*)p, PAYLOAD_SIZE_THERMAL - 1);
+}
+
+// ── Latency trace stamps ────────────────────────────────────────────
+// Both work on the raw Phase 2 bytes; neither touches the CRC.
+
+inline uint16_t trace_clamp_u16(uint32_t v) {
+    return v > 0xFFFF ? 0xFFFF : (uint16_t)v;
+}
+
+// Node: before each transmit attempt.
+inline void payload_stamp_trace(bee_count_payload_t* p, uint32_t capture_age_ms,
+                                uint32_t retry_ms, uint8_t attempt)
+{
+    payload_trace_t t;
+    memcpy(&t, (const uint8_t*)p + TRACE_OFFSET, sizeof(t));
+    t.version        = TRACE_VERSION;
+    t.tx_attempt     = attempt;
+    t.capture_age_ms = trace_clamp_u16(capture_age_ms);
+    t.retry_ms       = trace_clamp_u16(retry_ms);
+    memcpy((uint8_t*)p + TRACE_OFFSET, &t, sizeof(t));
+}
+
+// Bridge: before writing the frame.  Payloads without a trace (older
+// nodes, payloads rebuilt from parity) are left as they are.
+inline void payload_stamp_bridge(uint8_t* payload, size_t len, uint32_t rx_ms,
+                                 uint32_t hold_us)
+{
+    if (len != PAYLOAD_SIZE_V2 || payload[TRACE_OFFSET] != TRACE_VERSION) {
+        return;
+    }
+    payload_trace_t t;
+    memcpy(&t, payload + TRACE_OFFSET, sizeof(t));
+    t.bridge_rx_ms   = rx_ms;
+    t.bridge_hold_us = trace_clamp_u16(hold_us);
+    memcpy(payload + TRACE_OFFSET, &t, sizeof(t));
+}
+
 #endif // PAYLOAD_H
@@ -0,0 +1,155 @@
+// Waggle Sensor Node — Power management implementation (see power.h).
+
+#ifndef UNIT_TEST
+
+#include "power.h"
+#include "config.h"
+
+#include <Arduino.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <string.h>
+
+// ── Module state ────────────────────────────────────────────────────
+static esp_pm_lock_handle_t s_cpu_lock = nullptr;
+static bool     s_dfs = false;           // esp_pm_configure() succeeded
+static bool     s_auto_sleep = false;    // ... with light_sleep_enable
+static uint32_t s_busy_depth = 0;
+static bool     s_radio_on = false;
+
+static PowerProfile s_profile;
+static PowerState   s_state = POWER_ACTIVE;
+static int64_t      s_state_since_us = 0;
+
+// ── Accounting ──────────────────────────────────────────────────────
+// State while running (waiting = false) or blocked in a wait.
+static PowerState state_for(bool waiting) {
+    if (s_radio_on) {
+        return POWER_RADIO;
+    }
+    if (!s_dfs) {
+        return POWER_ACTIVE;
+    }
+    if (waiting) {
+        return s_auto_sleep ? POWER_SLEEP : POWER_IDLE;
+    }
+    return (s_busy_depth > 0) ? POWER_ACTIVE : POWER_IDLE;
+}
+
+static void enter_state(PowerState state) {
+    int64_t now = esp_timer_get_time();
+    s_profile.us[s_state] += (uint64_t)(now - s_state_since_us);
+    s_state_since_us = now;
+    s_state = state;
+}
+
+// ── Init ────────────────────────────────────────────────────────────
+void power_init() {
+    memset(&s_profile, 0, sizeof(s_profile));
+    s_state_since_us = esp_timer_get_time();
+    s_state = POWER_ACTIVE;
+
+#if POWER_MANAGEMENT
+    esp_err_t err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "waggle", &s_cpu_lock);
+    if (err != ESP_OK) {
+        log_e("PM lock create failed: %d — power management off", err);
+        return;
+    }
+
+    esp_pm_config_esp32_t cfg = {};
+    cfg.max_freq_mhz = POWER_MAX_CPU_MHZ;
+    cfg.min_freq_mhz = POWER_MIN_CPU_MHZ;
+    cfg.light_sleep_enable = true;
+    err = esp_pm_configure(&cfg);
+    if (err == ESP_ERR_NOT_SUPPORTED) {
+        // Framework built without tickless idle: DFS only
+        cfg.light_sleep_enable = false;
+        err = esp_pm_configure(&cfg);
+    }
+    if (err != ESP_OK) {
+        log_w("esp_pm_configure failed: %d — fixed %d MHz", err, POWER_MAX_CPU_MHZ);
+        return;
+    }
+    s_dfs = true;
+    s_auto_sleep = cfg.light_sleep_enable;
+    log_i("Power management: DFS %d-%d MHz, auto light sleep %s",
+          POWER_MIN_CPU_MHZ, POWER_MAX_CPU_MHZ, s_auto_sleep ? "on" : "unavailable");
+#else
+    log_i("Power management disabled — fixed %d MHz, timer light sleep", POWER_MAX_CPU_MHZ);
+#endif
+}
+
+bool power_auto_light_sleep() {
+    return s_auto_sleep;
+}
+
+// ── CPU lock ────────────────────────────────────────────────────────
+void power_busy(bool busy) {
+    if (busy) {
+        if (s_busy_depth++ == 0 && s_dfs) {
+            esp_pm_lock_acquire(s_cpu_lock);
+        }
+    } else if (s_busy_depth > 0) {
+        if (--s_busy_depth == 0 && s_dfs) {
+            esp_pm_lock_release(s_cpu_lock);
+        }
+    }
+    enter_state(state_for(false));
+}
+
+void power_wait_begin() {
+    if (s_busy_depth > 0 && s_dfs) {
+        esp_pm_lock_release(s_cpu_lock);
+    }
+    enter_state(state_for(true));
+}
+
+void power_wait_end() {
+    if (s_busy_depth > 0 && s_dfs) {
+        esp_pm_lock_acquire(s_cpu_lock);
+    }
+    enter_state(state_for(false));
+}
+
+void power_wait_ms(uint32_t ms) {
+    power_wait_begin();
+    delay(ms);
+    power_wait_end();
+}
+
+// ── Sleep between wakes ─────────────────────────────────────────────
+void power_sleep_us(uint64_t us) {
+    enter_state(POWER_SLEEP);
+    if (s_auto_sleep) {
+        vTaskDelay(pdMS_TO_TICKS(us / 1000ULL));
+    } else {
+        // Beam edges are wake sources too; go back to sleep until the
+        // interval is over.
+        int64_t deadline = esp_timer_get_time() + (int64_t)us;
+        int64_t left;
+        while ((left = deadline - esp_timer_get_time()) > 0) {
+            esp_sleep_enable_timer_wakeup((uint64_t)left);
+            esp_light_sleep_start();
+        }
+    }
+    enter_state(state_for(false));
+}
+
+// ── Radio ───────────────────────────────────────────────────────────
+void power_radio(bool on) {
+    s_radio_on = on;
+    enter_state(state_for(false));
+}
+
+// ── Profile ─────────────────────────────────────────────────────────
+PowerProfile power_profile(bool reset) {
+    enter_state(s_state);  // Close the running interval
+    PowerProfile p = s_profile;
+    if (reset) {
+        memset(&s_profile, 0, sizeof(s_profile));
+    }
+    return p;
+}
+
+#endif // UNIT_TEST
@@ -0,0 +1,115 @@
+// Waggle Sensor Node — Power management and per-cycle current profile.
+//
+// With POWER_MANAGEMENT set (config.h) the node runs under ESP-IDF power
+// management instead of a fixed 240 MHz clock:
+//
+//   DFS               the CPU runs at POWER_MIN_CPU_MHZ unless a
+//                     ESP_PM_CPU_FREQ_MAX lock is held; the wake cycle
+//                     holds it only while it computes (power_busy) and
+//                     drops it across every blocking wait (power_wait_ms)
+//   auto light sleep  whenever all tasks are blocked and no lock is held,
+//                     the idle task light-sleeps until the next timer or
+//                     beam edge; the sleep between wakes is a plain task
+//                     delay (power_sleep_us)
+//
+// Automatic light sleep needs CONFIG_PM_ENABLE and
+// CONFIG_FREERTOS_USE_TICKLESS_IDLE.  When the framework was built
+// without tickless idle, power_init() falls back to DFS only and
+// power_sleep_us() to explicit esp_light_sleep_start() calls.
+//
+// Beam pins are GPIO wake sources (see bee_counter.cpp), so edges wake
+// the chip from either kind of light sleep.  The WiFi driver takes its
+// own PM lock while the radio is up; comms_deinit() stops it before the
+// node sleeps.
+//
+// Profiling: time is accounted to one of four states and weighted with
+// typical ESP32-WROOM-32 supply currents to give the average current of
+// each wake cycle, logged at the start of the next wake.  The same
+// accounting runs in the simulator (sim/hal_sim.h), which reports it with
+// and without power management.
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+// ── Power states and their typical supply current (mA) ─────────────────
+enum PowerState : uint8_t {
+    POWER_ACTIVE = 0,   // CPU at 240 MHz, radio off
+    POWER_IDLE   = 1,   // CPU at POWER_MIN_CPU_MHZ, radio off
+    POWER_RADIO  = 2,   // WiFi / ESP-NOW up (RX listen, TX bursts)
+    POWER_SLEEP  = 3,   // Light sleep
+    POWER_STATE_COUNT
+};
+
+#define POWER_MA_ACTIVE  50.0f
+#define POWER_MA_IDLE    22.0f
+#define POWER_MA_RADIO   110.0f
+#define POWER_MA_SLEEP   0.8f
+
+// DFS range.  80 MHz keeps APB at 80 MHz, so UART, I2C and the HX711
+// bit-bang timing see the same peripheral clock at either end.
+#define POWER_MAX_CPU_MHZ  240
+#define POWER_MIN_CPU_MHZ  80
+
+// Microseconds spent in each state since the last reset.
+struct PowerProfile {
+    uint64_t us[POWER_STATE_COUNT];
+};
+
+inline uint64_t power_profile_total_us(const PowerProfile* p) {
+    uint64_t total = 0;
+    for (int s = 0; s < POWER_STATE_COUNT; s++) {
+        total += p->us[s];
+    }
+    return total;
+}
+
+// Time-weighted average supply current in mA (0 for an empty profile).
+inline float power_profile_avg_ma(const PowerProfile* p) {
+    static const float ma[POWER_STATE_COUNT] = {
+        POWER_MA_ACTIVE, POWER_MA_IDLE, POWER_MA_RADIO, POWER_MA_SLEEP,
+    };
+    uint64_t total = power_profile_total_us(p);
+    if (total == 0) {
+        return 0.0f;
+    }
+    double charge = 0.0;
+    for (int s = 0; s < POWER_STATE_COUNT; s++) {
+        charge += (double)ma[s] * (double)p->us[s];
+    }
+    return (float)(charge / (double)total);
+}
+
+#ifndef UNIT_TEST
+
+// Configure DFS and, where the framework supports it, automatic light
+// sleep.  Without POWER_MANAGEMENT only the profiling runs.
+void power_init();
+
+// True once automatic light sleep is active.
+bool power_auto_light_sleep();
+
+// Hold (true) or release (false) the max-frequency lock.  Nests.
+void power_busy(bool busy);
+
+// Block for ms without holding the lock; the CPU may light-sleep.
+void power_wait_ms(uint32_t ms);
+
+// Bracket any other blocking call (semaphore, queue) the same way.
+void power_wait_begin();
+void power_wait_end();
+
+// Sleep between wakes: a task delay under automatic light sleep, else
+// timer light sleep re-entered after each beam wake until us has passed.
+void power_sleep_us(uint64_t us);
+
+// Radio up / down, for the profile (called by comms).
+void power_radio(bool on);
+
+// Time per state since the last reset.
+PowerProfile power_profile(bool reset);
+
+#endif // UNIT_TEST
+
+#endif // POWER_H
@@ -5,20 +5,32 @@
 //   TARE                     Zero the load cell (store offset in NVS)
 //   CALIBRATE <grams>        Place known weight, compute scale factor
 //   STATUS                   Print current config
+//   ISR_STATS [RESET]        Print (then optionally zero) the beam ISR histograms
 //   REBOOT                   Restart the ESP32
+//
+// A 0x00 byte switches the console to the binary protocol of
+// provision_proto.h for the rest of the session (host tool: provtool/).
 
 #include "provision.h"
+#include "bee_counter.h"
 #include "config.h"
 #include "payload.h"
+#include "provision_proto.h"
+#include "tunnel_config.h"
 
 #include <Arduino.h>
 #include <Preferences.h>
 #include <HX711.h>
+#include <esp_system.h>
 
 // ── Shared calibration state (also used by sensors.cpp) ─────────────
 float hx711_scale_factor = 1.0f;
 long  hx711_offset       = 0;
 
+// LED blink period while waiting for input (100 ms on)
+#define PROV_BLINK_TEXT_MS    500
+#define PROV_BLINK_BINARY_MS  200
+
 // ── Module state ────────────────────────────────────────────────────
 static uint8_t  s_hive_id = 0;
 static uint8_t  s_bridge_mac[6] = {0};
@@ -44,35 +56,35 @@ static void print_mac(const uint8_t* mac) {
                   mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
 }
 
-static void blink_led(int count, int on_ms, int off_ms) {
-    for (int i = 0; i < count; i++) {
-        digitalWrite(LED_PIN, HIGH);
-        delay(on_ms);
-        digitalWrite(LED_PIN, LOW);
-        delay(off_ms);
-    }
-}
-
-// ── NVS Load ────────────────────────────────────────────────────────
-void provision_load() {
+// ── NVS ─────────────────────────────────────────────────────────────
+static void nvs_read_config(ProvConfig* cfg) {
     Preferences prefs;
     prefs.begin(NVS_NAMESPACE, true);  // read-only
+    cfg->hive_id = prefs.getUChar("hive_id", 0);
+    memset(cfg->bridge_mac, 0, sizeof(cfg->bridge_mac));
+    cfg->bridge_mac_set = (prefs.getBytes("bridge_mac", cfg->bridge_mac, 6) == 6) ? 1 : 0;
+    cfg->hx_scale  = prefs.getFloat("hx_scale", 1.0f);
+    cfg->hx_offset = (int32_t)prefs.getLong("hx_offset", 0);
+    prefs.end();
+}
 
-    s_hive_id = prefs.getUChar("hive_id", 0);
-
-    size_t mac_len = prefs.getBytes("bridge_mac", s_bridge_mac, 6);
-    s_bridge_mac_set = (mac_len == 6);
-
-    hx711_scale_factor = prefs.getFloat("hx_scale", 1.0f);
-    hx711_offset       = prefs.getLong("hx_offset", 0);
+static void apply_config(const ProvConfig* cfg) {
+    s_hive_id = cfg->hive_id;
+    memcpy(s_bridge_mac, cfg->bridge_mac, 6);
+    s_bridge_mac_set = (cfg->bridge_mac_set != 0);
+    hx711_scale_factor = cfg->hx_scale;
+    hx711_offset       = cfg->hx_offset;
+}
 
-    prefs.end();
+void provision_load() {
+    ProvConfig cfg;
+    nvs_read_config(&cfg);
+    apply_config(&cfg);
 
     log_i("NVS loaded: hive_id=%u, bridge_mac_set=%d, scale=%.2f, offset=%ld",
           s_hive_id, s_bridge_mac_set, hx711_scale_factor, hx711_offset);
 }
 
-// ── NVS Save helpers ────────────────────────────────────────────────
 static void nvs_save_hive_id(uint8_t id) {
     Preferences prefs;
     prefs.begin(NVS_NAMESPACE, false);
@@ -87,127 +99,272 @@ static void nvs_save_bridge_mac(const uint8_t* mac) {
     prefs.end();
 }
 
-static void nvs_save_calibration(float scale, long offset) {
+static bool nvs_save_calibration(float scale, long offset) {
     Preferences prefs;
     prefs.begin(NVS_NAMESPACE, false);
-    prefs.putFloat("hx_scale", scale);
-    prefs.putLong("hx_offset", offset);
+    bool ok = prefs.putFloat("hx_scale", scale) != 0 &&
+              prefs.putLong("hx_offset", offset) != 0;
+    prefs.end();
+    return ok;
+}
+
+// Every key in one NVS session (binary WRITE_CONFIG)
+static bool nvs_save_config(const ProvConfig* cfg) {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        return false;
+    }
+    bool ok = prefs.putUChar("hive_id", cfg->hive_id) != 0 &&
+              prefs.putBytes("bridge_mac", cfg->bridge_mac, 6) == 6 &&
+              prefs.putFloat("hx_scale", cfg->hx_scale) != 0 &&
+              prefs.putLong("hx_offset", cfg->hx_offset) != 0;
     prefs.end();
+    return ok;
+}
+
+// ── Load cell (shared by the text and binary consoles) ──────────────
+static uint8_t hx711_tare(HX711* scale, uint16_t settle_ms, uint8_t samples, int32_t* offset) {
+    if (!scale->wait_ready_timeout(1000)) {
+        return PROV_STATUS_HX711;
+    }
+    delay(settle_ms);
+    scale->tare(samples);
+    hx711_offset = scale->get_offset();
+    if (!nvs_save_calibration(hx711_scale_factor, hx711_offset)) {
+        return PROV_STATUS_NVS;
+    }
+    *offset = (int32_t)hx711_offset;
+    return PROV_STATUS_OK;
+}
+
+static uint8_t hx711_calibrate(HX711* scale, float known_grams, uint16_t settle_ms,
+                               uint8_t samples, float* factor) {
+    if (!scale->wait_ready_timeout(1000)) {
+        return PROV_STATUS_HX711;
+    }
+    delay(settle_ms);
+    // Read raw average and compute scale factor
+    long raw = scale->read_average(samples);
+    if (raw == hx711_offset) {
+        return PROV_STATUS_NO_WEIGHT;
+    }
+    hx711_scale_factor = (float)(raw - hx711_offset) / known_grams;
+    if (!nvs_save_calibration(hx711_scale_factor, hx711_offset)) {
+        return PROV_STATUS_NVS;
+    }
+    *factor = hx711_scale_factor;
+    return PROV_STATUS_OK;
+}
+
+// ── Binary protocol backend (provision_proto.h) ─────────────────────
+static void be_node_mac(void*, uint8_t mac[6]) {
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+}
+
+static void be_load(void*, ProvConfig* out) {
+    nvs_read_config(out);
+}
+
+static uint8_t be_save(void*, const ProvConfig* cfg) {
+    if (!nvs_save_config(cfg)) {
+        return PROV_STATUS_NVS;
+    }
+    apply_config(cfg);
+    return PROV_STATUS_OK;
+}
+
+static uint8_t be_tare(void* ctx, const ProvTareArgs* args, int32_t* offset) {
+    return hx711_tare((HX711*)ctx, args->settle_ms, args->samples, offset);
+}
+
+static uint8_t be_calibrate(void* ctx, const ProvCalibrateArgs* args, float* scale) {
+    return hx711_calibrate((HX711*)ctx, args->known_g, args->settle_ms, args->samples, scale);
+}
+
+static void send_message(const ProvMessage* m) {
+    uint8_t wire[PROV_MAX_WIRE];
+    size_t n = prov_encode(m, wire);
+    Serial.write(wire, n);
+    Serial.flush();
+}
+
+// ── Text commands ───────────────────────────────────────────────────
+static void print_prompt() {
+    Serial.print("waggle> ");
+}
+
+static void handle_text_command(String line, HX711* scale_prov) {
+    line.trim();
+    if (line.length() == 0) {
+        return;
+    }
+
+    // ── SET_ID ──────────────────────────────────────────────
+    if (line.startsWith("SET_ID ")) {
+        int id = line.substring(7).toInt();
+        if (id < 1 || id > 250) {
+            Serial.println("ERROR: ID must be 1-250");
+            return;
+        }
+        s_hive_id = (uint8_t)id;
+        nvs_save_hive_id(s_hive_id);
+        Serial.printf("OK: hive_id=%u\n", s_hive_id);
+    }
+    // ── SET_BRIDGE ──────────────────────────────────────────
+    else if (line.startsWith("SET_BRIDGE ")) {
+        String mac_str = line.substring(11);
+        mac_str.trim();
+        uint8_t mac[6];
+        if (!parse_mac(mac_str.c_str(), mac)) {
+            Serial.println("ERROR: Invalid MAC format (use AA:BB:CC:DD:EE:FF)");
+            return;
+        }
+        memcpy(s_bridge_mac, mac, 6);
+        s_bridge_mac_set = true;
+        nvs_save_bridge_mac(s_bridge_mac);
+        Serial.print("OK: bridge_mac=");
+        print_mac(s_bridge_mac);
+        Serial.println();
+    }
+    // ── TARE ────────────────────────────────────────────────
+    else if (line == "TARE") {
+        if (!scale_prov->wait_ready_timeout(1000)) {
+            Serial.println("ERROR: HX711 not ready");
+            return;
+        }
+        Serial.println("Taring... remove all weight from the scale.");
+        int32_t offset;
+        if (hx711_tare(scale_prov, 2000, 20, &offset) != PROV_STATUS_OK) {  // average 20 readings
+            Serial.println("ERROR: Tare failed");
+            return;
+        }
+        Serial.printf("OK: offset=%ld\n", (long)offset);
+    }
+    // ── CALIBRATE ───────────────────────────────────────────
+    else if (line.startsWith("CALIBRATE ")) {
+        float known_grams = line.substring(10).toFloat();
+        if (known_grams <= 0) {
+            Serial.println("ERROR: Specify positive weight in grams");
+            return;
+        }
+        if (!scale_prov->wait_ready_timeout(1000)) {
+            Serial.println("ERROR: HX711 not ready");
+            return;
+        }
+        Serial.printf("Calibrating with %.1f g... place weight now.\n", known_grams);
+        float factor;
+        uint8_t status = hx711_calibrate(scale_prov, known_grams, 3000, 20, &factor);
+        if (status == PROV_STATUS_NO_WEIGHT) {
+            Serial.println("ERROR: Raw reading equals offset — no weight detected?");
+            return;
+        }
+        if (status != PROV_STATUS_OK) {
+            Serial.println("ERROR: Calibration failed");
+            return;
+        }
+        Serial.printf("OK: scale_factor=%.4f\n", factor);
+    }
+    // ── STATUS ──────────────────────────────────────────────
+    else if (line == "STATUS") {
+        Serial.println("--- Waggle Sensor Status ---");
+        Serial.printf("  hive_id:     %u\n", s_hive_id);
+        Serial.print("  bridge_mac:  ");
+        if (s_bridge_mac_set) {
+            print_mac(s_bridge_mac);
+        } else {
+            Serial.print("(not set)");
+        }
+        Serial.println();
+        Serial.printf("  hx711_scale: %.4f\n", hx711_scale_factor);
+        Serial.printf("  hx711_offset:%ld\n", hx711_offset);
+        Serial.printf("  configured:  %s\n", provision_is_configured() ? "YES" : "NO");
+        Serial.println("----------------------------");
+    }
+    // ── ISR_STATS ───────────────────────────────────────────
+    else if (line == "ISR_STATS" || line == "ISR_STATS RESET") {
+        bee_counter_print_isr_stats();
+        if (line.endsWith("RESET")) {
+            LaneIsrStats discard[NUM_CHANNELS];
+            bee_counter_isr_stats(discard, true);
+            Serial.println("OK: ISR statistics reset");
+        }
+    }
+    // ── REBOOT ──────────────────────────────────────────────
+    else if (line == "REBOOT") {
+        Serial.println("Rebooting...");
+        delay(500);
+        ESP.restart();
+    }
+    // ── Unknown ─────────────────────────────────────────────
+    else {
+        Serial.println("ERROR: Unknown command. Try STATUS for help.");
+    }
 }
 
 // ── Provisioning serial loop ────────────────────────────────────────
+// Bytes are polled rather than read a line at a time, so the LED blinks
+// without holding up input.  The first 0x00 (never typed) switches the
+// console to the binary protocol.
 static void provision_loop() {
     Serial.println();
     Serial.println("=== WAGGLE PROVISIONING MODE ===");
     Serial.println("Commands: SET_ID <n>, SET_BRIDGE <MAC>, TARE,");
-    Serial.println("          CALIBRATE <grams>, STATUS, REBOOT");
+    Serial.println("          CALIBRATE <grams>, STATUS, ISR_STATS [RESET], REBOOT");
+    Serial.println("          (binary protocol: send 0x00, see provision_proto.h)");
     Serial.println();
 
     // Temporary HX711 for tare/calibrate
     HX711 scale_prov;
     scale_prov.begin(HX711_DOUT_PIN, HX711_SCK_PIN);
 
+    const ProvBackend backend = {be_node_mac, be_load, be_save, be_tare, be_calibrate,
+                                 &scale_prov};
+    ProvReader reader;
+    prov_reader_reset(&reader);
+    bool binary = false;
+    String line;
+    uint32_t blink_ms = millis();
+
+    print_prompt();
     while (true) {
-        Serial.print("waggle> ");
+        // Slow blink while waiting, fast once in binary mode
+        uint32_t period = binary ? PROV_BLINK_BINARY_MS : PROV_BLINK_TEXT_MS;
+        uint32_t phase = (millis() - blink_ms) % period;
+        digitalWrite(LED_PIN, phase < 100 ? HIGH : LOW);
 
-        // Wait for serial input
-        while (!Serial.available()) {
-            blink_led(1, 100, 400);  // slow blink while waiting
+        int c = Serial.read();
+        if (c < 0) {
+            delay(1);
+            continue;
         }
 
-        String line = Serial.readStringUntil('\n');
-        line.trim();
-        if (line.length() == 0) continue;
-
-        // ── SET_ID ──────────────────────────────────────────────
-        if (line.startsWith("SET_ID ")) {
-            int id = line.substring(7).toInt();
-            if (id < 1 || id > 250) {
-                Serial.println("ERROR: ID must be 1-250");
-                continue;
+        if (!binary && c != 0x00) {
+            if (c == '\n') {
+                handle_text_command(line, &scale_prov);
+                line = "";
+                print_prompt();
+            } else if (c != '\r' && line.length() < 64) {
+                line += (char)c;
             }
-            s_hive_id = (uint8_t)id;
-            nvs_save_hive_id(s_hive_id);
-            Serial.printf("OK: hive_id=%u\n", s_hive_id);
+            continue;
         }
-        // ── SET_BRIDGE ──────────────────────────────────────────
-        else if (line.startsWith("SET_BRIDGE ")) {
-            String mac_str = line.substring(11);
-            mac_str.trim();
-            uint8_t mac[6];
-            if (!parse_mac(mac_str.c_str(), mac)) {
-                Serial.println("ERROR: Invalid MAC format (use AA:BB:CC:DD:EE:FF)");
-                continue;
-            }
-            memcpy(s_bridge_mac, mac, 6);
-            s_bridge_mac_set = true;
-            nvs_save_bridge_mac(s_bridge_mac);
-            Serial.print("OK: bridge_mac=");
-            print_mac(s_bridge_mac);
-            Serial.println();
+        if (!binary) {
+            binary = true;
+            line = "";
+            log_i("Provisioning: binary protocol v%u", PROV_PROTO_VERSION);
         }
-        // ── TARE ────────────────────────────────────────────────
-        else if (line == "TARE") {
-            if (!scale_prov.wait_ready_timeout(1000)) {
-                Serial.println("ERROR: HX711 not ready");
-                continue;
-            }
-            Serial.println("Taring... remove all weight from the scale.");
-            delay(2000);
-            scale_prov.tare(20);  // average 20 readings
-            hx711_offset = scale_prov.get_offset();
-            nvs_save_calibration(hx711_scale_factor, hx711_offset);
-            Serial.printf("OK: offset=%ld\n", hx711_offset);
-        }
-        // ── CALIBRATE ───────────────────────────────────────────
-        else if (line.startsWith("CALIBRATE ")) {
-            float known_grams = line.substring(10).toFloat();
-            if (known_grams <= 0) {
-                Serial.println("ERROR: Specify positive weight in grams");
-                continue;
-            }
-            if (!scale_prov.wait_ready_timeout(1000)) {
-                Serial.println("ERROR: HX711 not ready");
-                continue;
-            }
-            Serial.printf("Calibrating with %.1f g... place weight now.\n", known_grams);
-            delay(3000);
-            // Read raw average and compute scale factor
-            long raw = scale_prov.read_average(20);
-            if (raw == hx711_offset) {
-                Serial.println("ERROR: Raw reading equals offset — no weight detected?");
-                continue;
-            }
-            hx711_scale_factor = (float)(raw - hx711_offset) / known_grams;
-            nvs_save_calibration(hx711_scale_factor, hx711_offset);
-            Serial.printf("OK: scale_factor=%.4f\n", hx711_scale_factor);
-        }
-        // ── STATUS ──────────────────────────────────────────────
-        else if (line == "STATUS") {
-            Serial.println("--- Waggle Sensor Status ---");
-            Serial.printf("  hive_id:     %u\n", s_hive_id);
-            Serial.print("  bridge_mac:  ");
-            if (s_bridge_mac_set) {
-                print_mac(s_bridge_mac);
-            } else {
-                Serial.print("(not set)");
-            }
-            Serial.println();
-            Serial.printf("  hx711_scale: %.4f\n", hx711_scale_factor);
-            Serial.printf("  hx711_offset:%ld\n", hx711_offset);
-            Serial.printf("  configured:  %s\n", provision_is_configured() ? "YES" : "NO");
-            Serial.println("----------------------------");
+
+        ProvMessage req;
+        if (prov_reader_push(&reader, (uint8_t)c, &req) != PROV_PUSH_MESSAGE) {
+            continue;  // Mid-frame, or noise that failed the CRC
         }
-        // ── REBOOT ──────────────────────────────────────────────
-        else if (line == "REBOOT") {
-            Serial.println("Rebooting...");
-            delay(500);
+        ProvMessage reply;
+        bool restart = prov_handle(&backend, &req, &reply);
+        send_message(&reply);
+        if (restart) {
+            delay(100);
             ESP.restart();
         }
-        // ── Unknown ─────────────────────────────────────────────
-        else {
-            Serial.println("ERROR: Unknown command. Try STATUS for help.");
-        }
     }
 }
 
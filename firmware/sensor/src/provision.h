@@ -1,7 +1,8 @@
 // Waggle Sensor Node — Provisioning mode.
 // When GPIO27 is held LOW at boot, the node enters an interactive serial
 // console for configuration (hive ID, bridge MAC, tare, calibration).
-// All values are persisted to NVS.
+// All values are persisted to NVS.  The same console also accepts the
+// binary protocol of provision_proto.h for batch provisioning.
 
 #ifndef PROVISION_H
 #define PROVISION_H
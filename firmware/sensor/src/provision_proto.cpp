@@ -0,0 +1,184 @@
+// Waggle Sensor Node — Binary provisioning protocol (see provision_proto.h).
+
+#include "provision_proto.h"
+#include "payload.h"
+
+#include "../../bridge/src/cobs.h"
+
+#include <math.h>
+#include <string.h>
+
+// ── Messages and framing ────────────────────────────────────────────
+
+bool prov_message(ProvMessage* m, uint8_t cmd, uint8_t seq, uint8_t status,
+                  const void* body, size_t len) {
+    if (len > PROV_MAX_BODY) {
+        return false;
+    }
+    m->cmd = cmd;
+    m->seq = seq;
+    m->status = status;
+    m->len = (uint8_t)len;
+    if (len != 0) {
+        memcpy(m->body, body, len);
+    }
+    return true;
+}
+
+size_t prov_encode(const ProvMessage* m, uint8_t* out) {
+    uint8_t raw[PROV_MAX_MESSAGE];
+    size_t n = PROV_HEADER_LEN + m->len;
+    raw[0] = m->cmd;
+    raw[1] = m->seq;
+    raw[2] = m->status;
+    raw[3] = m->len;
+    memcpy(raw + PROV_HEADER_LEN, m->body, m->len);
+    raw[n] = crc8(raw, n);
+    n++;
+
+    out[0] = 0x00;
+    size_t w = 1 + cobs_encode(raw, n, out + 1);
+    out[w++] = 0x00;
+    return w;
+}
+
+bool prov_decode(const uint8_t* frame, size_t len, ProvMessage* out) {
+    uint8_t raw[PROV_MAX_MESSAGE];
+    size_t n = cobs_decode(frame, len, raw, sizeof(raw));
+    if (n < PROV_HEADER_LEN + 1 || raw[3] > PROV_MAX_BODY ||
+        n != (size_t)PROV_HEADER_LEN + raw[3] + 1) {
+        return false;
+    }
+    if (crc8(raw, n - 1) != raw[n - 1]) {
+        return false;
+    }
+    out->cmd = raw[0];
+    out->seq = raw[1];
+    out->status = raw[2];
+    out->len = raw[3];
+    memcpy(out->body, raw + PROV_HEADER_LEN, out->len);
+    return true;
+}
+
+void prov_reader_reset(ProvReader* r) {
+    r->len = 0;
+    r->overflow = false;
+}
+
+ProvPush prov_reader_push(ProvReader* r, uint8_t byte, ProvMessage* out) {
+    if (byte != 0x00) {
+        if (r->len < sizeof(r->buf)) {
+            r->buf[r->len++] = byte;
+        } else {
+            r->overflow = true;
+        }
+        return PROV_PUSH_PENDING;
+    }
+    size_t len = r->len;
+    bool overflow = r->overflow;
+    prov_reader_reset(r);
+    if (len == 0 && !overflow) {
+        return PROV_PUSH_PENDING;
+    }
+    if (overflow || !prov_decode(r->buf, len, out)) {
+        return PROV_PUSH_INVALID;
+    }
+    return PROV_PUSH_MESSAGE;
+}
+
+// ── Request handling ────────────────────────────────────────────────
+
+bool prov_config_valid(const ProvConfig* cfg) {
+    return cfg->hive_id >= 1 && cfg->hive_id <= 250 && cfg->bridge_mac_set == 1 &&
+           isfinite(cfg->hx_scale) && cfg->hx_scale != 0.0f;
+}
+
+static bool samples_valid(uint8_t samples) {
+    return samples >= 1 && samples <= 100;
+}
+
+static void reply_status(const ProvMessage* req, ProvMessage* reply, uint8_t status) {
+    prov_message(reply, req->cmd | PROV_REPLY, req->seq, status, nullptr, 0);
+}
+
+bool prov_handle(const ProvBackend* be, const ProvMessage* req, ProvMessage* reply) {
+    switch (req->cmd) {
+        case PROV_CMD_HELLO: {
+            ProvHello hello;
+            hello.proto_version = PROV_PROTO_VERSION;
+            be->node_mac(be->ctx, hello.node_mac);
+            be->load(be->ctx, &hello.config);
+            prov_message(reply, req->cmd | PROV_REPLY, req->seq, PROV_STATUS_OK,
+                         &hello, sizeof(hello));
+            return false;
+        }
+        case PROV_CMD_READ_CONFIG: {
+            ProvConfig cfg;
+            be->load(be->ctx, &cfg);
+            prov_message(reply, req->cmd | PROV_REPLY, req->seq, PROV_STATUS_OK,
+                         &cfg, sizeof(cfg));
+            return false;
+        }
+        case PROV_CMD_WRITE_CONFIG: {
+            ProvConfig cfg;
+            if (req->len != sizeof(cfg)) {
+                reply_status(req, reply, PROV_STATUS_BAD_ARG);
+                return false;
+            }
+            memcpy(&cfg, req->body, sizeof(cfg));
+            if (!prov_config_valid(&cfg)) {
+                reply_status(req, reply, PROV_STATUS_BAD_ARG);
+                return false;
+            }
+            uint8_t status = be->save(be->ctx, &cfg);
+            ProvConfig readback;
+            be->load(be->ctx, &readback);
+            if (status == PROV_STATUS_OK && memcmp(&readback, &cfg, sizeof(cfg)) != 0) {
+                status = PROV_STATUS_VERIFY;
+            }
+            prov_message(reply, req->cmd | PROV_REPLY, req->seq, status,
+                         &readback, sizeof(readback));
+            return false;
+        }
+        case PROV_CMD_TARE: {
+            ProvTareArgs args;
+            if (req->len != sizeof(args)) {
+                reply_status(req, reply, PROV_STATUS_BAD_ARG);
+                return false;
+            }
+            memcpy(&args, req->body, sizeof(args));
+            if (!samples_valid(args.samples)) {
+                reply_status(req, reply, PROV_STATUS_BAD_ARG);
+                return false;
+            }
+            int32_t offset = 0;
+            uint8_t status = be->tare(be->ctx, &args, &offset);
+            prov_message(reply, req->cmd | PROV_REPLY, req->seq, status,
+                         &offset, status == PROV_STATUS_OK ? sizeof(offset) : 0);
+            return false;
+        }
+        case PROV_CMD_CALIBRATE: {
+            ProvCalibrateArgs args;
+            if (req->len != sizeof(args)) {
+                reply_status(req, reply, PROV_STATUS_BAD_ARG);
+                return false;
+            }
+            memcpy(&args, req->body, sizeof(args));
+            if (!samples_valid(args.samples) || !isfinite(args.known_g) || args.known_g <= 0.0f) {
+                reply_status(req, reply, PROV_STATUS_BAD_ARG);
+                return false;
+            }
+            float scale = 0.0f;
+            uint8_t status = be->calibrate(be->ctx, &args, &scale);
+            prov_message(reply, req->cmd | PROV_REPLY, req->seq, status,
+                         &scale, status == PROV_STATUS_OK ? sizeof(scale) : 0);
+            return false;
+        }
+        case PROV_CMD_REBOOT:
+            reply_status(req, reply, PROV_STATUS_OK);
+            return true;
+        default:
+            reply_status(req, reply, PROV_STATUS_UNKNOWN_CMD);
+            return false;
+    }
+}
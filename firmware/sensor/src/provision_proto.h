@@ -0,0 +1,153 @@
+// Waggle Sensor Node — Binary provisioning protocol.
+//
+// Runs alongside the text console in provisioning mode (provision.cpp) so
+// a host tool (provtool/) can commission a node in a few round trips
+// instead of typed commands.  Each message is COBS-encoded with the
+// bridge's encoder and sent as [0x00][COBS(message)][0x00].  The leading
+// delimiter keeps any log text the node printed from running into the
+// next frame.  The first 0x00 the console receives switches it to binary
+// for the rest of the session.
+//
+// Message (before COBS):
+//   Offset  Size  Field
+//   0       1     cmd (PROV_CMD_*; replies set PROV_REPLY)
+//   1       1     seq (echoed in the reply)
+//   2       1     status (PROV_STATUS_*; 0 in requests)
+//   3       1     len (body bytes, 0-PROV_MAX_BODY)
+//   4       len   body
+//   4+len   1     CRC-8 over bytes 0..3+len (payload.h crc8)
+//
+// Commands and bodies (little-endian, packed):
+//   HELLO          -> ProvHello (protocol version, node MAC, config)
+//   READ_CONFIG    -> ProvConfig
+//   WRITE_CONFIG   ProvConfig -> ProvConfig read back from NVS; every key
+//                  is written in one NVS session, and a read-back that
+//                  differs from the request fails with VERIFY
+//   TARE           ProvTareArgs -> int32 offset (stored)
+//   CALIBRATE      ProvCalibrateArgs -> float scale factor (stored)
+//   REBOOT         -> empty reply, then restart
+//
+// prov_handle() dispatches a request against a ProvBackend (NVS and HX711
+// on the node, a fake in the native tests), so the protocol is tested
+// without hardware.
+
+#ifndef PROVISION_PROTO_H
+#define PROVISION_PROTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROV_PROTO_VERSION   1
+#define PROV_MAX_BODY        32
+#define PROV_HEADER_LEN      4
+#define PROV_MAX_MESSAGE     (PROV_HEADER_LEN + PROV_MAX_BODY + 1)
+// COBS adds at most one byte per 254, plus the two delimiters
+#define PROV_MAX_WIRE        (PROV_MAX_MESSAGE + 2 + 2)
+
+#define PROV_REPLY           0x80
+
+enum ProvCmd : uint8_t {
+    PROV_CMD_HELLO        = 0x01,
+    PROV_CMD_READ_CONFIG  = 0x02,
+    PROV_CMD_WRITE_CONFIG = 0x03,
+    PROV_CMD_TARE         = 0x04,
+    PROV_CMD_CALIBRATE    = 0x05,
+    PROV_CMD_REBOOT       = 0x06,
+};
+
+enum ProvStatus : uint8_t {
+    PROV_STATUS_OK          = 0,
+    PROV_STATUS_UNKNOWN_CMD = 1,
+    PROV_STATUS_BAD_ARG     = 2,   // Body length or a value out of range
+    PROV_STATUS_HX711       = 3,   // Load cell not ready
+    PROV_STATUS_NO_WEIGHT   = 4,   // Calibration reading equals the offset
+    PROV_STATUS_NVS         = 5,   // NVS write failed
+    PROV_STATUS_VERIFY      = 6,   // NVS read-back differs from the write
+};
+
+// ── Bodies ──────────────────────────────────────────────────────────
+#pragma pack(push, 1)
+typedef struct {
+    uint8_t  hive_id;           // 0 = not set
+    uint8_t  bridge_mac_set;    // 0 / 1
+    uint8_t  bridge_mac[6];
+    float    hx_scale;
+    int32_t  hx_offset;
+} ProvConfig;                   // 16 bytes
+
+typedef struct {
+    uint8_t    proto_version;   // PROV_PROTO_VERSION
+    uint8_t    node_mac[6];     // The node's own station MAC
+    ProvConfig config;
+} ProvHello;                    // 23 bytes
+
+typedef struct {
+    uint16_t settle_ms;         // Wait before sampling (scale cleared)
+    uint8_t  samples;           // HX711 readings averaged (1-100)
+} ProvTareArgs;
+
+typedef struct {
+    float    known_g;           // Weight on the scale, grams (> 0)
+    uint16_t settle_ms;         // Wait before sampling (weight placed)
+    uint8_t  samples;           // HX711 readings averaged (1-100)
+} ProvCalibrateArgs;
+#pragma pack(pop)
+
+// ── Messages and framing ────────────────────────────────────────────
+struct ProvMessage {
+    uint8_t cmd;
+    uint8_t seq;
+    uint8_t status;
+    uint8_t len;
+    uint8_t body[PROV_MAX_BODY];
+};
+
+// Fill a message; body may be nullptr when len is 0.  Returns false if
+// len exceeds PROV_MAX_BODY.
+bool prov_message(ProvMessage* m, uint8_t cmd, uint8_t seq, uint8_t status,
+                  const void* body, size_t len);
+
+// Encode [0x00][COBS(message)][0x00] into out (PROV_MAX_WIRE bytes).
+// Returns the number of bytes written.
+size_t prov_encode(const ProvMessage* m, uint8_t* out);
+
+// Decode one frame (delimiters stripped).  False on bad COBS, length or CRC.
+bool prov_decode(const uint8_t* frame, size_t len, ProvMessage* out);
+
+// Byte-at-a-time frame splitter for a serial stream.  Text and other
+// noise between delimiters fails prov_decode() and is dropped.
+struct ProvReader {
+    uint8_t buf[PROV_MAX_WIRE];
+    size_t  len;
+    bool    overflow;           // Current frame too long: skip to the next 0x00
+};
+
+enum ProvPush : int8_t {
+    PROV_PUSH_PENDING = 0,      // Mid-frame or empty frame
+    PROV_PUSH_MESSAGE = 1,      // *out holds a valid message
+    PROV_PUSH_INVALID = -1,     // A frame ended but did not decode
+};
+
+void     prov_reader_reset(ProvReader* r);
+ProvPush prov_reader_push(ProvReader* r, uint8_t byte, ProvMessage* out);
+
+// ── Request handling (node side) ────────────────────────────────────
+// Hardware behind the protocol.  Each returns a PROV_STATUS_* code.
+struct ProvBackend {
+    void    (*node_mac)(void* ctx, uint8_t mac[6]);
+    void    (*load)(void* ctx, ProvConfig* out);
+    uint8_t (*save)(void* ctx, const ProvConfig* cfg);
+    uint8_t (*tare)(void* ctx, const ProvTareArgs* args, int32_t* offset);
+    uint8_t (*calibrate)(void* ctx, const ProvCalibrateArgs* args, float* scale);
+    void*   ctx;
+};
+
+// True if cfg can be written: hive_id 1-250, bridge MAC set, finite
+// non-zero scale factor.
+bool prov_config_valid(const ProvConfig* cfg);
+
+// Build the reply to `req`.  Returns true if the node should restart once
+// the reply has been sent (REBOOT).
+bool prov_handle(const ProvBackend* be, const ProvMessage* req, ProvMessage* reply);
+
+#endif // PROVISION_PROTO_H
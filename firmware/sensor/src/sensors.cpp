@@ -3,6 +3,7 @@
 #include "sensors.h"
 #include "config.h"
 #include "payload.h"  // flag constants
+#include "power.h"
 
 #include <Arduino.h>
 #include <Wire.h>
@@ -21,6 +22,24 @@ static bool bme280_ok = false;
 extern float hx711_scale_factor;  // counts per gram
 extern long  hx711_offset;        // tare offset
 
+// ── HX711 sampling ──────────────────────────────────────────────────
+// At 10 SPS each conversion takes ~100 ms.  HX711::get_units() spins on
+// DOUT for all of it; waiting here in power_wait_ms() steps lets the CPU
+// drop its clock and light-sleep between conversions instead.
+#define HX711_SAMPLES      5
+#define HX711_POLL_MS      10
+#define HX711_TIMEOUT_MS   200   // Per conversion
+
+static bool hx711_wait_ready() {
+    for (uint32_t waited = 0; !scale.is_ready(); waited += HX711_POLL_MS) {
+        if (waited >= HX711_TIMEOUT_MS) {
+            return false;
+        }
+        power_wait_ms(HX711_POLL_MS);
+    }
+    return true;
+}
+
 // ── Init ────────────────────────────────────────────────────────────
 uint8_t sensors_init() {
     uint8_t flags = 0;
@@ -73,8 +92,17 @@ int32_t read_weight_g(uint8_t* flags) {
         *flags |= FLAG_HX711_ERROR;
         return 0;
     }
-    // Average 5 readings for stability
-    float grams = scale.get_units(5);
+    // Average HX711_SAMPLES readings for stability (as get_units(5))
+    int64_t sum = 0;
+    for (int i = 0; i < HX711_SAMPLES; i++) {
+        if (!hx711_wait_ready()) {
+            log_w("HX711 conversion timed out");
+            *flags |= FLAG_HX711_ERROR;
+            return 0;
+        }
+        sum += scale.read();
+    }
+    float grams = (float)(sum / HX711_SAMPLES - scale.get_offset()) / scale.get_scale();
     log_d("Weight: %.1f g", grams);
     return (int32_t)grams;
 }
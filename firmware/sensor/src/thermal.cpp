@@ -0,0 +1,87 @@
+// Waggle Sensor Node — Brood-frame thermal array (see thermal.h).
+
+#include "thermal.h"
+#include "config.h"
+#include "onewire.h"
+#include "onewire_rmt.h"
+#include "power.h"
+
+#include <Arduino.h>
+
+static OneWireRmt s_rmt = {ONEWIRE_PIN, ONEWIRE_RMT_TX_CHANNEL, ONEWIRE_RMT_RX_CHANNEL, nullptr};
+static OneWireBus s_bus;
+
+// ── Probes found by the ROM search (kept across light sleep) ────────
+static uint8_t s_roms[THERMAL_MAX_PROBES][ONEWIRE_ROM_LEN];
+static uint8_t s_count = 0;
+
+// ── Conversion in progress ──────────────────────────────────────────
+static bool     s_converting = false;
+static uint8_t  s_flags = 0;
+static uint32_t s_convert_ms = 0;
+
+static void enumerate() {
+    s_count = onewire_search(&s_bus, s_roms, THERMAL_MAX_PROBES, DS18B20_FAMILY);
+    if (s_count == 0) {
+        return;
+    }
+    log_i("Thermal array: %u DS18B20 probe(s) on GPIO%u", s_count, ONEWIRE_PIN);
+    for (uint8_t i = 0; i < s_count; i++) {
+        const uint8_t* r = s_roms[i];
+        log_i("  probe %2u: %02X%02X%02X%02X%02X%02X%02X%02X", i,
+              r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7]);
+    }
+}
+
+uint8_t thermal_start() {
+    s_converting = false;
+    s_flags = 0;
+    if (!onewire_rmt_open(&s_rmt, &s_bus)) {
+        return s_count;  // Known probes are reported with a bus error
+    }
+    if (s_count == 0) {
+        enumerate();
+    }
+    if (s_count != 0) {
+        if (onewire_convert_all(&s_bus)) {
+            s_converting = true;
+            s_convert_ms = millis();
+        } else {
+            log_w("Thermal array: no presence pulse on GPIO%u", ONEWIRE_PIN);
+        }
+    }
+    onewire_rmt_close(&s_rmt);
+    return s_count;
+}
+
+void thermal_collect(ThermalReading* out) {
+    out->count = s_count;
+    out->flags = s_flags;
+    for (uint8_t i = 0; i < THERMAL_MAX_PROBES; i++) {
+        out->temp_x16[i] = THERMAL_NO_READING;
+    }
+    if (!s_converting) {
+        out->flags |= THERMAL_FLAG_BUS_ERROR;
+        return;
+    }
+    s_converting = false;
+
+    // Sleep out whatever the other sensor reads left of the conversion
+    uint32_t elapsed = millis() - s_convert_ms;
+    if (elapsed < DS18B20_CONVERT_MS) {
+        power_wait_ms(DS18B20_CONVERT_MS - elapsed);
+    }
+
+    if (!onewire_rmt_open(&s_rmt, &s_bus)) {
+        out->flags |= THERMAL_FLAG_BUS_ERROR;
+        return;
+    }
+    for (uint8_t i = 0; i < s_count; i++) {
+        Ds18b20Status status = ds18b20_read(&s_bus, s_roms[i], &out->temp_x16[i]);
+        if (status != DS18B20_OK) {
+            out->temp_x16[i] = THERMAL_NO_READING;
+            log_w("Thermal probe %u: read failed (status %u)", i, status);
+        }
+    }
+    onewire_rmt_close(&s_rmt);
+}
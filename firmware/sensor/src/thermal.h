@@ -0,0 +1,48 @@
+// Waggle Sensor Node — Brood-frame thermal array (DS18B20 chain).
+//
+// Up to THERMAL_MAX_PROBES DS18B20 probes on one 1-Wire bus (ONEWIRE_PIN)
+// are read once per wake and sent as a thermal payload (msg_type 0x04,
+// payload.h).  The wake is split so the 750 ms conversion runs alongside
+// the other work instead of in front of it:
+//
+//   thermal_start()    enumerate the bus if needed, then start every
+//                      probe converting at once (SKIP ROM + CONVERT T)
+//   ... HX711, BME280, battery and bee counter reads ...
+//   thermal_collect()  wait out whatever is left of the 750 ms in
+//                      power_wait_ms(), then read each probe's scratchpad
+//
+// The bus is enumerated with the ROM search on the first wake that finds
+// probes; the ROM codes stay in RAM across light sleep.  While none are
+// found each wake retries with a single reset pulse.  Probes added later
+// are picked up after a restart.
+//
+// The RMT driver is installed only around each bus transaction: it holds
+// an APB frequency lock while installed, which would keep the chip out
+// of automatic light sleep during the conversion wait.
+
+#ifndef THERMAL_H
+#define THERMAL_H
+
+#include <stdint.h>
+
+#include "payload.h"
+
+// One wake's readings, in bus (ROM code) order.
+struct ThermalReading {
+    uint8_t count;                          // Probes on the bus
+    uint8_t flags;                          // THERMAL_FLAG_*
+    int16_t temp_x16[THERMAL_MAX_PROBES];   // 1/16 °C, or THERMAL_NO_READING
+};
+
+#ifndef UNIT_TEST
+
+// Start a conversion on every probe.  Returns the number of probes on the
+// bus (0 = no array fitted; skip thermal_collect()).
+uint8_t thermal_start();
+
+// Wait for the conversion started by thermal_start() and read every probe.
+void thermal_collect(ThermalReading* out);
+
+#endif // UNIT_TEST
+
+#endif // THERMAL_H
@@ -13,11 +13,23 @@
 #define NUM_CHANNELS 4
 
 // ── Timing constants (milliseconds) ──────────────────────────────────
+// Each can be overridden with a build flag (e.g. -DREFRACTORY_MS=20) to
+// try other counter settings, see bench/traffic_main.cpp.
+#ifndef DEBOUNCE_MS
 #define DEBOUNCE_MS        3     // Ignore edges within 3ms of last edge
+#endif
+#ifndef MIN_TRANSIT_MS
 #define MIN_TRANSIT_MS     5     // Minimum valid transit time (beam A→B or B→A)
+#endif
+#ifndef MAX_TRANSIT_MS
 #define MAX_TRANSIT_MS     200   // Maximum valid transit time before timeout
+#endif
+#ifndef REFRACTORY_MS
 #define REFRACTORY_MS      30    // Cooldown after a valid transit detection
+#endif
+#ifndef STUCK_BEAM_MS
 #define STUCK_BEAM_MS      2000  // Beam held longer than this → stuck flag
+#endif
 
 // ── Pin assignments (customize per board) ─────────────────────────────
 // Channel 0: GPIO 32 (beam A), GPIO 33 (beam B)
@@ -27,4 +39,15 @@
 static const uint8_t BEAM_A_PINS[NUM_CHANNELS] = {32, 25, 14, 13};
 static const uint8_t BEAM_B_PINS[NUM_CHANNELS] = {33, 26, 12, 15};
 
+// ── Activity trigger (camera wake line) ──────────────────────────────
+// GPIO 18 drives the camera node's EXT0 wake input (active HIGH) when the
+// IN or OUT transit count within the window reaches its threshold.
+// A threshold of 0 disables that direction.
+#define ACTIVITY_TRIGGER_PIN     18
+#define ACTIVITY_WINDOW_MS       10000   // Sliding window for rate detection
+#define ACTIVITY_IN_THRESHOLD    60      // IN transits per window (~6/s)
+#define ACTIVITY_OUT_THRESHOLD   60      // OUT transits per window (~6/s)
+#define ACTIVITY_HOLD_MS         2000    // Wake line held HIGH this long
+#define ACTIVITY_HOLDOFF_MS      300000  // Min 5 minutes between camera wakes
+
 #endif // TUNNEL_CONFIG_H
@@ -0,0 +1,283 @@
+// Waggle Sensor Node — Native unit tests for the activity trigger
+// (camera wake line) sliding-window logic.
+//
+// Runs on the host (no ESP32 required) via:
+//   pio test -e native
+//
+// Tests:
+//   1. Steady foraging traffic below threshold never fires
+//   2. Robbing burst (IN spike) fires with ACTIVITY_REASON_IN
+//   3. Mass exodus (OUT spike) fires with ACTIVITY_REASON_OUT
+//   4. Line is released after hold_ms, not before
+//   5. Holdoff suppresses re-triggering, then allows it
+//   6. Old transits age out of the window
+//   7. Zero threshold disables a direction
+//   8. Window sums match a brute-force reference on a random trace
+//   9. Long idle gap clears the window
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/activity_trigger.h"
+
+// ── Trace helpers ─────────────────────────────────────────────────────
+struct TraceEvent {
+    uint32_t t_ms;
+    bool     inbound;
+};
+
+static ActivityTriggerConfig default_cfg() {
+    ActivityTriggerConfig cfg;
+    cfg.window_ms     = 8000;   // 1000 ms buckets
+    cfg.in_threshold  = 20;
+    cfg.out_threshold = 20;
+    cfg.hold_ms       = 2000;
+    cfg.holdoff_ms    = 60000;
+    return cfg;
+}
+
+// Feed a trace; returns the number of fires and the time of the first.
+static int run_trace(ActivityTrigger* t, const TraceEvent* events, int n,
+                     uint32_t* first_fire_ms) {
+    int fires = 0;
+    for (int i = 0; i < n; i++) {
+        if (activity_trigger_record(t, events[i].t_ms, events[i].inbound)) {
+            if (fires == 0 && first_fire_ms != NULL) {
+                *first_fire_ms = events[i].t_ms;
+            }
+            fires++;
+        }
+    }
+    return fires;
+}
+
+// Deterministic LCG so traces are reproducible on every host
+static uint32_t s_rng = 12345;
+static uint32_t rng_next() {
+    s_rng = s_rng * 1103515245u + 12345u;
+    return (s_rng >> 16) & 0x7FFF;
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Trace-driven firing
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_steady_foraging_never_fires(void) {
+    ActivityTriggerConfig cfg = default_cfg();
+    ActivityTrigger t;
+    activity_trigger_init(&t, &cfg);
+
+    // One IN and one OUT per second for 10 minutes: 8 per direction per
+    // window, well under the threshold of 20
+    TraceEvent ev[1200];
+    for (int i = 0; i < 600; i++) {
+        ev[2 * i]     = {(uint32_t)(i * 1000),       true};
+        ev[2 * i + 1] = {(uint32_t)(i * 1000 + 500), false};
+    }
+    TEST_ASSERT_EQUAL(0, run_trace(&t, ev, 1200, NULL));
+    TEST_ASSERT_FALSE(t.asserted);
+    TEST_ASSERT_EQUAL_UINT32(0, t.fire_count);
+}
+
+void test_robbing_burst_fires_in(void) {
+    ActivityTriggerConfig cfg = default_cfg();
+    ActivityTrigger t;
+    activity_trigger_init(&t, &cfg);
+
+    // Background traffic, then 5 IN transits per second from t=30 s
+    TraceEvent ev[200];
+    int n = 0;
+    for (int i = 0; i < 30; i++) {
+        ev[n++] = {(uint32_t)(i * 1000), true};
+    }
+    for (int i = 0; i < 100; i++) {
+        ev[n++] = {(uint32_t)(30000 + i * 200), true};
+    }
+
+    uint32_t first = 0;
+    int fires = run_trace(&t, ev, n, &first);
+    TEST_ASSERT_EQUAL(1, fires);
+    TEST_ASSERT_EQUAL(ACTIVITY_REASON_IN, t.reason);
+    TEST_ASSERT_TRUE(t.asserted);
+    // Must fire within the window after the burst starts
+    TEST_ASSERT_GREATER_OR_EQUAL(30000, first);
+    TEST_ASSERT_LESS_THAN(30000 + 8000, first);
+}
+
+void test_exodus_fires_out(void) {
+    ActivityTriggerConfig cfg = default_cfg();
+    ActivityTrigger t;
+    activity_trigger_init(&t, &cfg);
+
+    TraceEvent ev[40];
+    for (int i = 0; i < 40; i++) {
+        ev[i] = {(uint32_t)(1000 + i * 100), false};
+    }
+    uint32_t first = 0;
+    TEST_ASSERT_EQUAL(1, run_trace(&t, ev, 40, &first));
+    TEST_ASSERT_EQUAL(ACTIVITY_REASON_OUT, t.reason);
+    // 20th OUT transit is at 1000 + 19 * 100
+    TEST_ASSERT_EQUAL_UINT32(2900, first);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Line hold / release
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_release_after_hold(void) {
+    ActivityTriggerConfig cfg = default_cfg();
+    ActivityTrigger t;
+    activity_trigger_init(&t, &cfg);
+
+    for (uint32_t i = 0; i < 20; i++) {
+        activity_trigger_record(&t, 100 + i, true);
+    }
+    TEST_ASSERT_TRUE(t.asserted);
+    uint32_t fired = t.fired_ms;
+
+    TEST_ASSERT_EQUAL_UINT32(cfg.hold_ms, activity_trigger_release_in_ms(&t, fired));
+    TEST_ASSERT_FALSE(activity_trigger_poll(&t, fired + cfg.hold_ms - 1));
+    TEST_ASSERT_EQUAL_UINT32(1, activity_trigger_release_in_ms(&t, fired + cfg.hold_ms - 1));
+    TEST_ASSERT_TRUE(activity_trigger_poll(&t, fired + cfg.hold_ms));
+    TEST_ASSERT_FALSE(t.asserted);
+    TEST_ASSERT_EQUAL_UINT32(0, activity_trigger_release_in_ms(&t, fired + cfg.hold_ms));
+    // Releasing twice is a no-op
+    TEST_ASSERT_FALSE(activity_trigger_poll(&t, fired + cfg.hold_ms + 10));
+}
+
+void test_holdoff_suppresses_retrigger(void) {
+    ActivityTriggerConfig cfg = default_cfg();
+    ActivityTrigger t;
+    activity_trigger_init(&t, &cfg);
+
+    // Sustained heavy traffic: 10 IN per second for 3 minutes
+    int fires = 0;
+    uint32_t fire_times[8];
+    for (uint32_t ms = 0; ms < 180000; ms += 100) {
+        activity_trigger_poll(&t, ms);
+        if (activity_trigger_record(&t, ms, true)) {
+            if (fires < 8) fire_times[fires] = ms;
+            fires++;
+        }
+    }
+    // Fires at ~2 s, then again once each 60 s holdoff has elapsed
+    TEST_ASSERT_EQUAL(3, fires);
+    TEST_ASSERT_EQUAL_UINT32(60000, fire_times[1] - fire_times[0]);
+    TEST_ASSERT_EQUAL_UINT32(60000, fire_times[2] - fire_times[1]);
+    TEST_ASSERT_EQUAL_UINT32(3, t.fire_count);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Window behaviour
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_old_transits_age_out(void) {
+    ActivityTriggerConfig cfg = default_cfg();
+    ActivityTrigger t;
+    activity_trigger_init(&t, &cfg);
+
+    // 15 IN transits early, then 15 more after the window has moved on:
+    // never 20 within 8 s
+    for (uint32_t i = 0; i < 15; i++) {
+        TEST_ASSERT_FALSE(activity_trigger_record(&t, i * 10, true));
+    }
+    for (uint32_t i = 0; i < 15; i++) {
+        TEST_ASSERT_FALSE(activity_trigger_record(&t, 9000 + i * 10, true));
+    }
+    TEST_ASSERT_EQUAL_UINT16(15, t.in_sum);
+}
+
+void test_zero_threshold_disables_direction(void) {
+    ActivityTriggerConfig cfg = default_cfg();
+    cfg.out_threshold = 0;
+    ActivityTrigger t;
+    activity_trigger_init(&t, &cfg);
+
+    for (uint32_t i = 0; i < 500; i++) {
+        TEST_ASSERT_FALSE(activity_trigger_record(&t, i, false));
+    }
+    TEST_ASSERT_FALSE(t.asserted);
+    // IN direction still armed
+    for (uint32_t i = 0; i < 20; i++) {
+        activity_trigger_record(&t, 600 + i, true);
+    }
+    TEST_ASSERT_TRUE(t.asserted);
+    TEST_ASSERT_EQUAL(ACTIVITY_REASON_IN, t.reason);
+}
+
+void test_window_matches_reference(void) {
+    ActivityTriggerConfig cfg = default_cfg();
+    cfg.in_threshold  = 0;  // Observe sums only
+    cfg.out_threshold = 0;
+    ActivityTrigger t;
+    activity_trigger_init(&t, &cfg);
+
+    // Random trace with bursts and gaps
+    static TraceEvent ev[3000];
+    uint32_t now = 0;
+    s_rng = 777;
+    for (int i = 0; i < 3000; i++) {
+        uint32_t r = rng_next();
+        now += (r % 10 == 0) ? (r % 5000) : (r % 300);
+        ev[i] = {now, (r & 1) != 0};
+    }
+
+    for (int i = 0; i < 3000; i++) {
+        activity_trigger_record(&t, ev[i].t_ms, ev[i].inbound);
+
+        // Reference: the window covers the head bucket plus the previous
+        // ACTIVITY_BUCKETS - 1 buckets, aligned to the first event
+        uint32_t head_start = t.bucket_start_ms;
+        uint32_t span = (ACTIVITY_BUCKETS - 1) * t.bucket_ms;
+        uint32_t lo = (head_start > span) ? head_start - span : 0;
+        uint16_t ref_in = 0, ref_out = 0;
+        for (int j = 0; j <= i; j++) {
+            if (ev[j].t_ms >= lo) {
+                if (ev[j].inbound) ref_in++; else ref_out++;
+            }
+        }
+        TEST_ASSERT_EQUAL_UINT16(ref_in, t.in_sum);
+        TEST_ASSERT_EQUAL_UINT16(ref_out, t.out_sum);
+    }
+}
+
+void test_long_gap_clears_window(void) {
+    ActivityTriggerConfig cfg = default_cfg();
+    ActivityTrigger t;
+    activity_trigger_init(&t, &cfg);
+
+    for (uint32_t i = 0; i < 19; i++) {
+        activity_trigger_record(&t, i, true);
+    }
+    TEST_ASSERT_EQUAL_UINT16(19, t.in_sum);
+
+    // An hour later a single transit must not fire
+    TEST_ASSERT_FALSE(activity_trigger_record(&t, 3600000, true));
+    TEST_ASSERT_EQUAL_UINT16(1, t.in_sum);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Test runner
+// ═══════════════════════════════════════════════════════════════════════
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    // Trace-driven firing
+    RUN_TEST(test_steady_foraging_never_fires);
+    RUN_TEST(test_robbing_burst_fires_in);
+    RUN_TEST(test_exodus_fires_out);
+
+    // Hold / release
+    RUN_TEST(test_release_after_hold);
+    RUN_TEST(test_holdoff_suppresses_retrigger);
+
+    // Window behaviour
+    RUN_TEST(test_old_transits_age_out);
+    RUN_TEST(test_zero_threshold_disables_direction);
+    RUN_TEST(test_window_matches_reference);
+    RUN_TEST(test_long_gap_clears_window);
+
+    return UNITY_END();
+}
@@ -10,12 +10,14 @@
 //   3. Timeout (>MAX_TRANSIT_MS) discards count
 //   4. Debounce rejects edges within DEBOUNCE_MS
 //   5. Transit too fast (<MIN_TRANSIT_MS) discards count
-//   6. Cooldown prevents double-counting
-//   7. Counter overflow clamps at 65535
+//   6. Cooldown prevents double-counting, and expires on the next event
+//   7. Counter overflow clamps at 65535 (per lane and summed over lanes)
 //   8. bee_count_payload_t is exactly 48 bytes
 //   9. 48-byte payload has correct field offsets
 //  10. msg_type is 0x02 in payload
 //  11. CRC covers bytes 0-16 only
+//  12. ISR cycle histograms bucket by log2 and report percentiles
+//  13. Latency trace stamps: layout, clamping, CRC untouched, bridge skip
 
 #include <unity.h>
 #include <stdint.h>
@@ -217,6 +219,23 @@ void test_cooldown_expires_to_idle(void) {
     TEST_ASSERT_EQUAL(LANE_IDLE, lane.state);
 }
 
+void test_cooldown_expires_on_next_event(void) {
+    LaneData lane;
+    lane_reset(&lane);
+
+    // Two bees a second apart with no lane_check_timeout() in between
+    // (the main loop only runs it at the snapshot on each wake)
+    lane_beam_a_event(&lane, 100);
+    lane_beam_b_event(&lane, 120);
+    lane_beam_a_event(&lane, 1100);
+    lane_beam_b_event(&lane, 1130);
+    TEST_ASSERT_EQUAL_UINT32(2, lane.bees_in);
+
+    // An edge just inside the refractory period is still ignored
+    lane_beam_b_event(&lane, 1130 + REFRACTORY_MS - 1);
+    TEST_ASSERT_EQUAL(LANE_COOLDOWN, lane.state);
+}
+
 // ═══════════════════════════════════════════════════════════════════════
 // Stuck detection
 // ═══════════════════════════════════════════════════════════════════════
@@ -259,6 +278,77 @@ void test_counter_overflow_clamps(void) {
     TEST_ASSERT_EQUAL_UINT16(65535, clamped_out);
 }
 
+void test_lanes_collect_clamps_and_resets(void) {
+    LaneData lanes[NUM_CHANNELS];
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        lane_reset(&lanes[ch]);
+    }
+    lanes[0].bees_in  = 70000;  // Clamped per lane...
+    lanes[1].bees_in  = 40000;  // ...and the sum clamped again
+    lanes[2].bees_out = 12;
+    lanes[3].bees_out = 99;     // Lane 3 disabled, not collected
+    lanes[2].stuck    = true;
+
+    BeeCountSnapshot snap = lanes_collect(lanes, 0x07, 5000, 2000);
+    TEST_ASSERT_EQUAL_UINT16(65535, snap.bees_in);
+    TEST_ASSERT_EQUAL_UINT16(12, snap.bees_out);
+    TEST_ASSERT_EQUAL_UINT32(3000, snap.period_ms);
+    TEST_ASSERT_EQUAL_HEX8(0x07, snap.lane_mask);
+    TEST_ASSERT_EQUAL_HEX8(0x04, snap.stuck_mask);
+
+    // Enabled lanes are reset, the disabled one is untouched
+    TEST_ASSERT_EQUAL_UINT32(0, lanes[0].bees_in);
+    TEST_ASSERT_EQUAL_UINT32(0, lanes[2].bees_out);
+    TEST_ASSERT_FALSE(lanes[2].stuck);
+    TEST_ASSERT_EQUAL_UINT32(99, lanes[3].bees_out);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// ISR instrumentation histograms
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_isr_hist_buckets(void) {
+    IsrHist h;
+    memset(&h, 0, sizeof(h));
+
+    isr_hist_record(&h, 0);
+    isr_hist_record(&h, 127);           // < 2^7: bucket 0
+    isr_hist_record(&h, 128);           // [128, 256): bucket 1
+    isr_hist_record(&h, 255);
+    isr_hist_record(&h, 256);           // [256, 512): bucket 2
+    isr_hist_record(&h, 1u << 17);      // Last bucket from 2^17 up
+    isr_hist_record(&h, 0xFFFFFFFFu);
+
+    TEST_ASSERT_EQUAL_UINT32(2, h.count[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, h.count[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, h.count[2]);
+    TEST_ASSERT_EQUAL_UINT32(0, h.count[ISR_HIST_BUCKETS - 2]);
+    TEST_ASSERT_EQUAL_UINT32(2, h.count[ISR_HIST_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, h.max_cycles);
+
+    TEST_ASSERT_EQUAL_UINT32(128, isr_hist_bucket_limit(0));
+    TEST_ASSERT_EQUAL_UINT32(1u << 17, isr_hist_bucket_limit(ISR_HIST_BUCKETS - 2));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, isr_hist_bucket_limit(ISR_HIST_BUCKETS - 1));
+}
+
+void test_isr_hist_percentile(void) {
+    IsrHist h;
+    memset(&h, 0, sizeof(h));
+    TEST_ASSERT_EQUAL_UINT32(0, isr_hist_percentile(&h, 50));
+
+    for (int i = 0; i < 90; i++) {
+        isr_hist_record(&h, 100);       // Bucket 0
+    }
+    for (int i = 0; i < 10; i++) {
+        isr_hist_record(&h, 5000);      // [4096, 8192)
+    }
+    TEST_ASSERT_EQUAL_UINT32(128, isr_hist_percentile(&h, 50));
+    TEST_ASSERT_EQUAL_UINT32(128, isr_hist_percentile(&h, 90));
+    TEST_ASSERT_EQUAL_UINT32(8192, isr_hist_percentile(&h, 91));
+    TEST_ASSERT_EQUAL_UINT32(8192, isr_hist_percentile(&h, 99));
+    TEST_ASSERT_EQUAL_UINT32(5000, h.max_cycles);
+}
+
 // ═══════════════════════════════════════════════════════════════════════
 // Phase 2 payload struct layout
 // ═══════════════════════════════════════════════════════════════════════
@@ -446,6 +536,45 @@ void test_bee_count_payload_raw_bytes(void) {
     }
 }
 
+void test_latency_trace_stamps(void) {
+    TEST_ASSERT_EQUAL(12, sizeof(payload_trace_t));
+
+    bee_count_payload_t p;
+    payload_build_v2(&p, 3, 77, 1000, 2000, 5000, 10130, 4000, 0,
+                     1, 2, 60000, 0x0F, 0x00);
+    uint8_t* raw = (uint8_t*)&p;
+    uint8_t crc = p.crc;
+
+    // An untraced payload is left alone by the bridge
+    payload_stamp_bridge(raw, PAYLOAD_SIZE_V2, 0x01020304, 250);
+    for (int i = 28; i < 48; i++) {
+        TEST_ASSERT_EQUAL_HEX8(0x00, raw[i]);
+    }
+
+    payload_stamp_trace(&p, 0x1234, 100000, 2);  // Retry time saturates
+    payload_stamp_bridge(raw, PAYLOAD_SIZE_V2, 0x01020304, 250);
+    TEST_ASSERT_EQUAL_HEX8(TRACE_VERSION, raw[28]);
+    TEST_ASSERT_EQUAL_HEX8(2, raw[29]);
+    TEST_ASSERT_EQUAL_HEX8(0x34, raw[30]);
+    TEST_ASSERT_EQUAL_HEX8(0x12, raw[31]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, raw[32]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, raw[33]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, raw[34]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, raw[37]);
+    TEST_ASSERT_EQUAL_HEX8(250, raw[38]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, raw[39]);
+    for (int i = 40; i < 48; i++) {
+        TEST_ASSERT_EQUAL_HEX8(0x00, raw[i]);
+    }
+
+    // A later node attempt keeps the bridge half; the CRC never changes
+    payload_stamp_trace(&p, 0x1234, 10, 3);
+    TEST_ASSERT_EQUAL_HEX8(3, raw[29]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, raw[34]);
+    TEST_ASSERT_EQUAL_HEX8(crc, p.crc);
+    TEST_ASSERT_EQUAL_HEX8(crc8(raw, 17), p.crc);
+}
+
 // ═══════════════════════════════════════════════════════════════════════
 // Flag bits
 // ═══════════════════════════════════════════════════════════════════════
@@ -497,12 +626,18 @@ int main(int argc, char** argv) {
     // Cooldown
     RUN_TEST(test_cooldown_prevents_double_count);
     RUN_TEST(test_cooldown_expires_to_idle);
+    RUN_TEST(test_cooldown_expires_on_next_event);
 
     // Stuck detection
     RUN_TEST(test_stuck_beam_detection);
 
     // Counter overflow
     RUN_TEST(test_counter_overflow_clamps);
+    RUN_TEST(test_lanes_collect_clamps_and_resets);
+
+    // ISR instrumentation
+    RUN_TEST(test_isr_hist_buckets);
+    RUN_TEST(test_isr_hist_percentile);
 
     // Phase 2 payload layout
     RUN_TEST(test_bee_count_payload_size);
@@ -512,6 +647,7 @@ int main(int argc, char** argv) {
     RUN_TEST(test_bee_count_payload_build_fields);
     RUN_TEST(test_bee_count_payload_crc);
     RUN_TEST(test_bee_count_payload_raw_bytes);
+    RUN_TEST(test_latency_trace_stamps);
 
     // Flag bits
     RUN_TEST(test_phase2_flag_bits_non_overlapping);
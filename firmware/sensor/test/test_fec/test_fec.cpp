@@ -0,0 +1,241 @@
+// Waggle Sensor Node — Native unit tests for fec.h
+//
+// Runs on the host (no ESP32 required) via:
+//   pio test -e native
+//
+// Tests:
+//   1. parity_payload_t is exactly 32 bytes
+//   2. Encoder completes a group after K payloads with a valid parity
+//   3. Encoder starts a new group on a sequence gap or another hive
+//   4. Decoder: nothing lost, nothing rebuilt
+//   5. Decoder rebuilds a lost payload at every position in the group
+//   6. Decoder: two lost payloads cannot be rebuilt
+//   7. Decoder rejects a corrupted or malformed parity payload
+//   8. Groups across the sequence wrap
+//   9. A repeated parity payload rebuilds nothing the second time
+//  10. A stale payload from an earlier run is not mistaken for a member
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+// Header-only (inline functions)
+#include "../src/fec.h"
+
+// ── Helpers ───────────────────────────────────────────────────────────
+
+static bee_count_payload_t reading(uint16_t seq) {
+    bee_count_payload_t p;
+    payload_build_v2(&p, 7, seq,
+                     40000 + seq * 13, (int16_t)(1500 + seq), 6000 + seq, 10132,
+                     (uint16_t)(4100 - seq), (uint8_t)(seq & 0x03),
+                     (uint16_t)(seq * 3), (uint16_t)(seq * 5), 60000 + seq, 0x0F, 0);
+    return p;
+}
+
+// Encode `count` readings from first_seq; returns the parity payload.
+static parity_payload_t encode_group(uint16_t first_seq, uint8_t count) {
+    FecEncoder enc;
+    fec_encoder_reset(&enc);
+    for (uint8_t i = 0; i < count; i++) {
+        bee_count_payload_t p = reading((uint16_t)(first_seq + i));
+        fec_encoder_add(&enc, &p, count);
+    }
+    parity_payload_t parity;
+    fec_build_parity(&parity, &enc);
+    return parity;
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Encoder
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_parity_struct_size(void) {
+    TEST_ASSERT_EQUAL(PAYLOAD_SIZE_PARITY, sizeof(parity_payload_t));
+    TEST_ASSERT_EQUAL(32, sizeof(parity_payload_t));
+    // The protected span ends at stuck_mask
+    TEST_ASSERT_EQUAL(28, PARITY_OFFSET + PARITY_LEN);
+}
+
+void test_encoder_group_and_parity(void) {
+    FecEncoder enc;
+    fec_encoder_reset(&enc);
+    for (uint16_t seq = 100; seq < 104; seq++) {
+        bee_count_payload_t p = reading(seq);
+        TEST_ASSERT_EQUAL(seq == 103, fec_encoder_add(&enc, &p, 4));
+    }
+
+    parity_payload_t parity = encode_group(100, 4);
+    TEST_ASSERT_EQUAL_UINT8(7, parity.hive_id);
+    TEST_ASSERT_EQUAL_HEX8(MSG_TYPE_PARITY, parity.msg_type);
+    TEST_ASSERT_EQUAL_UINT16(100, parity.first_seq);
+    TEST_ASSERT_EQUAL_UINT8(4, parity.count);
+    TEST_ASSERT_EQUAL_HEX8(crc8((const uint8_t*)&parity, 29), parity.crc);
+
+    uint8_t expected[PARITY_LEN] = {0};
+    for (uint16_t seq = 100; seq < 104; seq++) {
+        bee_count_payload_t p = reading(seq);
+        for (int i = 0; i < PARITY_LEN; i++) {
+            expected[i] ^= ((const uint8_t*)&p)[PARITY_OFFSET + i];
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, parity.parity, PARITY_LEN);
+}
+
+void test_encoder_restarts_on_gap(void) {
+    FecEncoder enc;
+    fec_encoder_reset(&enc);
+    bee_count_payload_t a = reading(10);
+    bee_count_payload_t b = reading(11);
+    bee_count_payload_t restart = reading(0);  // Node rebooted
+    fec_encoder_add(&enc, &a, 3);
+    fec_encoder_add(&enc, &b, 3);
+    TEST_ASSERT_FALSE(fec_encoder_add(&enc, &restart, 3));
+    TEST_ASSERT_EQUAL_UINT16(0, enc.first_seq);
+    TEST_ASSERT_EQUAL_UINT8(1, enc.count);
+
+    bee_count_payload_t other = reading(1);
+    other.hive_id = 8;
+    fec_encoder_add(&enc, &other, 3);
+    TEST_ASSERT_EQUAL_UINT8(8, enc.hive_id);
+    TEST_ASSERT_EQUAL_UINT8(1, enc.count);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Decoder
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_decoder_nothing_lost(void) {
+    FecDecoder dec;
+    fec_decoder_reset(&dec);
+    for (uint16_t seq = 20; seq < 24; seq++) {
+        bee_count_payload_t p = reading(seq);
+        fec_decoder_note(&dec, &p);
+    }
+    parity_payload_t parity = encode_group(20, 4);
+    bee_count_payload_t out;
+    TEST_ASSERT_EQUAL(FEC_COMPLETE, fec_decoder_recover(&dec, &parity, &out));
+}
+
+void test_decoder_rebuilds_any_position(void) {
+    const uint8_t k = 5;
+    parity_payload_t parity = encode_group(300, k);
+    for (uint8_t lost = 0; lost < k; lost++) {
+        FecDecoder dec;
+        fec_decoder_reset(&dec);
+        for (uint8_t i = 0; i < k; i++) {
+            if (i != lost) {
+                bee_count_payload_t p = reading((uint16_t)(300 + i));
+                fec_decoder_note(&dec, &p);
+            }
+        }
+        bee_count_payload_t out;
+        TEST_ASSERT_EQUAL(FEC_RECOVERED, fec_decoder_recover(&dec, &parity, &out));
+        bee_count_payload_t original = reading((uint16_t)(300 + lost));
+        TEST_ASSERT_EQUAL_MEMORY(&original, &out, sizeof(out));
+        TEST_ASSERT_TRUE(fec_decoder_has(&dec, (uint16_t)(300 + lost)));
+    }
+}
+
+void test_decoder_two_lost(void) {
+    FecDecoder dec;
+    fec_decoder_reset(&dec);
+    bee_count_payload_t p = reading(41);
+    fec_decoder_note(&dec, &p);
+    p = reading(43);
+    fec_decoder_note(&dec, &p);
+    parity_payload_t parity = encode_group(40, 4);  // 40 and 42 lost
+    bee_count_payload_t out;
+    TEST_ASSERT_EQUAL(FEC_TOO_MANY_LOST, fec_decoder_recover(&dec, &parity, &out));
+}
+
+void test_decoder_rejects_bad_parity(void) {
+    FecDecoder dec;
+    fec_decoder_reset(&dec);
+    for (uint16_t seq = 1; seq < 4; seq++) {
+        bee_count_payload_t p = reading(seq);
+        fec_decoder_note(&dec, &p);
+    }
+    bee_count_payload_t out;
+
+    parity_payload_t parity = encode_group(0, 4);
+    parity.parity[3] ^= 0x10;  // Corrupted in flight
+    TEST_ASSERT_EQUAL(FEC_BAD_PARITY, fec_decoder_recover(&dec, &parity, &out));
+
+    parity = encode_group(0, 4);
+    parity.count = FEC_MAX_GROUP + 1;
+    parity.crc = crc8((const uint8_t*)&parity, 29);
+    TEST_ASSERT_EQUAL(FEC_BAD_PARITY, fec_decoder_recover(&dec, &parity, &out));
+
+    // Valid CRC but the wrong contents: the rebuilt payload fails its CRC
+    parity = encode_group(0, 4);
+    parity.parity[0] ^= 0x01;
+    parity.crc = crc8((const uint8_t*)&parity, 29);
+    TEST_ASSERT_EQUAL(FEC_BAD_PARITY, fec_decoder_recover(&dec, &parity, &out));
+    TEST_ASSERT_FALSE(fec_decoder_has(&dec, 0));
+}
+
+void test_group_across_sequence_wrap(void) {
+    FecDecoder dec;
+    fec_decoder_reset(&dec);
+    parity_payload_t parity = encode_group(65534, 4);  // 65534, 65535, 0, 1
+    const uint16_t received[] = {65534, 0, 1};
+    for (int i = 0; i < 3; i++) {
+        bee_count_payload_t p = reading(received[i]);
+        fec_decoder_note(&dec, &p);
+    }
+    bee_count_payload_t out;
+    TEST_ASSERT_EQUAL(FEC_RECOVERED, fec_decoder_recover(&dec, &parity, &out));
+    TEST_ASSERT_EQUAL_UINT16(65535, out.sequence);
+}
+
+void test_repeated_parity(void) {
+    FecDecoder dec;
+    fec_decoder_reset(&dec);
+    bee_count_payload_t p = reading(8);
+    fec_decoder_note(&dec, &p);
+    parity_payload_t parity = encode_group(8, 2);
+    bee_count_payload_t out;
+    TEST_ASSERT_EQUAL(FEC_RECOVERED, fec_decoder_recover(&dec, &parity, &out));
+    TEST_ASSERT_EQUAL(FEC_COMPLETE, fec_decoder_recover(&dec, &parity, &out));
+}
+
+void test_stale_history_not_used(void) {
+    FecDecoder dec;
+    fec_decoder_reset(&dec);
+    // Before a node restart: seq 1000 lands in the slot seq 0 will use
+    bee_count_payload_t old = reading(1000);
+    TEST_ASSERT_EQUAL(0, 1000 % FEC_HISTORY);
+    fec_decoder_note(&dec, &old);
+
+    bee_count_payload_t p = reading(1);
+    fec_decoder_note(&dec, &p);
+    parity_payload_t parity = encode_group(0, 2);  // seq 0 lost
+    bee_count_payload_t out;
+    TEST_ASSERT_EQUAL(FEC_RECOVERED, fec_decoder_recover(&dec, &parity, &out));
+    TEST_ASSERT_EQUAL_UINT16(0, out.sequence);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Test runner
+// ═══════════════════════════════════════════════════════════════════════
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    // Encoder
+    RUN_TEST(test_parity_struct_size);
+    RUN_TEST(test_encoder_group_and_parity);
+    RUN_TEST(test_encoder_restarts_on_gap);
+
+    // Decoder
+    RUN_TEST(test_decoder_nothing_lost);
+    RUN_TEST(test_decoder_rebuilds_any_position);
+    RUN_TEST(test_decoder_two_lost);
+    RUN_TEST(test_decoder_rejects_bad_parity);
+    RUN_TEST(test_group_across_sequence_wrap);
+    RUN_TEST(test_repeated_parity);
+    RUN_TEST(test_stale_history_not_used);
+
+    return UNITY_END();
+}
@@ -0,0 +1,541 @@
+// Waggle Sensor Node — Native tests for the full wake cycle on the
+// simulation HAL.
+//
+// Runs on the host (no ESP32 required) via:
+//   pio test -e native
+//
+// Tests:
+//   1. Unconfigured node transmits nothing and sleeps the interval
+//   2. One wake delivers a valid 48-byte payload with scripted readings
+//   3. Sequence increments and virtual time advances one interval per wake
+//   4. Transits during light sleep are reported by the following wake
+//   5. Back-to-back bees on one lane are all counted
+//   6. Radio loss: three attempts, frame dropped, sequence still advances
+//   7. Sensor failure sets the error flags
+//   8. Traffic burst raises and then releases the camera wake line
+//   9. period_ms stays correct across the 49.7-day millis() wrap
+//  10. The busy lock is released before every sleep, configured or not
+//  11. Power management lowers the per-cycle average current
+//  12. FEC uplink: one attempt per payload, parity rebuilds a lost one
+//  13. Thermal array: payload per wake, conversion overlaps the sensor reads
+//  14. Latency trace: attempt, capture age and retry time on every copy
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/node.h"
+#include "../sim/hal_sim.h"
+
+// ── Helpers ───────────────────────────────────────────────────────────
+
+struct Capture {
+    int count;
+    bee_count_payload_t last;
+};
+
+static void capture_frame(void* ctx, uint64_t now_ms, const uint8_t* data, size_t len) {
+    (void)now_ms;
+    Capture* c = (Capture*)ctx;
+    TEST_ASSERT_EQUAL(sizeof(bee_count_payload_t), len);
+    memcpy(&c->last, data, sizeof(c->last));
+    c->count++;
+}
+
+static void failed_bme280(void* ctx, uint64_t now_ms, SimReadings* out) {
+    sim_default_script(ctx, now_ms, out);
+    out->bme280_ok = false;
+}
+
+static const uint64_t INTERVAL_MS = (uint64_t)WAKE_INTERVAL_SEC * 1000ULL;
+
+// ═══════════════════════════════════════════════════════════════════════
+// Wake cycle
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_unconfigured_sends_nothing(void) {
+    SimHal hal;
+    static const uint8_t mac[6] = {1, 2, 3, 4, 5, 6};
+    hal.set_provisioning(0, mac, false);
+    Capture cap = {};
+    hal.set_frame_sink(capture_frame, &cap);
+
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+    node.wake();
+
+    TEST_ASSERT_EQUAL(0, cap.count);
+    TEST_ASSERT_EQUAL_UINT16(0, seq);
+    // Blink (1 s) plus the full sleep interval
+    TEST_ASSERT_EQUAL_UINT64(1000 + INTERVAL_MS, hal.now_ms());
+}
+
+void test_wake_delivers_valid_payload(void) {
+    SimHal hal;
+    static const uint8_t mac[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+    hal.set_provisioning(7, mac, true);
+    Capture cap = {};
+    hal.set_frame_sink(capture_frame, &cap);
+
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+    node.wake();
+
+    TEST_ASSERT_EQUAL(1, cap.count);
+    const bee_count_payload_t& p = cap.last;
+    TEST_ASSERT_EQUAL_UINT8(7, p.hive_id);
+    TEST_ASSERT_EQUAL_UINT8(MSG_TYPE_BEE_COUNT, p.msg_type);
+    TEST_ASSERT_EQUAL_UINT16(0, p.sequence);
+    TEST_ASSERT_EQUAL_HEX8(crc8((const uint8_t*)&p, 17), p.crc);
+    TEST_ASSERT_EQUAL_HEX8(DEFAULT_LANE_MASK, p.lane_mask);
+    TEST_ASSERT_TRUE(p.flags & FLAG_FIRST_BOOT);
+    TEST_ASSERT_FALSE(p.flags & (FLAG_HX711_ERROR | FLAG_BME280_ERROR));
+
+    // Midnight values of the default script
+    TEST_ASSERT_INT_WITHIN(1, 40000, p.weight_g);
+    TEST_ASSERT_INT_WITHIN(5, 700, p.temp_c_x100);
+    TEST_ASSERT_EQUAL_UINT16(6000, p.humidity_x100);
+    TEST_ASSERT_EQUAL_UINT16(10132, p.pressure_hpa_x10);
+    TEST_ASSERT_UINT_WITHIN(1, 4100, p.battery_mv);
+}
+
+void test_sequence_and_virtual_time(void) {
+    SimHal hal;
+    Capture cap = {};
+    hal.set_frame_sink(capture_frame, &cap);
+
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+    for (int i = 0; i < 10; i++) {
+        node.wake();
+    }
+
+    TEST_ASSERT_EQUAL(10, cap.count);
+    TEST_ASSERT_EQUAL_UINT16(9, cap.last.sequence);
+    TEST_ASSERT_EQUAL_UINT16(10, seq);
+    // Ten sleep intervals plus a little awake time per wake
+    TEST_ASSERT_EQUAL_UINT64(10 * INTERVAL_MS * 1000ULL, hal.asleep_us());
+    TEST_ASSERT_TRUE(hal.awake_us() > 0);
+    TEST_ASSERT_TRUE(hal.awake_us() < 10 * 1000000ULL);
+    // Steady-state period is one interval plus one wake's awake time
+    TEST_ASSERT_UINT32_WITHIN(1000, INTERVAL_MS, cap.last.period_ms);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Bee counting
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_scripted_transits_counted_next_wake(void) {
+    SimHal hal;
+    Capture cap = {};
+    hal.set_frame_sink(capture_frame, &cap);
+
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+    node.wake();  // Starts the bee counter, then sleeps
+
+    // During the next sleep: 3 in on lane 0, 2 out on lane 2
+    uint64_t t0 = hal.now_ms();
+    hal.schedule_transit(t0 + 5000, 0, true, 40);
+    hal.schedule_transit(t0 + 15000, 0, true, 40);
+    hal.schedule_transit(t0 + 25000, 0, true, 40);
+    hal.schedule_transit(t0 + 8000, 2, false, 30);
+    hal.schedule_transit(t0 + 9000, 2, false, 30);
+    // Too fast to be a bee
+    hal.schedule_transit(t0 + 30000, 1, true, 2);
+
+    // This wake reports before the bees arrive; they are counted while
+    // it sleeps and reported by the next one
+    node.wake();
+    TEST_ASSERT_EQUAL_UINT16(0, cap.last.bees_in);
+    node.wake();
+    TEST_ASSERT_EQUAL(3, cap.count);
+    TEST_ASSERT_EQUAL_UINT16(3, cap.last.bees_in);
+    TEST_ASSERT_EQUAL_UINT16(2, cap.last.bees_out);
+
+    // Counters were reset by the snapshot
+    node.wake();
+    TEST_ASSERT_EQUAL_UINT16(0, cap.last.bees_in);
+    TEST_ASSERT_EQUAL_UINT16(0, cap.last.bees_out);
+}
+
+void test_back_to_back_bees_on_one_lane(void) {
+    SimHal hal;
+    Capture cap = {};
+    hal.set_frame_sink(capture_frame, &cap);
+
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+    node.wake();
+
+    // 50 bees through lane 3, 200 ms apart, within a single interval
+    uint64_t t0 = hal.now_ms() + 2000;
+    for (int i = 0; i < 50; i++) {
+        hal.schedule_transit(t0 + (uint64_t)i * 200, 3, (i % 2) == 0, 25);
+    }
+    node.wake();
+    node.wake();
+    TEST_ASSERT_EQUAL_UINT16(25, cap.last.bees_in);
+    TEST_ASSERT_EQUAL_UINT16(25, cap.last.bees_out);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Faults
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_radio_loss_retries_then_drops(void) {
+    SimHal hal;
+    hal.set_radio_loss_pct(100);
+    Capture cap = {};
+    hal.set_frame_sink(capture_frame, &cap);
+
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+    node.wake();
+    node.wake();
+
+    TEST_ASSERT_EQUAL(0, cap.count);
+    TEST_ASSERT_EQUAL_UINT64(2 * ESPNOW_MAX_RETRIES, hal.send_attempts());
+    TEST_ASSERT_EQUAL_UINT64(2, hal.frames_lost());
+    TEST_ASSERT_EQUAL_UINT16(2, seq);
+}
+
+void test_sensor_failure_sets_flags(void) {
+    SimHal hal;
+    hal.set_sensor_script(failed_bme280, nullptr);
+    Capture cap = {};
+    hal.set_frame_sink(capture_frame, &cap);
+
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+    node.wake();
+
+    TEST_ASSERT_TRUE(cap.last.flags & FLAG_BME280_ERROR);
+    TEST_ASSERT_FALSE(cap.last.flags & FLAG_HX711_ERROR);
+    TEST_ASSERT_EQUAL_INT16(0, cap.last.temp_c_x100);
+    TEST_ASSERT_EQUAL_UINT16(0, cap.last.humidity_x100);
+    TEST_ASSERT_TRUE(cap.last.weight_g != 0);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Activity trigger
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_burst_raises_and_releases_wake_line(void) {
+    SimHal hal;
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+    node.wake();
+
+    // Robbing: ACTIVITY_IN_THRESHOLD inbound bees within a few seconds,
+    // spread over all lanes
+    uint64_t t0 = hal.now_ms() + 1000;
+    for (int i = 0; i < ACTIVITY_IN_THRESHOLD; i++) {
+        hal.schedule_transit(t0 + (uint64_t)(i / NUM_CHANNELS) * 100,
+                             (uint8_t)(i % NUM_CHANNELS), true, 30);
+    }
+
+    // Wake into the burst, sleep through the hold time
+    node.wake();
+    TEST_ASSERT_EQUAL_UINT64(1, hal.wake_line_rises());
+    TEST_ASSERT_TRUE(hal.pin_level(ACTIVITY_TRIGGER_PIN));
+
+    // The next wake's split sleep releases the line after ACTIVITY_HOLD_MS
+    node.wake();
+    TEST_ASSERT_FALSE(hal.pin_level(ACTIVITY_TRIGGER_PIN));
+    TEST_ASSERT_EQUAL_UINT64(1, hal.wake_line_rises());
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Long runs
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_period_across_millis_wrap(void) {
+    SimHal hal;
+    Capture cap = {};
+    hal.set_frame_sink(capture_frame, &cap);
+
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+
+    // Run until millis() has wrapped (2^32 ms ≈ 49.7 days), checking
+    // every payload's period
+    const uint64_t wrap_ms = 1ULL << 32;
+    uint32_t max_period = 0;
+    while (hal.now_ms() < wrap_ms + 10 * INTERVAL_MS) {
+        node.wake();
+        if (cap.count > 1 && cap.last.period_ms > max_period) {
+            max_period = cap.last.period_ms;
+        }
+    }
+    TEST_ASSERT_TRUE(hal.millis() < 20 * INTERVAL_MS);
+    TEST_ASSERT_UINT32_WITHIN(1000, INTERVAL_MS, max_period);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Power management
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_busy_lock_released_before_sleep(void) {
+    SimHal hal;
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+    node.wake();
+    node.wake();
+
+    SimHal unconfigured;
+    static const uint8_t mac[6] = {1, 2, 3, 4, 5, 6};
+    unconfigured.set_provisioning(0, mac, false);
+    SensorNode<SimHal> idle_node(unconfigured, &seq);
+    idle_node.wake();
+
+    TEST_ASSERT_EQUAL_UINT64(2, hal.wakes());
+    TEST_ASSERT_EQUAL_UINT64(0, hal.sleeps_while_busy());
+    TEST_ASSERT_EQUAL_UINT64(0, unconfigured.sleeps_while_busy());
+}
+
+void test_pm_lowers_average_current(void) {
+    float avg_ma[2];
+    for (int pm = 0; pm < 2; pm++) {
+        SimHal hal;
+        hal.set_power_management(pm != 0);
+        uint16_t seq = 0;
+        SensorNode<SimHal> node(hal, &seq);
+        for (int i = 0; i < 10; i++) {
+            node.wake();
+        }
+        const PowerProfile& p = hal.run_profile();
+        // Every virtual microsecond is accounted to exactly one state
+        TEST_ASSERT_EQUAL_UINT64(hal.now_us(), power_profile_total_us(&p));
+        TEST_ASSERT_EQUAL_UINT64(10 * (SIM_COST_RADIO_INIT_US + SIM_COST_RADIO_TX_US),
+                                 p.us[POWER_RADIO]);
+        avg_ma[pm] = power_profile_avg_ma(&p);
+    }
+    // Off: ~465 ms at 240 MHz per cycle; on: the HX711 conversions sleep
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 1.22f, avg_ma[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.85f, avg_ma[1]);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Uplink FEC
+// ═══════════════════════════════════════════════════════════════════════
+
+// Feeds every frame the bridge receives through the FEC decoder, as the
+// bridge firmware does.
+struct FecSink {
+    FecDecoder decoder;
+    int        readings;
+    int        parities;
+    int        recovered;
+    uint16_t   recovered_seq;
+};
+
+static void fec_sink(void* ctx, uint64_t now_ms, const uint8_t* data, size_t len) {
+    (void)now_ms;
+    FecSink* s = (FecSink*)ctx;
+    if (len == sizeof(parity_payload_t)) {
+        parity_payload_t parity;
+        memcpy(&parity, data, sizeof(parity));
+        bee_count_payload_t rebuilt;
+        if (fec_decoder_recover(&s->decoder, &parity, &rebuilt) == FEC_RECOVERED) {
+            s->recovered++;
+            s->recovered_seq = rebuilt.sequence;
+        }
+        s->parities++;
+        return;
+    }
+    TEST_ASSERT_EQUAL(sizeof(bee_count_payload_t), len);
+    bee_count_payload_t p;
+    memcpy(&p, data, sizeof(p));
+    fec_decoder_note(&s->decoder, &p);
+    s->readings++;
+}
+
+void test_fec_uplink_rebuilds_lost_payload(void) {
+    SimHal hal;
+    FecSink sink;
+    memset(&sink, 0, sizeof(sink));
+    hal.set_frame_sink(fec_sink, &sink);
+
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq, 4);
+    node.wake();
+    hal.set_radio_loss_pct(100);  // seq 1 lost, no retries
+    node.wake();
+    hal.set_radio_loss_pct(0);
+    node.wake();
+    node.wake();                  // seq 3 closes the group: parity follows
+
+    TEST_ASSERT_EQUAL(3, sink.readings);
+    TEST_ASSERT_EQUAL(1, sink.parities);
+    TEST_ASSERT_EQUAL(1, sink.recovered);
+    TEST_ASSERT_EQUAL_UINT16(1, sink.recovered_seq);
+    TEST_ASSERT_EQUAL_UINT64(5, hal.send_attempts());  // 4 payloads + 1 parity
+    TEST_ASSERT_EQUAL_UINT16(4, seq);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Thermal array
+// ═══════════════════════════════════════════════════════════════════════
+
+struct ThermalSink {
+    int                 readings;
+    int                 thermals;
+    bee_count_payload_t reading;
+    thermal_payload_t   thermal;
+};
+
+static void thermal_sink(void* ctx, uint64_t now_ms, const uint8_t* data, size_t len) {
+    (void)now_ms;
+    ThermalSink* s = (ThermalSink*)ctx;
+    if (len == sizeof(thermal_payload_t)) {
+        memcpy(&s->thermal, data, sizeof(s->thermal));
+        s->thermals++;
+        return;
+    }
+    TEST_ASSERT_EQUAL(sizeof(bee_count_payload_t), len);
+    memcpy(&s->reading, data, sizeof(s->reading));
+    s->readings++;
+}
+
+void test_thermal_array_overlaps_conversion(void) {
+    // Second wake without the array, for comparison
+    SimHal plain;
+    uint16_t plain_seq = 0;
+    SensorNode<SimHal> plain_node(plain, &plain_seq);
+    plain_node.wake();
+    uint64_t before = plain.awake_us();
+    plain_node.wake();
+    uint64_t plain_wake_us = plain.awake_us() - before;
+
+    SimHal hal;
+    ThermalSink sink;
+    memset(&sink, 0, sizeof(sink));
+    hal.set_frame_sink(thermal_sink, &sink);
+    hal.set_thermal_probes(8, 34.5f);
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+    node.wake();  // Includes the ROM search
+    before = hal.awake_us();
+    node.wake();
+    uint64_t wake_us = hal.awake_us() - before;
+
+    TEST_ASSERT_EQUAL(2, sink.readings);
+    TEST_ASSERT_EQUAL(2, sink.thermals);
+    TEST_ASSERT_EQUAL_HEX8(MSG_TYPE_THERMAL, sink.thermal.msg_type);
+    TEST_ASSERT_EQUAL_UINT16(sink.reading.sequence, sink.thermal.sequence);
+    TEST_ASSERT_EQUAL_UINT8(8, sink.thermal.probe_count);
+    TEST_ASSERT_EQUAL_HEX8(0, sink.thermal.thermal_flags);
+    TEST_ASSERT_EQUAL_HEX8(crc8((const uint8_t*)&sink.thermal, PAYLOAD_SIZE_THERMAL - 1),
+                           sink.thermal.crc);
+
+    // Warmest in the middle of the chain, cooler towards the edges
+    float middle = (sink.thermal.base_x16 + 2 * sink.thermal.q[4]) / 16.0f;
+    TEST_ASSERT_FLOAT_WITHIN(1.5f, 34.5f, middle);
+    TEST_ASSERT_TRUE(sink.thermal.q[0] < sink.thermal.q[4]);
+    TEST_ASSERT_TRUE(sink.thermal.q[7] < sink.thermal.q[4]);
+    TEST_ASSERT_EQUAL_HEX8(THERMAL_Q_NONE, sink.thermal.q[8]);
+
+    // Converting first and reading afterwards would add the full 750 ms;
+    // overlapping it with the HX711 and BME280 reads hides over 400 ms.
+    uint64_t serial_us = SIM_COST_THERMAL_START_US + (uint64_t)DS18B20_CONVERT_MS * 1000ULL +
+                         8ULL * SIM_COST_THERMAL_PROBE_US + SIM_COST_RADIO_TX_US;
+    uint64_t extra_us = wake_us - plain_wake_us;
+    TEST_ASSERT_TRUE(extra_us + 400000ULL < serial_us);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Latency trace
+// ═══════════════════════════════════════════════════════════════════════
+
+struct TraceSink {
+    int             frames;
+    int             retried;
+    payload_trace_t traces[32];
+};
+
+static void trace_sink(void* ctx, uint64_t now_ms, const uint8_t* data, size_t len) {
+    (void)now_ms;
+    TraceSink* s = (TraceSink*)ctx;
+    TEST_ASSERT_EQUAL(PAYLOAD_SIZE_V2, len);
+    if (s->frames < 32) {
+        memcpy(&s->traces[s->frames], data + TRACE_OFFSET, sizeof(payload_trace_t));
+    }
+    s->frames++;
+}
+
+void test_latency_trace_stamped_per_attempt(void) {
+    SimHal hal;
+    hal.set_seed(7);
+    hal.set_radio_loss_pct(50);
+    TraceSink sink;
+    memset(&sink, 0, sizeof(sink));
+    hal.set_frame_sink(trace_sink, &sink);
+
+    uint16_t seq = 0;
+    SensorNode<SimHal> node(hal, &seq);
+    for (int i = 0; i < 16; i++) {
+        node.wake();
+    }
+
+    TEST_ASSERT_TRUE(sink.frames > 0 && sink.frames <= 16);
+    const uint32_t init_ms = SIM_COST_RADIO_INIT_US / 1000;
+    const uint32_t step_ms = ESPNOW_RETRY_MS + SIM_COST_RADIO_TX_US / 1000;
+    for (int i = 0; i < sink.frames; i++) {
+        const payload_trace_t& t = sink.traces[i];
+        TEST_ASSERT_EQUAL_UINT8(TRACE_VERSION, t.version);
+        TEST_ASSERT_TRUE(t.tx_attempt >= 1 && t.tx_attempt <= ESPNOW_MAX_RETRIES);
+        // Only the radio bring-up lies between the reads and the first attempt
+        TEST_ASSERT_UINT_WITHIN(2, init_ms, t.capture_age_ms);
+        TEST_ASSERT_UINT_WITHIN(1, (t.tx_attempt - 1) * step_ms, t.retry_ms);
+        // The bridge half is left for the bridge
+        TEST_ASSERT_EQUAL_UINT32(0, t.bridge_rx_ms);
+        TEST_ASSERT_EQUAL_UINT16(0, t.bridge_hold_us);
+        if (t.tx_attempt > 1) {
+            sink.retried++;
+        }
+    }
+    TEST_ASSERT_TRUE(sink.retried > 0);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Test runner
+// ═══════════════════════════════════════════════════════════════════════
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    // Wake cycle
+    RUN_TEST(test_unconfigured_sends_nothing);
+    RUN_TEST(test_wake_delivers_valid_payload);
+    RUN_TEST(test_sequence_and_virtual_time);
+
+    // Bee counting
+    RUN_TEST(test_scripted_transits_counted_next_wake);
+    RUN_TEST(test_back_to_back_bees_on_one_lane);
+
+    // Faults
+    RUN_TEST(test_radio_loss_retries_then_drops);
+    RUN_TEST(test_sensor_failure_sets_flags);
+
+    // Activity trigger
+    RUN_TEST(test_burst_raises_and_releases_wake_line);
+
+    // Long runs
+    RUN_TEST(test_period_across_millis_wrap);
+
+    // Power management
+    RUN_TEST(test_busy_lock_released_before_sleep);
+    RUN_TEST(test_pm_lowers_average_current);
+
+    // Uplink FEC
+    RUN_TEST(test_fec_uplink_rebuilds_lost_payload);
+
+    // Thermal array
+    RUN_TEST(test_thermal_array_overlaps_conversion);
+
+    // Latency trace
+    RUN_TEST(test_latency_trace_stamped_per_attempt);
+
+    return UNITY_END();
+}
@@ -0,0 +1,413 @@
+// Waggle Sensor Node — Native unit tests for onewire.h and the thermal
+// payload builder in payload.h
+//
+// Runs on the host (no ESP32 required) via:
+//   pio test -e native
+//
+// The bus is a simulated chain of DS18B20s: every device follows the
+// ROM command protocol bit by bit and the line is the wired AND of all
+// devices still talking, as on the real open-drain bus.
+//
+// Tests:
+//   1. Dallas CRC-8 check value and ROM code self-check
+//   2. Search finds every probe on a chain of 12
+//   3. Search with a single probe, and on an empty bus
+//   4. Search skips other families and stops at max
+//   5. Convert-all then scratchpad read of each probe, negative values too
+//   6. Read before a conversion reports the 85 °C power-on value
+//   7. Corrupted scratchpad fails its CRC; an unplugged probe reads absent
+//   8. thermal_payload_t is exactly 44 bytes; builder fields and CRC
+//   9. Quantisation: 0.125 °C steps above the coldest probe
+//  10. Failed probes, clamped spans and an all-failed array
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/onewire.h"
+#include "../src/payload.h"
+
+// ── Simulated DS18B20 chain ───────────────────────────────────────────
+
+#define SIM_MAX_DEVICES 16
+
+struct SimProbe {
+    uint8_t rom[ONEWIRE_ROM_LEN];
+    int16_t temp_x16;      // What the next conversion will measure
+    uint8_t scratch[DS18B20_SCRATCHPAD_LEN];
+    bool    present;
+    bool    noisy;         // Flip a scratchpad bit on every read
+};
+
+enum SimState { SIM_IDLE, SIM_ROM_CMD, SIM_SEARCH, SIM_MATCH, SIM_FUNCTION, SIM_READ };
+
+struct SimBus {
+    SimProbe dev[SIM_MAX_DEVICES];
+    int      count;
+    SimState state;
+    bool     selected[SIM_MAX_DEVICES];
+    uint8_t  acc;          // Bits of the byte being written
+    uint8_t  acc_bits;
+    int      bit;          // Search / match / read position
+    int      search_phase; // 0: id bit, 1: complement, 2: master's choice
+};
+
+static bool rom_bit(const uint8_t* bytes, int bit) {
+    return (bytes[bit / 8] >> (bit % 8)) & 0x01;
+}
+
+static void set_scratchpad(SimProbe* d, uint16_t raw) {
+    uint8_t pad[DS18B20_SCRATCHPAD_LEN] = {
+        (uint8_t)raw, (uint8_t)(raw >> 8), 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0};
+    pad[8] = onewire_crc8(pad, 8);
+    memcpy(d->scratch, pad, sizeof(pad));
+}
+
+// Add a probe whose 48-bit serial is `serial`.
+static SimProbe* sim_add(SimBus* b, uint8_t family, uint64_t serial, int16_t temp_x16) {
+    SimProbe* d = &b->dev[b->count++];
+    memset(d, 0, sizeof(*d));
+    d->rom[0] = family;
+    for (int i = 0; i < 6; i++) {
+        d->rom[1 + i] = (uint8_t)(serial >> (8 * i));
+    }
+    d->rom[7] = onewire_crc8(d->rom, 7);
+    d->temp_x16 = temp_x16;
+    d->present = true;
+    set_scratchpad(d, DS18B20_POWER_ON_RAW);
+    return d;
+}
+
+// Line level of one slot: wired AND of every selected device's bit.
+template <typename Fn>
+static bool sim_wired_and(SimBus* b, Fn device_bit) {
+    bool line = true;
+    for (int i = 0; i < b->count; i++) {
+        if (b->selected[i] && !device_bit(i)) {
+            line = false;
+        }
+    }
+    return line;
+}
+
+static void sim_command(SimBus* b, uint8_t cmd) {
+    if (b->state == SIM_ROM_CMD) {
+        b->bit = 0;
+        b->search_phase = 0;
+        b->state = (cmd == ONEWIRE_CMD_SEARCH_ROM) ? SIM_SEARCH
+                 : (cmd == ONEWIRE_CMD_MATCH_ROM)  ? SIM_MATCH
+                 : (cmd == ONEWIRE_CMD_SKIP_ROM)   ? SIM_FUNCTION
+                 : SIM_IDLE;
+        return;
+    }
+    if (cmd == DS18B20_CMD_CONVERT_T) {
+        for (int i = 0; i < b->count; i++) {
+            if (b->selected[i]) {
+                set_scratchpad(&b->dev[i], (uint16_t)b->dev[i].temp_x16);
+            }
+        }
+        b->state = SIM_IDLE;
+    } else if (cmd == DS18B20_CMD_READ_SCRATCH) {
+        b->bit = 0;
+        b->state = SIM_READ;
+    } else {
+        b->state = SIM_IDLE;
+    }
+}
+
+static void sim_write_bit(SimBus* b, bool v) {
+    if (b->state == SIM_SEARCH || b->state == SIM_MATCH) {
+        if (b->state == SIM_SEARCH && b->search_phase != 2) {
+            b->state = SIM_IDLE;  // Protocol error: devices drop out
+            return;
+        }
+        for (int i = 0; i < b->count; i++) {
+            if (rom_bit(b->dev[i].rom, b->bit) != v) {
+                b->selected[i] = false;
+            }
+        }
+        b->search_phase = 0;
+        if (++b->bit == 64) {
+            b->state = SIM_FUNCTION;
+        }
+        return;
+    }
+    if (b->state == SIM_ROM_CMD || b->state == SIM_FUNCTION) {
+        b->acc |= (uint8_t)(v << b->acc_bits);
+        if (++b->acc_bits == 8) {
+            uint8_t cmd = b->acc;
+            b->acc = 0;
+            b->acc_bits = 0;
+            sim_command(b, cmd);
+        }
+    }
+}
+
+static bool sim_read_bit(SimBus* b) {
+    if (b->state == SIM_SEARCH && b->search_phase < 2) {
+        bool complement = (b->search_phase++ == 1);
+        int bit = b->bit;
+        return sim_wired_and(b, [&](int i) { return rom_bit(b->dev[i].rom, bit) != complement; });
+    }
+    if (b->state == SIM_READ && b->bit < DS18B20_SCRATCHPAD_LEN * 8) {
+        int bit = b->bit++;
+        return sim_wired_and(b, [&](int i) {
+            bool v = rom_bit(b->dev[i].scratch, bit);
+            return (b->dev[i].noisy && bit == 20) ? !v : v;
+        });
+    }
+    return true;  // Pull-up
+}
+
+static bool sim_reset(void* ctx) {
+    SimBus* b = (SimBus*)ctx;
+    bool presence = false;
+    for (int i = 0; i < b->count; i++) {
+        b->selected[i] = b->dev[i].present;
+        presence = presence || b->dev[i].present;
+    }
+    b->state = SIM_ROM_CMD;
+    b->acc = 0;
+    b->acc_bits = 0;
+    return presence;
+}
+
+static void sim_write_bits(void* ctx, uint8_t value, uint8_t nbits) {
+    for (uint8_t i = 0; i < nbits; i++) {
+        sim_write_bit((SimBus*)ctx, (value >> i) & 0x01);
+    }
+}
+
+static uint8_t sim_read_bits(void* ctx, uint8_t nbits) {
+    uint8_t value = 0;
+    for (uint8_t i = 0; i < nbits; i++) {
+        value |= (uint8_t)(sim_read_bit((SimBus*)ctx) << i);
+    }
+    return value;
+}
+
+static const OneWireOps SIM_OPS = {sim_reset, sim_write_bits, sim_read_bits};
+
+static OneWireBus sim_bus(SimBus* b) {
+    OneWireBus bus = {&SIM_OPS, b};
+    return bus;
+}
+
+// Index of the simulated device with this ROM code, or -1.
+static int sim_find(const SimBus* b, const uint8_t* rom) {
+    for (int i = 0; i < b->count; i++) {
+        if (memcmp(b->dev[i].rom, rom, ONEWIRE_ROM_LEN) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// 1-Wire protocol
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_crc8_dallas(void) {
+    // CRC-8/MAXIM check value
+    TEST_ASSERT_EQUAL_HEX8(0xA1, onewire_crc8((const uint8_t*)"123456789", 9));
+    SimBus b;
+    memset(&b, 0, sizeof(b));
+    SimProbe* d = sim_add(&b, DS18B20_FAMILY, 0x0000A1B2C3D4ULL, 0);
+    TEST_ASSERT_EQUAL_HEX8(0, onewire_crc8(d->rom, ONEWIRE_ROM_LEN));
+    TEST_ASSERT_EQUAL_HEX8(0, onewire_crc8(d->scratch, DS18B20_SCRATCHPAD_LEN));
+}
+
+void test_search_finds_chain(void) {
+    SimBus b;
+    memset(&b, 0, sizeof(b));
+    // Serials sharing long prefixes force discrepancies deep in the code
+    static const uint64_t serials[] = {
+        0x000000000001ULL, 0x000000000002ULL, 0x000000000003ULL, 0x800000000000ULL,
+        0x800000000001ULL, 0x123456789ABCULL, 0x123456789ABDULL, 0xFFFFFFFFFFFFULL,
+        0x000000010000ULL, 0x00000F000000ULL, 0x7FFFFFFFFFFFULL, 0x555555555555ULL,
+    };
+    for (int i = 0; i < 12; i++) {
+        sim_add(&b, DS18B20_FAMILY, serials[i], 0);
+    }
+    OneWireBus bus = sim_bus(&b);
+
+    uint8_t roms[THERMAL_MAX_PROBES][ONEWIRE_ROM_LEN];
+    TEST_ASSERT_EQUAL_UINT8(12, onewire_search(&bus, roms, THERMAL_MAX_PROBES, DS18B20_FAMILY));
+    bool seen[12] = {false};
+    for (int i = 0; i < 12; i++) {
+        int idx = sim_find(&b, roms[i]);
+        TEST_ASSERT_TRUE(idx >= 0);
+        TEST_ASSERT_FALSE(seen[idx]);
+        seen[idx] = true;
+    }
+
+    // Same order on the next search
+    uint8_t again[THERMAL_MAX_PROBES][ONEWIRE_ROM_LEN];
+    TEST_ASSERT_EQUAL_UINT8(12, onewire_search(&bus, again, THERMAL_MAX_PROBES, DS18B20_FAMILY));
+    TEST_ASSERT_EQUAL_MEMORY(roms, again, 12 * ONEWIRE_ROM_LEN);
+}
+
+void test_search_single_and_empty(void) {
+    SimBus b;
+    memset(&b, 0, sizeof(b));
+    OneWireBus bus = sim_bus(&b);
+    uint8_t roms[4][ONEWIRE_ROM_LEN];
+    TEST_ASSERT_EQUAL_UINT8(0, onewire_search(&bus, roms, 4, 0));
+
+    SimProbe* d = sim_add(&b, DS18B20_FAMILY, 0x00C0FFEE0042ULL, 0);
+    TEST_ASSERT_EQUAL_UINT8(1, onewire_search(&bus, roms, 4, 0));
+    TEST_ASSERT_EQUAL_MEMORY(d->rom, roms[0], ONEWIRE_ROM_LEN);
+}
+
+void test_search_family_and_max(void) {
+    SimBus b;
+    memset(&b, 0, sizeof(b));
+    sim_add(&b, 0x10, 0x000000000007ULL, 0);  // DS18S20: not ours
+    for (uint64_t s = 1; s <= 5; s++) {
+        sim_add(&b, DS18B20_FAMILY, s * 0x1111ULL, 0);
+    }
+    OneWireBus bus = sim_bus(&b);
+    uint8_t roms[8][ONEWIRE_ROM_LEN];
+    TEST_ASSERT_EQUAL_UINT8(5, onewire_search(&bus, roms, 8, DS18B20_FAMILY));
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_HEX8(DS18B20_FAMILY, roms[i][0]);
+    }
+    TEST_ASSERT_EQUAL_UINT8(6, onewire_search(&bus, roms, 8, 0));
+    TEST_ASSERT_EQUAL_UINT8(3, onewire_search(&bus, roms, 3, 0));
+}
+
+void test_convert_and_read(void) {
+    SimBus b;
+    memset(&b, 0, sizeof(b));
+    sim_add(&b, DS18B20_FAMILY, 0x01ULL, 552);    // 34.5 °C
+    sim_add(&b, DS18B20_FAMILY, 0x02ULL, -168);   // -10.5 °C
+    sim_add(&b, DS18B20_FAMILY, 0x03ULL, 401);    // 25.0625 °C
+    OneWireBus bus = sim_bus(&b);
+    uint8_t roms[4][ONEWIRE_ROM_LEN];
+    TEST_ASSERT_EQUAL_UINT8(3, onewire_search(&bus, roms, 4, DS18B20_FAMILY));
+
+    TEST_ASSERT_TRUE(onewire_convert_all(&bus));
+    for (int i = 0; i < 3; i++) {
+        int16_t t = 0;
+        TEST_ASSERT_EQUAL(DS18B20_OK, ds18b20_read(&bus, roms[i], &t));
+        TEST_ASSERT_EQUAL_INT16(b.dev[sim_find(&b, roms[i])].temp_x16, t);
+    }
+}
+
+void test_read_before_convert(void) {
+    SimBus b;
+    memset(&b, 0, sizeof(b));
+    SimProbe* d = sim_add(&b, DS18B20_FAMILY, 0x42ULL, 300);
+    OneWireBus bus = sim_bus(&b);
+    int16_t t = 7;
+    TEST_ASSERT_EQUAL(DS18B20_NOT_CONVERTED, ds18b20_read(&bus, d->rom, &t));
+    TEST_ASSERT_EQUAL_INT16(7, t);  // Untouched
+}
+
+void test_bad_crc_and_absent(void) {
+    SimBus b;
+    memset(&b, 0, sizeof(b));
+    SimProbe* a = sim_add(&b, DS18B20_FAMILY, 0x0AULL, 500);
+    SimProbe* n = sim_add(&b, DS18B20_FAMILY, 0x0BULL, 510);
+    OneWireBus bus = sim_bus(&b);
+    TEST_ASSERT_TRUE(onewire_convert_all(&bus));
+
+    n->noisy = true;
+    int16_t t;
+    TEST_ASSERT_EQUAL(DS18B20_BAD_CRC, ds18b20_read(&bus, n->rom, &t));
+
+    a->present = false;  // Unplugged: nobody answers MATCH ROM
+    TEST_ASSERT_EQUAL(DS18B20_NO_PRESENCE, ds18b20_read(&bus, a->rom, &t));
+
+    n->present = false;  // Whole chain gone: no presence pulse
+    TEST_ASSERT_FALSE(onewire_convert_all(&bus));
+    TEST_ASSERT_EQUAL(DS18B20_NO_PRESENCE, ds18b20_read(&bus, n->rom, &t));
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Thermal payload
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_thermal_payload_fields(void) {
+    TEST_ASSERT_EQUAL(PAYLOAD_SIZE_THERMAL, sizeof(thermal_payload_t));
+    TEST_ASSERT_EQUAL(44, sizeof(thermal_payload_t));
+
+    const int16_t temps[3] = {552, 560, 548};
+    thermal_payload_t p;
+    payload_build_thermal(&p, 9, 1234, temps, 3, 0);
+    TEST_ASSERT_EQUAL_UINT8(9, p.hive_id);
+    TEST_ASSERT_EQUAL_HEX8(MSG_TYPE_THERMAL, p.msg_type);
+    TEST_ASSERT_EQUAL_UINT16(1234, p.sequence);
+    TEST_ASSERT_EQUAL_UINT8(3, p.probe_count);
+    TEST_ASSERT_EQUAL_HEX8(0, p.thermal_flags);
+    TEST_ASSERT_EQUAL_HEX8(crc8((const uint8_t*)&p, 43), p.crc);
+    TEST_ASSERT_EQUAL_HEX8(THERMAL_Q_NONE, p.q[3]);
+    TEST_ASSERT_EQUAL_HEX8(THERMAL_Q_NONE, p.q[THERMAL_MAX_PROBES - 1]);
+    uint8_t zeros[3] = {0};
+    TEST_ASSERT_EQUAL_MEMORY(zeros, p.reserved, 3);
+}
+
+void test_thermal_quantisation(void) {
+    // 34.5, 35.0, 34.25, 34.5625 (odd 1/16 step rounds down) °C
+    const int16_t temps[4] = {552, 560, 548, 553};
+    thermal_payload_t p;
+    payload_build_thermal(&p, 1, 0, temps, 4, 0);
+    TEST_ASSERT_EQUAL_INT16(548, p.base_x16);
+    TEST_ASSERT_EQUAL_UINT8(2, p.q[0]);
+    TEST_ASSERT_EQUAL_UINT8(6, p.q[1]);
+    TEST_ASSERT_EQUAL_UINT8(0, p.q[2]);
+    TEST_ASSERT_EQUAL_UINT8(2, p.q[3]);
+    for (int i = 0; i < 4; i++) {
+        int decoded = p.base_x16 + 2 * p.q[i];
+        TEST_ASSERT_TRUE(temps[i] - decoded >= 0 && temps[i] - decoded <= 1);
+    }
+
+    // Below zero the base rounds towards colder, never warmer
+    const int16_t cold[2] = {-169, -100};   // -10.5625, -6.25 °C
+    payload_build_thermal(&p, 1, 0, cold, 2, 0);
+    TEST_ASSERT_EQUAL_INT16(-170, p.base_x16);
+    TEST_ASSERT_EQUAL_UINT8(0, p.q[0]);
+    TEST_ASSERT_EQUAL_UINT8(35, p.q[1]);
+}
+
+void test_thermal_failed_and_clamped(void) {
+    const int16_t temps[3] = {400, THERMAL_NO_READING, 400 + 2 * 300};
+    thermal_payload_t p;
+    payload_build_thermal(&p, 1, 0, temps, 3, THERMAL_FLAG_BUS_ERROR);
+    TEST_ASSERT_EQUAL_INT16(400, p.base_x16);
+    TEST_ASSERT_EQUAL_HEX8(THERMAL_Q_NONE, p.q[1]);
+    TEST_ASSERT_EQUAL_UINT8(THERMAL_Q_MAX, p.q[2]);
+    TEST_ASSERT_EQUAL_HEX8(THERMAL_FLAG_BUS_ERROR | THERMAL_FLAG_READ_ERROR | THERMAL_FLAG_CLAMPED,
+                           p.thermal_flags);
+
+    const int16_t none[2] = {THERMAL_NO_READING, THERMAL_NO_READING};
+    payload_build_thermal(&p, 1, 0, none, 2, 0);
+    TEST_ASSERT_EQUAL_INT16(0, p.base_x16);
+    TEST_ASSERT_EQUAL_HEX8(THERMAL_Q_NONE, p.q[0]);
+    TEST_ASSERT_EQUAL_HEX8(THERMAL_Q_NONE, p.q[1]);
+    TEST_ASSERT_EQUAL_HEX8(THERMAL_FLAG_READ_ERROR, p.thermal_flags);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Test runner
+// ═══════════════════════════════════════════════════════════════════════
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    // 1-Wire protocol
+    RUN_TEST(test_crc8_dallas);
+    RUN_TEST(test_search_finds_chain);
+    RUN_TEST(test_search_single_and_empty);
+    RUN_TEST(test_search_family_and_max);
+    RUN_TEST(test_convert_and_read);
+    RUN_TEST(test_read_before_convert);
+    RUN_TEST(test_bad_crc_and_absent);
+
+    // Thermal payload
+    RUN_TEST(test_thermal_payload_fields);
+    RUN_TEST(test_thermal_quantisation);
+    RUN_TEST(test_thermal_failed_and_clamped);
+
+    return UNITY_END();
+}
@@ -0,0 +1,431 @@
+// Waggle Sensor Node — Native unit tests for provision_proto.h
+//
+// Runs on the host (no ESP32 required) via:
+//   pio test -e native
+//
+// The node side runs against a fake backend: NVS is a ProvConfig that can
+// be told to fail writes or to corrupt them, and the load cell returns
+// fixed results.
+//
+// Tests:
+//   1. Body structs have their wire sizes
+//   2. Encode/decode round trip; the wire frame has no inner zero bytes
+//   3. A flipped bit fails the CRC; a wrong length byte is rejected
+//   4. Reader splits frames out of log text and drops the noise
+//   5. Reader skips an over-long frame and recovers at the next delimiter
+//   6. HELLO reports the protocol version, node MAC and stored config
+//   7. WRITE_CONFIG stores every key and replies with the read-back
+//   8. WRITE_CONFIG rejects bad values and a short body without writing
+//   9. WRITE_CONFIG read-back mismatch reports VERIFY; a failed write NVS
+//  10. TARE / CALIBRATE argument checks and results
+//  11. Unknown command and REBOOT
+
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/payload.h"
+#include "../src/provision_proto.h"
+#include "../../bridge/src/cobs.h"
+
+// ── Fake backend ──────────────────────────────────────────────────────
+
+struct FakeNode {
+    uint8_t    mac[6];
+    ProvConfig nvs;
+    int        saves;
+    bool       fail_write;      // save() reports an NVS error
+    bool       corrupt_write;   // save() stores a different hx_offset
+    uint8_t    hx_status;       // Returned by tare / calibrate
+    ProvTareArgs      last_tare;
+    ProvCalibrateArgs last_cal;
+};
+
+static void fake_node_mac(void* ctx, uint8_t mac[6]) {
+    memcpy(mac, ((FakeNode*)ctx)->mac, 6);
+}
+
+static void fake_load(void* ctx, ProvConfig* out) {
+    *out = ((FakeNode*)ctx)->nvs;
+}
+
+static uint8_t fake_save(void* ctx, const ProvConfig* cfg) {
+    FakeNode* n = (FakeNode*)ctx;
+    n->saves++;
+    if (n->fail_write) {
+        return PROV_STATUS_NVS;
+    }
+    n->nvs = *cfg;
+    if (n->corrupt_write) {
+        n->nvs.hx_offset ^= 1;
+    }
+    return PROV_STATUS_OK;
+}
+
+static uint8_t fake_tare(void* ctx, const ProvTareArgs* args, int32_t* offset) {
+    FakeNode* n = (FakeNode*)ctx;
+    n->last_tare = *args;
+    if (n->hx_status == PROV_STATUS_OK) {
+        *offset = -81234;
+        n->nvs.hx_offset = *offset;
+    }
+    return n->hx_status;
+}
+
+static uint8_t fake_calibrate(void* ctx, const ProvCalibrateArgs* args, float* scale) {
+    FakeNode* n = (FakeNode*)ctx;
+    n->last_cal = *args;
+    if (n->hx_status == PROV_STATUS_OK) {
+        *scale = 21.5f;
+        n->nvs.hx_scale = *scale;
+    }
+    return n->hx_status;
+}
+
+static FakeNode s_node;
+static ProvBackend s_be;
+
+static void fake_reset(void) {
+    memset(&s_node, 0, sizeof(s_node));
+    const uint8_t mac[6] = {0x24, 0x6F, 0x28, 0x01, 0x02, 0x03};
+    memcpy(s_node.mac, mac, 6);
+    s_node.nvs.hx_scale = 1.0f;
+    s_node.hx_status = PROV_STATUS_OK;
+    s_be.node_mac = fake_node_mac;
+    s_be.load = fake_load;
+    s_be.save = fake_save;
+    s_be.tare = fake_tare;
+    s_be.calibrate = fake_calibrate;
+    s_be.ctx = &s_node;
+}
+
+static ProvConfig valid_config(void) {
+    ProvConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    const uint8_t bridge[6] = {0xAA, 0xBB, 0xCC, 0x00, 0x11, 0x22};
+    cfg.hive_id = 17;
+    cfg.bridge_mac_set = 1;
+    memcpy(cfg.bridge_mac, bridge, 6);
+    cfg.hx_scale = 22.75f;
+    cfg.hx_offset = -80000;
+    return cfg;
+}
+
+// Run one request through prov_handle
+static uint8_t request(uint8_t cmd, const void* body, size_t len, ProvMessage* reply,
+                       bool* restart = nullptr) {
+    ProvMessage req;
+    prov_message(&req, cmd, 0x5A, 0, body, len);
+    bool r = prov_handle(&s_be, &req, reply);
+    if (restart) {
+        *restart = r;
+    }
+    return reply->status;
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Framing
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_body_sizes(void) {
+    TEST_ASSERT_EQUAL(16, sizeof(ProvConfig));
+    TEST_ASSERT_EQUAL(23, sizeof(ProvHello));
+    TEST_ASSERT_EQUAL(3, sizeof(ProvTareArgs));
+    TEST_ASSERT_EQUAL(7, sizeof(ProvCalibrateArgs));
+    TEST_ASSERT_TRUE(sizeof(ProvHello) <= PROV_MAX_BODY);
+
+    ProvMessage m;
+    uint8_t big[PROV_MAX_BODY + 1] = {0};
+    TEST_ASSERT_FALSE(prov_message(&m, PROV_CMD_HELLO, 0, 0, big, sizeof(big)));
+}
+
+void test_encode_decode_round_trip(void) {
+    ProvConfig cfg = valid_config();
+    ProvMessage m;
+    TEST_ASSERT_TRUE(prov_message(&m, PROV_CMD_WRITE_CONFIG, 200, 0, &cfg, sizeof(cfg)));
+
+    uint8_t wire[PROV_MAX_WIRE];
+    size_t n = prov_encode(&m, wire);
+    TEST_ASSERT_TRUE(n <= PROV_MAX_WIRE);
+    TEST_ASSERT_EQUAL_HEX8(0x00, wire[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, wire[n - 1]);
+    for (size_t i = 1; i < n - 1; i++) {
+        TEST_ASSERT_NOT_EQUAL(0x00, wire[i]);
+    }
+
+    ProvMessage out;
+    TEST_ASSERT_TRUE(prov_decode(wire + 1, n - 2, &out));
+    TEST_ASSERT_EQUAL_HEX8(PROV_CMD_WRITE_CONFIG, out.cmd);
+    TEST_ASSERT_EQUAL_UINT8(200, out.seq);
+    TEST_ASSERT_EQUAL_UINT8(0, out.status);
+    TEST_ASSERT_EQUAL_UINT8(sizeof(cfg), out.len);
+    TEST_ASSERT_EQUAL_MEMORY(&cfg, out.body, sizeof(cfg));
+
+    // Largest body still fits the wire buffer
+    uint8_t full[PROV_MAX_BODY];
+    memset(full, 0xFF, sizeof(full));
+    prov_message(&m, PROV_CMD_HELLO | PROV_REPLY, 1, 0, full, sizeof(full));
+    n = prov_encode(&m, wire);
+    TEST_ASSERT_TRUE(n <= PROV_MAX_WIRE);
+    TEST_ASSERT_TRUE(prov_decode(wire + 1, n - 2, &out));
+    TEST_ASSERT_EQUAL_MEMORY(full, out.body, sizeof(full));
+}
+
+void test_decode_rejects_corruption(void) {
+    int32_t offset = 12345;
+    ProvMessage m;
+    prov_message(&m, PROV_CMD_TARE | PROV_REPLY, 3, PROV_STATUS_OK, &offset, sizeof(offset));
+    uint8_t wire[PROV_MAX_WIRE];
+    size_t n = prov_encode(&m, wire);
+
+    ProvMessage out;
+    uint8_t bad[PROV_MAX_WIRE];
+    for (size_t i = 1; i < n - 1; i++) {
+        memcpy(bad, wire, n);
+        bad[i] ^= 0x10;
+        if (bad[i] == 0x00) {
+            continue;  // Would split the frame instead
+        }
+        TEST_ASSERT_FALSE(prov_decode(bad + 1, n - 2, &out));
+    }
+
+    // Body shorter than the length byte claims (CRC recomputed)
+    uint8_t raw[8] = {PROV_CMD_TARE, 3, 0, 4, 1, 2};
+    raw[6] = crc8(raw, 6);
+    uint8_t enc[16];
+    size_t e = cobs_encode(raw, 7, enc);
+    TEST_ASSERT_FALSE(prov_decode(enc, e, &out));
+    TEST_ASSERT_FALSE(prov_decode(enc, 0, &out));
+}
+
+void test_reader_splits_text_noise(void) {
+    ProvMessage a, b;
+    prov_message(&a, PROV_CMD_HELLO, 1, 0, nullptr, 0);
+    ProvConfig cfg = valid_config();
+    prov_message(&b, PROV_CMD_WRITE_CONFIG, 2, 0, &cfg, sizeof(cfg));
+
+    uint8_t stream[256];
+    size_t n = 0;
+    const char* log1 = "[I][provision.cpp:80] NVS loaded\r\nwaggle> ";
+    memcpy(stream + n, log1, strlen(log1));
+    n += strlen(log1);
+    n += prov_encode(&a, stream + n);
+    const char* log2 = "noise";
+    memcpy(stream + n, log2, strlen(log2));
+    n += strlen(log2);
+    n += prov_encode(&b, stream + n);
+
+    ProvReader r;
+    prov_reader_reset(&r);
+    ProvMessage got[4];
+    int messages = 0, invalid = 0;
+    for (size_t i = 0; i < n; i++) {
+        ProvPush p = prov_reader_push(&r, stream[i], &got[messages]);
+        if (p == PROV_PUSH_MESSAGE) {
+            messages++;
+        } else if (p == PROV_PUSH_INVALID) {
+            invalid++;
+        }
+    }
+    TEST_ASSERT_EQUAL(2, messages);
+    TEST_ASSERT_EQUAL(2, invalid);  // Each run of text
+    TEST_ASSERT_EQUAL_HEX8(PROV_CMD_HELLO, got[0].cmd);
+    TEST_ASSERT_EQUAL_UINT8(1, got[0].seq);
+    TEST_ASSERT_EQUAL_HEX8(PROV_CMD_WRITE_CONFIG, got[1].cmd);
+    TEST_ASSERT_EQUAL_MEMORY(&cfg, got[1].body, sizeof(cfg));
+}
+
+void test_reader_overflow_recovers(void) {
+    ProvReader r;
+    prov_reader_reset(&r);
+    ProvMessage out;
+    for (int i = 0; i < 3 * PROV_MAX_WIRE; i++) {
+        TEST_ASSERT_EQUAL(PROV_PUSH_PENDING, prov_reader_push(&r, 'x', &out));
+    }
+    TEST_ASSERT_EQUAL(PROV_PUSH_INVALID, prov_reader_push(&r, 0x00, &out));
+
+    ProvMessage m;
+    prov_message(&m, PROV_CMD_READ_CONFIG, 9, 0, nullptr, 0);
+    uint8_t wire[PROV_MAX_WIRE];
+    size_t n = prov_encode(&m, wire);
+    ProvPush last = PROV_PUSH_PENDING;
+    for (size_t i = 0; i < n; i++) {
+        last = prov_reader_push(&r, wire[i], &out);
+    }
+    TEST_ASSERT_EQUAL(PROV_PUSH_MESSAGE, last);
+    TEST_ASSERT_EQUAL_UINT8(9, out.seq);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Request handling
+// ═══════════════════════════════════════════════════════════════════════
+
+void test_hello(void) {
+    fake_reset();
+    s_node.nvs = valid_config();
+    ProvMessage reply;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_OK, request(PROV_CMD_HELLO, nullptr, 0, &reply));
+    TEST_ASSERT_EQUAL_HEX8(PROV_CMD_HELLO | PROV_REPLY, reply.cmd);
+    TEST_ASSERT_EQUAL_UINT8(0x5A, reply.seq);
+    TEST_ASSERT_EQUAL_UINT8(sizeof(ProvHello), reply.len);
+
+    ProvHello hello;
+    memcpy(&hello, reply.body, sizeof(hello));
+    TEST_ASSERT_EQUAL_UINT8(PROV_PROTO_VERSION, hello.proto_version);
+    TEST_ASSERT_EQUAL_MEMORY(s_node.mac, hello.node_mac, 6);
+    TEST_ASSERT_EQUAL_MEMORY(&s_node.nvs, &hello.config, sizeof(ProvConfig));
+}
+
+void test_write_config_read_back(void) {
+    fake_reset();
+    ProvConfig cfg = valid_config();
+    ProvMessage reply;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_OK,
+                            request(PROV_CMD_WRITE_CONFIG, &cfg, sizeof(cfg), &reply));
+    TEST_ASSERT_EQUAL(1, s_node.saves);
+    TEST_ASSERT_EQUAL_MEMORY(&cfg, &s_node.nvs, sizeof(cfg));
+    TEST_ASSERT_EQUAL_UINT8(sizeof(cfg), reply.len);
+    TEST_ASSERT_EQUAL_MEMORY(&cfg, reply.body, sizeof(cfg));
+
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_OK, request(PROV_CMD_READ_CONFIG, nullptr, 0, &reply));
+    TEST_ASSERT_EQUAL_MEMORY(&cfg, reply.body, sizeof(cfg));
+}
+
+void test_write_config_rejects_bad_values(void) {
+    fake_reset();
+    ProvMessage reply;
+    ProvConfig cfg = valid_config();
+
+    cfg.hive_id = 0;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_BAD_ARG,
+                            request(PROV_CMD_WRITE_CONFIG, &cfg, sizeof(cfg), &reply));
+    cfg.hive_id = 251;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_BAD_ARG,
+                            request(PROV_CMD_WRITE_CONFIG, &cfg, sizeof(cfg), &reply));
+
+    cfg = valid_config();
+    cfg.bridge_mac_set = 0;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_BAD_ARG,
+                            request(PROV_CMD_WRITE_CONFIG, &cfg, sizeof(cfg), &reply));
+
+    cfg = valid_config();
+    cfg.hx_scale = 0.0f;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_BAD_ARG,
+                            request(PROV_CMD_WRITE_CONFIG, &cfg, sizeof(cfg), &reply));
+    cfg.hx_scale = NAN;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_BAD_ARG,
+                            request(PROV_CMD_WRITE_CONFIG, &cfg, sizeof(cfg), &reply));
+
+    cfg = valid_config();
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_BAD_ARG,
+                            request(PROV_CMD_WRITE_CONFIG, &cfg, sizeof(cfg) - 1, &reply));
+    TEST_ASSERT_EQUAL_UINT8(0, reply.len);
+    TEST_ASSERT_EQUAL(0, s_node.saves);
+}
+
+void test_write_config_verify_and_nvs_errors(void) {
+    fake_reset();
+    ProvConfig cfg = valid_config();
+    ProvMessage reply;
+
+    s_node.corrupt_write = true;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_VERIFY,
+                            request(PROV_CMD_WRITE_CONFIG, &cfg, sizeof(cfg), &reply));
+    ProvConfig back;
+    memcpy(&back, reply.body, sizeof(back));
+    TEST_ASSERT_EQUAL_INT32(cfg.hx_offset ^ 1, back.hx_offset);  // What NVS really holds
+
+    s_node.corrupt_write = false;
+    s_node.fail_write = true;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_NVS,
+                            request(PROV_CMD_WRITE_CONFIG, &cfg, sizeof(cfg), &reply));
+    TEST_ASSERT_EQUAL(2, s_node.saves);
+}
+
+void test_tare_and_calibrate(void) {
+    fake_reset();
+    ProvMessage reply;
+    ProvTareArgs tare = {1500, 20};
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_OK, request(PROV_CMD_TARE, &tare, sizeof(tare), &reply));
+    TEST_ASSERT_EQUAL_UINT16(1500, s_node.last_tare.settle_ms);
+    TEST_ASSERT_EQUAL_UINT8(20, s_node.last_tare.samples);
+    int32_t offset;
+    TEST_ASSERT_EQUAL_UINT8(sizeof(offset), reply.len);
+    memcpy(&offset, reply.body, sizeof(offset));
+    TEST_ASSERT_EQUAL_INT32(-81234, offset);
+
+    tare.samples = 0;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_BAD_ARG,
+                            request(PROV_CMD_TARE, &tare, sizeof(tare), &reply));
+    tare.samples = 101;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_BAD_ARG,
+                            request(PROV_CMD_TARE, &tare, sizeof(tare), &reply));
+
+    ProvCalibrateArgs cal = {500.0f, 3000, 20};
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_OK,
+                            request(PROV_CMD_CALIBRATE, &cal, sizeof(cal), &reply));
+    float scale;
+    TEST_ASSERT_EQUAL_UINT8(sizeof(scale), reply.len);
+    memcpy(&scale, reply.body, sizeof(scale));
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, scale);
+    TEST_ASSERT_EQUAL_FLOAT(500.0f, s_node.last_cal.known_g);
+
+    cal.known_g = -1.0f;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_BAD_ARG,
+                            request(PROV_CMD_CALIBRATE, &cal, sizeof(cal), &reply));
+    cal.known_g = INFINITY;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_BAD_ARG,
+                            request(PROV_CMD_CALIBRATE, &cal, sizeof(cal), &reply));
+
+    // Load cell errors pass through with no result body
+    cal.known_g = 500.0f;
+    s_node.hx_status = PROV_STATUS_NO_WEIGHT;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_NO_WEIGHT,
+                            request(PROV_CMD_CALIBRATE, &cal, sizeof(cal), &reply));
+    TEST_ASSERT_EQUAL_UINT8(0, reply.len);
+    s_node.hx_status = PROV_STATUS_HX711;
+    tare.samples = 10;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_HX711,
+                            request(PROV_CMD_TARE, &tare, sizeof(tare), &reply));
+    TEST_ASSERT_EQUAL_UINT8(0, reply.len);
+}
+
+void test_unknown_and_reboot(void) {
+    fake_reset();
+    ProvMessage reply;
+    bool restart = true;
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_UNKNOWN_CMD, request(0x42, nullptr, 0, &reply, &restart));
+    TEST_ASSERT_EQUAL_HEX8(0x42 | PROV_REPLY, reply.cmd);
+    TEST_ASSERT_FALSE(restart);
+
+    TEST_ASSERT_EQUAL_UINT8(PROV_STATUS_OK,
+                            request(PROV_CMD_REBOOT, nullptr, 0, &reply, &restart));
+    TEST_ASSERT_TRUE(restart);
+    TEST_ASSERT_EQUAL_UINT8(0, reply.len);
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// Test runner
+// ═══════════════════════════════════════════════════════════════════════
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    // Framing
+    RUN_TEST(test_body_sizes);
+    RUN_TEST(test_encode_decode_round_trip);
+    RUN_TEST(test_decode_rejects_corruption);
+    RUN_TEST(test_reader_splits_text_noise);
+    RUN_TEST(test_reader_overflow_recovers);
+
+    // Request handling
+    RUN_TEST(test_hello);
+    RUN_TEST(test_write_config_read_back);
+    RUN_TEST(test_write_config_rejects_bad_values);
+    RUN_TEST(test_write_config_verify_and_nvs_errors);
+    RUN_TEST(test_tare_and_calibrate);
+    RUN_TEST(test_unknown_and_reboot);
+
+    return UNITY_END();
+}
@@ -166,6 +166,8 @@ if command -v rsync &>/dev/null; then
         --exclude='*.egg-info' \
         --exclude='test_temp*' \
         --exclude='waggle.db' \
+        --exclude='/build' \
+        --exclude='*.so' \
         "${REPO_ROOT}/backend/" "${BACKEND_DIR}/"
     info "Synced backend/ -> ${BACKEND_DIR}/ (rsync)"
 else
@@ -175,7 +177,17 @@ else
     info "Copied backend/ -> ${BACKEND_DIR}/ (cp)"
 fi
 
-chown -R "${SERVICE_USER}:${SERVICE_USER}" "${BACKEND_DIR}"
+# Firmware sources compiled into the native frame decoder (backend/setup.py)
+FIRMWARE_DIR="${INSTALL_DIR}/firmware"
+mkdir -p "${FIRMWARE_DIR}/bridge/src" "${FIRMWARE_DIR}/sensor/src"
+cp "${REPO_ROOT}/firmware/bridge/src/cobs.h" "${REPO_ROOT}/firmware/bridge/src/cobs.cpp" \
+    "${FIRMWARE_DIR}/bridge/src/"
+mkdir -p "${FIRMWARE_DIR}/bridge/host"
+cp "${REPO_ROOT}/firmware/sensor/src/payload.h" "${FIRMWARE_DIR}/sensor/src/"
+cp "${REPO_ROOT}/firmware/bridge/host/host_io.h" "${FIRMWARE_DIR}/bridge/host/"
+info "Copied frame decoder sources -> ${FIRMWARE_DIR}/"
+
+chown -R "${SERVICE_USER}:${SERVICE_USER}" "${BACKEND_DIR}" "${FIRMWARE_DIR}"
 info "Ownership set to ${SERVICE_USER}:${SERVICE_USER}"
 
 # ============================================================================
@@ -198,6 +210,52 @@ info "pip upgraded"
 sudo -u "$SERVICE_USER" "${VENV_DIR}/bin/pip" install --quiet -e "${BACKEND_DIR}/"
 info "Installed waggle package (editable)"
 
+if sudo -u "$SERVICE_USER" "${VENV_DIR}/bin/python" -c "import waggle._frames" 2>/dev/null; then
+    info "Native frame decoder built"
+else
+    warn "Native frame decoder not built (needs g++ and python3-dev); using pure Python"
+fi
+
+if sudo -u "$SERVICE_USER" "${VENV_DIR}/bin/python" -c "import waggle._tsstore" 2>/dev/null; then
+    info "Time-series store built (waggle-tsstore.service, set TSSTORE_DIR to use)"
+else
+    warn "Time-series store not built (needs g++ and python3-dev); raw queries use SQLite"
+fi
+
+if sudo -u "$SERVICE_USER" "${VENV_DIR}/bin/python" -c "import waggle._alerts" 2>/dev/null; then
+    info "Native alert windows built"
+else
+    warn "Native alert windows not built (needs g++ and python3-dev); alert rules use SQL"
+fi
+
+if sudo -u "$SERVICE_USER" "${VENV_DIR}/bin/python" -c "import waggle._latest" 2>/dev/null; then
+    info "Latest-state table built (set LATEST_STATE_PATH to use)"
+else
+    warn "Latest-state table not built (needs g++ and python3-dev); status queries use SQLite"
+fi
+
+if sudo -u "$SERVICE_USER" "${VENV_DIR}/bin/python" -c "import waggle._preprocess" 2>/dev/null; then
+    info "Native ML pre-processing built"
+else
+    warn "Native ML pre-processing not built (needs g++, python3-dev and libjpeg-dev); ML worker uses ultralytics' loader"
+fi
+
+# Optional native ingestion daemon (waggle-ingestd.service, not enabled by default)
+if sudo -u "$SERVICE_USER" make --quiet -C "${BACKEND_DIR}/native" ingestd \
+        FIRMWARE="${FIRMWARE_DIR}" >/dev/null 2>&1; then
+    info "Built ingestd -> ${BACKEND_DIR}/native/ingestd/ingestd"
+else
+    warn "ingestd not built (needs g++ and libsqlite3-dev); use waggle-bridge + waggle-worker"
+fi
+
+# Optional multi-bridge aggregator (waggle-aggregator.service, not enabled by default)
+if sudo -u "$SERVICE_USER" make --quiet -C "${BACKEND_DIR}/native" aggregator \
+        FIRMWARE="${FIRMWARE_DIR}" >/dev/null 2>&1; then
+    info "Built aggregator -> ${BACKEND_DIR}/native/aggregator/aggregator"
+else
+    warn "aggregator not built (needs g++); only single-bridge setups are supported"
+fi
+
 # ============================================================================
 # Step 6: Default configuration
 # ============================================================================
@@ -0,0 +1,9 @@
+-- Waggle: record why the camera node woke for each photo
+-- (mirrors backend alembic revision 004)
+
+ALTER TABLE photos
+    ADD COLUMN IF NOT EXISTS trigger_reason TEXT NOT NULL DEFAULT 'scheduled';
+
+ALTER TABLE photos
+    ADD CONSTRAINT ck_photo_trigger_reason
+    CHECK (trigger_reason IN ('scheduled', 'activity', 'boot'));
@@ -0,0 +1,5 @@
+-- Waggle: optional same-wake thumbnail per photo
+-- (mirrors backend alembic revision 006)
+
+ALTER TABLE photos
+    ADD COLUMN IF NOT EXISTS thumbnail_path TEXT;